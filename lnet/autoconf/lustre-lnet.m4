@@ -723,6 +723,9 @@ AC_CHECK_FUNCS([gethostbyname socket connect])
 # lnet/utils/debug.c
 AC_CHECK_HEADERS([linux/version.h])
 
+# lnet/ulnds/socklnd/epoll.c
+AC_CHECK_HEADERS([sys/epoll.h])
+
 # lnet/utils/wirecheck.c
 AC_CHECK_FUNCS([strnlen])
 
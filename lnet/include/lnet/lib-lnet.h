@@ -697,6 +697,16 @@ lnet_net2rnethash(__u32 net)
 		((1U << the_lnet.ln_remote_nets_hbits) - 1)];
 }
 
+/* wall-clock usec for latency histograms, callers clamp negative deltas */
+static inline __u64
+lnet_time_usec(void)
+{
+	struct timeval tv;
+
+	cfs_gettimeofday(&tv);
+	return (__u64)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
 extern lnd_t the_lolnd;
 
 #ifndef __KERNEL__
@@ -830,6 +840,7 @@ int lnet_fail_nid(lnet_nid_t nid, unsigned int threshold);
 
 void lnet_counters_get(lnet_counters_t *counters);
 void lnet_counters_reset(void);
+void lnet_latency_reset(void);
 
 unsigned int lnet_iov_nob (unsigned int niov, struct iovec *iov);
 int lnet_extract_iov (int dst_niov, struct iovec *dst,
@@ -218,6 +218,11 @@ typedef struct lnet_msg {
         unsigned int          msg_peerrtrcredit:1; /* taken a peer router credit */
         unsigned int          msg_onactivelist:1; /* on the activelist */
 
+	/* usec timestamps for latency histograms, 0 if not reached yet */
+	__u64			msg_tx_commit_usec; /* committed for sending */
+	__u64			msg_tx_delay_usec;  /* first blocked on credits */
+	__u64			msg_tx_send_usec;   /* handed to the LND */
+
         struct lnet_peer     *msg_txpeer;         /* peer I'm sending to */
         struct lnet_peer     *msg_rxpeer;         /* peer I received from */
 
@@ -401,11 +406,30 @@ typedef struct {
         __u32      ns_unused;
 } WIRE_ATTR lnet_ni_status_t;
 
+/* # of log2(usec) buckets of latency histograms, the last one is
+ * open-ended */
+#define LNET_LAT_BUCKETS	20
+
+enum {
+	LNET_LAT_QUEUE	= 0,	/* committed -> handed to the LND */
+	LNET_LAT_CREDIT,	/* part of LNET_LAT_QUEUE blocked on credits */
+	LNET_LAT_WIRE,		/* handed to the LND -> send completion */
+	LNET_LAT_NTYPES,
+};
+
+typedef struct lnet_latency {
+	__u64			la_count[LNET_LAT_NTYPES];
+	__u64			la_usec[LNET_LAT_NTYPES];  /* total time */
+	__u32			la_hist[LNET_LAT_NTYPES][LNET_LAT_BUCKETS];
+} lnet_latency_t;
+
 struct lnet_tx_queue {
 	int			tq_credits;	/* # tx credits free */
 	int			tq_credits_min;	/* lowest it's been */
 	int			tq_credits_max;	/* total # tx credits */
 	cfs_list_t		tq_delayed;	/* delayed TXs */
+	/* send latency of this NI on this CPT */
+	lnet_latency_t		tq_latency;
 };
 
 #define LNET_MAX_INTERFACES   16
@@ -503,6 +527,12 @@ typedef struct lnet_peer {
 	unsigned int		lp_ping_feats;
 	cfs_list_t		lp_routes;	/* routers on this peer */
 	lnet_rc_data_t		*lp_rcd;	/* router checker state */
+	/* # messages handed to the LND and not completed yet */
+	int			lp_tx_inflight;
+	/* high water mark of lp_tx_inflight */
+	int			lp_tx_inflight_max;
+	/* send latency to this peer */
+	lnet_latency_t		lp_latency;
 } lnet_peer_t;
 
 
@@ -47,9 +47,12 @@
 
 #define LST_FEAT_NONE		(0)
 #define LST_FEAT_BULK_LEN	(1 << 0)	/* enable variable page size */
+#define LST_FEAT_BULK_DIST	(1 << 1)	/* size distribution, ramp-up
+						 * and latency percentiles */
 
 #define LST_FEATS_EMPTY		(LST_FEAT_NONE)
-#define LST_FEATS_MASK		(LST_FEAT_NONE | LST_FEAT_BULK_LEN)
+#define LST_FEATS_MASK		(LST_FEAT_NONE | LST_FEAT_BULK_LEN | \
+				 LST_FEAT_BULK_DIST)
 
 #define LST_NAME_SIZE           32              /* max name buffer length */
 
@@ -429,6 +432,7 @@ typedef struct {
 
         int                     lstio_tes_dist;         /* IN: node distribution in destination groups */
         int                     lstio_tes_span;         /* IN: node span in destination groups */
+        int                     lstio_tes_ramp;         /* IN: seconds to start all test units */
         int                     lstio_tes_sgrp_nmlen;   /* IN: source group name length */
         char                   *lstio_tes_sgrp_name;    /* IN: group name */
         int                     lstio_tes_dgrp_nmlen;   /* IN: destination group name length */
@@ -454,11 +458,23 @@ typedef enum {
         LST_BRW_CHECK_FULL   = 3
 } lst_brw_flags_t;
 
+typedef enum {
+        LST_BULK_DIST_FIXED   = 0,      /* always blk_size */
+        LST_BULK_DIST_UNIFORM = 1,      /* random in [blk_sizes[0], blk_sizes[1]] */
+        LST_BULK_DIST_MIXED   = 2,      /* random one of blk_sizes[] */
+} lst_bulk_dist_t;
+
+#define LST_BULK_MAX_SIZES      8       /* max # of sizes in a mixed test */
+
 typedef struct {
         int                     blk_opc;                /* bulk operation code */
-        int                     blk_size;               /* size (bytes) */
+        int                     blk_size;               /* size (bytes), max size if
+                                                         * blk_dist is not FIXED */
         int                     blk_time;               /* time of running the test*/
         int                     blk_flags;              /* reserved flags */
+        int                     blk_dist;               /* size distribution */
+        int                     blk_nsizes;             /* # of valid blk_sizes */
+        int                     blk_sizes[LST_BULK_MAX_SIZES]; /* sizes (bytes) */
 } lst_test_bulk_param_t;
 
 typedef struct {
@@ -1443,6 +1443,28 @@ kiblnd_find_rd_dma_mr(kib_hca_dev_t *hdev, kib_rdma_desc_t *rd)
         return mr;
 }
 
+static void
+kiblnd_destroy_fastreg_descs(kib_fmr_pool_t *fpo)
+{
+	kib_fast_reg_descriptor_t *frd;
+
+	while (!cfs_list_empty(&fpo->fpo_frd_list)) {
+		frd = cfs_list_entry(fpo->fpo_frd_list.next,
+				     kib_fast_reg_descriptor_t, frd_list);
+		cfs_list_del(&frd->frd_list);
+
+		if (frd->frd_mr != NULL)
+			ib_dereg_mr(frd->frd_mr);
+		if (frd->frd_frpl != NULL)
+			ib_free_fast_reg_page_list(frd->frd_frpl);
+
+		LIBCFS_FREE(frd, sizeof(*frd));
+		fpo->fpo_frd_count--;
+	}
+
+	LASSERT(fpo->fpo_frd_count == 0);
+}
+
 void
 kiblnd_destroy_fmr_pool(kib_fmr_pool_t *pool)
 {
@@ -1451,6 +1473,9 @@ kiblnd_destroy_fmr_pool(kib_fmr_pool_t *pool)
         if (pool->fpo_fmr_pool != NULL)
                 ib_destroy_fmr_pool(pool->fpo_fmr_pool);
 
+	if (!pool->fpo_is_fmr)
+		kiblnd_destroy_fastreg_descs(pool);
+
         if (pool->fpo_hdev != NULL)
                 kiblnd_hdev_decref(pool->fpo_hdev);
 
@@ -1483,12 +1508,9 @@ static int kiblnd_fmr_flush_trigger(int ncpts)
 	return max(IBLND_FMR_POOL_FLUSH, size);
 }
 
-int
-kiblnd_create_fmr_pool(kib_fmr_poolset_t *fps, kib_fmr_pool_t **pp_fpo)
+static int
+kiblnd_create_fmr_pool_fmr(kib_fmr_poolset_t *fps, kib_fmr_pool_t *fpo)
 {
-        /* FMR pool for RDMA */
-        kib_dev_t               *dev = fps->fps_net->ibn_dev;
-        kib_fmr_pool_t          *fpo;
         struct ib_fmr_pool_param param = {
                 .max_pages_per_fmr = LNET_MAX_PAYLOAD/PAGE_SIZE,
                 .page_shift        = PAGE_SHIFT,
@@ -1501,17 +1523,105 @@ kiblnd_create_fmr_pool(kib_fmr_poolset_t *fps, kib_fmr_pool_t **pp_fpo)
 		.cache             = !!*kiblnd_tunables.kib_fmr_cache};
 	int rc;
 
+	fpo->fpo_fmr_pool = ib_create_fmr_pool(fpo->fpo_hdev->ibh_pd, &param);
+	if (IS_ERR(fpo->fpo_fmr_pool)) {
+		rc = PTR_ERR(fpo->fpo_fmr_pool);
+		fpo->fpo_fmr_pool = NULL;
+		if (rc != -ENOSYS)
+			CERROR("Failed to create FMR pool: %d\n", rc);
+		return rc;
+	}
+
+	fpo->fpo_is_fmr = 1;
+	return 0;
+}
+
+/* Pre-allocate fps_pool_size fast-reg MRs and page lists, they are
+ * registered by FAST_REG_MR work items posted ahead of the tx */
+static int
+kiblnd_create_fmr_pool_fastreg(kib_fmr_poolset_t *fps, kib_fmr_pool_t *fpo)
+{
+	kib_hca_dev_t			*hdev = fpo->fpo_hdev;
+	kib_fast_reg_descriptor_t	*frd;
+	int				 npages = LNET_MAX_PAYLOAD/PAGE_SIZE;
+	int				 rc;
+	int				 i;
+
+	if ((hdev->ibh_dev_cap & IB_DEVICE_MEM_MGT_EXTENSIONS) == 0 ||
+	    hdev->ibh_max_frpl_len < npages)
+		return -ENOSYS;
+
+	fpo->fpo_is_fmr = 0;
+
+	for (i = 0; i < fps->fps_pool_size; i++) {
+		LIBCFS_CPT_ALLOC(frd, lnet_cpt_table(), fps->fps_cpt,
+				 sizeof(*frd));
+		if (frd == NULL) {
+			rc = -ENOMEM;
+			goto failed;
+		}
+
+		/* add it first, so kiblnd_destroy_fastreg_descs() can
+		 * free a partially initialized descriptor */
+		cfs_list_add_tail(&frd->frd_list, &fpo->fpo_frd_list);
+		fpo->fpo_frd_count++;
+
+		frd->frd_frpl = ib_alloc_fast_reg_page_list(hdev->ibh_ibdev,
+							    npages);
+		if (IS_ERR(frd->frd_frpl)) {
+			rc = PTR_ERR(frd->frd_frpl);
+			frd->frd_frpl = NULL;
+			CERROR("Failed to allocate fast-reg page list: %d\n",
+			       rc);
+			goto failed;
+		}
+
+		frd->frd_mr = ib_alloc_fast_reg_mr(hdev->ibh_pd, npages);
+		if (IS_ERR(frd->frd_mr)) {
+			rc = PTR_ERR(frd->frd_mr);
+			frd->frd_mr = NULL;
+			CERROR("Failed to allocate fast-reg MR: %d\n", rc);
+			goto failed;
+		}
+
+		frd->frd_valid = 1;
+	}
+
+	return 0;
+
+ failed:
+	kiblnd_destroy_fastreg_descs(fpo);
+	return rc;
+}
+
+int
+kiblnd_create_fmr_pool(kib_fmr_poolset_t *fps, kib_fmr_pool_t **pp_fpo)
+{
+        /* FMR or FRWR pool for RDMA */
+        kib_dev_t               *dev = fps->fps_net->ibn_dev;
+        kib_fmr_pool_t          *fpo;
+	int rc;
+
 	LIBCFS_CPT_ALLOC(fpo, lnet_cpt_table(), fps->fps_cpt, sizeof(*fpo));
 	if (fpo == NULL)
 		return -ENOMEM;
 
 	fpo->fpo_hdev = kiblnd_current_hdev(dev);
+	CFS_INIT_LIST_HEAD(&fpo->fpo_frd_list);
+
+	/* FRWR never stalls on pool flushes but costs two extra work
+	 * items per tx, so FMR stays the default where it exists */
+	if (*kiblnd_tunables.kib_use_fastreg) {
+		rc = kiblnd_create_fmr_pool_fastreg(fps, fpo);
+		if (rc == -ENOSYS)
+			rc = kiblnd_create_fmr_pool_fmr(fps, fpo);
+	} else {
+		rc = kiblnd_create_fmr_pool_fmr(fps, fpo);
+		if (rc == -ENOSYS)
+			rc = kiblnd_create_fmr_pool_fastreg(fps, fpo);
+	}
 
-	fpo->fpo_fmr_pool = ib_create_fmr_pool(fpo->fpo_hdev->ibh_pd, &param);
-	if (IS_ERR(fpo->fpo_fmr_pool)) {
-		rc = PTR_ERR(fpo->fpo_fmr_pool);
-		CERROR("Failed to create FMR pool: %d\n", rc);
-
+	if (rc != 0) {
                 kiblnd_hdev_decref(fpo->fpo_hdev);
                 LIBCFS_FREE(fpo, sizeof(kib_fmr_pool_t));
                 return rc;
@@ -1597,20 +1707,32 @@ kiblnd_fmr_pool_unmap(kib_fmr_t *fmr, int status)
         kib_fmr_poolset_t *fps = fpo->fpo_owner;
         cfs_time_t         now = cfs_time_current();
         kib_fmr_pool_t    *tmp;
+	kib_fast_reg_descriptor_t *frd;
         int                rc;
 
-        rc = ib_fmr_pool_unmap(fmr->fmr_pfmr);
-        LASSERT (rc == 0);
+	if (fpo->fpo_is_fmr) {
+		rc = ib_fmr_pool_unmap(fmr->fmr_pfmr);
+		LASSERT (rc == 0);
 
-        if (status != 0) {
-                rc = ib_flush_fmr_pool(fpo->fpo_fmr_pool);
-                LASSERT (rc == 0);
-        }
+		if (status != 0) {
+			rc = ib_flush_fmr_pool(fpo->fpo_fmr_pool);
+			LASSERT (rc == 0);
+		}
+	}
+
+	frd = fmr->fmr_frd;
 
         fmr->fmr_pool = NULL;
         fmr->fmr_pfmr = NULL;
+	fmr->fmr_frd  = NULL;
 
 	spin_lock(&fps->fps_lock);
+	if (frd != NULL) {
+		/* the key stays registered until the next user of this
+		 * descriptor invalidates it, so no flush is ever needed */
+		frd->frd_valid = 0;
+		cfs_list_add_tail(&frd->frd_list, &fpo->fpo_frd_list);
+	}
         fpo->fpo_map_count --;  /* decref the pool */
 
         cfs_list_for_each_entry_safe(fpo, tmp, &fps->fps_pool_list, fpo_list) {
@@ -1629,10 +1751,57 @@ kiblnd_fmr_pool_unmap(kib_fmr_t *fmr, int status)
                 kiblnd_destroy_fmr_pool_list(&zombies);
 }
 
+/* Prepare the work items which (re)register the pages of \a fmr with
+ * the descriptor \a frd. They are posted ahead of the first work item
+ * of the tx by kiblnd_post_tx_locked() */
+static void
+kiblnd_fastreg_prep(kib_fast_reg_descriptor_t *frd, __u64 *pages,
+		    int npages, __u32 nob, __u64 iov, kib_fmr_t *fmr)
+{
+	struct ib_fast_reg_page_list	*frpl = frd->frd_frpl;
+	struct ib_mr			*mr   = frd->frd_mr;
+	struct ib_send_wr		*wr;
+	int				 i;
+
+	if (!frd->frd_valid) {
+		/* invalidate the previous key and pick a new one, so a
+		 * stale rkey held by a peer can't access the pages */
+		wr = &frd->frd_inv_wr;
+		memset(wr, 0, sizeof(*wr));
+		wr->opcode		= IB_WR_LOCAL_INV;
+		wr->wr_id		= kiblnd_ptr2wreqid(frd, IBLND_WID_MR);
+		wr->ex.invalidate_rkey	= mr->rkey;
+
+		ib_update_fast_reg_key(mr, ib_inc_rkey(mr->rkey) & 0xff);
+	}
+
+	for (i = 0; i < npages; i++)
+		frpl->page_list[i] = pages[i];
+
+	wr = &frd->frd_fastreg_wr;
+	memset(wr, 0, sizeof(*wr));
+	wr->opcode			= IB_WR_FAST_REG_MR;
+	wr->wr_id			= kiblnd_ptr2wreqid(frd, IBLND_WID_MR);
+	wr->wr.fast_reg.iova_start	= iov;
+	wr->wr.fast_reg.page_list	= frpl;
+	wr->wr.fast_reg.page_list_len	= npages;
+	wr->wr.fast_reg.page_shift	= PAGE_SHIFT;
+	wr->wr.fast_reg.length		= nob;
+	wr->wr.fast_reg.rkey		= mr->rkey;
+	wr->wr.fast_reg.access_flags	= (IB_ACCESS_LOCAL_WRITE |
+					   IB_ACCESS_REMOTE_WRITE);
+
+	frd->frd_posted = 0;
+
+	fmr->fmr_frd = frd;
+	fmr->fmr_key = mr->rkey;
+}
+
 int
 kiblnd_fmr_pool_map(kib_fmr_poolset_t *fps, __u64 *pages, int npages,
-                    __u64 iov, kib_fmr_t *fmr)
+		    __u32 nob, __u64 iov, kib_fmr_t *fmr)
 {
+	kib_fast_reg_descriptor_t *frd;
         struct ib_pool_fmr *pfmr;
         kib_fmr_pool_t     *fpo;
         __u64               version;
@@ -1643,6 +1812,24 @@ kiblnd_fmr_pool_map(kib_fmr_poolset_t *fps, __u64 *pages, int npages,
 	version = fps->fps_version;
 	cfs_list_for_each_entry(fpo, &fps->fps_pool_list, fpo_list) {
 		fpo->fpo_deadline = cfs_time_shift(IBLND_POOL_DEADLINE);
+
+		if (!fpo->fpo_is_fmr) {
+			if (cfs_list_empty(&fpo->fpo_frd_list))
+				continue; /* try the next pool */
+
+			frd = cfs_list_entry(fpo->fpo_frd_list.next,
+					     kib_fast_reg_descriptor_t,
+					     frd_list);
+			cfs_list_del(&frd->frd_list);
+			fpo->fpo_map_count++;
+			spin_unlock(&fps->fps_lock);
+
+			kiblnd_fastreg_prep(frd, pages, npages, nob, iov, fmr);
+			fmr->fmr_pool = fpo;
+			fmr->fmr_pfmr = NULL;
+			return 0;
+		}
+
 		fpo->fpo_map_count++;
 		spin_unlock(&fps->fps_lock);
 
@@ -1651,6 +1838,8 @@ kiblnd_fmr_pool_map(kib_fmr_poolset_t *fps, __u64 *pages, int npages,
                 if (likely(!IS_ERR(pfmr))) {
                         fmr->fmr_pool = fpo;
                         fmr->fmr_pfmr = pfmr;
+			fmr->fmr_frd  = NULL;
+			fmr->fmr_key  = pfmr->fmr->rkey;
                         return 0;
                 }
 
@@ -2302,7 +2491,7 @@ kiblnd_net_init_pools(kib_net_t *net, __u32 *cpts, int ncpts)
 	cfs_percpt_free(net->ibn_fmr_ps);
 	net->ibn_fmr_ps = NULL;
 
-	CWARN("Device does not support FMR, failing back to PMR\n");
+	CWARN("Device does not support FMR or FRWR, failing back to PMR\n");
 
 	if (*kiblnd_tunables.kib_pmr_pool_size <
 	    *kiblnd_tunables.kib_ntx / 4) {
@@ -2385,8 +2574,11 @@ kiblnd_hdev_get_attr(kib_hca_dev_t *hdev)
         }
 
         rc = ib_query_device(hdev->ibh_ibdev, attr);
-        if (rc == 0)
-                hdev->ibh_mr_size = attr->max_mr_size;
+        if (rc == 0) {
+                hdev->ibh_mr_size      = attr->max_mr_size;
+                hdev->ibh_dev_cap      = attr->device_cap_flags;
+                hdev->ibh_max_frpl_len = attr->max_fast_reg_page_list_len;
+        }
 
         LIBCFS_FREE(attr, sizeof(*attr));
 
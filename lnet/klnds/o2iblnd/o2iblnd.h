@@ -110,6 +110,7 @@ typedef struct
         int              *kib_fmr_pool_size;    /* # FMRs in pool */
         int              *kib_fmr_flush_trigger; /* When to trigger FMR flush */
         int              *kib_fmr_cache;        /* enable FMR pool cache? */
+        int              *kib_use_fastreg;      /* prefer FRWR to FMR? */
 #if defined(CONFIG_SYSCTL) && !CFS_SYSFS_MODULE_PARM
         cfs_sysctl_table_header_t *kib_sysctl;  /* sysctl interface */
 #endif
@@ -186,7 +187,8 @@ kiblnd_concurrent_sends_v1(void)
 
 /* WRs and CQEs (per connection) */
 #define IBLND_RECV_WRS(v)            IBLND_RX_MSGS(v)
-#define IBLND_SEND_WRS(v)          ((IBLND_RDMA_FRAGS(v) + 1) * IBLND_CONCURRENT_SENDS(v))
+/* +2 for LOCAL_INV and FAST_REG_MR work items of fast registration */
+#define IBLND_SEND_WRS(v)          ((IBLND_RDMA_FRAGS(v) + 3) * IBLND_CONCURRENT_SENDS(v))
 #define IBLND_CQ_ENTRIES(v)         (IBLND_RECV_WRS(v) + IBLND_SEND_WRS(v))
 
 struct kib_hca_dev;
@@ -224,6 +226,8 @@ typedef struct kib_hca_dev
         __u64                ibh_page_mask;     /* page mask of current HCA */
         int                  ibh_mr_shift;      /* bits shift of max MR size */
         __u64                ibh_mr_size;       /* size of MR */
+        int                  ibh_dev_cap;       /* device capability flags */
+        int                  ibh_max_frpl_len;  /* max # pages of a FRWR */
         int                  ibh_nmrs;          /* # of global MRs */
         struct ib_mr       **ibh_mrs;           /* global MR */
         struct ib_pd        *ibh_pd;            /* PD */
@@ -332,12 +336,28 @@ typedef struct
 	cfs_time_t		fps_next_retry;
 } kib_fmr_poolset_t;
 
+/* fast registration (FRWR) descriptor, the FMR pool alternative for
+ * HCAs with memory management extensions */
+typedef struct
+{
+	cfs_list_t			 frd_list;	/* chain on fpo_frd_list */
+	struct ib_fast_reg_page_list	*frd_frpl;	/* page list */
+	struct ib_mr			*frd_mr;	/* fast-reg MR */
+	struct ib_send_wr		 frd_inv_wr;	/* invalidate old key */
+	struct ib_send_wr		 frd_fastreg_wr;/* register pages */
+	int				 frd_valid;	/* no need to invalidate */
+	int				 frd_posted;	/* WRs have been posted */
+} kib_fast_reg_descriptor_t;
+
 typedef struct
 {
         cfs_list_t              fpo_list;               /* chain on pool list */
         struct kib_hca_dev     *fpo_hdev;               /* device for this pool */
         kib_fmr_poolset_t      *fpo_owner;              /* owner of this pool */
         struct ib_fmr_pool     *fpo_fmr_pool;           /* IB FMR pool */
+	cfs_list_t		fpo_frd_list;		/* free FRWR descriptors */
+	int			fpo_frd_count;		/* # of FRWR descriptors */
+	int			fpo_is_fmr;		/* FMR or FRWR pool */
         cfs_time_t              fpo_deadline;           /* deadline of this pool */
         int                     fpo_failed;             /* fmr pool is failed */
         int                     fpo_map_count;          /* # of mapped FMR */
@@ -345,7 +365,9 @@ typedef struct
 
 typedef struct {
         struct ib_pool_fmr     *fmr_pfmr;               /* IB pool fmr */
+	kib_fast_reg_descriptor_t *fmr_frd;		/* FRWR descriptor */
         kib_fmr_pool_t         *fmr_pool;               /* pool of FMR */
+	__u32			fmr_key;		/* lkey == rkey */
 } kib_fmr_t;
 
 typedef struct kib_net
@@ -829,6 +851,7 @@ kiblnd_queue2str (kib_conn_t *conn, cfs_list_t *q)
 #define IBLND_WID_TX    0
 #define IBLND_WID_RDMA  1
 #define IBLND_WID_RX    2
+#define IBLND_WID_MR    3
 #define IBLND_WID_MASK  3UL
 
 static inline __u64
@@ -1050,7 +1073,7 @@ void kiblnd_pool_free_node(kib_pool_t *pool, cfs_list_t *node);
 cfs_list_t *kiblnd_pool_alloc_node(kib_poolset_t *ps);
 
 int  kiblnd_fmr_pool_map(kib_fmr_poolset_t *fps, __u64 *pages,
-                         int npages, __u64 iov, kib_fmr_t *fmr);
+			 int npages, __u32 nob, __u64 iov, kib_fmr_t *fmr);
 void kiblnd_fmr_pool_unmap(kib_fmr_t *fmr, int status);
 
 int  kiblnd_pmr_pool_map(kib_pmr_poolset_t *pps, kib_hca_dev_t *hdev,
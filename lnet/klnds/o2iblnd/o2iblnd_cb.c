@@ -576,16 +576,20 @@ kiblnd_fmr_map_tx(kib_net_t *net, kib_tx_t *tx, kib_rdma_desc_t *rd, int nob)
 	cpt = tx->tx_pool->tpo_pool.po_owner->ps_cpt;
 
 	fps = net->ibn_fmr_ps[cpt];
-	rc = kiblnd_fmr_pool_map(fps, pages, npages, 0, &tx->tx_u.fmr);
+	rc = kiblnd_fmr_pool_map(fps, pages, npages, nob, 0, &tx->tx_u.fmr);
         if (rc != 0) {
                 CERROR ("Can't map %d pages: %d\n", npages, rc);
                 return rc;
         }
 
-        /* If rd is not tx_rd, it's going to get sent to a peer, who will need
-         * the rkey */
-        rd->rd_key = (rd != tx->tx_rd) ? tx->tx_u.fmr.fmr_pfmr->fmr->rkey :
-                                         tx->tx_u.fmr.fmr_pfmr->fmr->lkey;
+	/* If rd is not tx_rd, it's going to get sent to a peer, who will need
+	 * the rkey */
+	if (tx->tx_u.fmr.fmr_pfmr != NULL)
+		rd->rd_key = (rd != tx->tx_rd) ?
+			     tx->tx_u.fmr.fmr_pfmr->fmr->rkey :
+			     tx->tx_u.fmr.fmr_pfmr->fmr->lkey;
+	else	/* FRWR: lkey == rkey */
+		rd->rd_key = tx->tx_u.fmr.fmr_key;
         rd->rd_frags[0].rf_addr &= ~hdev->ibh_page_mask;
         rd->rd_frags[0].rf_nob   = nob;
         rd->rd_nfrags = 1;
@@ -636,9 +640,9 @@ kiblnd_unmap_tx(lnet_ni_t *ni, kib_tx_t *tx)
 
 	LASSERT(net != NULL);
 
-	if (net->ibn_fmr_ps != NULL && tx->tx_u.fmr.fmr_pfmr != NULL) {
+	if (net->ibn_fmr_ps != NULL && tx->tx_u.fmr.fmr_pool != NULL) {
 		kiblnd_fmr_pool_unmap(&tx->tx_u.fmr, tx->tx_status);
-		tx->tx_u.fmr.fmr_pfmr = NULL;
+		LASSERT(tx->tx_u.fmr.fmr_pfmr == NULL);
 
 	} else if (net->ibn_pmr_ps != NULL && tx->tx_u.pmr != NULL) {
 		kiblnd_pmr_pool_unmap(tx->tx_u.pmr);
@@ -876,10 +880,27 @@ kiblnd_post_tx_locked (kib_conn_t *conn, kib_tx_t *tx, int credit)
                  conn->ibc_hdev != tx->tx_pool->tpo_hdev) {
                 /* close_conn will launch failover */
                 rc = -ENETDOWN;
-        } else {
-                rc = ib_post_send(conn->ibc_cmid->qp,
-                                  tx->tx_wrq, &bad_wrq);
-        }
+	} else {
+		struct ib_send_wr		*wrq = tx->tx_wrq;
+		kib_fast_reg_descriptor_t	*frd = NULL;
+
+		if (tx->tx_pool->tpo_pool.po_owner->ps_net->ibn_fmr_ps != NULL)
+			frd = tx->tx_u.fmr.fmr_frd;
+
+		/* register FRWR pages in the same chain, ahead of the
+		 * RDMA and message work items that use the key */
+		if (frd != NULL && !frd->frd_posted) {
+			frd->frd_fastreg_wr.next = wrq;
+			wrq = &frd->frd_fastreg_wr;
+			if (!frd->frd_valid) {
+				frd->frd_inv_wr.next = wrq;
+				wrq = &frd->frd_inv_wr;
+			}
+			frd->frd_posted = 1;
+		}
+
+		rc = ib_post_send(conn->ibc_cmid->qp, wrq, &bad_wrq);
+	}
 
         conn->ibc_last_send = jiffies;
 
@@ -3268,6 +3289,12 @@ kiblnd_complete (struct ib_wc *wc)
                         kiblnd_wreqid2ptr(wc->wr_id), wc->status);
                 return;
 
+        case IBLND_WID_MR:
+		/* FRWR work items are unsignaled, so this is a failure and
+		 * the tx's own SEND will fail too */
+		CNETERR("FastReg failed: %d\n", wc->status);
+		return;
+
         case IBLND_WID_TX:
                 kiblnd_tx_complete(kiblnd_wreqid2ptr(wc->wr_id), wc->status);
                 return;
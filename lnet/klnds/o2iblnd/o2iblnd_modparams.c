@@ -126,6 +126,10 @@ static int fmr_cache = 1;
 CFS_MODULE_PARM(fmr_cache, "i", int, 0444,
 		"non-zero to enable FMR caching");
 
+static int use_fastreg = 0;
+CFS_MODULE_PARM(use_fastreg, "i", int, 0444,
+		"non-zero to prefer FRWR (fast registration work requests) to FMR");
+
 /* NB: this value is shared by all CPTs, it can grow at runtime */
 static int pmr_pool_size = 512;
 CFS_MODULE_PARM(pmr_pool_size, "i", int, 0444,
@@ -170,6 +174,7 @@ kib_tunables_t kiblnd_tunables = {
         .kib_fmr_pool_size          = &fmr_pool_size,
         .kib_fmr_flush_trigger      = &fmr_flush_trigger,
         .kib_fmr_cache              = &fmr_cache,
+	.kib_use_fastreg	    = &use_fastreg,
         .kib_pmr_pool_size          = &pmr_pool_size,
         .kib_require_priv_port      = &require_privileged_port,
 	.kib_use_priv_port	    = &use_privileged_port,
@@ -202,6 +207,7 @@ enum {
         O2IBLND_FMR_POOL_SIZE,
         O2IBLND_FMR_FLUSH_TRIGGER,
         O2IBLND_FMR_CACHE,
+	O2IBLND_USE_FASTREG,
         O2IBLND_PMR_POOL_SIZE,
         O2IBLND_DEV_FAILOVER
 };
@@ -226,6 +232,7 @@ enum {
 #define O2IBLND_FMR_POOL_SIZE    CTL_UNNUMBERED
 #define O2IBLND_FMR_FLUSH_TRIGGER CTL_UNNUMBERED
 #define O2IBLND_FMR_CACHE        CTL_UNNUMBERED
+#define O2IBLND_USE_FASTREG      CTL_UNNUMBERED
 #define O2IBLND_PMR_POOL_SIZE    CTL_UNNUMBERED
 #define O2IBLND_DEV_FAILOVER     CTL_UNNUMBERED
 
@@ -385,6 +392,14 @@ static cfs_sysctl_table_t kiblnd_ctl_table[] = {
                 .mode     = 0444,
                 .proc_handler = &proc_dointvec
         },
+	{
+		.ctl_name = O2IBLND_USE_FASTREG,
+		.procname = "use_fastreg",
+		.data     = &use_fastreg,
+		.maxlen   = sizeof(int),
+		.mode     = 0444,
+		.proc_handler = &proc_dointvec
+	},
         {
                 .ctl_name = O2IBLND_PMR_POOL_SIZE,
                 .procname = "pmr_pool_size",
@@ -863,6 +863,7 @@ lnet_post_send_locked(lnet_msg_t *msg, int do_send)
 
                 if (lp->lp_txcredits < 0) {
 			msg->msg_tx_delayed = 1;
+			msg->msg_tx_delay_usec = lnet_time_usec();
                         cfs_list_add_tail(&msg->msg_list, &lp->lp_txq);
                         return EAGAIN;
                 }
@@ -880,11 +881,19 @@ lnet_post_send_locked(lnet_msg_t *msg, int do_send)
 
 		if (tq->tq_credits < 0) {
 			msg->msg_tx_delayed = 1;
+			if (msg->msg_tx_delay_usec == 0)
+				msg->msg_tx_delay_usec = lnet_time_usec();
 			cfs_list_add_tail(&msg->msg_list, &tq->tq_delayed);
 			return EAGAIN;
 		}
 	}
 
+	/* it's going to the LND right after the lock is dropped */
+	msg->msg_tx_send_usec = lnet_time_usec();
+	lp->lp_tx_inflight++;
+	if (lp->lp_tx_inflight > lp->lp_tx_inflight_max)
+		lp->lp_tx_inflight_max = lp->lp_tx_inflight;
+
 	if (do_send) {
 		lnet_net_unlock(cpt);
 		lnet_ni_send(ni, msg);
@@ -150,6 +150,7 @@ lnet_msg_commit(lnet_msg_t *msg, int cpt)
 
 		msg->msg_tx_cpt = cpt;
 		msg->msg_tx_committed = 1;
+		msg->msg_tx_commit_usec = lnet_time_usec();
 		if (msg->msg_rx_committed) { /* routed message REPLY */
 			LASSERT(msg->msg_onactivelist);
 			return;
@@ -169,6 +170,59 @@ lnet_msg_commit(lnet_msg_t *msg, int cpt)
 		counters->msgs_max = counters->msgs_alloc;
 }
 
+static inline __u64
+lnet_usec_diff(__u64 end, __u64 start)
+{
+	/* wall-clock can step backwards, count it as no time */
+	return end > start ? end - start : 0;
+}
+
+static void
+lnet_latency_add(lnet_latency_t *lat, int type, __u64 usec)
+{
+	__u64	v = usec;
+	int	i;
+
+	/* bucket 0 is [0, 2) usec, bucket i is [2^i, 2^(i+1)) usec */
+	for (i = 0; v > 1 && i < LNET_LAT_BUCKETS - 1; i++)
+		v >>= 1;
+
+	lat->la_hist[type][i]++;
+	lat->la_count[type]++;
+	lat->la_usec[type] += usec;
+}
+
+/* Account a message which has been handed to the LND, both the NI
+ * TX queue and the peer belong to msg_tx_cpt so its lock covers them */
+static void
+lnet_msg_tx_latency(lnet_msg_t *msg, int status)
+{
+	lnet_peer_t		*lp = msg->msg_txpeer;
+	struct lnet_tx_queue	*tq = lp->lp_ni->ni_tx_queues[msg->msg_tx_cpt];
+	__u64			send = msg->msg_tx_send_usec;
+	__u64			usec;
+
+	LASSERT(lp->lp_tx_inflight > 0);
+	lp->lp_tx_inflight--;
+
+	if (status != 0)
+		return;
+
+	usec = lnet_usec_diff(send, msg->msg_tx_commit_usec);
+	lnet_latency_add(&tq->tq_latency, LNET_LAT_QUEUE, usec);
+	lnet_latency_add(&lp->lp_latency, LNET_LAT_QUEUE, usec);
+
+	if (msg->msg_tx_delay_usec != 0) {
+		usec = lnet_usec_diff(send, msg->msg_tx_delay_usec);
+		lnet_latency_add(&tq->tq_latency, LNET_LAT_CREDIT, usec);
+		lnet_latency_add(&lp->lp_latency, LNET_LAT_CREDIT, usec);
+	}
+
+	usec = lnet_usec_diff(lnet_time_usec(), send);
+	lnet_latency_add(&tq->tq_latency, LNET_LAT_WIRE, usec);
+	lnet_latency_add(&lp->lp_latency, LNET_LAT_WIRE, usec);
+}
+
 static void
 lnet_msg_decommit_tx(lnet_msg_t *msg, int status)
 {
@@ -176,6 +230,10 @@ lnet_msg_decommit_tx(lnet_msg_t *msg, int status)
 	lnet_event_t	*ev = &msg->msg_ev;
 
 	LASSERT(msg->msg_tx_committed);
+
+	if (msg->msg_tx_send_usec != 0)
+		lnet_msg_tx_latency(msg, status);
+
 	if (status != 0)
 		goto out;
 
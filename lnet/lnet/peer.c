@@ -335,3 +335,33 @@ lnet_debug_peer(lnet_nid_t nid)
 
 	lnet_net_unlock(cpt);
 }
+
+void
+lnet_latency_reset(void)
+{
+	struct lnet_peer_table	*ptable;
+	lnet_peer_t		*lp;
+	lnet_ni_t		*ni;
+	int			i;
+	int			j;
+
+	cfs_percpt_for_each(ptable, i, the_lnet.ln_peer_tables) {
+		lnet_net_lock(i);
+
+		cfs_list_for_each_entry(ni, &the_lnet.ln_nis, ni_list) {
+			memset(&ni->ni_tx_queues[i]->tq_latency, 0,
+			       sizeof(lnet_latency_t));
+		}
+
+		for (j = 0; j < LNET_PEER_HASH_SIZE; j++) {
+			cfs_list_for_each_entry(lp, &ptable->pt_hash[j],
+						lp_hashlist) {
+				memset(&lp->lp_latency, 0,
+				       sizeof(lnet_latency_t));
+				lp->lp_tx_inflight_max = lp->lp_tx_inflight;
+			}
+		}
+
+		lnet_net_unlock(i);
+	}
+}
@@ -42,6 +42,8 @@ enum {
         PSDEV_LNET_BUFFERS,
         PSDEV_LNET_NIS,
 	PSDEV_LNET_PTL_ROTOR,
+	PSDEV_LNET_NIS_LATENCY,
+	PSDEV_LNET_PEERS_LATENCY,
 };
 #else
 #define CTL_LNET           CTL_UNNUMBERED
@@ -52,6 +54,8 @@ enum {
 #define PSDEV_LNET_BUFFERS CTL_UNNUMBERED
 #define PSDEV_LNET_NIS     CTL_UNNUMBERED
 #define PSDEV_LNET_PTL_ROTOR	CTL_UNNUMBERED
+#define PSDEV_LNET_NIS_LATENCY	CTL_UNNUMBERED
+#define PSDEV_LNET_PEERS_LATENCY	CTL_UNNUMBERED
 #endif
 
 #define LNET_LOFFT_BITS		(sizeof(loff_t) * 8)
@@ -413,6 +417,59 @@ int LL_PROC_PROTO(proc_lnet_routers)
         return rc;
 }
 
+/* Return the peer at position (*hash, *hoff) of \a ptable and advance
+ * the position past it, or NULL if the table has been drained */
+static lnet_peer_t *
+lnet_proc_peer_next_locked(struct lnet_peer_table *ptable,
+			   int *hashp, int *hoffp)
+{
+	lnet_peer_t	*peer = NULL;
+	cfs_list_t	*p = NULL;
+	int		hash = *hashp;
+	int		hoff = *hoffp;
+	int		skip = hoff - 1;
+
+	while (hash < LNET_PEER_HASH_SIZE) {
+		if (p == NULL)
+			p = ptable->pt_hash[hash].next;
+
+		while (p != &ptable->pt_hash[hash]) {
+			lnet_peer_t *lp = cfs_list_entry(p, lnet_peer_t,
+							 lp_hashlist);
+			if (skip == 0) {
+				peer = lp;
+
+				/* minor optimization: start from idx+1
+				 * on next iteration if we've just
+				 * drained lp_hashlist */
+				if (lp->lp_hashlist.next ==
+				    &ptable->pt_hash[hash]) {
+					hoff = 1;
+					hash++;
+				} else {
+					hoff++;
+				}
+
+				break;
+			}
+
+			skip--;
+			p = lp->lp_hashlist.next;
+		}
+
+		if (peer != NULL)
+			break;
+
+		p = NULL;
+		hoff = 1;
+		hash++;
+	}
+
+	*hashp = hash;
+	*hoffp = hoff;
+	return peer;
+}
+
 int LL_PROC_PROTO(proc_lnet_peers)
 {
 	const int		tmpsiz  = 256;
@@ -453,13 +510,7 @@ int LL_PROC_PROTO(proc_lnet_peers)
 		hoff++;
 	} else {
 		struct lnet_peer	*peer;
-		cfs_list_t		*p;
-		int			skip;
  again:
-		p = NULL;
-		peer = NULL;
-		skip = hoff - 1;
-
 		lnet_net_lock(cpt);
 		ptable = the_lnet.ln_peer_tables[cpt];
 		if (hoff == 1)
@@ -471,42 +522,7 @@ int LL_PROC_PROTO(proc_lnet_peers)
 			return -ESTALE;
 		}
 
-		while (hash < LNET_PEER_HASH_SIZE) {
-			if (p == NULL)
-				p = ptable->pt_hash[hash].next;
-
-			while (p != &ptable->pt_hash[hash]) {
-                                lnet_peer_t *lp = cfs_list_entry(p, lnet_peer_t,
-                                                                 lp_hashlist);
-                                if (skip == 0) {
-                                        peer = lp;
-
-                                        /* minor optimization: start from idx+1
-                                         * on next iteration if we've just
-                                         * drained lp_hashlist */
-					if (lp->lp_hashlist.next ==
-					    &ptable->pt_hash[hash]) {
-						hoff = 1;
-						hash++;
-					} else {
-						hoff++;
-                                        }
-
-                                        break;
-                                }
-
-                                skip--;
-                                p = lp->lp_hashlist.next;
-                        }
-
-                        if (peer != NULL)
-                                break;
-
-                        p = NULL;
-			hoff = 1;
-			hash++;
-                }
-
+		peer = lnet_proc_peer_next_locked(ptable, &hash, &hoff);
                 if (peer != NULL) {
                         lnet_nid_t nid       = peer->lp_nid;
                         int        nrefs     = peer->lp_refcount;
@@ -759,6 +775,253 @@ int LL_PROC_PROTO(proc_lnet_nis)
         return rc;
 }
 
+static const char *lnet_latency_names[LNET_LAT_NTYPES] = {
+	[LNET_LAT_QUEUE]	= "queue",
+	[LNET_LAT_CREDIT]	= "credit",
+	[LNET_LAT_WIRE]		= "wire",
+};
+
+/* "total_us" over "count" is the mean, the remaining columns are the
+ * histogram, headed by the lower bound (usec) of each log2 bucket */
+static char *
+lnet_proc_latency_header(char *s, char *end)
+{
+	int	i;
+
+	s += snprintf(s, end - s, " %10s %14s", "count", "total_us");
+	for (i = 0; i < LNET_LAT_BUCKETS; i++)
+		s += snprintf(s, end - s, " %u", i == 0 ? 0 : 1U << i);
+	s += snprintf(s, end - s, "\n");
+	LASSERT(end - s > 0);
+
+	return s;
+}
+
+static char *
+lnet_proc_latency_line(char *s, char *end, lnet_latency_t *lat, int type)
+{
+	int	i;
+
+	s += snprintf(s, end - s, " %-6s %10"LPF64"u %14"LPF64"u",
+		      lnet_latency_names[type], lat->la_count[type],
+		      lat->la_usec[type]);
+	for (i = 0; i < LNET_LAT_BUCKETS; i++)
+		s += snprintf(s, end - s, " %u", lat->la_hist[type][i]);
+	s += snprintf(s, end - s, "\n");
+	LASSERT(end - s > 0);
+
+	return s;
+}
+
+int LL_PROC_PROTO(proc_lnet_nis_latency)
+{
+	const int	tmpsiz = 384 * (LNET_LAT_NTYPES + 1);
+	int		rc = 0;
+	char		*tmpstr;
+	char		*s;
+	int		len;
+
+	DECLARE_LL_PROC_PPOS_DECL;
+
+	if (write) {
+		lnet_latency_reset();
+		return 0;
+	}
+
+	if (*lenp == 0)
+		return 0;
+
+	LIBCFS_ALLOC(tmpstr, tmpsiz);
+	if (tmpstr == NULL)
+		return -ENOMEM;
+
+	s = tmpstr; /* points to current position in tmpstr[] */
+
+	if (*ppos == 0) {
+		s += snprintf(s, tmpstr + tmpsiz - s, "%-24s %-6s",
+			      "nid", "type");
+		s = lnet_proc_latency_header(s, tmpstr + tmpsiz);
+	} else {
+		cfs_list_t	*n;
+		lnet_ni_t	*ni   = NULL;
+		int		skip = *ppos - 1;
+
+		lnet_net_lock(0);
+
+		n = the_lnet.ln_nis.next;
+
+		while (n != &the_lnet.ln_nis) {
+			lnet_ni_t *a_ni = cfs_list_entry(n, lnet_ni_t, ni_list);
+
+			if (skip == 0) {
+				ni = a_ni;
+				break;
+			}
+
+			skip--;
+			n = n->next;
+		}
+
+		if (ni != NULL) {
+			struct lnet_tx_queue	*tq;
+			lnet_latency_t		lat;
+			int			i;
+			int			j;
+			int			k;
+
+			memset(&lat, 0, sizeof(lat));
+
+			/* sum up TX queues of all partitions */
+			cfs_percpt_for_each(tq, i, ni->ni_tx_queues) {
+				if (i != 0)
+					lnet_net_lock(i);
+
+				for (j = 0; j < LNET_LAT_NTYPES; j++) {
+					lat.la_count[j] +=
+						tq->tq_latency.la_count[j];
+					lat.la_usec[j] +=
+						tq->tq_latency.la_usec[j];
+					for (k = 0; k < LNET_LAT_BUCKETS; k++)
+						lat.la_hist[j][k] +=
+						tq->tq_latency.la_hist[j][k];
+				}
+
+				if (i != 0)
+					lnet_net_unlock(i);
+			}
+
+			for (j = 0; j < LNET_LAT_NTYPES; j++) {
+				s += snprintf(s, tmpstr + tmpsiz - s, "%-24s",
+					      libcfs_nid2str(ni->ni_nid));
+				s = lnet_proc_latency_line(s, tmpstr + tmpsiz,
+							   &lat, j);
+			}
+		}
+
+		lnet_net_unlock(0);
+	}
+
+	len = s - tmpstr;     /* how many bytes was written */
+
+	if (len > *lenp) {    /* linux-supplied buffer is too small */
+		rc = -EINVAL;
+	} else if (len > 0) { /* wrote something */
+		if (cfs_copy_to_user(buffer, tmpstr, len))
+			rc = -EFAULT;
+		else
+			*ppos += 1;
+	}
+
+	LIBCFS_FREE(tmpstr, tmpsiz);
+
+	if (rc == 0)
+		*lenp = len;
+
+	return rc;
+}
+
+int LL_PROC_PROTO(proc_lnet_peers_latency)
+{
+	const int		tmpsiz = 384 * (LNET_LAT_NTYPES + 1);
+	struct lnet_peer_table	*ptable;
+	char			*tmpstr;
+	char			*s;
+	int			cpt  = LNET_PROC_CPT_GET(*ppos);
+	int			ver  = LNET_PROC_VER_GET(*ppos);
+	int			hash = LNET_PROC_HASH_GET(*ppos);
+	int			hoff = LNET_PROC_HOFF_GET(*ppos);
+	int			rc = 0;
+	int			len;
+
+	if (write) {
+		lnet_latency_reset();
+		return 0;
+	}
+
+	if (*lenp == 0)
+		return 0;
+
+	if (cpt >= LNET_CPT_NUMBER) {
+		*lenp = 0;
+		return 0;
+	}
+
+	LIBCFS_ALLOC(tmpstr, tmpsiz);
+	if (tmpstr == NULL)
+		return -ENOMEM;
+
+	s = tmpstr; /* points to current position in tmpstr[] */
+
+	if (*ppos == 0) {
+		s += snprintf(s, tmpstr + tmpsiz - s, "%-24s %8s %8s %-6s",
+			      "nid", "inflight", "max", "type");
+		s = lnet_proc_latency_header(s, tmpstr + tmpsiz);
+
+		hoff++;
+	} else {
+		struct lnet_peer	*peer;
+ again:
+		lnet_net_lock(cpt);
+		ptable = the_lnet.ln_peer_tables[cpt];
+		if (hoff == 1)
+			ver = LNET_PROC_VERSION(ptable->pt_version);
+
+		if (ver != LNET_PROC_VERSION(ptable->pt_version)) {
+			lnet_net_unlock(cpt);
+			LIBCFS_FREE(tmpstr, tmpsiz);
+			return -ESTALE;
+		}
+
+		peer = lnet_proc_peer_next_locked(ptable, &hash, &hoff);
+		if (peer != NULL) {
+			lnet_latency_t	lat = peer->lp_latency;
+			lnet_nid_t	nid = peer->lp_nid;
+			int		inflight = peer->lp_tx_inflight;
+			int		inflight_max = peer->lp_tx_inflight_max;
+			int		i;
+
+			lnet_net_unlock(cpt);
+
+			for (i = 0; i < LNET_LAT_NTYPES; i++) {
+				s += snprintf(s, tmpstr + tmpsiz - s,
+					      "%-24s %8d %8d",
+					      libcfs_nid2str(nid), inflight,
+					      inflight_max);
+				s = lnet_proc_latency_line(s, tmpstr + tmpsiz,
+							   &lat, i);
+			}
+		} else { /* peer is NULL */
+			lnet_net_unlock(cpt);
+		}
+
+		if (hash == LNET_PEER_HASH_SIZE) {
+			cpt++;
+			hash = 0;
+			hoff = 1;
+			if (peer == NULL && cpt < LNET_CPT_NUMBER)
+				goto again;
+		}
+	}
+
+	len = s - tmpstr;     /* how many bytes was written */
+
+	if (len > *lenp) {    /* linux-supplied buffer is too small */
+		rc = -EINVAL;
+	} else if (len > 0) { /* wrote something */
+		if (cfs_copy_to_user(buffer, tmpstr, len))
+			rc = -EFAULT;
+		else
+			*ppos = LNET_PROC_POS_MAKE(cpt, ver, hash, hoff);
+	}
+
+	LIBCFS_FREE(tmpstr, tmpsiz);
+
+	if (rc == 0)
+		*lenp = len;
+
+	return rc;
+}
+
 struct lnet_portal_rotors {
 	int             pr_value;
 	const char      *pr_name;
@@ -907,6 +1170,18 @@ static cfs_sysctl_table_t lnet_table[] = {
 		.mode     = 0644,
 		.proc_handler = &proc_lnet_portal_rotor,
 	},
+	{
+		INIT_CTL_NAME(PSDEV_LNET_NIS_LATENCY)
+		.procname = "nis_latency",
+		.mode     = 0644,
+		.proc_handler = &proc_lnet_nis_latency,
+	},
+	{
+		INIT_CTL_NAME(PSDEV_LNET_PEERS_LATENCY)
+		.procname = "peers_latency",
+		.mode     = 0644,
+		.proc_handler = &proc_lnet_peers_latency,
+	},
 	{
 		INIT_CTL_NAME(0)
 	}
@@ -65,6 +65,69 @@ brw_client_fini (sfw_test_instance_t *tsi)
         }
 }
 
+/* sizes of a distribution must be within (0, blk_len] */
+static int
+brw_check_dist(test_bulk_req_v2_t *breq)
+{
+	int i;
+
+	switch (breq->blk_dist) {
+	case LST_BULK_DIST_FIXED:
+		return 0;
+
+	case LST_BULK_DIST_UNIFORM:
+		if (breq->blk_nlens != 2 ||
+		    breq->blk_lens[0] > breq->blk_lens[1])
+			return -EINVAL;
+		break;
+
+	case LST_BULK_DIST_MIXED:
+		if (breq->blk_nlens == 0 ||
+		    breq->blk_nlens > LST_BULK_MAX_SIZES)
+			return -EINVAL;
+		break;
+
+	default:
+		return -EINVAL;
+	}
+
+	for (i = 0; i < breq->blk_nlens; i++) {
+		if (breq->blk_lens[i] == 0 ||
+		    breq->blk_lens[i] > breq->blk_len)
+			return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* pick the length of the next RPC from the size distribution */
+static int
+brw_dist_len(test_bulk_req_v2_t *breq)
+{
+	__u32 len;
+
+	switch (breq->blk_dist) {
+	default:
+		LBUG();
+	case LST_BULK_DIST_FIXED:
+		return breq->blk_len;
+
+	case LST_BULK_DIST_MIXED:
+		return breq->blk_lens[cfs_rand() % breq->blk_nlens];
+
+	case LST_BULK_DIST_UNIFORM:
+		len = breq->blk_lens[0] +
+		      cfs_rand() % (breq->blk_lens[1] - breq->blk_lens[0] + 1);
+		/* data check works on whole pages */
+		if (breq->blk_flags != LST_BRW_CHECK_NONE) {
+			len = (len + CFS_PAGE_SIZE - 1) & CFS_PAGE_MASK;
+			if (len > breq->blk_len)
+				len = breq->blk_len;
+		}
+		return len;
+	}
+}
+
 int
 brw_client_init (sfw_test_instance_t *tsi)
 {
@@ -105,6 +168,10 @@ brw_client_init (sfw_test_instance_t *tsi)
 	if (npg > LNET_MAX_IOV || npg <= 0)
 		return -EINVAL;
 
+	if ((sn->sn_features & LST_FEAT_BULK_DIST) != 0 &&
+	    brw_check_dist(&tsi->tsi_u.bulk_v2) != 0)
+		return -EINVAL;
+
 	if (opc != LST_BRW_READ && opc != LST_BRW_WRITE)
 		return -EINVAL;
 
@@ -220,12 +287,12 @@ bad_data:
 }
 
 void
-brw_fill_bulk (srpc_bulk_t *bk, int pattern, __u64 magic)
+brw_fill_bulk (srpc_bulk_t *bk, int npg, int pattern, __u64 magic)
 {
         int         i;
         cfs_page_t *pg;
 
-        for (i = 0; i < bk->bk_niov; i++) {
+        for (i = 0; i < npg; i++) {
 #ifdef __KERNEL__
                 pg = bk->bk_iovs[i].kiov_page;
 #else
@@ -237,12 +304,12 @@ brw_fill_bulk (srpc_bulk_t *bk, int pattern, __u64 magic)
 }
 
 int
-brw_check_bulk (srpc_bulk_t *bk, int pattern, __u64 magic)
+brw_check_bulk (srpc_bulk_t *bk, int npg, int pattern, __u64 magic)
 {
         int         i;
         cfs_page_t *pg;
 
-        for (i = 0; i < bk->bk_niov; i++) {
+        for (i = 0; i < npg; i++) {
 #ifdef __KERNEL__
                 pg = bk->bk_iovs[i].kiov_page;
 #else
@@ -303,10 +370,18 @@ brw_client_prep_rpc (sfw_test_unit_t *tsu,
 		return rc;
 
 	memcpy(&rpc->crpc_bulk, bulk, offsetof(srpc_bulk_t, bk_iovs[npg]));
+
+	/* bulk is sized for the max length, only the chosen length is
+	 * transferred by the server */
+	if ((sn->sn_features & LST_FEAT_BULK_DIST) != 0) {
+		len = brw_dist_len(&tsi->tsi_u.bulk_v2);
+		npg = (len + CFS_PAGE_SIZE - 1) >> CFS_PAGE_SHIFT;
+	}
+
 	if (opc == LST_BRW_WRITE)
-		brw_fill_bulk(&rpc->crpc_bulk, flags, BRW_MAGIC);
+		brw_fill_bulk(&rpc->crpc_bulk, npg, flags, BRW_MAGIC);
 	else
-		brw_fill_bulk(&rpc->crpc_bulk, flags, BRW_POISON);
+		brw_fill_bulk(&rpc->crpc_bulk, npg, flags, BRW_POISON);
 
 	req = &rpc->crpc_reqstmsg.msg_body.brw_reqst;
 	req->brw_flags = flags;
@@ -354,7 +429,9 @@ brw_client_done_rpc (sfw_test_unit_t *tsu, srpc_client_rpc_t *rpc)
 
         if (reqst->brw_rw == LST_BRW_WRITE) goto out;
 
-        if (brw_check_bulk(&rpc->crpc_bulk, reqst->brw_flags, magic) != 0) {
+        if (brw_check_bulk(&rpc->crpc_bulk,
+                           (reqst->brw_len + CFS_PAGE_SIZE - 1) >>
+                           CFS_PAGE_SHIFT, reqst->brw_flags, magic) != 0) {
                 CERROR ("Bulk data from %s is corrupted!\n",
                         libcfs_id2str(rpc->crpc_dest));
                 cfs_atomic_inc(&sn->sn_brw_errors);
@@ -414,7 +491,8 @@ brw_bulk_ready (srpc_server_rpc_t *rpc, int status)
         if (reqstmsg->msg_magic != SRPC_MSG_MAGIC)
                 __swab64s(&magic);
 
-        if (brw_check_bulk(rpc->srpc_bulk, reqst->brw_flags, magic) != 0) {
+        if (brw_check_bulk(rpc->srpc_bulk, rpc->srpc_bulk->bk_niov,
+                           reqst->brw_flags, magic) != 0) {
                 CERROR ("Bulk data from %s is corrupted!\n",
                         libcfs_id2str(rpc->srpc_peer));
                 reply->brw_status = EBADMSG;
@@ -490,9 +568,11 @@ brw_server_handle(struct srpc_server_rpc *rpc)
 		return rc;
 
         if (reqst->brw_rw == LST_BRW_READ)
-                brw_fill_bulk(rpc->srpc_bulk, reqst->brw_flags, BRW_MAGIC);
+                brw_fill_bulk(rpc->srpc_bulk, rpc->srpc_bulk->bk_niov,
+                              reqst->brw_flags, BRW_MAGIC);
         else
-                brw_fill_bulk(rpc->srpc_bulk, reqst->brw_flags, BRW_POISON);
+                brw_fill_bulk(rpc->srpc_bulk, rpc->srpc_bulk->bk_niov,
+                              reqst->brw_flags, BRW_POISON);
 
         return 0;
 }
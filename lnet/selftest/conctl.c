@@ -746,6 +746,7 @@ int lst_test_add_ioctl(lstio_test_args_t *args)
 
 	if (args->lstio_tes_loop == 0 || /* negative is infinite */
 	    args->lstio_tes_concur <= 0 ||
+	    args->lstio_tes_ramp < 0 ||
 	    args->lstio_tes_dist <= 0 ||
 	    args->lstio_tes_span <= 0)
 		return -EINVAL;
@@ -792,6 +793,7 @@ int lst_test_add_ioctl(lstio_test_args_t *args)
                             args->lstio_tes_type,
                             args->lstio_tes_loop,
                             args->lstio_tes_concur,
+                            args->lstio_tes_ramp,
                             args->lstio_tes_dist, args->lstio_tes_span,
                             srcgrp, dstgrp, param, args->lstio_tes_param_len,
                             &ret, args->lstio_tes_resultp);
@@ -817,6 +817,25 @@ lstcon_bulkrpc_v1_prep(lst_test_bulk_param_t *param, srpc_test_reqst_t *req)
 	return 0;
 }
 
+int
+lstcon_bulkrpc_v2_prep(lst_test_bulk_param_t *param, srpc_test_reqst_t *req)
+{
+	test_bulk_req_v2_t *brq = &req->tsr_u.bulk_v2;
+	int		    i;
+
+	brq->blk_opc	= param->blk_opc;
+	brq->blk_flags	= param->blk_flags;
+	brq->blk_len	= param->blk_size;
+	brq->blk_offset	= 0; /* reserved */
+	brq->blk_dist	= param->blk_dist;
+	brq->blk_nlens	= param->blk_nsizes;
+
+	for (i = 0; i < LST_BULK_MAX_SIZES; i++)
+		brq->blk_lens[i] = param->blk_sizes[i];
+
+	return 0;
+}
+
 int
 lstcon_testrpc_prep(lstcon_node_t *nd, int transop, unsigned feats,
                     lstcon_test_t *test, lstcon_rpc_t **crpc)
@@ -897,6 +916,7 @@ lstcon_testrpc_prep(lstcon_node_t *nd, int transop, unsigned feats,
         trq->tsr_concur     = test->tes_concur;
         trq->tsr_is_client  = (transop == LST_TRANS_TSBCLIADD) ? 1 : 0;
         trq->tsr_stop_onerr = !!test->tes_stop_onerr;
+	trq->tsr_ramp	    = test->tes_ramp;
 
         switch (test->tes_type) {
         case LST_TEST_PING:
@@ -910,6 +930,9 @@ lstcon_testrpc_prep(lstcon_node_t *nd, int transop, unsigned feats,
 		if ((feats & LST_FEAT_BULK_LEN) == 0) {
 			rc = lstcon_bulkrpc_v0_prep((lst_test_bulk_param_t *)
 						    &test->tes_param[0], trq);
+		} else if ((feats & LST_FEAT_BULK_DIST) != 0) {
+			rc = lstcon_bulkrpc_v2_prep((lst_test_bulk_param_t *)
+						    &test->tes_param[0], trq);
 		} else {
 			rc = lstcon_bulkrpc_v1_prep((lst_test_bulk_param_t *)
 						    &test->tes_param[0], trq);
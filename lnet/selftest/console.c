@@ -1248,7 +1248,7 @@ again:
 }
 
 int
-lstcon_test_add(char *name, int type, int loop, int concur,
+lstcon_test_add(char *name, int type, int loop, int concur, int ramp,
                 int dist, int span, char *src_name, char * dst_name,
                 void *param, int paramlen, int *retp,
                 cfs_list_t *result_up)
@@ -1302,6 +1302,7 @@ lstcon_test_add(char *name, int type, int loop, int concur,
         test->tes_concur        = concur;
         test->tes_stop_onerr    = 1; /* TODO */
         test->tes_span          = span;
+        test->tes_ramp          = ramp;
         test->tes_dist          = dist;
         test->tes_cliidx        = 0; /* just used for creating RPC */
         test->tes_src_grp       = src_grp;
@@ -1373,6 +1374,18 @@ lstcon_tsbrpc_readent(int transop, srpc_msg_t *msg,
                              &rep->bar_active, sizeof(rep->bar_active)))
                 return -EFAULT;
 
+	if ((console_session.ses_features & LST_FEAT_BULK_DIST) == 0)
+		return 0;
+
+	/* latency percentiles (usec) follow the active count */
+	if (cfs_copy_to_user(&ent_up->rpe_priv[1],
+			     &rep->bar_lat_p50, sizeof(rep->bar_lat_p50)) ||
+	    cfs_copy_to_user(&ent_up->rpe_priv[2],
+			     &rep->bar_lat_p99, sizeof(rep->bar_lat_p99)) ||
+	    cfs_copy_to_user(&ent_up->rpe_priv[3],
+			     &rep->bar_lat_p999, sizeof(rep->bar_lat_p999)))
+		return -EFAULT;
+
         return 0;
 }
 
@@ -115,6 +115,7 @@ typedef struct lstcon_test {
         int                   tes_loop;       /* loop count */
         int                   tes_dist;       /* nodes distribution of target group */
         int                   tes_span;       /* nodes span of target group */
+        int                   tes_ramp;       /* seconds to start all test units */
         int                   tes_cliidx;     /* client index, used for RPC creating */
 
         cfs_list_t  tes_trans_list; /* transaction list */
@@ -226,7 +227,8 @@ extern int lstcon_group_stat(char *grp_name, int timeout,
 extern int lstcon_nodes_stat(int count, lnet_process_id_t *ids_up,
                              int timeout, cfs_list_t *result_up);
 extern int lstcon_test_add(char *name, int type, int loop, int concur,
-                           int dist, int span, char *src_name, char * dst_name,
+                           int ramp, int dist, int span,
+                           char *src_name, char * dst_name,
                            void *param, int paramlen, int *retp,
                            cfs_list_t *result_up);
 #endif
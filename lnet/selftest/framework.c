@@ -725,13 +725,26 @@ sfw_unpack_addtest_req(srpc_msg_t *msg)
 			__swab32s(&bulk->blk_npg);
 			__swab32s(&bulk->blk_flags);
 
-		} else {
+		} else if ((msg->msg_ses_feats & LST_FEAT_BULK_DIST) == 0) {
 			test_bulk_req_v1_t *bulk = &req->tsr_u.bulk_v1;
 
 			__swab16s(&bulk->blk_opc);
 			__swab16s(&bulk->blk_flags);
 			__swab32s(&bulk->blk_offset);
 			__swab32s(&bulk->blk_len);
+
+		} else {
+			test_bulk_req_v2_t *bulk = &req->tsr_u.bulk_v2;
+			int		    i;
+
+			__swab16s(&bulk->blk_opc);
+			__swab16s(&bulk->blk_flags);
+			__swab32s(&bulk->blk_offset);
+			__swab32s(&bulk->blk_len);
+			__swab16s(&bulk->blk_dist);
+			__swab16s(&bulk->blk_nlens);
+			for (i = 0; i < LST_BULK_MAX_SIZES; i++)
+				__swab32s(&bulk->blk_lens[i]);
 		}
 
 		return;
@@ -749,6 +762,15 @@ sfw_unpack_addtest_req(srpc_msg_t *msg)
         return;
 }
 
+/* ramp-up timer of a test unit */
+static void
+sfw_test_unit_start(void *arg)
+{
+	sfw_test_unit_t *tsu = arg;
+
+	swi_schedule_workitem(&tsu->tsu_worker);
+}
+
 int
 sfw_add_test_instance (sfw_batch_t *tsb, srpc_server_rpc_t *rpc)
 {
@@ -782,6 +804,8 @@ sfw_add_test_instance (sfw_batch_t *tsb, srpc_server_rpc_t *rpc)
         tsi->tsi_service       = req->tsr_service;
         tsi->tsi_is_client     = !!(req->tsr_is_client);
         tsi->tsi_stoptsu_onerr = !!(req->tsr_stop_onerr);
+	if ((msg->msg_ses_feats & LST_FEAT_BULK_DIST) != 0)
+		tsi->tsi_ramp = req->tsr_ramp;
 
         rc = sfw_load_test(tsi);
         if (rc != 0) {
@@ -836,6 +860,9 @@ sfw_add_test_instance (sfw_batch_t *tsb, srpc_server_rpc_t *rpc)
                         tsu->tsu_dest.pid = id.pid;
                         tsu->tsu_instance = tsi;
                         tsu->tsu_private  = NULL;
+			CFS_INIT_LIST_HEAD(&tsu->tsu_timer.stt_list);
+			tsu->tsu_timer.stt_func = sfw_test_unit_start;
+			tsu->tsu_timer.stt_data = tsu;
                         cfs_list_add_tail(&tsu->tsu_list, &tsi->tsi_units);
                 }
         }
@@ -896,6 +923,94 @@ sfw_test_unit_done (sfw_test_unit_t *tsu)
 	return;
 }
 
+static __u64
+sfw_time_usec(void)
+{
+	struct timeval tv;
+
+	cfs_gettimeofday(&tv);
+	return (__u64)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static int
+sfw_latency_bucket(__u64 usec)
+{
+	__u32 val = usec > ~0U ? ~0U : (__u32)usec;
+	int   msb = SFW_LAT_SUBBITS;
+
+	if (val < (1 << SFW_LAT_SUBBITS))
+		return val;
+
+	while (msb < 31 && (val >> (msb + 1)) != 0)
+		msb++;
+
+	return ((msb - SFW_LAT_SUBBITS + 1) << SFW_LAT_SUBBITS) |
+	       ((val >> (msb - SFW_LAT_SUBBITS)) &
+		((1 << SFW_LAT_SUBBITS) - 1));
+}
+
+/* middle of the range of values in bucket @idx */
+static __u32
+sfw_latency_value(int idx)
+{
+	int grp = idx >> SFW_LAT_SUBBITS;
+	int sub = idx & ((1 << SFW_LAT_SUBBITS) - 1);
+
+	if (grp == 0)
+		return idx;
+
+	return (((1 << SFW_LAT_SUBBITS) + sub) << (grp - 1)) +
+	       ((1 << (grp - 1)) >> 1);
+}
+
+/* Latency of test RPCs in the whole batch (testidx == 0) or in one test,
+ * returns the value at @ppm parts per million of all samples. Counters
+ * are read without tsi_lock, it's fine for statistics. */
+static __u32
+sfw_latency_percentile(sfw_batch_t *tsb, int testidx, __u32 ppm)
+{
+	sfw_test_instance_t *tsi;
+	__u64		     total = 0;
+	__u64		     rank;
+	__u64		     sum = 0;
+	int		     last = 0;
+	int		     idx;
+	int		     i = 0;
+
+	cfs_list_for_each_entry_typed(tsi, &tsb->bat_tests,
+				      sfw_test_instance_t, tsi_list) {
+		if (testidx == 0 || testidx == ++i)
+			total += tsi->tsi_latency.sl_count;
+	}
+
+	if (total == 0)
+		return 0;
+
+	/* rank = ceil(total * ppm / 10^6) */
+	rank = total * ppm + 999999;
+	do_div(rank, 1000000);
+
+	for (idx = 0; idx < SFW_LAT_NBUCKETS; idx++) {
+		i = 0;
+		cfs_list_for_each_entry_typed(tsi, &tsb->bat_tests,
+					      sfw_test_instance_t, tsi_list) {
+			if (testidx != 0 && testidx != ++i)
+				continue;
+
+			if (tsi->tsi_latency.sl_hist[idx] == 0)
+				continue;
+
+			sum += tsi->tsi_latency.sl_hist[idx];
+			last = idx;
+		}
+
+		if (sum >= rank)
+			break;
+	}
+
+	return sfw_latency_value(last);
+}
+
 void
 sfw_test_rpc_done (srpc_client_rpc_t *rpc)
 {
@@ -912,6 +1027,15 @@ sfw_test_rpc_done (srpc_client_rpc_t *rpc)
 
         cfs_list_del_init(&rpc->crpc_list);
 
+	if (rpc->crpc_status == 0) {
+		__u64 now = sfw_time_usec();
+
+		tsi->tsi_latency.sl_count++;
+		tsi->tsi_latency.sl_hist[sfw_latency_bucket(
+			now > tsu->tsu_rpc_start ?
+			now - tsu->tsu_rpc_start : 0)]++;
+	}
+
         /* batch is stopping or loop is done or get error */
         if (tsi->tsi_stopping ||
             tsu->tsu_loop == 0 ||
@@ -1006,6 +1130,7 @@ sfw_run_test (swi_workitem_t *wi)
 	spin_unlock(&tsi->tsi_lock);
 
 	rpc->crpc_timeout = rpc_timeout;
+	tsu->tsu_rpc_start = sfw_time_usec();
 
 	spin_lock(&rpc->crpc_lock);
 	srpc_post_rpc(rpc);
@@ -1031,6 +1156,8 @@ sfw_run_batch (sfw_batch_t *tsb)
         swi_workitem_t      *wi;
         sfw_test_unit_t     *tsu;
         sfw_test_instance_t *tsi;
+	int		     nunits;
+	int		     i;
 
         if (sfw_batch_active(tsb)) {
                 CDEBUG(D_NET, "Batch already active: "LPU64" (%d)\n",
@@ -1047,16 +1174,33 @@ sfw_run_batch (sfw_batch_t *tsb)
                 LASSERT (!sfw_test_active(tsi));
 
                 cfs_atomic_inc(&tsb->bat_nactive);
+		memset(&tsi->tsi_latency, 0, sizeof(tsi->tsi_latency));
+
+		nunits = 0;
+		cfs_list_for_each_entry_typed(tsu, &tsi->tsi_units,
+					      sfw_test_unit_t, tsu_list)
+			nunits++;
 
+		i = 0;
                 cfs_list_for_each_entry_typed (tsu, &tsi->tsi_units,
                                                sfw_test_unit_t, tsu_list) {
+			/* unit i of n starts ramp * i / n seconds later */
+			int delay = tsi->tsi_ramp * i++ / nunits;
+
                         cfs_atomic_inc(&tsi->tsi_nactive);
                         tsu->tsu_loop = tsi->tsi_loop;
                         wi = &tsu->tsu_worker;
 			swi_init_workitem(wi, tsu, sfw_run_test,
 					  lst_sched_test[\
 					  lnet_cpt_of_nid(tsu->tsu_dest.nid)]);
-                        swi_schedule_workitem(wi);
+			if (delay == 0) {
+				swi_schedule_workitem(wi);
+				continue;
+			}
+
+			tsu->tsu_timer.stt_expires =
+				cfs_time_add(delay, cfs_time_current_sec());
+			stt_add_timer(&tsu->tsu_timer);
                 }
         }
 
@@ -1067,6 +1211,7 @@ int
 sfw_stop_batch (sfw_batch_t *tsb, int force)
 {
         sfw_test_instance_t *tsi;
+        sfw_test_unit_t     *tsu;
         srpc_client_rpc_t   *rpc;
 
         if (!sfw_batch_active(tsb)) {
@@ -1086,6 +1231,13 @@ sfw_stop_batch (sfw_batch_t *tsb, int force)
 
 		tsi->tsi_stopping = 1;
 
+		/* units still waiting for ramp-up just finish */
+		cfs_list_for_each_entry_typed(tsu, &tsi->tsi_units,
+					      sfw_test_unit_t, tsu_list) {
+			if (stt_del_timer(&tsu->tsu_timer))
+				swi_schedule_workitem(&tsu->tsu_worker);
+		}
+
 		if (!force) {
 			spin_unlock(&tsi->tsi_lock);
 			continue;
@@ -1107,25 +1259,40 @@ sfw_stop_batch (sfw_batch_t *tsb, int force)
 	return 0;
 }
 
+static void
+sfw_query_latency(sfw_batch_t *tsb, int testidx, srpc_batch_reply_t *reply)
+{
+	if ((tsb->bat_session->sn_features & LST_FEAT_BULK_DIST) == 0)
+		return;
+
+	reply->bar_lat_p50  = sfw_latency_percentile(tsb, testidx, 500000);
+	reply->bar_lat_p99  = sfw_latency_percentile(tsb, testidx, 990000);
+	reply->bar_lat_p999 = sfw_latency_percentile(tsb, testidx, 999000);
+}
+
 int
 sfw_query_batch (sfw_batch_t *tsb, int testidx, srpc_batch_reply_t *reply)
 {
         sfw_test_instance_t *tsi;
+	int		     i;
 
         if (testidx < 0)
                 return -EINVAL;
 
         if (testidx == 0) {
                 reply->bar_active = cfs_atomic_read(&tsb->bat_nactive);
+		sfw_query_latency(tsb, 0, reply);
                 return 0;
         }
 
+	i = testidx;
         cfs_list_for_each_entry_typed (tsi, &tsb->bat_tests,
                                        sfw_test_instance_t, tsi_list) {
-                if (testidx-- > 1)
+                if (i-- > 1)
                         continue;
 
                 reply->bar_active = cfs_atomic_read(&tsi->tsi_nactive);
+		sfw_query_latency(tsb, testidx, reply);
                 return 0;
         }
 
@@ -1563,6 +1730,9 @@ sfw_unpack_message (srpc_msg_t *msg)
 
                 __swab32s(&rep->bar_status);
                 sfw_unpack_sid(rep->bar_sid);
+		__swab32s(&rep->bar_lat_p50);
+		__swab32s(&rep->bar_lat_p99);
+		__swab32s(&rep->bar_lat_p999);
                 return;
         }
 
@@ -1575,6 +1745,7 @@ sfw_unpack_message (srpc_msg_t *msg)
                 __swab32s(&req->tsr_ndest);
                 __swab32s(&req->tsr_concur);
                 __swab32s(&req->tsr_service);
+		__swab32s(&req->tsr_ramp);
                 sfw_unpack_sid(req->tsr_sid);
                 __swab64s(&req->tsr_bid.bat_id);
                 return;
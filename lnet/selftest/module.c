@@ -96,9 +96,10 @@ void
 lnet_selftest_structure_assertion(void)
 {
         CLASSERT(sizeof(srpc_msg_t) == 160);
-        CLASSERT(sizeof(srpc_test_reqst_t) == 70);
+        CLASSERT(sizeof(srpc_test_reqst_t) == 110);
         CLASSERT(offsetof(srpc_msg_t, msg_body.tes_reqst.tsr_concur) == 72);
         CLASSERT(offsetof(srpc_msg_t, msg_body.tes_reqst.tsr_ndest) == 78);
+        CLASSERT(offsetof(srpc_msg_t, msg_body.tes_reqst.tsr_ramp) == 130);
         CLASSERT(sizeof(srpc_stat_reply_t) == 136);
         CLASSERT(sizeof(srpc_stat_reqst_t) == 28);
 }
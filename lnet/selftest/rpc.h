@@ -157,6 +157,10 @@ typedef struct {
         lst_sid_t               bar_sid;        /* session id */
         __u32                   bar_active;     /* # of active tests in batch/test */
         __u32                   bar_time;       /* remained time */
+	/* RPC latency percentiles (usec), LST_FEAT_BULK_DIST only */
+	__u32			bar_lat_p50;
+	__u32			bar_lat_p99;
+	__u32			bar_lat_p999;
 } WIRE_ATTR srpc_batch_reply_t;
 
 typedef struct {
@@ -190,6 +194,20 @@ typedef struct {
 	__u32                   blk_offset;
 } WIRE_ATTR test_bulk_req_v1_t;
 
+typedef struct {
+	/** same layout as test_bulk_req_v1_t, blk_len is the max length */
+	__u16			blk_opc;
+	__u16			blk_flags;
+	__u32			blk_len;
+	__u32			blk_offset;
+	/** size distribution: LST_BULK_DIST_* */
+	__u16			blk_dist;
+	/** # of valid blk_lens */
+	__u16			blk_nlens;
+	/** uniform: [min, max]; mixed: lengths to pick from */
+	__u32			blk_lens[LST_BULK_MAX_SIZES];
+} WIRE_ATTR test_bulk_req_v2_t;
+
 typedef struct {
 	__u32			png_size;       /* size of ping message */
 	__u32			png_flags;      /* reserved flags */
@@ -212,7 +230,10 @@ typedef struct {
 		test_ping_req_t		ping;
 		test_bulk_req_t		bulk_v0;
 		test_bulk_req_v1_t	bulk_v1;
+		test_bulk_req_v2_t	bulk_v2;
 	}		tsr_u;
+	/* seconds to start all test units, LST_FEAT_BULK_DIST only */
+	__u32			tsr_ramp;
 } WIRE_ATTR srpc_test_reqst_t;
 
 typedef struct {
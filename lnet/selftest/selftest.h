@@ -372,6 +372,17 @@ typedef struct {
                              srpc_client_rpc_t *rpc);    /* done a test rpc */
 } sfw_test_client_ops_t;
 
+/* log-linear histogram of RPC latency in usec: values below
+ * 2^SFW_LAT_SUBBITS are exact, above that every power of 2 is split into
+ * 2^SFW_LAT_SUBBITS buckets, i.e. the error is within 12.5% */
+#define SFW_LAT_SUBBITS    3
+#define SFW_LAT_NBUCKETS   ((32 - SFW_LAT_SUBBITS + 1) << SFW_LAT_SUBBITS)
+
+typedef struct {
+        __u64             sl_count;             /* # of samples */
+        __u32             sl_hist[SFW_LAT_NBUCKETS];
+} sfw_latency_t;
+
 typedef struct sfw_test_instance {
         cfs_list_t              tsi_list;         /* chain on batch */
         int                     tsi_service;      /* test type */
@@ -383,6 +394,7 @@ typedef struct sfw_test_instance {
 	unsigned int		tsi_stoptsu_onerr:1; /* stop tsu on error */
         int                     tsi_concur;          /* concurrency */
         int                     tsi_loop;            /* loop count */
+        int                     tsi_ramp;            /* seconds to start all units */
 
 	/* status of test instance */
 	spinlock_t		tsi_lock;	  /* serialize */
@@ -396,7 +408,9 @@ typedef struct sfw_test_instance {
 		test_ping_req_t		ping;	  /* ping parameter */
 		test_bulk_req_t		bulk_v0;  /* bulk parameter */
 		test_bulk_req_v1_t	bulk_v1;  /* bulk v1 parameter */
+		test_bulk_req_v2_t	bulk_v2;  /* bulk v2 parameter */
 	} tsi_u;
+	sfw_latency_t		tsi_latency;	  /* RPC latency, tsi_lock */
 } sfw_test_instance_t;
 
 /* XXX: trailing (CFS_PAGE_SIZE % sizeof(lnet_process_id_t)) bytes at
@@ -413,6 +427,8 @@ typedef struct sfw_test_unit {
         sfw_test_instance_t  *tsu_instance;     /* pointer to test instance */
         void                 *tsu_private;      /* private data */
         swi_workitem_t        tsu_worker;       /* workitem of the test unit */
+        stt_timer_t           tsu_timer;        /* delayed start for ramp-up */
+        __u64                 tsu_rpc_start;    /* usec when RPC was posted */
 } sfw_test_unit_t;
 
 typedef struct sfw_test_case {
@@ -90,6 +90,8 @@ usocklnd_conn_allocate()
         }
         memset(conn, 0, sizeof(*conn));
         conn->uc_preq = pr;
+        CFS_INIT_LIST_HEAD (&conn->uc_pt_list);
+        CFS_INIT_LIST_HEAD (&conn->uc_ready_list);
 
         LIBCFS_ALLOC (conn->uc_rx_hello,
                       offsetof(ksock_hello_msg_t,
@@ -0,0 +1,450 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.sun.com/software/products/lustre/docs/GPLv2.pdf
+ *
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa Clara,
+ * CA 95054 USA or visit www.sun.com if you need additional information or
+ * have any questions.
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2013, Intel Corporation.
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ * Lustre is a trademark of Sun Microsystems, Inc.
+ *
+ * lnet/ulnds/socklnd/epoll.c
+ *
+ * Edge-triggered epoll(7) engine for usocklnd poll threads.
+ *
+ * Unlike the poll(2) engine, the cost of a wakeup here is proportional
+ * to the number of ready conns rather than to the number of registered
+ * ones. Because events are reported only once per edge, a conn whose
+ * handler has not drained the socket within ut_fair_limit passes is
+ * kept on upt_ready_list and handled again before sleeping.
+ */
+
+#include "usocklnd.h"
+#include <unistd.h>
+
+#ifdef HAVE_SYS_EPOLL_H
+
+static inline __u32
+usocklnd_poll2epoll(short value)
+{
+        __u32 events = 0;
+
+        if ((value & POLLIN) != 0)
+                events |= EPOLLIN;
+        if ((value & POLLOUT) != 0)
+                events |= EPOLLOUT;
+
+        return events;
+}
+
+/* Allocate epoll engine state of a poll thread. Notifier sockets
+ * must be already created. Returns 0 on success, <0 else */
+int
+usocklnd_epoll_state_init(usock_pollthread_t *pt)
+{
+        struct epoll_event ev;
+        int                rc;
+
+        LIBCFS_ALLOC (pt->upt_events,
+                      sizeof(struct epoll_event) * UPT_EPOLL_MAXEVENTS);
+        if (pt->upt_events == NULL)
+                return -ENOMEM;
+
+        pt->upt_epfd = epoll_create(UPT_EPOLL_MAXEVENTS);
+        if (pt->upt_epfd < 0) {
+                rc = -errno;
+                CERROR("Cannot create epoll instance: errno=%d\n", errno);
+                goto failed;
+        }
+
+        /* notifier fd is level-triggered: it is always drained */
+        memset(&ev, 0, sizeof(ev));
+        ev.events   = EPOLLIN;
+        ev.data.ptr = NULL;
+
+        if (epoll_ctl(pt->upt_epfd, EPOLL_CTL_ADD,
+                      LIBCFS_SOCK2FD(pt->upt_notifier[1]), &ev) != 0) {
+                rc = -errno;
+                CERROR("Cannot add notifier to epoll set: errno=%d\n",
+                       errno);
+                close(pt->upt_epfd);
+                goto failed;
+        }
+
+        return 0;
+
+  failed:
+        LIBCFS_FREE (pt->upt_events,
+                     sizeof(struct epoll_event) * UPT_EPOLL_MAXEVENTS);
+        return rc;
+}
+
+void
+usocklnd_epoll_state_fini(usock_pollthread_t *pt)
+{
+        close(pt->upt_epfd);
+        LIBCFS_FREE (pt->upt_events,
+                     sizeof(struct epoll_event) * UPT_EPOLL_MAXEVENTS);
+}
+
+/* Change the set of events the conn is polled for. EPOLL_CTL_MOD re-arms
+ * the edge, so readiness which arrived while an event was masked out is
+ * reported by the next epoll_wait(). Returns 0 on success, <0 else */
+static int
+usocklnd_epoll_modify(usock_pollthread_t *pt_data, usock_conn_t *conn,
+                      __u32 events)
+{
+        struct epoll_event ev;
+
+        conn->uc_ep_events   = events;
+        conn->uc_ep_revents &= events | EPOLLERR | EPOLLHUP;
+        if (conn->uc_ep_revents == 0)
+                cfs_list_del_init(&conn->uc_ready_list);
+
+        memset(&ev, 0, sizeof(ev));
+        ev.events   = events | EPOLLET;
+        ev.data.ptr = conn;
+
+        if (epoll_ctl(pt_data->upt_epfd, EPOLL_CTL_MOD,
+                      LIBCFS_SOCK2FD(conn->uc_sock), &ev) != 0) {
+                CERROR("Cannot modify epoll events of fd %d: errno=%d\n",
+                       LIBCFS_SOCK2FD(conn->uc_sock), errno);
+                return -errno;
+        }
+
+        return 0;
+}
+
+/* Process poll request. Update epoll set.
+ * Returns 0 on success, <0 else */
+static int
+usocklnd_epoll_process_pollrequest(usock_pollrequest_t *pr,
+                                   usock_pollthread_t *pt_data)
+{
+        int                type  = pr->upr_type;
+        short              value = pr->upr_value;
+        usock_conn_t      *conn  = pr->upr_conn;
+        struct epoll_event ev;
+        int                fd;
+        int                rc = 0;
+
+        LASSERT(conn != NULL);
+        LASSERT(conn->uc_sock != NULL);
+
+        LIBCFS_FREE (pr, sizeof(*pr));
+
+        fd = LIBCFS_SOCK2FD(conn->uc_sock);
+
+        if (type != POLL_ADD_REQUEST &&
+            cfs_list_empty(&conn->uc_pt_list)) { /* unlikely */
+                CWARN("Very unlikely event happend: trying to"
+                      " handle poll request of type %d but fd %d"
+                      " is not polled. Is shutdown in progress (%d)?\n",
+                      type, fd, usock_data.ud_shutdown);
+
+                usocklnd_conn_decref(conn);
+                return 0;
+        }
+
+        switch (type) {
+        case POLL_ADD_REQUEST:
+                conn->uc_ep_events  = usocklnd_poll2epoll(value);
+                conn->uc_ep_revents = 0;
+
+                memset(&ev, 0, sizeof(ev));
+                ev.events   = conn->uc_ep_events | EPOLLET;
+                ev.data.ptr = conn;
+
+                if (epoll_ctl(pt_data->upt_epfd, EPOLL_CTL_ADD,
+                              fd, &ev) != 0) {
+                        /* don't kill the poll thread: orphan the conn
+                         * and let the peer reconnect */
+                        CERROR("Cannot add fd %d to epoll set: errno=%d\n",
+                               fd, errno);
+                        libcfs_sock_release(conn->uc_sock);
+                        cfs_list_add_tail(&conn->uc_stale_list,
+                                          &pt_data->upt_stale_list);
+                        return 0;
+                }
+
+                /* upt_conn_list takes the reference that
+                 * poll request possesses */
+                cfs_list_add_tail(&conn->uc_pt_list,
+                                  &pt_data->upt_conn_list);
+                pt_data->upt_nconns++;
+                return 0;
+        case POLL_DEL_REQUEST:
+                if (epoll_ctl(pt_data->upt_epfd, EPOLL_CTL_DEL,
+                              fd, &ev) != 0)
+                        CWARN("Cannot delete fd %d from epoll set: "
+                              "errno=%d\n", fd, errno);
+
+                cfs_list_del_init(&conn->uc_pt_list);
+                cfs_list_del_init(&conn->uc_ready_list);
+                pt_data->upt_nconns--;
+                conn->uc_ep_revents = 0;
+
+                libcfs_sock_release(conn->uc_sock);
+                cfs_list_add_tail(&conn->uc_stale_list,
+                                  &pt_data->upt_stale_list);
+                break;
+        case POLL_RX_SET_REQUEST:
+                rc = usocklnd_epoll_modify(pt_data, conn,
+                                           (conn->uc_ep_events & ~EPOLLIN) |
+                                           usocklnd_poll2epoll(value));
+                break;
+        case POLL_TX_SET_REQUEST:
+                rc = usocklnd_epoll_modify(pt_data, conn,
+                                           (conn->uc_ep_events & ~EPOLLOUT) |
+                                           usocklnd_poll2epoll(value));
+                break;
+        case POLL_SET_REQUEST:
+                rc = usocklnd_epoll_modify(pt_data, conn,
+                                           usocklnd_poll2epoll(value));
+                break;
+        default:
+                LBUG(); /* unknown type */
+        }
+
+        usocklnd_conn_decref(conn);
+        return rc;
+}
+
+/* Collect events reported by epoll_wait() onto upt_ready_list, then loop
+ * on the ready conns executing handlers until fair_limit is reached or
+ * all of them are exhausted. Conns still ready stay on the list */
+static void
+usocklnd_epoll_execute_handlers(usock_pollthread_t *pt_data, int nevents)
+{
+        cfs_list_t   *ready = &pt_data->upt_ready_list;
+        usock_conn_t *conn;
+        usock_conn_t *next;
+        int           i;
+        int           j;
+
+        for (i = 0; i < nevents; i++) {
+                conn = pt_data->upt_events[i].data.ptr;
+
+                if (conn == NULL) { /* notifier */
+                        while (usocklnd_notifier_handler(
+                                LIBCFS_SOCK2FD(pt_data->upt_notifier[1])) > 0)
+                                ;
+                        continue;
+                }
+
+                conn->uc_ep_revents |= pt_data->upt_events[i].events;
+                if (cfs_list_empty(&conn->uc_ready_list))
+                        cfs_list_add_tail(&conn->uc_ready_list, ready);
+        }
+
+        for (j = 0; j < usock_tuns.ut_fair_limit; j++) {
+                if (cfs_list_empty(ready)) /* nothing ready */
+                        break;
+
+                cfs_list_for_each_entry_safe_typed(conn, next, ready,
+                                                   usock_conn_t,
+                                                   uc_ready_list) {
+                        __u32 revents = conn->uc_ep_revents;
+
+                        /* kill connection if it's closed by peer and
+                         * there is no data pending for reading */
+                        if ((revents & (EPOLLERR | EPOLLHUP)) != 0) {
+                                if ((conn->uc_ep_events & EPOLLIN) != 0 &&
+                                    (revents & EPOLLIN) == 0)
+                                        usocklnd_conn_kill(conn);
+                                else
+                                        usocklnd_exception_handler(conn);
+
+                                conn->uc_ep_revents &= ~(EPOLLERR | EPOLLHUP);
+                        }
+
+                        if ((conn->uc_ep_revents & EPOLLIN) != 0 &&
+                            usocklnd_read_handler(conn) <= 0)
+                                conn->uc_ep_revents &= ~EPOLLIN;
+
+                        if ((conn->uc_ep_revents & EPOLLOUT) != 0 &&
+                            usocklnd_write_handler(conn) <= 0)
+                                conn->uc_ep_revents &= ~EPOLLOUT;
+
+                        if (conn->uc_ep_revents == 0)
+                                cfs_list_del_init(&conn->uc_ready_list);
+                }
+        }
+}
+
+/* Check a chunk of conns for timeout. The list is rotated so that every
+ * conn is checked once per full cycle, like in the poll(2) engine */
+static void
+usocklnd_epoll_check_timeouts(usock_pollthread_t *pt_data,
+                              cfs_time_t current_time, int times)
+{
+        int n;
+
+        n = usocklnd_calculate_chunk_size(pt_data->upt_nconns) * times;
+        if (n > pt_data->upt_nconns)
+                n = pt_data->upt_nconns;
+
+        while (n-- > 0) {
+                usock_conn_t *conn;
+
+                conn = cfs_list_entry(pt_data->upt_conn_list.next,
+                                      usock_conn_t, uc_pt_list);
+                cfs_list_move_tail(&conn->uc_pt_list,
+                                   &pt_data->upt_conn_list);
+
+                pthread_mutex_lock(&conn->uc_lock);
+                if (usocklnd_conn_timed_out(conn, current_time) &&
+                    conn->uc_state != UC_DEAD) {
+                        conn->uc_errored = 1;
+                        usocklnd_conn_kill_locked(conn);
+                }
+                pthread_mutex_unlock(&conn->uc_lock);
+        }
+}
+
+int
+usocklnd_epoll_thread(void *arg)
+{
+        int                 rc = 0;
+        usock_pollthread_t *pt_data = (usock_pollthread_t *)arg;
+        cfs_time_t          current_time;
+        cfs_time_t          planned_time;
+        int                 nevents;
+        int                 timeout;
+
+        /* mask signals to avoid SIGPIPE, etc */
+        sigset_t  sigs;
+        sigfillset (&sigs);
+        pthread_sigmask (SIG_SETMASK, &sigs, 0);
+
+        LASSERT(pt_data != NULL);
+
+        planned_time = cfs_time_shift(usock_tuns.ut_poll_timeout);
+
+        /* Main loop */
+        while (usock_data.ud_shutdown == 0) {
+                /* Process all enqueued poll requests */
+                pthread_mutex_lock(&pt_data->upt_pollrequests_lock);
+                while (!cfs_list_empty(&pt_data->upt_pollrequests)) {
+                        usock_pollrequest_t *pr;
+                        pr = cfs_list_entry(pt_data->upt_pollrequests.next,
+                                            usock_pollrequest_t, upr_list);
+
+                        cfs_list_del(&pr->upr_list);
+                        rc = usocklnd_epoll_process_pollrequest(pr, pt_data);
+                        if (rc)
+                                break;
+                }
+                pthread_mutex_unlock(&pt_data->upt_pollrequests_lock);
+
+                if (rc)
+                        break;
+
+                /* Delete conns orphaned due to POLL_DEL_REQUESTs */
+                usocklnd_process_stale_list(pt_data);
+
+                /* Don't sleep while some conns have unhandled events */
+                timeout = cfs_list_empty(&pt_data->upt_ready_list) ?
+                          usock_tuns.ut_poll_timeout * 1000 : 0;
+
+                /* Actual polling for events */
+                nevents = epoll_wait(pt_data->upt_epfd, pt_data->upt_events,
+                                     UPT_EPOLL_MAXEVENTS, timeout);
+                if (nevents < 0) {
+                        if (errno != EINTR) {
+                                rc = -errno;
+                                CERROR("Cannot epoll_wait(2): errno=%d\n",
+                                       errno);
+                                break;
+                        }
+                        nevents = 0;
+                }
+
+                usocklnd_epoll_execute_handlers(pt_data, nevents);
+
+                current_time = cfs_time_current();
+
+                if (pt_data->upt_nconns == 0 ||
+                    cfs_time_before(current_time, planned_time))
+                        continue;
+
+                usocklnd_epoll_check_timeouts(pt_data, current_time,
+                        cfs_duration_sec(cfs_time_sub(current_time,
+                                                      planned_time)) + 1);
+
+                planned_time = cfs_time_add(current_time,
+                                            cfs_time_seconds(usock_tuns.ut_poll_timeout));
+        }
+
+        /* All conns should be deleted by POLL_DEL_REQUESTs while shutdown */
+        LASSERT (rc != 0 || pt_data->upt_nconns == 0);
+
+        if (rc) {
+                usocklnd_cancel_pollrequests(pt_data, rc);
+
+                while (!cfs_list_empty(&pt_data->upt_conn_list)) {
+                        usock_conn_t *conn;
+
+                        conn = cfs_list_entry(pt_data->upt_conn_list.next,
+                                              usock_conn_t, uc_pt_list);
+                        cfs_list_del_init(&conn->uc_pt_list);
+                        cfs_list_del_init(&conn->uc_ready_list);
+                        pt_data->upt_nconns--;
+
+                        libcfs_sock_release(conn->uc_sock);
+                        usocklnd_tear_peer_conn(conn);
+                        usocklnd_conn_decref(conn);
+                }
+        }
+
+	/* unblock usocklnd_shutdown() */
+	complete(&pt_data->upt_completion);
+
+	return 0;
+}
+
+#else /* !HAVE_SYS_EPOLL_H */
+
+/* usocklnd_validate_tunables() refuses USOCK_EPOLL on such platforms */
+
+int
+usocklnd_epoll_state_init(usock_pollthread_t *pt)
+{
+        return -EOPNOTSUPP;
+}
+
+void
+usocklnd_epoll_state_fini(usock_pollthread_t *pt)
+{
+}
+
+int
+usocklnd_epoll_thread(void *arg)
+{
+        LBUG();
+        return 0;
+}
+
+#endif /* HAVE_SYS_EPOLL_H */
@@ -57,6 +57,38 @@ usocklnd_process_stale_list(usock_pollthread_t *pt_data)
         }
 }
 
+/* Called by errored poll thread: block new poll requests and
+ * drop enqueued ones, then release orphaned conns */
+void
+usocklnd_cancel_pollrequests(usock_pollthread_t *pt_data, int rc)
+{
+        pthread_mutex_lock(&pt_data->upt_pollrequests_lock);
+
+        /* Block new poll requests to be enqueued */
+        pt_data->upt_errno = rc;
+
+        while (!cfs_list_empty(&pt_data->upt_pollrequests)) {
+                usock_pollrequest_t *pr;
+                pr = cfs_list_entry(pt_data->upt_pollrequests.next,
+                                    usock_pollrequest_t, upr_list);
+
+                cfs_list_del(&pr->upr_list);
+
+                if (pr->upr_type == POLL_ADD_REQUEST) {
+                        libcfs_sock_release(pr->upr_conn->uc_sock);
+                        cfs_list_add_tail(&pr->upr_conn->uc_stale_list,
+                                          &pt_data->upt_stale_list);
+                } else {
+                        usocklnd_conn_decref(pr->upr_conn);
+                }
+
+                LIBCFS_FREE (pr, sizeof(*pr));
+        }
+        pthread_mutex_unlock(&pt_data->upt_pollrequests_lock);
+
+        usocklnd_process_stale_list(pt_data);
+}
+
 int
 usocklnd_poll_thread(void *arg)
 {
@@ -166,31 +198,7 @@ usocklnd_poll_thread(void *arg)
         LASSERT (rc != 0 || pt_data->upt_nfds == 1);
 
         if (rc) {
-                pthread_mutex_lock(&pt_data->upt_pollrequests_lock);
-
-                /* Block new poll requests to be enqueued */
-                pt_data->upt_errno = rc;
-
-                while (!cfs_list_empty(&pt_data->upt_pollrequests)) {
-                        usock_pollrequest_t *pr;
-                        pr = cfs_list_entry(pt_data->upt_pollrequests.next,
-                                        usock_pollrequest_t, upr_list);
-
-                        cfs_list_del(&pr->upr_list);
-
-                        if (pr->upr_type == POLL_ADD_REQUEST) {
-                                libcfs_sock_release(pr->upr_conn->uc_sock);
-                                cfs_list_add_tail(&pr->upr_conn->uc_stale_list,
-                                                  &pt_data->upt_stale_list);
-                        } else {
-                                usocklnd_conn_decref(pr->upr_conn);
-                        }
-
-                        LIBCFS_FREE (pr, sizeof(*pr));
-                }
-                pthread_mutex_unlock(&pt_data->upt_pollrequests_lock);
-
-                usocklnd_process_stale_list(pt_data);
+                usocklnd_cancel_pollrequests(pt_data, rc);
 
                 for (idx = 1; idx < pt_data->upt_nfds; idx++) {
                         usock_conn_t *conn = pt_data->upt_idx2conn[idx];
@@ -207,6 +215,67 @@ usocklnd_poll_thread(void *arg)
 	return 0;
 }
 
+/* Allocate poll(2) engine state of a poll thread. Notifier sockets
+ * must be already created. Returns 0 on success, <0 else */
+int
+usocklnd_poll_state_init(usock_pollthread_t *pt)
+{
+        LIBCFS_ALLOC (pt->upt_pollfd,
+                      sizeof(struct pollfd) * UPT_START_SIZ);
+        if (pt->upt_pollfd == NULL)
+                goto failed_0;
+
+        LIBCFS_ALLOC (pt->upt_idx2conn,
+                      sizeof(usock_conn_t *) * UPT_START_SIZ);
+        if (pt->upt_idx2conn == NULL)
+                goto failed_1;
+
+        LIBCFS_ALLOC (pt->upt_fd2idx,
+                      sizeof(int) * UPT_START_SIZ);
+        if (pt->upt_fd2idx == NULL)
+                goto failed_2;
+
+        memset(pt->upt_fd2idx, 0,
+               sizeof(int) * UPT_START_SIZ);
+
+        LIBCFS_ALLOC (pt->upt_skip,
+                      sizeof(int) * UPT_START_SIZ);
+        if (pt->upt_skip == NULL)
+                goto failed_3;
+
+        pt->upt_npollfd = pt->upt_nfd2idx = UPT_START_SIZ;
+
+        pt->upt_pollfd[0].fd = LIBCFS_SOCK2FD(pt->upt_notifier[1]);
+        pt->upt_pollfd[0].events = POLLIN;
+        pt->upt_pollfd[0].revents = 0;
+
+        pt->upt_nfds = 1;
+        pt->upt_idx2conn[0] = NULL;
+        return 0;
+
+  failed_3:
+        LIBCFS_FREE (pt->upt_fd2idx, sizeof(int) * UPT_START_SIZ);
+  failed_2:
+        LIBCFS_FREE (pt->upt_idx2conn, sizeof(usock_conn_t *) * UPT_START_SIZ);
+  failed_1:
+        LIBCFS_FREE (pt->upt_pollfd, sizeof(struct pollfd) * UPT_START_SIZ);
+  failed_0:
+        return -ENOMEM;
+}
+
+void
+usocklnd_poll_state_fini(usock_pollthread_t *pt)
+{
+        LIBCFS_FREE (pt->upt_pollfd,
+                     sizeof(struct pollfd) * pt->upt_npollfd);
+        LIBCFS_FREE (pt->upt_idx2conn,
+                     sizeof(usock_conn_t *) * pt->upt_npollfd);
+        LIBCFS_FREE (pt->upt_skip,
+                     sizeof(int) * pt->upt_npollfd);
+        LIBCFS_FREE (pt->upt_fd2idx,
+                     sizeof(int) * pt->upt_nfd2idx);
+}
+
 /* Returns 0 on success, <0 else */
 int
 usocklnd_add_pollrequest(usock_conn_t *conn, int type, short value)
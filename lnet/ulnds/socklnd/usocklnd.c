@@ -61,6 +61,11 @@ usock_tunables_t usock_tuns = {
         .ut_peertxcredits   = 8,
         .ut_socknagle       = 0,
         .ut_sockbufsiz      = 0,
+#ifdef HAVE_SYS_EPOLL_H
+        .ut_epoll           = 1,
+#else
+        .ut_epoll           = 0,
+#endif
 };
 
 #define MAX_REASONABLE_TIMEOUT 36000 /* 10 hours */
@@ -128,6 +133,21 @@ usocklnd_validate_tunables()
                 return -1;
         }
 
+        if (usock_tuns.ut_epoll != 0 &&
+            usock_tuns.ut_epoll != 1) {
+                CERROR("USOCK_EPOLL: %d should be 0 or 1\n",
+                       usock_tuns.ut_epoll);
+                return -1;
+        }
+
+#ifndef HAVE_SYS_EPOLL_H
+        if (usock_tuns.ut_epoll) {
+                CERROR("USOCK_EPOLL: epoll(7) is not supported "
+                       "on this platform\n");
+                return -1;
+        }
+#endif
+
         return 0;
 }
 
@@ -145,12 +165,10 @@ usocklnd_release_poll_states(int n)
                 pthread_mutex_destroy(&pt->upt_pollrequests_lock);
 		fini_completion(&pt->upt_completion);
 
-                LIBCFS_FREE (pt->upt_pollfd,
-                             sizeof(struct pollfd) * pt->upt_npollfd);
-                LIBCFS_FREE (pt->upt_idx2conn,
-                              sizeof(usock_conn_t *) * pt->upt_npollfd);
-                LIBCFS_FREE (pt->upt_fd2idx,
-                              sizeof(int) * pt->upt_nfd2idx);
+                if (usock_tuns.ut_epoll)
+                        usocklnd_epoll_state_fini(pt);
+                else
+                        usocklnd_poll_state_fini(pt);
         }
 }
 
@@ -204,6 +222,11 @@ usocklnd_update_tunables()
         if (rc)
                 return rc;
 
+        rc = lnet_parse_int_tunable(&usock_tuns.ut_epoll,
+                                      "USOCK_EPOLL");
+        if (rc)
+                return rc;
+
         if (usocklnd_validate_tunables())
                 return -EINVAL;
 
@@ -244,47 +267,23 @@ usocklnd_base_startup()
 
                 pt = &usock_data.ud_pollthreads[i];
 
-                rc = -ENOMEM;
-
-                LIBCFS_ALLOC (pt->upt_pollfd,
-                              sizeof(struct pollfd) * UPT_START_SIZ);
-                if (pt->upt_pollfd == NULL)
-                        goto base_startup_failed_0;
-
-                LIBCFS_ALLOC (pt->upt_idx2conn,
-                              sizeof(usock_conn_t *) * UPT_START_SIZ);
-                if (pt->upt_idx2conn == NULL)
-                        goto base_startup_failed_1;
-
-                LIBCFS_ALLOC (pt->upt_fd2idx,
-                              sizeof(int) * UPT_START_SIZ);
-                if (pt->upt_fd2idx == NULL)
-                        goto base_startup_failed_2;
-
-                memset(pt->upt_fd2idx, 0,
-                       sizeof(int) * UPT_START_SIZ);
-
-                LIBCFS_ALLOC (pt->upt_skip,
-                              sizeof(int) * UPT_START_SIZ);
-                if (pt->upt_skip == NULL)
-                        goto base_startup_failed_3;
-
-                pt->upt_npollfd = pt->upt_nfd2idx = UPT_START_SIZ;
-
                 rc = libcfs_socketpair(pt->upt_notifier);
                 if (rc != 0)
-                        goto base_startup_failed_4;
-
-                pt->upt_pollfd[0].fd = LIBCFS_SOCK2FD(pt->upt_notifier[1]);
-                pt->upt_pollfd[0].events = POLLIN;
-                pt->upt_pollfd[0].revents = 0;
+                        goto base_startup_failed_0;
 
-                pt->upt_nfds = 1;
-                pt->upt_idx2conn[0] = NULL;
+                if (usock_tuns.ut_epoll)
+                        rc = usocklnd_epoll_state_init(pt);
+                else
+                        rc = usocklnd_poll_state_init(pt);
+                if (rc != 0)
+                        goto base_startup_failed_1;
 
                 pt->upt_errno = 0;
                 CFS_INIT_LIST_HEAD (&pt->upt_pollrequests);
                 CFS_INIT_LIST_HEAD (&pt->upt_stale_list);
+                CFS_INIT_LIST_HEAD (&pt->upt_conn_list);
+                CFS_INIT_LIST_HEAD (&pt->upt_ready_list);
+                pt->upt_nconns = 0;
                 pthread_mutex_init(&pt->upt_pollrequests_lock, NULL);
 		init_completion(&pt->upt_completion);
         }
@@ -297,7 +296,9 @@ usocklnd_base_startup()
 
         /* Spawn poll threads */
         for (i = 0; i < usock_data.ud_npollthreads; i++) {
-                rc = cfs_create_thread(usocklnd_poll_thread,
+                rc = cfs_create_thread(usock_tuns.ut_epoll ?
+                                       usocklnd_epoll_thread :
+                                       usocklnd_poll_thread,
                                        &usock_data.ud_pollthreads[i], 0);
                 if (rc) {
                         usocklnd_base_shutdown(i);
@@ -309,14 +310,9 @@ usocklnd_base_startup()
 
         return 0;
 
-  base_startup_failed_4:
-        LIBCFS_FREE (pt->upt_skip, sizeof(int) * UPT_START_SIZ);
-  base_startup_failed_3:
-        LIBCFS_FREE (pt->upt_fd2idx, sizeof(int) * UPT_START_SIZ);
-  base_startup_failed_2:
-        LIBCFS_FREE (pt->upt_idx2conn, sizeof(usock_conn_t *) * UPT_START_SIZ);
   base_startup_failed_1:
-        LIBCFS_FREE (pt->upt_pollfd, sizeof(struct pollfd) * UPT_START_SIZ);
+        libcfs_sock_release(pt->upt_notifier[0]);
+        libcfs_sock_release(pt->upt_notifier[1]);
   base_startup_failed_0:
         LASSERT(rc != 0);
         usocklnd_release_poll_states(i);
@@ -42,6 +42,9 @@
 #endif
 #include <pthread.h>
 #include <poll.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 #include <lnet/lib-lnet.h>
 #include <lnet/socklnd.h>
 
@@ -74,6 +77,10 @@ typedef struct {
         __u32                 uc_peer_ip;    /* IP address of the peer */
         __u16                 uc_peer_port;  /* port of the peer */
         cfs_list_t            uc_stale_list; /* orphaned connections */
+        cfs_list_t            uc_pt_list;    /* on upt_conn_list (epoll) */
+        cfs_list_t            uc_ready_list; /* on upt_ready_list (epoll) */
+        __u32                 uc_ep_events;  /* registered epoll events */
+        __u32                 uc_ep_revents; /* events not handled yet */
 
         /* Receive state */
         int                uc_rx_state;      /* message or hello state */
@@ -156,12 +163,25 @@ typedef struct {
         int                 upt_errno;         /* non-zero if errored */
 	struct completion	upt_completion;	/* wait/signal facility for
 						 * syncronizing shutdown */
+	/* epoll engine state, unused by poll(2) engine */
+	int			upt_epfd;	/* epoll instance */
+#ifdef HAVE_SYS_EPOLL_H
+	struct epoll_event     *upt_events;	/* epoll_wait() results */
+#endif
+	cfs_list_t		upt_conn_list;	/* all conns of this thread,
+						 * rotated by timeout scan */
+	int			upt_nconns;	/* # of conns on upt_conn_list */
+	cfs_list_t		upt_ready_list;	/* conns with events left
+						 * after ut_fair_limit passes */
 } usock_pollthread_t;
 
 /* Number of elements in upt_pollfd[], upt_idx2conn[] and upt_fd2idx[]
  * at initialization time. Will be resized on demand */
 #define UPT_START_SIZ 32
 
+/* Max # of events returned by one epoll_wait() */
+#define UPT_EPOLL_MAXEVENTS 256
+
 /* # peer lists */
 #define UD_PEER_HASH_SIZE  101
 
@@ -200,6 +220,8 @@ typedef struct {
         int ut_peertxcredits; /* # concurrent sends to 1 peer */
         int ut_socknagle;     /* Is Nagle alg on ? */
         int ut_sockbufsiz;    /* size of socket buffers */
+        int ut_epoll;         /* use edge-triggered epoll(7) engine
+                               * instead of poll(2) */
 } usock_tunables_t;
 
 extern usock_tunables_t usock_tuns;
@@ -280,6 +302,13 @@ int usocklnd_recv(lnet_ni_t *ni, void *private, lnet_msg_t *msg, int delayed,
 int usocklnd_accept(lnet_ni_t *ni, cfs_socket_t *sock);
 
 int usocklnd_poll_thread(void *arg);
+int usocklnd_poll_state_init(usock_pollthread_t *pt);
+void usocklnd_poll_state_fini(usock_pollthread_t *pt);
+void usocklnd_process_stale_list(usock_pollthread_t *pt_data);
+void usocklnd_cancel_pollrequests(usock_pollthread_t *pt_data, int rc);
+int usocklnd_epoll_thread(void *arg);
+int usocklnd_epoll_state_init(usock_pollthread_t *pt);
+void usocklnd_epoll_state_fini(usock_pollthread_t *pt);
 int usocklnd_add_pollrequest(usock_conn_t *conn, int type, short value);
 void usocklnd_add_killrequest(usock_conn_t *conn);
 int usocklnd_process_pollrequest(usock_pollrequest_t *pr,
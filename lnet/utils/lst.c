@@ -2688,6 +2688,50 @@ lst_print_tsb_verbose(cfs_list_t *head,
         }
 }
 
+/* rpe_priv[1..3] of batch query: p50, p99 and p99.9 RPC latency (usec) */
+void
+lst_print_tsb_latency(cfs_list_t *head)
+{
+        static const char *names[] = {"p50", "p99", "p99.9"};
+        lstcon_rpc_ent_t  *ent;
+        long long          sum[3] = {0};
+        int                min[3] = {0};
+        int                max[3] = {0};
+        int                count = 0;
+        int                i;
+
+        cfs_list_for_each_entry_typed(ent, head, lstcon_rpc_ent_t, rpe_link) {
+                if (ent->rpe_rpc_errno != 0 || ent->rpe_fwk_errno != 0 ||
+                    ent->rpe_priv[1] == 0) /* no samples */
+                        continue;
+
+                fprintf(stdout, "%s: ", libcfs_id2str(ent->rpe_peer));
+                for (i = 0; i < 3; i++) {
+                        int lat = ent->rpe_priv[i + 1];
+
+                        fprintf(stdout, "%s %d us%s", names[i], lat,
+                                i == 2 ? "\n" : ", ");
+                        sum[i] += lat;
+                        if (count == 0 || lat < min[i])
+                                min[i] = lat;
+                        if (lat > max[i])
+                                max[i] = lat;
+                }
+                count++;
+        }
+
+        if (count == 0) {
+                fprintf(stdout, "No latency samples\n");
+                return;
+        }
+
+        for (i = 0; i < 3; i++) {
+                fprintf(stdout, "%s of %d nodes (us): min %d, avg %lld, "
+                        "max %d\n", names[i], count, min[i],
+                        sum[i] / count, max[i]);
+        }
+}
+
 int
 jt_lst_query_batch(int argc, char **argv)
 {
@@ -2697,6 +2741,7 @@ jt_lst_query_batch(int argc, char **argv)
         time_t                  last    = 0;
         int                     optidx  = 0;
         int                     verbose = 0;
+        int                     latency = 0;
         int                     server  = 0;
         int                     timeout = 5; /* default 5 seconds */
         int                     delay   = 5; /* default 5 seconds */
@@ -2721,6 +2766,7 @@ jt_lst_query_batch(int argc, char **argv)
                 {"idle",    no_argument,       0, 'i' },
                 {"error",   no_argument,       0, 'e' },
                 {"all",     no_argument,       0, 'l' },
+                {"latency", no_argument,       0, 'p' },
                 {0,         0,                 0,  0  }
         };
 
@@ -2731,7 +2777,7 @@ jt_lst_query_batch(int argc, char **argv)
         }
 
         while (1) {
-                c = getopt_long(argc, argv, "o:d:c:t:saiel",
+                c = getopt_long(argc, argv, "o:d:c:t:saielp",
                                 query_batch_opts, &optidx);
 
                 /* Detect the end of the options. */
@@ -2766,12 +2812,21 @@ jt_lst_query_batch(int argc, char **argv)
                 case 'l':
                         verbose = 1;
                         break;
+                case 'p':
+                        latency = verbose = 1;
+                        break;
                 default:
                         lst_print_usage(argv[0]);
                         return -1;
                 }
         }
 
+        if (latency && (session_features & LST_FEAT_BULK_DIST) == 0) {
+                fprintf(stderr, "Latency needs feature %x of session\n",
+                        LST_FEAT_BULK_DIST);
+                return -1;
+        }
+
         if (test < 0 || timeout <= 0 || delay <= 0 || loop <= 0) {
                 lst_print_usage(argv[0]);
                 return -1;
@@ -2832,6 +2887,11 @@ jt_lst_query_batch(int argc, char **argv)
                         break;
                 }
 
+                if (latency) {
+                        lst_print_tsb_latency(&head);
+                        continue;
+                }
+
                 if (verbose) {
                         /* Verbose mode */
                         lst_print_tsb_verbose(&head, active, idle, error);
@@ -2889,11 +2949,101 @@ lst_parse_distribute(char *dstr, int *dist, int *span)
         return 0;
 }
 
+/* parse one size with optional K/M suffix, return bytes or -1 */
+static int
+lst_parse_size(char *str, char **end)
+{
+        long size = strtol(str, end, 0);
+
+        if (size <= 0)
+                return -1;
+
+        if (**end == 'k' || **end == 'K') {
+                size *= 1024;
+                (*end)++;
+        } else if (**end == 'm' || **end == 'M') {
+                size *= 1024 * 1024;
+                (*end)++;
+        }
+
+        if (size > CFS_PAGE_SIZE * LNET_MAX_IOV) {
+                fprintf(stderr, "Size exceed limitation: %ld bytes\n", size);
+                return -1;
+        }
+
+        return size;
+}
+
+/* size=SIZE: fixed size
+ * size=MIN-MAX: random size for each RPC, uniformly distributed
+ * size=SIZE,SIZE[,...]: random one of the listed sizes for each RPC */
+int
+lst_parse_bulk_size(char *str, lst_test_bulk_param_t *bulk)
+{
+        char *end = str;
+        int   size;
+        int   i;
+
+        bulk->blk_dist   = LST_BULK_DIST_FIXED;
+        bulk->blk_nsizes = 0;
+        bulk->blk_size   = 0;
+
+        for (;;) {
+                size = lst_parse_size(end, &end);
+                if (size < 0)
+                        goto failed;
+
+                if (bulk->blk_nsizes == LST_BULK_MAX_SIZES) {
+                        fprintf(stderr, "At most %d sizes can be mixed\n",
+                                LST_BULK_MAX_SIZES);
+                        return -1;
+                }
+
+                bulk->blk_sizes[bulk->blk_nsizes++] = size;
+                if (size > bulk->blk_size)
+                        bulk->blk_size = size;
+
+                if (*end == '\0')
+                        break;
+
+                if (*end == '-' && bulk->blk_nsizes == 1) {
+                        bulk->blk_dist = LST_BULK_DIST_UNIFORM;
+                } else if (*end == ',' &&
+                           bulk->blk_dist != LST_BULK_DIST_UNIFORM) {
+                        bulk->blk_dist = LST_BULK_DIST_MIXED;
+                } else {
+                        goto failed;
+                }
+                end++;
+        }
+
+        if (bulk->blk_dist == LST_BULK_DIST_UNIFORM &&
+            (bulk->blk_nsizes != 2 || bulk->blk_sizes[0] > bulk->blk_sizes[1]))
+                goto failed;
+
+        if (bulk->blk_dist != LST_BULK_DIST_FIXED &&
+            (session_features & LST_FEAT_BULK_DIST) == 0) {
+                fprintf(stderr, "Size distribution needs feature %x "
+                        "of session\n", LST_FEAT_BULK_DIST);
+                return -1;
+        }
+
+        if (bulk->blk_dist == LST_BULK_DIST_FIXED)
+                bulk->blk_nsizes = 0;
+
+        for (i = bulk->blk_nsizes; i < LST_BULK_MAX_SIZES; i++)
+                bulk->blk_sizes[i] = 0;
+
+        return 0;
+failed:
+        fprintf(stderr, "Invalid size %s\n", str);
+        return -1;
+}
+
 int
 lst_get_bulk_param(int argc, char **argv, lst_test_bulk_param_t *bulk)
 {
         char   *tok = NULL;
-        char   *end = NULL;
         int     rc  = 0;
         int     i   = 0;
 
@@ -2919,25 +3069,8 @@ lst_get_bulk_param(int argc, char **argv, lst_test_bulk_param_t *bulk)
                          strcasestr(argv[i], "s=") == argv[i]) {
                         tok = strchr(argv[i], '=') + 1;
 
-                        bulk->blk_size = strtol(tok, &end, 0);
-                        if (bulk->blk_size <= 0) {
-                                fprintf(stderr, "Invalid size %s\n", tok);
+                        if (lst_parse_bulk_size(tok, bulk) != 0)
                                 return -1;
-                        }
-
-                        if (end == NULL)
-                                return 0;
-
-                        if (*end == 'k' || *end == 'K')
-                                bulk->blk_size *= 1024;
-                        else if (*end == 'm' || *end == 'M')
-                                bulk->blk_size *= 1024 * 1024;
-
-                        if (bulk->blk_size > CFS_PAGE_SIZE * LNET_MAX_IOV) {
-                                fprintf(stderr, "Size exceed limitation: %d bytes\n",
-                                        bulk->blk_size);
-                                return -1;
-                        }
 
                 } else if (strcasecmp(argv[i], "read") == 0 ||
                            strcasecmp(argv[i], "r") == 0) {
@@ -3002,7 +3135,7 @@ lst_get_test_param(char *test, int argc, char **argv, void **param, int *plen)
 }
 
 int
-lst_add_test_ioctl(char *batch, int type, int loop, int concur,
+lst_add_test_ioctl(char *batch, int type, int loop, int concur, int ramp,
                    int dist, int span, char *sgrp, char *dgrp,
                    void *param, int plen, int *retp, cfs_list_t *resultp)
 {
@@ -3017,6 +3150,7 @@ lst_add_test_ioctl(char *batch, int type, int loop, int concur,
         args.lstio_tes_concur     = concur;
         args.lstio_tes_dist       = dist;
         args.lstio_tes_span       = span;
+        args.lstio_tes_ramp       = ramp;
         args.lstio_tes_sgrp_nmlen = strlen(sgrp);
         args.lstio_tes_sgrp_name  = sgrp;
         args.lstio_tes_dgrp_nmlen = strlen(dgrp);
@@ -3044,6 +3178,7 @@ jt_lst_add_test(int argc, char **argv)
         int           loop   = -1;
         int           dist   = 1;
         int           span   = 1;
+        int           ramp   = 0;
         int           plen   = 0;
         int           fcount = 0;
         int           tcount = 0;
@@ -3060,6 +3195,7 @@ jt_lst_add_test(int argc, char **argv)
                 {"from",        required_argument, 0, 'f' },
                 {"to",          required_argument, 0, 't' },
                 {"loop",        required_argument, 0, 'l' },
+                {"ramp",        required_argument, 0, 'r' },
                 {0,             0,                 0,  0  }
         };
 
@@ -3070,7 +3206,7 @@ jt_lst_add_test(int argc, char **argv)
         }
 
         while (1) {
-                c = getopt_long(argc, argv, "b:c:d:f:l:t:",
+                c = getopt_long(argc, argv, "b:c:d:f:l:r:t:",
                                 add_test_opts, &optidx);
 
                 /* Detect the end of the options. */
@@ -3093,6 +3229,9 @@ jt_lst_add_test(int argc, char **argv)
                 case 'l':
                         loop = atoi(optarg);
                         break;
+                case 'r':
+                        ramp = atoi(optarg);
+                        break;
                 case 't':
                         to = optarg;
                         break;
@@ -3112,6 +3251,17 @@ jt_lst_add_test(int argc, char **argv)
                 return -1;
         }
 
+        if (ramp < 0) {
+                fprintf(stderr, "Invalid ramp-up time: %d\n", ramp);
+                return -1;
+        }
+
+        if (ramp > 0 && (session_features & LST_FEAT_BULK_DIST) == 0) {
+                fprintf(stderr, "Ramp-up needs feature %x of session\n",
+                        LST_FEAT_BULK_DIST);
+                return -1;
+        }
+
         if (batch == NULL)
                 batch = LST_DEFAULT_BATCH;
 
@@ -3156,7 +3306,7 @@ jt_lst_add_test(int argc, char **argv)
                 goto out;
         }
 
-        rc = lst_add_test_ioctl(batch, type, loop, concur,
+        rc = lst_add_test_ioctl(batch, type, loop, concur, ramp,
                                 dist, span, from, to, param, plen, &ret, &head);
 
         if (rc == 0) {
@@ -3217,10 +3367,10 @@ static command_t lst_cmdlist[] = {
         {"list_batch",          jt_lst_list_batch,      NULL,
          "Usage: lst list_batch NAME [--test ID] [--server]"                            },
         {"query",               jt_lst_query_batch,     NULL,
-         "Usage: lst query [--test ID] [--server] [--timeout TIME] NAME"                },
+         "Usage: lst query [--test ID] [--server] [--timeout TIME] [--latency] NAME"    },
         {"add_test",            jt_lst_add_test,        NULL,
          "Usage: lst add_test [--batch BATCH] [--loop #] [--concurrency #] "
-         " [--distribute #:#] [--from GROUP] [--to GROUP] TEST..."                      },
+         " [--distribute #:#] [--ramp SECONDS] [--from GROUP] [--to GROUP] TEST..."     },
         {"help",                Parser_help,            0,     "help"                   },
         {0,                     0,                      0,      NULL                    }
 };
@@ -0,0 +1,309 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.sun.com/software/products/lustre/docs/GPLv2.pdf
+ *
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa Clara,
+ * CA 95054 USA or visit www.sun.com if you need additional information or
+ * have any questions.
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2013, Intel Corporation.
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ * Lustre is a trademark of Sun Microsystems, Inc.
+ *
+ * lnet/utils/usockbench.c
+ *
+ * Microbenchmark of the userspace socket LND: reports messages/sec
+ * handled by one usocklnd instance versus the number of connections.
+ *
+ * Run "usockbench --server" on the node under test (it starts userspace
+ * LNet in server mode, so the kernel LNet must not be loaded there), then
+ * "usockbench --target NID" on the same or another node. The client
+ * forks one userspace LNet instance per connection; each of them pings
+ * the target in a loop. Every ping is a GET plus a REPLY message.
+ * The poll engine of the server is selected by the USOCK_EPOLL tunable.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <lnet/lib-lnet.h>
+
+#define USB_MAX_CONNS		4096
+#define USB_PING_TIMEOUT_MS	(10 * 1000)
+
+static int usb_stopping = 0;
+
+static struct option usb_options[] =
+{
+	{"server",	no_argument,		0, 's' },
+	{"target",	required_argument,	0, 't' },
+	{"conns",	required_argument,	0, 'c' },
+	{"duration",	required_argument,	0, 'd' },
+	{0,		0,			0,  0  }
+};
+
+static void
+usb_stop(int sig)
+{
+	usb_stopping = 1;
+}
+
+static int
+usb_lnet_init(lnet_pid_t pid)
+{
+	int rc;
+
+	rc = libcfs_debug_init(5 * 1024 * 1024);
+	if (rc != 0) {
+		fprintf(stderr, "libcfs_debug_init() failed: %d\n", rc);
+		return rc;
+	}
+
+	rc = LNetInit();
+	if (rc != 0) {
+		fprintf(stderr, "LNetInit() failed: %d\n", rc);
+		goto out_debug;
+	}
+
+	if (pid == LUSTRE_SRV_LNET_PID)
+		lnet_server_mode();
+
+	rc = LNetNIInit(pid);
+	if (rc < 0) {
+		fprintf(stderr, "LNetNIInit() failed: %d\n", rc);
+		goto out_lnet;
+	}
+
+	return 0;
+
+out_lnet:
+	LNetFini();
+out_debug:
+	libcfs_debug_cleanup();
+	return rc;
+}
+
+static void
+usb_lnet_fini(void)
+{
+	LNetNIFini();
+	LNetFini();
+	libcfs_debug_cleanup();
+}
+
+static int
+usb_server(void)
+{
+	int rc;
+
+	rc = usb_lnet_init(LUSTRE_SRV_LNET_PID);
+	if (rc != 0)
+		return rc;
+
+	signal(SIGINT, usb_stop);
+	signal(SIGTERM, usb_stop);
+
+	fprintf(stdout, "Serving pings, Ctl-C to stop\n");
+	while (!usb_stopping)
+		pause();
+
+	usb_lnet_fini();
+	return 0;
+}
+
+static double
+usb_now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* Body of a forked client: ping target until deadline, then report the
+ * number of completed pings through the pipe */
+static int
+usb_client(lnet_process_id_t target, double deadline, int fd)
+{
+	lnet_process_id_t ids[LNET_MAX_INTERFACES];
+	__u64		  count = 0;
+	int		  rc;
+
+	rc = usb_lnet_init(LNET_PID_ANY);
+	if (rc != 0)
+		return rc;
+
+	while (usb_now() < deadline) {
+		rc = lnet_ping(target, USB_PING_TIMEOUT_MS, ids,
+			       LNET_MAX_INTERFACES);
+		if (rc < 0) {
+			fprintf(stderr, "ping %s failed: %d\n",
+				libcfs_id2str(target), rc);
+			break;
+		}
+		count++;
+	}
+
+	if (write(fd, &count, sizeof(count)) != sizeof(count))
+		rc = -errno;
+
+	usb_lnet_fini();
+	return rc < 0 ? rc : 0;
+}
+
+static int
+usb_run(lnet_process_id_t target, int nconns, int duration)
+{
+	__u64	total = 0;
+	double	start;
+	double	deadline;
+	int	pfd[2];
+	int	failed = 0;
+	int	status;
+	int	i;
+
+	if (pipe(pfd) != 0) {
+		fprintf(stderr, "pipe() failed: %s\n", strerror(errno));
+		return -errno;
+	}
+
+	/* 1s of warm-up for connection establishment */
+	deadline = usb_now() + 1 + duration;
+
+	for (i = 0; i < nconns; i++) {
+		pid_t pid = fork();
+
+		if (pid < 0) {
+			fprintf(stderr, "fork() failed: %s\n",
+				strerror(errno));
+			failed = 1;
+			break;
+		}
+
+		if (pid == 0) {
+			close(pfd[0]);
+			exit(usb_client(target, deadline, pfd[1]) == 0 ?
+			     0 : 1);
+		}
+	}
+	close(pfd[1]);
+
+	start = usb_now();
+	for (;;) {
+		__u64 count;
+
+		if (read(pfd[0], &count, sizeof(count)) != sizeof(count))
+			break;
+		total += count;
+	}
+	close(pfd[0]);
+
+	while (wait(&status) > 0) {
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			failed = 1;
+	}
+
+	/* GET + REPLY for every ping */
+	fprintf(stdout, "conns %5d: "LPU64" pings, %.0f msgs/sec%s\n",
+		nconns, total, 2 * total / (usb_now() - start),
+		failed ? " (some clients failed)" : "");
+	return failed ? -EIO : 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	lnet_process_id_t target = { .nid = LNET_NID_ANY,
+				     .pid = LUSTRE_SRV_LNET_PID };
+	char		 *conns = "1,4,16,64,256";
+	char		 *tok;
+	int		  server_flag = 0;
+	int		  duration = 10;
+	int		  optidx;
+	int		  c;
+	int		  rc = 0;
+
+	const char *usage_string =
+		"Usage: usockbench --server\n"
+		"       usockbench --target NID [--conns N[,N...]] "
+		"[--duration SECONDS]\n";
+
+	while (1) {
+		c = getopt_long(argc, argv, "st:c:d:", usb_options, &optidx);
+
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case 's':
+			server_flag = 1;
+			break;
+		case 't':
+			target.nid = libcfs_str2nid(optarg);
+			if (target.nid == LNET_NID_ANY) {
+				fprintf(stderr, "Invalid NID: %s\n", optarg);
+				return -1;
+			}
+			break;
+		case 'c':
+			conns = optarg;
+			break;
+		case 'd':
+			duration = atoi(optarg);
+			break;
+		default:
+			fprintf(stderr, "%s", usage_string);
+			return -1;
+		}
+	}
+
+	if (optind != argc || duration <= 0 ||
+	    server_flag == (target.nid != LNET_NID_ANY)) {
+		fprintf(stderr, "%s", usage_string);
+		return -1;
+	}
+
+	if (server_flag)
+		return usb_server();
+
+	for (tok = strtok(conns, ","); tok != NULL; tok = strtok(NULL, ",")) {
+		int nconns = atoi(tok);
+
+		if (nconns <= 0 || nconns > USB_MAX_CONNS) {
+			fprintf(stderr, "Invalid # of conns: %s\n", tok);
+			return -1;
+		}
+
+		rc = usb_run(target, nconns, duration);
+		if (rc != 0)
+			break;
+	}
+
+	return rc;
+}
@@ -1745,6 +1745,27 @@ LB_LINUX_TRY_COMPILE([
 ])
 ])
 
+#
+# 2.6.39 has on-stack plugging of block requests
+#
+AC_DEFUN([LC_HAVE_BLK_PLUG],
+[AC_MSG_CHECKING([if kernel has struct blk_plug])
+LB_LINUX_TRY_COMPILE([
+	#include <linux/blkdev.h>
+],[
+	struct blk_plug plug;
+
+	blk_start_plug(&plug);
+	blk_finish_plug(&plug);
+],[
+	AC_DEFINE(HAVE_BLK_PLUG, 1,
+		  [kernel has struct blk_plug])
+	AC_MSG_RESULT([yes])
+],[
+	AC_MSG_RESULT([no])
+])
+])
+
 #
 # 2.6.39 replace get_sb with mount in struct file_system_type
 #
@@ -2375,6 +2396,7 @@ AC_DEFUN([LC_PROG_LINUX],
 
          # 2.6.39
          LC_REQUEST_QUEUE_UNPLUG_FN
+	 LC_HAVE_BLK_PLUG
 	 LC_HAVE_FSTYPE_MOUNT
 
 	 # 3.0
@@ -378,6 +378,7 @@ typedef enum {
 #define LLOG_F_ZAP_WHEN_EMPTY   0x1
 #define LLOG_F_IS_CAT           0x2
 #define LLOG_F_IS_PLAIN         0x4
+#define LLOG_F_RESERVE          0x8
 
 #define PTL_RPC_MSG_REQUEST 4711
 #define PTL_RPC_MSG_ERR 4712
@@ -1164,6 +1165,7 @@ const value_string lustre_llog_hdr_llh_flags[]= {
   {LLOG_F_ZAP_WHEN_EMPTY , "LLOhdr_llh_G_F_ZAP_WHEN_EMPTY"},
   {LLOG_F_IS_CAT         , "LLOhdr_llh_G_F_IS_CAT"},
   {LLOG_F_IS_PLAIN       , "LLOG_F_IS_PLAIN"},
+  {LLOG_F_RESERVE        , "LLOG_F_RESERVE"},
   { 0, NULL }
 };
 
@@ -434,6 +434,11 @@ struct cl_object_header {
 	 * Size of cl_page + page slices
 	 */
 	unsigned short		 coh_page_bufsize;
+	/**
+	 * Index of the slab cache cl_page's of this object are allocated
+	 * from, -1 until the first page is allocated.
+	 */
+	short			 coh_page_kmem_index;
 	/**
 	 * Number of objects above this one: 0 for a top-object, 1 for its
 	 * sub-object, etc.
@@ -232,6 +232,9 @@ extern const struct dt_index_features dt_quota_slv_features;
 struct dt_allocation_hint {
         struct dt_object           *dah_parent;
         __u32                       dah_mode;
+	/* striping of a new directory, struct lmv_user_md */
+	const void		   *dah_eadata;
+	int			    dah_eadata_len;
 };
 
 /**
@@ -94,6 +94,8 @@ enum {
          LPROC_LL_LISTXATTR,
          LPROC_LL_REMOVEXATTR,
          LPROC_LL_INODE_PERM,
+         LPROC_LL_CREATE_BATCHED,
+         LPROC_LL_CREATE_UNBATCHED,
          LPROC_LL_FILE_OPCODES
 };
 
@@ -93,6 +93,10 @@ enum {
         BRW_W_DISK_IOSIZE,
         BRW_R_DIO_FRAGS,
         BRW_W_DIO_FRAGS,
+	BRW_R_BIO_SEGS,
+	BRW_W_BIO_SEGS,
+	BRW_R_SUBMIT_TIME,
+	BRW_W_SUBMIT_TIME,
         BRW_LAST,
 };
 
@@ -363,6 +363,24 @@ extern void lustre_som_swab(struct som_attrs *attrs);
 
 #define SOM_INCOMPAT_SUPP 0x0
 
+/**
+ * Lazy size-on-MDT attributes stored in a separate xattr: the size and blocks
+ * reported by the writers when they close the file.
+ */
+struct lsom_attrs {
+	/** LSOM_FL_* */
+	__u32	lsa_flags;
+	__u32	lsa_padding;
+	__u64	lsa_size;
+	__u64	lsa_blocks;
+};
+extern void lustre_lsom_swab(struct lsom_attrs *attrs);
+
+enum lsom_flags {
+	/* the size was exact when the last writer closed the file */
+	LSOM_FL_VALID	= 0x00000001,
+};
+
 /**
  * HSM on-disk attributes stored in a separate xattr.
  */
@@ -1305,6 +1323,13 @@ extern void lustre_swab_ptlrpc_body(struct ptlrpc_body *pb);
 #define OBD_CONNECT_LIGHTWEIGHT 0x1000000000000ULL/* lightweight connection */
 #define OBD_CONNECT_SHORTIO     0x2000000000000ULL/* short io */
 #define OBD_CONNECT_PINGLESS	0x4000000000000ULL/* pings not required */
+#define OBD_CONNECT_MULTIBRW	0x8000000000000ULL/* multi-object BRW write */
+#define OBD_CONNECT_DOM		0x10000000000000ULL/* data on MDT */
+#define OBD_CONNECT_BATCH_GETATTR 0x20000000000000ULL/* MDS_BATCH_GETATTR */
+#define OBD_CONNECT_LAZY_SIZE	0x40000000000000ULL/* lazy size-on-MDT */
+#define OBD_CONNECT_SYNC_BATCH	0x80000000000000ULL/* OST_SYNC_BATCH */
+#define OBD_CONNECT_STRIPED_DIR	0x100000000000000ULL/* dir striped over MDTs */
+#define OBD_CONNECT_QUOTA_BATCH	0x200000000000000ULL/* QUOTA_DQACQ_BATCH */
 /* XXX README XXX:
  * Please DO NOT add flag values here before first ensuring that this same
  * flag value is not in use on some other branch.  Please clear any such
@@ -1346,7 +1371,11 @@ extern void lustre_swab_ptlrpc_body(struct ptlrpc_body *pb);
 				OBD_CONNECT_EINPROGRESS | \
 				OBD_CONNECT_LIGHTWEIGHT | OBD_CONNECT_UMASK | \
 				OBD_CONNECT_LVB_TYPE | OBD_CONNECT_LAYOUTLOCK |\
-				OBD_CONNECT_PINGLESS)
+				OBD_CONNECT_PINGLESS | OBD_CONNECT_DOM | \
+				OBD_CONNECT_BATCH_GETATTR | \
+				OBD_CONNECT_LAZY_SIZE | \
+				OBD_CONNECT_STRIPED_DIR | \
+				OBD_CONNECT_QUOTA_BATCH)
 #define OST_CONNECT_SUPPORTED  (OBD_CONNECT_SRVLOCK | OBD_CONNECT_GRANT | \
                                 OBD_CONNECT_REQPORTAL | OBD_CONNECT_VERSION | \
                                 OBD_CONNECT_TRUNCLOCK | OBD_CONNECT_INDEX | \
@@ -1363,7 +1392,8 @@ extern void lustre_swab_ptlrpc_body(struct ptlrpc_body *pb);
 				OBD_CONNECT_JOBSTATS | \
 				OBD_CONNECT_LIGHTWEIGHT | OBD_CONNECT_LVB_TYPE|\
 				OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_FID | \
-				OBD_CONNECT_PINGLESS)
+				OBD_CONNECT_PINGLESS | OBD_CONNECT_MULTIBRW | \
+				OBD_CONNECT_SYNC_BATCH)
 #define ECHO_CONNECT_SUPPORTED (0)
 #define MGS_CONNECT_SUPPORTED  (OBD_CONNECT_VERSION | OBD_CONNECT_AT | \
 				OBD_CONNECT_FULL20 | OBD_CONNECT_IMP_RECOV | \
@@ -1488,6 +1518,7 @@ typedef enum {
         OST_QUOTACHECK = 18,
         OST_QUOTACTL   = 19,
 	OST_QUOTA_ADJUST_QUNIT = 20, /* not used since 2.4 */
+	OST_SYNC_BATCH = 21,
         OST_LAST_OPC
 } ost_cmd_t;
 #define OST_FIRST_OPC  OST_REPLY
@@ -1547,6 +1578,7 @@ enum obdo_flags {
 
 #define LOV_PATTERN_RAID0 0x001   /* stripes are used round-robin */
 #define LOV_PATTERN_RAID1 0x002   /* stripes are mirrors of each other */
+#define LOV_PATTERN_MDT   0x004   /* data is kept in the MDT inode (DoM) */
 #define LOV_PATTERN_FIRST 0x100   /* first stripe is not in round-robin */
 #define LOV_PATTERN_CMOBD 0x200
 
@@ -1648,6 +1680,7 @@ static inline void lmm_oi_cpu_to_le(struct ost_id *dst_oi,
 #define XATTR_NAME_FID          "trusted.fid"
 #define XATTR_NAME_VERSION      "trusted.version"
 #define XATTR_NAME_SOM		"trusted.som"
+#define XATTR_NAME_LSOM		"trusted.lsom"
 #define XATTR_NAME_HSM		"trusted.hsm"
 #define XATTR_NAME_LFSCK_NAMESPACE "trusted.lfsck_namespace"
 
@@ -1723,6 +1756,8 @@ struct lov_mds_md_v3 {            /* LOV EA mds/wire data (little-endian) */
 #define OBD_MD_FLRMTRGETFACL (0x0008000000000000ULL) /* lfs rgetfacl case */
 
 #define OBD_MD_FLDATAVERSION (0x0010000000000000ULL) /* iversion sum */
+#define OBD_MD_FLLAZYSIZE    (0x0020000000000000ULL) /* lazy size on MDT */
+#define OBD_MD_FLLAZYBLOCKS  (0x0040000000000000ULL) /* lazy blocks on MDT */
 
 #define OBD_MD_FLGETATTR (OBD_MD_FLID    | OBD_MD_FLATIME | OBD_MD_FLMTIME | \
                           OBD_MD_FLCTIME | OBD_MD_FLSIZE  | OBD_MD_FLBLKSZ | \
@@ -1916,6 +1951,12 @@ struct quota_body {
 /* qb_usage is the current qunit (in kbytes/inodes) when quota_body is used in
  * quota reply */
 #define qb_qunit	qb_usage
+/* status of each quota_body in a QUOTA_DQACQ_BATCH reply */
+#define qb_rc		qb_padding
+
+/* QUOTA_DQACQ_BATCH: non-intent dqacq requests of several IDs, one quota_body
+ * each, replied with one quota_body per request in the same order */
+#define QUOTA_DQACQ_BATCH_MAX	64
 
 #define QUOTA_DQACQ_FL_ACQ	0x1  /* acquire quota */
 #define QUOTA_DQACQ_FL_PREACQ	0x2  /* pre-acquire */
@@ -2011,6 +2052,7 @@ extern void lustre_swab_lquota_lvb(struct lquota_lvb *lvb);
 typedef enum {
 	QUOTA_DQACQ	= 601,
 	QUOTA_DQREL	= 602,
+	QUOTA_DQACQ_BATCH = 603,
 	QUOTA_LAST_OPC
 } quota_cmd_t;
 #define QUOTA_FIRST_OPC	QUOTA_DQACQ
@@ -2050,6 +2092,9 @@ typedef enum {
 	MDS_HSM_CT_REGISTER	= 59,
 	MDS_HSM_CT_UNREGISTER	= 60,
 	MDS_SWAP_LAYOUTS	= 61,
+	MDS_DOM_READ		= 62,
+	MDS_DOM_WRITE		= 63,
+	MDS_BATCH_GETATTR	= 64,
 	MDS_LAST_OPC
 } mds_cmd_t;
 
@@ -2101,8 +2146,9 @@ extern void lustre_swab_generic_32s (__u32 *val);
 #define MDS_INODELOCK_OPEN   0x000004       /* For opened files */
 #define MDS_INODELOCK_LAYOUT 0x000008       /* for layout */
 #define MDS_INODELOCK_PERM   0x000010       /* for permission */
+#define MDS_INODELOCK_DOM    0x000020       /* data kept on the MDT */
 
-#define MDS_INODELOCK_MAXSHIFT 4
+#define MDS_INODELOCK_MAXSHIFT 5
 /* This FULL lock is useful to take on unlink sort of operations */
 #define MDS_INODELOCK_FULL ((1<<(MDS_INODELOCK_MAXSHIFT+1))-1)
 
@@ -2222,6 +2268,44 @@ struct mdt_body {
 
 extern void lustre_swab_mdt_body (struct mdt_body *b);
 
+/* mdt_body::flags for MDS_DOM_READ/MDS_DOM_WRITE, where mdt_body::size is
+ * the file offset and mdt_body::nlink the byte count */
+enum {
+	MDS_DOM_FL_APPEND	= 1 << 0, /* write at the current file size */
+	MDS_DOM_FL_PUNCH	= 1 << 1, /* truncate the body at offset */
+	MDS_DOM_FL_MIGRATE	= 1 << 2, /* move the file to OST stripes:
+					   * freeze the body, or swap in the
+					   * layout of mdt_body::fid2 */
+};
+
+/* MDS_BATCH_GETATTR: stat a batch of names of the directory in mdt_body::fid1
+ * and grant an ibits lock on each of them. mdt_body::eadatasize is the room
+ * for the LOV EA of one entry. */
+#define MDS_BATCH_GETATTR_MAX	256
+#define MDS_BATCH_NAMES_MAX	(32 * 1024)
+
+struct mdt_batch_ent {
+	struct lustre_handle	mbe_handle;	/* client lock handle */
+	__u64			mbe_bits;	/* ibits wanted */
+	__u32			mbe_nameoff;	/* name offset in the names buf */
+	__u32			mbe_namelen;	/* without the trailing NUL */
+};
+
+extern void lustre_swab_mdt_batch_ent(struct mdt_batch_ent *e);
+
+/* One reply record per mdt_batch_ent. The LOV EAs follow in RMF_MDT_MD, each
+ * one padded to 8 bytes; mbr_body.eadatasize is 0 when there is none. */
+struct mdt_batch_rep {
+	struct mdt_body		mbr_body;
+	struct lustre_handle	mbr_handle;	/* server lock handle */
+	__u64			mbr_bits;	/* ibits granted */
+	__s32			mbr_status;	/* the client falls back to an
+						 * intent getattr if non-zero */
+	__u32			mbr_padding;
+};
+
+extern void lustre_swab_mdt_batch_rep(struct mdt_batch_rep *r);
+
 struct mdt_ioepoch {
         struct lustre_handle handle;
         __u64  ioepoch;
@@ -2597,6 +2681,11 @@ struct lmv_stripe_md {
 
 extern void lustre_swab_lmv_stripe_md(struct lmv_stripe_md *mea);
 
+static inline int lmv_stripe_md_size(int count)
+{
+	return sizeof(struct lmv_stripe_md) + count * sizeof(struct lu_fid);
+}
+
 /* lmv structures */
 #define MEA_MAGIC_LAST_CHAR      0xb2221ca1
 #define MEA_MAGIC_ALL_CHARS      0xb222a11c
@@ -3112,6 +3201,8 @@ enum llog_flag {
 	LLOG_F_ZAP_WHEN_EMPTY	= 0x1,
 	LLOG_F_IS_CAT		= 0x2,
 	LLOG_F_IS_PLAIN		= 0x4,
+	/* records may be appended out of order by reserved slots */
+	LLOG_F_RESERVE		= 0x8,
 };
 
 struct llog_log_hdr {
@@ -3257,6 +3348,20 @@ struct ll_fiemap_info_key {
 };
 
 extern void lustre_swab_ost_body (struct ost_body *b);
+
+/* OST_SYNC_BATCH: destroys and ownership changes of many objects, sent by the
+ * MDS from its llog of OST changes. The batch fits into OST_MAXREQSIZE. */
+#define OST_SYNC_BATCH_MAX	128
+
+struct ost_sync_rec {
+	struct ost_id	osr_oi;
+	__u32		osr_op;		/* OST_DESTROY or OST_SETATTR */
+	__u32		osr_count;	/* OST_DESTROY: number of objects */
+	__u32		osr_uid;	/* OST_SETATTR: new owner */
+	__u32		osr_gid;
+};
+
+extern void lustre_swab_ost_sync_rec(struct ost_sync_rec *r);
 extern void lustre_swab_ost_last_id(obd_id *id);
 extern void lustre_swab_fiemap(struct ll_user_fiemap *fiemap);
 
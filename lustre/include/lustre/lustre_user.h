@@ -298,6 +298,7 @@ struct ost_id {
 
 #define LOV_PATTERN_RAID0 0x001
 #define LOV_PATTERN_RAID1 0x002
+#define LOV_PATTERN_MDT   0x004
 #define LOV_PATTERN_FIRST 0x100
 
 #define LOV_MAXPOOLNAME 16
@@ -305,6 +306,7 @@ struct ost_id {
 
 #define LOV_MIN_STRIPE_BITS 16   /* maximum PAGE_SIZE (ia64), power of 2 */
 #define LOV_MIN_STRIPE_SIZE (1 << LOV_MIN_STRIPE_BITS)
+#define LOV_MAX_DOM_SIZE (1 << 20) /* largest LOV_PATTERN_MDT size limit */
 #define LOV_MAX_STRIPE_COUNT_OLD 160
 /* This calculation is crafted so that input of 4096 will result in 160
  * which in turn is equal to old maximal stripe count.
@@ -1011,6 +1011,13 @@ struct ldlm_lock {
 	 */
 	__u64			l_client_cookie;
 
+	/**
+	 * Transaction number of the update this lock protected when it was
+	 * saved as a COS lock. Used by fine-grained Commit on Share to skip
+	 * forced commits once that transaction is already on disk.
+	 */
+	__u64			l_transno;
+
 	/**
 	 * List item for locks waiting for cancellation from clients.
 	 * The lists this could be linked into are:
@@ -1597,6 +1604,14 @@ int ldlm_cli_enqueue_fini(struct obd_export *exp, struct ptlrpc_request *req,
                           ldlm_type_t type, __u8 with_policy, ldlm_mode_t mode,
 			  __u64 *flags, void *lvb, __u32 lvb_len,
                           struct lustre_handle *lockh, int rc);
+int ldlm_cli_batch_prep(struct obd_export *exp,
+			struct ldlm_enqueue_info *einfo,
+			const struct ldlm_res_id *res_id,
+			ldlm_policy_data_t const *policy,
+			struct lustre_handle *lockh);
+int ldlm_cli_batch_fini(struct obd_export *exp, struct lustre_handle *lockh,
+			ldlm_mode_t mode, const struct ldlm_res_id *res_id,
+			struct lustre_handle *remote, __u64 bits, int rc);
 int ldlm_cli_enqueue_local(struct ldlm_namespace *ns,
                            const struct ldlm_res_id *res_id,
                            ldlm_type_t type, ldlm_policy_data_t *policy,
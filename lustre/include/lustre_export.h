@@ -99,6 +99,11 @@ struct filter_export_data {
         long                       fed_pending;  /* bytes just being written */
         __u32                      fed_group;
 	__u8                       fed_pagesize; /* log2 of client page size */
+	/* write rate tracking for adaptive grant, under ofd_grant_lock */
+	__u64			   fed_write_bytes; /* in current window */
+	__u64			   fed_write_rate;  /* decayed, bytes/sec */
+	cfs_time_t		   fed_rate_stamp;  /* window start */
+	__u64			   fed_grant_shrunk; /* reclaimed bytes */
 };
 
 struct mgs_export_data {
@@ -359,6 +364,21 @@ static inline int exp_connect_layout(struct obd_export *exp)
 	return !!(exp_connect_flags(exp) & OBD_CONNECT_LAYOUTLOCK);
 }
 
+static inline int exp_connect_multibrw(struct obd_export *exp)
+{
+	return !!(exp_connect_flags(exp) & OBD_CONNECT_MULTIBRW);
+}
+
+static inline int exp_connect_dom(struct obd_export *exp)
+{
+	return !!(exp_connect_flags(exp) & OBD_CONNECT_DOM);
+}
+
+static inline int exp_connect_batch_getattr(struct obd_export *exp)
+{
+	return !!(exp_connect_flags(exp) & OBD_CONNECT_BATCH_GETATTR);
+}
+
 static inline bool exp_connect_lvb_type(struct obd_export *exp)
 {
 	LASSERT(exp != NULL);
@@ -140,6 +140,8 @@ int llog_reverse_process(const struct lu_env *env,
 			 void *data, void *catdata);
 int llog_cancel_rec(const struct lu_env *env, struct llog_handle *loghandle,
 		    int index);
+int llog_cancel_arr_rec(const struct lu_env *env,
+			struct llog_handle *loghandle, int num, int *index);
 int llog_open(const struct lu_env *env, struct llog_ctxt *ctxt,
 	      struct llog_handle **lgh, struct llog_logid *logid,
 	      char *name, enum llog_open_param open_param);
@@ -192,6 +194,9 @@ int llog_cat_add(const struct lu_env *env, struct llog_handle *cathandle,
 int llog_cat_cancel_records(const struct lu_env *env,
 			    struct llog_handle *cathandle, int count,
 			    struct llog_cookie *cookies);
+int llog_cat_purge(const struct lu_env *env, struct llog_handle *cathandle,
+		   llog_cb_t cb, void *data, __u64 *cancelled,
+		   int *destroyed);
 int llog_cat_process_or_fork(const struct lu_env *env,
 			     struct llog_handle *cat_llh, llog_cb_t cb,
 			     void *data, int startcat, int startidx, bool fork);
@@ -311,6 +316,7 @@ struct llog_operations {
 struct llog_handle {
 	struct rw_semaphore	 lgh_lock;
 	spinlock_t		 lgh_hdr_lock; /* protect lgh_hdr data */
+	struct mutex		 lgh_hdr_mutex; /* serialize header writes */
 	struct llog_logid	 lgh_id; /* id of this log */
 	struct llog_log_hdr	*lgh_hdr;
 	struct file		*lgh_file;
@@ -318,6 +324,11 @@ struct llog_handle {
 	int			 lgh_last_idx;
 	int			 lgh_cur_idx; /* used during llog_process */
 	__u64			 lgh_cur_offset; /* used during llog_process */
+	/* next append offset, valid for plain logs in reserved mode */
+	__u64			 lgh_write_offset;
+	/* catalog: append to plain logs by reserved slots;
+	 * plain log: reserved-slot append is active */
+	unsigned int		 lgh_reserve:1;
 	struct llog_ctxt	*lgh_ctxt;
 	union {
 		struct plain_handle_data	 phd;
@@ -361,6 +372,7 @@ struct llog_ctxt {
 
 #define LLOG_PROC_BREAK 0x0001
 #define LLOG_DEL_RECORD 0x0002
+#define LLOG_KEEP_RECORD 0x0004 /* llog_cat_purge(): leave this one */
 
 static inline int llog_obd2ops(struct llog_ctxt *ctxt,
                                struct llog_operations **lop)
@@ -96,6 +96,10 @@ struct qmt_handlers {
 	int (*qmth_dqacq)(const struct lu_env *, struct lu_device *,
 			  struct ptlrpc_request *);
 
+	/* Handle a batch of dqacq/dqrel requests for several IDs. */
+	int (*qmth_dqacq_batch)(const struct lu_env *, struct lu_device *,
+				struct ptlrpc_request *);
+
 	/* LDLM intent policy associated with quota locks */
 	int (*qmth_intent_policy)(const struct lu_env *, struct lu_device *,
 				  struct ptlrpc_request *, struct ldlm_lock **,
@@ -208,6 +212,9 @@ struct lquota_id_info {
 	 * be negative when releasing space.  */
 	long long		 lqi_space;
 
+	/* part of lqi_space charged to a per-CPU reservation on the slave */
+	long long		 lqi_rsv_space;
+
 	/* quota slave entry structure associated with this ID */
 	struct lquota_entry	*lqi_qentry;
 
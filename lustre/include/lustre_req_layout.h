@@ -188,7 +188,11 @@ extern struct req_format RQF_MDS_QUOTACHECK;
 extern struct req_format RQF_MDS_QUOTACTL;
 extern struct req_format RQF_QC_CALLBACK;
 extern struct req_format RQF_QUOTA_DQACQ;
+extern struct req_format RQF_QUOTA_DQACQ_BATCH;
 extern struct req_format RQF_MDS_SWAP_LAYOUTS;
+extern struct req_format RQF_MDS_DOM_READ;
+extern struct req_format RQF_MDS_DOM_WRITE;
+extern struct req_format RQF_MDS_BATCH_GETATTR;
 /* MDS hsm formats */
 extern struct req_format RQF_MDS_HSM_STATE_GET;
 extern struct req_format RQF_MDS_HSM_STATE_SET;
@@ -208,6 +212,7 @@ extern struct req_format RQF_OST_CREATE;
 extern struct req_format RQF_OST_PUNCH;
 extern struct req_format RQF_OST_SYNC;
 extern struct req_format RQF_OST_DESTROY;
+extern struct req_format RQF_OST_SYNC_BATCH;
 extern struct req_format RQF_OST_BRW_READ;
 extern struct req_format RQF_OST_BRW_WRITE;
 extern struct req_format RQF_OST_STATFS;
@@ -282,11 +287,15 @@ extern struct req_msg_field RMF_CAPA2;
 extern struct req_msg_field RMF_OBD_QUOTACHECK;
 extern struct req_msg_field RMF_OBD_QUOTACTL;
 extern struct req_msg_field RMF_QUOTA_BODY;
+extern struct req_msg_field RMF_QUOTA_BATCH;
 extern struct req_msg_field RMF_STRING;
 extern struct req_msg_field RMF_SWAP_LAYOUTS;
 extern struct req_msg_field RMF_MDS_HSM_PROGRESS;
 extern struct req_msg_field RMF_MDS_HSM_REQUEST;
 extern struct req_msg_field RMF_MDS_HSM_USER_ITEM;
+extern struct req_msg_field RMF_MDT_BATCH_ENT;
+extern struct req_msg_field RMF_MDT_BATCH_NAMES;
+extern struct req_msg_field RMF_MDT_BATCH_REP;
 extern struct req_msg_field RMF_MDS_HSM_ARCHIVE;
 extern struct req_msg_field RMF_HSM_USER_STATE;
 extern struct req_msg_field RMF_HSM_STATE_SET;
@@ -310,6 +319,7 @@ extern struct req_msg_field RMF_MGS_TARGET_INFO;
 extern struct req_msg_field RMF_MGS_SEND_PARAM;
 
 extern struct req_msg_field RMF_OST_BODY;
+extern struct req_msg_field RMF_OST_SYNC_REC;
 extern struct req_msg_field RMF_OBD_IOOBJ;
 extern struct req_msg_field RMF_OBD_ID;
 extern struct req_msg_field RMF_FID;
@@ -130,6 +130,12 @@ struct lov_stripe_md {
 #define lsm_stripe_count lsm_wire.lw_stripe_count
 #define lsm_pool_name    lsm_wire.lw_pool_name
 
+/* file data is kept in the MDT inode, there are no OST objects */
+static inline int lsm_is_dom(const struct lov_stripe_md *lsm)
+{
+	return lsm != NULL && lsm->lsm_pattern == LOV_PATTERN_MDT;
+}
+
 struct obd_info;
 
 typedef int (*obd_enqueue_update_f)(void *cookie, int rc);
@@ -400,6 +406,7 @@ struct timeout_item {
 #define OSC_MAX_DIRTY_DEFAULT  (OSC_MAX_RIF_DEFAULT * 4)
 #define OSC_MAX_DIRTY_MB_MAX   2048     /* arbitrary, but < MAX_LONG bytes */
 #define OSC_DEFAULT_RESENDS      10
+#define OSC_BRW_OBJS_DEFAULT      8
 
 /* possible values for fo_sync_lock_cancel */
 enum {
@@ -414,6 +421,15 @@ enum {
 
 struct mdc_rpc_lock;
 struct obd_import;
+/* Pages added to the LRU of a client_obd are first staged on the batch of
+ * the current CPT, and moved to client_obd::cl_lru_list in bulk, so that
+ * cl_lru_list_lock is taken once per batch rather than once per page. */
+struct cl_lru_batch {
+	spinlock_t		 clb_lock;
+	cfs_list_t		 clb_list;
+	int			 clb_nr;
+};
+
 struct client_obd {
 	struct rw_semaphore  cl_sem;
         struct obd_uuid          cl_target_uuid;
@@ -485,6 +501,8 @@ struct client_obd {
 	cfs_atomic_t             cl_pending_r_pages;
 	__u32			 cl_max_pages_per_rpc;
         int                      cl_max_rpcs_in_flight;
+	/* max # of objects packed into one write RPC, 1 disables it */
+	int			 cl_max_brw_objs;
         struct obd_histogram     cl_read_rpc_hist;
         struct obd_histogram     cl_write_rpc_hist;
         struct obd_histogram     cl_read_page_hist;
@@ -501,6 +519,13 @@ struct client_obd {
 	cfs_atomic_t		 cl_lru_in_list;
 	cfs_list_t		 cl_lru_list; /* lru page list */
 	client_obd_lock_t	 cl_lru_list_lock; /* page list protector */
+	/* per-CPT batches of pages staged for cl_lru_list */
+	struct cl_lru_batch	**cl_lru_batches;
+	/* cl_lru_list_lock statistics, updated with the lock held */
+	__u64			 cl_lru_lock_count;
+	__u64			 cl_lru_lock_usec;
+	long			 cl_lru_lock_max_usec;
+	__u64			 cl_lru_batch_flushes;
 
         /* number of in flight destroy rpcs is limited to max_rpcs_in_flight */
         cfs_atomic_t             cl_destroy_in_flight;
@@ -1224,6 +1249,10 @@ struct md_op_data {
 	/* Used by readdir */
 	__u32                   op_npages;
 
+	/* Used by Data-on-MDT I/O, see MDS_DOM_FL_* */
+	__u32			op_count;
+	__u32			op_dom_flags;
+
 	/* used to transfer info between the stacks of MD client
 	 * see enum op_cli_flags */
 	__u32			op_cli_flags;
@@ -1240,6 +1269,11 @@ typedef int (* md_enqueue_cb_t)(struct ptlrpc_request *req,
                                 struct md_enqueue_info *minfo,
                                 int rc);
 
+struct md_batch_info;
+/* batched stat-ahead, called once per MDS_BATCH_GETATTR reply */
+typedef int (* md_batch_cb_t)(struct ptlrpc_request *req,
+			      struct md_batch_info *mbi, int rc);
+
 /* seq client type */
 enum lu_cli_type {
 	LUSTRE_SEQ_METADATA = 1,
@@ -1256,6 +1290,28 @@ struct md_enqueue_info {
         unsigned int            mi_generation;
 };
 
+/* one name of a MDS_BATCH_GETATTR */
+struct md_batch_item {
+	const char		*mbi_name;
+	int			 mbi_namelen;
+	__u64			 mbi_cbdata;
+	/* the rest is filled from the reply, mbi_lockh is set and unused
+	 * when mbi_rc is 0 */
+	int			 mbi_rc;
+	struct lustre_handle	 mbi_lockh;
+	struct mdt_body		*mbi_body;
+	void			*mbi_ea;
+};
+
+struct md_batch_info {
+	struct md_op_data	 mbi_data;	/* parent directory */
+	struct inode		*mbi_dir;
+	md_batch_cb_t		 mbi_cb;
+	unsigned int		 mbi_generation;
+	int			 mbi_count;
+	struct md_batch_item	 mbi_items[0];
+};
+
 struct obd_ops {
         cfs_module_t *o_owner;
         int (*o_iocontrol)(unsigned int cmd, struct obd_export *exp, int len,
@@ -1329,6 +1385,10 @@ struct obd_ops {
                          struct obdo *oa, struct lov_stripe_md *ea,
                          struct obd_trans_info *oti, struct obd_export *md_exp,
                          void *capa);
+	/* destroy/setattr a batch of objects, see OST_SYNC_BATCH */
+	int (*o_sync_batch)(const struct lu_env *env, struct obd_export *exp,
+			    struct ost_sync_rec *recs, int count,
+			    struct obd_trans_info *oti);
         int (*o_setattr)(const struct lu_env *, struct obd_export *exp,
                          struct obd_info *oinfo, struct obd_trans_info *oti);
         int (*o_setattr_async)(struct obd_export *exp, struct obd_info *oinfo,
@@ -1508,6 +1568,8 @@ struct md_ops {
                       struct obd_capa *, struct ptlrpc_request **);
         int (*m_readpage)(struct obd_export *, struct md_op_data *,
                           struct page **, struct ptlrpc_request **);
+	int (*m_dom_rw)(struct obd_export *, struct md_op_data *, int,
+			struct page **, struct ptlrpc_request **);
 
         int (*m_unlink)(struct obd_export *, struct md_op_data *,
                         struct ptlrpc_request **);
@@ -1558,6 +1620,10 @@ struct md_ops {
                                       struct md_enqueue_info *,
                                       struct ldlm_enqueue_info *);
 
+	int (*m_batch_getattr_async)(struct obd_export *,
+				     struct md_batch_info *,
+				     struct ldlm_enqueue_info *);
+
         int (*m_revalidate_lock)(struct obd_export *, struct lookup_intent *,
                                  struct lu_fid *, __u64 *bits);
 
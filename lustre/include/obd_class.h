@@ -869,6 +869,21 @@ static inline int obd_destroy(const struct lu_env *env, struct obd_export *exp,
         RETURN(rc);
 }
 
+static inline int obd_sync_batch(const struct lu_env *env,
+				 struct obd_export *exp,
+				 struct ost_sync_rec *recs, int count,
+				 struct obd_trans_info *oti)
+{
+	int rc;
+	ENTRY;
+
+	EXP_CHECK_DT_OP(exp, sync_batch);
+	EXP_COUNTER_INCREMENT(exp, sync_batch);
+
+	rc = OBP(exp->exp_obd, sync_batch)(env, exp, recs, count, oti);
+	RETURN(rc);
+}
+
 static inline int obd_getattr(const struct lu_env *env, struct obd_export *exp,
                               struct obd_info *oinfo)
 {
@@ -2041,6 +2056,19 @@ static inline int md_readpage(struct obd_export *exp, struct md_op_data *opdata,
         RETURN(rc);
 }
 
+/* Synchronous Data-on-MDT read or write (@cmd is OBD_BRW_READ/WRITE) */
+static inline int md_dom_rw(struct obd_export *exp, struct md_op_data *opdata,
+			    int cmd, struct page **pages,
+			    struct ptlrpc_request **request)
+{
+	int rc;
+	ENTRY;
+	EXP_CHECK_MD_OP(exp, dom_rw);
+	EXP_MD_COUNTER_INCREMENT(exp, dom_rw);
+	rc = MDP(exp->exp_obd, dom_rw)(exp, opdata, cmd, pages, request);
+	RETURN(rc);
+}
+
 static inline int md_unlink(struct obd_export *exp, struct md_op_data *op_data,
                             struct ptlrpc_request **request)
 {
@@ -2221,6 +2249,18 @@ static inline int md_intent_getattr_async(struct obd_export *exp,
         RETURN(rc);
 }
 
+static inline int md_batch_getattr_async(struct obd_export *exp,
+					 struct md_batch_info *mbi,
+					 struct ldlm_enqueue_info *einfo)
+{
+	int rc;
+	ENTRY;
+	EXP_CHECK_MD_OP(exp, batch_getattr_async);
+	EXP_MD_COUNTER_INCREMENT(exp, batch_getattr_async);
+	rc = MDP(exp->exp_obd, batch_getattr_async)(exp, mbi, einfo);
+	RETURN(rc);
+}
+
 static inline int md_revalidate_lock(struct obd_export *exp,
                                      struct lookup_intent *it,
                                      struct lu_fid *fid, __u64 *bits)
@@ -242,6 +242,9 @@ int obd_alloc_fail(const void *ptr, const char *name, const char *type,
 #define OBD_FAIL_MDS_SWAP_LAYOUTS_NET		0x14f
 #define OBD_FAIL_MDS_HSM_ACTION_NET		0x150
 #define OBD_FAIL_MDS_CHANGELOG_INIT		0x151
+#define OBD_FAIL_MDS_DOM_READ_NET		0x152
+#define OBD_FAIL_MDS_DOM_WRITE_NET		0x153
+#define OBD_FAIL_MDS_DOM_WRITE_NET_REP		0x154
 
 /* layout lock */
 #define OBD_FAIL_MDS_NO_LL_GETATTR	 0x170
@@ -361,6 +364,7 @@ int obd_alloc_fail(const void *ptr, const char *name, const char *type,
 #define OBD_FAIL_OSC_CP_ENQ_RACE         0x410
 #define OBD_FAIL_OSC_NO_GRANT            0x411
 #define OBD_FAIL_OSC_DELAY_SETTIME	 0x412
+#define OBD_FAIL_OSC_BRW_OVERSIZE	 0x413
 
 #define OBD_FAIL_PTLRPC                  0x500
 #define OBD_FAIL_PTLRPC_ACK              0x501
@@ -428,6 +432,7 @@ int obd_alloc_fail(const void *ptr, const char *name, const char *type,
 #define OBD_FAIL_QUOTA_EDQUOT            0xA02
 #define OBD_FAIL_QUOTA_DELAY_REINT       0xA03
 #define OBD_FAIL_QUOTA_RECOVERABLE_ERR   0xA04
+#define OBD_FAIL_QUOTA_DQACQ_BATCH_NET		0xA05
 
 #define OBD_FAIL_LPROC_REMOVE            0xB00
 
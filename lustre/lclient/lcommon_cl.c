@@ -1186,7 +1186,8 @@ int cl_file_inode_init(struct inode *inode, struct lustre_md *md)
                          * locked by I_NEW bit.
                          */
                         lli->lli_clob = clob;
-			lli->lli_has_smd = md->lsm != NULL;
+			lli->lli_has_smd = md->lsm != NULL &&
+					   !lsm_is_dom(md->lsm);
                         lu_object_ref_add(&clob->co_lu, "inode", inode);
                 } else
                         result = PTR_ERR(clob);
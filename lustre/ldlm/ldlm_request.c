@@ -713,6 +713,114 @@ cleanup:
 }
 EXPORT_SYMBOL(ldlm_cli_enqueue_fini);
 
+/**
+ * Create a client ibits lock that is granted by a batched RPC instead of its
+ * own LDLM_ENQUEUE, like MDS_BATCH_GETATTR. The handle is sent to the server
+ * so that blocking ASTs racing with the reply find the lock.
+ *
+ * The lock must be completed or dropped by ldlm_cli_batch_fini().
+ */
+int ldlm_cli_batch_prep(struct obd_export *exp,
+			struct ldlm_enqueue_info *einfo,
+			const struct ldlm_res_id *res_id,
+			ldlm_policy_data_t const *policy,
+			struct lustre_handle *lockh)
+{
+	const struct ldlm_callback_suite cbs = {
+		.lcs_completion = einfo->ei_cb_cp,
+		.lcs_blocking   = einfo->ei_cb_bl,
+		.lcs_glimpse    = einfo->ei_cb_gl,
+		.lcs_weigh      = einfo->ei_cb_wg
+	};
+	struct ldlm_lock *lock;
+	ENTRY;
+
+	LASSERT(einfo->ei_type == LDLM_IBITS);
+
+	lock = ldlm_lock_create(exp->exp_obd->obd_namespace, res_id,
+				einfo->ei_type, einfo->ei_mode, &cbs,
+				einfo->ei_cbdata, 0, LVB_T_NONE);
+	if (lock == NULL)
+		RETURN(-ENOMEM);
+
+	/* for the local lock, add the reference */
+	ldlm_lock_addref_internal(lock, einfo->ei_mode);
+	ldlm_lock2handle(lock, lockh);
+	lock->l_policy_data = *policy;
+	lock->l_conn_export = exp;
+	lock->l_export = NULL;
+	lock->l_blocking_ast = einfo->ei_cb_bl;
+
+	LDLM_DEBUG(lock, "client-side batch enqueue START");
+	RETURN(0);
+}
+EXPORT_SYMBOL(ldlm_cli_batch_prep);
+
+/**
+ * Finish a lock created by ldlm_cli_batch_prep() with the server lock handle
+ * \a remote and the granted \a bits of the reply, or drop it locally if \a rc
+ * is not zero or the server did not grant it. The lock is moved to
+ * \a res_id, the resource of the child the server locked.
+ */
+int ldlm_cli_batch_fini(struct obd_export *exp, struct lustre_handle *lockh,
+			ldlm_mode_t mode, const struct ldlm_res_id *res_id,
+			struct lustre_handle *remote, __u64 bits, int rc)
+{
+	struct ldlm_namespace *ns = exp->exp_obd->obd_namespace;
+	struct ldlm_lock      *lock;
+	__u64                  flags = 0;
+	ENTRY;
+
+	lock = ldlm_handle2lock(lockh);
+	LASSERT(lock != NULL);
+
+	if (rc == 0 && !lustre_handle_is_used(remote))
+		rc = ELDLM_LOCK_ABORTED;
+	if (rc != 0) {
+		LDLM_DEBUG(lock, "client-side batch enqueue END (%s)",
+			   rc == ELDLM_LOCK_ABORTED ? "ABORTED" : "FAILED");
+		GOTO(cleanup, rc);
+	}
+
+	if (memcmp(res_id, &lock->l_resource->lr_name, sizeof(*res_id))) {
+		rc = ldlm_lock_change_resource(ns, lock, res_id);
+		if (rc || lock->l_resource == NULL)
+			GOTO(cleanup, rc = -ENOMEM);
+	}
+
+	lock_res_and_lock(lock);
+	if (exp->exp_lock_hash) {
+		/* In the function below, .hs_keycmp resolves to
+		 * ldlm_export_lock_keycmp() */
+		/* coverity[overrun-buffer-val] */
+		cfs_hash_rehash_key(exp->exp_lock_hash,
+				    &lock->l_remote_handle,
+				    remote, &lock->l_exp_hash);
+	} else {
+		lock->l_remote_handle = *remote;
+	}
+	lock->l_policy_data.l_inodebits.bits = bits;
+	unlock_res_and_lock(lock);
+
+	rc = ldlm_lock_enqueue(ns, &lock, NULL, &flags);
+	if (lock->l_completion_ast != NULL) {
+		int err = lock->l_completion_ast(lock, flags, NULL);
+		if (!rc)
+			rc = err;
+	}
+
+	LDLM_DEBUG(lock, "client-side batch enqueue END");
+	EXIT;
+cleanup:
+	if (rc)
+		failed_lock_cleanup(ns, lock, mode);
+	/* the second reference is held by ldlm_cli_batch_prep() */
+	LDLM_LOCK_PUT(lock);
+	LDLM_LOCK_RELEASE(lock);
+	return rc;
+}
+EXPORT_SYMBOL(ldlm_cli_batch_fini);
+
 /**
  * Estimate number of lock handles that would fit into request of given
  * size.  PAGE_SIZE-512 is to allow TCP/IP and LNET headers to fit into
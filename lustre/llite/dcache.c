@@ -414,6 +414,11 @@ int ll_revalidate_it(struct dentry *de, int lookup_flags,
 		if (d_lustre_invalid(de))
                         RETURN(0);
 
+		/* creates in the shards of a striped directory do not revoke
+		 * the UPDATE lock of the master */
+		if (ll_i2info(parent)->lli_lsm_md != NULL)
+			RETURN(0);
+
                 ibits = MDS_INODELOCK_UPDATE;
                 rc = ll_have_md_lock(parent, &ibits, LCK_MINMODE);
                 GOTO(out_sa, rc);
@@ -402,6 +402,10 @@ struct page *ll_get_dir_page(struct inode *dir, __u64 hash,
         ldlm_lock_dump_handle(D_OTHER, &lockh);
 
 	mutex_lock(&lli->lli_readdir_mutex);
+	/* the lock above does not cover the shards of a striped directory,
+	 * so its pages are only trusted until the next readdir from start */
+	if (lli->lli_lsm_md != NULL && hash == 0)
+		truncate_inode_pages(mapping, 0);
         page = ll_dir_page_locate(dir, &lhash, &start, &end);
         if (IS_ERR(page)) {
                 CERROR("dir page locate: "DFID" at "LPU64": rc %ld\n",
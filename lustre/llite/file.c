@@ -299,7 +299,7 @@ int ll_file_release(struct inode *inode, struct file *file)
         struct ll_file_data *fd;
         struct ll_sb_info *sbi = ll_i2sbi(inode);
         struct ll_inode_info *lli = ll_i2info(inode);
-        int rc;
+	int rc = 0, rc2;
         ENTRY;
 
         CDEBUG(D_VFSTRACE, "VFS Op:inode=%lu/%u(%p)\n", inode->i_ino,
@@ -340,9 +340,18 @@ int ll_file_release(struct inode *inode, struct file *file)
         if (!S_ISDIR(inode->i_mode)) {
 		lov_read_and_clear_async_rc(lli->lli_clob);
                 lli->lli_async_rc = 0;
+		/* not flushed if the file was not closed by close(2), the
+		 * error is left for the next fsync() or close() */
+		if (ll_batch_pending(inode) && fd->fd_omode & FMODE_WRITE) {
+			rc = ll_batch_flush(inode, file, LL_BATCH_IO);
+			if (rc < 0)
+				lli->lli_async_rc = rc;
+		}
         }
 
-        rc = ll_md_close(sbi->ll_md_exp, inode, file);
+	rc2 = ll_md_close(sbi->ll_md_exp, inode, file);
+	if (rc == 0)
+		rc = rc2;
 
         if (CFS_FAIL_TIMEOUT_MS(OBD_FAIL_PTLRPC_DUMP_LOG, cfs_fail_val))
                 libcfs_debug_dumplog();
@@ -654,6 +663,10 @@ restart:
 
         ll_capa_open(inode);
 
+	if (lli->lli_dom_size != 0 && file->f_mode & FMODE_WRITE &&
+	    it_disposition(it, DISP_OPEN_CREATE))
+		ll_batch_start(inode, file);
+
 	if (!lli->lli_has_smd) {
                 if (file->f_flags & O_LOV_DELAY_CREATE ||
                     !(file->f_mode & FMODE_WRITE)) {
@@ -702,6 +715,9 @@ static int ll_lsm_getattr(struct lov_stripe_md *lsm, struct obd_export *exp,
         ENTRY;
 
         LASSERT(lsm != NULL);
+	/* DoM file attributes are kept by the MDT only */
+	if (lsm_is_dom(lsm))
+		RETURN(-EOPNOTSUPP);
 
         oinfo.oi_md = lsm;
         oinfo.oi_oa = obdo;
@@ -850,17 +866,355 @@ void ll_io_init(struct cl_io *io, const struct file *file, int write)
         }
 }
 
+/*
+ * Data-on-MDT I/O.
+ *
+ * The body of a DoM file is kept in the MDT inode. It is read and written
+ * synchronously through the MDC, bypassing the page cache and the CLIO
+ * stack. A file that outgrows its DoM size limit is migrated to OST stripes
+ * and the I/O is then restarted through CLIO.
+ */
+
+/* Move @count bytes between @pages, starting @start bytes into them, and
+ * the user buffers of @iov */
+static int ll_dom_copy(struct page **pages, size_t start,
+		       const struct iovec *iov, unsigned long nr_segs,
+		       size_t count, int cmd)
+{
+	unsigned long	seg;
+	size_t		done = 0;
+
+	for (seg = 0; seg < nr_segs && done < count; seg++) {
+		char __user	*buf = iov[seg].iov_base;
+		size_t		 left = min(iov[seg].iov_len, count - done);
+
+		while (left > 0) {
+			size_t	 at = start + done;
+			size_t	 off = at & (CFS_PAGE_SIZE - 1);
+			size_t	 len = min_t(size_t, left, CFS_PAGE_SIZE - off);
+			char	*kaddr = kmap(pages[at >> CFS_PAGE_SHIFT]);
+			int	 rc;
+
+			if (cmd == OBD_BRW_READ)
+				rc = copy_to_user(buf, kaddr + off, len);
+			else
+				rc = copy_from_user(kaddr + off, buf, len);
+			kunmap(pages[at >> CFS_PAGE_SHIFT]);
+			if (rc != 0)
+				return -EFAULT;
+
+			buf += len;
+			left -= len;
+			done += len;
+		}
+	}
+	return 0;
+}
+
+static void ll_dom_pages_free(struct page **pages, int npages)
+{
+	int i;
+
+	for (i = 0; i < npages; i++)
+		if (pages[i] != NULL)
+			cfs_free_page(pages[i]);
+	OBD_FREE(pages, npages * sizeof(*pages));
+}
+
+static struct page **ll_dom_pages_alloc(int npages)
+{
+	struct page	**pages;
+	int		  i;
+
+	OBD_ALLOC(pages, npages * sizeof(*pages));
+	if (pages == NULL)
+		return NULL;
+
+	for (i = 0; i < npages; i++) {
+		pages[i] = cfs_alloc_page(CFS_ALLOC_STD);
+		if (pages[i] == NULL) {
+			ll_dom_pages_free(pages, npages);
+			return NULL;
+		}
+	}
+	return pages;
+}
+
+/**
+ * Send one DoM read or write RPC for @inode.
+ *
+ * \retval bytes transferred, the file size is returned in @size
+ * \retval negative errno on failure
+ */
+static int ll_dom_rpc(struct inode *inode, int cmd, loff_t offset,
+		      size_t count, __u32 flags, struct page **pages,
+		      int npages, __u64 *size)
+{
+	struct ptlrpc_request	*req = NULL;
+	struct md_op_data	*op_data;
+	struct mdt_body		*body;
+	int			 rc;
+	ENTRY;
+
+	op_data = ll_prep_md_op_data(NULL, inode, NULL, NULL, 0, 0,
+				     LUSTRE_OPC_ANY, NULL);
+	if (IS_ERR(op_data))
+		RETURN(PTR_ERR(op_data));
+
+	op_data->op_offset = offset;
+	op_data->op_count = count;
+	op_data->op_npages = npages;
+	op_data->op_dom_flags = flags;
+
+	rc = md_dom_rw(ll_i2mdexp(inode), op_data, cmd, pages, &req);
+	ll_finish_md_op_data(op_data);
+	if (rc != 0)
+		RETURN(rc);
+
+	body = req_capsule_server_get(&req->rq_pill, &RMF_MDT_BODY);
+	if (size != NULL)
+		*size = body->size;
+	rc = body->nlink;
+	ptlrpc_req_finished(req);
+	RETURN(rc);
+}
+
+/**
+ * Truncate the body of a DoM file to @size. Returns -ESTALE if the file
+ * has been moved to OSTs meanwhile, with the new layout fetched.
+ */
+int ll_dom_punch(struct inode *inode, loff_t size)
+{
+	__u32	gen;
+	int	rc;
+
+	rc = ll_dom_rpc(inode, OBD_BRW_WRITE, size, 0, MDS_DOM_FL_PUNCH,
+			NULL, 0, NULL);
+	if (rc == -ESTALE) {
+		rc = ll_layout_refresh(inode, &gen);
+		if (rc == 0)
+			rc = -ESTALE;
+	}
+	return rc < 0 ? rc : 0;
+}
+
+/**
+ * Read or write the body of a DoM file.
+ *
+ * \retval -EAGAIN the file is not (or can no longer be) a DoM file, the
+ *		   caller has to do the I/O through CLIO
+ */
+static ssize_t ll_dom_io(struct vvp_io_args *args, struct file *file,
+			 enum cl_io_type iot, loff_t *ppos, size_t count)
+{
+	struct inode		*inode = file->f_dentry->d_inode;
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	struct ll_file_data	*fd = LUSTRE_FPRIVATE(file);
+	struct iovec		*iov = args->u.normal.via_iov;
+	unsigned long		 nr_segs = args->u.normal.via_nrsegs;
+	struct page		**pages;
+	__u32			 limit = lli->lli_dom_size;
+	__u32			 flags = 0;
+	loff_t			 pos = *ppos;
+	__u64			 size = 0;
+	__u32			 gen;
+	int			 cmd;
+	int			 npages;
+	int			 locked = 0;
+	ssize_t			 rc;
+	ENTRY;
+
+	if (limit == 0)
+		RETURN(-EAGAIN);
+	/* sendfile and splice go through the page cache */
+	if (args->via_io_subtype != IO_NORMAL)
+		RETURN(-EINVAL);
+	if (count == 0)
+		RETURN(0);
+
+	if (iot == CIT_WRITE) {
+		cmd = OBD_BRW_WRITE;
+		if (file->f_flags & O_APPEND) {
+			/* the MDT writes at its own idea of the file size */
+			flags |= MDS_DOM_FL_APPEND;
+			pos = i_size_read(inode);
+		}
+		if (pos + count > limit) {
+			rc = ll_dom_migrate(inode, file);
+			RETURN(rc < 0 ? rc : -EAGAIN);
+		}
+	} else {
+		cmd = OBD_BRW_READ;
+		if (pos >= limit)
+			RETURN(0);
+		count = min_t(size_t, count, limit - pos);
+	}
+
+	npages = (count + CFS_PAGE_SIZE - 1) >> CFS_PAGE_SHIFT;
+	pages = ll_dom_pages_alloc(npages);
+	if (pages == NULL)
+		RETURN(-ENOMEM);
+
+	if (iot == CIT_WRITE) {
+		rc = ll_dom_copy(pages, 0, iov, nr_segs, count, cmd);
+		if (rc != 0)
+			GOTO(out, rc);
+		if (!(fd->fd_flags & LL_FILE_GROUP_LOCKED)) {
+			if (mutex_lock_interruptible(&lli->lli_write_mutex))
+				GOTO(out, rc = -ERESTARTSYS);
+			locked = 1;
+		}
+	} else {
+		down_read(&lli->lli_trunc_sem);
+	}
+
+	rc = ll_dom_rpc(inode, cmd, pos, count, flags, pages, npages, &size);
+
+	if (locked)
+		mutex_unlock(&lli->lli_write_mutex);
+	else if (iot == CIT_READ)
+		up_read(&lli->lli_trunc_sem);
+
+	if (rc == -EFBIG && iot == CIT_WRITE) {
+		/* appending write past the limit */
+		rc = ll_dom_migrate(inode, file);
+		GOTO(out, rc = rc < 0 ? rc : -EAGAIN);
+	} else if (rc == -ESTALE) {
+		/* migrated to OSTs by another client */
+		rc = ll_layout_refresh(inode, &gen);
+		GOTO(out, rc = rc < 0 ? rc : -EAGAIN);
+	} else if (rc < 0) {
+		GOTO(out, rc);
+	}
+
+	if (iot == CIT_READ) {
+		if (rc > 0 && ll_dom_copy(pages, 0, iov, nr_segs, rc, cmd) != 0)
+			GOTO(out, rc = -EFAULT);
+		*ppos = pos + rc;
+	} else {
+		*ppos = flags & MDS_DOM_FL_APPEND ? size : pos + rc;
+	}
+	cl_isize_write(inode, size);
+	EXIT;
+out:
+	ll_dom_pages_free(pages, npages);
+	return rc;
+}
+
+/*
+ * Batched create.
+ *
+ * A file created by an open for write in a directory whose default layout
+ * keeps the data on the MDT has its DoM layout from that open. While
+ * create_batch_kb is set, its first bytes up to that limit are kept in
+ * lli_batch_pages and sent at close by one MDS_DOM_WRITE. A write past the
+ * limit sends them and goes on through the regular DoM path. Until the
+ * flush the data and the size of the file are known to this client only.
+ */
+
+/**
+ * Keep a write to a batched file in the buffer.
+ *
+ * \retval -EAGAIN the batch has been flushed, the caller has to do the
+ *		   write through the regular path
+ */
+static ssize_t ll_batch_write(struct vvp_io_args *args, struct file *file,
+			      loff_t *ppos, size_t count)
+{
+	struct inode		*inode = file->f_dentry->d_inode;
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	loff_t			 pos = *ppos;
+	int			 i;
+	ssize_t			 rc;
+	ENTRY;
+
+	/* sendfile and splice go through the page cache */
+	if (args->via_io_subtype != IO_NORMAL) {
+		rc = ll_batch_flush(inode, file, LL_BATCH_IO);
+		RETURN(rc < 0 ? rc : -EAGAIN);
+	}
+	if (count == 0)
+		RETURN(0);
+
+	if (mutex_lock_interruptible(&lli->lli_batch_mutex))
+		RETURN(-ERESTARTSYS);
+	/* flushed meanwhile */
+	if (lli->lli_batch_limit == 0)
+		GOTO(out, rc = -EAGAIN);
+
+	if (file->f_flags & O_APPEND)
+		pos = lli->lli_batch_len;
+	/* the buffer has no holes */
+	if (pos > lli->lli_batch_len || pos + count > lli->lli_batch_limit) {
+		mutex_unlock(&lli->lli_batch_mutex);
+		rc = ll_batch_flush(inode, file, LL_BATCH_IO);
+		RETURN(rc < 0 ? rc : -EAGAIN);
+	}
+
+	if (lli->lli_batch_pages == NULL) {
+		OBD_ALLOC(lli->lli_batch_pages,
+			  (lli->lli_batch_limit >> CFS_PAGE_SHIFT) *
+			  sizeof(*lli->lli_batch_pages));
+		if (lli->lli_batch_pages == NULL)
+			GOTO(out, rc = -ENOMEM);
+	}
+	for (i = pos >> CFS_PAGE_SHIFT;
+	     i <= (pos + count - 1) >> CFS_PAGE_SHIFT; i++) {
+		if (lli->lli_batch_pages[i] != NULL)
+			continue;
+		lli->lli_batch_pages[i] = cfs_alloc_page(CFS_ALLOC_STD);
+		if (lli->lli_batch_pages[i] == NULL)
+			GOTO(out, rc = -ENOMEM);
+	}
+
+	rc = ll_dom_copy(lli->lli_batch_pages, pos, args->u.normal.via_iov,
+			 args->u.normal.via_nrsegs, count, OBD_BRW_WRITE);
+	if (rc != 0)
+		GOTO(out, rc);
+
+	if (pos + count > lli->lli_batch_len) {
+		lli->lli_batch_len = pos + count;
+		cl_isize_write(inode, lli->lli_batch_len);
+	}
+	*ppos = pos + count;
+	rc = count;
+	EXIT;
+out:
+	mutex_unlock(&lli->lli_batch_mutex);
+	return rc;
+}
+
 static ssize_t
 ll_file_io_generic(const struct lu_env *env, struct vvp_io_args *args,
 		   struct file *file, enum cl_io_type iot,
 		   loff_t *ppos, size_t count)
 {
-	struct ll_inode_info *lli = ll_i2info(file->f_dentry->d_inode);
+	struct inode         *inode = file->f_dentry->d_inode;
+	struct ll_inode_info *lli = ll_i2info(inode);
 	struct ll_file_data  *fd  = LUSTRE_FPRIVATE(file);
         struct cl_io         *io;
         ssize_t               result;
         ENTRY;
 
+	if (ll_batch_pending(inode)) {
+		if (iot == CIT_WRITE) {
+			result = ll_batch_write(args, file, ppos, count);
+			if (result != -EAGAIN)
+				GOTO(out_stats, result);
+		} else {
+			/* the data is read back from the MDT */
+			result = ll_batch_flush(inode, file, LL_BATCH_IO);
+			if (result < 0)
+				GOTO(out_stats, result);
+		}
+	}
+
+	if (lli->lli_dom_size != 0) {
+		result = ll_dom_io(args, file, iot, ppos, count);
+		if (result != -EAGAIN)
+			GOTO(out_stats, result);
+	}
+
 restart:
         io = ccc_env_thread_io(env);
         ll_io_init(io, file, iot == CIT_WRITE);
@@ -930,6 +1284,7 @@ out:
 		goto restart;
 	}
 
+out_stats:
         if (iot == CIT_READ) {
                 if (result >= 0)
                         ll_stats_ops_tally(ll_i2sbi(file->f_dentry->d_inode),
@@ -948,6 +1303,343 @@ out:
 }
 
 
+/* Write the first @nob bytes of @pages at offset 0 of @file */
+static int ll_file_write_pages(struct file *file, struct page **pages,
+			       int nob)
+{
+	struct lu_env		*env;
+	struct cl_env_nest	 nest;
+	struct vvp_io_args	*args;
+	struct iovec		*iov;
+	mm_segment_t		 seg;
+	loff_t			 pos = 0;
+	int			 i;
+	int			 rc = 0;
+
+	env = cl_env_nested_get(&nest);
+	if (IS_ERR(env))
+		return PTR_ERR(env);
+
+	iov = &vvp_env_info(env)->vti_local_iov;
+	seg = get_fs();
+	set_fs(KERNEL_DS);
+	while (pos < nob) {
+		size_t	off = pos & (CFS_PAGE_SIZE - 1);
+		ssize_t	result;
+
+		i = pos >> CFS_PAGE_SHIFT;
+		iov->iov_base = (char *)kmap(pages[i]) + off;
+		iov->iov_len = min_t(size_t, nob - pos, CFS_PAGE_SIZE - off);
+		args = vvp_env_args(env, IO_NORMAL);
+		args->u.normal.via_iov = iov;
+		args->u.normal.via_nrsegs = 1;
+#ifndef HAVE_FILE_WRITEV
+		args->u.normal.via_iocb = &vvp_env_info(env)->vti_kiocb;
+		init_sync_kiocb(args->u.normal.via_iocb, file);
+		args->u.normal.via_iocb->ki_pos = pos;
+		args->u.normal.via_iocb->ki_left = iov->iov_len;
+#endif
+		result = ll_file_io_generic(env, args, file, CIT_WRITE, &pos,
+					    iov->iov_len);
+		kunmap(pages[i]);
+		if (result < 0) {
+			rc = result;
+			break;
+		}
+		if (result == 0) {
+			rc = -EIO;
+			break;
+		}
+	}
+	set_fs(seg);
+	cl_env_nested_put(&nest, env);
+	return rc;
+}
+
+/**
+ * Send the MDS_DOM_FL_MIGRATE request of a migration of @inode: freeze its
+ * body and get the cookie of the migration in @cookie if @fid is NULL,
+ * otherwise give @inode the layout of the volatile file @fid if @cookie is
+ * still valid.
+ */
+static int ll_dom_migrate_rpc(struct inode *inode, const struct lu_fid *fid,
+			      __u64 *cookie)
+{
+	struct ptlrpc_request	*req = NULL;
+	struct md_op_data	*op_data;
+	struct mdt_body		*body;
+	int			 rc;
+	ENTRY;
+
+	op_data = ll_prep_md_op_data(NULL, inode, NULL, NULL, 0, 0,
+				     LUSTRE_OPC_ANY, NULL);
+	if (IS_ERR(op_data))
+		RETURN(PTR_ERR(op_data));
+
+	op_data->op_dom_flags = MDS_DOM_FL_MIGRATE;
+	if (fid != NULL) {
+		op_data->op_fid2 = *fid;
+		op_data->op_ioepoch = *cookie;
+	}
+
+	rc = md_dom_rw(ll_i2mdexp(inode), op_data, OBD_BRW_WRITE, NULL, &req);
+	ll_finish_md_op_data(op_data);
+	if (rc != 0)
+		RETURN(rc);
+
+	if (fid == NULL) {
+		body = req_capsule_server_get(&req->rq_pill, &RMF_MDT_BODY);
+		*cookie = body->ioepoch;
+	}
+	ptlrpc_req_finished(req);
+	RETURN(0);
+}
+
+/**
+ * Create a volatile file on the MDT of the file open in @file, in the same
+ * directory, and open it for write. The volatile file gets the default
+ * layout of the filesystem when it is opened.
+ */
+static struct file *ll_dom_volatile_open(struct file *file)
+{
+	struct inode		*inode = file->f_dentry->d_inode;
+	struct ptlrpc_request	*req = NULL;
+	struct md_op_data	*op_data;
+	struct dentry		*parent;
+	struct dentry		*dentry;
+	struct inode		*vinode = NULL;
+	struct file		*vfile;
+	struct path		 path;
+	char			 name[sizeof(LUSTRE_VOLATILE_IDX) + 4];
+	int			 mdtidx;
+	int			 rc;
+	ENTRY;
+
+	/* the layouts are swapped on the MDT of the file */
+	mdtidx = ll_get_mdt_idx(inode);
+	if (mdtidx < 0)
+		RETURN(ERR_PTR(mdtidx));
+	snprintf(name, sizeof(name), LUSTRE_VOLATILE_IDX, mdtidx);
+
+	parent = dget_parent(file->f_dentry);
+	op_data = ll_prep_md_op_data(NULL, parent->d_inode, NULL, name,
+				     strlen(name), 0, LUSTRE_OPC_CREATE, NULL);
+	dput(parent);
+	if (IS_ERR(op_data))
+		RETURN(ERR_PTR(PTR_ERR(op_data)));
+
+	rc = md_create(ll_i2mdexp(inode), op_data, NULL, 0,
+		       S_IFREG | S_IRUSR | S_IWUSR, cfs_curproc_fsuid(),
+		       cfs_curproc_fsgid(), cfs_curproc_cap_pack(), 0, &req);
+	ll_finish_md_op_data(op_data);
+	if (rc < 0)
+		RETURN(ERR_PTR(rc));
+
+	rc = ll_prep_inode(&vinode, req, inode->i_sb, NULL);
+	ptlrpc_req_finished(req);
+	if (rc < 0)
+		RETURN(ERR_PTR(rc));
+	ll_i2info(vinode)->lli_volatile = true;
+
+	dentry = d_obtain_alias(vinode);
+	if (IS_ERR(dentry))
+		RETURN(ERR_PTR(PTR_ERR(dentry)));
+	ll_dops_init(dentry, 1, 0);
+
+	path.mnt = file->f_vfsmnt;
+	path.dentry = dentry;
+	vfile = ll_dentry_open(&path, O_WRONLY | O_LARGEFILE, current_cred());
+	dput(dentry);
+	RETURN(vfile);
+}
+
+/**
+ * Move a DoM file to OST stripes.
+ *
+ * The MDT freezes the body of the file for the migration: a DoM write gets
+ * -EFBIG then and joins the migration, a truncate cancels it. The body is
+ * copied into a volatile file with OST objects, whose layout the MDT swaps
+ * with the DoM one and frees the old body if the body has not changed since
+ * it was frozen. Until then the file keeps its DoM layout and other clients
+ * keep reading the body on the MDT, no group lock is needed. The volatile
+ * file is destroyed when it is closed. Must be called without
+ * lli_write_mutex held.
+ */
+int ll_dom_migrate(struct inode *inode, struct file *file)
+{
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	struct page		**pages;
+	struct file		*vfile;
+	__u64			 cookie;
+	__u32			 gen;
+	int			 npages;
+	int			 nob;
+	int			 rc;
+	ENTRY;
+
+	mutex_lock(&lli->lli_dom_mutex);
+again:
+	npages = (lli->lli_dom_size + CFS_PAGE_SIZE - 1) >> CFS_PAGE_SHIFT;
+	if (npages == 0)
+		GOTO(out_unlock, rc = 0);
+
+	CDEBUG(D_INODE, "migrating DoM file "DFID" to OSTs\n",
+	       PFID(ll_inode2fid(inode)));
+
+	rc = ll_dom_migrate_rpc(inode, NULL, &cookie);
+	if (rc < 0)
+		GOTO(out_stale, rc);
+
+	pages = ll_dom_pages_alloc(npages);
+	if (pages == NULL)
+		GOTO(out_unlock, rc = -ENOMEM);
+
+	vfile = ll_dom_volatile_open(file);
+	if (IS_ERR(vfile))
+		GOTO(out_free, rc = PTR_ERR(vfile));
+
+	nob = ll_dom_rpc(inode, OBD_BRW_READ, 0, npages << CFS_PAGE_SHIFT, 0,
+			 pages, npages, NULL);
+	if (nob < 0)
+		GOTO(out_close, rc = nob);
+
+	if (nob > 0) {
+		rc = ll_file_write_pages(vfile, pages, nob);
+		if (rc < 0)
+			GOTO(out_close, rc);
+		rc = cl_sync_file_range(vfile->f_dentry->d_inode, 0,
+					OBD_OBJECT_EOF, CL_FSYNC_ALL);
+		if (rc < 0)
+			GOTO(out_close, rc);
+	}
+
+	rc = ll_dom_migrate_rpc(inode, ll_inode2fid(vfile->f_dentry->d_inode),
+				&cookie);
+	EXIT;
+out_close:
+	fput(vfile);
+out_free:
+	ll_dom_pages_free(pages, npages);
+out_stale:
+	if (rc == -ESTALE) {
+		/* the body has changed since it was frozen, or another client
+		 * has migrated the file */
+		rc = ll_layout_refresh(inode, &gen);
+		if (rc == 0)
+			goto again;
+	} else if (rc == 0) {
+		rc = ll_layout_refresh(inode, &gen);
+	}
+out_unlock:
+	mutex_unlock(&lli->lli_dom_mutex);
+	if (rc < 0)
+		CERROR("%s: cannot migrate DoM file "DFID": rc = %d\n",
+		       ll_get_fsname(inode->i_sb, NULL, 0),
+		       PFID(ll_inode2fid(inode)), rc);
+	return rc < 0 ? rc : 0;
+}
+
+/**
+ * Send the data of a batched create to the MDT by one MDS_DOM_WRITE and end
+ * the batching. If the file has been moved to OSTs meanwhile, the data is
+ * written through the page cache instead. That is not done for
+ * LL_BATCH_LOCKED and LL_BATCH_MMAP, whose callers hold i_mutex or
+ * mmap_sem: the data is kept and -EBUSY returned. LL_BATCH_MMAP does not
+ * wait for a writer copying data into the buffer either, -EAGAIN then.
+ * \a file may be NULL for LL_BATCH_LOCKED.
+ */
+int ll_batch_flush(struct inode *inode, struct file *file,
+		   enum ll_batch_how how)
+{
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	struct page		**pages;
+	__u32			 limit;
+	__u32			 gen;
+	int			 nob;
+	int			 rc = 0;
+	ENTRY;
+
+	if (how != LL_BATCH_MMAP)
+		mutex_lock(&lli->lli_batch_mutex);
+	else if (!mutex_trylock(&lli->lli_batch_mutex))
+		RETURN(-EAGAIN);
+	limit = lli->lli_batch_limit;
+	if (limit == 0) {
+		mutex_unlock(&lli->lli_batch_mutex);
+		RETURN(0);
+	}
+	pages = lli->lli_batch_pages;
+	nob = lli->lli_batch_len;
+
+	CDEBUG(D_INODE, "flush batched create of "DFID": %d bytes, how %d\n",
+	       PFID(ll_inode2fid(inode)), nob, how);
+
+	if (nob > 0) {
+		rc = ll_dom_rpc(inode, OBD_BRW_WRITE, 0, nob, 0, pages,
+				(nob + CFS_PAGE_SIZE - 1) >> CFS_PAGE_SHIFT,
+				NULL);
+		if (rc == -ESTALE) {
+			/* moved to OSTs, e.g. by a writer on another client */
+			rc = ll_layout_refresh(inode, &gen);
+			if (rc == 0 && how != LL_BATCH_IO) {
+				mutex_unlock(&lli->lli_batch_mutex);
+				CDEBUG(D_INODE, "batched data of "DFID" kept\n",
+				       PFID(ll_inode2fid(inode)));
+				RETURN(-EBUSY);
+			}
+			if (rc == 0)
+				rc = -ESTALE;
+		} else if (rc > 0) {
+			rc = 0;
+		}
+	}
+
+	lli->lli_batch_pages = NULL;
+	lli->lli_batch_limit = 0;
+	lli->lli_batch_len = 0;
+	mutex_unlock(&lli->lli_batch_mutex);
+
+	if (rc == -ESTALE) {
+		ll_stats_ops_tally(ll_i2sbi(inode), LPROC_LL_CREATE_UNBATCHED,
+				   1);
+		rc = ll_file_write_pages(file, pages, nob);
+	} else if (rc == 0) {
+		ll_stats_ops_tally(ll_i2sbi(inode), LPROC_LL_CREATE_BATCHED,
+				   1);
+	}
+
+	if (pages != NULL)
+		ll_dom_pages_free(pages, limit >> CFS_PAGE_SHIFT);
+	if (rc < 0)
+		CERROR("%s: lost %d bytes of batched create "DFID": rc = %d\n",
+		       ll_get_fsname(inode->i_sb, NULL, 0), nob,
+		       PFID(ll_inode2fid(inode)), rc);
+	RETURN(rc < 0 ? rc : 0);
+}
+
+/**
+ * Called for an open which created a DoM file for write: its first data
+ * is kept until close, see ll_batch_write().
+ */
+void ll_batch_start(struct inode *inode, struct file *file)
+{
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	struct ll_sb_info	*sbi = ll_i2sbi(inode);
+
+	/* synchronous writes are not kept */
+	if (sbi->ll_create_batch == 0 || file->f_flags & (O_SYNC | O_DIRECT))
+		return;
+
+	mutex_lock(&lli->lli_batch_mutex);
+	if (lli->lli_batch_limit == 0 && lli->lli_dom_size != 0 &&
+	    i_size_read(inode) == 0) {
+		lli->lli_batch_limit = min_t(__u32, sbi->ll_create_batch,
+					     lli->lli_dom_size);
+		lli->lli_batch_len = 0;
+	}
+	mutex_unlock(&lli->lli_batch_mutex);
+}
+
 /*
  * XXX: exact copy from kernel code (__generic_file_aio_write_nolock)
  */
@@ -1684,6 +2376,9 @@ int ll_do_fiemap(struct inode *inode, struct ll_user_fiemap *fiemap,
 	if (lsm == NULL)
 		return -ENOENT;
 
+	if (lsm_is_dom(lsm))
+		GOTO(out, rc = -EOPNOTSUPP);
+
 	/* If the stripe_count > 1 and the application does not understand
 	 * DEVICE_ORDER flag, then it cannot interpret the extents correctly.
 	 */
@@ -2360,6 +3055,13 @@ int ll_flush(struct file *file, fl_owner_t id)
 	if (rc == 0)
 		rc = err;
 
+	/* the data of a batched create is sent by the close of a writer */
+	if (ll_batch_pending(inode) && fd->fd_omode & FMODE_WRITE) {
+		err = ll_batch_flush(inode, file, LL_BATCH_IO);
+		if (err < 0)
+			return err;
+	}
+
 	/* The application has been told write failure already.
 	 * Do not report failure again. */
 	if (fd->fd_write_failed)
@@ -2450,6 +3152,18 @@ int ll_fsync(struct file *file, struct dentry *dentry, int datasync)
                inode->i_generation, inode);
         ll_stats_ops_tally(ll_i2sbi(inode), LPROC_LL_FSYNC, 1);
 
+	/* the data of a batched create is written by the MDT synchronously */
+	if (ll_batch_pending(inode)) {
+#ifdef HAVE_FILE_FSYNC_4ARGS
+		rc = ll_batch_flush(inode, file, LL_BATCH_IO);
+#else
+		/* i_mutex is held by the caller */
+		rc = ll_batch_flush(inode, file, LL_BATCH_LOCKED);
+#endif
+		if (rc < 0)
+			RETURN(rc);
+	}
+
 #ifdef HAVE_FILE_FSYNC_4ARGS
 	rc = filemap_write_and_wait_range(inode->i_mapping, start, end);
 	mutex_lock(&inode->i_mutex);
@@ -193,6 +193,8 @@ struct ll_inode_info {
 			/* "opendir_pid" is the token when lookup/revalid
 			 * -- I am the owner of dir statahead. */
 			pid_t                           d_opendir_pid;
+			/* shards of a directory striped over MDTs */
+			struct lmv_stripe_md	       *d_lsm_md;
 		} d;
 
 #define lli_readdir_mutex       u.d.d_readdir_mutex
@@ -201,6 +203,7 @@ struct ll_inode_info {
 #define lli_def_acl             u.d.d_def_acl
 #define lli_sa_lock             u.d.d_sa_lock
 #define lli_opendir_pid         u.d.d_opendir_pid
+#define lli_lsm_md		u.d.d_lsm_md
 
 		/* for non-directory */
 		struct {
@@ -240,6 +243,17 @@ struct ll_inode_info {
 			 * accurate if the file is shared by different jobs.
 			 */
 			char                     f_jobid[JOBSTATS_JOBID_SIZE];
+			/* batched create: data written since the file was
+			 * created, up to f_batch_limit bytes, protected by
+			 * f_batch_mutex; f_batch_limit is 0 if the file is not
+			 * batched */
+			struct page		       **f_batch_pages;
+			__u32				f_batch_limit;
+			__u32				f_batch_len;
+			struct mutex			f_batch_mutex;
+			/* serializes the migrations of a DoM file to OSTs,
+			 * taken under i_mutex by setattr */
+			struct mutex			f_dom_mutex;
                 } f;
 
 #define lli_size_sem            u.f.f_size_sem
@@ -255,6 +269,11 @@ struct ll_inode_info {
 #define lli_async_rc		u.f.f_async_rc
 #define lli_jobid		u.f.f_jobid
 #define lli_volatile		u.f.f_volatile
+#define lli_batch_pages		u.f.f_batch_pages
+#define lli_batch_limit		u.f.f_batch_limit
+#define lli_batch_len		u.f.f_batch_len
+#define lli_batch_mutex		u.f.f_batch_mutex
+#define lli_dom_mutex		u.f.f_dom_mutex
 
 	} u;
 
@@ -269,6 +288,8 @@ struct ll_inode_info {
          *      some of the following members can be moved into u.f.
          */
 	bool                            lli_has_smd;
+	/* Data-on-MDT size limit, 0 if the file data is not on the MDT */
+	__u32				lli_dom_size;
 	struct cl_object	       *lli_clob;
 
 	/* mutex to request for layout lock exclusively. */
@@ -485,6 +506,12 @@ struct ll_sb_info {
          * >0 - max. chunk to be read/written w/o lock re-acquiring */
         unsigned long             ll_max_rw_chunk;
         unsigned int              ll_md_brw_size; /* used by readdir */
+        /* max. pages of a direct IO request in flight before the
+         * submitter waits for them, 0 - wait for every chunk */
+        unsigned long             ll_dio_inflight_max;
+	/* max. size of a new file whose data is kept by the client until
+	 * close and sent with its layout, 0 - off, see ll_batch_write() */
+	unsigned int		  ll_create_batch;
 
         struct lu_site           *ll_site;
         struct cl_device         *ll_cl;
@@ -501,6 +528,8 @@ struct ll_sb_info {
 
         /* metadata stat-ahead */
         unsigned int              ll_sa_max;     /* max statahead RPCs */
+	unsigned int		  ll_sa_batch_max; /* max names per batched
+						    * statahead RPC */
         atomic_t                  ll_sa_total;   /* statahead thread started
                                                   * count */
         atomic_t                  ll_sa_wrong;   /* statahead thread stopped for
@@ -514,6 +543,7 @@ struct ll_sb_info {
 };
 
 #define LL_DEFAULT_MAX_RW_CHUNK      (32 * 1024 * 1024)
+#define LL_DIO_INFLIGHT_DEF          (64 << (20 - CFS_PAGE_SHIFT))
 
 struct ll_ra_read {
         pgoff_t             lrr_start;
@@ -801,6 +831,24 @@ int ll_do_fiemap(struct inode *inode, struct ll_user_fiemap *fiemap,
 int ll_merge_lvb(const struct lu_env *env, struct inode *inode);
 int ll_get_grouplock(struct inode *inode, struct file *file, unsigned long arg);
 int ll_put_grouplock(struct inode *inode, struct file *file, unsigned long arg);
+int ll_dom_migrate(struct inode *inode, struct file *file);
+int ll_dom_punch(struct inode *inode, loff_t size);
+/* context of ll_batch_flush() */
+enum ll_batch_how {
+	LL_BATCH_IO,		/* may write through the page cache */
+	LL_BATCH_LOCKED,	/* i_mutex held */
+	LL_BATCH_MMAP,		/* mmap_sem held */
+};
+int ll_batch_flush(struct inode *inode, struct file *file,
+		   enum ll_batch_how how);
+void ll_batch_start(struct inode *inode, struct file *file);
+
+/* data of a batched create is only on this client */
+static inline bool ll_batch_pending(struct inode *inode)
+{
+	return S_ISREG(inode->i_mode) &&
+	       ll_i2info(inode)->lli_batch_limit != 0;
+}
 int ll_fid2path(struct inode *inode, void *arg);
 int ll_data_version(struct inode *inode, __u64 *data_version, int extent_lock);
 
@@ -859,6 +907,8 @@ int ll_show_options(struct seq_file *seq, struct vfsmount *vfs);
 void ll_dirty_page_discard_warn(cfs_page_t *page, int ioret);
 int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
 		  struct super_block *, struct lookup_intent *);
+int ll_prep_inode_batch(struct inode **inode, struct mdt_body *body, void *ea,
+			struct super_block *, struct lookup_intent *);
 void lustre_dump_dentry(struct dentry *, int recur);
 void lustre_dump_inode(struct inode *);
 int ll_obd_statfs(struct inode *inode, void *arg);
@@ -1239,6 +1289,7 @@ void et_fini(struct eacl_table *et);
 #define LL_SA_RPC_MIN           2
 #define LL_SA_RPC_DEF           32
 #define LL_SA_RPC_MAX           8192
+#define LL_SA_BATCH_DEF         16
 
 #define LL_SA_CACHE_BIT         5
 #define LL_SA_CACHE_SIZE        (1 << LL_SA_CACHE_BIT)
@@ -1284,6 +1335,10 @@ struct ll_statahead_info {
         cfs_list_t              sai_cache[LL_SA_CACHE_SIZE];
 	spinlock_t		sai_cache_lock[LL_SA_CACHE_SIZE];
 	cfs_atomic_t		sai_cache_count; /* entry count in cache */
+	/* entries collected for the next MDS_BATCH_GETATTR */
+	int			sai_batch_count;
+	int			sai_batch_namelen;
+	struct ll_sa_entry     *sai_batch_ent[MDS_BATCH_GETATTR_MAX];
 };
 
 int do_statahead_enter(struct inode *dir, struct dentry **dentry,
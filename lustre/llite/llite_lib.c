@@ -111,6 +111,7 @@ static struct ll_sb_info *ll_init_sbi(void)
         sbi->ll_ra_info.ra_max_pages = sbi->ll_ra_info.ra_max_pages_per_file;
         sbi->ll_ra_info.ra_max_read_ahead_whole_pages =
                                            SBI_DEFAULT_READAHEAD_WHOLE_MAX;
+        sbi->ll_dio_inflight_max = LL_DIO_INFLIGHT_DEF;
         CFS_INIT_LIST_HEAD(&sbi->ll_conn_chain);
         CFS_INIT_LIST_HEAD(&sbi->ll_orphan_dentry_list);
 
@@ -140,6 +141,7 @@ static struct ll_sb_info *ll_init_sbi(void)
 
         /* metadata statahead is enabled by default */
         sbi->ll_sa_max = LL_SA_RPC_DEF;
+	sbi->ll_sa_batch_max = LL_SA_BATCH_DEF;
         cfs_atomic_set(&sbi->ll_sa_total, 0);
         cfs_atomic_set(&sbi->ll_sa_wrong, 0);
         cfs_atomic_set(&sbi->ll_agl_total, 0);
@@ -218,7 +220,9 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
                                   OBD_CONNECT_FULL20   | OBD_CONNECT_64BITHASH|
 				  OBD_CONNECT_EINPROGRESS |
 				  OBD_CONNECT_JOBSTATS | OBD_CONNECT_LVB_TYPE |
-				  OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_PINGLESS;
+				  OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_PINGLESS |
+				  OBD_CONNECT_DOM | OBD_CONNECT_BATCH_GETATTR |
+				  OBD_CONNECT_LAZY_SIZE | OBD_CONNECT_STRIPED_DIR;
 
         if (sbi->ll_flags & LL_SBI_SOM_PREVIEW)
                 data->ocd_connect_flags |= OBD_CONNECT_SOM;
@@ -410,7 +414,8 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
                                   OBD_CONNECT_MAXBYTES |
 				  OBD_CONNECT_EINPROGRESS |
 				  OBD_CONNECT_JOBSTATS | OBD_CONNECT_LVB_TYPE |
-				  OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_PINGLESS;
+				  OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_PINGLESS |
+				  OBD_CONNECT_MULTIBRW;
 
         if (sbi->ll_flags & LL_SBI_SOM_PREVIEW)
                 data->ocd_connect_flags |= OBD_CONNECT_SOM;
@@ -940,6 +945,7 @@ void ll_lli_init(struct ll_inode_info *lli)
 	mutex_init(&lli->lli_och_mutex);
 	spin_lock_init(&lli->lli_agl_lock);
 	lli->lli_has_smd = false;
+	lli->lli_dom_size = 0;
 	lli->lli_layout_gen = LL_LAYOUT_GEN_NONE;
 	lli->lli_clob = NULL;
 
@@ -951,6 +957,7 @@ void ll_lli_init(struct ll_inode_info *lli)
 		lli->lli_def_acl = NULL;
 		spin_lock_init(&lli->lli_sa_lock);
 		lli->lli_opendir_pid = 0;
+		lli->lli_lsm_md = NULL;
 	} else {
 		sema_init(&lli->lli_size_sem, 1);
 		lli->lli_size_sem_owner = NULL;
@@ -963,6 +970,11 @@ void ll_lli_init(struct ll_inode_info *lli)
 		lli->lli_agl_index = 0;
 		lli->lli_async_rc = 0;
 		lli->lli_volatile = false;
+		lli->lli_batch_pages = NULL;
+		lli->lli_batch_limit = 0;
+		lli->lli_batch_len = 0;
+		mutex_init(&lli->lli_batch_mutex);
+		mutex_init(&lli->lli_dom_mutex);
 	}
 	mutex_init(&lli->lli_layout_mutex);
 }
@@ -1207,6 +1219,9 @@ void ll_clear_inode(struct inode *inode)
                 LASSERT(lli->lli_opendir_key == NULL);
                 LASSERT(lli->lli_sai == NULL);
                 LASSERT(lli->lli_opendir_pid == 0);
+		if (lli->lli_lsm_md != NULL)
+			obd_free_memmd(sbi->ll_md_exp,
+				       (void *)&lli->lli_lsm_md);
         }
 
         ll_i2info(inode)->lli_flags &= ~LLIF_MDS_SIZE_LOCK;
@@ -1256,6 +1271,7 @@ void ll_clear_inode(struct inode *inode)
          */
         cl_inode_fini(inode);
 	lli->lli_has_smd = false;
+	lli->lli_dom_size = 0;
 
 	EXIT;
 }
@@ -1443,6 +1459,15 @@ int ll_setattr_raw(struct dentry *dentry, struct iattr *attr)
 		PFID(&lli->lli_fid), i_size_read(inode), attr->ia_size,
 		attr->ia_valid);
 
+	/* the data of a batched create goes to the MDT first, so that its
+	 * write does not override the new attributes */
+	if (ll_batch_pending(inode)) {
+		rc = ll_batch_flush(inode, attr->ia_valid & ATTR_FILE ?
+					   attr->ia_file : NULL, LL_BATCH_LOCKED);
+		if (rc)
+			RETURN(rc);
+	}
+
 	if (attr->ia_valid & ATTR_SIZE) {
                 /* Check new size against VFS/VM file size limit and rlimit */
                 rc = inode_newsize_ok(inode, attr->ia_size);
@@ -1459,6 +1484,18 @@ int ll_setattr_raw(struct dentry *dentry, struct iattr *attr)
                         RETURN(-EFBIG);
                 }
 
+		/* DoM file is moved to OSTs before it grows past its limit,
+		 * which needs an open file to create the volatile file next
+		 * to it */
+		if (S_ISREG(inode->i_mode) && lli->lli_dom_size != 0 &&
+		    attr->ia_size > lli->lli_dom_size) {
+			if (!(attr->ia_valid & ATTR_FILE))
+				RETURN(-EFBIG);
+			rc = ll_dom_migrate(inode, attr->ia_file);
+			if (rc)
+				RETURN(rc);
+		}
+
                 attr->ia_valid |= ATTR_MTIME | ATTR_CTIME;
         }
 
@@ -1534,6 +1571,14 @@ int ll_setattr_raw(struct dentry *dentry, struct iattr *attr)
 	if (!S_ISREG(inode->i_mode))
                 GOTO(out, rc = 0);
 
+	if (lli->lli_dom_size != 0) {
+		/* DoM body is truncated on the MDT, there are no OST objects */
+		if (attr->ia_valid & ATTR_SIZE)
+			rc = ll_dom_punch(inode, attr->ia_size);
+		if (rc != -ESTALE)
+			GOTO(out, rc);
+	}
+
 	if (attr->ia_valid & (ATTR_SIZE |
 			      ATTR_ATIME | ATTR_ATIME_SET |
 			      ATTR_MTIME | ATTR_MTIME_SET))
@@ -1714,10 +1759,19 @@ void ll_update_inode(struct inode *inode, struct lustre_md *md)
 	struct ll_sb_info *sbi = ll_i2sbi(inode);
 
 	LASSERT ((lsm != NULL) == ((body->valid & OBD_MD_FLEASIZE) != 0));
+	/* the shards of a striped directory never change, keep the first
+	 * copy, md_free_lustre_md() frees the others */
+	if (md->mea != NULL && S_ISDIR(inode->i_mode) &&
+	    lli->lli_lsm_md == NULL) {
+		lli->lli_lsm_md = md->mea;
+		md->mea = NULL;
+	}
 	if (lsm != NULL) {
-		if (!lli->lli_has_smd &&
+		if (!lli->lli_has_smd && !lsm_is_dom(lsm) &&
 		    !(sbi->ll_flags & LL_SBI_LAYOUT_LOCK))
 			cl_file_inode_init(inode, md);
+		if (lsm_is_dom(lsm))
+			lli->lli_dom_size = lsm->lsm_stripe_size;
 
 		lli->lli_maxbytes = lsm->lsm_maxbytes;
 		if (lli->lli_maxbytes > MAX_LFS_FILESIZE)
@@ -1794,7 +1848,8 @@ void ll_update_inode(struct inode *inode, struct lustre_md *md)
 
         LASSERT(fid_seq(&lli->lli_fid) != 0);
 
-        if (body->valid & OBD_MD_FLSIZE) {
+	/* the size of a batched create is only known to this client */
+	if (body->valid & OBD_MD_FLSIZE && !ll_batch_pending(inode)) {
                 if (exp_connect_som(ll_i2mdexp(inode)) &&
 		    S_ISREG(inode->i_mode)) {
                         struct lustre_handle lockh;
@@ -1833,6 +1888,22 @@ void ll_update_inode(struct inode *inode, struct lustre_md *md)
 
                 if (body->valid & OBD_MD_FLBLOCKS)
                         inode->i_blocks = body->blocks;
+	} else if (body->valid & OBD_MD_FLLAZYSIZE && S_ISREG(inode->i_mode) &&
+		   !ll_batch_pending(inode)) {
+		struct lustre_handle lockh;
+		ldlm_mode_t mode;
+
+		/* The lazy size is valid until the UPDATE lock is cancelled,
+		 * the MDT revokes it when the file is opened for write. */
+		mode = ll_take_md_lock(inode, MDS_INODELOCK_UPDATE, &lockh,
+				       LDLM_FL_CBPENDING);
+		if (mode) {
+			i_size_write(inode, body->size);
+			if (body->valid & OBD_MD_FLLAZYBLOCKS)
+				inode->i_blocks = body->blocks;
+			lli->lli_flags |= LLIF_MDS_SIZE_LOCK;
+			ldlm_lock_decref(&lockh, mode);
+		}
         }
 
         if (body->valid & OBD_MD_FLMDSCAPA) {
@@ -1989,6 +2060,10 @@ int ll_iocontrol(struct inode *inode, struct file *file,
 		lsm = ccc_inode_lsm_get(inode);
 		if (lsm == NULL)
 			RETURN(0);
+		if (lsm_is_dom(lsm)) {
+			ccc_inode_lsm_put(inode, lsm);
+			RETURN(0);
+		}
 
 		OBDO_ALLOC(oinfo.oi_oa);
 		if (!oinfo.oi_oa) {
@@ -2139,23 +2214,15 @@ int ll_remount_fs(struct super_block *sb, int *flags, char *data)
         return 0;
 }
 
-int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
-		  struct super_block *sb, struct lookup_intent *it)
+static int ll_prep_inode_md(struct inode **inode, struct lustre_md *md,
+			    struct super_block *sb, struct lookup_intent *it)
 {
-	struct ll_sb_info *sbi = NULL;
-	struct lustre_md md;
-        int rc;
-        ENTRY;
-
-        LASSERT(*inode || sb);
-        sbi = sb ? ll_s2sbi(sb) : ll_i2sbi(*inode);
-        rc = md_get_lustre_md(sbi->ll_md_exp, req, sbi->ll_dt_exp,
-                              sbi->ll_md_exp, &md);
-        if (rc)
-                RETURN(rc);
+	struct ll_sb_info *sbi = sb ? ll_s2sbi(sb) : ll_i2sbi(*inode);
+	int rc = 0;
+	ENTRY;
 
         if (*inode) {
-                ll_update_inode(*inode, &md);
+                ll_update_inode(*inode, md);
         } else {
                 LASSERT(sb != NULL);
 
@@ -2163,16 +2230,16 @@ int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
                  * At this point server returns to client's same fid as client
                  * generated for creating. So using ->fid1 is okay here.
                  */
-                LASSERT(fid_is_sane(&md.body->fid1));
+                LASSERT(fid_is_sane(&md->body->fid1));
 
-		*inode = ll_iget(sb, cl_fid_build_ino(&md.body->fid1,
+		*inode = ll_iget(sb, cl_fid_build_ino(&md->body->fid1,
 						      ll_need_32bit_api(sbi)),
-				 &md);
+				 md);
                 if (*inode == NULL || IS_ERR(*inode)) {
 #ifdef CONFIG_FS_POSIX_ACL
-                        if (md.posix_acl) {
-                                posix_acl_release(md.posix_acl);
-                                md.posix_acl = NULL;
+                        if (md->posix_acl) {
+                                posix_acl_release(md->posix_acl);
+                                md->posix_acl = NULL;
                         }
 #endif
                         rc = IS_ERR(*inode) ? PTR_ERR(*inode) : -ENOMEM;
@@ -2204,19 +2271,70 @@ int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
 			conf.coc_opc = OBJECT_CONF_SET;
 			conf.coc_inode = *inode;
 			conf.coc_lock = lock;
-			conf.u.coc_md = &md;
+			conf.u.coc_md = md;
 			(void)ll_layout_conf(*inode, &conf);
 		}
 		LDLM_LOCK_PUT(lock);
 	}
 
 out:
-	if (md.lsm != NULL)
-		obd_free_memmd(sbi->ll_dt_exp, &md.lsm);
-	md_free_lustre_md(sbi->ll_md_exp, &md);
+	if (md->lsm != NULL)
+		obd_free_memmd(sbi->ll_dt_exp, &md->lsm);
+	md_free_lustre_md(sbi->ll_md_exp, md);
 	RETURN(rc);
 }
 
+int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
+		  struct super_block *sb, struct lookup_intent *it)
+{
+	struct ll_sb_info *sbi = NULL;
+	struct lustre_md md;
+        int rc;
+        ENTRY;
+
+        LASSERT(*inode || sb);
+        sbi = sb ? ll_s2sbi(sb) : ll_i2sbi(*inode);
+        rc = md_get_lustre_md(sbi->ll_md_exp, req, sbi->ll_dt_exp,
+                              sbi->ll_md_exp, &md);
+        if (rc)
+                RETURN(rc);
+
+	RETURN(ll_prep_inode_md(inode, &md, sb, it));
+}
+
+/*
+ * Same as ll_prep_inode() for one entry of a batched stat-ahead reply: the
+ * attributes and LOV EA are not in their own reply buffers. Only the LOV EA
+ * of regular files is returned by MDS_BATCH_GETATTR.
+ */
+int ll_prep_inode_batch(struct inode **inode, struct mdt_body *body, void *ea,
+			struct super_block *sb, struct lookup_intent *it)
+{
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	struct lustre_md md;
+	int rc;
+	ENTRY;
+
+	memset(&md, 0, sizeof(md));
+	md.body = body;
+	if (body->valid & OBD_MD_FLEASIZE) {
+		if (!S_ISREG(body->mode) || body->eadatasize == 0 ||
+		    ea == NULL)
+			RETURN(-EPROTO);
+
+		rc = obd_unpackmd(sbi->ll_dt_exp, &md.lsm, ea,
+				  body->eadatasize);
+		if (rc < 0)
+			RETURN(rc);
+		if (rc < sizeof(*md.lsm)) {
+			obd_free_memmd(sbi->ll_dt_exp, &md.lsm);
+			RETURN(-EPROTO);
+		}
+	}
+
+	RETURN(ll_prep_inode_md(inode, &md, sb, it));
+}
+
 int ll_obd_statfs(struct inode *inode, void *arg)
 {
         struct ll_sb_info *sbi = NULL;
@@ -2336,6 +2454,10 @@ struct md_op_data * ll_prep_md_op_data(struct md_op_data *op_data,
 	op_data->op_opc = opc;
 	op_data->op_mds = 0;
 	op_data->op_data = data;
+	op_data->op_mea1 = S_ISDIR(i1->i_mode) ? ll_i2info(i1)->lli_lsm_md :
+						 NULL;
+	op_data->op_mea2 = i2 != NULL && S_ISDIR(i2->i_mode) ?
+			   ll_i2info(i2)->lli_lsm_md : NULL;
 
         /* If the file is being opened after mknod() (normally due to NFS)
          * try to use the default stripe data from parent directory for
@@ -622,6 +622,21 @@ int ll_file_mmap(struct file *file, struct vm_area_struct * vma)
         if (ll_file_nolock(file))
                 RETURN(-EOPNOTSUPP);
 
+	/* the data of a batched create goes to the MDT first */
+	if (ll_batch_pending(inode)) {
+		rc = ll_batch_flush(inode, file, LL_BATCH_MMAP);
+		if (rc < 0)
+			RETURN(rc);
+	}
+
+	/* DoM data does not go through the page cache, the file is moved
+	 * to OSTs to be mapped */
+	if (ll_i2info(inode)->lli_dom_size != 0) {
+		rc = ll_dom_migrate(inode, file);
+		if (rc < 0)
+			RETURN(rc);
+	}
+
         ll_stats_ops_tally(ll_i2sbi(inode), LPROC_LL_MAP, 1);
         rc = generic_file_mmap(file, vma);
         if (rc == 0) {
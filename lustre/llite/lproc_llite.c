@@ -527,6 +527,40 @@ static int ll_wr_max_rw_chunk(struct file *file, const char *buffer,
         return count;
 }
 
+static int ll_rd_max_dio_inflight_mb(char *page, char **start, off_t off,
+                                     int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	int mult;
+
+	mult = 1 << (20 - CFS_PAGE_SHIFT);
+	return lprocfs_read_frac_helper(page, count,
+					ll_s2sbi(sb)->ll_dio_inflight_max,
+					mult);
+}
+
+static int ll_wr_max_dio_inflight_mb(struct file *file, const char *buffer,
+                                     unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	int mult, rc, pages_number;
+
+	mult = 1 << (20 - CFS_PAGE_SHIFT);
+	rc = lprocfs_write_frac_helper(buffer, count, &pages_number, mult);
+	if (rc)
+		return rc;
+
+	/* 0 disables pipelining: every direct IO chunk is waited for */
+	if (pages_number < 0 || pages_number > cfs_num_physpages / 2) {
+		CERROR("can't set max_dio_inflight_mb more than %luMB\n",
+		       cfs_num_physpages >> (20 - CFS_PAGE_SHIFT + 1));
+		return -ERANGE;
+	}
+
+	ll_s2sbi(sb)->ll_dio_inflight_max = pages_number;
+	return count;
+}
+
 static int ll_rd_track_id(char *page, int count, void *data,
                           enum stats_track_type type)
 {
@@ -626,6 +660,36 @@ static int ll_wr_statahead_max(struct file *file, const char *buffer,
         return count;
 }
 
+static int ll_rd_statahead_batch_max(char *page, char **start, off_t off,
+				     int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n", sbi->ll_sa_batch_max);
+}
+
+static int ll_wr_statahead_batch_max(struct file *file, const char *buffer,
+				     unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	/* 0 or 1 sends one intent getattr per name */
+	if (val >= 0 && val <= MDS_BATCH_GETATTR_MAX)
+		sbi->ll_sa_batch_max = val;
+	else
+		CERROR("Bad statahead_batch_max value %d. Valid values are "
+		       "in the range [0, %d]\n", val, MDS_BATCH_GETATTR_MAX);
+
+	return count;
+}
+
 static int ll_rd_statahead_agl(char *page, char **start, off_t off,
                                int count, int *eof, void *data)
 {
@@ -699,6 +763,39 @@ static int ll_wr_lazystatfs(struct file *file, const char *buffer,
         return count;
 }
 
+static int ll_rd_create_batch_kb(char *page, char **start, off_t off,
+				 int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n", sbi->ll_create_batch >> 10);
+}
+
+static int ll_wr_create_batch_kb(struct file *file, const char *buffer,
+				 unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	/* the data is kept on the MDT, see LOV_PATTERN_MDT */
+	if (val < 0 || val > (LOV_MAX_DOM_SIZE >> 10) ||
+	    val & ((LOV_MIN_STRIPE_SIZE >> 10) - 1))
+		return -ERANGE;
+	/* the client learns the new layout by the layout lock */
+	if (val != 0 && (!exp_connect_dom(sbi->ll_md_exp) ||
+			 !(sbi->ll_flags & LL_SBI_LAYOUT_LOCK)))
+		return -EOPNOTSUPP;
+
+	sbi->ll_create_batch = val << 10;
+	return count;
+}
+
 static int ll_rd_maxea_size(char *page, char **start, off_t off,
                             int count, int *eof, void *data)
 {
@@ -762,13 +859,18 @@ static struct lprocfs_vars lprocfs_llite_obd_vars[] = {
         { "max_cached_mb",    ll_rd_max_cached_mb, ll_wr_max_cached_mb, 0 },
         { "checksum_pages",   ll_rd_checksum, ll_wr_checksum, 0 },
         { "max_rw_chunk",     ll_rd_max_rw_chunk, ll_wr_max_rw_chunk, 0 },
+        { "max_dio_inflight_mb", ll_rd_max_dio_inflight_mb,
+                                 ll_wr_max_dio_inflight_mb, 0 },
         { "stats_track_pid",  ll_rd_track_pid, ll_wr_track_pid, 0 },
         { "stats_track_ppid", ll_rd_track_ppid, ll_wr_track_ppid, 0 },
         { "stats_track_gid",  ll_rd_track_gid, ll_wr_track_gid, 0 },
         { "statahead_max",    ll_rd_statahead_max, ll_wr_statahead_max, 0 },
+	{ "statahead_batch_max", ll_rd_statahead_batch_max,
+				 ll_wr_statahead_batch_max, 0 },
         { "statahead_agl",    ll_rd_statahead_agl, ll_wr_statahead_agl, 0 },
         { "statahead_stats",  ll_rd_statahead_stats, 0, 0 },
         { "lazystatfs",       ll_rd_lazystatfs, ll_wr_lazystatfs, 0 },
+	{ "create_batch_kb",  ll_rd_create_batch_kb, ll_wr_create_batch_kb, 0 },
         { "max_easize",       ll_rd_maxea_size, 0, 0 },
 	{ "sbi_flags",        ll_rd_sbi_flags, 0, 0 },
         { 0 }
@@ -825,6 +927,9 @@ struct llite_file_opcode {
         { LPROC_LL_LISTXATTR,      LPROCFS_TYPE_REGS, "listxattr" },
         { LPROC_LL_REMOVEXATTR,    LPROCFS_TYPE_REGS, "removexattr" },
         { LPROC_LL_INODE_PERM,     LPROCFS_TYPE_REGS, "inode_permission" },
+	/* batched create */
+	{ LPROC_LL_CREATE_BATCHED, LPROCFS_TYPE_REGS, "create_batched" },
+	{ LPROC_LL_CREATE_UNBATCHED, LPROCFS_TYPE_REGS, "create_unbatched" },
 };
 
 void ll_stats_ops_tally(struct ll_sb_info *sbi, int op, int count)
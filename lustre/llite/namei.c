@@ -1208,6 +1208,12 @@ int ll_objects_destroy(struct ptlrpc_request *request, struct inode *dir)
         }
         LASSERT(rc >= sizeof(*lsm));
 
+	/* Data-on-MDT file has no OST objects */
+	if (lsm_is_dom(lsm)) {
+		obd_free_memmd(ll_i2dtexp(dir), &lsm);
+		RETURN(0);
+	}
+
         OBDO_ALLOC(oa);
         if (oa == NULL)
                 GOTO(out_free_memmd, rc = -ENOMEM);
@@ -237,26 +237,24 @@ static void ll_free_user_pages(struct page **pages, int npages, int do_dirty)
         OBD_FREE_LARGE(pages, npages * sizeof(*pages));
 }
 
-ssize_t ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io,
-                           int rw, struct inode *inode,
-                           struct ll_dio_pages *pv)
+/* Create transient cl_pages for the user pages described by \a pv and
+ * queue the ones needing transfer on \a queue->c2_qin. */
+static int ll_dio_queue_pages(const struct lu_env *env, struct cl_io *io,
+                              int rw, struct ll_dio_pages *pv,
+                              struct cl_2queue *queue, int *io_pages)
 {
         struct cl_page    *clp;
-        struct cl_2queue  *queue;
         struct cl_object  *obj = io->ci_obj;
         int i;
-        ssize_t rc = 0;
+        int rc = 0;
         loff_t file_offset  = pv->ldp_start_offset;
         long size           = pv->ldp_size;
         int page_count      = pv->ldp_nr;
         struct page **pages = pv->ldp_pages;
         long page_size      = cl_page_size(obj);
         bool do_io;
-        int  io_pages       = 0;
-        ENTRY;
 
-        queue = &io->ci_queue;
-        cl_2queue_init(queue);
+        *io_pages = 0;
         for (i = 0; i < page_count; i++) {
                 if (pv->ldp_offsets)
                     file_offset = pv->ldp_offsets[i];
@@ -319,7 +317,7 @@ ssize_t ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io,
                          */
                         cl_page_clip(env, clp, 0, min(size, page_size));
 
-                        ++io_pages;
+                        ++*io_pages;
                 }
 
                 /* drop the reference count for cl_page_find */
@@ -327,7 +325,21 @@ ssize_t ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io,
                 size -= page_size;
                 file_offset += page_size;
         }
+        return rc;
+}
+
+ssize_t ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io,
+                           int rw, struct inode *inode,
+                           struct ll_dio_pages *pv)
+{
+        struct cl_2queue  *queue;
+        ssize_t rc;
+        int  io_pages;
+        ENTRY;
 
+        queue = &io->ci_queue;
+        cl_2queue_init(queue);
+        rc = ll_dio_queue_pages(env, io, rw, pv, queue, &io_pages);
         if (rc == 0 && io_pages) {
                 rc = cl_io_submit_sync(env, io,
                                        rw == READ ? CRT_READ : CRT_WRITE,
@@ -359,6 +371,137 @@ static ssize_t ll_direct_IO_26_seg(const struct lu_env *env, struct cl_io *io,
     return ll_direct_rw_pages(env, io, rw, inode, &pvec);
 }
 
+/*
+ * Pipelined direct IO: chunks are submitted one after another without
+ * waiting for the transfer of the previous ones. All pages share a single
+ * sync anchor, and the caller waits once for every window of
+ * ll_sb_info::ll_dio_inflight_max pages, and at the end of the request.
+ */
+struct ll_dio_chunk {
+	cfs_list_t		 dch_link;
+	struct page		**dch_pages;
+	int			 dch_max_pages;
+};
+
+struct ll_dio_pipe {
+	/* holds an extra count while chunks are being submitted, so that the
+	 * anchor can't complete between two chunks */
+	struct cl_sync_io	 dpi_anchor;
+	/* pages under transfer, owned by the io */
+	struct cl_page_list	 dpi_inflight;
+	/* user pages pinned by this window */
+	cfs_list_t		 dpi_chunks;
+	long			 dpi_pages;
+};
+
+static void ll_dio_pipe_init(struct ll_dio_pipe *pipe)
+{
+	cl_sync_io_init(&pipe->dpi_anchor, 1);
+	cl_page_list_init(&pipe->dpi_inflight);
+	CFS_INIT_LIST_HEAD(&pipe->dpi_chunks);
+	pipe->dpi_pages = 0;
+}
+
+/* Wait for all chunks of the current window, then release them. */
+static int ll_dio_pipe_drain(const struct lu_env *env, struct cl_io *io,
+			     int rw, struct ll_dio_pipe *pipe)
+{
+	struct ll_dio_chunk *chunk;
+	struct ll_dio_chunk *tmp;
+	int rc;
+
+	cl_sync_io_note(&pipe->dpi_anchor, 0);
+	rc = cl_sync_io_wait(env, io, &pipe->dpi_inflight, &pipe->dpi_anchor,
+			     0);
+	cl_page_list_discard(env, io, &pipe->dpi_inflight);
+	cl_page_list_disown(env, io, &pipe->dpi_inflight);
+	cl_page_list_fini(env, &pipe->dpi_inflight);
+
+	cfs_list_for_each_entry_safe(chunk, tmp, &pipe->dpi_chunks, dch_link) {
+		cfs_list_del(&chunk->dch_link);
+		ll_free_user_pages(chunk->dch_pages, chunk->dch_max_pages,
+				   rw == READ);
+		OBD_FREE_PTR(chunk);
+	}
+
+	ll_dio_pipe_init(pipe);
+	return rc;
+}
+
+/* Submit a chunk without waiting for it. On success the user pages are
+ * kept pinned until the window is drained, otherwise they are released
+ * before returning. */
+static ssize_t ll_dio_pipe_submit(const struct lu_env *env, struct cl_io *io,
+				  int rw, struct ll_dio_pipe *pipe,
+				  size_t size, loff_t file_offset,
+				  struct page **pages, int page_count,
+				  int max_pages)
+{
+	struct cl_sync_io   *anchor = &pipe->dpi_anchor;
+	struct cl_2queue    *queue = &io->ci_queue;
+	struct ll_dio_chunk *chunk;
+	struct cl_page      *clp;
+	struct ll_dio_pages  pvec = { .ldp_pages        = pages,
+				      .ldp_nr           = page_count,
+				      .ldp_size         = size,
+				      .ldp_offsets      = NULL,
+				      .ldp_start_offset = file_offset
+				    };
+	int		     io_pages;
+	int		     rc;
+	ENTRY;
+
+	OBD_ALLOC_PTR(chunk);
+	if (chunk == NULL) {
+		ll_free_user_pages(pages, max_pages, rw == READ);
+		RETURN(-ENOMEM);
+	}
+
+	cl_2queue_init(queue);
+	rc = ll_dio_queue_pages(env, io, rw, &pvec, queue, &io_pages);
+	if (rc == 0 && io_pages) {
+		cl_page_list_for_each(clp, &queue->c2_qin) {
+			LASSERT(clp->cp_sync_io == NULL);
+			clp->cp_sync_io = anchor;
+		}
+		cfs_atomic_add(queue->c2_qin.pl_nr, &anchor->csi_sync_nr);
+
+		rc = cl_io_submit_rw(env, io,
+				     rw == READ ? CRT_READ : CRT_WRITE, queue);
+		if (rc == 0) {
+			/* pages left behind count as completed */
+			cl_page_list_for_each(clp, &queue->c2_qin) {
+				clp->cp_sync_io = NULL;
+				cl_sync_io_note(anchor, +1);
+			}
+			cl_page_list_splice(&queue->c2_qout,
+					    &pipe->dpi_inflight);
+		} else {
+			LASSERT(cfs_list_empty(&queue->c2_qout.pl_pages));
+			cl_page_list_for_each(clp, &queue->c2_qin)
+				clp->cp_sync_io = NULL;
+			cfs_atomic_sub(queue->c2_qin.pl_nr,
+				       &anchor->csi_sync_nr);
+		}
+	}
+
+	cl_2queue_discard(env, io, queue);
+	cl_2queue_disown(env, io, queue);
+	cl_2queue_fini(env, queue);
+
+	if (rc != 0) {
+		ll_free_user_pages(pages, max_pages, rw == READ);
+		OBD_FREE_PTR(chunk);
+		RETURN(rc);
+	}
+
+	chunk->dch_pages = pages;
+	chunk->dch_max_pages = max_pages;
+	cfs_list_add_tail(&chunk->dch_link, &pipe->dpi_chunks);
+	pipe->dpi_pages += page_count;
+	RETURN(size);
+}
+
 #ifdef KMALLOC_MAX_SIZE
 #define MAX_MALLOC KMALLOC_MAX_SIZE
 #else
@@ -384,8 +527,12 @@ static ssize_t ll_direct_IO_26(int rw, struct kiocb *iocb,
         long count = iov_length(iov, nr_segs);
         long tot_bytes = 0, result = 0;
         struct ll_inode_info *lli = ll_i2info(inode);
+        struct ll_sb_info *sbi = ll_i2sbi(inode);
+        struct ll_dio_pipe *pipe = NULL;
         unsigned long seg = 0;
         long size = MAX_DIO_SIZE;
+        long done = 0;
+        long inflight_max;
         int refcheck;
         ENTRY;
 
@@ -414,6 +561,18 @@ static ssize_t ll_direct_IO_26(int rw, struct kiocb *iocb,
         io = ccc_env_io(env)->cui_cl.cis_io;
         LASSERT(io != NULL);
 
+	/* keep a few chunks in flight within the window */
+	inflight_max = sbi->ll_dio_inflight_max;
+	if (inflight_max > 0) {
+		OBD_ALLOC_PTR(pipe);
+		if (pipe != NULL) {
+			ll_dio_pipe_init(pipe);
+			size = min_t(long, size,
+				     max_t(long, inflight_max / 4, 1) <<
+				     CFS_PAGE_SHIFT);
+		}
+	}
+
 	/* 0. Need locking between buffered and direct access. and race with
 	 *    size changing by concurrent truncates and writes.
 	 * 1. Need inode mutex to operate transient pages.
@@ -444,11 +603,20 @@ static ssize_t ll_direct_IO_26(int rw, struct kiocb *iocb,
                         if (likely(page_count > 0)) {
                                 if (unlikely(page_count <  max_pages))
                                         bytes = page_count << CFS_PAGE_SHIFT;
-                                result = ll_direct_IO_26_seg(env, io, rw, inode,
-                                                             file->f_mapping,
-                                                             bytes, file_offset,
-                                                             pages, page_count);
-                                ll_free_user_pages(pages, max_pages, rw==READ);
+                                if (pipe != NULL) {
+                                        result = ll_dio_pipe_submit(env, io,
+                                                        rw, pipe, bytes,
+                                                        file_offset, pages,
+                                                        page_count, max_pages);
+                                } else {
+                                        result = ll_direct_IO_26_seg(env, io,
+                                                        rw, inode,
+                                                        file->f_mapping,
+                                                        bytes, file_offset,
+                                                        pages, page_count);
+                                        ll_free_user_pages(pages, max_pages,
+                                                           rw == READ);
+                                }
                         } else if (page_count == 0) {
                                 GOTO(out, result = -EFAULT);
                         } else {
@@ -478,9 +646,31 @@ static ssize_t ll_direct_IO_26(int rw, struct kiocb *iocb,
                         file_offset += result;
                         iov_left -= result;
                         user_addr += result;
+
+                        if (pipe != NULL && pipe->dpi_pages >= inflight_max) {
+                                result = ll_dio_pipe_drain(env, io, rw, pipe);
+                                if (result < 0) {
+                                        file_offset -= tot_bytes - done;
+                                        tot_bytes = done;
+                                        GOTO(out, result);
+                                }
+                                done = tot_bytes;
+                        }
                 }
         }
 out:
+	if (pipe != NULL) {
+		/* the only wait of a request smaller than the window; on
+		 * failure, only the bytes of completed windows are reported */
+		int rc = ll_dio_pipe_drain(env, io, rw, pipe);
+
+		if (rc < 0) {
+			file_offset -= tot_bytes - done;
+			tot_bytes = done;
+			result = rc;
+		}
+		OBD_FREE_PTR(pipe);
+	}
 	LASSERT(obj->cob_transient_pages == 0);
 	if (rw == READ)
 		mutex_unlock(&inode->i_mutex);
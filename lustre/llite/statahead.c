@@ -78,6 +78,9 @@ struct ll_sa_entry {
 	struct md_enqueue_info *se_minfo;
 	/* pointer to the async getattr request */
 	struct ptlrpc_request  *se_req;
+	/* attributes and LOV EA in se_req, for a batched getattr */
+	struct mdt_body        *se_body;
+	void                   *se_ea;
 	/* pointer to the target inode */
 	struct inode           *se_inode;
 	/* entry name */
@@ -132,10 +135,15 @@ ll_sa_entry_unhash(struct ll_statahead_info *sai, struct ll_sa_entry *entry)
 	spin_unlock(&sai->sai_cache_lock[i]);
 }
 
+/* The size of a DoM file, or of a file with a lazy size, comes with the
+ * attributes from the MDT; only files striped over OSTs are glimpsed, still
+ * one RPC per file. */
 static inline int agl_should_run(struct ll_statahead_info *sai,
                                  struct inode *inode)
 {
-	return (inode != NULL && S_ISREG(inode->i_mode) && sai->sai_agl_valid);
+	return (inode != NULL && S_ISREG(inode->i_mode) && sai->sai_agl_valid &&
+		ll_i2info(inode)->lli_dom_size == 0 &&
+		!(ll_i2info(inode)->lli_flags & LLIF_MDS_SIZE_LOCK));
 }
 
 static inline struct ll_sa_entry *
@@ -318,6 +326,8 @@ static void ll_sa_entry_cleanup(struct ll_statahead_info *sai,
 
         if (req) {
                 entry->se_req = NULL;
+		entry->se_body = NULL;
+		entry->se_ea = NULL;
                 ptlrpc_req_finished(req);
         }
 }
@@ -617,6 +627,57 @@ static void ll_agl_trigger(struct inode *inode, struct ll_statahead_info *sai)
         EXIT;
 }
 
+/*
+ * ll_post_statahead() for an entry replied by MDS_BATCH_GETATTR.
+ */
+static int ll_post_statahead_batch(struct ll_statahead_info *sai,
+				   struct ll_sa_entry *entry)
+{
+	struct inode         *dir   = sai->sai_inode;
+	struct inode         *child = entry->se_inode;
+	struct mdt_body      *body  = entry->se_body;
+	struct lookup_intent  it    = { .it_op = IT_GETATTR,
+					.d.lustre.it_lock_handle =
+					 entry->se_handle };
+	int                   rc;
+	ENTRY;
+
+	if (body == NULL)
+		RETURN(-EFAULT);
+
+	/* unlinked and re-created with the same name */
+	if (child != NULL &&
+	    unlikely(!lu_fid_eq(ll_inode2fid(child), &body->fid1))) {
+		entry->se_inode = NULL;
+		iput(child);
+		child = NULL;
+	}
+
+	/* the reply has no LMV EA, a directory seen for the first time could
+	 * be striped: leave it to the normal lookup */
+	if (child == NULL && S_ISDIR(body->mode) &&
+	    exp_connect_flags(ll_i2mdexp(dir)) & OBD_CONNECT_STRIPED_DIR)
+		RETURN(-EAGAIN);
+
+	rc = md_revalidate_lock(ll_i2mdexp(dir), &it, ll_inode2fid(dir), NULL);
+	if (rc != 1)
+		RETURN(-EAGAIN);
+
+	rc = ll_prep_inode_batch(&child, body, entry->se_ea, dir->i_sb, &it);
+	if (rc == 0) {
+		CDEBUG(D_DLMTRACE, "setting l_data to inode %p (%lu/%u)\n",
+		       child, child->i_ino, child->i_generation);
+		ll_set_lock_data(ll_i2sbi(dir)->ll_md_exp, child, &it, NULL);
+
+		entry->se_inode = child;
+		if (agl_should_run(sai, child))
+			ll_agl_add(sai, child, entry->se_index);
+	}
+	ll_intent_release(&it);
+
+	RETURN(rc);
+}
+
 static void ll_post_statahead(struct ll_statahead_info *sai)
 {
         struct inode           *dir   = sai->sai_inode;
@@ -643,6 +704,9 @@ static void ll_post_statahead(struct ll_statahead_info *sai)
         LASSERT(entry->se_handle != 0);
 
         minfo = entry->se_minfo;
+	if (minfo == NULL)
+		GOTO(out, rc = ll_post_statahead_batch(sai, entry));
+
         it = &minfo->mi_it;
         req = entry->se_req;
         body = req_capsule_server_get(&req->rq_pill, &RMF_MDT_BODY);
@@ -846,7 +910,90 @@ static int sa_args_init(struct inode *dir, struct inode *child,
         return 0;
 }
 
-static int do_sa_lookup(struct inode *dir, struct ll_sa_entry *entry)
+static int ll_statahead_batch_interpret(struct ptlrpc_request *req,
+					struct md_batch_info *mbi, int rc)
+{
+	struct inode             *dir = mbi->mbi_dir;
+	struct ll_inode_info     *lli = ll_i2info(dir);
+	struct ll_statahead_info *sai;
+	struct ll_sa_entry       *entry;
+	int                       wakeup;
+	int                       i;
+	ENTRY;
+
+	spin_lock(&lli->lli_sa_lock);
+	/* stale entries */
+	if (unlikely(lli->lli_sai == NULL ||
+		     lli->lli_sai->sai_generation != mbi->mbi_generation)) {
+		spin_unlock(&lli->lli_sa_lock);
+		GOTO(out, rc = -ESTALE);
+	}
+	sai = ll_sai_get(lli->lli_sai);
+	spin_unlock(&lli->lli_sa_lock);
+
+	for (i = 0; i < mbi->mbi_count; i++) {
+		struct md_batch_item *item = &mbi->mbi_items[i];
+
+		spin_lock(&lli->lli_sa_lock);
+		sai->sai_replied++;
+		if (unlikely(!thread_is_running(&sai->sai_thread))) {
+			spin_unlock(&lli->lli_sa_lock);
+			continue;
+		}
+
+		entry = ll_sa_entry_get_byindex(sai, item->mbi_cbdata);
+		if (entry == NULL) {
+			spin_unlock(&lli->lli_sa_lock);
+			continue;
+		}
+
+		wakeup = 0;
+		if (item->mbi_rc != 0) {
+			/* the scanner does a normal lookup for it */
+			do_sa_entry_to_stated(sai, entry, SA_ENTRY_INVA);
+			if (entry->se_index == sai->sai_index_wait)
+				cfs_waitq_signal(&sai->sai_waitq);
+		} else {
+			/* the ibits lock is not referenced, as for the
+			 * "ll_intent_drop_lock()" in ll_statahead_interpret */
+			entry->se_req = ptlrpc_request_addref(req);
+			entry->se_body = item->mbi_body;
+			entry->se_ea = item->mbi_ea;
+			entry->se_handle = item->mbi_lockh.cookie;
+			wakeup = sa_received_empty(sai);
+			cfs_list_add_tail(&entry->se_list,
+					  &sai->sai_entries_received);
+		}
+		spin_unlock(&lli->lli_sa_lock);
+
+		ll_sa_entry_put(sai, entry);
+		if (wakeup)
+			cfs_waitq_signal(&sai->sai_thread.t_ctl_waitq);
+	}
+	ll_sai_put(sai);
+
+	EXIT;
+
+out:
+	iput(dir);
+	OBD_FREE(mbi, offsetof(struct md_batch_info, mbi_items[mbi->mbi_count]));
+	return rc;
+}
+
+static inline int sa_batch_enabled(struct inode *dir)
+{
+	struct ll_sb_info *sbi = ll_i2sbi(dir);
+
+	/* capabilities and remote permissions are not batched */
+	return sbi->ll_sa_batch_max > 1 &&
+	       !(sbi->ll_flags & (LL_SBI_MDS_CAPA | LL_SBI_RMT_CLIENT)) &&
+	       exp_connect_batch_getattr(sbi->ll_md_exp);
+}
+
+/*
+ * Stat the entry with its own intent getattr RPC.
+ */
+static int sa_getattr_one(struct inode *dir, struct ll_sa_entry *entry)
 {
         struct md_enqueue_info   *minfo;
         struct ldlm_enqueue_info *einfo;
@@ -854,7 +1001,7 @@ static int do_sa_lookup(struct inode *dir, struct ll_sa_entry *entry)
         int                       rc;
         ENTRY;
 
-        rc = sa_args_init(dir, NULL, entry, &minfo, &einfo, capas);
+        rc = sa_args_init(dir, entry->se_inode, entry, &minfo, &einfo, capas);
         if (rc)
                 RETURN(rc);
 
@@ -869,6 +1016,147 @@ static int do_sa_lookup(struct inode *dir, struct ll_sa_entry *entry)
         RETURN(rc);
 }
 
+/*
+ * Send the collected entries in one MDS_BATCH_GETATTR. If that fails, every
+ * entry is sent by itself; an entry which can't be sent at all is marked
+ * invalid for the scanner to look it up.
+ */
+static void sa_batch_flush(struct ll_statahead_info *sai)
+{
+	struct inode             *dir   = sai->sai_inode;
+	struct ll_inode_info     *lli   = ll_i2info(dir);
+	int                       count = sai->sai_batch_count;
+	struct ldlm_enqueue_info  einfo = {
+					.ei_type  = LDLM_IBITS,
+					.ei_mode  = LCK_PR,
+					.ei_cb_bl = ll_md_blocking_ast,
+					.ei_cb_cp = ldlm_completion_ast,
+				  };
+	struct md_batch_info     *mbi;
+	struct md_op_data        *op_data;
+	struct obd_capa          *capa;
+	struct ll_sa_entry       *entry;
+	int                       rc;
+	int                       i;
+	ENTRY;
+
+	if (count == 0)
+		RETURN_EXIT;
+
+	sai->sai_batch_count = 0;
+	sai->sai_batch_namelen = 0;
+
+	OBD_ALLOC(mbi, offsetof(struct md_batch_info, mbi_items[count]));
+	if (mbi == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	op_data = ll_prep_md_op_data(&mbi->mbi_data, dir, NULL, NULL, 0, 0,
+				     LUSTRE_OPC_ANY, NULL);
+	if (IS_ERR(op_data)) {
+		OBD_FREE(mbi, offsetof(struct md_batch_info,
+				       mbi_items[count]));
+		GOTO(out, rc = PTR_ERR(op_data));
+	}
+
+	mbi->mbi_dir = igrab(dir);
+	mbi->mbi_cb = ll_statahead_batch_interpret;
+	mbi->mbi_generation = sai->sai_generation;
+	mbi->mbi_count = count;
+	for (i = 0; i < count; i++) {
+		entry = sai->sai_batch_ent[i];
+		mbi->mbi_items[i].mbi_name = entry->se_qstr.name;
+		mbi->mbi_items[i].mbi_namelen = entry->se_qstr.len;
+		mbi->mbi_items[i].mbi_cbdata = entry->se_index;
+	}
+
+	/* see sa_args_init() on why capa is saved */
+	capa = op_data->op_capa1;
+	rc = md_batch_getattr_async(ll_i2mdexp(dir), mbi, &einfo);
+	capa_put(capa);
+	if (rc) {
+		CDEBUG(D_READA, "batch getattr of %d names in "DFID
+		       " failed: rc = %d\n", count, PFID(&lli->lli_fid), rc);
+		iput(dir);
+		OBD_FREE(mbi, offsetof(struct md_batch_info,
+				       mbi_items[count]));
+	}
+
+	EXIT;
+
+out:
+	for (i = 0; i < count; i++) {
+		entry = sai->sai_batch_ent[i];
+		sai->sai_batch_ent[i] = NULL;
+
+		if (rc != 0 && sa_getattr_one(dir, entry) != 0) {
+			spin_lock(&lli->lli_sa_lock);
+			sai->sai_replied++;
+			spin_unlock(&lli->lli_sa_lock);
+
+			if (ll_sa_entry_to_stated(sai, entry,
+						  SA_ENTRY_INVA) == 0 &&
+			    entry->se_index == sai->sai_index_wait)
+				cfs_waitq_signal(&sai->sai_waitq);
+		}
+		ll_sa_entry_put(sai, entry);
+	}
+}
+
+/*
+ * Drop the collected entries when the statahead thread exits.
+ */
+static void sa_batch_discard(struct ll_statahead_info *sai)
+{
+	struct ll_inode_info *lli = ll_i2info(sai->sai_inode);
+	int                   i;
+
+	for (i = 0; i < sai->sai_batch_count; i++) {
+		spin_lock(&lli->lli_sa_lock);
+		sai->sai_replied++;
+		spin_unlock(&lli->lli_sa_lock);
+
+		ll_sa_entry_put(sai, sai->sai_batch_ent[i]);
+		sai->sai_batch_ent[i] = NULL;
+	}
+	sai->sai_batch_count = 0;
+	sai->sai_batch_namelen = 0;
+}
+
+/*
+ * Queue the entry for the next MDS_BATCH_GETATTR, it is sent when the batch
+ * is full or the scanner waits for one of its entries.
+ */
+static void sa_batch_add(struct ll_statahead_info *sai,
+			 struct ll_sa_entry *entry)
+{
+	int max = min_t(int, ll_i2sbi(sai->sai_inode)->ll_sa_batch_max,
+			MDS_BATCH_GETATTR_MAX);
+
+	if (sai->sai_batch_namelen + entry->se_qstr.len + 1 >
+	    MDS_BATCH_NAMES_MAX)
+		sa_batch_flush(sai);
+
+	cfs_atomic_inc(&entry->se_refcount);
+	sai->sai_batch_ent[sai->sai_batch_count++] = entry;
+	sai->sai_batch_namelen += entry->se_qstr.len + 1;
+
+	if (sai->sai_batch_count >= max ||
+	    sai->sai_index_wait >= sai->sai_batch_ent[0]->se_index)
+		sa_batch_flush(sai);
+}
+
+static int do_sa_lookup(struct inode *dir, struct ll_sa_entry *entry)
+{
+        ENTRY;
+
+	if (sa_batch_enabled(dir)) {
+		sa_batch_add(ll_i2info(dir)->lli_sai, entry);
+		RETURN(0);
+	}
+
+	RETURN(sa_getattr_one(dir, entry));
+}
+
 /**
  * similar to ll_revalidate_it().
  * \retval      1 -- dentry valid
@@ -904,6 +1192,11 @@ static int do_sa_revalidate(struct inode *dir, struct ll_sa_entry *entry,
                 RETURN(1);
         }
 
+	if (sa_batch_enabled(dir)) {
+		sa_batch_add(ll_i2info(dir)->lli_sai, entry);
+		RETURN(0);
+	}
+
         rc = sa_args_init(dir, inode, entry, &minfo, &einfo, capas);
         if (rc) {
                 entry->se_inode = NULL;
@@ -1162,6 +1455,10 @@ static int ll_statahead_thread(void *arg)
                                 continue;
 
 keep_it:
+			/* no window for more, send what is collected */
+			if (sa_sent_full(sai))
+				sa_batch_flush(sai);
+
                         l_wait_event(thread->t_ctl_waitq,
                                      !sa_sent_full(sai) ||
                                      !sa_received_empty(sai) ||
@@ -1218,6 +1515,7 @@ do_it:
                          * End of directory reached.
                          */
                         ll_release_page(page, 0);
+			sa_batch_flush(sai);
                         while (1) {
                                 l_wait_event(thread->t_ctl_waitq,
                                              !sa_received_empty(sai) ||
@@ -1255,6 +1553,7 @@ do_it:
                          */
                         ll_release_page(page, le32_to_cpu(dp->ldp_flags) &
                                               LDF_COLLIDE);
+			sa_batch_flush(sai);
                         sai->sai_in_readpage = 1;
 			page = ll_get_dir_page(dir, pos, &chain);
                         sai->sai_in_readpage = 0;
@@ -1269,6 +1568,7 @@ do_it:
         EXIT;
 
 out:
+	sa_batch_discard(sai);
         if (sai->sai_agl_valid) {
 		spin_lock(&plli->lli_agl_lock);
 		thread_set_flags(agl_thread, SVC_STOPPING);
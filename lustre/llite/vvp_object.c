@@ -141,13 +141,17 @@ int vvp_conf_set(const struct lu_env *env, struct cl_object *obj,
 			lli->lli_layout_gen,
 			conf->u.coc_md->lsm->lsm_layout_gen);
 
-		lli->lli_has_smd = true;
+		/* DoM file has a layout but no OST objects */
+		lli->lli_has_smd = !lsm_is_dom(conf->u.coc_md->lsm);
+		lli->lli_dom_size = lsm_is_dom(conf->u.coc_md->lsm) ?
+				    conf->u.coc_md->lsm->lsm_stripe_size : 0;
 		lli->lli_layout_gen = conf->u.coc_md->lsm->lsm_layout_gen;
 	} else {
 		CDEBUG(D_VFSTRACE, "layout lock destroyed: %u.\n",
 			lli->lli_layout_gen);
 
 		lli->lli_has_smd = false;
+		lli->lli_dom_size = 0;
 		lli->lli_layout_gen = LL_LAYOUT_GEN_EMPTY;
 	}
 	return 0;
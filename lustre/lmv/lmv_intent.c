@@ -175,6 +175,8 @@ int lmv_intent_open(struct obd_export *exp, struct md_op_data *op_data,
 	int			rc;
 	ENTRY;
 
+	lmv_name2shard(op_data->op_mea1, &op_data->op_fid1, op_data->op_name,
+		       op_data->op_namelen);
 	tgt = lmv_locate_mds(lmv, op_data, &op_data->op_fid1);
 	if (IS_ERR(tgt))
 		RETURN(PTR_ERR(tgt));
@@ -256,6 +258,8 @@ int lmv_intent_lookup(struct obd_export *exp, struct md_op_data *op_data,
 	int                     rc = 0;
 	ENTRY;
 
+	lmv_name2shard(op_data->op_mea1, &op_data->op_fid1, op_data->op_name,
+		       op_data->op_namelen);
 	tgt = lmv_locate_mds(lmv, op_data, &op_data->op_fid1);
 	if (IS_ERR(tgt))
 		RETURN(PTR_ERR(tgt));
@@ -144,6 +144,8 @@ lmv_find_target(struct lmv_obd *lmv, const struct lu_fid *fid)
 struct lmv_tgt_desc
 *lmv_locate_mds(struct lmv_obd *lmv, struct md_op_data *op_data,
 		struct lu_fid *fid);
+void lmv_name2shard(struct lmv_stripe_md *mea, struct lu_fid *fid,
+		    const char *name, int namelen);
 /* lproc_lmv.c */
 #ifdef LPROCFS
 void lprocfs_lmv_init_vars(struct lprocfs_static_vars *lvars);
@@ -1496,6 +1496,110 @@ struct lmv_tgt_desc
 	return tgt;
 }
 
+/*
+ * In a directory striped over several MDTs the entry \a name lives in the
+ * shard picked by the hash of the name, point \a fid of the master (shard 0)
+ * to that shard.
+ */
+void lmv_name2shard(struct lmv_stripe_md *mea, struct lu_fid *fid,
+		    const char *name, int namelen)
+{
+	if (mea == NULL || mea->mea_count <= 1 || name == NULL ||
+	    namelen <= 0 || !lu_fid_eq(fid, &mea->mea_ids[0]))
+		return;
+
+	*fid = mea->mea_ids[mea_name2idx(mea, name, namelen)];
+}
+
+/*
+ * A volatile file named after an MDT is created in the shard of a striped
+ * directory on that MDT, not in the one picked by the hash of its name.
+ */
+static void lmv_volatile2shard(struct lmv_obd *lmv, struct md_op_data *op_data)
+{
+	struct lmv_stripe_md	*mea = op_data->op_mea1;
+	struct lmv_tgt_desc	*tgt;
+	int			 idx;
+	int			 i;
+
+	if (mea == NULL || mea->mea_count <= 1 ||
+	    !lu_fid_eq(&op_data->op_fid1, &mea->mea_ids[0]) ||
+	    !filename_is_volatile(op_data->op_name, op_data->op_namelen, &idx) ||
+	    idx < 0)
+		return;
+
+	for (i = 0; i < mea->mea_count; i++) {
+		tgt = lmv_find_target(lmv, &mea->mea_ids[i]);
+		if (!IS_ERR(tgt) && tgt->ltd_idx == idx) {
+			op_data->op_fid1 = mea->mea_ids[i];
+			return;
+		}
+	}
+}
+
+/*
+ * "lfs setdirstripe -c N": allocate the FIDs of the N shards of the new
+ * directory, shard 0 (the master) lives on the MDT of the parent, shard i
+ * on the i-th next MDT. The MDT creates the shards and keeps their FIDs in
+ * the LMV EA of the master.
+ */
+static int lmv_stripe_dir_prep(struct lmv_obd *lmv, struct lmv_tgt_desc *tgt,
+			       struct md_op_data *op_data,
+			       struct lmv_user_md **lump, int *lum_size)
+{
+	struct lmv_user_md	*lum = op_data->op_data;
+	struct lmv_user_md	*new;
+	int			 count;
+	int			 size;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	count = min_t(int, lum->lum_stripe_count, lmv->desc.ld_tgt_count);
+	if (!(exp_connect_flags(tgt->ltd_exp) & OBD_CONNECT_STRIPED_DIR))
+		RETURN(-EOPNOTSUPP);
+
+	if (lum->lum_stripe_offset != (__u32)-1 &&
+	    lum->lum_stripe_offset != op_data->op_mds) {
+		CDEBUG(D_INODE, "striped dir must start on MDT of parent %u,"
+		       " not %u\n", op_data->op_mds, lum->lum_stripe_offset);
+		RETURN(-EINVAL);
+	}
+
+	if (lum->lum_hash_type != 0 &&
+	    lum->lum_hash_type != MEA_MAGIC_LAST_CHAR &&
+	    lum->lum_hash_type != MEA_MAGIC_ALL_CHARS)
+		RETURN(-EINVAL);
+
+	size = lmv_user_md_size(count, LMV_USER_MAGIC);
+	OBD_ALLOC(new, size);
+	if (new == NULL)
+		RETURN(-ENOMEM);
+
+	*new = *lum;
+	new->lum_stripe_count = count;
+	new->lum_stripe_offset = op_data->op_mds;
+	if (new->lum_hash_type == 0)
+		new->lum_hash_type = MEA_MAGIC_ALL_CHARS;
+
+	new->lum_objects[0].lum_fid = op_data->op_fid2;
+	new->lum_objects[0].lum_mds = op_data->op_mds;
+	for (i = 1; i < count; i++) {
+		mdsno_t mds = (op_data->op_mds + i) % lmv->desc.ld_tgt_count;
+
+		rc = __lmv_fid_alloc(lmv, &new->lum_objects[i].lum_fid, mds);
+		if (rc != 0) {
+			OBD_FREE(new, size);
+			RETURN(rc);
+		}
+		new->lum_objects[i].lum_mds = mds;
+	}
+
+	*lump = new;
+	*lum_size = size;
+	RETURN(0);
+}
+
 int lmv_create(struct obd_export *exp, struct md_op_data *op_data,
                const void *data, int datalen, int mode, __u32 uid,
                __u32 gid, cfs_cap_t cap_effective, __u64 rdev,
@@ -1504,6 +1608,8 @@ int lmv_create(struct obd_export *exp, struct md_op_data *op_data,
 	struct obd_device       *obd = exp->exp_obd;
 	struct lmv_obd          *lmv = &obd->u.lmv;
 	struct lmv_tgt_desc     *tgt;
+	struct lmv_user_md	*lum = NULL;
+	int			 lum_size = 0;
 	int                      rc;
 	ENTRY;
 
@@ -1514,6 +1620,11 @@ int lmv_create(struct obd_export *exp, struct md_op_data *op_data,
 	if (!lmv->desc.ld_active_tgt_count)
 		RETURN(-EIO);
 
+	if (op_data->op_bias & MDS_CREATE_VOLATILE)
+		lmv_volatile2shard(lmv, op_data);
+	else
+		lmv_name2shard(op_data->op_mea1, &op_data->op_fid1,
+			       op_data->op_name, op_data->op_namelen);
 	tgt = lmv_locate_mds(lmv, op_data, &op_data->op_fid1);
 	if (IS_ERR(tgt))
 		RETURN(PTR_ERR(tgt));
@@ -1522,6 +1633,16 @@ int lmv_create(struct obd_export *exp, struct md_op_data *op_data,
 	if (rc)
 		RETURN(rc);
 
+	if (op_data->op_cli_flags & CLI_SET_MEA &&
+	    ((struct lmv_user_md *)op_data->op_data)->lum_stripe_count > 1 &&
+	    lmv->desc.ld_tgt_count > 1) {
+		rc = lmv_stripe_dir_prep(lmv, tgt, op_data, &lum, &lum_size);
+		if (rc)
+			RETURN(rc);
+		data = lum;
+		datalen = lum_size;
+	}
+
 	CDEBUG(D_INODE, "CREATE '%*s' on "DFID" -> mds #%x\n",
 	       op_data->op_namelen, op_data->op_name, PFID(&op_data->op_fid1),
 	       op_data->op_mds);
@@ -1529,6 +1650,8 @@ int lmv_create(struct obd_export *exp, struct md_op_data *op_data,
 	op_data->op_flags |= MF_MDC_CANCEL_FID1;
 	rc = md_create(tgt->ltd_exp, op_data, data, datalen, mode, uid, gid,
 		       cap_effective, rdev, request);
+	if (lum != NULL)
+		OBD_FREE(lum, lum_size);
 
 	if (rc == 0) {
 		if (*request == NULL)
@@ -1672,6 +1795,8 @@ lmv_getattr_name(struct obd_export *exp,struct md_op_data *op_data,
 	if (rc)
 		RETURN(rc);
 
+	lmv_name2shard(op_data->op_mea1, &op_data->op_fid1, op_data->op_name,
+		       op_data->op_namelen);
 	tgt = lmv_locate_mds(lmv, op_data, &op_data->op_fid1);
 	if (IS_ERR(tgt))
 		RETURN(PTR_ERR(tgt));
@@ -1778,6 +1903,8 @@ static int lmv_link(struct obd_export *exp, struct md_op_data *op_data,
 	op_data->op_fsuid = cfs_curproc_fsuid();
 	op_data->op_fsgid = cfs_curproc_fsgid();
 	op_data->op_cap = cfs_curproc_cap_pack();
+	lmv_name2shard(op_data->op_mea2, &op_data->op_fid2, op_data->op_name,
+		       op_data->op_namelen);
 	tgt = lmv_locate_mds(lmv, op_data, &op_data->op_fid2);
 	if (IS_ERR(tgt))
 		RETURN(PTR_ERR(tgt));
@@ -1820,6 +1947,9 @@ static int lmv_rename(struct obd_export *exp, struct md_op_data *op_data,
 	op_data->op_fsuid = cfs_curproc_fsuid();
 	op_data->op_fsgid = cfs_curproc_fsgid();
 	op_data->op_cap = cfs_curproc_cap_pack();
+	/* a rename between two shards on different MDTs gets -EXDEV */
+	lmv_name2shard(op_data->op_mea1, &op_data->op_fid1, old, oldlen);
+	lmv_name2shard(op_data->op_mea2, &op_data->op_fid2, new, newlen);
 	src_tgt = lmv_locate_mds(lmv, op_data, &op_data->op_fid1);
 	if (IS_ERR(src_tgt))
 		RETURN(PTR_ERR(src_tgt));
@@ -1914,6 +2044,251 @@ static int lmv_sync(struct obd_export *exp, const struct lu_fid *fid,
         RETURN(rc);
 }
 
+static int lmv_dom_rw(struct obd_export *exp, struct md_op_data *op_data,
+		      int cmd, struct page **pages,
+		      struct ptlrpc_request **request)
+{
+	struct obd_device	*obd = exp->exp_obd;
+	struct lmv_obd		*lmv = &obd->u.lmv;
+	struct lmv_tgt_desc	*tgt;
+	int			 rc;
+	ENTRY;
+
+	rc = lmv_check_connect(obd);
+	if (rc)
+		RETURN(rc);
+
+	tgt = lmv_find_target(lmv, &op_data->op_fid1);
+	if (IS_ERR(tgt))
+		RETURN(PTR_ERR(tgt));
+
+	rc = md_dom_rw(tgt->ltd_exp, op_data, cmd, pages, request);
+	RETURN(rc);
+}
+
+/*
+ * Several lu_dirpages (LU_PAGE_SIZE) may come in one client page, chain
+ * their entries so that the client page reads as one lu_dirpage.
+ */
+static void lmv_adjust_dirpages(struct page **pages, int nrdpgs, int nlupgs)
+{
+	struct lu_dirpage	*dp;
+	struct lu_dirent	*ent;
+	int			 i;
+
+	for (i = 0; i < nrdpgs; i++) {
+#if CFS_PAGE_SIZE > LU_PAGE_SIZE
+		struct lu_dirpage *first;
+		__u64 hash_end = 0;
+		__u32 flags = 0;
+#endif
+		struct lu_dirent *tmp = NULL;
+
+		dp = cfs_kmap(pages[i]);
+		ent = lu_dirent_start(dp);
+#if CFS_PAGE_SIZE > LU_PAGE_SIZE
+		first = dp;
+		hash_end = dp->ldp_hash_end;
+repeat:
+#endif
+		nlupgs--;
+
+		for (tmp = ent; ent != NULL;
+		     tmp = ent, ent = lu_dirent_next(ent));
+#if CFS_PAGE_SIZE > LU_PAGE_SIZE
+		dp = (struct lu_dirpage *)((char *)dp + LU_PAGE_SIZE);
+		if (((unsigned long)dp & ~CFS_PAGE_MASK) && nlupgs > 0) {
+			ent = lu_dirent_start(dp);
+
+			if (tmp) {
+				/* enlarge the end entry lde_reclen from 0 to
+				 * first entry of next lu_dirpage, in this way
+				 * several lu_dirpages can be stored into one
+				 * client page on client. */
+				tmp = ((void *)tmp) +
+				      le16_to_cpu(tmp->lde_reclen);
+				tmp->lde_reclen =
+					cpu_to_le16((char *)(dp->ldp_entries) -
+						    (char *)tmp);
+				goto repeat;
+			}
+		}
+		first->ldp_hash_end = hash_end;
+		first->ldp_flags &= ~cpu_to_le32(LDF_COLLIDE);
+		first->ldp_flags |= flags & cpu_to_le32(LDF_COLLIDE);
+#else
+		SET_BUT_UNUSED(tmp);
+#endif
+		cfs_kunmap(pages[i]);
+	}
+}
+
+/*
+ * Read one page of each shard of a striped directory starting at
+ * op_data->op_offset and merge the entries by hash into pages[0]. Entries
+ * are returned only up to the smallest hash_end of the shards, the entries
+ * beyond it in other shards come with the next call. "." and ".." of the
+ * shards other than the master are skipped.
+ */
+static int lmv_readpage_striped(struct obd_export *exp,
+				struct md_op_data *op_data,
+				struct page **pages,
+				struct ptlrpc_request **request)
+{
+	struct obd_device	 *obd = exp->exp_obd;
+	struct lmv_obd		 *lmv = &obd->u.lmv;
+	struct lmv_stripe_md	 *mea = op_data->op_mea1;
+	struct lu_fid		  fid = op_data->op_fid1;
+	int			  npages = op_data->op_npages;
+	__u64			  offset = op_data->op_offset;
+	__u64			  limit = MDS_DIR_END_OFF;
+	__u64			  hash_end;
+	__u64			  last_hash = 0;
+	__u32			  flags = 0;
+	struct ptlrpc_request	**reqs;
+	struct page		**spages;
+	struct lu_dirent	**ents;
+	struct lu_dirpage	 *out;
+	struct lu_dirent	 *prev = NULL;
+	char			 *tail;
+	int			  count = mea->mea_count;
+	int			  rc = 0;
+	int			  i;
+	ENTRY;
+
+	OBD_ALLOC(reqs, count * sizeof(*reqs));
+	OBD_ALLOC(spages, count * sizeof(*spages));
+	OBD_ALLOC(ents, count * sizeof(*ents));
+	if (reqs == NULL || spages == NULL || ents == NULL)
+		GOTO(out_free, rc = -ENOMEM);
+
+	for (i = 0; i < count; i++) {
+		spages[i] = cfs_alloc_page(CFS_ALLOC_STD);
+		if (spages[i] == NULL)
+			GOTO(out_pages, rc = -ENOMEM);
+	}
+
+	op_data->op_npages = 1;
+	for (i = 0; i < count; i++) {
+		struct lmv_tgt_desc	*tgt;
+		struct lu_dirpage	*dp;
+		int			 nob;
+
+		op_data->op_fid1 = mea->mea_ids[i];
+		tgt = lmv_find_target(lmv, &op_data->op_fid1);
+		if (IS_ERR(tgt))
+			GOTO(out_reqs, rc = PTR_ERR(tgt));
+
+		rc = md_readpage(tgt->ltd_exp, op_data, &spages[i], &reqs[i]);
+		if (rc != 0)
+			GOTO(out_reqs, rc);
+
+		nob = reqs[i]->rq_bulk->bd_nob_transferred;
+		LASSERT(nob > 0 && !(nob & ~LU_PAGE_MASK));
+		lmv_adjust_dirpages(&spages[i], 1, nob >> LU_PAGE_SHIFT);
+
+		dp = cfs_kmap(spages[i]);
+		if (le64_to_cpu(dp->ldp_hash_end) < limit)
+			limit = le64_to_cpu(dp->ldp_hash_end);
+		ents[i] = lu_dirent_start(dp);
+	}
+
+	out = cfs_kmap(pages[0]);
+	tail = (char *)out->ldp_entries;
+	for (;;) {
+		struct lu_dirent	*ent = NULL;
+		__u64			 hash = 0;
+		int			 size;
+		int			 k = -1;
+
+		/* the entry with the smallest hash below limit */
+		for (i = 0; i < count; i++) {
+			struct lu_dirent *e = ents[i];
+
+			/* "." and ".." of the shards */
+			while (i > 0 && e != NULL &&
+			       ((le16_to_cpu(e->lde_namelen) == 1 &&
+				 e->lde_name[0] == '.') ||
+				(le16_to_cpu(e->lde_namelen) == 2 &&
+				 e->lde_name[0] == '.' && e->lde_name[1] == '.')))
+				e = lu_dirent_next(e);
+			ents[i] = e;
+
+			if (e == NULL || (le64_to_cpu(e->lde_hash) >= limit &&
+					  limit != MDS_DIR_END_OFF))
+				continue;
+			if (ent == NULL || le64_to_cpu(e->lde_hash) < hash) {
+				ent = e;
+				hash = le64_to_cpu(e->lde_hash);
+				k = i;
+			}
+		}
+
+		if (ent == NULL) {
+			hash_end = limit;
+			break;
+		}
+
+		size = lu_dirent_calc_size(le16_to_cpu(ent->lde_namelen),
+					   le32_to_cpu(ent->lde_attrs));
+		if (tail + size > (char *)out + CFS_PAGE_SIZE) {
+			/* page is full, continue from this entry */
+			hash_end = hash;
+			if (prev != NULL && hash == last_hash)
+				flags |= LDF_COLLIDE;
+			break;
+		}
+
+		memcpy(tail, ent, size);
+		prev = (struct lu_dirent *)tail;
+		prev->lde_reclen = cpu_to_le16(size);
+		tail += size;
+		last_hash = hash;
+		ents[k] = lu_dirent_next(ent);
+	}
+
+	if (prev != NULL)
+		prev->lde_reclen = 0;
+	else
+		flags |= LDF_EMPTY;
+
+	/* an entry hash colliding over a whole shard page, move on */
+	if (hash_end == offset && prev == NULL && hash_end != MDS_DIR_END_OFF)
+		hash_end++;
+
+	out->ldp_hash_start = cpu_to_le64(offset);
+	out->ldp_hash_end = cpu_to_le64(hash_end);
+	out->ldp_flags = cpu_to_le32(flags);
+	cfs_kunmap(pages[0]);
+
+	CDEBUG(D_INODE, "striped "DFID" ["LPX64", "LPX64"] flags %#x\n",
+	       PFID(&fid), offset, hash_end, flags);
+
+	*request = reqs[0];
+	reqs[0] = NULL;
+	i = count;
+out_reqs:
+	while (--i >= 0)
+		cfs_kunmap(spages[i]);
+	for (i = 0; i < count; i++)
+		if (reqs[i] != NULL)
+			ptlrpc_req_finished(reqs[i]);
+	op_data->op_fid1 = fid;
+	op_data->op_npages = npages;
+	i = count;
+out_pages:
+	while (--i >= 0)
+		cfs_free_page(spages[i]);
+out_free:
+	if (ents != NULL)
+		OBD_FREE(ents, count * sizeof(*ents));
+	if (spages != NULL)
+		OBD_FREE(spages, count * sizeof(*spages));
+	if (reqs != NULL)
+		OBD_FREE(reqs, count * sizeof(*reqs));
+	RETURN(rc);
+}
+
 static int lmv_readpage(struct obd_export *exp, struct md_op_data *op_data,
                         struct page **pages, struct ptlrpc_request **request)
 {
@@ -1921,14 +2296,11 @@ static int lmv_readpage(struct obd_export *exp, struct md_op_data *op_data,
         struct lmv_obd          *lmv = &obd->u.lmv;
         __u64                    offset = op_data->op_offset;
         int                      rc;
-        int                      i;
         /* number of pages read, in CFS_PAGE_SIZE */
         int                      nrdpgs;
         /* number of pages transferred in LU_PAGE_SIZE */
         int                      nlupgs;
         struct lmv_tgt_desc     *tgt;
-        struct lu_dirpage       *dp;
-        struct lu_dirent        *ent;
         ENTRY;
 
         rc = lmv_check_connect(obd);
@@ -1994,6 +2366,9 @@ static int lmv_readpage(struct obd_export *exp, struct md_op_data *op_data,
 		       PFID(&rid), (unsigned long)offset, tgt_idx);
 	}
 	*/
+	if (op_data->op_mea1 != NULL && op_data->op_mea1->mea_count > 1)
+		RETURN(lmv_readpage_striped(exp, op_data, pages, request));
+
 	tgt = lmv_find_target(lmv, &op_data->op_fid1);
 	if (IS_ERR(tgt))
 		RETURN(PTR_ERR(tgt));
@@ -2011,51 +2386,7 @@ static int lmv_readpage(struct obd_export *exp, struct md_op_data *op_data,
 	CDEBUG(D_INODE, "read %d(%d)/%d pages\n", nrdpgs, nlupgs,
 	       op_data->op_npages);
 
-	for (i = 0; i < nrdpgs; i++) {
-#if CFS_PAGE_SIZE > LU_PAGE_SIZE
-		struct lu_dirpage *first;
-		__u64 hash_end = 0;
-		__u32 flags = 0;
-#endif
-		struct lu_dirent *tmp = NULL;
-
-		dp = cfs_kmap(pages[i]);
-		ent = lu_dirent_start(dp);
-#if CFS_PAGE_SIZE > LU_PAGE_SIZE
-		first = dp;
-		hash_end = dp->ldp_hash_end;
-repeat:
-#endif
-		nlupgs--;
-
-		for (tmp = ent; ent != NULL;
-		     tmp = ent, ent = lu_dirent_next(ent));
-#if CFS_PAGE_SIZE > LU_PAGE_SIZE
-		dp = (struct lu_dirpage *)((char *)dp + LU_PAGE_SIZE);
-		if (((unsigned long)dp & ~CFS_PAGE_MASK) && nlupgs > 0) {
-			ent = lu_dirent_start(dp);
-
-			if (tmp) {
-				/* enlarge the end entry lde_reclen from 0 to
-				 * first entry of next lu_dirpage, in this way
-				 * several lu_dirpages can be stored into one
-				 * client page on client. */
-				tmp = ((void *)tmp) +
-				      le16_to_cpu(tmp->lde_reclen);
-				tmp->lde_reclen =
-					cpu_to_le16((char *)(dp->ldp_entries) -
-						    (char *)tmp);
-				goto repeat;
-			}
-		}
-		first->ldp_hash_end = hash_end;
-		first->ldp_flags &= ~cpu_to_le32(LDF_COLLIDE);
-		first->ldp_flags |= flags & cpu_to_le32(LDF_COLLIDE);
-#else
-		SET_BUT_UNUSED(tmp);
-#endif
-		cfs_kunmap(pages[i]);
-	}
+	lmv_adjust_dirpages(pages, nrdpgs, nlupgs);
 	RETURN(rc);
 }
 
@@ -2072,6 +2403,9 @@ static int lmv_unlink(struct obd_export *exp, struct md_op_data *op_data,
 	rc = lmv_check_connect(obd);
 	if (rc)
 		RETURN(rc);
+
+	lmv_name2shard(op_data->op_mea1, &op_data->op_fid1, op_data->op_name,
+		       op_data->op_namelen);
 retry:
 	/* Send unlink requests to the MDT where the child is located */
 	if (likely(!fid_is_zero(&op_data->op_fid2)))
@@ -2339,7 +2673,23 @@ int lmv_unpackmd(struct obd_export *exp, struct lov_stripe_md **lsmp,
                 RETURN(0);
         }
 
-        LASSERT(mea_size == lmm_size);
+	/* the EA of a striped directory comes from the MDT, check it */
+	if (lmm != NULL &&
+	    (lmm_size < sizeof(*mea) ||
+	     le32_to_cpu(mea->mea_count) > lmv->desc.ld_tgt_count ||
+	     lmm_size < lmv_stripe_md_size(le32_to_cpu(mea->mea_count)))) {
+		CERROR("%s: bad LMV EA size %d: rc = %d\n",
+		       obd->obd_name, lmm_size, -EPROTO);
+		RETURN(-EPROTO);
+	}
+
+	magic = lmm == NULL ? 0 : le32_to_cpu(mea->mea_magic);
+	if (lmm != NULL && magic != MEA_MAGIC_LAST_CHAR &&
+	    magic != MEA_MAGIC_ALL_CHARS) {
+		CERROR("%s: unsupported LMV EA magic %#x: rc = %d\n",
+		       obd->obd_name, magic, -EPROTO);
+		RETURN(-EPROTO);
+	}
 
         OBD_ALLOC_LARGE(*tmea, mea_size);
         if (*tmea == NULL)
@@ -2348,19 +2698,6 @@ int lmv_unpackmd(struct obd_export *exp, struct lov_stripe_md **lsmp,
         if (!lmm)
                 RETURN(mea_size);
 
-        if (mea->mea_magic == MEA_MAGIC_LAST_CHAR ||
-            mea->mea_magic == MEA_MAGIC_ALL_CHARS ||
-            mea->mea_magic == MEA_MAGIC_HASH_SEGMENT)
-        {
-                magic = le32_to_cpu(mea->mea_magic);
-        } else {
-                /*
-                 * Old mea is not handled here.
-                 */
-                CERROR("Old not supportable EA is found\n");
-                LBUG();
-        }
-
         (*tmea)->mea_magic = magic;
         (*tmea)->mea_count = le32_to_cpu(mea->mea_count);
         (*tmea)->mea_master = le32_to_cpu(mea->mea_master);
@@ -2561,6 +2898,8 @@ int lmv_intent_getattr_async(struct obd_export *exp,
 	if (rc)
 		RETURN(rc);
 
+	lmv_name2shard(op_data->op_mea1, &op_data->op_fid1, op_data->op_name,
+		       op_data->op_namelen);
 	tgt = lmv_find_target(lmv, &op_data->op_fid1);
 	if (IS_ERR(tgt))
 		RETURN(PTR_ERR(tgt));
@@ -2569,6 +2908,34 @@ int lmv_intent_getattr_async(struct obd_export *exp,
 	RETURN(rc);
 }
 
+static int lmv_batch_getattr_async(struct obd_export *exp,
+				   struct md_batch_info *mbi,
+				   struct ldlm_enqueue_info *einfo)
+{
+	struct obd_device	*obd = exp->exp_obd;
+	struct lmv_obd		*lmv = &obd->u.lmv;
+	struct lmv_tgt_desc	*tgt;
+	int			 rc;
+	ENTRY;
+
+	rc = lmv_check_connect(obd);
+	if (rc)
+		RETURN(rc);
+
+	/* the names of a striped directory are spread over its shards */
+	if (mbi->mbi_data.op_mea1 != NULL &&
+	    mbi->mbi_data.op_mea1->mea_count > 1)
+		RETURN(-EOPNOTSUPP);
+
+	/* names living on other MDTs come back with -EREMOTE */
+	tgt = lmv_find_target(lmv, &mbi->mbi_data.op_fid1);
+	if (IS_ERR(tgt))
+		RETURN(PTR_ERR(tgt));
+
+	rc = md_batch_getattr_async(tgt->ltd_exp, mbi, einfo);
+	RETURN(rc);
+}
+
 int lmv_revalidate_lock(struct obd_export *exp, struct lookup_intent *it,
                         struct lu_fid *fid, __u64 *bits)
 {
@@ -2706,6 +3073,7 @@ struct md_ops lmv_md_ops = {
         .m_setxattr             = lmv_setxattr,
         .m_sync                 = lmv_sync,
         .m_readpage             = lmv_readpage,
+	.m_dom_rw		= lmv_dom_rw,
         .m_unlink               = lmv_unlink,
         .m_init_ea_size         = lmv_init_ea_size,
         .m_cancel_unused        = lmv_cancel_unused,
@@ -2719,6 +3087,7 @@ struct md_ops lmv_md_ops = {
         .m_unpack_capa          = lmv_unpack_capa,
         .m_get_remote_perm      = lmv_get_remote_perm,
         .m_intent_getattr_async = lmv_intent_getattr_async,
+	.m_batch_getattr_async	= lmv_batch_getattr_async,
         .m_revalidate_lock      = lmv_revalidate_lock
 };
 
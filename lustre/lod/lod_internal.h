@@ -158,11 +158,16 @@ struct lod_object {
 	 * is cached in stripenr/stripe_size */
 	unsigned int	   ldo_stripes_allocated:16,
 			   ldo_striping_cached:1,
-			   ldo_def_striping_set:1;
+			   ldo_def_striping_set:1,
+			   ldo_dom:1, /* data on MDT, no stripes */
+			   ldo_def_dom:1, /* default is data on MDT */
+			   ldo_dir_striped:1; /* shards in ldo_stripe */
 	__u32		   ldo_def_stripe_size;
 	__u16		   ldo_def_stripenr;
 	__u16		   ldo_def_stripe_offset;
 	mdsno_t		   ldo_mds_num;
+	/* name hash of a striped directory, MEA_MAGIC_* */
+	__u32		   ldo_dir_hash_type;
 };
 
 
@@ -181,6 +186,7 @@ struct lod_thread_info {
 	struct obd_statfs lti_osfs;
 	struct lu_attr    lti_attr;
 	struct lod_it	  lti_it;
+	struct dt_allocation_hint lti_ah;
 };
 
 extern const struct lu_device_operations lod_lu_ops;
@@ -274,7 +280,16 @@ int lod_del_device(const struct lu_env *env, struct lod_device *lod,
 		   unsigned gen);
 int lod_fini_tgt(struct lod_device *lod, struct lod_tgt_descs *ltd);
 int lod_load_striping(const struct lu_env *env, struct lod_object *mo);
+int lod_get_ea(const struct lu_env *env, struct lod_object *mo,
+	       const char *name);
 int lod_get_lov_ea(const struct lu_env *env, struct lod_object *mo);
+struct dt_object *lod_dir_shard_locate(const struct lu_env *env,
+				       struct lod_device *lod,
+				       const struct lu_fid *fid);
+int lod_parse_dir_striping(const struct lu_env *env, struct lod_object *mo,
+			   const struct lu_buf *buf);
+int lod_generate_lmvea(const struct lu_env *env, struct lod_object *mo,
+		       struct lu_buf *buf);
 void lod_fix_desc(struct lov_desc *desc);
 void lod_fix_desc_qos_maxage(__u32 *val);
 void lod_fix_desc_pattern(__u32 *val);
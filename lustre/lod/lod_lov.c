@@ -228,7 +228,8 @@ int lod_add_device(const struct lu_env *env, struct lod_device *lod,
 					   OBD_CONNECT_FID |
 					   OBD_CONNECT_LVB_TYPE |
 					   OBD_CONNECT_VERSION |
-					   OBD_CONNECT_PINGLESS;
+					   OBD_CONNECT_PINGLESS |
+					   OBD_CONNECT_SYNC_BATCH;
 
 		data->ocd_group = tgt_index;
 		ltd = &lod->lod_ost_descs;
@@ -504,7 +505,7 @@ int lod_generate_and_set_lovea(const struct lu_env *env,
 	ENTRY;
 
 	LASSERT(lo);
-	LASSERT(lo->ldo_stripenr > 0);
+	LASSERT(lo->ldo_stripenr > 0 || lo->ldo_dom);
 
 	magic = lo->ldo_pool ? LOV_MAGIC_V3 : LOV_MAGIC_V1;
 	lmm_size = lov_mds_md_size(lo->ldo_stripenr, magic);
@@ -517,7 +518,8 @@ int lod_generate_and_set_lovea(const struct lu_env *env,
 	lmm = info->lti_ea_store;
 
 	lmm->lmm_magic = cpu_to_le32(magic);
-	lmm->lmm_pattern = cpu_to_le32(LOV_PATTERN_RAID0);
+	lmm->lmm_pattern = cpu_to_le32(lo->ldo_dom ? LOV_PATTERN_MDT :
+						     LOV_PATTERN_RAID0);
 	fid_to_lmm_oi(fid, &lmm->lmm_oi);
 	lmm_oi_cpu_to_le(&lmm->lmm_oi, &lmm->lmm_oi);
 	lmm->lmm_stripe_size = cpu_to_le32(lo->ldo_stripe_size);
@@ -565,7 +567,8 @@ int lod_generate_and_set_lovea(const struct lu_env *env,
 	RETURN(rc);
 }
 
-int lod_get_lov_ea(const struct lu_env *env, struct lod_object *lo)
+int lod_get_ea(const struct lu_env *env, struct lod_object *lo,
+	       const char *name)
 {
 	struct lod_thread_info *info = lod_env_info(env);
 	struct dt_object       *next = dt_object_child(&lo->ldo_obj);
@@ -581,7 +584,7 @@ int lod_get_lov_ea(const struct lu_env *env, struct lod_object *lo)
 repeat:
 		info->lti_buf.lb_buf = info->lti_ea_store;
 		info->lti_buf.lb_len = info->lti_ea_store_size;
-		rc = dt_xattr_get(env, next, &info->lti_buf, XATTR_NAME_LOV,
+		rc = dt_xattr_get(env, next, &info->lti_buf, name,
 				  BYPASS_CAPA);
 	}
 	/* if object is not striped or inaccessible */
@@ -590,7 +593,7 @@ repeat:
 
 	if (rc == -ERANGE) {
 		/* EA doesn't fit, reallocate new buffer */
-		rc = dt_xattr_get(env, next, &LU_BUF_NULL, XATTR_NAME_LOV,
+		rc = dt_xattr_get(env, next, &LU_BUF_NULL, name,
 				  BYPASS_CAPA);
 		if (rc == -ENODATA)
 			RETURN(0);
@@ -607,6 +610,127 @@ repeat:
 	RETURN(rc);
 }
 
+int lod_get_lov_ea(const struct lu_env *env, struct lod_object *lo)
+{
+	return lod_get_ea(env, lo, XATTR_NAME_LOV);
+}
+
+/*
+ * find the shard \a fid of a striped directory, the object is looked up from
+ * the top of the stack so that all the layers know it, the slice below LOD
+ * is returned
+ */
+struct dt_object *lod_dir_shard_locate(const struct lu_env *env,
+				       struct lod_device *lod,
+				       const struct lu_fid *fid)
+{
+	struct lu_device *top = lod2lu_dev(lod)->ld_site->ls_top_dev;
+	struct dt_object *dt;
+
+	dt = dt_locate_at(env, &lod->lod_dt_dev, fid, top);
+	if (IS_ERR(dt))
+		return dt;
+
+	return dt_object_child(dt);
+}
+
+/*
+ * Parse the LMV EA of a striped directory, the shards other than the master
+ * itself are kept in ldo_stripe[]
+ */
+int lod_parse_dir_striping(const struct lu_env *env, struct lod_object *lo,
+			   const struct lu_buf *buf)
+{
+	struct lod_device	*lod = lu2lod_dev(lo->ldo_obj.do_lu.lo_dev);
+	struct lmv_stripe_md	*mea = buf->lb_buf;
+	struct dt_object       **stripe;
+	struct lu_fid		 fid;
+	int			 count;
+	int			 i;
+	int			 rc = 0;
+	ENTRY;
+
+	if (buf->lb_len < sizeof(*mea))
+		RETURN(-EINVAL);
+
+	count = le32_to_cpu(mea->mea_count);
+	if (count <= 1)
+		RETURN(0);
+	if (buf->lb_len < lmv_stripe_md_size(count)) {
+		CERROR("%s: bad LMV EA of "DFID", count %d, size %d\n",
+		       lod2obd(lod)->obd_name,
+		       PFID(lu_object_fid(&lo->ldo_obj.do_lu)), count,
+		       (int)buf->lb_len);
+		RETURN(-EINVAL);
+	}
+
+	OBD_ALLOC(stripe, sizeof(stripe[0]) * (count - 1));
+	if (stripe == NULL)
+		RETURN(-ENOMEM);
+
+	for (i = 1; i < count; i++) {
+		fid_le_to_cpu(&fid, &mea->mea_ids[i]);
+		stripe[i - 1] = lod_dir_shard_locate(env, lod, &fid);
+		if (IS_ERR(stripe[i - 1])) {
+			rc = PTR_ERR(stripe[i - 1]);
+			stripe[i - 1] = NULL;
+			break;
+		}
+	}
+
+	if (rc != 0) {
+		for (i = 0; i < count - 1; i++)
+			if (stripe[i] != NULL)
+				lu_object_put(env, &stripe[i]->do_lu);
+		OBD_FREE(stripe, sizeof(stripe[0]) * (count - 1));
+		RETURN(rc);
+	}
+
+	lo->ldo_stripe = stripe;
+	lo->ldo_stripenr = count - 1;
+	lo->ldo_stripes_allocated = count - 1;
+	lo->ldo_dir_striped = 1;
+	lo->ldo_dir_hash_type = le32_to_cpu(mea->mea_magic);
+	RETURN(0);
+}
+
+/*
+ * generate LMV EA of a striped directory in lti_ea_store
+ */
+int lod_generate_lmvea(const struct lu_env *env, struct lod_object *lo,
+		       struct lu_buf *buf)
+{
+	struct lod_thread_info	*info = lod_env_info(env);
+	struct lmv_stripe_md	*mea;
+	int			 count = lo->ldo_stripenr + 1;
+	int			 size = lmv_stripe_md_size(count);
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	LASSERT(lo->ldo_dir_striped);
+
+	if (info->lti_ea_store_size < size) {
+		rc = lod_ea_store_resize(info, size);
+		if (rc)
+			RETURN(rc);
+	}
+
+	mea = info->lti_ea_store;
+	memset(mea, 0, size);
+	mea->mea_magic = cpu_to_le32(lo->ldo_dir_hash_type);
+	mea->mea_count = cpu_to_le32(count);
+	mea->mea_master = cpu_to_le32(lo->ldo_mds_num);
+	fid_cpu_to_le(&mea->mea_ids[0], lu_object_fid(&lo->ldo_obj.do_lu));
+	for (i = 1; i < count; i++)
+		fid_cpu_to_le(&mea->mea_ids[i],
+			      lu_object_fid(&lo->ldo_stripe[i - 1]->do_lu));
+
+	buf->lb_buf = mea;
+	buf->lb_len = size;
+	RETURN(0);
+}
+
 int lod_store_def_striping(const struct lu_env *env, struct dt_object *dt,
 			   struct thandle *th)
 {
@@ -639,7 +763,8 @@ int lod_store_def_striping(const struct lu_env *env, struct dt_object *dt,
 		RETURN(-ENOMEM);
 
 	v3->lmm_magic = cpu_to_le32(LOV_MAGIC_V3);
-	v3->lmm_pattern = cpu_to_le32(LOV_PATTERN_RAID0);
+	v3->lmm_pattern = cpu_to_le32(lo->ldo_def_dom ? LOV_PATTERN_MDT :
+							LOV_PATTERN_RAID0);
 	v3->lmm_stripe_size = cpu_to_le32(lo->ldo_def_stripe_size);
 	v3->lmm_stripe_count = cpu_to_le16(lo->ldo_def_stripenr);
 	v3->lmm_stripe_offset = cpu_to_le16(lo->ldo_def_stripe_offset);
@@ -758,6 +883,16 @@ int lod_parse_striping(const struct lu_env *env, struct lod_object *lo,
 
 	if (magic != LOV_MAGIC_V1 && magic != LOV_MAGIC_V3)
 		GOTO(out, rc = -EINVAL);
+
+	/* data on MDT, there are no stripe objects to set up */
+	if (le32_to_cpu(lmm->lmm_pattern) == LOV_PATTERN_MDT) {
+		lo->ldo_dom = 1;
+		lo->ldo_stripenr = 0;
+		lo->ldo_stripe_size = le32_to_cpu(lmm->lmm_stripe_size);
+		lo->ldo_layout_gen = le16_to_cpu(lmm->lmm_layout_gen);
+		GOTO(out, rc = 0);
+	}
+
 	if (le32_to_cpu(lmm->lmm_pattern) != LOV_PATTERN_RAID0)
 		GOTO(out, rc = -EINVAL);
 
@@ -809,6 +944,18 @@ int lod_load_striping(const struct lu_env *env, struct lod_object *lo)
 	if (!dt_object_exists(next))
 		GOTO(out, rc = 0);
 
+	/* a directory can be striped over MDTs */
+	if (S_ISDIR(lu_object_attr(lod2lu_obj(lo)))) {
+		rc = lod_get_ea(env, lo, XATTR_NAME_LMV);
+		if (rc <= 0)
+			GOTO(out, rc);
+
+		info->lti_buf.lb_buf = info->lti_ea_store;
+		info->lti_buf.lb_len = rc;
+		rc = lod_parse_dir_striping(env, lo, &info->lti_buf);
+		GOTO(out, rc);
+	}
+
 	/* only regular files can be striped */
 	if (!(lu_object_attr(lod2lu_obj(lo)) & S_IFREG))
 		GOTO(out, rc = 0);
@@ -851,8 +998,23 @@ int lod_verify_striping(struct lod_device *d, const struct lu_buf *buf,
 		RETURN(-EINVAL);
 	}
 
-	if ((specific && lum->lmm_pattern != LOV_PATTERN_RAID0) ||
-	    (specific == 0 && lum->lmm_pattern != 0)) {
+	if (specific == 0 && lum->lmm_pattern == LOV_PATTERN_MDT) {
+		/* directory default for DoM files, the stripe size is their
+		 * size limit and there are no OSTs to choose */
+		if (lum->lmm_stripe_size == 0 ||
+		    lum->lmm_stripe_size > LOV_MAX_DOM_SIZE ||
+		    lum->lmm_stripe_count != 0 ||
+		    lum->lmm_stripe_offset !=
+		    (typeof(lum->lmm_stripe_offset))(-1) ||
+		    lum->lmm_magic != LOV_USER_MAGIC_V1) {
+			CDEBUG(D_IOCTL, "bad DoM default: size %u count %u "
+			       "offset %d magic %#x\n", lum->lmm_stripe_size,
+			       lum->lmm_stripe_count,
+			       (int)lum->lmm_stripe_offset, lum->lmm_magic);
+			RETURN(-EINVAL);
+		}
+	} else if ((specific && lum->lmm_pattern != LOV_PATTERN_RAID0) ||
+		   (specific == 0 && lum->lmm_pattern != 0)) {
 		CDEBUG(D_IOCTL, "bad userland stripe pattern: %#x\n",
 		       lum->lmm_pattern);
 		RETURN(-EINVAL);
@@ -52,6 +52,9 @@
 extern cfs_mem_cache_t *lod_object_kmem;
 static const struct dt_body_operations lod_body_lnk_ops;
 
+static const char dot[] = ".";
+static const char dotdot[] = "..";
+
 static int lod_index_lookup(const struct lu_env *env, struct dt_object *dt,
 			    struct dt_rec *rec, const struct dt_key *key,
 			    struct lustre_capa *capa)
@@ -274,6 +277,24 @@ static int lod_attr_get(const struct lu_env *env,
 	return dt_attr_get(env, dt_object_child(dt), attr, capa);
 }
 
+/*
+ * the shards of a striped directory take mode and ownership of the master,
+ * OST objects only care about ownership
+ */
+static const struct lu_attr *lod_stripe_attr(const struct lu_env *env,
+					     struct lod_object *lo,
+					     const struct lu_attr *attr)
+{
+	struct lu_attr *la = &lod_env_info(env)->lti_attr;
+
+	if (!lo->ldo_dir_striped)
+		return attr;
+
+	*la = *attr;
+	la->la_valid &= LA_MODE | LA_UID | LA_GID;
+	return la;
+}
+
 static int lod_declare_attr_set(const struct lu_env *env,
 				struct dt_object *dt,
 				const struct lu_attr *attr,
@@ -297,8 +318,10 @@ static int lod_declare_attr_set(const struct lu_env *env,
 	 * lod_declare_init_size(), and not through this function.
 	 * Therefore we need not load striping unless ownership is
 	 * changing.  This should save memory and (we hope) speed up
-	 * rename(). */
-	if (!(attr->la_valid & (LA_UID | LA_GID)))
+	 * rename(). The shards of a striped directory follow its mode
+	 * too. */
+	if (!(attr->la_valid & (LA_UID | LA_GID)) &&
+	    !(attr->la_valid & LA_MODE && S_ISDIR(dt->do_lu.lo_header->loh_attr)))
 		RETURN(rc);
 
 	/*
@@ -314,6 +337,7 @@ static int lod_declare_attr_set(const struct lu_env *env,
 	 * if object is striped declare changes on the stripes
 	 */
 	LASSERT(lo->ldo_stripe || lo->ldo_stripenr == 0);
+	attr = lod_stripe_attr(env, lo, attr);
 	for (i = 0; i < lo->ldo_stripenr; i++) {
 		LASSERT(lo->ldo_stripe[i]);
 		rc = dt_declare_attr_set(env, lo->ldo_stripe[i], attr, handle);
@@ -344,13 +368,15 @@ static int lod_attr_set(const struct lu_env *env,
 	if (rc)
 		RETURN(rc);
 
-	if (!(attr->la_valid & (LA_UID | LA_GID)))
+	if (!(attr->la_valid & (LA_UID | LA_GID)) &&
+	    !(attr->la_valid & LA_MODE && lo->ldo_dir_striped))
 		RETURN(rc);
 
 	/*
 	 * if object is striped, apply changes to all the stripes
 	 */
 	LASSERT(lo->ldo_stripe || lo->ldo_stripenr == 0);
+	attr = lod_stripe_attr(env, lo, attr);
 	for (i = 0; i < lo->ldo_stripenr; i++) {
 		LASSERT(lo->ldo_stripe[i]);
 		rc = dt_attr_set(env, lo->ldo_stripe[i], attr, handle, capa);
@@ -407,6 +433,29 @@ static int lod_xattr_get(const struct lu_env *env, struct dt_object *dt,
 	RETURN(rc);
 }
 
+/*
+ * The shards of a striped directory have the link EA of the master, so that
+ * the path of an entry in a shard goes through the name of the directory.
+ */
+static int lod_declare_shards_linkea(const struct lu_env *env,
+				     struct dt_object *dt,
+				     const struct lu_buf *buf, int fl,
+				     struct thandle *th)
+{
+	struct lod_object	*lo = lod_dt_obj(dt);
+	int			 rc;
+	int			 i;
+
+	rc = lod_load_striping(env, lo);
+	if (rc != 0 || !lo->ldo_dir_striped)
+		return rc;
+
+	for (i = 0; i < lo->ldo_stripenr && rc == 0; i++)
+		rc = dt_declare_xattr_set(env, lo->ldo_stripe[i], buf,
+					  XATTR_NAME_LINK, fl, th);
+	return rc;
+}
+
 /*
  * LOV xattr is a storage for striping, and LOD owns this xattr.
  * but LOD allows others to control striping to some extent
@@ -456,6 +505,10 @@ static int lod_declare_xattr_set(const struct lu_env *env,
 	}
 
 	rc = dt_declare_xattr_set(env, next, buf, name, fl, th);
+	/* a new directory has no mode yet but its shards are known */
+	if (rc == 0 && !strcmp(name, XATTR_NAME_LINK) && buf->lb_buf != NULL &&
+	    (S_ISDIR(mode) || lod_dt_obj(dt)->ldo_dir_striped))
+		rc = lod_declare_shards_linkea(env, dt, buf, fl, th);
 
 	RETURN(rc);
 }
@@ -478,6 +531,7 @@ static int lod_xattr_set_lov_on_dir(const struct lu_env *env,
 	LASSERT(l->ldo_stripe == NULL);
 	l->ldo_striping_cached = 0;
 	l->ldo_def_striping_set = 0;
+	l->ldo_def_dom = 0;
 	lod_object_set_pool(l, NULL);
 	l->ldo_def_stripe_size = 0;
 	l->ldo_def_stripenr = 0;
@@ -529,12 +583,21 @@ static int lod_xattr_set(const struct lu_env *env,
 
 	attr = dt->do_lu.lo_header->loh_attr & S_IFMT;
 	if (S_ISDIR(attr)) {
+		struct lod_object *lo = lod_dt_obj(dt);
+		int		   i;
+
 		if (strncmp(name, XATTR_NAME_LOV, strlen(XATTR_NAME_LOV)) == 0)
 			rc = lod_xattr_set_lov_on_dir(env, dt, buf, name,
 						      fl, th, capa);
 		else
 			rc = dt_xattr_set(env, next, buf, name, fl, th, capa);
 
+		/* see lod_declare_shards_linkea() */
+		if (!strcmp(name, XATTR_NAME_LINK) && lo->ldo_dir_striped)
+			for (i = 0; i < lo->ldo_stripenr && rc == 0; i++)
+				rc = dt_xattr_set(env, lo->ldo_stripe[i], buf,
+						  name, fl, th, capa);
+
 	} else if (S_ISREG(attr) && !strcmp(name, XATTR_NAME_LOV)) {
 		/* in case of lov EA swap, just set it
 		 * if not, it is a replay so check striping match what we
@@ -625,6 +688,7 @@ static int lod_cache_parent_striping(const struct lu_env *env,
 	if (rc < sizeof(struct lov_user_md)) {
 		/* don't lookup for non-existing or invalid striping */
 		lp->ldo_def_striping_set = 0;
+		lp->ldo_def_dom = 0;
 		lp->ldo_striping_cached = 1;
 		lp->ldo_def_stripe_size = 0;
 		lp->ldo_def_stripenr = 0;
@@ -641,9 +705,11 @@ static int lod_cache_parent_striping(const struct lu_env *env,
 	if (v1->lmm_magic != LOV_MAGIC_V3 && v1->lmm_magic != LOV_MAGIC_V1)
 		GOTO(unlock, rc = 0);
 
-	if (v1->lmm_pattern != LOV_PATTERN_RAID0 && v1->lmm_pattern != 0)
+	if (v1->lmm_pattern != LOV_PATTERN_RAID0 && v1->lmm_pattern != 0 &&
+	    v1->lmm_pattern != LOV_PATTERN_MDT)
 		GOTO(unlock, rc = 0);
 
+	lp->ldo_def_dom = (v1->lmm_pattern == LOV_PATTERN_MDT);
 	lp->ldo_def_stripenr = v1->lmm_stripe_count;
 	lp->ldo_def_stripe_size = v1->lmm_stripe_size;
 	lp->ldo_def_stripe_offset = v1->lmm_stripe_offset;
@@ -657,7 +723,8 @@ static int lod_cache_parent_striping(const struct lu_env *env,
 			lod_object_set_pool(lp, v3->lmm_pool_name);
 	}
 
-	CDEBUG(D_OTHER, "def. striping: # %d, sz %d, off %d %s%s on "DFID"\n",
+	CDEBUG(D_OTHER, "def. striping: %s# %d, sz %d, off %d %s%s on "DFID
+	       "\n", lp->ldo_def_dom ? "DoM " : "",
 	       lp->ldo_def_stripenr, lp->ldo_def_stripe_size,
 	       lp->ldo_def_stripe_offset, v3 ? "from " : "",
 	       v3 ? lp->ldo_pool : "", PFID(lu_object_fid(&lp->ldo_obj.do_lu)));
@@ -719,6 +786,7 @@ static void lod_ah_init(const struct lu_env *env,
 			lc->ldo_def_stripenr = lp->ldo_def_stripenr;
 			lc->ldo_def_stripe_size = lp->ldo_def_stripe_size;
 			lc->ldo_def_stripe_offset = lp->ldo_def_stripe_offset;
+			lc->ldo_def_dom = lp->ldo_def_dom;
 			lc->ldo_striping_cached = 1;
 			lc->ldo_def_striping_set = 1;
 			CDEBUG(D_OTHER, "inherite EA sz:%d off:%d nr:%d\n",
@@ -738,6 +806,12 @@ static void lod_ah_init(const struct lu_env *env,
 					lu_object_fid(&child->do_lu)))
 		return;
 
+	/* DoM file being moved to OSTs, its size limit is no stripe size */
+	if (lc->ldo_dom) {
+		lc->ldo_dom = 0;
+		lc->ldo_stripe_size = 0;
+	}
+
 	/*
 	 * try from the parent
 	 */
@@ -750,7 +824,16 @@ static void lod_ah_init(const struct lu_env *env,
 
 		lc->ldo_def_stripe_offset = (__u16) -1;
 
-		if (lp->ldo_def_striping_set) {
+		if (lp->ldo_def_striping_set && lp->ldo_def_dom) {
+			/* the data of the new file is kept on the MDT */
+			lc->ldo_dom = 1;
+			lc->ldo_stripenr = 0;
+			lc->ldo_stripe_size = lp->ldo_def_stripe_size;
+			CDEBUG(D_OTHER, "DoM from parent: sz %d\n",
+			       lc->ldo_stripe_size);
+			EXIT;
+			return;
+		} else if (lp->ldo_def_striping_set) {
 			if (lp->ldo_pool)
 				lod_object_set_pool(lc, lp->ldo_pool);
 			lc->ldo_stripenr = lp->ldo_def_stripenr;
@@ -798,6 +881,10 @@ static int lod_declare_init_size(const struct lu_env *env,
 	LASSERT(lo->ldo_stripe || lo->ldo_stripenr == 0);
 	LASSERT(lo->ldo_stripe_size > 0);
 
+	/* DoM file keeps its size in the MDT inode */
+	if (lo->ldo_dom)
+		RETURN(0);
+
 	rc = dt_attr_get(env, next, attr, BYPASS_CAPA);
 	LASSERT(attr->la_valid & LA_SIZE);
 	if (rc)
@@ -875,6 +962,231 @@ out:
 	RETURN(rc);
 }
 
+/*
+ * Shard \a i of a new striped directory comes from the client: it has to be
+ * a normal FID of a remote MDT set up in LOD, and not be used by the master
+ * or another shard already.
+ */
+static int lod_check_dir_shard(const struct lu_env *env,
+			       struct lod_device *lod, struct lmv_user_md *lum,
+			       int i)
+{
+	struct lod_tgt_descs	*ltd = &lod->lod_mdt_descs;
+	const struct lu_fid	*fid = &lum->lum_objects[i].lum_fid;
+	__u32			 mdt;
+	int			 j;
+	int			 rc;
+
+	if (!fid_is_norm(fid) || fid_oid(fid) == 0 || fid_ver(fid) != 0)
+		return -EINVAL;
+
+	for (j = 0; j < i; j++)
+		if (lu_fid_eq(fid, &lum->lum_objects[j].lum_fid))
+			return -EINVAL;
+
+	rc = lod_fld_lookup(env, lod, fid, &mdt, LU_SEQ_RANGE_MDT);
+	if (rc != 0)
+		return -EINVAL;
+	if (mdt == lu_site2seq(lod2lu_dev(lod)->ld_site)->ss_node_id)
+		return -EINVAL;
+
+	lod_getref(ltd);
+	if (mdt >= ltd->ltd_tgt_bitmap->size ||
+	    !cfs_bitmap_check(ltd->ltd_tgt_bitmap, mdt) ||
+	    LTD_TGT(ltd, mdt) == NULL)
+		rc = -EINVAL;
+	lod_putref(lod, ltd);
+	return rc;
+}
+
+/*
+ * "lfs setdirstripe -c N": the client allocated the FIDs of all the shards
+ * of the new directory and sends them in struct lmv_user_md, the master
+ * (shard 0) is \a dt itself. The other shards are kept in ldo_stripe[].
+ */
+static int lod_prep_dir_stripes(const struct lu_env *env, struct dt_object *dt,
+				const struct dt_allocation_hint *hint)
+{
+	struct lod_device	*lod = lu2lod_dev(dt->do_lu.lo_dev);
+	struct lod_object	*lo = lod_dt_obj(dt);
+	struct lmv_user_md	*lum;
+	struct dt_object       **stripe;
+	int			 len = hint->dah_eadata_len;
+	int			 count;
+	int			 i;
+	int			 rc = 0;
+	ENTRY;
+
+	if (lo->ldo_stripe != NULL)
+		RETURN(0);
+
+	if (len < sizeof(*lum))
+		RETURN(-EINVAL);
+
+	OBD_ALLOC(lum, len);
+	if (lum == NULL)
+		RETURN(-ENOMEM);
+	memcpy(lum, hint->dah_eadata, len);
+
+	if (lum->lum_magic == __swab32(LMV_USER_MAGIC)) {
+		if (__swab32(lum->lum_stripe_count) >
+		    (len - sizeof(*lum)) / sizeof(lum->lum_objects[0]))
+			GOTO(out, rc = -EINVAL);
+		lustre_swab_lmv_user_md(lum);
+	}
+
+	if (lum->lum_magic != LMV_USER_MAGIC ||
+	    lum->lum_type != LMV_STRIPE_TYPE)
+		GOTO(out, rc = -EINVAL);
+
+	/* "lfs setdirstripe -i" only, no shards */
+	count = lum->lum_stripe_count;
+	if (count <= 1)
+		GOTO(out, rc = 0);
+
+	if (len < lmv_user_md_size(count, LMV_USER_MAGIC) ||
+	    (lum->lum_hash_type != MEA_MAGIC_LAST_CHAR &&
+	     lum->lum_hash_type != MEA_MAGIC_ALL_CHARS) ||
+	    !lu_fid_eq(&lum->lum_objects[0].lum_fid,
+		       lu_object_fid(&dt->do_lu))) {
+		CERROR("%s: bad stripes of "DFID", count %d, hash %#x\n",
+		       lod2obd(lod)->obd_name, PFID(lu_object_fid(&dt->do_lu)),
+		       count, lum->lum_hash_type);
+		GOTO(out, rc = -EINVAL);
+	}
+
+	for (i = 1; i < count; i++) {
+		rc = lod_check_dir_shard(env, lod, lum, i);
+		if (rc != 0) {
+			CERROR("%s: bad shard %d "DFID" of "DFID": rc = %d\n",
+			       lod2obd(lod)->obd_name, i,
+			       PFID(&lum->lum_objects[i].lum_fid),
+			       PFID(lu_object_fid(&dt->do_lu)), rc);
+			GOTO(out, rc);
+		}
+	}
+
+	OBD_ALLOC(stripe, sizeof(stripe[0]) * (count - 1));
+	if (stripe == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	for (i = 1; i < count; i++) {
+		stripe[i - 1] = lod_dir_shard_locate(env, lod,
+					&lum->lum_objects[i].lum_fid);
+		if (IS_ERR(stripe[i - 1])) {
+			rc = PTR_ERR(stripe[i - 1]);
+			stripe[i - 1] = NULL;
+			break;
+		}
+	}
+
+	if (rc != 0) {
+		for (i = 0; i < count - 1; i++)
+			if (stripe[i] != NULL)
+				lu_object_put(env, &stripe[i]->do_lu);
+		OBD_FREE(stripe, sizeof(stripe[0]) * (count - 1));
+		GOTO(out, rc);
+	}
+
+	lo->ldo_stripe = stripe;
+	lo->ldo_stripenr = count - 1;
+	lo->ldo_stripes_allocated = count - 1;
+	lo->ldo_dir_striped = 1;
+	lo->ldo_dir_hash_type = lum->lum_hash_type;
+	EXIT;
+out:
+	OBD_FREE(lum, len);
+	return rc;
+}
+
+/*
+ * declare creation of the shards of a striped directory with "." and ".."
+ * pointing to the shard and the master, and the LMV EA of the master
+ */
+static int lod_declare_dir_stripes(const struct lu_env *env,
+				   struct dt_object *dt, struct lu_attr *attr,
+				   struct dt_object_format *dof,
+				   struct thandle *th)
+{
+	struct lod_thread_info	*info = lod_env_info(env);
+	struct dt_allocation_hint *ah = &info->lti_ah;
+	struct lod_object	*lo = lod_dt_obj(dt);
+	const struct lu_fid	*pfid = lu_object_fid(&dt->do_lu);
+	int			 rc = 0;
+	int			 i;
+	ENTRY;
+
+	memset(ah, 0, sizeof(*ah));
+	ah->dah_parent = dt;
+	ah->dah_mode = attr->la_mode & S_IFMT;
+
+	for (i = 0; i < lo->ldo_stripenr && rc == 0; i++) {
+		struct dt_object *shard = lo->ldo_stripe[i];
+
+		rc = dt_declare_create(env, shard, attr, ah, dof, th);
+		if (rc == 0)
+			rc = dt_declare_ref_add(env, shard, th);
+		if (rc == 0 && !dt_try_as_dir(env, shard))
+			rc = -ENOTDIR;
+		if (rc == 0)
+			rc = dt_declare_insert(env, shard,
+				(const struct dt_rec *)lu_object_fid(&shard->do_lu),
+				(const struct dt_key *)dot, th);
+		if (rc == 0)
+			rc = dt_declare_insert(env, shard,
+					       (const struct dt_rec *)pfid,
+					       (const struct dt_key *)dotdot, th);
+	}
+
+	if (rc == 0)
+		rc = lod_generate_lmvea(env, lo, &info->lti_buf);
+	if (rc == 0)
+		rc = dt_declare_xattr_set(env, dt_object_child(dt),
+					  &info->lti_buf, XATTR_NAME_LMV, 0, th);
+	RETURN(rc);
+}
+
+static int lod_dir_stripes_create(const struct lu_env *env,
+				  struct dt_object *dt, struct lu_attr *attr,
+				  struct dt_object_format *dof,
+				  struct thandle *th)
+{
+	struct lod_thread_info	*info = lod_env_info(env);
+	struct dt_allocation_hint *ah = &info->lti_ah;
+	struct lod_object	*lo = lod_dt_obj(dt);
+	const struct lu_fid	*pfid = lu_object_fid(&dt->do_lu);
+	int			 rc = 0;
+	int			 i;
+	ENTRY;
+
+	memset(ah, 0, sizeof(*ah));
+	ah->dah_parent = dt;
+	ah->dah_mode = attr->la_mode & S_IFMT;
+
+	for (i = 0; i < lo->ldo_stripenr && rc == 0; i++) {
+		struct dt_object *shard = lo->ldo_stripe[i];
+
+		rc = dt_create(env, shard, attr, ah, dof, th);
+		if (rc == 0)
+			rc = dt_ref_add(env, shard, th);
+		if (rc == 0)
+			rc = dt_insert(env, shard,
+				(const struct dt_rec *)lu_object_fid(&shard->do_lu),
+				(const struct dt_key *)dot, th, BYPASS_CAPA, 1);
+		if (rc == 0)
+			rc = dt_insert(env, shard, (const struct dt_rec *)pfid,
+				       (const struct dt_key *)dotdot, th,
+				       BYPASS_CAPA, 1);
+	}
+
+	if (rc == 0)
+		rc = lod_generate_lmvea(env, lo, &info->lti_buf);
+	if (rc == 0)
+		rc = dt_xattr_set(env, dt_object_child(dt), &info->lti_buf,
+				  XATTR_NAME_LMV, 0, th, BYPASS_CAPA);
+	RETURN(rc);
+}
+
 static int lod_declare_object_create(const struct lu_env *env,
 				     struct dt_object *dt,
 				     struct lu_attr *attr,
@@ -901,6 +1213,16 @@ static int lod_declare_object_create(const struct lu_env *env,
 	if (dof->dof_type == DFT_SYM)
 		dt->do_body_ops = &lod_body_lnk_ops;
 
+	/* the shards of a directory striped over MDTs */
+	if (dof->dof_type == DFT_DIR && hint != NULL &&
+	    hint->dah_eadata != NULL) {
+		rc = lod_prep_dir_stripes(env, dt, hint);
+		if (rc == 0 && lo->ldo_dir_striped)
+			rc = lod_declare_dir_stripes(env, dt, attr, dof, th);
+		if (rc)
+			GOTO(out, rc);
+	}
+
 	/*
 	 * it's lod_ah_init() who has decided the object will striped
 	 */
@@ -909,9 +1231,11 @@ static int lod_declare_object_create(const struct lu_env *env,
 		/* XXX: all tricky interactions with ->ah_make_hint() decided
 		 * to use striping, then ->declare_create() behaving differently
 		 * should be cleaned */
-		if (dof->u.dof_reg.striped == 0)
+		if (dof->u.dof_reg.striped == 0) {
 			lo->ldo_stripenr = 0;
-		if (lo->ldo_stripenr > 0)
+			lo->ldo_dom = 0;
+		}
+		if (lo->ldo_stripenr > 0 || lo->ldo_dom)
 			rc = lod_declare_striped_object(env, dt, attr,
 							NULL, th);
 	} else if (dof->dof_type == DFT_DIR && lo->ldo_striping_cached) {
@@ -929,7 +1253,9 @@ static int lod_declare_object_create(const struct lu_env *env,
 			RETURN(-ENOMEM);
 
 		v3->lmm_magic = cpu_to_le32(LOV_MAGIC_V3);
-		v3->lmm_pattern = cpu_to_le32(LOV_PATTERN_RAID0);
+		v3->lmm_pattern = cpu_to_le32(lo->ldo_def_dom ?
+					      LOV_PATTERN_MDT :
+					      LOV_PATTERN_RAID0);
 		fid_to_lmm_oi(lu_object_fid(&dt->do_lu), &v3->lmm_oi);
 		lmm_oi_cpu_to_le(&v3->lmm_oi, &v3->lmm_oi);
 		v3->lmm_stripe_size = cpu_to_le32(lo->ldo_def_stripe_size);
@@ -960,8 +1286,8 @@ int lod_striping_create(const struct lu_env *env, struct dt_object *dt,
 	int		   rc = 0, i;
 	ENTRY;
 
-	LASSERT(lo->ldo_stripe);
-	LASSERT(lo->ldo_stripenr > 0);
+	LASSERT(lo->ldo_stripe || lo->ldo_dom);
+	LASSERT(lo->ldo_stripenr > 0 || lo->ldo_dom);
 	LASSERT(lo->ldo_striping_cached == 0);
 
 	/* create all underlying objects */
@@ -992,9 +1318,12 @@ static int lod_object_create(const struct lu_env *env, struct dt_object *dt,
 	rc = dt_create(env, next, attr, hint, dof, th);
 
 	if (rc == 0) {
-		if (S_ISDIR(dt->do_lu.lo_header->loh_attr))
+		if (S_ISDIR(dt->do_lu.lo_header->loh_attr)) {
 			rc = lod_store_def_striping(env, dt, th);
-		else if (lo->ldo_stripe)
+			if (rc == 0 && lo->ldo_dir_striped)
+				rc = lod_dir_stripes_create(env, dt, attr,
+							    dof, th);
+		} else if (lo->ldo_stripe || lo->ldo_dom)
 			rc = lod_striping_create(env, dt, attr, dof, th);
 	}
 
@@ -1029,6 +1358,15 @@ static int lod_declare_object_destroy(const struct lu_env *env,
 	/* declare destroy for all underlying objects */
 	for (i = 0; i < lo->ldo_stripenr; i++) {
 		LASSERT(lo->ldo_stripe[i]);
+		/* the shards of a directory lose "." and the master */
+		if (lo->ldo_dir_striped) {
+			rc = dt_declare_ref_del(env, lo->ldo_stripe[i], th);
+			if (rc == 0)
+				rc = dt_declare_ref_del(env, lo->ldo_stripe[i],
+							th);
+			if (rc)
+				break;
+		}
 		rc = dt_declare_destroy(env, lo->ldo_stripe[i], th);
 
 		if (rc)
@@ -1054,6 +1392,13 @@ static int lod_object_destroy(const struct lu_env *env,
 	/* destroy all underlying objects */
 	for (i = 0; i < lo->ldo_stripenr; i++) {
 		LASSERT(lo->ldo_stripe[i]);
+		if (lo->ldo_dir_striped) {
+			rc = dt_ref_del(env, lo->ldo_stripe[i], th);
+			if (rc == 0)
+				rc = dt_ref_del(env, lo->ldo_stripe[i], th);
+			if (rc)
+				break;
+		}
 		rc = dt_destroy(env, lo->ldo_stripe[i], th);
 		if (rc)
 			break;
@@ -1233,6 +1578,8 @@ void lod_object_free_striping(const struct lu_env *env, struct lod_object *lo)
 		lo->ldo_stripes_allocated = 0;
 	}
 	lo->ldo_stripenr = 0;
+	lo->ldo_dom = 0;
+	lo->ldo_dir_striped = 0;
 }
 
 /*
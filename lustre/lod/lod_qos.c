@@ -1289,11 +1289,33 @@ static int lod_qos_parse_config(const struct lu_env *env,
 		RETURN(-EINVAL);
 	}
 
-	if (v1->lmm_pattern != 0 && v1->lmm_pattern != LOV_PATTERN_RAID0) {
+	if (v1->lmm_pattern != 0 && v1->lmm_pattern != LOV_PATTERN_RAID0 &&
+	    v1->lmm_pattern != LOV_PATTERN_MDT) {
 		CERROR("invalid pattern: %x\n", v1->lmm_pattern);
 		RETURN(-EINVAL);
 	}
 
+	if (v1->lmm_pattern == LOV_PATTERN_MDT) {
+		/* the stripe size is the size limit of the MDT body */
+		if (v1->lmm_stripe_size == 0 ||
+		    v1->lmm_stripe_size > LOV_MAX_DOM_SIZE ||
+		    v1->lmm_stripe_size & (LOV_MIN_STRIPE_SIZE - 1)) {
+			CERROR("invalid DoM size: %u\n", v1->lmm_stripe_size);
+			RETURN(-EINVAL);
+		}
+		lo->ldo_dom = 1;
+		lo->ldo_stripenr = 0;
+		lo->ldo_stripe_size = v1->lmm_stripe_size;
+		lod_object_set_pool(lo, NULL);
+		RETURN(0);
+	}
+	if (lo->ldo_dom) {
+		/* inherited a DoM default, the rest comes from the fs one */
+		lo->ldo_dom = 0;
+		lo->ldo_stripenr = d->lod_desc.ld_default_stripe_count;
+		lo->ldo_stripe_size = d->lod_desc.ld_default_stripe_size;
+	}
+
 	if (v1->lmm_stripe_size)
 		lo->ldo_stripe_size = v1->lmm_stripe_size;
 	if (lo->ldo_stripe_size & (LOV_MIN_STRIPE_SIZE - 1))
@@ -1365,12 +1387,6 @@ int lod_qos_prep_create(const struct lu_env *env, struct lod_object *lo,
 
 	LASSERT(lo);
 
-	/* no OST available */
-	/* XXX: should we be waiting a bit to prevent failures during
-	 * cluster initialization? */
-	if (d->lod_ostnr == 0)
-		GOTO(out, rc = -EIO);
-
 	/*
 	 * by this time, the object's ldo_stripenr and ldo_stripe_size
 	 * contain default value for striping: taken from the parent
@@ -1383,6 +1399,16 @@ int lod_qos_prep_create(const struct lu_env *env, struct lod_object *lo,
 	if (rc)
 		GOTO(out, rc);
 
+	/* data is kept in the MDT inode, nothing to allocate */
+	if (lo->ldo_dom)
+		GOTO(out, rc = 0);
+
+	/* no OST available */
+	/* XXX: should we be waiting a bit to prevent failures during
+	 * cluster initialization? */
+	if (d->lod_ostnr == 0)
+		GOTO(out, rc = -EIO);
+
 	if (likely(lo->ldo_stripe == NULL)) {
 		/*
 		 * no striping has been created so far
@@ -475,6 +475,10 @@ struct lov_io_sub {
         int                  sub_refcheck2;
         int                  sub_reenter;
         void                *sub_cookie;
+        /** work item starting the sub-io on a lov_io_start() worker */
+        cfs_workitem_t       sub_wi;
+        /** result of the sub-io operation done by the worker */
+        int                  sub_rc;
 };
 
 /**
@@ -491,7 +495,8 @@ struct lov_io {
         /**
          * Original end-of-io position for this IO, set by the upper layer as
          * cl_io::u::ci_rw::pos + cl_io::u::ci_rw::count. lov remembers this,
-         * changes pos and count to fit IO into a single stripe and uses saved
+         * changes pos and count to fit IO into a single stripe (a whole stripe
+         * width when its sub-io's are started in parallel) and uses saved
          * value to determine when IO iterations have to stop.
          *
          * This is used only for CIT_READ and CIT_WRITE io's.
@@ -528,6 +533,15 @@ struct lov_io {
          * List of active sub-io's.
          */
         cfs_list_t         lis_active;
+        /**
+         * Operation fanned out to the lov_io_start() workers, and the
+         * number of sub-io's it is still running on.
+         */
+        int              (*lis_fanout_func)(const struct lu_env *,
+                                            struct cl_io *);
+        cfs_atomic_t       lis_fanout_nr;
+        /** completed by the worker finishing the last sub-io */
+        struct completion  lis_fanout_done;
 };
 
 struct lov_session {
@@ -61,6 +61,20 @@ struct lovea_unpack_args {
 static int lsm_lmm_verify_common(struct lov_mds_md *lmm, int lmm_bytes,
                                  __u16 stripe_count)
 {
+	/* Data-on-MDT layout has no OST objects */
+	if (lmm->lmm_pattern == cpu_to_le32(LOV_PATTERN_MDT) &&
+	    stripe_count == 0) {
+		if (lmm->lmm_stripe_size == 0 ||
+		    le32_to_cpu(lmm->lmm_stripe_size) > LOV_MAX_DOM_SIZE ||
+		    (le32_to_cpu(lmm->lmm_stripe_size) &
+		     (LOV_MIN_STRIPE_SIZE - 1)) != 0) {
+			CERROR("bad DoM size limit %u\n",
+			       le32_to_cpu(lmm->lmm_stripe_size));
+			lov_dump_lmm(D_WARNING, lmm);
+			return -EINVAL;
+		}
+		return 0;
+	}
 
         if (stripe_count == 0 || stripe_count > LOV_V1_INSANE_STRIPE_COUNT) {
                 CERROR("bad stripe count %d\n", stripe_count);
@@ -245,6 +259,9 @@ int lsm_unpackmd_v1(struct lov_obd *lov, struct lov_stripe_md *lsm,
         }
 
         lsm->lsm_maxbytes = stripe_maxbytes * lsm->lsm_stripe_count;
+	/* DoM file is moved to OST stripes when it outgrows the MDT */
+	if (lsm_is_dom(lsm))
+		lsm->lsm_maxbytes = LUSTRE_STRIPE_MAXBYTES;
 
         return 0;
 }
@@ -324,6 +341,9 @@ int lsm_unpackmd_v3(struct lov_obd *lov, struct lov_stripe_md *lsm,
         }
 
         lsm->lsm_maxbytes = stripe_maxbytes * lsm->lsm_stripe_count;
+	/* DoM file is moved to OST stripes when it outgrows the MDT */
+	if (lsm_is_dom(lsm))
+		lsm->lsm_maxbytes = LUSTRE_STRIPE_MAXBYTES;
 
         return 0;
 }
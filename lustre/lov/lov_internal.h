@@ -292,6 +292,10 @@ static inline void lprocfs_lov_init_vars(struct lprocfs_static_vars *lvars)
 /* lov_cl.c */
 extern struct lu_device_type lov_device_type;
 
+/* lov_io.c */
+int lov_io_sched_init(void);
+void lov_io_sched_fini(void);
+
 /* pools */
 extern cfs_hash_ops_t pool_hash_operations;
 /* ost_pool methods */
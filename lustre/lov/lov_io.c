@@ -424,6 +424,87 @@ static int lov_io_iter_init(const struct lu_env *env,
         RETURN(rc);
 }
 
+static int lov_io_threads;
+CFS_MODULE_PARM(lov_io_threads, "i", int, 0644,
+		"# of threads per CPT starting sub-io's of an io in parallel, "
+		"0 to run them on the calling thread");
+
+static struct cfs_wi_sched **lov_io_scheds;
+static DEFINE_MUTEX(lov_io_sched_mutex);
+
+static void lov_io_sched_free(struct cfs_wi_sched **scheds)
+{
+	int ncpts = cfs_cpt_number(cfs_cpt_table);
+	int i;
+
+	for (i = 0; i < ncpts; i++) {
+		if (scheds[i] != NULL)
+			cfs_wi_sched_destroy(scheds[i]);
+	}
+	OBD_FREE(scheds, ncpts * sizeof(scheds[0]));
+}
+
+int lov_io_sched_init(void)
+{
+	struct cfs_wi_sched **scheds;
+	int ncpts = cfs_cpt_number(cfs_cpt_table);
+	int rc = 0;
+	int i;
+
+	mutex_lock(&lov_io_sched_mutex);
+	if (lov_io_threads <= 0 || lov_io_scheds != NULL)
+		GOTO(out, rc);
+
+	OBD_ALLOC(scheds, ncpts * sizeof(scheds[0]));
+	if (scheds == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	for (i = 0; i < ncpts; i++) {
+		rc = cfs_wi_sched_create("lov_io", cfs_cpt_table, i,
+					 lov_io_threads, &scheds[i]);
+		if (rc != 0) {
+			CERROR("Can't create sub-io threads for CPT %d: %d\n",
+			       i, rc);
+			lov_io_sched_free(scheds);
+			GOTO(out, rc);
+		}
+	}
+	/* the array is read without the mutex by lov_io_sched_get() */
+	smp_mb();
+	lov_io_scheds = scheds;
+out:
+	mutex_unlock(&lov_io_sched_mutex);
+	return rc;
+}
+
+void lov_io_sched_fini(void)
+{
+	if (lov_io_scheds == NULL)
+		return;
+
+	lov_io_sched_free(lov_io_scheds);
+	lov_io_scheds = NULL;
+}
+
+/**
+ * Returns the sub-io workers if \a lio may fan out to them. The workers are
+ * started by the first io after lov_io_threads was set, and are kept until
+ * the module is unloaded; setting lov_io_threads to 0 just stops using them.
+ */
+static struct cfs_wi_sched **lov_io_sched_get(struct lov_io *lio)
+{
+	if (lov_io_threads <= 0 || lio->lis_mem_frozen)
+		return NULL;
+
+	if (unlikely(lov_io_scheds == NULL) && lov_io_sched_init() != 0) {
+		/* don't retry on every io */
+		lov_io_threads = 0;
+		return NULL;
+	}
+
+	return lov_io_scheds;
+}
+
 static int lov_io_rw_iter_init(const struct lu_env *env,
                                const struct cl_io_slice *ios)
 {
@@ -432,13 +513,17 @@ static int lov_io_rw_iter_init(const struct lu_env *env,
 	struct lov_stripe_md *lsm = lio->lis_object->lo_lsm;
         loff_t start = io->u.ci_rw.crw_pos;
         loff_t next;
-        unsigned long ssize = lsm->lsm_stripe_size;
+	__u64 ssize = lsm->lsm_stripe_size;
 
         LASSERT(io->ci_type == CIT_READ || io->ci_type == CIT_WRITE);
         ENTRY;
 
         /* fast path for common case. */
         if (lio->lis_nr_subios != 1 && !cl_io_is_append(io)) {
+		/* an iteration covers a whole stripe width if its sub-io's
+		 * are started in parallel, a single stripe otherwise */
+		if (lov_io_sched_get(lio) != NULL)
+			ssize *= lio->lis_stripe_count;
 
 		lov_do_div64(start, ssize);
 		next = (start + 1) * ssize;
@@ -455,12 +540,90 @@ static int lov_io_rw_iter_init(const struct lu_env *env,
 		       (__u64)lio->lis_io_endpos);
 	}
 	/*
-	 * XXX The following call should be optimized: we know, that
-	 * [lio->lis_pos, lio->lis_endpos) intersects with exactly one stripe.
+	 * XXX The following call should be optimized: unless the sub-io's are
+	 * started in parallel, we know, that [lio->lis_pos, lio->lis_endpos)
+	 * intersects with exactly one stripe.
 	 */
 	RETURN(lov_io_iter_init(env, ios));
 }
 
+static struct cfs_wi_sched *lov_io_sub_sched(struct lov_io_sub *sub)
+{
+	return lov_io_scheds[sub->sub_stripe % cfs_cpt_number(cfs_cpt_table)];
+}
+
+static void lov_io_sub_call(struct lov_io *lio, struct lov_io_sub *sub)
+{
+	lov_sub_enter(sub);
+	sub->sub_rc = lio->lis_fanout_func(sub->sub_env, sub->sub_io);
+	lov_sub_exit(sub);
+}
+
+static int lov_io_sub_run(cfs_workitem_t *wi)
+{
+	struct lov_io_sub *sub = container_of(wi, struct lov_io_sub, sub_wi);
+	struct lov_io	  *lio = wi->wi_data;
+	int		   refcheck;
+
+	/* make the sub-io environment current on this worker, so that
+	 * cl_env_get() done by the lower layers finds it */
+	cl_env_implant(sub->sub_env, &refcheck);
+	lov_io_sub_call(lio, sub);
+	cl_env_unplant(sub->sub_env, &refcheck);
+	cfs_wi_exit(lov_io_sub_sched(sub), wi);
+
+	if (cfs_atomic_dec_and_test(&lio->lis_fanout_nr))
+		complete(&lio->lis_fanout_done);
+	return 1;
+}
+
+/**
+ * Run \a iofunc against all active sub-io's at once: all but the first one
+ * are handed to the workers, the first one is done by the calling thread,
+ * which then waits for the others. Unlike the serial loop, a failing sub-io
+ * doesn't prevent the following ones from being called.
+ */
+static int lov_io_call_parallel(const struct lu_env *env, struct lov_io *lio,
+				int (*iofunc)(const struct lu_env *,
+					      struct cl_io *))
+{
+	struct cl_io	  *parent = lio->lis_cl.cis_io;
+	struct lov_io_sub *first = NULL;
+	struct lov_io_sub *sub;
+	int		   nr = 0;
+	int		   rc = 0;
+	ENTRY;
+
+	cfs_list_for_each_entry(sub, &lio->lis_active, sub_linkage)
+		nr++;
+
+	lio->lis_fanout_func = iofunc;
+	cfs_atomic_set(&lio->lis_fanout_nr, nr - 1);
+	init_completion(&lio->lis_fanout_done);
+
+	cfs_list_for_each_entry(sub, &lio->lis_active, sub_linkage) {
+		if (first == NULL) {
+			first = sub;
+			continue;
+		}
+		cfs_wi_init(&sub->sub_wi, lio, lov_io_sub_run);
+		cfs_wi_schedule(lov_io_sub_sched(sub), &sub->sub_wi);
+	}
+
+	lov_io_sub_call(lio, first);
+	wait_for_completion(&lio->lis_fanout_done);
+
+	cfs_list_for_each_entry(sub, &lio->lis_active, sub_linkage) {
+		rc = sub->sub_rc;
+		if (rc)
+			break;
+
+		if (parent->ci_result == 0)
+			parent->ci_result = sub->sub_io->ci_result;
+	}
+	RETURN(rc);
+}
+
 static int lov_io_call(const struct lu_env *env, struct lov_io *lio,
                        int (*iofunc)(const struct lu_env *, struct cl_io *))
 {
@@ -482,6 +645,19 @@ static int lov_io_call(const struct lu_env *env, struct lov_io *lio,
 	RETURN(rc);
 }
 
+/* start of the sub-io's is fanned out to the workers if there is more than
+ * one of them in this iteration; locks are still enqueued by lov_io_lock()
+ * one stripe after another, in the order that avoids deadlocks */
+static int lov_io_fanout(const struct lu_env *env, struct lov_io *lio,
+			 int (*iofunc)(const struct lu_env *, struct cl_io *))
+{
+	if (lov_io_sched_get(lio) != NULL &&
+	    lio->lis_active.next != lio->lis_active.prev)
+		return lov_io_call_parallel(env, lio, iofunc);
+
+	return lov_io_call(env, lio, iofunc);
+}
+
 static int lov_io_lock(const struct lu_env *env, const struct cl_io_slice *ios)
 {
         ENTRY;
@@ -491,7 +667,7 @@ static int lov_io_lock(const struct lu_env *env, const struct cl_io_slice *ios)
 static int lov_io_start(const struct lu_env *env, const struct cl_io_slice *ios)
 {
         ENTRY;
-        RETURN(lov_io_call(env, cl2lov_io(env, ios), cl_io_start));
+        RETURN(lov_io_fanout(env, cl2lov_io(env, ios), cl_io_start));
 }
 
 static int lov_io_end_wrapper(const struct lu_env *env, struct cl_io *io)
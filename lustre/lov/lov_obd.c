@@ -2903,12 +2903,20 @@ int __init lov_init(void)
                 lu_kmem_fini(lov_caches);
                 return -ENOMEM;
         }
+        rc = lov_io_sched_init();
+        if (rc) {
+                rc2 = cfs_mem_cache_destroy(lov_oinfo_slab);
+                LASSERT(rc2 == 0);
+                lu_kmem_fini(lov_caches);
+                return rc;
+        }
         lprocfs_lov_init_vars(&lvars);
 
         rc = class_register_type(&lov_obd_ops, NULL, lvars.module_vars,
                                  LUSTRE_LOV_NAME, &lov_device_type);
 
         if (rc) {
+                lov_io_sched_fini();
                 rc2 = cfs_mem_cache_destroy(lov_oinfo_slab);
                 LASSERT(rc2 == 0);
                 lu_kmem_fini(lov_caches);
@@ -2923,6 +2931,7 @@ static void /*__exit*/ lov_exit(void)
         int rc;
 
         class_unregister_type(LUSTRE_LOV_NAME);
+        lov_io_sched_fini();
         rc = cfs_mem_cache_destroy(lov_oinfo_slab);
         LASSERT(rc == 0);
 
@@ -100,7 +100,16 @@ static int lov_init_empty(const struct lu_env *env,
                           const struct cl_object_conf *conf,
                           union  lov_layout_state *state)
 {
-        return 0;
+	struct lov_stripe_md *lsm = NULL;
+
+	if (conf->u.coc_md != NULL)
+		lsm = conf->u.coc_md->lsm;
+	/* Data-on-MDT file has no objects either, but keeps its layout for
+	 * getstripe and layout generation checks */
+	LASSERT(lov->lo_lsm == NULL);
+	if (lsm_is_dom(lsm))
+		lov->lo_lsm = lsm_addref(lsm);
+	return 0;
 }
 
 static void lov_install_raid0(const struct lu_env *env,
@@ -350,6 +359,8 @@ static void lov_fini_empty(const struct lu_env *env, struct lov_object *lov,
                            union lov_layout_state *state)
 {
         LASSERT(lov->lo_type == LLT_EMPTY);
+	if (lov->lo_lsm != NULL)
+		lov_free_memmd(&lov->lo_lsm);
 }
 
 static void lov_fini_raid0(const struct lu_env *env, struct lov_object *lov,
@@ -612,7 +623,8 @@ static int lov_layout_change(const struct lu_env *unused,
 
 	LASSERT(0 <= lov->lo_type && lov->lo_type < ARRAY_SIZE(lov_dispatch));
 
-	if (conf->u.coc_md != NULL && conf->u.coc_md->lsm != NULL)
+	if (conf->u.coc_md != NULL && conf->u.coc_md->lsm != NULL &&
+	    !lsm_is_dom(conf->u.coc_md->lsm))
 		llt = LLT_RAID0; /* only raid0 is supported. */
 	LASSERT(0 <= llt && llt < ARRAY_SIZE(lov_dispatch));
 
@@ -677,7 +689,8 @@ int lov_object_init(const struct lu_env *env, struct lu_object *obj,
 	cl_object_page_init(lu2cl(obj), sizeof(struct lov_page));
 
         /* no locking is necessary, as object is being created */
-        lov->lo_type = cconf->u.coc_md->lsm != NULL ? LLT_RAID0 : LLT_EMPTY;
+	lov->lo_type = cconf->u.coc_md->lsm != NULL &&
+		       !lsm_is_dom(cconf->u.coc_md->lsm) ? LLT_RAID0 : LLT_EMPTY;
         ops = &lov_dispatch[lov->lo_type];
         result = ops->llo_init(env, dev, lov, cconf, set);
         if (result == 0)
@@ -61,6 +61,7 @@ void mdc_swap_layouts_pack(struct ptlrpc_request *req,
 			   struct md_op_data *op_data);
 void mdc_readdir_pack(struct ptlrpc_request *req, __u64 pgoff, __u32 size,
                       const struct lu_fid *fid, struct obd_capa *oc);
+void mdc_dom_pack(struct ptlrpc_request *req, struct md_op_data *op_data);
 void mdc_getattr_pack(struct ptlrpc_request *req, __u64 valid, int flags,
                       struct md_op_data *data, int ea_size);
 void mdc_setattr_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
@@ -164,6 +165,9 @@ int mdc_intent_getattr_async(struct obd_export *exp,
                              struct md_enqueue_info *minfo,
                              struct ldlm_enqueue_info *einfo);
 
+int mdc_batch_getattr_async(struct obd_export *exp, struct md_batch_info *mbi,
+			    struct ldlm_enqueue_info *einfo);
+
 ldlm_mode_t mdc_lock_match(struct obd_export *exp, __u64 flags,
                            const struct lu_fid *fid, ldlm_type_t type,
                            ldlm_policy_data_t *policy, ldlm_mode_t mode,
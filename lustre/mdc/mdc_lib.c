@@ -142,6 +142,22 @@ void mdc_readdir_pack(struct ptlrpc_request *req, __u64 pgoff,
         mdc_pack_capa(req, &RMF_CAPA1, oc);
 }
 
+void mdc_dom_pack(struct ptlrpc_request *req, struct md_op_data *op_data)
+{
+	struct mdt_body *b = req_capsule_client_get(&req->rq_pill,
+						    &RMF_MDT_BODY);
+	b->fid1 = op_data->op_fid1;
+	b->valid |= OBD_MD_FLID;
+	b->size = op_data->op_offset;		/* file offset */
+	b->nlink = op_data->op_count;		/* byte count */
+	b->flags = op_data->op_dom_flags;
+	b->fid2 = op_data->op_fid2;		/* migration target */
+	b->ioepoch = op_data->op_ioepoch;	/* migration cookie */
+	__mdc_pack_body(b, -1);
+
+	mdc_pack_capa(req, &RMF_CAPA1, op_data->op_capa1);
+}
+
 /* packing of MDS records */
 void mdc_create_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
                      const void *data, int datalen, __u32 mode,
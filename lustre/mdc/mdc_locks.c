@@ -59,6 +59,11 @@ struct mdc_getattr_args {
         struct ldlm_enqueue_info    *ga_einfo;
 };
 
+struct mdc_batch_args {
+	struct obd_export	*ba_exp;
+	struct md_batch_info	*ba_mbi;
+};
+
 int it_disposition(struct lookup_intent *it, int flag)
 {
         return it->d.lustre.it_disposition & flag;
@@ -1233,3 +1238,189 @@ int mdc_intent_getattr_async(struct obd_export *exp,
 
         RETURN(0);
 }
+
+static int mdc_batch_getattr_interpret(const struct lu_env *env,
+				       struct ptlrpc_request *req,
+				       void *args, int rc)
+{
+	struct mdc_batch_args	*ba = args;
+	struct obd_export	*exp = ba->ba_exp;
+	struct md_batch_info	*mbi = ba->ba_mbi;
+	struct mdt_batch_rep	*rep = NULL;
+	char			*ea = NULL;
+	int			 easize = 0;
+	int			 i;
+	ENTRY;
+
+	mdc_exit_request(&class_exp2obd(exp)->u.cli);
+
+	if (rc == 0) {
+		rep = req_capsule_server_sized_get(&req->rq_pill,
+						   &RMF_MDT_BATCH_REP,
+						   mbi->mbi_count *
+						   sizeof(*rep));
+		if (rep == NULL)
+			rc = -EPROTO;
+	}
+	if (rc == 0) {
+		easize = req_capsule_get_size(&req->rq_pill, &RMF_MDT_MD,
+					      RCL_SERVER);
+		if (easize > 0)
+			ea = req_capsule_server_get(&req->rq_pill,
+						    &RMF_MDT_MD);
+	}
+
+	for (i = 0; i < mbi->mbi_count; i++) {
+		struct md_batch_item	*item = &mbi->mbi_items[i];
+		struct mdt_batch_rep	*r;
+		struct ldlm_res_id	 res_id;
+		int			 len;
+
+		item->mbi_body = NULL;
+		item->mbi_ea = NULL;
+		if (rc != 0) {
+			item->mbi_rc = rc;
+			ldlm_cli_batch_fini(exp, &item->mbi_lockh, LCK_PR,
+					    NULL, NULL, 0, rc);
+			continue;
+		}
+
+		r = &rep[i];
+		item->mbi_rc = r->mbr_status;
+		len = cfs_size_round(r->mbr_body.eadatasize);
+		if (item->mbi_rc == 0 && len > easize)
+			item->mbi_rc = -EPROTO;
+		if (item->mbi_rc == 0 &&
+		    !(r->mbr_body.valid & OBD_MD_FLID))
+			item->mbi_rc = -EPROTO;
+		if (item->mbi_rc == 0)
+			fid_build_reg_res_name(&r->mbr_body.fid1, &res_id);
+
+		item->mbi_rc = ldlm_cli_batch_fini(exp, &item->mbi_lockh,
+						   LCK_PR, &res_id,
+						   &r->mbr_handle,
+						   r->mbr_bits,
+						   item->mbi_rc);
+		if (item->mbi_rc == 0) {
+			/* the caller matches the lock again to use it */
+			ldlm_lock_decref(&item->mbi_lockh, LCK_PR);
+			item->mbi_body = &r->mbr_body;
+			if (r->mbr_body.eadatasize > 0)
+				item->mbi_ea = ea;
+		}
+		if (len <= easize) {
+			ea += len;
+			easize -= len;
+		}
+	}
+
+	mbi->mbi_cb(req, mbi, rc);
+	RETURN(0);
+}
+
+/**
+ * Stat up to MDS_BATCH_GETATTR_MAX names of the directory mbi_data.op_fid1
+ * in one RPC. A PR ibits lock is created for each name before sending, the
+ * MDT grants LOOKUP|UPDATE (and LAYOUT) on the child it finds, or nothing if
+ * that would block. \a einfo is only used to create the locks.
+ * \a mbi->mbi_cb is called from ptlrpcd with per-name results in mbi_items[].
+ */
+int mdc_batch_getattr_async(struct obd_export *exp, struct md_batch_info *mbi,
+			    struct ldlm_enqueue_info *einfo)
+{
+	struct md_op_data	*op_data = &mbi->mbi_data;
+	struct obd_device	*obddev = class_exp2obd(exp);
+	ldlm_policy_data_t	 policy = {
+					.l_inodebits = { MDS_INODELOCK_LOOKUP |
+							 MDS_INODELOCK_UPDATE }
+				 };
+	struct ptlrpc_request	*req;
+	struct mdc_batch_args	*ba;
+	struct mdt_batch_ent	*ent;
+	struct ldlm_res_id	 res_id;
+	char			*names;
+	int			 namelen = 0;
+	int			 easize;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	LASSERT(mbi->mbi_count > 0 &&
+		mbi->mbi_count <= MDS_BATCH_GETATTR_MAX);
+	LASSERT(einfo->ei_type == LDLM_IBITS && einfo->ei_mode == LCK_PR);
+
+	if (!exp_connect_batch_getattr(exp))
+		RETURN(-EOPNOTSUPP);
+
+	for (i = 0; i < mbi->mbi_count; i++)
+		namelen += mbi->mbi_items[i].mbi_namelen + 1;
+	if (namelen > MDS_BATCH_NAMES_MAX)
+		RETURN(-E2BIG);
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp),
+				   &RQF_MDS_BATCH_GETATTR);
+	if (req == NULL)
+		RETURN(-ENOMEM);
+
+	mdc_set_capa_size(req, &RMF_CAPA1, op_data->op_capa1);
+	req_capsule_set_size(&req->rq_pill, &RMF_MDT_BATCH_ENT, RCL_CLIENT,
+			     mbi->mbi_count * sizeof(*ent));
+	req_capsule_set_size(&req->rq_pill, &RMF_MDT_BATCH_NAMES, RCL_CLIENT,
+			     namelen);
+
+	rc = ptlrpc_request_pack(req, LUSTRE_MDS_VERSION, MDS_BATCH_GETATTR);
+	if (rc) {
+		ptlrpc_request_free(req);
+		RETURN(rc);
+	}
+
+	easize = cfs_size_round(obddev->u.cli.cl_default_mds_easize);
+	mdc_getattr_pack(req, OBD_MD_FLGETATTR | OBD_MD_FLEASIZE, 0, op_data,
+			 easize);
+
+	req_capsule_set_size(&req->rq_pill, &RMF_MDT_BATCH_REP, RCL_SERVER,
+			     mbi->mbi_count * sizeof(struct mdt_batch_rep));
+	req_capsule_set_size(&req->rq_pill, &RMF_MDT_MD, RCL_SERVER,
+			     mbi->mbi_count * easize);
+	ptlrpc_request_set_replen(req);
+
+	ent = req_capsule_client_get(&req->rq_pill, &RMF_MDT_BATCH_ENT);
+	names = req_capsule_client_get(&req->rq_pill, &RMF_MDT_BATCH_NAMES);
+	fid_build_reg_res_name(&op_data->op_fid1, &res_id);
+	for (i = 0, namelen = 0; i < mbi->mbi_count; i++) {
+		struct md_batch_item *item = &mbi->mbi_items[i];
+
+		rc = ldlm_cli_batch_prep(exp, einfo, &res_id, &policy,
+					 &item->mbi_lockh);
+		if (rc)
+			break;
+
+		ent[i].mbe_handle = item->mbi_lockh;
+		ent[i].mbe_bits = policy.l_inodebits.bits;
+		ent[i].mbe_nameoff = namelen;
+		ent[i].mbe_namelen = item->mbi_namelen;
+		memcpy(names + namelen, item->mbi_name, item->mbi_namelen);
+		names[namelen + item->mbi_namelen] = '\0';
+		namelen += item->mbi_namelen + 1;
+	}
+
+	if (rc == 0)
+		rc = mdc_enter_request(&obddev->u.cli);
+	if (rc) {
+		while (--i >= 0)
+			ldlm_cli_batch_fini(exp, &mbi->mbi_items[i].mbi_lockh,
+					    LCK_PR, NULL, NULL, 0, rc);
+		ptlrpc_req_finished(req);
+		RETURN(rc);
+	}
+
+	CLASSERT(sizeof(*ba) <= sizeof(req->rq_async_args));
+	ba = ptlrpc_req_async_args(req);
+	ba->ba_exp = exp;
+	ba->ba_mbi = mbi;
+
+	req->rq_interpret_reply = mdc_batch_getattr_interpret;
+	ptlrpcd_add_req(req, PDL_POLICY_LOCAL, -1);
+
+	RETURN(0);
+}
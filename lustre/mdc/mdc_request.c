@@ -1113,6 +1113,98 @@ restart_bulk:
         RETURN(0);
 }
 
+/**
+ * Read or write a Data-on-MDT file body synchronously.
+ *
+ * op_data->op_count bytes at file offset op_data->op_offset are moved
+ * between the MDT inode and @pages, packed from the start of pages[0].
+ * The reply mdt_body carries the file size in ->size and the number of
+ * bytes transferred in ->nlink. A write with op_npages == 0 is a control
+ * request (punch or migration, see MDS_DOM_FL_*).
+ */
+int mdc_dom_rw(struct obd_export *exp, struct md_op_data *op_data, int cmd,
+	       struct page **pages, struct ptlrpc_request **request)
+{
+	struct ptlrpc_request	*req;
+	struct ptlrpc_bulk_desc	*desc;
+	const struct req_format	*fmt;
+	__u32			 left = op_data->op_count;
+	int			 opc;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	*request = NULL;
+	if (!exp_connect_dom(exp))
+		RETURN(-EOPNOTSUPP);
+
+	if (cmd == OBD_BRW_READ) {
+		fmt = &RQF_MDS_DOM_READ;
+		opc = MDS_DOM_READ;
+	} else {
+		fmt = &RQF_MDS_DOM_WRITE;
+		opc = MDS_DOM_WRITE;
+	}
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp), fmt);
+	if (req == NULL)
+		RETURN(-ENOMEM);
+
+	mdc_set_capa_size(req, &RMF_CAPA1, op_data->op_capa1);
+
+	rc = ptlrpc_request_pack(req, LUSTRE_MDS_VERSION, opc);
+	if (rc) {
+		ptlrpc_request_free(req);
+		RETURN(rc);
+	}
+
+	if (op_data->op_npages > 0) {
+		desc = ptlrpc_prep_bulk_imp(req, op_data->op_npages, 1,
+					    cmd == OBD_BRW_READ ?
+					    BULK_PUT_SINK : BULK_GET_SOURCE,
+					    MDS_BULK_PORTAL);
+		if (desc == NULL) {
+			ptlrpc_request_free(req);
+			RETURN(-ENOMEM);
+		}
+
+		/* NB req now owns desc and will free it when it gets freed */
+		for (i = 0; i < op_data->op_npages && left > 0; i++) {
+			int len = min_t(__u32, left, CFS_PAGE_SIZE);
+
+			ptlrpc_prep_bulk_page_pin(desc, pages[i], 0, len);
+			left -= len;
+		}
+	}
+
+	mdc_dom_pack(req, op_data);
+	ptlrpc_request_set_replen(req);
+
+	rc = ptlrpc_queue_wait(req);
+	if (rc)
+		GOTO(out, rc);
+
+	if (req->rq_bulk != NULL) {
+		if (cmd == OBD_BRW_READ)
+			rc = sptlrpc_cli_unwrap_bulk_read(req, req->rq_bulk,
+					req->rq_bulk->bd_nob_transferred);
+		else
+			rc = sptlrpc_cli_unwrap_bulk_write(req, req->rq_bulk);
+		if (rc < 0)
+			GOTO(out, rc);
+		rc = 0;
+	}
+
+	if (req_capsule_server_get(&req->rq_pill, &RMF_MDT_BODY) == NULL)
+		GOTO(out, rc = -EPROTO);
+
+	*request = req;
+	RETURN(0);
+out:
+	ptlrpc_req_finished(req);
+	return rc;
+}
+
 static int mdc_statfs(const struct lu_env *env,
                       struct obd_export *exp, struct obd_statfs *osfs,
                       __u64 max_age, __u32 flags)
@@ -2763,6 +2855,7 @@ struct md_ops mdc_md_ops = {
         .m_getxattr         = mdc_getxattr,
         .m_sync             = mdc_sync,
         .m_readpage         = mdc_readpage,
+	.m_dom_rw           = mdc_dom_rw,
         .m_unlink           = mdc_unlink,
         .m_cancel_unused    = mdc_cancel_unused,
         .m_init_ea_size     = mdc_init_ea_size,
@@ -2776,6 +2869,7 @@ struct md_ops mdc_md_ops = {
         .m_unpack_capa      = mdc_unpack_capa,
         .m_get_remote_perm  = mdc_get_remote_perm,
         .m_intent_getattr_async = mdc_intent_getattr_async,
+	.m_batch_getattr_async	= mdc_batch_getattr_async,
         .m_revalidate_lock      = mdc_revalidate_lock
 };
 
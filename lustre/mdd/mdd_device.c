@@ -201,33 +201,31 @@ static int changelog_user_init_cb(const struct lu_env *env,
 	return LLOG_PROC_BREAK;
 }
 
+struct mdd_changelog_gc_data {
+	__u64			 mcgd_endrec;
+	struct ptlrpc_thread	*mcgd_thread;
+};
+
+/* tell llog_cat_purge() which records can go */
 static int llog_changelog_cancel_cb(const struct lu_env *env,
 				    struct llog_handle *llh,
 				    struct llog_rec_hdr *hdr, void *data)
 {
-	struct llog_changelog_rec *rec = (struct llog_changelog_rec *)hdr;
-	struct llog_cookie	 cookie;
-	long long		 endrec = *(long long *)data;
-	int			 rc;
-
-	ENTRY;
+	struct llog_changelog_rec	*rec = (struct llog_changelog_rec *)hdr;
+	struct mdd_changelog_gc_data	*mcgd = data;
 
 	/* This is always a (sub)log, not the catalog */
 	LASSERT(llh->lgh_hdr->llh_flags & LLOG_F_IS_PLAIN);
 
-	if (rec->cr.cr_index > endrec)
-		/* records are in order, so we're done */
-		RETURN(LLOG_PROC_BREAK);
+	/* cr_index is taken before llog_add(), so the records
+	 * are not strictly ordered and each one has to be checked */
+	if (rec->cr.cr_index > mcgd->mcgd_endrec)
+		return LLOG_KEEP_RECORD;
 
-	cookie.lgc_lgl = llh->lgh_id;
-	cookie.lgc_index = hdr->lrh_index;
+	if (mcgd->mcgd_thread != NULL && thread_is_stopping(mcgd->mcgd_thread))
+		return LLOG_PROC_BREAK;
 
-	/* cancel them one at a time.  I suppose we could store up the cookies
-	 * and cancel them all at once; probably more efficient, but this is
-	 * done as a user call, so who cares... */
-	rc = llog_cat_cancel_records(env, llh->u.phd.phd_cat_handle, 1,
-				     &cookie);
-	RETURN(rc < 0 ? rc : 0);
+	return 0;
 }
 
 static int llog_changelog_cancel(const struct lu_env *env,
@@ -235,20 +233,20 @@ static int llog_changelog_cancel(const struct lu_env *env,
 				 struct lov_stripe_md *lsm, int count,
 				 struct llog_cookie *cookies, int flags)
 {
-	struct llog_handle	*cathandle = ctxt->loc_handle;
-	int			 rc;
+	struct llog_handle		*cathandle = ctxt->loc_handle;
+	struct mdd_changelog_gc_data	 mcgd;
+	int				 rc;
 
 	ENTRY;
 
 	/* This should only be called with the catalog handle */
 	LASSERT(cathandle->lgh_hdr->llh_flags & LLOG_F_IS_CAT);
 
-	rc = llog_cat_process(env, cathandle, llog_changelog_cancel_cb,
-			      (void *)cookies, 0, 0);
-	if (rc >= 0)
-		/* 0 or 1 means we're done */
-		rc = 0;
-	else
+	mcgd.mcgd_endrec = *(long long *)cookies;
+	mcgd.mcgd_thread = NULL;
+	rc = llog_cat_purge(env, cathandle, llog_changelog_cancel_cb, &mcgd,
+			    NULL, NULL);
+	if (rc < 0)
 		CERROR("%s: cancel idx %u of catalog "DOSTID" rc=%d\n",
 		       ctxt->loc_obd->obd_name, cathandle->lgh_last_idx,
 		       POSTID(&cathandle->lgh_id.lgl_oi), rc);
@@ -256,6 +254,156 @@ static int llog_changelog_cancel(const struct lu_env *env,
 	RETURN(rc);
 }
 
+static int mdd_changelog_gc_purge(const struct lu_env *env,
+				  struct mdd_device *mdd, __u64 endrec)
+{
+	struct obd_device		*obd = mdd2obd_dev(mdd);
+	struct mdd_changelog		*mc = &mdd->mdd_cl;
+	struct mdd_changelog_gc_data	 mcgd;
+	struct llog_ctxt		*ctxt;
+	__u64				 records = 0;
+	int				 logs = 0;
+	int				 rc;
+
+	ctxt = llog_get_context(obd, LLOG_CHANGELOG_ORIG_CTXT);
+	if (ctxt == NULL)
+		return -ENXIO;
+
+	mcgd.mcgd_endrec = endrec;
+	mcgd.mcgd_thread = &mc->mc_gc_thread;
+	rc = llog_cat_purge(env, ctxt->loc_handle, llog_changelog_cancel_cb,
+			    &mcgd, &records, &logs);
+	llog_ctxt_put(ctxt);
+
+	CDEBUG(D_IOCTL, "%s: changelog purged up to "LPU64", %d llogs and "
+	       LPU64" records cancelled: rc = %d\n", obd->obd_name, endrec,
+	       logs, records, rc);
+
+	spin_lock(&mc->mc_lock);
+	mc->mc_gc_records += records;
+	mc->mc_gc_logs += logs;
+	spin_unlock(&mc->mc_lock);
+
+	return rc;
+}
+
+static int mdd_changelog_gc_wakeup(struct mdd_changelog *mc)
+{
+	int rc;
+
+	spin_lock(&mc->mc_lock);
+	rc = !thread_is_running(&mc->mc_gc_thread) ||
+	     mc->mc_gc_endrec > mc->mc_gc_done;
+	spin_unlock(&mc->mc_lock);
+	return rc;
+}
+
+/* Cancel changelog records in the background once all users cleared them,
+ * so that changelog_clear doesn't wait for a large backlog to be freed */
+static int mdd_changelog_gc_main(void *args)
+{
+	struct mdd_device	*mdd = args;
+	struct mdd_changelog	*mc = &mdd->mdd_cl;
+	struct ptlrpc_thread	*thread = &mc->mc_gc_thread;
+	struct lu_env		 env;
+	__u64			 endrec;
+	int			 rc;
+
+	ENTRY;
+
+	cfs_daemonize("changelog_gc");
+	rc = lu_env_init(&env, LCT_MD_THREAD | LCT_DT_THREAD);
+	if (rc != 0) {
+		CERROR("%s: changelog GC, fail to init env, rc = %d\n",
+		       mdd2obd_dev(mdd)->obd_name, rc);
+		GOTO(out, rc);
+	}
+
+	spin_lock(&mc->mc_lock);
+	thread_set_flags(thread, SVC_RUNNING);
+	spin_unlock(&mc->mc_lock);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+
+	while (1) {
+		struct l_wait_info lwi = { 0 };
+
+		l_wait_event(thread->t_ctl_waitq,
+			     mdd_changelog_gc_wakeup(mc),
+			     &lwi);
+		if (!thread_is_running(thread))
+			break;
+
+		spin_lock(&mc->mc_lock);
+		endrec = mc->mc_gc_endrec;
+		spin_unlock(&mc->mc_lock);
+
+		rc = mdd_changelog_gc_purge(&env, mdd, endrec);
+		if (!thread_is_running(thread))
+			break;
+
+		/* on failure the records are left to the next clear */
+		spin_lock(&mc->mc_lock);
+		mc->mc_gc_rc = rc;
+		mc->mc_gc_done = endrec;
+		spin_unlock(&mc->mc_lock);
+		if (rc < 0)
+			CERROR("%s: changelog GC up to "LPU64" failed: "
+			       "rc = %d\n", mdd2obd_dev(mdd)->obd_name,
+			       endrec, rc);
+	}
+	lu_env_fini(&env);
+	rc = 0;
+
+out:
+	spin_lock(&mc->mc_lock);
+	thread_set_flags(thread, SVC_STOPPED);
+	spin_unlock(&mc->mc_lock);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+	RETURN(rc);
+}
+
+static int mdd_changelog_gc_start(struct mdd_device *mdd)
+{
+	struct ptlrpc_thread	*thread = &mdd->mdd_cl.mc_gc_thread;
+	struct l_wait_info	 lwi = { 0 };
+	int			 rc;
+
+	cfs_waitq_init(&thread->t_ctl_waitq);
+	thread_set_flags(thread, 0);
+	rc = cfs_create_thread(mdd_changelog_gc_main, mdd, 0);
+	if (rc < 0) {
+		CERROR("%s: cannot start changelog GC thread, rc = %d\n",
+		       mdd2obd_dev(mdd)->obd_name, rc);
+		return rc;
+	}
+
+	l_wait_event(thread->t_ctl_waitq,
+		     thread_is_running(thread) ||
+		     thread_is_stopped(thread),
+		     &lwi);
+	return 0;
+}
+
+static void mdd_changelog_gc_stop(struct mdd_device *mdd)
+{
+	struct mdd_changelog	*mc = &mdd->mdd_cl;
+	struct ptlrpc_thread	*thread = &mc->mc_gc_thread;
+	struct l_wait_info	 lwi = { 0 };
+
+	spin_lock(&mc->mc_lock);
+	if (!thread_is_running(thread)) {
+		spin_unlock(&mc->mc_lock);
+		return;
+	}
+	thread_set_flags(thread, SVC_STOPPING);
+	spin_unlock(&mc->mc_lock);
+
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+	l_wait_event(thread->t_ctl_waitq,
+		     thread_is_stopped(thread),
+		     &lwi);
+}
+
 static struct llog_operations changelog_orig_logops;
 
 int mdd_changelog_on(const struct lu_env *env, struct mdd_device *mdd, int on);
@@ -295,6 +443,11 @@ static int mdd_changelog_llog_init(const struct lu_env *env,
 	if (rc)
 		GOTO(out_close, rc);
 
+	/* records are appended by reserved slots without holding the plain
+	 * log exclusively, see llog_cat_add_rec() */
+	if (ctxt->loc_handle->lgh_obj != NULL)
+		ctxt->loc_handle->lgh_reserve = 1;
+
 	rc = llog_cat_reverse_process(env, ctxt->loc_handle,
 				      changelog_init_cb, mdd);
 
@@ -372,14 +525,23 @@ static int mdd_changelog_init(const struct lu_env *env, struct mdd_device *mdd)
 	spin_lock_init(&mdd->mdd_cl.mc_user_lock);
 	mdd->mdd_cl.mc_lastuser = 0;
 
+	mdd->mdd_cl.mc_gc_endrec = 0;
+	mdd->mdd_cl.mc_gc_done = 0;
+	mdd->mdd_cl.mc_gc_records = 0;
+	mdd->mdd_cl.mc_gc_logs = 0;
+	mdd->mdd_cl.mc_gc_rc = 0;
+
 	rc = mdd_changelog_llog_init(env, mdd);
 	if (rc) {
 		CERROR("%s: changelog setup during init failed: rc = %d\n",
 		       obd->obd_name, rc);
 		mdd->mdd_cl.mc_flags |= CLM_ERR;
+		return rc;
 	}
 
-	return rc;
+	/* changelog_clear falls back to synchronous purge without it */
+	mdd_changelog_gc_start(mdd);
+	return 0;
 }
 
 static void mdd_changelog_fini(const struct lu_env *env,
@@ -389,6 +551,7 @@ static void mdd_changelog_fini(const struct lu_env *env,
 	struct llog_ctxt	*ctxt;
 
 	mdd->mdd_cl.mc_flags = 0;
+	mdd_changelog_gc_stop(mdd);
 
 	ctxt = llog_get_context(obd, LLOG_CHANGELOG_ORIG_CTXT);
 	if (ctxt) {
@@ -477,6 +640,17 @@ int mdd_changelog_llog_cancel(const struct lu_env *env,
            changed since the last purge) */
         mdd->mdd_cl.mc_starttime = cfs_time_current_64();
 
+	/* leave the records to the GC thread */
+	spin_lock(&mdd->mdd_cl.mc_lock);
+	if (thread_is_running(&mdd->mdd_cl.mc_gc_thread)) {
+		if (endrec > mdd->mdd_cl.mc_gc_endrec)
+			mdd->mdd_cl.mc_gc_endrec = endrec;
+		spin_unlock(&mdd->mdd_cl.mc_lock);
+		cfs_waitq_signal(&mdd->mdd_cl.mc_gc_thread.t_ctl_waitq);
+		GOTO(out, rc = 0);
+	}
+	spin_unlock(&mdd->mdd_cl.mc_lock);
+
 	rc = llog_cancel(env, ctxt, NULL, 1, (struct llog_cookie *)&endrec, 0);
 out:
         llog_ctxt_put(ctxt);
@@ -206,8 +206,8 @@ int mdd_is_subdir(const struct lu_env *env, struct md_object *mo,
  *           -ve        other error
  *
  */
-static int mdd_dir_is_empty(const struct lu_env *env,
-                            struct mdd_object *dir)
+static int mdd_dir_shard_is_empty(const struct lu_env *env,
+				  struct mdd_object *dir)
 {
         struct dt_it     *it;
         struct dt_object *obj;
@@ -244,6 +244,68 @@ static int mdd_dir_is_empty(const struct lu_env *env,
         RETURN(result);
 }
 
+/*
+ * A directory striped over several MDTs is empty only if all its shards are,
+ * the shards are listed in the LMV EA of the master (shard 0). The MDT holds
+ * UPDATE locks on the remote shards until the directory is destroyed, see
+ * mdt_dir_shards_lock().
+ */
+static int mdd_dir_is_empty(const struct lu_env *env,
+                            struct mdd_object *dir)
+{
+	struct mdd_device	*mdd = mdo2mdd(&dir->mod_obj);
+	struct lu_attr		*la = &mdd_env_info(env)->mti_la;
+	struct lmv_stripe_md	*mea;
+	struct lu_buf		 buf = { NULL, 0 };
+	int			 size;
+	int			 rc;
+	int			 i;
+	ENTRY;
+
+	rc = mdd_dir_shard_is_empty(env, dir);
+	if (rc != 0 || mdd_object_remote(dir))
+		RETURN(rc);
+
+	size = mdo_xattr_get(env, dir, &buf, XATTR_NAME_LMV, BYPASS_CAPA);
+	if (size == -ENODATA || size == 0)
+		RETURN(0);
+	if (size < 0)
+		RETURN(size);
+
+	OBD_ALLOC_LARGE(mea, size);
+	if (mea == NULL)
+		RETURN(-ENOMEM);
+	buf.lb_buf = mea;
+	buf.lb_len = size;
+	rc = mdo_xattr_get(env, dir, &buf, XATTR_NAME_LMV, BYPASS_CAPA);
+	if (rc != size)
+		GOTO(out, rc = rc < 0 ? rc : -EIO);
+	rc = 0;
+
+	if (size < lmv_stripe_md_size(le32_to_cpu(mea->mea_count)))
+		GOTO(out, rc = -EIO);
+
+	for (i = 1; i < le32_to_cpu(mea->mea_count) && rc == 0; i++) {
+		struct lu_fid		*fid = &mdd_env_info(env)->mti_fid2;
+		struct mdd_object	*shard;
+
+		fid_le_to_cpu(fid, &mea->mea_ids[i]);
+		shard = mdd_object_find(env, mdd, fid);
+		if (IS_ERR(shard))
+			GOTO(out, rc = PTR_ERR(shard));
+
+		/* for a remote shard this fetches whether it is empty */
+		rc = mdd_la_get(env, shard, la, BYPASS_CAPA);
+		if (rc == 0)
+			rc = mdd_dir_shard_is_empty(env, shard);
+		mdd_object_put(env, shard);
+	}
+	EXIT;
+out:
+	OBD_FREE_LARGE(mea, size);
+	return rc;
+}
+
 static int __mdd_may_link(const struct lu_env *env, struct mdd_object *obj)
 {
         struct mdd_device *m = mdd_obj2mdd_dev(obj);
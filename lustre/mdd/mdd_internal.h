@@ -80,6 +80,13 @@ struct mdd_changelog {
 	__u64			mc_starttime;
 	spinlock_t		mc_user_lock;
 	int			mc_lastuser;
+	/* changelog garbage collection, protected by mc_lock */
+	struct ptlrpc_thread	mc_gc_thread;
+	__u64			mc_gc_endrec;	/* purge requested up to */
+	__u64			mc_gc_done;	/* purged up to */
+	__u64			mc_gc_records;	/* records cancelled */
+	__u64			mc_gc_logs;	/* plain llogs destroyed */
+	int			mc_gc_rc;	/* last purge result */
 };
 
 static inline __u64 cl_time(void) {
@@ -433,6 +440,8 @@ int mdd_txn_start_cb(const struct lu_env *env, struct thandle *,
 /* mdd_lfsck.c */
 int mdd_lfsck_set_speed(const struct lu_env *env, struct md_lfsck *lfsck,
 			__u32 limit);
+int mdd_lfsck_set_threads(struct md_lfsck *lfsck, __u32 threads);
+int mdd_lfsck_dump_threads(struct md_lfsck *lfsck, char *buf, int len);
 int mdd_lfsck_start(const struct lu_env *env, struct md_lfsck *lfsck,
 		    struct lfsck_start *start);
 int mdd_lfsck_stop(const struct lu_env *env, struct md_lfsck *lfsck,
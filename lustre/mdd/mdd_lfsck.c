@@ -245,6 +245,16 @@ static void mdd_lfsck_pos_fill(const struct lu_env *env, struct md_lfsck *lfsck,
 		return;
 	}
 
+	/* The threads process the items out of order, only the position
+	 * before the first unfinished chunk is safe. */
+	if (lfsck->ml_mt_running) {
+		pos->lp_oit_cookie = lfsck->ml_mt_cookie;
+		fid_zero(&pos->lp_dir_parent);
+		pos->lp_dir_cookie = 0;
+		spin_unlock(&lfsck->ml_lock);
+		return;
+	}
+
 	pos->lp_oit_cookie = iops->store(env, lfsck->ml_di_oit);
 
 	LASSERT(pos->lp_oit_cookie > 0);
@@ -375,6 +385,41 @@ static void mdd_lfsck_control_speed(struct md_lfsck *lfsck)
 	}
 }
 
+/* All the LFSCK threads share ml_sleep_rate items per ml_sleep_jif. */
+static void mdd_lfsck_mt_control_speed(struct md_lfsck *lfsck)
+{
+	struct ptlrpc_thread *thread = &lfsck->ml_thread;
+	struct l_wait_info    lwi;
+	cfs_time_t	      now;
+	cfs_duration_t	      timeout;
+
+	if (lfsck->ml_sleep_jif == 0)
+		return;
+
+	spin_lock(&lfsck->ml_lock);
+	if (unlikely(lfsck->ml_sleep_jif == 0)) {
+		spin_unlock(&lfsck->ml_lock);
+		return;
+	}
+
+	now = cfs_time_current();
+	if (cfs_time_aftereq(now, lfsck->ml_time_speed_window)) {
+		lfsck->ml_time_speed_window = now + lfsck->ml_sleep_jif;
+		lfsck->ml_new_scanned = 0;
+	}
+
+	if (++lfsck->ml_new_scanned <= lfsck->ml_sleep_rate) {
+		spin_unlock(&lfsck->ml_lock);
+		return;
+	}
+
+	timeout = lfsck->ml_time_speed_window - now;
+	spin_unlock(&lfsck->ml_lock);
+
+	lwi = LWI_TIMEOUT_INTR(timeout, NULL, LWI_ON_SIGNAL_NOOP, NULL);
+	l_wait_event(thread->t_ctl_waitq, !thread_is_running(thread), &lwi);
+}
+
 /* lfsck_bookmark file ops */
 
 static void inline mdd_lfsck_bookmark_to_cpu(struct lfsck_bookmark *des,
@@ -790,6 +835,9 @@ static int mdd_lfsck_namespace_update(const struct lu_env *env,
 
 	rc = dt_insert(env, obj, (const struct dt_rec *)&flags,
 		       (const struct dt_key *)key, handle, BYPASS_CAPA, 1);
+	/* Another LFSCK thread has inserted it just now. */
+	if (rc == -EEXIST && !force)
+		rc = 0;
 
 	GOTO(out, rc);
 
@@ -1028,16 +1076,20 @@ static void
 mdd_lfsck_namespace_fail(const struct lu_env *env, struct lfsck_component *com,
 			 bool oit, bool new_checked)
 {
-	struct lfsck_namespace *ns = (struct lfsck_namespace *)com->lc_file_ram;
+	struct lfsck_namespace *ns  = (struct lfsck_namespace *)com->lc_file_ram;
+	struct lfsck_position	pos;
 
-	down_write(&com->lc_sem);
+	mdd_lfsck_pos_fill(env, com->lc_lfsck, &pos, oit, !oit);
+
+	down_read(&com->lc_sem);
+	spin_lock(&com->lc_lock);
 	if (new_checked)
 		com->lc_new_checked++;
 	ns->ln_items_failed++;
 	if (mdd_lfsck_pos_is_zero(&ns->ln_pos_first_inconsistent))
-		mdd_lfsck_pos_fill(env, com->lc_lfsck,
-				   &ns->ln_pos_first_inconsistent, oit, !oit);
-	up_write(&com->lc_sem);
+		ns->ln_pos_first_inconsistent = pos;
+	spin_unlock(&com->lc_lock);
+	up_read(&com->lc_sem);
 }
 
 static int mdd_lfsck_namespace_checkpoint(const struct lu_env *env,
@@ -1153,11 +1205,13 @@ static int mdd_lfsck_namespace_exec_oit(const struct lu_env *env,
 					struct lfsck_component *com,
 					struct mdd_object *obj)
 {
-	down_write(&com->lc_sem);
+	down_read(&com->lc_sem);
+	spin_lock(&com->lc_lock);
 	com->lc_new_checked++;
 	if (S_ISDIR(mdd_object_type(obj)))
 		((struct lfsck_namespace *)com->lc_file_ram)->ln_dirs_checked++;
-	up_write(&com->lc_sem);
+	spin_unlock(&com->lc_lock);
+	up_read(&com->lc_sem);
 	return 0;
 }
 
@@ -1178,11 +1232,10 @@ static int mdd_declare_lfsck_namespace_exec_dir(const struct lu_env *env,
 }
 
 static int mdd_lfsck_namespace_check_exist(const struct lu_env *env,
-					   struct md_lfsck *lfsck,
+					   struct dt_object *dir,
 					   struct mdd_object *obj,
 					   const char *name)
 {
-	struct dt_object *dir = lfsck->ml_obj_dir;
 	struct lu_fid	 *fid = &mdd_env_info(env)->mti_fid;
 	int		  rc;
 	ENTRY;
@@ -1206,6 +1259,7 @@ static int mdd_lfsck_namespace_check_exist(const struct lu_env *env,
 
 static int mdd_lfsck_namespace_exec_dir(const struct lu_env *env,
 					struct lfsck_component *com,
+					struct dt_object *dir,
 					struct mdd_object *obj,
 					struct lu_dirent *ent)
 {
@@ -1217,11 +1271,11 @@ static int mdd_lfsck_namespace_exec_dir(const struct lu_env *env,
 				(struct lfsck_namespace *)com->lc_file_ram;
 	struct mdd_device	   *mdd      = mdd_lfsck2mdd(lfsck);
 	struct linkea_data	    ldata    = { 0 };
-	const struct lu_fid	   *pfid     =
-				lu_object_fid(&lfsck->ml_obj_dir->do_lu);
+	const struct lu_fid	   *pfid     = lu_object_fid(&dir->do_lu);
 	const struct lu_fid	   *cfid     = mdo2fid(obj);
 	const struct lu_name	   *cname;
 	struct thandle		   *handle   = NULL;
+	struct lfsck_position	    pos;
 	bool			    repaired = false;
 	bool			    locked   = false;
 	int			    count    = 0;
@@ -1229,7 +1283,10 @@ static int mdd_lfsck_namespace_exec_dir(const struct lu_env *env,
 	ENTRY;
 
 	cname = mdd_name_get_const(env, ent->lde_name, ent->lde_namelen);
-	down_write(&com->lc_sem);
+	/* Several LFSCK threads may check the name entries in parallel, the
+	 * statistics are updated under lc_lock. */
+	down_read(&com->lc_sem);
+	spin_lock(&com->lc_lock);
 	com->lc_new_checked++;
 
 	if (ent->lde_attrs & LUDA_UPGRADE) {
@@ -1239,6 +1296,7 @@ static int mdd_lfsck_namespace_exec_dir(const struct lu_env *env,
 		ns->ln_flags |= LF_INCONSISTENT;
 		repaired = true;
 	}
+	spin_unlock(&com->lc_lock);
 
 	if (ent->lde_name[0] == '.' &&
 	    (ent->lde_namelen == 1 ||
@@ -1251,6 +1309,8 @@ static int mdd_lfsck_namespace_exec_dir(const struct lu_env *env,
 again:
 		LASSERT(!locked);
 
+		/* lc_journal is only a hint shared by the LFSCK threads,
+		 * whether the transaction is started is told by the handle. */
 		com->lc_journal = 1;
 		handle = mdd_trans_create(env, mdd);
 		if (IS_ERR(handle))
@@ -1268,7 +1328,7 @@ again:
 		locked = true;
 	}
 
-	rc = mdd_lfsck_namespace_check_exist(env, lfsck, obj, ent->lde_name);
+	rc = mdd_lfsck_namespace_check_exist(env, dir, obj, ent->lde_name);
 	if (rc != 0)
 		GOTO(stop, rc);
 
@@ -1287,7 +1347,9 @@ again:
 		} else {
 
 unmatch:
+			spin_lock(&com->lc_lock);
 			ns->ln_flags |= LF_INCONSISTENT;
+			spin_unlock(&com->lc_lock);
 			if (bk->lb_param & LPF_DRYRUN) {
 				repaired = true;
 				goto record;
@@ -1295,7 +1357,7 @@ unmatch:
 
 			/*For dir, remove the unmatched linkea entry directly.*/
 			if (S_ISDIR(mdd_object_type(obj))) {
-				if (!com->lc_journal)
+				if (handle == NULL)
 					goto again;
 
 				rc = mdo_xattr_del(env, obj, XATTR_NAME_LINK,
@@ -1309,14 +1371,16 @@ unmatch:
 			}
 		}
 	} else if (unlikely(rc == -EINVAL)) {
+		spin_lock(&com->lc_lock);
 		ns->ln_flags |= LF_INCONSISTENT;
+		spin_unlock(&com->lc_lock);
 		if (bk->lb_param & LPF_DRYRUN) {
 			count = 1;
 			repaired = true;
 			goto record;
 		}
 
-		if (!com->lc_journal)
+		if (handle == NULL)
 			goto again;
 
 		/* The magic crashed, we are not sure whether there are more
@@ -1328,7 +1392,9 @@ unmatch:
 
 		goto nodata;
 	} else if (rc == -ENODATA) {
+		spin_lock(&com->lc_lock);
 		ns->ln_flags |= LF_UPGRADE;
+		spin_unlock(&com->lc_lock);
 		if (bk->lb_param & LPF_DRYRUN) {
 			count = 1;
 			repaired = true;
@@ -1341,7 +1407,7 @@ nodata:
 			GOTO(stop, rc);
 
 add:
-		if (!com->lc_journal)
+		if (handle == NULL)
 			goto again;
 
 		rc = linkea_add_buf(&ldata, cname, pfid);
@@ -1381,7 +1447,9 @@ record:
 		handle = NULL;
 	}
 
+	spin_lock(&com->lc_lock);
 	ns->ln_mlinked_checked++;
+	spin_unlock(&com->lc_lock);
 	rc = mdd_lfsck_namespace_update(env, com, cfid,
 			count != la->la_nlink ? LLF_UNMATCH_NLINKS : 0, false);
 
@@ -1396,21 +1464,24 @@ stop:
 
 out:
 	if (rc < 0) {
+		mdd_lfsck_pos_fill(env, lfsck, &pos, true, false);
+		spin_lock(&com->lc_lock);
 		ns->ln_items_failed++;
 		if (mdd_lfsck_pos_is_zero(&ns->ln_pos_first_inconsistent))
-			mdd_lfsck_pos_fill(env, lfsck,
-					   &ns->ln_pos_first_inconsistent,
-					   true, false);
+			ns->ln_pos_first_inconsistent = pos;
+		spin_unlock(&com->lc_lock);
 		if (!(bk->lb_param & LPF_FAILOUT))
 			rc = 0;
 	} else {
+		spin_lock(&com->lc_lock);
 		if (repaired)
 			ns->ln_items_repaired++;
 		else
 			com->lc_journal = 0;
+		spin_unlock(&com->lc_lock);
 		rc = 0;
 	}
-	up_write(&com->lc_sem);
+	up_read(&com->lc_sem);
 	return rc;
 }
 
@@ -1898,6 +1969,7 @@ static int mdd_lfsck_namespace_setup(const struct lu_env *env,
 	CFS_INIT_LIST_HEAD(&com->lc_link);
 	CFS_INIT_LIST_HEAD(&com->lc_link_dir);
 	init_rwsem(&com->lc_sem);
+	spin_lock_init(&com->lc_lock);
 	atomic_set(&com->lc_ref, 1);
 	com->lc_lfsck = lfsck;
 	com->lc_type = LT_NAMESPACE;
@@ -2275,13 +2347,14 @@ out:
 }
 
 static int mdd_lfsck_exec_dir(const struct lu_env *env, struct md_lfsck *lfsck,
-			      struct mdd_object *obj, struct lu_dirent *ent)
+			      struct dt_object *dir, struct mdd_object *obj,
+			      struct lu_dirent *ent)
 {
 	struct lfsck_component *com;
 	int			rc;
 
 	cfs_list_for_each_entry(com, &lfsck->ml_list_scan, lc_link) {
-		rc = com->lc_ops->lfsck_exec_dir(env, com, obj, ent);
+		rc = com->lc_ops->lfsck_exec_dir(env, com, dir, obj, ent);
 		if (rc != 0)
 			return rc;
 	}
@@ -2387,7 +2460,8 @@ static int mdd_lfsck_dir_engine(const struct lu_env *env,
 
 		/* XXX: need more processing for remote object in the future. */
 		if (mdd_object_exists(child) && !mdd_object_remote(child))
-			rc = mdd_lfsck_exec_dir(env, lfsck, child, ent);
+			rc = mdd_lfsck_exec_dir(env, lfsck, lfsck->ml_obj_dir,
+						child, ent);
 		mdd_object_put(env, child);
 		if (rc != 0 && bk->lb_param & LPF_FAILOUT)
 			RETURN(rc);
@@ -2514,6 +2588,481 @@ checkpoint:
 	RETURN(rc);
 }
 
+/* Multi-threaded LFSCK engine
+ *
+ * The LFSCK main thread keeps the otable-based iteration (with its
+ * pre-loading) and cuts the inode table into chunks of consecutive items.
+ * The chunks are handed out to ml_threads helper threads, each of them
+ * checks its objects and traverses the directories found there on its own.
+ * The checkpoint only goes forward when all the chunks before it are done. */
+
+static inline bool mdd_lfsck_mt_abort(struct md_lfsck *lfsck)
+{
+	return !thread_is_running(&lfsck->ml_thread) || lfsck->ml_mt_rc != 0;
+}
+
+static void mdd_lfsck_mt_failout(struct md_lfsck *lfsck, int rc)
+{
+	spin_lock(&lfsck->ml_lock);
+	if (lfsck->ml_mt_rc == 0)
+		lfsck->ml_mt_rc = rc;
+	spin_unlock(&lfsck->ml_lock);
+	cfs_waitq_broadcast(&lfsck->ml_thread.t_ctl_waitq);
+}
+
+static int mdd_lfsck_mt_dir(const struct lu_env *env, struct lfsck_thread *lt,
+			    struct mdd_object *obj)
+{
+	struct md_lfsck		*lfsck	= lt->lt_lfsck;
+	struct mdd_device	*mdd	= mdd_lfsck2mdd(lfsck);
+	struct lu_dirent	*ent	= &mdd_env_info(env)->mti_ent;
+	struct lfsck_bookmark	*bk	= &lfsck->ml_bookmark_ram;
+	struct dt_object	*dir;
+	const struct dt_it_ops	*iops;
+	struct dt_it		*di;
+	struct lu_fid		 fid;
+	int			 rc;
+	ENTRY;
+
+	rc = object_is_client_visible(env, mdd, obj);
+	if (rc <= 0)
+		GOTO(fail, rc);
+
+	if (unlikely(mdd_is_dead_obj(obj)))
+		RETURN(0);
+
+	dir = mdd_object_child(obj);
+	if (unlikely(!dt_try_as_dir(env, dir)))
+		GOTO(fail, rc = -ENOTDIR);
+
+	iops = &dir->do_index_ops->dio_it;
+	di = iops->init(env, dir, lfsck->ml_args_dir, BYPASS_CAPA);
+	if (IS_ERR(di))
+		GOTO(fail, rc = PTR_ERR(di));
+
+	rc = iops->load(env, di, 0);
+	if (rc == 0)
+		rc = iops->next(env, di);
+	else if (rc > 0)
+		rc = 0;
+
+	if (rc < 0) {
+		iops->put(env, di);
+		iops->fini(env, di);
+		GOTO(fail, rc);
+	}
+
+	lt->lt_dirs++;
+	while (rc == 0) {
+		struct mdd_object *child;
+
+		mdd_lfsck_mt_control_speed(lfsck);
+		if (mdd_lfsck_mt_abort(lfsck))
+			break;
+
+		lt->lt_entries++;
+		rc = iops->rec(env, di, (struct dt_rec *)ent,
+			       lfsck->ml_args_dir);
+		if (rc != 0) {
+			lt->lt_failed++;
+			mdd_lfsck_fail(env, lfsck, false, true);
+			if (bk->lb_param & LPF_FAILOUT)
+				break;
+			else
+				goto next;
+		}
+
+		mdd_lfsck_unpack_ent(ent);
+		if (ent->lde_attrs & LUDA_IGNORE)
+			goto next;
+
+		fid = ent->lde_fid;
+		child = mdd_object_find(env, mdd, &fid);
+		if (child == NULL) {
+			goto next;
+		} else if (IS_ERR(child)) {
+			rc = PTR_ERR(child);
+			lt->lt_failed++;
+			mdd_lfsck_fail(env, lfsck, false, true);
+			if (bk->lb_param & LPF_FAILOUT)
+				break;
+			else
+				goto next;
+		}
+
+		/* XXX: need more processing for remote object in the future. */
+		if (mdd_object_exists(child) && !mdd_object_remote(child))
+			rc = mdd_lfsck_exec_dir(env, lfsck, dir, child, ent);
+		mdd_object_put(env, child);
+		if (rc != 0 && bk->lb_param & LPF_FAILOUT)
+			break;
+
+next:
+		rc = iops->next(env, di);
+	}
+
+	iops->put(env, di);
+	iops->fini(env, di);
+	RETURN(rc > 0 ? 0 : rc);
+
+fail:
+	if (rc < 0) {
+		lt->lt_failed++;
+		mdd_lfsck_fail(env, lfsck, false, false);
+	}
+	RETURN(rc);
+}
+
+static int mdd_lfsck_mt_exec(const struct lu_env *env, struct lfsck_thread *lt,
+			     const struct lu_fid *fid)
+{
+	struct md_lfsck		*lfsck	= lt->lt_lfsck;
+	struct lfsck_component	*com;
+	struct mdd_object	*obj;
+	int			 rc	= 0;
+
+	lt->lt_objects++;
+	obj = mdd_object_find(env, mdd_lfsck2mdd(lfsck), fid);
+	if (obj == NULL)
+		return 0;
+
+	if (IS_ERR(obj)) {
+		lt->lt_failed++;
+		mdd_lfsck_fail(env, lfsck, true, true);
+		return PTR_ERR(obj);
+	}
+
+	if (!mdd_object_exists(obj) || mdd_object_remote(obj))
+		GOTO(out, rc = 0);
+
+	cfs_list_for_each_entry(com, &lfsck->ml_list_scan, lc_link) {
+		rc = com->lc_ops->lfsck_exec_oit(env, com, obj);
+		if (rc != 0)
+			GOTO(out, rc);
+	}
+
+	if (S_ISDIR(mdd_object_type(obj)) &&
+	    !cfs_list_empty(&lfsck->ml_list_dir))
+		rc = mdd_lfsck_mt_dir(env, lt, obj);
+
+	GOTO(out, rc);
+
+out:
+	mdd_object_put(env, obj);
+	return rc;
+}
+
+static bool mdd_lfsck_mt_wakeup(struct md_lfsck *lfsck)
+{
+	return !cfs_list_empty(&lfsck->ml_mt_queue) || lfsck->ml_mt_over ||
+	       mdd_lfsck_mt_abort(lfsck);
+}
+
+static int mdd_lfsck_mt_main(void *args)
+{
+	struct lfsck_thread	*lt	= (struct lfsck_thread *)args;
+	struct md_lfsck		*lfsck	= lt->lt_lfsck;
+	struct ptlrpc_thread	*thread = &lfsck->ml_thread;
+	struct lfsck_bookmark	*bk	= &lfsck->ml_bookmark_ram;
+	struct lfsck_chunk	*chunk;
+	struct lu_env		 env;
+	char			 name[16];
+	int			 rc;
+	ENTRY;
+
+	snprintf(name, sizeof(name), "lfsck_%02d", lt->lt_index);
+	cfs_daemonize(name);
+	rc = lu_env_init(&env, LCT_MD_THREAD);
+	if (rc != 0) {
+		CERROR("%s: LFSCK, fail to init env for thread %d, rc = %d\n",
+		       mdd_lfsck2name(lfsck), lt->lt_index, rc);
+		GOTO(out, rc);
+	}
+
+	spin_lock(&lfsck->ml_lock);
+	thread_set_flags(&lt->lt_thread, SVC_RUNNING);
+	spin_unlock(&lfsck->ml_lock);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+
+	while (1) {
+		struct l_wait_info lwi = { 0 };
+		int		   i;
+
+		l_wait_event(thread->t_ctl_waitq,
+			     mdd_lfsck_mt_wakeup(lfsck),
+			     &lwi);
+
+		if (mdd_lfsck_mt_abort(lfsck))
+			break;
+
+		spin_lock(&lfsck->ml_lock);
+		if (cfs_list_empty(&lfsck->ml_mt_queue)) {
+			spin_unlock(&lfsck->ml_lock);
+			if (lfsck->ml_mt_over)
+				break;
+			continue;
+		}
+
+		chunk = cfs_list_entry(lfsck->ml_mt_queue.next,
+				       struct lfsck_chunk, lck_link);
+		cfs_list_del_init(&chunk->lck_link);
+		spin_unlock(&lfsck->ml_lock);
+
+		for (i = 0; i < chunk->lck_count; i++) {
+			rc = mdd_lfsck_mt_exec(&env, lt, &chunk->lck_fids[i]);
+			if (rc < 0 && bk->lb_param & LPF_FAILOUT) {
+				mdd_lfsck_mt_failout(lfsck, rc);
+				break;
+			}
+
+			if (mdd_lfsck_mt_abort(lfsck))
+				break;
+		}
+
+		/* Left the interrupted chunk undone, then the checkpoint will
+		 * not go beyond it. */
+		if (i == chunk->lck_count) {
+			lt->lt_chunks++;
+			spin_lock(&lfsck->ml_lock);
+			chunk->lck_done = 1;
+			spin_unlock(&lfsck->ml_lock);
+			cfs_waitq_broadcast(&thread->t_ctl_waitq);
+		}
+	}
+
+	lu_env_fini(&env);
+	rc = 0;
+
+out:
+	spin_lock(&lfsck->ml_lock);
+	thread_set_flags(&lt->lt_thread, SVC_STOPPED);
+	/* Nobody is left to process the chunks, the main thread would wait
+	 * for them forever. */
+	if (--lfsck->ml_mt_live == 0 && !lfsck->ml_mt_over &&
+	    lfsck->ml_mt_rc == 0 && thread_is_running(thread))
+		lfsck->ml_mt_rc = rc != 0 ? rc : -ESRCH;
+	spin_unlock(&lfsck->ml_lock);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+	RETURN(rc);
+}
+
+/* Release the finished chunks by dispatch order, and move the checkpoint
+ * position to the last one of them. Return true if there is free chunk. */
+static bool mdd_lfsck_mt_reap(struct md_lfsck *lfsck)
+{
+	struct lfsck_chunk *chunk;
+	bool		    free;
+
+	spin_lock(&lfsck->ml_lock);
+	while (!cfs_list_empty(&lfsck->ml_mt_order)) {
+		chunk = cfs_list_entry(lfsck->ml_mt_order.next,
+				       struct lfsck_chunk, lck_order);
+		if (!chunk->lck_done)
+			break;
+
+		lfsck->ml_mt_cookie = chunk->lck_cookie;
+		cfs_list_move_tail(&chunk->lck_order, &lfsck->ml_mt_free);
+	}
+	free = !cfs_list_empty(&lfsck->ml_mt_free);
+	spin_unlock(&lfsck->ml_lock);
+	return free;
+}
+
+static bool mdd_lfsck_mt_stopped(struct md_lfsck *lfsck)
+{
+	int i;
+
+	for (i = 0; i < lfsck->ml_mt_count; i++) {
+		if (!thread_is_init(&lfsck->ml_mt_threads[i].lt_thread) &&
+		    !thread_is_stopped(&lfsck->ml_mt_threads[i].lt_thread))
+			return false;
+	}
+	return true;
+}
+
+static void mdd_lfsck_mt_fini(struct md_lfsck *lfsck)
+{
+	struct ptlrpc_thread *thread = &lfsck->ml_thread;
+	struct lfsck_chunk   *chunk;
+	struct l_wait_info    lwi    = { 0 };
+
+	spin_lock(&lfsck->ml_lock);
+	lfsck->ml_mt_over = 1;
+	spin_unlock(&lfsck->ml_lock);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+	l_wait_event(thread->t_ctl_waitq,
+		     mdd_lfsck_mt_stopped(lfsck),
+		     &lwi);
+
+	mdd_lfsck_mt_reap(lfsck);
+
+	spin_lock(&lfsck->ml_lock);
+	cfs_list_splice_init(&lfsck->ml_mt_order, &lfsck->ml_mt_free);
+	CFS_INIT_LIST_HEAD(&lfsck->ml_mt_queue);
+	spin_unlock(&lfsck->ml_lock);
+
+	while (!cfs_list_empty(&lfsck->ml_mt_free)) {
+		chunk = cfs_list_entry(lfsck->ml_mt_free.next,
+				       struct lfsck_chunk, lck_order);
+		cfs_list_del(&chunk->lck_order);
+		OBD_FREE_LARGE(chunk, sizeof(*chunk));
+	}
+}
+
+static int mdd_lfsck_mt_init(const struct lu_env *env, struct md_lfsck *lfsck)
+{
+	const struct dt_it_ops	*iops	=
+				&lfsck->ml_obj_oit->do_index_ops->dio_it;
+	struct ptlrpc_thread	*thread = &lfsck->ml_thread;
+	struct lfsck_chunk	*chunk;
+	struct l_wait_info	 lwi	= { 0 };
+	int			 rc	= 0;
+	int			 i;
+
+	LASSERT(cfs_list_empty(&lfsck->ml_mt_free));
+
+	/* Two chunks for each thread, one in processing, one in queue. */
+	for (i = 0; i < lfsck->ml_mt_count * 2; i++) {
+		OBD_ALLOC_LARGE(chunk, sizeof(*chunk));
+		if (chunk == NULL)
+			return -ENOMEM;
+
+		CFS_INIT_LIST_HEAD(&chunk->lck_link);
+		cfs_list_add_tail(&chunk->lck_order, &lfsck->ml_mt_free);
+	}
+
+	/* The current item has not been processed yet. */
+	lfsck->ml_mt_cookie = iops->store(env, lfsck->ml_di_oit);
+	if (lfsck->ml_mt_cookie > 0)
+		lfsck->ml_mt_cookie--;
+	lfsck->ml_mt_rc = 0;
+	lfsck->ml_mt_over = 0;
+	lfsck->ml_time_speed_window = cfs_time_current();
+	spin_lock(&lfsck->ml_lock);
+	lfsck->ml_mt_running = 1;
+	lfsck->ml_mt_live = 0;
+	spin_unlock(&lfsck->ml_lock);
+
+	for (i = 0; i < lfsck->ml_mt_count; i++) {
+		struct lfsck_thread *lt = &lfsck->ml_mt_threads[i];
+
+		memset(lt, 0, sizeof(*lt));
+		lt->lt_lfsck = lfsck;
+		lt->lt_index = i;
+		cfs_waitq_init(&lt->lt_thread.t_ctl_waitq);
+		spin_lock(&lfsck->ml_lock);
+		lfsck->ml_mt_live++;
+		spin_unlock(&lfsck->ml_lock);
+		rc = cfs_create_thread(mdd_lfsck_mt_main, lt, 0);
+		if (rc < 0) {
+			spin_lock(&lfsck->ml_lock);
+			lfsck->ml_mt_live--;
+			spin_unlock(&lfsck->ml_lock);
+			CERROR("%s: cannot start LFSCK thread %d, rc = %d\n",
+			       mdd_lfsck2name(lfsck), i, rc);
+			break;
+		}
+
+		l_wait_event(thread->t_ctl_waitq,
+			     thread_is_running(&lt->lt_thread) ||
+			     thread_is_stopped(&lt->lt_thread),
+			     &lwi);
+		rc = 0;
+	}
+
+	return rc;
+}
+
+static int mdd_lfsck_mt_engine(const struct lu_env *env,
+			       struct md_lfsck *lfsck)
+{
+	const struct dt_it_ops	*iops	=
+				&lfsck->ml_obj_oit->do_index_ops->dio_it;
+	struct dt_it		*di	= lfsck->ml_di_oit;
+	struct lfsck_bookmark	*bk	= &lfsck->ml_bookmark_ram;
+	struct ptlrpc_thread	*thread = &lfsck->ml_thread;
+	int			 rc;
+	ENTRY;
+
+	/* Finish the directory traversal left by the last (single-threaded)
+	 * run, it is just one directory. */
+	if (lfsck->ml_di_dir != NULL) {
+		rc = mdd_lfsck_dir_engine(env, lfsck);
+		if (rc <= 0)
+			RETURN(rc);
+	}
+
+	if (unlikely(lfsck->ml_oit_over))
+		RETURN(1);
+
+	rc = mdd_lfsck_mt_init(env, lfsck);
+	if (rc != 0)
+		GOTO(out, rc);
+
+	do {
+		struct l_wait_info  lwi = { 0 };
+		struct lfsck_chunk *chunk;
+
+		l_wait_event(thread->t_ctl_waitq,
+			     mdd_lfsck_mt_reap(lfsck) ||
+			     mdd_lfsck_mt_abort(lfsck),
+			     &lwi);
+
+		if (mdd_lfsck_mt_abort(lfsck))
+			GOTO(out, rc = lfsck->ml_mt_rc);
+
+		if (OBD_FAIL_CHECK(OBD_FAIL_LFSCK_CRASH))
+			GOTO(out, rc = 0);
+
+		rc = mdd_lfsck_checkpoint(env, lfsck, true);
+		if (rc != 0 && bk->lb_param & LPF_FAILOUT)
+			GOTO(out, rc);
+
+		spin_lock(&lfsck->ml_lock);
+		chunk = cfs_list_entry(lfsck->ml_mt_free.next,
+				       struct lfsck_chunk, lck_order);
+		cfs_list_del_init(&chunk->lck_order);
+		spin_unlock(&lfsck->ml_lock);
+
+		chunk->lck_count = 0;
+		chunk->lck_done = 0;
+		do {
+			rc = iops->rec(env, di, (struct dt_rec *)
+				       &chunk->lck_fids[chunk->lck_count], 0);
+			if (rc == 0) {
+				chunk->lck_count++;
+			} else {
+				mdd_lfsck_fail(env, lfsck, true, true);
+				if (bk->lb_param & LPF_FAILOUT)
+					mdd_lfsck_mt_failout(lfsck, rc);
+			}
+
+			chunk->lck_cookie = iops->store(env, di);
+			mdd_lfsck_mt_control_speed(lfsck);
+			rc = iops->next(env, di);
+			if (rc > 0)
+				lfsck->ml_oit_over = 1;
+		} while (rc == 0 && chunk->lck_count < LFSCK_CHUNK_SIZE &&
+			 !mdd_lfsck_mt_abort(lfsck));
+
+		spin_lock(&lfsck->ml_lock);
+		cfs_list_add_tail(&chunk->lck_order, &lfsck->ml_mt_order);
+		cfs_list_add_tail(&chunk->lck_link, &lfsck->ml_mt_queue);
+		spin_unlock(&lfsck->ml_lock);
+		cfs_waitq_broadcast(&thread->t_ctl_waitq);
+	} while (rc == 0);
+
+	GOTO(out, rc);
+
+out:
+	mdd_lfsck_mt_fini(lfsck);
+	if (rc >= 0 && lfsck->ml_mt_rc != 0)
+		rc = lfsck->ml_mt_rc;
+	else if (rc > 0 && !thread_is_running(thread))
+		rc = 0;
+	RETURN(rc);
+}
+
 static int mdd_lfsck_main(void *args)
 {
 	struct lu_env		 env;
@@ -2562,10 +3111,14 @@ static int mdd_lfsck_main(void *args)
 	cfs_waitq_broadcast(&thread->t_ctl_waitq);
 
 	if (!cfs_list_empty(&lfsck->ml_list_scan) ||
-	    cfs_list_empty(&lfsck->ml_list_double_scan))
-		rc = mdd_lfsck_oit_engine(&env, lfsck);
-	else
+	    cfs_list_empty(&lfsck->ml_list_double_scan)) {
+		if (lfsck->ml_mt_count > 1)
+			rc = mdd_lfsck_mt_engine(&env, lfsck);
+		else
+			rc = mdd_lfsck_oit_engine(&env, lfsck);
+	} else {
 		rc = 1;
+	}
 
 	CDEBUG(D_LFSCK, "LFSCK exit: oit_flags = 0x%x, dir_flags = 0x%x, "
 	       "oit_cookie = "LPU64", dir_cookie = "LPU64", parent = "DFID
@@ -2583,6 +3136,10 @@ static int mdd_lfsck_main(void *args)
 	if (lfsck->ml_di_dir != NULL)
 		mdd_lfsck_close_dir(&env, lfsck);
 
+	spin_lock(&lfsck->ml_lock);
+	lfsck->ml_mt_running = 0;
+	spin_unlock(&lfsck->ml_lock);
+
 fini_oit:
 	spin_lock(&lfsck->ml_lock);
 	lfsck->ml_di_oit = NULL;
@@ -2623,6 +3180,64 @@ int mdd_lfsck_set_speed(const struct lu_env *env, struct md_lfsck *lfsck,
 	return rc;
 }
 
+int mdd_lfsck_set_threads(struct md_lfsck *lfsck, __u32 threads)
+{
+	if (threads < 1 || threads > LFSCK_THREADS_MAX)
+		return -EINVAL;
+
+	/* Take effect when the LFSCK is started next time. */
+	mutex_lock(&lfsck->ml_mutex);
+	lfsck->ml_threads = threads;
+	mutex_unlock(&lfsck->ml_mutex);
+	return 0;
+}
+
+int mdd_lfsck_dump_threads(struct md_lfsck *lfsck, char *buf, int len)
+{
+	int save = len;
+	int rc;
+	int i;
+
+	if (!lfsck->ml_initialized)
+		return -ENODEV;
+
+	mutex_lock(&lfsck->ml_mutex);
+	rc = snprintf(buf, len,
+		      "threads: %u\n"
+		      "completed_position: "LPU64"\n",
+		      lfsck->ml_threads,
+		      lfsck->ml_mt_running ? lfsck->ml_mt_cookie : 0);
+	if (rc <= 0)
+		GOTO(out, rc = -ENOSPC);
+
+	buf += rc;
+	len -= rc;
+	for (i = 0; i < lfsck->ml_mt_count; i++) {
+		struct lfsck_thread *lt = &lfsck->ml_mt_threads[i];
+
+		rc = snprintf(buf, len,
+			      "thread_%02d: %s chunks: "LPU64" objects: "LPU64
+			      " dirs: "LPU64" entries: "LPU64" failed: "LPU64
+			      "\n", i,
+			      thread_is_running(&lt->lt_thread) ?
+			      "running" : "stopped",
+			      lt->lt_chunks, lt->lt_objects, lt->lt_dirs,
+			      lt->lt_entries, lt->lt_failed);
+		if (rc <= 0)
+			GOTO(out, rc = -ENOSPC);
+
+		buf += rc;
+		len -= rc;
+	}
+	rc = save - len;
+
+	GOTO(out, rc);
+
+out:
+	mutex_unlock(&lfsck->ml_mutex);
+	return rc;
+}
+
 int mdd_lfsck_dump(const struct lu_env *env, struct md_lfsck *lfsck,
 		   __u16 type, char *buf, int len)
 {
@@ -2788,6 +3403,28 @@ trigger:
 		flags |= DOIF_OUTUSED;
 
 	lfsck->ml_args_oit = (flags << DT_OTABLE_IT_FLAGS_SHIFT) | valid;
+
+	if (lfsck->ml_mt_count != lfsck->ml_threads) {
+		if (lfsck->ml_mt_threads != NULL) {
+			OBD_FREE(lfsck->ml_mt_threads,
+				 sizeof(struct lfsck_thread) *
+				 lfsck->ml_mt_count);
+			lfsck->ml_mt_threads = NULL;
+			lfsck->ml_mt_count = 0;
+		}
+
+		if (lfsck->ml_threads > 1) {
+			OBD_ALLOC(lfsck->ml_mt_threads,
+				  sizeof(struct lfsck_thread) *
+				  lfsck->ml_threads);
+			if (lfsck->ml_mt_threads != NULL)
+				lfsck->ml_mt_count = lfsck->ml_threads;
+			else
+				CWARN("%s: LFSCK runs with single thread for "
+				      "no memory\n", mdd_lfsck2name(lfsck));
+		}
+	}
+
 	thread_set_flags(thread, 0);
 	rc = cfs_create_thread(mdd_lfsck_main, lfsck, 0);
 	if (rc < 0)
@@ -2865,7 +3502,11 @@ int mdd_lfsck_setup(const struct lu_env *env, struct mdd_device *mdd)
 	CFS_INIT_LIST_HEAD(&lfsck->ml_list_dir);
 	CFS_INIT_LIST_HEAD(&lfsck->ml_list_double_scan);
 	CFS_INIT_LIST_HEAD(&lfsck->ml_list_idle);
+	CFS_INIT_LIST_HEAD(&lfsck->ml_mt_queue);
+	CFS_INIT_LIST_HEAD(&lfsck->ml_mt_order);
+	CFS_INIT_LIST_HEAD(&lfsck->ml_mt_free);
 	cfs_waitq_init(&lfsck->ml_thread.t_ctl_waitq);
+	lfsck->ml_threads = 1;
 
 	obj = dt_locate(env, mdd->mdd_bottom, &lfsck_it_fid);
 	if (IS_ERR(obj))
@@ -2929,6 +3570,13 @@ void mdd_lfsck_cleanup(const struct lu_env *env, struct mdd_device *mdd)
 
 	LASSERT(lfsck->ml_obj_dir == NULL);
 
+	if (lfsck->ml_mt_threads != NULL) {
+		OBD_FREE(lfsck->ml_mt_threads,
+			 sizeof(struct lfsck_thread) * lfsck->ml_mt_count);
+		lfsck->ml_mt_threads = NULL;
+		lfsck->ml_mt_count = 0;
+	}
+
 	if (lfsck->ml_bookmark_obj != NULL) {
 		lu_object_put(env, &lfsck->ml_bookmark_obj->do_lu);
 		lfsck->ml_bookmark_obj = NULL;
@@ -209,6 +209,7 @@ struct lfsck_operations {
 
 	int (*lfsck_exec_dir)(const struct lu_env *env,
 			      struct lfsck_component *com,
+			      struct dt_object *dir,
 			      struct mdd_object *obj,
 			      struct lu_dirent *ent);
 
@@ -232,6 +233,10 @@ struct lfsck_component {
 	/* into md_lfsck::ml_list_dir */
 	cfs_list_t		 lc_link_dir;
 	struct rw_semaphore	 lc_sem;
+
+	/* Protect the statistics updated by the LFSCK threads those share
+	 * the lc_sem for scanning. */
+	spinlock_t		 lc_lock;
 	cfs_atomic_t		 lc_ref;
 
 	struct lfsck_position	 lc_pos_start;
@@ -248,6 +253,39 @@ struct lfsck_component {
 	__u16			 lc_type;
 };
 
+#define LFSCK_THREADS_MAX	32
+
+/* How many otable-based iteration items are dispatched together. */
+#define LFSCK_CHUNK_SIZE	256
+
+/* A run of the consecutive inode table items handled by one LFSCK thread. */
+struct lfsck_chunk {
+	/* into md_lfsck::ml_mt_queue, when waiting for a thread. */
+	cfs_list_t		 lck_link;
+
+	/* into md_lfsck::ml_mt_order by dispatch order, or ml_mt_free. */
+	cfs_list_t		 lck_order;
+
+	/* Position of the last item in the chunk. */
+	__u64			 lck_cookie;
+	int			 lck_count;
+	unsigned int		 lck_done:1;
+	struct lu_fid		 lck_fids[LFSCK_CHUNK_SIZE];
+};
+
+struct lfsck_thread {
+	struct ptlrpc_thread	 lt_thread;
+	struct md_lfsck		*lt_lfsck;
+	int			 lt_index;
+
+	/* Progress of this thread since the LFSCK started. */
+	__u64			 lt_chunks;
+	__u64			 lt_objects;
+	__u64			 lt_dirs;
+	__u64			 lt_entries;
+	__u64			 lt_failed;
+};
+
 struct md_lfsck {
 	struct mutex		 ml_mutex;
 	spinlock_t		 ml_lock;
@@ -306,10 +344,37 @@ struct md_lfsck {
 	/* How many objects have been scanned since last sleep. */
 	__u32			 ml_new_scanned;
 
+	/* End of the current speed limit window for the threads, jiffies */
+	cfs_time_t		 ml_time_speed_window;
+
+	/* How many threads scan the objects, 1 for single thread engine. */
+	__u32			 ml_threads;
+
+	/* The threads for multi-threaded engine, ml_mt_count in total. */
+	struct lfsck_thread	*ml_mt_threads;
+	__u32			 ml_mt_count;
+
+	/* How many of the threads are still alive, protected by ml_lock. */
+	__u32			 ml_mt_live;
+
+	/* The chunks to be processed, the ones in processing (by dispatch
+	 * order) and the free ones, protected by ml_lock. */
+	cfs_list_t		 ml_mt_queue;
+	cfs_list_t		 ml_mt_order;
+	cfs_list_t		 ml_mt_free;
+
+	/* All the items up to this position have been processed. */
+	__u64			 ml_mt_cookie;
+
+	/* The first failure of the threads under failout mode. */
+	int			 ml_mt_rc;
+
 	unsigned int		 ml_paused:1, /* The lfsck is paused. */
 				 ml_oit_over:1, /* oit is finished. */
 				 ml_drop_dryrun:1, /* Ever dryrun, not now. */
-				 ml_initialized:1; /* lfsck_setup is called. */
+				 ml_initialized:1, /* lfsck_setup is called. */
+				 ml_mt_running:1, /* threads are scanning. */
+				 ml_mt_over:1; /* no more chunks. */
 };
 
 enum lfsck_linkea_flags {
@@ -241,6 +241,41 @@ static int lprocfs_rd_changelog_users(char *page, char **start, off_t off,
 	return cucb.idx;
 }
 
+static int lprocfs_rd_changelog_gc(char *page, char **start, off_t off,
+				   int count, int *eof, void *data)
+{
+	struct mdd_device	*mdd = data;
+	struct mdd_changelog	*mc;
+	__u64			 cur, endrec, done, records, logs;
+	int			 running, rc;
+
+	LASSERT(mdd != NULL);
+	mc = &mdd->mdd_cl;
+
+	spin_lock(&mc->mc_lock);
+	running = thread_is_running(&mc->mc_gc_thread);
+	cur = mc->mc_index;
+	endrec = mc->mc_gc_endrec;
+	done = mc->mc_gc_done;
+	records = mc->mc_gc_records;
+	logs = mc->mc_gc_logs;
+	rc = mc->mc_gc_rc;
+	spin_unlock(&mc->mc_lock);
+
+	*eof = 1;
+	return snprintf(page, count,
+			"status: %s\n"
+			"current_index: "LPU64"\n"
+			"purge_requested: "LPU64"\n"
+			"purged: "LPU64"\n"
+			"lag: "LPU64"\n"
+			"records_cancelled: "LPU64"\n"
+			"llogs_destroyed: "LPU64"\n"
+			"last_rc: %d\n",
+			running ? "running" : "stopped", cur, endrec, done,
+			endrec - done, records, logs, rc);
+}
+
 static int lprocfs_rd_sync_perm(char *page, char **start, off_t off,
                                 int count, int *eof, void *data)
 {
@@ -303,6 +338,32 @@ static int lprocfs_wr_lfsck_speed_limit(struct file *file, const char *buffer,
 	return rc != 0 ? rc : count;
 }
 
+static int lprocfs_rd_lfsck_threads(char *page, char **start, off_t off,
+				    int count, int *eof, void *data)
+{
+	struct mdd_device *mdd = data;
+
+	LASSERT(mdd != NULL);
+	*eof = 1;
+	return mdd_lfsck_dump_threads(&mdd->mdd_lfsck, page, count);
+}
+
+static int lprocfs_wr_lfsck_threads(struct file *file, const char *buffer,
+				    unsigned long count, void *data)
+{
+	struct mdd_device *mdd = data;
+	__u32 val;
+	int rc;
+
+	LASSERT(mdd != NULL);
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc != 0)
+		return rc;
+
+	rc = mdd_lfsck_set_threads(&mdd->mdd_lfsck, val);
+	return rc != 0 ? rc : count;
+}
+
 static int lprocfs_rd_lfsck_namespace(char *page, char **start, off_t off,
 				      int count, int *eof, void *data)
 {
@@ -327,9 +388,12 @@ static struct lprocfs_vars lprocfs_mdd_obd_vars[] = {
         { "changelog_mask",  lprocfs_rd_changelog_mask,
                              lprocfs_wr_changelog_mask, 0 },
         { "changelog_users", lprocfs_rd_changelog_users, 0, 0},
+	{ "changelog_gc",    lprocfs_rd_changelog_gc, 0, 0 },
         { "sync_permission", lprocfs_rd_sync_perm, lprocfs_wr_sync_perm, 0 },
 	{ "lfsck_speed_limit", lprocfs_rd_lfsck_speed_limit,
 			       lprocfs_wr_lfsck_speed_limit, 0 },
+	{ "lfsck_threads",     lprocfs_rd_lfsck_threads,
+			       lprocfs_wr_lfsck_threads, 0 },
 	{ "lfsck_namespace", lprocfs_rd_lfsck_namespace, 0, 0 },
 	{ 0 }
 };
@@ -356,6 +356,15 @@ int mdd_declare_object_create_internal(const struct lu_env *env,
 		}
 	}
 
+	/* stripes of a directory from "lfs setdirstripe" */
+	if (S_ISDIR(attr->la_mode) && spec->u.sp_ea.eadata != NULL) {
+		hint->dah_eadata = spec->u.sp_ea.eadata;
+		hint->dah_eadata_len = spec->u.sp_ea.eadatalen;
+	} else {
+		hint->dah_eadata = NULL;
+		hint->dah_eadata_len = 0;
+	}
+
 	rc = mdo_declare_create_obj(env, c, attr, hint, dof, handle);
 
         RETURN(rc);
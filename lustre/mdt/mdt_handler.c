@@ -340,11 +340,18 @@ static void mdt_pack_size2body(struct mdt_thread_info *info,
         LASSERT(ma->ma_attr.la_valid & LA_MODE);
         b = req_capsule_server_get(info->mti_pill, &RMF_MDT_BODY);
 
+	/* Clients without Size-on-MDS may take the lazy size instead. */
+	if (!(mdt_conn_flags(info) & OBD_CONNECT_SOM)) {
+		if (mdt_conn_flags(info) & OBD_CONNECT_LAZY_SIZE &&
+		    S_ISREG(ma->ma_attr.la_mode))
+			mdt_lsom_pack(info, mo, b);
+		return;
+	}
+
         /* Check if Size-on-MDS is supported, if this is a regular file,
          * if SOM is enabled on the object and if SOM cache exists and valid.
          * Otherwise do not pack Size-on-MDS attributes to the reply. */
-        if (!(mdt_conn_flags(info) & OBD_CONNECT_SOM) ||
-            !S_ISREG(ma->ma_attr.la_mode) ||
+        if (!S_ISREG(ma->ma_attr.la_mode) ||
             !mdt_object_is_som_enabled(mo) ||
             !(ma->ma_valid & MA_SOM))
                 return;
@@ -388,6 +395,10 @@ void mdt_pack_attr2body(struct mdt_thread_info *info, struct mdt_body *b,
                 b->blocks = 0;
                 /* if no object is allocated on osts, the size on mds is valid. b=22272 */
                 b->valid |= OBD_MD_FLSIZE | OBD_MD_FLBLOCKS;
+	} else if (ma->ma_valid & MA_LOV && ma->ma_lmm != NULL &&
+		   le32_to_cpu(ma->ma_lmm->lmm_pattern) == LOV_PATTERN_MDT) {
+		/* data is kept in the MDT inode, the size on mds is valid */
+		b->valid |= OBD_MD_FLSIZE | OBD_MD_FLBLOCKS;
         }
 
         if (fid) {
@@ -1066,6 +1077,10 @@ int mdt_swap_layouts(struct mdt_thread_info *info)
 	if (msl == NULL)
 		GOTO(put, rc = -EPROTO);
 
+	/* the sizes go with the layouts */
+	mdt_lsom_invalidate(info, o1);
+	mdt_lsom_invalidate(info, o2);
+
 	lh1 = &info->mti_lh[MDT_LH_NEW];
 	mdt_lock_reg_init(lh1, LCK_EX);
 	lh2 = &info->mti_lh[MDT_LH_OLD];
@@ -1472,6 +1487,248 @@ out_shrink:
         return rc;
 }
 
+/*
+ * Hand the local lock in @lh over to the client, which created it with
+ * handle @remote, see mdt_intent_lock_replace(). A lock that already
+ * conflicts with somebody is dropped instead, and false returned.
+ */
+static bool mdt_batch_lock_give(struct mdt_thread_info *info,
+				struct mdt_lock_handle *lh,
+				struct lustre_handle *remote)
+{
+	struct obd_export *exp = info->mti_exp;
+	struct ldlm_lock  *lock;
+
+	lock = ldlm_handle2lock_long(&lh->mlh_reg_lh, 0);
+	LASSERT(lock != NULL);
+	LASSERT(lock->l_export == NULL);
+	LASSERT(lock->l_readers == 1 && lock->l_writers == 0);
+
+	lock_res_and_lock(lock);
+	if (lock->l_flags & LDLM_FL_AST_SENT) {
+		unlock_res_and_lock(lock);
+		LDLM_LOCK_RELEASE(lock);
+		return false;
+	}
+
+	/* zero l_readers without triggering a blocking AST */
+	lu_ref_del(&lock->l_reference, "reader", lock);
+	lu_ref_del(&lock->l_reference, "user", lock);
+	lock->l_readers--;
+
+	lock->l_export = class_export_lock_get(exp, lock);
+	lock->l_blocking_ast = ldlm_server_blocking_ast;
+	lock->l_completion_ast = ldlm_server_completion_ast;
+	lock->l_remote_handle = *remote;
+	lock->l_flags &= ~LDLM_FL_LOCAL;
+	unlock_res_and_lock(lock);
+
+	cfs_hash_add(exp->exp_lock_hash, &lock->l_remote_handle,
+		     &lock->l_exp_hash);
+
+	LDLM_DEBUG(lock, "Returning batch lock to client");
+	LDLM_LOCK_RELEASE(lock);
+	return true;
+}
+
+/*
+ * Stat one name of MDS_BATCH_GETATTR into @rep, with its LOV EA in @ea.
+ * Returns the EA size or a negative errno for the client to fall back to an
+ * intent getattr on that name.
+ */
+static int mdt_batch_getattr_one(struct mdt_thread_info *info,
+				 struct mdt_batch_ent *ent, char *name,
+				 struct mdt_batch_rep *rep, void *ea, int easize)
+{
+	const struct lu_env	*env = info->mti_env;
+	struct ptlrpc_request	*req = mdt_info_req(info);
+	struct mdt_object	*parent = info->mti_object;
+	struct mdt_lock_handle	*lhp = &info->mti_lh[MDT_LH_PARENT];
+	struct mdt_lock_handle	*lhc = &info->mti_lh[MDT_LH_CHILD];
+	struct lu_fid		*child_fid = &info->mti_tmp_fid1;
+	struct md_attr		*ma = &info->mti_attr;
+	struct mdt_object	*child;
+	struct ldlm_lock	*lock = NULL;
+	__u64			 bits;
+	int			 rc;
+	ENTRY;
+
+	mdt_lock_handle_init(lhp);
+	mdt_lock_handle_init(lhc);
+
+	/* resent, the client may already own the lock */
+	if (lustre_msg_get_flags(req->rq_reqmsg) & MSG_RESENT)
+		lock = cfs_hash_lookup(info->mti_exp->exp_lock_hash,
+				       &ent->mbe_handle);
+	if (lock != NULL) {
+		fid_build_from_res_name(child_fid, &lock->l_resource->lr_name);
+		rep->mbr_handle.cookie = lock->l_handle.h_cookie;
+		rep->mbr_bits = lock->l_policy_data.l_inodebits.bits;
+		LDLM_LOCK_PUT(lock);
+	} else {
+		mdt_lock_pdo_init(lhp, LCK_PR, name, ent->mbe_namelen);
+		rc = mdt_object_lock(info, parent, lhp, MDS_INODELOCK_UPDATE,
+				     MDT_LOCAL_LOCK);
+		if (rc)
+			RETURN(rc);
+
+		fid_zero(child_fid);
+		rc = mdo_lookup(env, mdt_object_child(parent),
+				mdt_name(env, name, ent->mbe_namelen),
+				child_fid, &info->mti_spec);
+		if (rc)
+			GOTO(out_parent, rc);
+	}
+
+	child = mdt_object_find(env, info->mti_mdt, child_fid);
+	if (IS_ERR(child))
+		GOTO(out_parent, rc = PTR_ERR(child));
+	if (!mdt_object_exists(child))
+		GOTO(out_child, rc = -ENOENT);
+	if (mdt_object_remote(child))
+		GOTO(out_child, rc = -EREMOTE);
+
+	if (lustre_handle_is_used(&rep->mbr_handle))
+		goto getattr;
+
+	/* never wait for a conflicting lock holding a batch of names, the
+	 * client enqueues such a name by itself */
+	mdt_lock_reg_init(lhc, LCK_PR);
+	bits = ent->mbe_bits & (MDS_INODELOCK_LOOKUP | MDS_INODELOCK_UPDATE);
+	if (bits == 0)
+		GOTO(out_child, rc = -EINVAL);
+	rc = 0;
+	if (exp_connect_layout(info->mti_exp) &&
+	    S_ISREG(lu_object_attr(&child->mot_obj.mo_lu)) &&
+	    mdt_object_lock_try(info, child, lhc,
+				bits | MDS_INODELOCK_LAYOUT, MDT_CROSS_LOCK))
+		bits |= MDS_INODELOCK_LAYOUT;
+	else if (!mdt_object_lock_try(info, child, lhc, bits, MDT_CROSS_LOCK))
+		rc = -EWOULDBLOCK;
+	if (rc)
+		GOTO(out_child, rc);
+
+getattr:
+	ma->ma_lmm = ea;
+	ma->ma_lmm_size = easize;
+	ma->ma_need = MA_INODE;
+	if (S_ISREG(lu_object_attr(&child->mot_obj.mo_lu)))
+		ma->ma_need |= MA_LOV;
+	rc = mdt_attr_get_complex(info, child, ma);
+	if (rc)
+		GOTO(out_unlock, rc);
+
+	/* ACLs are not returned, let the client fetch them with the inode */
+	if (exp_connect_flags(info->mti_exp) & OBD_CONNECT_ACL &&
+	    mo_xattr_get(env, mdt_object_child(child), &LU_BUF_NULL,
+			 XATTR_NAME_ACL_ACCESS) > 0)
+		GOTO(out_unlock, rc = -EOPNOTSUPP);
+
+	mdt_pack_attr2body(info, &rep->mbr_body, &ma->ma_attr,
+			   mdt_object_fid(child));
+	if (ma->ma_valid & MA_LOV) {
+		rep->mbr_body.eadatasize = ma->ma_lmm_size;
+		rep->mbr_body.valid |= OBD_MD_FLEASIZE;
+		rc = ma->ma_lmm_size;
+	}
+
+	if (lustre_handle_is_used(&lhc->mlh_reg_lh)) {
+		if (bits & MDS_INODELOCK_UPDATE &&
+		    exp_connect_flags(info->mti_exp) & OBD_CONNECT_LAZY_SIZE &&
+		    S_ISREG(ma->ma_attr.la_mode))
+			mdt_lsom_pack(info, child, &rep->mbr_body);
+		if (!mdt_batch_lock_give(info, lhc, &ent->mbe_handle))
+			GOTO(out_unlock, rc = -EWOULDBLOCK);
+		rep->mbr_handle = lhc->mlh_reg_lh;
+		rep->mbr_bits = bits;
+		lhc->mlh_reg_lh.cookie = 0;
+	}
+	EXIT;
+out_unlock:
+	mdt_object_unlock(info, child, lhc, 1);
+out_child:
+	mdt_object_put(env, child);
+out_parent:
+	mdt_object_unlock(info, parent, lhp, 1);
+	return rc;
+}
+
+/*
+ * Stat-ahead of many names in one RPC: for each mdt_batch_ent return the
+ * attributes and LOV EA of the child and a PR ibits lock on it, created with
+ * the client handle of the entry.
+ */
+int mdt_batch_getattr(struct mdt_thread_info *info)
+{
+	struct req_capsule	*pill = info->mti_pill;
+	struct mdt_body		*reqbody = info->mti_body;
+	struct mdt_batch_ent	*ent;
+	struct mdt_batch_rep	*rep;
+	char			*names;
+	char			*ea;
+	int			 namelen;
+	int			 easize;
+	int			 used = 0;
+	int			 count;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	if (!S_ISDIR(lu_object_attr(&info->mti_object->mot_obj.mo_lu)))
+		RETURN(-ENOTDIR);
+
+	count = req_capsule_get_size(pill, &RMF_MDT_BATCH_ENT, RCL_CLIENT) /
+		sizeof(*ent);
+	namelen = req_capsule_get_size(pill, &RMF_MDT_BATCH_NAMES, RCL_CLIENT);
+	ent = req_capsule_client_get(pill, &RMF_MDT_BATCH_ENT);
+	names = req_capsule_client_get(pill, &RMF_MDT_BATCH_NAMES);
+	if (ent == NULL || names == NULL || count == 0 ||
+	    count > MDS_BATCH_GETATTR_MAX || reqbody->eadatasize == 0)
+		RETURN(err_serious(-EPROTO));
+
+	easize = cfs_size_round(reqbody->eadatasize);
+	req_capsule_set_size(pill, &RMF_MDT_BATCH_REP, RCL_SERVER,
+			     count * sizeof(*rep));
+	req_capsule_set_size(pill, &RMF_MDT_MD, RCL_SERVER, count * easize);
+	rc = req_capsule_server_pack(pill);
+	if (rc)
+		RETURN(err_serious(rc));
+
+	rep = req_capsule_server_get(pill, &RMF_MDT_BATCH_REP);
+	ea = req_capsule_server_get(pill, &RMF_MDT_MD);
+	memset(rep, 0, count * sizeof(*rep));
+
+	rc = mdt_init_ucred(info, reqbody);
+	if (rc)
+		RETURN(rc);
+
+	for (i = 0; i < count; i++) {
+		if (ent[i].mbe_namelen == 0 || ent[i].mbe_namelen > NAME_MAX ||
+		    ent[i].mbe_nameoff >= namelen ||
+		    ent[i].mbe_nameoff + ent[i].mbe_namelen >= namelen ||
+		    names[ent[i].mbe_nameoff + ent[i].mbe_namelen] != '\0') {
+			rep[i].mbr_status = -EPROTO;
+			continue;
+		}
+
+		rc = mdt_batch_getattr_one(info, &ent[i],
+					   names + ent[i].mbe_nameoff,
+					   &rep[i], ea + used, easize);
+		if (rc < 0) {
+			memset(&rep[i], 0, sizeof(rep[i]));
+			rep[i].mbr_status = rc;
+			continue;
+		}
+		used += cfs_size_round(rc);
+	}
+	mdt_exit_ucred(info);
+
+	req_capsule_shrink(pill, &RMF_MDT_MD, used, RCL_SERVER);
+	CDEBUG(D_INODE, "batch getattr of %d names in "DFID"\n", count,
+	       PFID(mdt_object_fid(info->mti_object)));
+	RETURN(0);
+}
+
 static int mdt_iocontrol(unsigned int cmd, struct obd_export *exp, int len,
                          void *karg, void *uarg);
 
@@ -2330,6 +2587,20 @@ int mdt_quota_dqacq(struct mdt_thread_info *info)
 	RETURN(rc);
 }
 
+int mdt_quota_dqacq_batch(struct mdt_thread_info *info)
+{
+	struct lu_device	*qmt = info->mti_mdt->mdt_qmt_dev;
+	int			 rc;
+	ENTRY;
+
+	if (qmt == NULL)
+		RETURN(err_serious(-EOPNOTSUPP));
+
+	rc = qmt_hdls.qmth_dqacq_batch(info->mti_env, qmt,
+				       mdt_info_req(info));
+	RETURN(rc);
+}
+
 static struct mdt_object *mdt_obj(struct lu_object *o)
 {
         LASSERT(lu_device_is_mdt(o->lo_dev));
@@ -2390,6 +2661,47 @@ static void mdt_device_commit_async(const struct lu_env *env,
                 CWARN("async commit start failed with rc = %d", rc);
 }
 
+/**
+ * Check whether a COS conflict needs a new transaction commit.
+ *
+ * In the fine-grained COS mode the commit is skipped if the transaction
+ * the conflicting lock depends on is already committed, or if it was
+ * assigned before an asynchronous commit already requested by an earlier
+ * conflict: transnos are assigned before the journal handle is stopped,
+ * so such a commit includes it. Otherwise the current last transno is
+ * recorded as covered by the commit the caller is going to start.
+ *
+ * \param mdt the mdt device
+ * \param transno transaction number the conflicting lock depends on,
+ *		  0 if unknown
+ * \retval 1 the caller should start an asynchronous commit
+ * \retval 0 no commit is needed
+ */
+static int mdt_cos_need_commit(struct mdt_device *mdt, __u64 transno)
+{
+	struct lu_target *lut = &mdt->mdt_lut;
+	int		  commit = 1;
+
+	spin_lock(&lut->lut_translock);
+	if (mdt->mdt_opts.mo_cos == MDT_COS_FINE && transno != 0 &&
+	    (transno <= mdt2obd_dev(mdt)->obd_last_committed ||
+	     transno <= mdt->mdt_cos_commit_transno))
+		commit = 0;
+
+	if (commit) {
+		mdt->mdt_cos_commit_transno = lut->lut_last_transno;
+		mdt->mdt_cos_forced++;
+	} else {
+		mdt->mdt_cos_avoided++;
+	}
+	spin_unlock(&lut->lut_translock);
+
+	CDEBUG(D_HA, "%s: COS transno "LPU64": %s commit\n",
+	       mdt2obd_dev(mdt)->obd_name, transno,
+	       commit ? "start" : "skip");
+	return commit;
+}
+
 /**
  * Mark the lock as "synchonous".
  *
@@ -2438,6 +2750,7 @@ int mdt_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
 {
         struct obd_device *obd = ldlm_lock_to_ns(lock)->ns_obd;
         struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+        __u64 transno;
         int rc;
         ENTRY;
 
@@ -2454,12 +2767,14 @@ int mdt_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
             lock->l_client_cookie != lock->l_blocking_lock->l_client_cookie) {
                 mdt_set_lock_sync(lock);
         }
+        transno = lock->l_transno;
         rc = ldlm_blocking_ast_nocheck(lock);
 
         /* There is no lock conflict if l_blocking_lock == NULL,
          * it indicates a blocking ast sent from ldlm_lock_decref_internal
          * when the last reference to a local lock was released */
-        if (lock->l_req_mode == LCK_COS && lock->l_blocking_lock != NULL) {
+        if (lock->l_req_mode == LCK_COS && lock->l_blocking_lock != NULL &&
+            mdt_cos_need_commit(mdt, transno)) {
                 struct lu_env env;
 
                 rc = lu_env_init(&env, LCT_LOCAL);
@@ -2679,11 +2994,15 @@ void mdt_save_lock(struct mdt_thread_info *info, struct lustre_handle *h,
                                req, req->rq_reply_state, req->rq_transno);
                         if (mdt_cos_is_enabled(mdt)) {
                                 no_ack = 1;
+                                /* set before downgrade, which may run
+                                 * blocking ASTs of conflicting locks */
+                                lock->l_transno = req->rq_transno;
                                 ldlm_lock_downgrade(lock, LCK_COS);
                                 mode = LCK_COS;
                         }
                         ptlrpc_save_lock(req, h, mode, no_ack);
-                        if (mdt_is_lock_sync(lock)) {
+                        if (mdt_is_lock_sync(lock) &&
+                            mdt_cos_need_commit(mdt, req->rq_transno)) {
                                 CDEBUG(D_HA, "found sync-lock,"
                                        " async commit started\n");
                                 mdt_device_commit_async(info->mti_env,
@@ -3267,8 +3586,12 @@ static int mdt_msg_check_version(struct lustre_msg *msg)
         case MDS_QUOTACTL:
 	case UPDATE_OBJ:
 	case MDS_SWAP_LAYOUTS:
+	case MDS_DOM_READ:
+	case MDS_DOM_WRITE:
+	case MDS_BATCH_GETATTR:
         case QUOTA_DQACQ:
         case QUOTA_DQREL:
+	case QUOTA_DQACQ_BATCH:
         case SEQ_QUERY:
         case FLD_QUERY:
                 rc = lustre_msg_check_version(msg, LUSTRE_MDS_VERSION);
@@ -4675,6 +4998,8 @@ static int mdt_init0(const struct lu_env *env, struct mdt_device *m,
         sptlrpc_rule_set_init(&m->mdt_sptlrpc_rset);
 
 	spin_lock_init(&m->mdt_ioepoch_lock);
+	/* cookies of a former instance are not reused */
+	m->mdt_dom_cookie = (__u64)cfs_time_current_sec() << 32;
         m->mdt_opts.mo_compat_resname = 0;
         m->mdt_opts.mo_mds_capa = 1;
         m->mdt_opts.mo_oss_capa = 1;
@@ -4691,6 +5016,7 @@ static int mdt_init0(const struct lu_env *env, struct mdt_device *m,
 	m->mdt_osfs_age = cfs_time_shift_64(-1000);
 	m->mdt_enable_remote_dir = 0;
 	m->mdt_enable_remote_dir_gid = 0;
+	m->mdt_lsom_conf = 1;
 
         m->mdt_md_dev.md_lu_dev.ld_ops = &mdt_lu_ops;
         m->mdt_md_dev.md_lu_dev.ld_obd = obd;
@@ -4956,6 +5282,8 @@ static struct lu_object *mdt_object_alloc(const struct lu_env *env,
                 o->lo_ops = &mdt_obj_ops;
 		mutex_init(&mo->mot_ioepoch_mutex);
 		mutex_init(&mo->mot_lov_mutex);
+		/* locks of clients outlive the object in cache */
+		mo->mot_lsom_cached = 1;
                 RETURN(o);
         } else
                 RETURN(NULL);
@@ -6044,17 +6372,20 @@ struct lu_ucred *mdt_ucred_check(const struct mdt_thread_info *info)
 /**
  * Enable/disable COS (Commit On Sharing).
  *
- * Set/Clear the COS flag in mdt options.
+ * Set the COS mode in mdt options.
  *
  * \param mdt mdt device
- * \param val 0 disables COS, other values enable COS
+ * \param val MDT_COS_OFF disables COS, MDT_COS_ON starts a commit on every
+ *	      conflict, MDT_COS_FINE only when the conflicting transaction is
+ *	      not committed yet
  */
 void mdt_enable_cos(struct mdt_device *mdt, int val)
 {
         struct lu_env env;
         int rc;
 
-        mdt->mdt_opts.mo_cos = !!val;
+        LASSERT(val >= MDT_COS_OFF && val <= MDT_COS_FINE);
+        mdt->mdt_opts.mo_cos = val;
         rc = lu_env_init(&env, LCT_LOCAL);
         if (unlikely(rc != 0)) {
                 CWARN("lu_env initialization failed with rc = %d,"
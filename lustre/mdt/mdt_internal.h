@@ -128,13 +128,15 @@ struct mdt_device {
 				   mo_compat_resname:1,
 				   mo_mds_capa:1,
 				   mo_oss_capa:1,
-				   mo_cos:1;
+				   mo_cos:2;
 	} mdt_opts;
         /* mdt state flags */
         unsigned long              mdt_state;
         /* lock to protect IOepoch */
 	spinlock_t		   mdt_ioepoch_lock;
         __u64                      mdt_ioepoch;
+	/* last DoM migration cookie, under mdt_ioepoch_lock */
+	__u64			   mdt_dom_cookie;
 
         /* transaction callbacks */
         struct dt_txn_callback     mdt_txn_cb;
@@ -162,7 +164,9 @@ struct mdt_device {
 	unsigned int               mdt_capa_conf:1,
 				   mdt_som_conf:1,
 				   /* Enable remote dir on non-MDT0 */
-				   mdt_enable_remote_dir:1;
+				   mdt_enable_remote_dir:1,
+				   /* return lazy size with getattr */
+				   mdt_lsom_conf:1;
 
 	gid_t			   mdt_enable_remote_dir_gid;
 	/* statfs optimization: we cache a bit  */
@@ -186,6 +190,11 @@ struct mdt_device {
 	struct obd_export	  *mdt_qmt_exp;
 	/* quota master device associated with this MDT */
 	struct lu_device	  *mdt_qmt_dev;
+
+	/* fine-grained COS state, protected by mdt_lut.lut_translock */
+	__u64			   mdt_cos_commit_transno;
+	__u64			   mdt_cos_forced;
+	__u64			   mdt_cos_avoided;
 };
 
 #define MDT_SERVICE_WATCHDOG_FACTOR	(2)
@@ -193,7 +202,13 @@ struct mdt_device {
 #define MDT_INCOMPAT_SUPP	(OBD_INCOMPAT_MDT | OBD_INCOMPAT_COMMON_LR | \
 				OBD_INCOMPAT_FID | OBD_INCOMPAT_IAM_DIR | \
 				OBD_INCOMPAT_LMM_VER | OBD_INCOMPAT_MULTI_OI)
-#define MDT_COS_DEFAULT         (0)
+/* commit_on_sharing modes */
+#define MDT_COS_OFF		(0)
+/* start a commit on every conflict with an uncommitted lock */
+#define MDT_COS_ON		(1)
+/* start a commit only if the conflicting transaction is not yet covered */
+#define MDT_COS_FINE		(2)
+#define MDT_COS_DEFAULT		MDT_COS_OFF
 
 struct mdt_object {
         struct lu_object_header mot_header;
@@ -204,8 +219,17 @@ struct mdt_object {
         int                     mot_writecount;
         /* Lock to protect object's IO epoch. */
 	struct mutex		mot_ioepoch_mutex;
+	/* Lazy size of the current write session, under mot_ioepoch_mutex.
+	 * A session starts with the first writer and ends with the last. */
+	__u64			mot_lsom_size;
+	int			mot_lsom_opens;
+	unsigned int		mot_lsom_exact:1,
+				/* lazy size may be cached on clients */
+				mot_lsom_cached:1;
         /* Lock to protect create_data */
 	struct mutex		mot_lov_mutex;
+	/* DoM body is frozen for a migration to OSTs, see mdt_dom_write() */
+	__u64			mot_dom_cookie;
 };
 
 enum mdt_object_flags {
@@ -739,6 +763,13 @@ int mdt_object_is_som_enabled(struct mdt_object *mo);
 int mdt_write_get(struct mdt_object *o);
 void mdt_write_put(struct mdt_object *o);
 int mdt_write_read(struct mdt_object *o);
+void mdt_lsom_open(struct mdt_thread_info *info, struct mdt_object *o,
+		   int created);
+void mdt_lsom_truncate(struct mdt_thread_info *info, struct mdt_object *o,
+		       __u64 size, int open_trunc);
+void mdt_lsom_invalidate(struct mdt_thread_info *info, struct mdt_object *o);
+void mdt_lsom_pack(struct mdt_thread_info *info, struct mdt_object *o,
+		   struct mdt_body *b);
 struct mdt_file_data *mdt_mfd_new(void);
 int mdt_mfd_close(struct mdt_thread_info *info, struct mdt_file_data *mfd);
 void mdt_mfd_free(struct mdt_file_data *mfd);
@@ -776,6 +807,7 @@ int mdt_get_info(struct mdt_thread_info *info);
 int mdt_getstatus(struct mdt_thread_info *info);
 int mdt_getattr(struct mdt_thread_info *info);
 int mdt_getattr_name(struct mdt_thread_info *info);
+int mdt_batch_getattr(struct mdt_thread_info *info);
 int mdt_statfs(struct mdt_thread_info *info);
 int mdt_reint(struct mdt_thread_info *info);
 int mdt_sync(struct mdt_thread_info *info);
@@ -803,8 +835,13 @@ extern struct mdt_opc_slice mdt_fld_handlers[];
 int mdt_quotacheck(struct mdt_thread_info *info);
 int mdt_quotactl(struct mdt_thread_info *info);
 int mdt_quota_dqacq(struct mdt_thread_info *info);
+int mdt_quota_dqacq_batch(struct mdt_thread_info *info);
 int mdt_swap_layouts(struct mdt_thread_info *info);
 
+/* mdt_io.c */
+int mdt_dom_read(struct mdt_thread_info *info);
+int mdt_dom_write(struct mdt_thread_info *info);
+
 extern struct lprocfs_vars lprocfs_mds_module_vars[];
 extern struct lprocfs_vars lprocfs_mds_obd_vars[];
 
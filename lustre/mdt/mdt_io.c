@@ -0,0 +1,501 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.sun.com/software/products/lustre/docs/GPLv2.pdf
+ *
+ * Please contact Sun Microsystems, Inc., 4150 Network Circle, Santa Clara,
+ * CA 95054 USA or visit www.sun.com if you need additional information or
+ * have any questions.
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2013, Intel Corporation.
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ * Lustre is a trademark of Sun Microsystems, Inc.
+ *
+ * lustre/mdt/mdt_io.c
+ *
+ * Data-on-MDT I/O: the body of a file with LOV_PATTERN_MDT layout is kept in
+ * the MDT inode and moved by MDS_DOM_READ/MDS_DOM_WRITE bulk RPCs.
+ *
+ * The request mdt_body carries the file offset in ->size, the byte count in
+ * ->nlink and MDS_DOM_FL_* in ->flags. The reply mdt_body returns the file
+ * size in ->size and the number of bytes transferred in ->nlink.
+ *
+ * A file is moved to OSTs in two MDS_DOM_FL_MIGRATE writes. The first one
+ * freezes the body and returns a cookie in ->ioepoch. The client copies the
+ * body into a volatile file with OST objects, then the second one, with the
+ * volatile file in ->fid2 and the cookie, swaps the layouts of both files
+ * and frees the body. The file keeps its DoM layout until then.
+ */
+
+#define DEBUG_SUBSYSTEM S_MDS
+
+#include "mdt_internal.h"
+
+/**
+ * Check whether \a o has a Data-on-MDT layout.
+ *
+ * \retval DoM size limit of the file
+ * \retval 0 if the file is striped over OSTs or has no layout
+ * \retval negative errno on failure
+ */
+static int mdt_dom_limit(struct mdt_thread_info *info, struct mdt_object *o)
+{
+	struct lov_mds_md_v3	 lmm;
+	struct lu_buf		*buf;
+	int			 rc;
+
+	buf = mdt_buf(info->mti_env, &lmm, sizeof(lmm));
+	rc = mo_xattr_get(info->mti_env, mdt_object_child(o), buf,
+			  XATTR_NAME_LOV);
+	/* striped layouts do not fit into a stripeless EA */
+	if (rc == -ERANGE || rc == -ENODATA)
+		return 0;
+	if (rc < 0)
+		return rc;
+	if (rc < sizeof(struct lov_mds_md_v1))
+		return -EINVAL;
+
+	if (le32_to_cpu(lmm.lmm_pattern) != LOV_PATTERN_MDT)
+		return 0;
+
+	return le32_to_cpu(lmm.lmm_stripe_size);
+}
+
+static void mdt_dom_pages_free(struct page **pages, int npages)
+{
+	int i;
+
+	for (i = 0; i < npages; i++)
+		if (pages[i] != NULL)
+			cfs_free_page(pages[i]);
+	OBD_FREE(pages, npages * sizeof(pages[0]));
+}
+
+static struct page **mdt_dom_pages_alloc(int npages)
+{
+	struct page	**pages;
+	int		  i;
+
+	OBD_ALLOC(pages, npages * sizeof(pages[0]));
+	if (pages == NULL)
+		return NULL;
+
+	for (i = 0; i < npages; i++) {
+		pages[i] = cfs_alloc_page(CFS_ALLOC_STD | CFS_ALLOC_ZERO);
+		if (pages[i] == NULL) {
+			mdt_dom_pages_free(pages, npages);
+			return NULL;
+		}
+	}
+	return pages;
+}
+
+/* Move @count bytes between the client and @pages */
+static int mdt_dom_bulk(struct mdt_thread_info *info, struct page **pages,
+			int npages, int count, int type)
+{
+	struct ptlrpc_request	*req = mdt_info_req(info);
+	struct ptlrpc_bulk_desc	*desc;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	desc = ptlrpc_prep_bulk_exp(req, npages, 1, type, MDS_BULK_PORTAL);
+	if (desc == NULL)
+		RETURN(-ENOMEM);
+
+	for (i = 0; i < npages && count > 0; i++) {
+		int len = min_t(int, count, CFS_PAGE_SIZE);
+
+		ptlrpc_prep_bulk_page_pin(desc, pages[i], 0, len);
+		count -= len;
+	}
+
+	rc = target_bulk_io(req->rq_export, desc,
+			    &info->mti_u.rdpg.mti_wait_info);
+	ptlrpc_free_bulk_pin(desc);
+	RETURN(rc);
+}
+
+int mdt_dom_read(struct mdt_thread_info *info)
+{
+	struct mdt_object	*o = info->mti_object;
+	struct dt_object	*dt = mdt_obj2dt(o);
+	struct lu_attr		*la = &info->mti_attr.ma_attr;
+	struct mdt_lock_handle	*lh = &info->mti_lh[MDT_LH_NEW];
+	struct mdt_body		*reqbody = info->mti_body;
+	struct mdt_body		*repbody;
+	struct page		**pages;
+	loff_t			 pos = reqbody->size;
+	int			 count = reqbody->nlink;
+	int			 npages;
+	int			 nob = 0;
+	int			 limit;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	repbody = req_capsule_server_get(info->mti_pill, &RMF_MDT_BODY);
+	if (repbody == NULL)
+		RETURN(err_serious(-EFAULT));
+
+	if (mdt_object_remote(o) || !S_ISREG(lu_object_attr(&o->mot_obj.mo_lu)))
+		RETURN(-EINVAL);
+
+	if (count <= 0 || count > LOV_MAX_DOM_SIZE || pos < 0)
+		RETURN(-EINVAL);
+
+	if (req_capsule_get_size(info->mti_pill, &RMF_CAPA1, RCL_CLIENT))
+		mdt_set_capainfo(info, 0, &reqbody->fid1,
+				 req_capsule_client_get(info->mti_pill,
+							&RMF_CAPA1));
+
+	npages = (count + CFS_PAGE_SIZE - 1) >> CFS_PAGE_SHIFT;
+	pages = mdt_dom_pages_alloc(npages);
+	if (pages == NULL)
+		RETURN(-ENOMEM);
+
+	mdt_lock_reg_init(lh, LCK_PR);
+	rc = mdt_object_lock(info, o, lh, MDS_INODELOCK_DOM, MDT_LOCAL_LOCK);
+	if (rc < 0)
+		GOTO(out_pages, rc);
+
+	limit = mdt_dom_limit(info, o);
+	if (limit < 0)
+		GOTO(out_unlock, rc = limit);
+	/* the client has a stale layout */
+	if (limit == 0)
+		GOTO(out_unlock, rc = -ESTALE);
+
+	rc = dt_attr_get(info->mti_env, dt, la, BYPASS_CAPA);
+	if (rc < 0)
+		GOTO(out_unlock, rc);
+
+	for (i = 0; i < npages && pos < la->la_size; i++) {
+		struct lu_buf	*buf;
+		int		 len;
+
+		len = min_t(loff_t, CFS_PAGE_SIZE, la->la_size - pos);
+		len = min(len, count - nob);
+		buf = mdt_buf(info->mti_env, cfs_kmap(pages[i]), len);
+		rc = dt_read(info->mti_env, dt, buf, &pos);
+		cfs_kunmap(pages[i]);
+		if (rc < 0)
+			GOTO(out_unlock, rc);
+		nob += rc;
+		if (rc < len)
+			break;
+	}
+
+	/* the client waits for the whole buffer, the tail is zeroed */
+	rc = mdt_dom_bulk(info, pages, npages, count, BULK_PUT_SOURCE);
+	if (rc == 0) {
+		repbody->size = la->la_size;
+		repbody->nlink = nob;
+	}
+	EXIT;
+out_unlock:
+	mdt_object_unlock(info, o, lh, rc);
+out_pages:
+	mdt_dom_pages_free(pages, npages);
+	return rc;
+}
+
+static __u64 mdt_dom_cookie(struct mdt_device *mdt)
+{
+	__u64 cookie;
+
+	spin_lock(&mdt->mdt_ioepoch_lock);
+	cookie = ++mdt->mdt_dom_cookie;
+	spin_unlock(&mdt->mdt_ioepoch_lock);
+	return cookie;
+}
+
+/**
+ * Give the DoM file \a o the layout of the volatile file \a fid, which
+ * holds a copy of its body on OSTs. The OST objects are given to the owner
+ * of \a o first, for quota.
+ */
+static int mdt_dom_swap(struct mdt_thread_info *info, struct mdt_object *o,
+			const struct lu_fid *fid)
+{
+	const struct lu_env	*env = info->mti_env;
+	struct mdt_lock_handle	*lh = &info->mti_lh[MDT_LH_OLD];
+	struct md_attr		*ma = &info->mti_attr;
+	struct lu_ucred		*uc = mdt_ucred(info);
+	struct mdt_object	*vo;
+	cfs_cap_t		 cap;
+	int			 rc;
+	ENTRY;
+
+	if (lu_fid_eq(fid, mdt_object_fid(o)))
+		RETURN(-EINVAL);
+
+	vo = mdt_object_find(env, info->mti_mdt, fid);
+	if (IS_ERR(vo))
+		RETURN(PTR_ERR(vo));
+
+	if (mdt_object_remote(vo) || !mdt_object_exists(vo) ||
+	    !S_ISREG(lu_object_attr(&vo->mot_obj.mo_lu)))
+		GOTO(put, rc = -EINVAL);
+
+	rc = mo_permission(env, NULL, mdt_object_child(vo), NULL, MAY_WRITE);
+	if (rc < 0)
+		GOTO(put, rc);
+
+	mdt_lock_reg_init(lh, LCK_EX);
+	rc = mdt_object_lock(info, vo, lh, MDS_INODELOCK_LAYOUT,
+			     MDT_LOCAL_LOCK);
+	if (rc < 0)
+		GOTO(put, rc);
+
+	ma->ma_need = 0;
+	ma->ma_valid = 0;
+	rc = mo_attr_get(env, mdt_object_child(o), ma);
+	if (rc < 0)
+		GOTO(unlock, rc);
+
+	ma->ma_attr.la_valid = LA_UID | LA_GID;
+	ma->ma_attr_flags = 0;
+	cap = uc->uc_cap;
+	uc->uc_cap |= MD_CAP_TO_MASK(CFS_CAP_CHOWN);
+	rc = mo_attr_set(env, mdt_object_child(vo), ma);
+	uc->uc_cap = cap;
+	if (rc < 0)
+		GOTO(unlock, rc);
+
+	rc = mo_swap_layouts(env, mdt_object_child(o), mdt_object_child(vo),
+			     0);
+	EXIT;
+unlock:
+	mdt_object_unlock(info, vo, lh, rc);
+put:
+	mdt_object_put(env, vo);
+	CDEBUG(D_INODE, "migrate DoM file "DFID" to the layout of "DFID
+	       ": rc = %d\n", PFID(mdt_object_fid(o)), PFID(fid), rc);
+	return rc;
+}
+
+/*
+ * A resent write was done by the original request, only its reply is
+ * rebuilt: writing again would append the data twice.
+ */
+static void mdt_dom_reconstruct(struct mdt_thread_info *info,
+				struct mdt_lock_handle *lhc)
+{
+	struct ptlrpc_request	*req = mdt_info_req(info);
+	struct lu_attr		*la = &info->mti_attr.ma_attr;
+	struct mdt_body		*repbody;
+
+	mdt_reconstruct_generic(info, lhc);
+	if (req->rq_status != 0)
+		return;
+
+	repbody = req_capsule_server_get(info->mti_pill, &RMF_MDT_BODY);
+	if (dt_attr_get(info->mti_env, mdt_obj2dt(info->mti_object), la,
+			BYPASS_CAPA) == 0)
+		repbody->size = la->la_size;
+	repbody->nlink = info->mti_body->nlink;
+}
+
+int mdt_dom_write(struct mdt_thread_info *info)
+{
+	const struct lu_env	*env = info->mti_env;
+	struct mdt_device	*mdt = info->mti_mdt;
+	struct mdt_object	*o = info->mti_object;
+	struct dt_object	*dt = mdt_obj2dt(o);
+	struct lu_attr		*la = &info->mti_attr.ma_attr;
+	struct mdt_lock_handle	*lh = &info->mti_lh[MDT_LH_NEW];
+	struct mdt_body		*reqbody = info->mti_body;
+	struct mdt_body		*repbody;
+	struct page		**pages = NULL;
+	struct thandle		*th;
+	__u32			 flags = reqbody->flags;
+	__u64			 bits = MDS_INODELOCK_DOM | MDS_INODELOCK_UPDATE;
+	loff_t			 pos = reqbody->size;
+	loff_t			 off;
+	int			 count = reqbody->nlink;
+	int			 npages = 0;
+	int			 limit;
+	int			 i;
+	int			 rc;
+	ENTRY;
+
+	info->mti_fail_id = OBD_FAIL_MDS_DOM_WRITE_NET_REP;
+	repbody = req_capsule_server_get(info->mti_pill, &RMF_MDT_BODY);
+	if (repbody == NULL)
+		RETURN(err_serious(-EFAULT));
+
+	if (mdt_object_remote(o) || !S_ISREG(lu_object_attr(&o->mot_obj.mo_lu)))
+		RETURN(-EINVAL);
+
+	if (count < 0 || count > LOV_MAX_DOM_SIZE || pos < 0)
+		RETURN(-EINVAL);
+	/* data and control requests are not mixed */
+	if ((count > 0) == !!(flags & (MDS_DOM_FL_PUNCH | MDS_DOM_FL_MIGRATE)))
+		RETURN(-EINVAL);
+	if ((flags & MDS_DOM_FL_PUNCH) && (flags & MDS_DOM_FL_MIGRATE))
+		RETURN(-EINVAL);
+
+	if (req_capsule_get_size(info->mti_pill, &RMF_CAPA1, RCL_CLIENT))
+		mdt_set_capainfo(info, 0, &reqbody->fid1,
+				 req_capsule_client_get(info->mti_pill,
+							&RMF_CAPA1));
+
+	if (count > 0) {
+		npages = (count + CFS_PAGE_SIZE - 1) >> CFS_PAGE_SHIFT;
+		pages = mdt_dom_pages_alloc(npages);
+		if (pages == NULL)
+			RETURN(-ENOMEM);
+	}
+
+	if (mdt_check_resent(info, mdt_dom_reconstruct, NULL)) {
+		rc = lustre_msg_get_status(mdt_info_req(info)->rq_repmsg);
+		/* the client waits until its data is pulled, it is dropped */
+		if (rc == 0 && count > 0)
+			rc = mdt_dom_bulk(info, pages, npages, count,
+					  BULK_GET_SINK);
+		GOTO(out_pages, rc);
+	}
+
+	if (flags & MDS_DOM_FL_MIGRATE && !fid_is_zero(&reqbody->fid2)) {
+		/* the size goes with the layout */
+		mdt_lsom_invalidate(info, o);
+		bits |= MDS_INODELOCK_LAYOUT;
+	}
+	mdt_lock_reg_init(lh, LCK_EX);
+	rc = mdt_object_lock(info, o, lh, bits, MDT_LOCAL_LOCK);
+	if (rc < 0)
+		GOTO(out_pages, rc);
+
+	limit = mdt_dom_limit(info, o);
+	if (limit < 0)
+		GOTO(out_unlock, rc = limit);
+	/* the client has a stale layout */
+	if (limit == 0)
+		GOTO(out_unlock, rc = -ESTALE);
+
+	if (flags & MDS_DOM_FL_MIGRATE && fid_is_zero(&reqbody->fid2)) {
+		/* concurrent migrations share the cookie, they copy the
+		 * same body */
+		if (o->mot_dom_cookie == 0)
+			o->mot_dom_cookie = mdt_dom_cookie(mdt);
+		repbody->ioepoch = o->mot_dom_cookie;
+		GOTO(out_unlock, rc = 0);
+	} else if (flags & MDS_DOM_FL_MIGRATE) {
+		/* the body was changed or the cookie lost with the object
+		 * since the copy was started */
+		if (reqbody->ioepoch == 0 ||
+		    reqbody->ioepoch != o->mot_dom_cookie)
+			GOTO(out_unlock, rc = -ESTALE);
+		rc = mdt_init_ucred(info, reqbody);
+		if (rc < 0)
+			GOTO(out_unlock, rc);
+		rc = mdt_dom_swap(info, o, &reqbody->fid2);
+		mdt_exit_ucred(info);
+		if (rc < 0)
+			GOTO(out_unlock, rc);
+		o->mot_dom_cookie = 0;
+		/* the old body is freed now, a failure leaves it unused */
+		flags |= MDS_DOM_FL_PUNCH;
+		pos = 0;
+	} else if (o->mot_dom_cookie != 0) {
+		/* a writer joins the migration, a truncate cancels it */
+		if (count > 0)
+			GOTO(out_unlock, rc = -EFBIG);
+		o->mot_dom_cookie = 0;
+	}
+
+	rc = dt_attr_get(env, dt, la, BYPASS_CAPA);
+	if (rc < 0)
+		GOTO(out_unlock, rc);
+
+	if (flags & MDS_DOM_FL_APPEND)
+		pos = la->la_size;
+	if (count > 0 && pos + count > limit)
+		GOTO(out_unlock, rc = -EFBIG);
+
+	if (count > 0) {
+		rc = mdt_dom_bulk(info, pages, npages, count, BULK_GET_SINK);
+		if (rc < 0)
+			GOTO(out_unlock, rc);
+	}
+
+	la->la_valid = LA_MTIME | LA_CTIME;
+	la->la_mtime = la->la_ctime = cfs_time_current_sec();
+
+	th = dt_trans_create(env, mdt->mdt_bottom);
+	if (IS_ERR(th))
+		GOTO(out_unlock, rc = PTR_ERR(th));
+
+	/* the client does not keep DoM writes for replay */
+	th->th_sync = 1;
+	if (flags & MDS_DOM_FL_PUNCH) {
+		rc = dt_declare_punch(env, dt, pos, OBD_OBJECT_EOF, th);
+	} else {
+		for (i = 0, off = pos; i < npages && rc == 0; i++) {
+			int len = min_t(int, pos + count - off, CFS_PAGE_SIZE);
+
+			rc = dt_declare_record_write(env, dt, len, off, th);
+			off += len;
+		}
+	}
+	if (rc == 0)
+		rc = dt_declare_attr_set(env, dt, la, th);
+	if (rc < 0)
+		GOTO(out_stop, rc);
+
+	rc = dt_trans_start_local(env, mdt->mdt_bottom, th);
+	if (rc < 0)
+		GOTO(out_stop, rc);
+
+	if (flags & MDS_DOM_FL_PUNCH) {
+		if (pos < la->la_size)
+			rc = dt_punch(env, dt, pos, OBD_OBJECT_EOF, th,
+				      BYPASS_CAPA);
+	} else {
+		for (i = 0, off = pos; i < npages && rc == 0; i++) {
+			int len = min_t(int, pos + count - off, CFS_PAGE_SIZE);
+
+			rc = dt_record_write(env, dt,
+					     mdt_buf(env, cfs_kmap(pages[i]),
+						     len), &off, th);
+			cfs_kunmap(pages[i]);
+		}
+	}
+	if (rc == 0)
+		rc = dt_attr_set(env, dt, la, th, BYPASS_CAPA);
+	GOTO(out_stop, rc);
+out_stop:
+	dt_trans_stop(env, mdt->mdt_bottom, th);
+	if (rc == 0) {
+		rc = dt_attr_get(env, dt, la, BYPASS_CAPA);
+		repbody->size = la->la_size;
+		repbody->nlink = count;
+	}
+out_unlock:
+	mdt_object_unlock(info, o, lh, rc);
+out_pages:
+	if (pages != NULL)
+		mdt_dom_pages_free(pages, npages);
+	return rc;
+}
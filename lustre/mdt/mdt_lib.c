@@ -983,6 +983,16 @@ static int mdt_create_unpack(struct mdt_thread_info *info)
                         RETURN(-EFAULT);
         } else {
                 req_capsule_extend(pill, &RQF_MDS_REINT_CREATE_RMT_ACL);
+		/* the stripes of a directory from "lfs setdirstripe" */
+		if (S_ISDIR(attr->la_mode) &&
+		    req_capsule_get_size(pill, &RMF_EADATA, RCL_CLIENT) >=
+		    sizeof(struct lmv_user_md)) {
+			sp->u.sp_ea.eadata = req_capsule_client_get(pill,
+								&RMF_EADATA);
+			sp->u.sp_ea.eadatalen = req_capsule_get_size(pill,
+							&RMF_EADATA,
+							RCL_CLIENT);
+		}
         }
 
         rc = mdt_dlmreq_unpack(info);
@@ -660,7 +660,7 @@ static int lprocfs_rd_cos(char *page, char **start, off_t off,
         struct obd_device *obd = data;
         struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
 
-        return snprintf(page, count, "%u\n", mdt_cos_is_enabled(mdt));
+        return snprintf(page, count, "%u\n", mdt->mdt_opts.mo_cos);
 }
 
 static int lprocfs_wr_cos(struct file *file, const char *buffer,
@@ -673,10 +673,31 @@ static int lprocfs_wr_cos(struct file *file, const char *buffer,
         rc = lprocfs_write_helper(buffer, count, &val);
         if (rc)
                 return rc;
+        if (val < MDT_COS_OFF || val > MDT_COS_FINE)
+                return -EINVAL;
         mdt_enable_cos(mdt, val);
         return count;
 }
 
+static int lprocfs_rd_cos_stats(char *page, char **start, off_t off,
+				int count, int *eof, void *data)
+{
+	struct obd_device *obd = data;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	__u64		   forced, avoided;
+
+	spin_lock(&mdt->mdt_lut.lut_translock);
+	forced = mdt->mdt_cos_forced;
+	avoided = mdt->mdt_cos_avoided;
+	spin_unlock(&mdt->mdt_lut.lut_translock);
+
+	*eof = 1;
+	return snprintf(page, count,
+			"forced_commits: "LPU64"\n"
+			"avoided_commits: "LPU64"\n",
+			forced, avoided);
+}
+
 static int lprocfs_rd_root_squash(char *page, char **start, off_t off,
                                   int count, int *eof, void *data)
 {
@@ -1000,6 +1021,34 @@ static int lprocfs_wr_enable_remote_dir_gid(struct file *file,
 	return count;
 }
 
+static int lprocfs_rd_lazy_size(char *page, char **start, off_t off,
+				int count, int *eof, void *data)
+{
+	struct obd_device *obd = data;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	return snprintf(page, count, "%u\n", mdt->mdt_lsom_conf);
+}
+
+static int lprocfs_wr_lazy_size(struct file *file, const char *buffer,
+				unsigned long count, void *data)
+{
+	struct obd_device *obd = data;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	int val;
+	int rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0 || val > 1)
+		return -ERANGE;
+
+	mdt->mdt_lsom_conf = val;
+	return count;
+}
+
 static struct lprocfs_vars lprocfs_mdt_obd_vars[] = {
         { "uuid",                       lprocfs_rd_uuid,                 0, 0 },
         { "recovery_status",            lprocfs_obd_rd_recovery_status,  0, 0 },
@@ -1025,6 +1074,7 @@ static struct lprocfs_vars lprocfs_mdt_obd_vars[] = {
         { "sec_level",                  lprocfs_rd_sec_level,
                                         lprocfs_wr_sec_level,               0 },
         { "commit_on_sharing",          lprocfs_rd_cos, lprocfs_wr_cos, 0 },
+	{ "commit_on_sharing_stats",	lprocfs_rd_cos_stats,	  0, 0 },
         { "root_squash",                lprocfs_rd_root_squash,
                                         lprocfs_wr_root_squash,             0 },
         { "nosquash_nids",              lprocfs_rd_nosquash_nids,
@@ -1041,6 +1091,8 @@ static struct lprocfs_vars lprocfs_mdt_obd_vars[] = {
 					lprocfs_wr_enable_remote_dir,	    0},
 	{ "enable_remote_dir_gid",	lprocfs_rd_enable_remote_dir_gid,
 					lprocfs_wr_enable_remote_dir_gid,   0},
+	{ "lazy_size",			lprocfs_rd_lazy_size,
+					lprocfs_wr_lazy_size,		    0},
 	{ 0 }
 };
 
@@ -152,7 +152,11 @@ DEF_MDT_HDL(HABEO_CORPUS| HABEO_REFERO, MDS_HSM_STATE_SET,
 						mdt_hsm_state_set),
 DEF_MDT_HDL(HABEO_CORPUS| HABEO_REFERO, MDS_HSM_ACTION, mdt_hsm_action),
 DEF_MDT_HDL(HABEO_CORPUS| HABEO_REFERO, MDS_HSM_REQUEST, mdt_hsm_request),
-DEF_MDT_HDL(HABEO_CORPUS|HABEO_REFERO,	MDS_SWAP_LAYOUTS, mdt_swap_layouts)
+DEF_MDT_HDL(HABEO_CORPUS|HABEO_REFERO,	MDS_SWAP_LAYOUTS, mdt_swap_layouts),
+DEF_MDT_HDL(HABEO_CORPUS|HABEO_REFERO,	MDS_DOM_READ,	mdt_dom_read),
+DEF_MDT_HDL(HABEO_CORPUS|HABEO_REFERO|MUTABOR,
+				MDS_DOM_WRITE,	mdt_dom_write),
+DEF_MDT_HDL(HABEO_CORPUS,		MDS_BATCH_GETATTR, mdt_batch_getattr)
 };
 
 #define DEF_OBD_HDL(flags, name, fn)					\
@@ -206,6 +210,7 @@ DEF_SEC_HDL(0,				SEC_CTX_FINI,	  mdt_sec_ctx_handle)
 
 static struct mdt_handler mdt_quota_ops[] = {
 DEF_QUOTA_HDL(HABEO_REFERO,		QUOTA_DQACQ,	  mdt_quota_dqacq),
+DEF_QUOTA_HDL(0,			QUOTA_DQACQ_BATCH, mdt_quota_dqacq_batch),
 };
 
 struct mdt_opc_slice mdt_regular_handlers[] = {
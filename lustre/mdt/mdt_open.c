@@ -541,6 +541,249 @@ void mdt_write_put(struct mdt_object *o)
         EXIT;
 }
 
+/*
+ * Lazy size.
+ *
+ * The size and blocks of a regular file are kept in XATTR_NAME_LSOM, marked
+ * valid by the close of the last writer when the session was exact: one write
+ * open, a known size at its start and no truncate from others. The EA is
+ * invalidated by the first writer, so it never stays valid over a crash with
+ * the file open. Clients get a valid lazy size with an UPDATE lock, the first
+ * write open revokes it.
+ *
+ * All the EA updates are done under ->mot_ioepoch_mutex.
+ */
+static int mdt_lsom_get(struct mdt_thread_info *info, struct mdt_object *o,
+			struct lsom_attrs *lsa)
+{
+	struct lu_buf	*buf = &info->mti_buf;
+	int		 rc;
+
+	buf->lb_buf = info->mti_xattr_buf;
+	buf->lb_len = sizeof(info->mti_xattr_buf);
+	rc = mo_xattr_get(info->mti_env, mdt_object_child(o), buf,
+			  XATTR_NAME_LSOM);
+	if (rc < 0)
+		return rc;
+	if (rc < sizeof(*lsa))
+		return -ENODATA;
+
+	memcpy(lsa, info->mti_xattr_buf, sizeof(*lsa));
+	lustre_lsom_swab(lsa);
+	return 0;
+}
+
+static int mdt_lsom_set(struct mdt_thread_info *info, struct mdt_object *o,
+			struct lsom_attrs *lsa)
+{
+	struct lu_buf		*buf = &info->mti_buf;
+	struct lu_ucred		*uc = mdt_ucred(info);
+	struct lsom_attrs	*attrs;
+	cfs_cap_t		 cap;
+	int			 rc;
+
+	attrs = (struct lsom_attrs *)info->mti_xattr_buf;
+	CLASSERT(sizeof(info->mti_xattr_buf) >= sizeof(*attrs));
+	*attrs = *lsa;
+	lustre_lsom_swab(attrs);
+
+	buf->lb_buf = attrs;
+	buf->lb_len = sizeof(*attrs);
+
+	/* any writer updates the lazy size, not only the owner */
+	cap = uc->uc_cap;
+	uc->uc_cap |= MD_CAP_TO_MASK(CFS_CAP_FOWNER);
+	rc = mo_xattr_set(info->mti_env, mdt_object_child(o), buf,
+			  XATTR_NAME_LSOM, 0);
+	uc->uc_cap = cap;
+	if (rc)
+		CDEBUG(D_INODE, "lazy size update of "DFID" failed: rc = %d\n",
+		       PFID(mdt_object_fid(o)), rc);
+	return rc;
+}
+
+static inline int mdt_lsom_object(struct mdt_object *o)
+{
+	return mdt_object_exists(o) && !mdt_object_remote(o) &&
+	       S_ISREG(lu_object_attr(&o->mot_obj.mo_lu));
+}
+
+/* Revoke the lazy size cached on clients, call without any UPDATE lock on
+ * @o held. */
+static void mdt_lsom_revoke(struct mdt_thread_info *info, struct mdt_object *o)
+{
+	struct mdt_lock_handle *lh = &info->mti_lh[MDT_LH_CHILD];
+
+	mdt_lock_reg_init(lh, LCK_EX);
+	if (mdt_object_lock(info, o, lh, MDS_INODELOCK_UPDATE,
+			    MDT_LOCAL_LOCK) == 0)
+		mdt_object_unlock(info, o, lh, 1);
+}
+
+/* Clear LSOM_FL_VALID on disk, call under ->mot_ioepoch_mutex. */
+static void mdt_lsom_clear(struct mdt_thread_info *info, struct mdt_object *o,
+			   struct lsom_attrs *lsa)
+{
+	if (lsa->lsa_flags & LSOM_FL_VALID) {
+		lsa->lsa_flags &= ~LSOM_FL_VALID;
+		mdt_lsom_set(info, o, lsa);
+	}
+}
+
+/**
+ * Start or join the write session of @o, called after mdt_write_get().
+ */
+void mdt_lsom_open(struct mdt_thread_info *info, struct mdt_object *o,
+		   int created)
+{
+	struct lsom_attrs	lsa;
+	int			revoke = 0;
+	ENTRY;
+
+	if (!mdt_lsom_object(o))
+		RETURN_EXIT;
+
+	mutex_lock(&o->mot_ioepoch_mutex);
+	if (o->mot_writecount == 1) {
+		o->mot_lsom_opens = 0;
+		o->mot_lsom_exact = 0;
+		o->mot_lsom_size = 0;
+		if (created) {
+			o->mot_lsom_exact = 1;
+			o->mot_lsom_cached = 0;
+		} else if (mdt_lsom_get(info, o, &lsa) == 0) {
+			if (lsa.lsa_flags & LSOM_FL_VALID) {
+				o->mot_lsom_exact = 1;
+				o->mot_lsom_size = lsa.lsa_size;
+			}
+			mdt_lsom_clear(info, o, &lsa);
+		}
+	}
+	o->mot_lsom_opens++;
+	if (o->mot_lsom_cached) {
+		o->mot_lsom_cached = 0;
+		revoke = 1;
+	}
+	mutex_unlock(&o->mot_ioepoch_mutex);
+
+	if (revoke)
+		mdt_lsom_revoke(info, o);
+	EXIT;
+}
+
+/**
+ * End the write session of @o on the close of its last writer: store the
+ * size sent by the client and mark it valid if the session was exact.
+ */
+static void mdt_lsom_close(struct mdt_thread_info *info, struct mdt_object *o)
+{
+	struct md_attr		*ma = &info->mti_attr;
+	struct lu_attr		*la = &ma->ma_attr;
+	struct lsom_attrs	 lsa;
+	ENTRY;
+
+	if (!mdt_lsom_object(o))
+		RETURN_EXIT;
+
+	/* no size from the client on eviction or open replay */
+	if (!(ma->ma_valid & MA_INODE) ||
+	    (la->la_valid & (LA_SIZE | LA_BLOCKS)) != (LA_SIZE | LA_BLOCKS))
+		RETURN_EXIT;
+
+	mutex_lock(&o->mot_ioepoch_mutex);
+	if (o->mot_writecount == 0 && o->mot_lsom_opens == 1 &&
+	    o->mot_lsom_exact) {
+		memset(&lsa, 0, sizeof(lsa));
+		lsa.lsa_flags = LSOM_FL_VALID;
+		/* the client may not know the size of the stripes it did
+		 * not write to */
+		lsa.lsa_size = max(o->mot_lsom_size, la->la_size);
+		lsa.lsa_blocks = la->la_blocks;
+		if (mdt_lsom_set(info, o, &lsa) == 0)
+			CDEBUG(D_INODE, "lazy size "LPU64" of "DFID"\n",
+			       lsa.lsa_size, PFID(mdt_object_fid(o)));
+	}
+	o->mot_lsom_exact = 0;
+	mutex_unlock(&o->mot_ioepoch_mutex);
+	EXIT;
+}
+
+/**
+ * Invalidate the lazy size of @o, its data changed behind the writers.
+ * Call without any UPDATE lock on @o held.
+ */
+void mdt_lsom_invalidate(struct mdt_thread_info *info, struct mdt_object *o)
+{
+	struct lsom_attrs	lsa;
+	int			revoke;
+	ENTRY;
+
+	if (!mdt_lsom_object(o))
+		RETURN_EXIT;
+
+	mutex_lock(&o->mot_ioepoch_mutex);
+	o->mot_lsom_exact = 0;
+	if (o->mot_writecount == 0 && mdt_lsom_get(info, o, &lsa) == 0)
+		mdt_lsom_clear(info, o, &lsa);
+	revoke = o->mot_lsom_cached;
+	o->mot_lsom_cached = 0;
+	mutex_unlock(&o->mot_ioepoch_mutex);
+
+	if (revoke)
+		mdt_lsom_revoke(info, o);
+	EXIT;
+}
+
+/**
+ * Truncate of @o to @size. O_TRUNC of the only writer gives the exact size of
+ * the session, any other truncate invalidates the lazy size.
+ */
+void mdt_lsom_truncate(struct mdt_thread_info *info, struct mdt_object *o,
+		       __u64 size, int open_trunc)
+{
+	if (open_trunc && mdt_lsom_object(o)) {
+		mutex_lock(&o->mot_ioepoch_mutex);
+		if (o->mot_writecount == 1 && o->mot_lsom_opens == 1) {
+			o->mot_lsom_exact = 1;
+			o->mot_lsom_size = size;
+			mutex_unlock(&o->mot_ioepoch_mutex);
+			return;
+		}
+		mutex_unlock(&o->mot_ioepoch_mutex);
+	}
+	mdt_lsom_invalidate(info, o);
+}
+
+/**
+ * Pack the lazy size of @o into the reply body if it is valid and no writer
+ * has the file open. Call under a DLM UPDATE lock.
+ */
+void mdt_lsom_pack(struct mdt_thread_info *info, struct mdt_object *o,
+		   struct mdt_body *b)
+{
+	struct lsom_attrs	lsa;
+	int			rc = -ENODATA;
+
+	if (!info->mti_mdt->mdt_lsom_conf || !mdt_lsom_object(o))
+		return;
+
+	mutex_lock(&o->mot_ioepoch_mutex);
+	if (o->mot_writecount == 0) {
+		rc = mdt_lsom_get(info, o, &lsa);
+		if (rc == 0 && (lsa.lsa_flags & LSOM_FL_VALID))
+			o->mot_lsom_cached = 1;
+		else
+			rc = -ENODATA;
+	}
+	mutex_unlock(&o->mot_ioepoch_mutex);
+	if (rc)
+		return;
+
+	b->size = lsa.lsa_size;
+	b->blocks = lsa.lsa_blocks;
+	b->valid |= OBD_MD_FLLAZYSIZE | OBD_MD_FLLAZYBLOCKS;
+}
+
 static int mdt_write_deny(struct mdt_object *o)
 {
         int rc = 0;
@@ -707,6 +950,7 @@ static int mdt_mfd_open(struct mdt_thread_info *info, struct mdt_object *p,
                 if (rc == 0) {
                         mdt_ioepoch_open(info, o, created);
                         repbody->ioepoch = o->mot_ioepoch;
+			mdt_lsom_open(info, o, created);
                 }
         } else if (flags & MDS_FMODE_EXEC) {
 		/* if file is released, we can't deny write because we must
@@ -1753,6 +1997,8 @@ int mdt_mfd_close(struct mdt_thread_info *info, struct mdt_file_data *mfd)
         if ((mode & FMODE_WRITE) || (mode & MDS_FMODE_TRUNC)) {
                 mdt_write_put(o);
                 ret = mdt_ioepoch_close(info, o);
+		if (mode & FMODE_WRITE)
+			mdt_lsom_close(info, o);
         } else if (mode & MDS_FMODE_EXEC) {
                 mdt_write_allow(o);
         } else if (mode & MDS_FMODE_EPOCH) {
@@ -569,6 +569,9 @@ static int mdt_reint_setattr(struct mdt_thread_info *info,
                 mdt_mfd_close(info, mfd);
 	} else if ((ma->ma_valid & MA_INODE) && ma->ma_attr.la_valid) {
 		LASSERT((ma->ma_valid & MA_LOV) == 0);
+		if (ma->ma_attr.la_valid & LA_SIZE)
+			mdt_lsom_truncate(info, mo, ma->ma_attr.la_size,
+					  rr->rr_flags & MRF_OPEN_TRUNC);
                 rc = mdt_attr_set(info, mo, ma, rr->rr_flags);
                 if (rc)
                         GOTO(out_put, rc);
@@ -663,6 +666,99 @@ static int mdt_reint_create(struct mdt_thread_info *info,
 	RETURN(rc);
 }
 
+/* locks on the shards of a striped directory on other MDTs */
+struct mdt_shard_locks {
+	struct lustre_handle	*msl_lh;
+	int			 msl_count;
+};
+
+/*
+ * Take EX UPDATE locks on the shards of the striped directory \a o that live
+ * on other MDTs, so that no entry is created in them while the directory is
+ * checked for emptiness and destroyed, see mdd_dir_is_empty().
+ */
+static int mdt_dir_shards_lock(struct mdt_thread_info *info,
+			       struct mdt_object *o,
+			       struct mdt_shard_locks *msl)
+{
+	const struct lu_env	*env = info->mti_env;
+	struct lu_buf		*buf = &info->mti_buf;
+	struct lmv_stripe_md	*mea;
+	struct mdt_object	*shard;
+	struct lu_fid		 fid;
+	int			 size;
+	int			 rc;
+	int			 i;
+	ENTRY;
+
+	msl->msl_lh = NULL;
+	msl->msl_count = 0;
+	if (!S_ISDIR(lu_object_attr(&o->mot_obj.mo_lu)))
+		RETURN(0);
+
+	buf->lb_buf = NULL;
+	buf->lb_len = 0;
+	size = mo_xattr_get(env, mdt_object_child(o), buf, XATTR_NAME_LMV);
+	if (size == -ENODATA || size == 0)
+		RETURN(0);
+	if (size < 0)
+		RETURN(size);
+
+	OBD_ALLOC_LARGE(mea, size);
+	if (mea == NULL)
+		RETURN(-ENOMEM);
+	buf->lb_buf = mea;
+	buf->lb_len = size;
+	rc = mo_xattr_get(env, mdt_object_child(o), buf, XATTR_NAME_LMV);
+	if (rc != size)
+		GOTO(out, rc = rc < 0 ? rc : -EIO);
+	rc = 0;
+
+	if (size < lmv_stripe_md_size(le32_to_cpu(mea->mea_count)))
+		GOTO(out, rc = -EIO);
+	if (le32_to_cpu(mea->mea_count) <= 1)
+		GOTO(out, rc = 0);
+
+	msl->msl_count = le32_to_cpu(mea->mea_count) - 1;
+	OBD_ALLOC(msl->msl_lh, sizeof(msl->msl_lh[0]) * msl->msl_count);
+	if (msl->msl_lh == NULL) {
+		msl->msl_count = 0;
+		GOTO(out, rc = -ENOMEM);
+	}
+
+	for (i = 0; i < msl->msl_count && rc == 0; i++) {
+		fid_le_to_cpu(&fid, &mea->mea_ids[i + 1]);
+		shard = mdt_object_find(env, info->mti_mdt, &fid);
+		if (IS_ERR(shard))
+			GOTO(out, rc = PTR_ERR(shard));
+		/* a local shard is checked under the lock of the master */
+		if (mdt_object_remote(shard))
+			rc = mdt_remote_object_lock(info, shard,
+						    &msl->msl_lh[i], LCK_EX,
+						    MDS_INODELOCK_UPDATE);
+		mdt_object_put(env, shard);
+	}
+	EXIT;
+out:
+	OBD_FREE_LARGE(mea, size);
+	return rc;
+}
+
+static void mdt_dir_shards_unlock(struct mdt_shard_locks *msl)
+{
+	int i;
+
+	if (msl->msl_lh == NULL)
+		return;
+
+	for (i = 0; i < msl->msl_count; i++)
+		if (lustre_handle_is_used(&msl->msl_lh[i]))
+			ldlm_lock_decref(&msl->msl_lh[i], LCK_EX);
+	OBD_FREE(msl->msl_lh, sizeof(msl->msl_lh[0]) * msl->msl_count);
+	msl->msl_lh = NULL;
+	msl->msl_count = 0;
+}
+
 /*
  * VBR: save parent version in reply and child version getting by its name.
  * Version of child is getting and checking during its lookup. If
@@ -674,6 +770,7 @@ static int mdt_reint_unlink(struct mdt_thread_info *info,
         struct ptlrpc_request   *req = mdt_info_req(info);
         struct md_attr          *ma = &info->mti_attr;
         struct lu_fid           *child_fid = &info->mti_tmp_fid1;
+	struct mdt_shard_locks	 msl;
         struct mdt_object       *mp;
         struct mdt_object       *mc;
         struct mdt_lock_handle  *parent_lh;
@@ -827,6 +924,12 @@ static int mdt_reint_unlink(struct mdt_thread_info *info,
 		GOTO(put_child, rc);
 	}
 
+	rc = mdt_dir_shards_lock(info, mc, &msl);
+	if (rc != 0) {
+		mdt_dir_shards_unlock(&msl);
+		GOTO(unlock_child, rc);
+	}
+
         mdt_fail_write(info->mti_env, info->mti_mdt->mdt_bottom,
                        OBD_FAIL_MDS_REINT_UNLINK_WRITE);
         /* save version when object is locked */
@@ -841,6 +944,7 @@ static int mdt_reint_unlink(struct mdt_thread_info *info,
 
 	rc = mdo_unlink(info->mti_env, mdt_object_child(mp),
 			mdt_object_child(mc), lname, ma, no_name);
+	mdt_dir_shards_unlock(&msl);
 	if (rc == 0 && !lu_object_is_dying(&mc->mot_header))
 		rc = mdt_attr_get_complex(info, mc, ma);
 	if (rc == 0)
@@ -1119,6 +1223,7 @@ static int mdt_reint_rename(struct mdt_thread_info *info,
         struct mdt_object       *mtgtdir;
         struct mdt_object       *mold;
         struct mdt_object       *mnew = NULL;
+	struct mdt_shard_locks	 msl = { NULL, 0 };
         struct mdt_lock_handle  *lh_srcdirp;
         struct mdt_lock_handle  *lh_tgtdirp;
         struct mdt_lock_handle  *lh_oldp;
@@ -1286,6 +1391,11 @@ static int mdt_reint_rename(struct mdt_thread_info *info,
                 /* get and save version after locking */
                 mdt_version_get_save(info, mnew, 3);
                 mdt_set_capainfo(info, 3, new_fid, BYPASS_CAPA);
+
+		/* the target directory is destroyed if it is empty */
+		rc = mdt_dir_shards_lock(info, mnew, &msl);
+		if (rc != 0)
+			GOTO(out_unlock_new, rc);
         } else if (rc != -EREMOTE && rc != -ENOENT) {
                 GOTO(out_unlock_old, rc);
         } else {
@@ -1321,6 +1431,7 @@ static int mdt_reint_rename(struct mdt_thread_info *info,
 
         EXIT;
 out_unlock_new:
+	mdt_dir_shards_unlock(&msl);
         if (mnew)
                 mdt_object_unlock_put(info, mnew, lh_newp, rc);
 out_unlock_old:
@@ -1645,10 +1645,18 @@ void cl_req_attr_set(const struct lu_env *env, struct cl_req *req,
         LASSERT(!cfs_list_empty(&req->crq_pages));
         ENTRY;
 
-        /* Take any page to use as a model. */
-        page = cfs_list_entry(req->crq_pages.next, struct cl_page, cp_flight);
-
         for (i = 0; i < req->crq_nrobjs; ++i) {
+                struct cl_object *top = req->crq_o[i].ro_obj;
+
+                if (top == NULL)
+                        break;
+                /* Take any page of this object to use as a model. */
+                cfs_list_for_each_entry(page, &req->crq_pages, cp_flight) {
+                        if (cl_object_top(page->cp_obj) == top)
+                                break;
+                }
+                LASSERT(&page->cp_flight != &req->crq_pages);
+
                 cfs_list_for_each_entry(slice, &req->crq_layers, crs_linkage) {
                         const struct cl_page_slice *scan;
                         const struct cl_object     *obj;
@@ -93,6 +93,7 @@ int cl_object_header_init(struct cl_object_header *h)
                 INIT_RADIX_TREE(&h->coh_tree, GFP_ATOMIC);
                 CFS_INIT_LIST_HEAD(&h->coh_locks);
 		h->coh_page_bufsize = ALIGN(sizeof(struct cl_page), 8);
+		h->coh_page_kmem_index = -1;
         }
         RETURN(result);
 }
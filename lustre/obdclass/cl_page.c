@@ -273,10 +273,87 @@ int cl_page_gang_lookup(const struct lu_env *env, struct cl_object *obj,
 }
 EXPORT_SYMBOL(cl_page_gang_lookup);
 
+/*
+ * cl_page's are allocated from slab caches, one for each distinct size of
+ * cl_page plus slices (cl_object_header::coh_page_bufsize), as there are
+ * only a few of them (one per layering of the client stack). The caches are
+ * created on the first allocation of a given size, and the per-CPU object
+ * caches of the slab allocator serve as allocation magazines. Past
+ * CLP_MAX_KMEM sizes, generic kmalloc is used.
+ */
+#define CLP_MAX_KMEM	8
+
+static cfs_mem_cache_t	*cl_page_kmem_array[CLP_MAX_KMEM];
+static unsigned short	 cl_page_kmem_size_array[CLP_MAX_KMEM];
+static char		 cl_page_kmem_name[CLP_MAX_KMEM][24];
+static DEFINE_MUTEX(cl_page_kmem_mutex);
+
+static unsigned int cl_page_slab = 1;
+CFS_MODULE_PARM(cl_page_slab, "i", uint, 0644,
+		"allocate cl_page's from per-size slab caches");
+
+static int cl_page_kmem_index(struct cl_object_header *hdr)
+{
+	unsigned short size = hdr->coh_page_bufsize;
+	int idx = hdr->coh_page_kmem_index;
+
+	if (likely(idx >= 0))
+		return idx;
+
+	if (!cl_page_slab) {
+		hdr->coh_page_kmem_index = CLP_MAX_KMEM;
+		return CLP_MAX_KMEM;
+	}
+
+	mutex_lock(&cl_page_kmem_mutex);
+	for (idx = 0; idx < CLP_MAX_KMEM; idx++) {
+		if (cl_page_kmem_size_array[idx] == size)
+			break;
+
+		if (cl_page_kmem_array[idx] == NULL) {
+			snprintf(cl_page_kmem_name[idx],
+				 sizeof(cl_page_kmem_name[idx]),
+				 "cl_page_kmem-%u", size);
+			cl_page_kmem_array[idx] =
+				cfs_mem_cache_create(cl_page_kmem_name[idx],
+						     size, 0, 0);
+			if (cl_page_kmem_array[idx] == NULL) {
+				CWARN("Can't create cache for %u bytes "
+				      "cl_page's, use kmalloc\n", size);
+				idx = CLP_MAX_KMEM;
+				break;
+			}
+			cl_page_kmem_size_array[idx] = size;
+			break;
+		}
+	}
+	mutex_unlock(&cl_page_kmem_mutex);
+
+	hdr->coh_page_kmem_index = idx;
+	return idx;
+}
+
+static void cl_page_kmem_fini(void)
+{
+	int i;
+
+	for (i = 0; i < CLP_MAX_KMEM; i++) {
+		if (cl_page_kmem_array[i] == NULL)
+			break;
+		if (cfs_mem_cache_destroy(cl_page_kmem_array[i]) != 0)
+			CERROR("%s: cache still in use\n",
+			       cl_page_kmem_name[i]);
+		cl_page_kmem_array[i] = NULL;
+		cl_page_kmem_size_array[i] = 0;
+	}
+}
+
 static void cl_page_free(const struct lu_env *env, struct cl_page *page)
 {
         struct cl_object *obj  = page->cp_obj;
-	int pagesize = cl_object_header(obj)->coh_page_bufsize;
+	struct cl_object_header *hdr = cl_object_header(obj);
+	int pagesize = hdr->coh_page_bufsize;
+	int idx = hdr->coh_page_kmem_index;
 
         PASSERT(env, page, cfs_list_empty(&page->cp_batch));
         PASSERT(env, page, page->cp_owner == NULL);
@@ -299,7 +376,10 @@ static void cl_page_free(const struct lu_env *env, struct cl_page *page)
         lu_object_ref_del_at(&obj->co_lu, page->cp_obj_ref, "cl_page", page);
         cl_object_put(env, obj);
         lu_ref_fini(&page->cp_reference);
-        OBD_FREE(page, pagesize);
+	if (idx < CLP_MAX_KMEM)
+		OBD_SLAB_FREE(page, cl_page_kmem_array[idx], pagesize);
+	else
+		OBD_FREE(page, pagesize);
         EXIT;
 }
 
@@ -318,12 +398,18 @@ static struct cl_page *cl_page_alloc(const struct lu_env *env,
 		struct cl_object *o, pgoff_t ind, struct page *vmpage,
 		enum cl_page_type type)
 {
+	struct cl_object_header *hdr = cl_object_header(o);
 	struct cl_page          *page;
 	struct lu_object_header *head;
+	int			 idx;
 
 	ENTRY;
-	OBD_ALLOC_GFP(page, cl_object_header(o)->coh_page_bufsize,
-			CFS_ALLOC_IO);
+	idx = cl_page_kmem_index(hdr);
+	if (idx < CLP_MAX_KMEM)
+		OBD_SLAB_ALLOC_GFP(page, cl_page_kmem_array[idx],
+				   hdr->coh_page_bufsize, CFS_ALLOC_IO);
+	else
+		OBD_ALLOC_GFP(page, hdr->coh_page_bufsize, CFS_ALLOC_IO);
 	if (page != NULL) {
 		int result;
 		cfs_atomic_set(&page->cp_ref, 1);
@@ -1628,4 +1714,5 @@ int  cl_page_init(void)
 
 void cl_page_fini(void)
 {
+	cl_page_kmem_fini();
 }
@@ -69,6 +69,7 @@ struct llog_handle *llog_alloc_handle(void)
 
 	init_rwsem(&loghandle->lgh_lock);
 	spin_lock_init(&loghandle->lgh_hdr_lock);
+	mutex_init(&loghandle->lgh_hdr_mutex);
 	CFS_INIT_LIST_HEAD(&loghandle->u.phd.phd_entry);
 	cfs_atomic_set(&loghandle->lgh_refcount, 1);
 
@@ -169,6 +170,74 @@ out_err:
 }
 EXPORT_SYMBOL(llog_cancel_rec);
 
+/* Cancel \a num records of a plain log with a single header write.
+ * Entries of \a index which were not set in the bitmap are zeroed.
+ * Returns as llog_cancel_rec() */
+int llog_cancel_arr_rec(const struct lu_env *env,
+			struct llog_handle *loghandle, int num, int *index)
+{
+	struct llog_log_hdr	*llh = loghandle->lgh_hdr;
+	int			 i, cleared = 0, rc;
+
+	ENTRY;
+
+	spin_lock(&loghandle->lgh_hdr_lock);
+	for (i = 0; i < num; i++) {
+		if (index[i] == 0 ||
+		    !ext2_clear_bit(index[i], llh->llh_bitmap)) {
+			CDEBUG(D_RPCTRACE, "index %u already clear?\n",
+			       index[i]);
+			index[i] = 0;
+			continue;
+		}
+		llh->llh_count--;
+		cleared++;
+	}
+	if (cleared == 0) {
+		spin_unlock(&loghandle->lgh_hdr_lock);
+		RETURN(0);
+	}
+
+	if ((llh->llh_flags & LLOG_F_ZAP_WHEN_EMPTY) &&
+	    (llh->llh_count == 1) &&
+	    (loghandle->lgh_last_idx == (LLOG_BITMAP_BYTES * 8) - 1)) {
+		spin_unlock(&loghandle->lgh_hdr_lock);
+		rc = llog_destroy(env, loghandle);
+		if (rc < 0) {
+			CERROR("%s: can't destroy empty llog #"DOSTID
+			       "#%08x: rc = %d\n",
+			       loghandle->lgh_ctxt->loc_obd->obd_name,
+			       POSTID(&loghandle->lgh_id.lgl_oi),
+			       loghandle->lgh_id.lgl_ogen, rc);
+			GOTO(out_err, rc);
+		}
+		RETURN(1);
+	}
+	spin_unlock(&loghandle->lgh_hdr_lock);
+
+	rc = llog_write(env, loghandle, &llh->llh_hdr, NULL, 0, NULL, 0);
+	if (rc < 0) {
+		CERROR("%s: fail to write header for llog #"DOSTID
+		       "#%08x: rc = %d\n",
+		       loghandle->lgh_ctxt->loc_obd->obd_name,
+		       POSTID(&loghandle->lgh_id.lgl_oi),
+		       loghandle->lgh_id.lgl_ogen, rc);
+		GOTO(out_err, rc);
+	}
+	RETURN(0);
+out_err:
+	spin_lock(&loghandle->lgh_hdr_lock);
+	for (i = 0; i < num; i++) {
+		if (index[i] == 0)
+			continue;
+		ext2_set_bit(index[i], llh->llh_bitmap);
+		llh->llh_count++;
+	}
+	spin_unlock(&loghandle->lgh_hdr_lock);
+	return rc;
+}
+EXPORT_SYMBOL(llog_cancel_arr_rec);
+
 static int llog_read_header(const struct lu_env *env,
 			    struct llog_handle *handle,
 			    struct obd_uuid *uuid)
@@ -296,6 +365,26 @@ int llog_copy_handler(const struct lu_env *env,
 }
 EXPORT_SYMBOL(llog_copy_handler);
 
+/* The record runs over the buffer or its tail does not match the header.
+ * The tail of a swabbed record is swabbed by the type specific code, if at
+ * all, so both byte orders are accepted. */
+static int llog_rec_is_torn(struct llog_rec_hdr *rec, char *buf)
+{
+	struct llog_rec_tail *tail;
+
+	if ((char *)rec + rec->lrh_len > buf + LLOG_CHUNK_SIZE ||
+	    rec->lrh_len < LLOG_MIN_REC_SIZE)
+		return 1;
+
+	tail = (struct llog_rec_tail *)((char *)rec + rec->lrh_len -
+					sizeof(*tail));
+	if (tail->lrt_len == rec->lrh_len && tail->lrt_index == rec->lrh_index)
+		return 0;
+
+	return tail->lrt_len == __swab32(rec->lrh_len) &&
+	       tail->lrt_index == __swab32(rec->lrh_index) ? 0 : 1;
+}
+
 static int llog_process_thread(void *arg)
 {
 	struct llog_process_info	*lpi = arg;
@@ -381,6 +470,13 @@ repeat:
                                 GOTO(out, rc = -EINVAL);
                         }
 
+			/* never hand a torn record to the callback */
+			if (llog_rec_is_torn(rec, buf)) {
+				CWARN("invalid tail in llog record for "
+				      "index %d/%d\n", rec->lrh_index, index);
+				GOTO(out, rc = -EINVAL);
+			}
+
                         if (rec->lrh_index < index) {
                                 CDEBUG(D_OTHER, "skipping lrh_index %d\n",
                                        rec->lrh_index);
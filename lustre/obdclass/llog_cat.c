@@ -96,9 +96,12 @@ static int llog_cat_new_log(const struct lu_env *env,
 		RETURN(rc);
 	}
 
+	/* LLOG_F_RESERVE is on disk with the first header write, before any
+	 * record is appended by reserved slot */
 	rc = llog_init_handle(env, loghandle,
-                              LLOG_F_IS_PLAIN | LLOG_F_ZAP_WHEN_EMPTY,
-                              &cathandle->lgh_hdr->llh_tgtuuid);
+			      LLOG_F_IS_PLAIN | LLOG_F_ZAP_WHEN_EMPTY |
+			      (cathandle->lgh_reserve ? LLOG_F_RESERVE : 0),
+			      &cathandle->lgh_hdr->llh_tgtuuid);
         if (rc)
                 GOTO(out_destroy, rc);
 
@@ -324,6 +327,60 @@ static struct llog_handle *llog_cat_current_log(struct llog_handle *cathandle,
 	RETURN(loghandle);
 }
 
+/*
+ * Switch a plain log to reserved-slot append once a record has been written
+ * to it under the exclusive lock, so lgh_write_offset is known to be valid.
+ * Only the OSD backend supports it, and only the logs created with
+ * LLOG_F_RESERVE so that all readers know to check for unwritten slots.
+ */
+static inline void llog_cat_set_reserve(struct llog_handle *cathandle,
+					struct llog_handle *loghandle)
+{
+	if (cathandle->lgh_reserve && loghandle->lgh_obj != NULL &&
+	    loghandle->lgh_hdr->llh_flags & LLOG_F_RESERVE)
+		loghandle->lgh_reserve = 1;
+}
+
+/*
+ * Append a record to the current plain log of a catalog in reserved-slot
+ * mode. Both the catalog and the plain log are only read-locked, so appends
+ * from many threads run in parallel: the plain log hands out record slots
+ * under lgh_hdr_lock and only the header write is serialized.
+ *
+ * Returns -EAGAIN if the locked path has to be used: no current log yet,
+ * the log is not in reserved mode or it is full.
+ */
+static int llog_cat_add_rec_reserve(const struct lu_env *env,
+				    struct llog_handle *cathandle,
+				    struct llog_rec_hdr *rec,
+				    struct llog_cookie *reccookie,
+				    struct thandle *th)
+{
+	struct llog_handle	*loghandle;
+	int			 rc;
+
+	down_read_nested(&cathandle->lgh_lock, LLOGH_CAT);
+	loghandle = cathandle->u.chd.chd_current_log;
+	if (loghandle == NULL) {
+		up_read(&cathandle->lgh_lock);
+		return -EAGAIN;
+	}
+	down_read_nested(&loghandle->lgh_lock, LLOGH_LOG);
+	up_read(&cathandle->lgh_lock);
+
+	if (!loghandle->lgh_reserve || !llog_exist(loghandle)) {
+		rc = -EAGAIN;
+	} else {
+		rc = llog_write_rec(env, loghandle, rec, reccookie, 1, NULL,
+				    -1, th);
+		if (rc == -ENOSPC)
+			rc = -EAGAIN;
+	}
+	up_read(&loghandle->lgh_lock);
+
+	return rc;
+}
+
 /* Add a single record to the recovery log(s) using a catalog
  * Returns as llog_write_record
  *
@@ -338,6 +395,13 @@ int llog_cat_add_rec(const struct lu_env *env, struct llog_handle *cathandle,
         ENTRY;
 
         LASSERT(rec->lrh_len <= LLOG_CHUNK_SIZE);
+	if (cathandle->lgh_reserve && buf == NULL) {
+		rc = llog_cat_add_rec_reserve(env, cathandle, rec, reccookie,
+					      th);
+		if (rc != -EAGAIN)
+			RETURN(rc);
+	}
+
 	loghandle = llog_cat_current_log(cathandle, th);
 	LASSERT(!IS_ERR(loghandle));
 
@@ -354,6 +418,8 @@ int llog_cat_add_rec(const struct lu_env *env, struct llog_handle *cathandle,
 	if (rc < 0)
 		CDEBUG_LIMIT(rc == -ENOSPC ? D_HA : D_ERROR,
 			     "llog_write_rec %d: lh=%p\n", rc, loghandle);
+	else
+		llog_cat_set_reserve(cathandle, loghandle);
 	up_write(&loghandle->lgh_lock);
         if (rc == -ENOSPC) {
 		/* try to use next log */
@@ -372,6 +438,8 @@ int llog_cat_add_rec(const struct lu_env *env, struct llog_handle *cathandle,
 				    -1, th);
 		if (rc < 0)
 			CERROR("llog_write_rec %d: lh=%p\n", rc, loghandle);
+		else
+			llog_cat_set_reserve(cathandle, loghandle);
 		up_write(&loghandle->lgh_lock);
 	}
 
@@ -637,6 +705,191 @@ int llog_cat_process(const struct lu_env *env, struct llog_handle *cat_llh,
 }
 EXPORT_SYMBOL(llog_cat_process);
 
+#define LLOG_PURGE_BATCH	512
+
+struct llog_purge_data {
+	llog_cb_t		 lpg_cb;
+	void			*lpg_data;
+	int			*lpg_index;
+	int			 lpg_count;
+	int			 lpg_kept;
+	__u64			 lpg_cancelled;
+	int			 lpg_destroyed;
+};
+
+static int llog_purge_flush(const struct lu_env *env,
+			    struct llog_handle *loghandle,
+			    struct llog_purge_data *lpg)
+{
+	int i, rc;
+
+	if (lpg->lpg_count == 0)
+		return 0;
+
+	rc = llog_cancel_arr_rec(env, loghandle, lpg->lpg_count,
+				 lpg->lpg_index);
+	if (rc >= 0) {
+		for (i = 0; i < lpg->lpg_count; i++)
+			if (lpg->lpg_index[i] != 0)
+				lpg->lpg_cancelled++;
+	}
+	lpg->lpg_count = 0;
+	return rc;
+}
+
+static int llog_purge_rec_cb(const struct lu_env *env,
+			     struct llog_handle *loghandle,
+			     struct llog_rec_hdr *rec, void *data)
+{
+	struct llog_purge_data	*lpg = data;
+	int			 rc;
+
+	rc = lpg->lpg_cb(env, loghandle, rec, lpg->lpg_data);
+	if (rc == LLOG_KEEP_RECORD) {
+		/* records are not strictly ordered, a later one may go */
+		lpg->lpg_kept++;
+		return 0;
+	}
+	if (rc) {
+		lpg->lpg_kept++;
+		return rc;
+	}
+
+	/* flush before adding this record, so the log is never emptied
+	 * and destroyed under llog_process() */
+	if (lpg->lpg_count == LLOG_PURGE_BATCH) {
+		rc = llog_purge_flush(env, loghandle, lpg);
+		if (rc < 0)
+			return rc;
+	}
+	lpg->lpg_index[lpg->lpg_count++] = rec->lrh_index;
+	return 0;
+}
+
+static int llog_purge_cat_cb(const struct lu_env *env,
+			     struct llog_handle *cathandle,
+			     struct llog_rec_hdr *rec, void *data)
+{
+	struct llog_purge_data	*lpg = data;
+	struct llog_logid_rec	*lir = (struct llog_logid_rec *)rec;
+	struct llog_handle	*loghandle;
+	struct llog_log_hdr	*llh;
+	int			 busy, rc, rc2;
+
+	ENTRY;
+
+	if (rec->lrh_type != LLOG_LOGID_MAGIC) {
+		CERROR("invalid record in catalog\n");
+		RETURN(-EINVAL);
+	}
+
+	rc = llog_cat_id2handle(env, cathandle, &loghandle, &lir->lid_id);
+	if (rc) {
+		CERROR("%s: cannot find handle for llog "DOSTID": %d\n",
+		       cathandle->lgh_ctxt->loc_obd->obd_name,
+		       POSTID(&lir->lid_id.lgl_oi), rc);
+		RETURN(rc);
+	}
+
+	down_read(&cathandle->lgh_lock);
+	busy = (loghandle == cathandle->u.chd.chd_current_log ||
+		loghandle == cathandle->u.chd.chd_next_log);
+	up_read(&cathandle->lgh_lock);
+
+	lpg->lpg_kept = 0;
+	rc = llog_process_or_fork(env, loghandle, llog_purge_rec_cb, lpg,
+				  NULL, false);
+	rc2 = llog_purge_flush(env, loghandle, lpg);
+	if (rc >= 0 && rc2 < 0)
+		rc = rc2;
+	if (rc < 0)
+		GOTO(out, rc);
+
+	llh = loghandle->lgh_hdr;
+	if (rc2 == 0 && !busy && lpg->lpg_kept == 0 && llh->llh_count == 1 &&
+	    (llh->llh_flags & LLOG_F_ZAP_WHEN_EMPTY)) {
+		/* not full, so llog_cancel_arr_rec() left it in place */
+		rc2 = llog_destroy(env, loghandle);
+		if (rc2 == 0)
+			rc2 = 1;
+		else
+			CERROR("%s: fail to destroy empty log: rc = %d\n",
+			       loghandle->lgh_ctxt->loc_obd->obd_name, rc2);
+	}
+	if (rc2 == 1) {
+		lpg->lpg_destroyed++;
+		rc = llog_cat_cleanup(env, cathandle, loghandle,
+				      loghandle->u.phd.phd_cookie.lgc_index);
+		if (rc)
+			GOTO(out, rc);
+	} else if (rc2 < 0) {
+		GOTO(out, rc = rc2);
+	}
+
+	/* records may still be added to the current log, and a log with
+	 * records left stops the walk, later logs mostly hold newer ones */
+	rc = (busy || lpg->lpg_kept > 0) ? LLOG_PROC_BREAK : 0;
+out:
+	llog_handle_put(loghandle);
+	RETURN(rc);
+}
+
+/**
+ * Cancel the oldest records of a catalog for which \a cb returns 0.
+ *
+ * Every record is checked, \a cb returns LLOG_KEEP_RECORD for one which must
+ * stay and LLOG_PROC_BREAK to stop. The walk ends with the first plain log
+ * which keeps any record. Records are cancelled in batches, with one header
+ * write per LLOG_PURGE_BATCH records, and emptied logs are destroyed.
+ */
+int llog_cat_purge(const struct lu_env *env, struct llog_handle *cathandle,
+		   llog_cb_t cb, void *data, __u64 *cancelled,
+		   int *destroyed)
+{
+	struct llog_log_hdr	*llh = cathandle->lgh_hdr;
+	struct llog_purge_data	 lpg = { 0 };
+	int			 rc;
+
+	ENTRY;
+
+	LASSERT(llh->llh_flags & LLOG_F_IS_CAT);
+
+	OBD_ALLOC(lpg.lpg_index, sizeof(int) * LLOG_PURGE_BATCH);
+	if (lpg.lpg_index == NULL)
+		RETURN(-ENOMEM);
+	lpg.lpg_cb = cb;
+	lpg.lpg_data = data;
+
+	if (llh->llh_cat_idx > cathandle->lgh_last_idx) {
+		struct llog_process_cat_data cd;
+
+		cd.lpcd_first_idx = llh->llh_cat_idx;
+		cd.lpcd_last_idx = 0;
+		rc = llog_process_or_fork(env, cathandle, llog_purge_cat_cb,
+					  &lpg, &cd, false);
+		if (rc == 0) {
+			cd.lpcd_first_idx = 0;
+			cd.lpcd_last_idx = cathandle->lgh_last_idx;
+			rc = llog_process_or_fork(env, cathandle,
+						  llog_purge_cat_cb, &lpg,
+						  &cd, false);
+		}
+	} else {
+		rc = llog_process_or_fork(env, cathandle, llog_purge_cat_cb,
+					  &lpg, NULL, false);
+	}
+	if (rc == LLOG_PROC_BREAK)
+		rc = 0;
+
+	if (cancelled != NULL)
+		*cancelled = lpg.lpg_cancelled;
+	if (destroyed != NULL)
+		*destroyed = lpg.lpg_destroyed;
+	OBD_FREE(lpg.lpg_index, sizeof(int) * LLOG_PURGE_BATCH);
+	RETURN(rc);
+}
+EXPORT_SYMBOL(llog_cat_purge);
+
 static int llog_cat_reverse_process_cb(const struct lu_env *env,
 				       struct llog_handle *cat_llh,
 				       struct llog_rec_hdr *rec, void *data)
@@ -317,6 +317,134 @@ static int llog_osd_declare_write_rec(const struct lu_env *env,
 	RETURN(rc);
 }
 
+/* lgh_reserve on a catalog only tells to put its plain logs in this mode */
+static inline int llog_osd_reserved(struct llog_handle *loghandle)
+{
+	return loghandle->lgh_reserve && loghandle->lgh_hdr != NULL &&
+	       loghandle->lgh_hdr->llh_flags & LLOG_F_IS_PLAIN;
+}
+
+/*
+ * Append a record in reserved-slot mode (see llog_cat_add_rec()).
+ *
+ * The record index and its offset in the log are reserved under lgh_hdr_lock
+ * from lgh_write_offset, so concurrent appenders never wait for each other to
+ * write their data; only the header write is serialized by lgh_hdr_mutex so
+ * that the last header written carries every bit set before it.
+ *
+ * Returns the record index or negative errno, -ENOSPC if the log is full.
+ */
+static int llog_osd_write_rec_reserve(const struct lu_env *env,
+				      struct llog_handle *loghandle,
+				      struct llog_rec_hdr *rec,
+				      struct thandle *th)
+{
+	struct llog_thread_info	*lgi = llog_info(env);
+	struct llog_log_hdr	*llh = loghandle->lgh_hdr;
+	struct dt_object	*o = loghandle->lgh_obj;
+	struct llog_rec_tail	*lrt;
+	int			 reclen = rec->lrh_len;
+	int			 index = 0, pad_idx = 0, rc, rc2;
+	loff_t			 off, rec_off = 0, pad_off = 0;
+	size_t			 left, pad_len = 0;
+
+	ENTRY;
+
+	spin_lock(&loghandle->lgh_hdr_lock);
+	if (loghandle->lgh_last_idx >= LLOG_BITMAP_SIZE(llh) - 1) {
+		spin_unlock(&loghandle->lgh_hdr_lock);
+		RETURN(-ENOSPC);
+	}
+	off = loghandle->lgh_write_offset;
+	left = LLOG_CHUNK_SIZE - (off & (LLOG_CHUNK_SIZE - 1));
+	if (left != 0 && left != reclen &&
+	    left < (reclen + LLOG_MIN_REC_SIZE)) {
+		pad_idx = ++loghandle->lgh_last_idx;
+		pad_off = off;
+		pad_len = left;
+		off += left;
+	}
+	if (loghandle->lgh_last_idx < LLOG_BITMAP_SIZE(llh) - 1) {
+		index = ++loghandle->lgh_last_idx;
+		if (ext2_set_bit(index, llh->llh_bitmap)) {
+			CERROR("%s: index %u already set in log bitmap\n",
+			       o->do_lu.lo_dev->ld_obd->obd_name, index);
+			spin_unlock(&loghandle->lgh_hdr_lock);
+			LBUG(); /* should never happen */
+		}
+		llh->llh_count++;
+		llh->llh_tail.lrt_index = index;
+		rec_off = off;
+		off += reclen;
+	}
+	loghandle->lgh_write_offset = off;
+	spin_unlock(&loghandle->lgh_hdr_lock);
+
+	/* NOTE: padding is a record, but no bit is set */
+	if (pad_len != 0) {
+		rc = llog_osd_pad(env, o, &pad_off, pad_len, pad_idx, th);
+		if (rc)
+			GOTO(out, rc);
+	}
+	if (index == 0)
+		RETURN(-ENOSPC);
+
+	rec->lrh_index = index;
+	lrt = (struct llog_rec_tail *)((char *)rec + reclen - sizeof(*lrt));
+	lrt->lrt_len = reclen;
+	lrt->lrt_index = index;
+
+	lgi->lgi_off = rec_off;
+	lgi->lgi_buf.lb_len = reclen;
+	lgi->lgi_buf.lb_buf = rec;
+	rc = dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off, th);
+	if (rc) {
+		CERROR("%s: error writing log record: rc = %d\n",
+		       o->do_lu.lo_dev->ld_obd->obd_name, rc);
+		GOTO(out, rc);
+	}
+
+	mutex_lock(&loghandle->lgh_hdr_mutex);
+	lgi->lgi_off = 0;
+	lgi->lgi_buf.lb_len = llh->llh_hdr.lrh_len;
+	lgi->lgi_buf.lb_buf = llh;
+	rc = dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off, th);
+	mutex_unlock(&loghandle->lgh_hdr_mutex);
+	if (rc)
+		CERROR("%s: error writing log header: rc = %d\n",
+		       o->do_lu.lo_dev->ld_obd->obd_name, rc);
+out:
+	if (rc == 0)
+		RETURN(index);
+	if (index == 0)
+		RETURN(rc);
+
+	/* the slot can't be given back as later records may already follow
+	 * it, so fill it with padding for readers to step over */
+	spin_lock(&loghandle->lgh_hdr_lock);
+	ext2_clear_bit(index, llh->llh_bitmap);
+	llh->llh_count--;
+	spin_unlock(&loghandle->lgh_hdr_lock);
+
+	rc2 = llog_osd_pad(env, o, &rec_off, reclen, index, th);
+	if (rc2 == 0) {
+		mutex_lock(&loghandle->lgh_hdr_mutex);
+		lgi->lgi_off = 0;
+		lgi->lgi_buf.lb_len = llh->llh_hdr.lrh_len;
+		lgi->lgi_buf.lb_buf = llh;
+		rc2 = dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off,
+				      th);
+		mutex_unlock(&loghandle->lgh_hdr_mutex);
+	}
+	if (rc2) {
+		/* leave the hole at the end of the log */
+		spin_lock(&loghandle->lgh_hdr_lock);
+		loghandle->lgh_last_idx = LLOG_BITMAP_SIZE(llh) - 1;
+		spin_unlock(&loghandle->lgh_hdr_lock);
+	}
+	RETURN(rc);
+}
+
 /* returns negative in on error; 0 if success && reccookie == 0; 1 otherwise */
 /* appends if idx == -1, otherwise overwrites record idx. */
 static int llog_osd_write_rec(const struct lu_env *env,
@@ -354,6 +482,13 @@ static int llog_osd_write_rec(const struct lu_env *env,
 	if (rc)
 		RETURN(rc);
 
+	if (idx == -1 && buf == NULL && llog_osd_reserved(loghandle)) {
+		index = llog_osd_write_rec_reserve(env, loghandle, rec, th);
+		if (index < 0)
+			RETURN(index);
+		GOTO(out, rc = 0);
+	}
+
 	rc = dt_attr_get(env, o, &lgi->lgi_attr, NULL);
 	if (rc)
 		RETURN(rc);
@@ -380,8 +515,10 @@ static int llog_osd_write_rec(const struct lu_env *env,
 			       rec->lrh_index);
 
 		lgi->lgi_off = 0;
+		mutex_lock(&loghandle->lgh_hdr_mutex);
 		rc = llog_osd_write_blob(env, o, &llh->llh_hdr, NULL,
 					 &lgi->lgi_off, th);
+		mutex_unlock(&loghandle->lgh_hdr_mutex);
 		/* we are done if we only write the header or on error */
 		if (rc || idx == 0)
 			RETURN(rc);
@@ -478,6 +615,8 @@ static int llog_osd_write_rec(const struct lu_env *env,
 	lgi->lgi_off = lgi->lgi_attr.la_size;
 
 	rc = llog_osd_write_blob(env, o, rec, buf, &lgi->lgi_off, th);
+	if (rc == 0)
+		loghandle->lgh_write_offset = lgi->lgi_off;
 
 out:
 	/* cleanup llog for error case */
@@ -526,6 +665,38 @@ static void llog_skip_over(__u64 *off, int curr, int goal)
 		~(LLOG_CHUNK_SIZE - 1);
 }
 
+/* The plain log may have records appended by reserved slots, through this
+ * handle or any other one, e.g. a remote reader or a handle opened after
+ * remount. */
+static inline int llog_osd_may_reserve(struct llog_handle *loghandle)
+{
+	return loghandle->lgh_hdr != NULL &&
+	       loghandle->lgh_hdr->llh_flags & LLOG_F_RESERVE;
+}
+
+/* A plain log in reserved-slot mode may have slots reserved but not written
+ * yet. Return the length of the leading run of complete records in buf. */
+static int llog_osd_valid_len(void *buf, int len)
+{
+	struct llog_rec_hdr	*rec;
+	struct llog_rec_tail	*tail;
+	int			 off = 0;
+
+	while (off + LLOG_MIN_REC_SIZE <= len) {
+		rec = (struct llog_rec_hdr *)((char *)buf + off);
+		if (rec->lrh_index == 0 || rec->lrh_len < LLOG_MIN_REC_SIZE ||
+		    rec->lrh_len > len - off)
+			break;
+		tail = (struct llog_rec_tail *)((char *)rec + rec->lrh_len -
+						sizeof(*tail));
+		if (tail->lrt_index != rec->lrh_index ||
+		    tail->lrt_len != rec->lrh_len)
+			break;
+		off += rec->lrh_len;
+	}
+	return off;
+}
+
 /* sets:
  *  - cur_offset to the furthest point read in the log file
  *  - cur_idx to the log index preceeding cur_offset
@@ -597,6 +768,16 @@ static int llog_osd_next_block(const struct lu_env *env,
 			GOTO(out, rc);
 		}
 
+		if (rc > 0 && llog_osd_may_reserve(loghandle) &&
+		    !LLOG_REC_HDR_NEEDS_SWABBING((struct llog_rec_hdr *)buf)) {
+			int valid = llog_osd_valid_len(buf, rc);
+
+			/* stop before a slot whose record is not written yet,
+			 * llog_process will come back for it */
+			*cur_offset -= rc - valid;
+			rc = valid;
+		}
+
 		if (rc < len) {
 			/* signal the end of the valid buffer to
 			 * llog_process */
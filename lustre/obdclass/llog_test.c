@@ -898,6 +898,186 @@ out:
 	RETURN(rc);
 }
 
+#define LLOG_TEST_8_THREADS	4
+
+struct llog_test_8_info {
+	struct llog_handle	*lti_cath;
+	cfs_atomic_t		 lti_running;
+	cfs_atomic_t		 lti_added;
+	int			 lti_count;
+	int			 lti_rc;
+	struct completion	 lti_done;
+};
+
+static int llog_test_8_thread(void *arg)
+{
+	struct llog_test_8_info	*lti = arg;
+	struct llog_mini_rec	 lmr;
+	struct lu_env		 env;
+	struct lu_context	 session;
+	int			 i, rc;
+
+	cfs_daemonize("llog_test_8");
+
+	rc = lu_env_init(&env, LCT_LOCAL | LCT_MG_THREAD);
+	if (rc)
+		GOTO(out, rc);
+	rc = lu_context_init(&session, LCT_SESSION);
+	if (rc)
+		GOTO(out_env, rc);
+	session.lc_thread = (struct ptlrpc_thread *)cfs_current();
+	lu_context_enter(&session);
+	env.le_ses = &session;
+
+	for (i = 0; i < lti->lti_count; i++) {
+		lmr.lmr_hdr.lrh_len = lmr.lmr_tail.lrt_len = LLOG_MIN_REC_SIZE;
+		lmr.lmr_hdr.lrh_type = 0xf00f00;
+		rc = llog_cat_add(&env, lti->lti_cath, &lmr.lmr_hdr, NULL,
+				  NULL);
+		if (rc < 0) {
+			CERROR("8: add record #%d failed: rc = %d\n", i, rc);
+			break;
+		}
+		cfs_atomic_inc(&lti->lti_added);
+		rc = 0;
+	}
+
+	lu_context_exit(&session);
+	lu_context_fini(&session);
+out_env:
+	lu_env_fini(&env);
+out:
+	if (rc)
+		lti->lti_rc = rc;
+	if (cfs_atomic_dec_and_test(&lti->lti_running))
+		complete(&lti->lti_done);
+	return rc;
+}
+
+static int test_8_cancel_cb(const struct lu_env *env, struct llog_handle *llh,
+			    struct llog_rec_hdr *rec, void *data)
+{
+	struct llog_cookie cookie;
+
+	cookie.lgc_lgl = llh->lgh_id;
+	cookie.lgc_index = rec->lrh_index;
+	llog_cat_cancel_records(env, llh->u.phd.phd_cat_handle, 1, &cookie);
+	plain_counter++;
+	return 0;
+}
+
+/* Append LLOG_TEST_RECNUM records to a catalog from several threads and
+ * report the rate, with the locked and the reserved-slot append */
+static int llog_test_8_sub(const struct lu_env *env, struct llog_ctxt *ctxt,
+			   char *test, int reserve)
+{
+	struct llog_test_8_info	 lti;
+	struct llog_handle	*cath;
+	cfs_time_t		 start;
+	cfs_duration_t		 elapsed;
+	int			 i, rc, rc2;
+
+	ENTRY;
+
+	rc = llog_open_create(env, ctxt, &cath, NULL, NULL);
+	if (rc) {
+		CERROR("%s: llog_create with name failed: %d\n", test, rc);
+		RETURN(rc);
+	}
+
+	rc = llog_init_handle(env, cath, LLOG_F_IS_CAT, &uuid);
+	if (rc) {
+		CERROR("%s: can't init llog handle: %d\n", test, rc);
+		GOTO(out, rc);
+	}
+	cath->lgh_reserve = reserve;
+
+	memset(&lti, 0, sizeof(lti));
+	lti.lti_cath = cath;
+	lti.lti_count = LLOG_TEST_RECNUM / LLOG_TEST_8_THREADS;
+	cfs_atomic_set(&lti.lti_running, LLOG_TEST_8_THREADS);
+	cfs_atomic_set(&lti.lti_added, 0);
+	init_completion(&lti.lti_done);
+
+	start = cfs_time_current();
+	for (i = 0; i < LLOG_TEST_8_THREADS; i++) {
+		rc = cfs_create_thread(llog_test_8_thread, &lti, 0);
+		if (rc < 0) {
+			CERROR("%s: can't start thread %d: rc = %d\n",
+			       test, i, rc);
+			lti.lti_rc = rc;
+			/* account for the threads which won't be started */
+			cfs_atomic_add(i - LLOG_TEST_8_THREADS + 1,
+				       &lti.lti_running);
+			if (cfs_atomic_dec_and_test(&lti.lti_running))
+				complete(&lti.lti_done);
+			break;
+		}
+	}
+	wait_for_completion(&lti.lti_done);
+	elapsed = cfs_time_sub(cfs_time_current(), start);
+	if (elapsed == 0)
+		elapsed = 1;
+
+	CWARN("%s: %d threads added %d records in %lu ms, %lu recs/s\n",
+	      test, LLOG_TEST_8_THREADS, cfs_atomic_read(&lti.lti_added),
+	      (unsigned long)cfs_duration_sec(elapsed * 1000),
+	      (unsigned long)cfs_atomic_read(&lti.lti_added) * CFS_HZ /
+	      elapsed);
+	rc = lti.lti_rc;
+	if (rc)
+		GOTO(out, rc);
+
+	plain_counter = 0;
+	rc = llog_cat_process(env, cath, test_8_cancel_cb, "test 8", 0, 0);
+	if (rc) {
+		CERROR("%s: process with test_8_cancel_cb failed: %d\n",
+		       test, rc);
+		GOTO(out, rc);
+	}
+	if (plain_counter != cfs_atomic_read(&lti.lti_added)) {
+		CERROR("%s: found %d records, added %d\n", test,
+		       plain_counter, cfs_atomic_read(&lti.lti_added));
+		GOTO(out, rc = -EINVAL);
+	}
+out:
+	rc2 = llog_cat_close(env, cath);
+	if (rc2) {
+		CERROR("%s: close catalog failed: %d\n", test, rc2);
+		if (rc == 0)
+			rc = rc2;
+	}
+	RETURN(rc);
+}
+
+/* Benchmark catalog append with the plain log locked and by reserved slots */
+static int llog_test_8(const struct lu_env *env, struct obd_device *obd)
+{
+	struct llog_ctxt	*ctxt;
+	int			 rc;
+
+	ENTRY;
+
+	ctxt = llog_get_context(obd, LLOG_TEST_ORIG_CTXT);
+
+	CWARN("8a: concurrent catalog append, locked\n");
+	rc = llog_test_8_sub(env, ctxt, "8a", 0);
+	if (rc) {
+		CERROR("8a: locked append test failed\n");
+		GOTO(out, rc);
+	}
+
+	CWARN("8b: concurrent catalog append, reserved slots\n");
+	rc = llog_test_8_sub(env, ctxt, "8b", 1);
+	if (rc) {
+		CERROR("8b: reserved-slot append test failed\n");
+		GOTO(out, rc);
+	}
+out:
+	llog_ctxt_put(ctxt);
+	RETURN(rc);
+}
+
 /* -------------------------------------------------------------------------
  * Tests above, boring obd functions below
  * ------------------------------------------------------------------------- */
@@ -942,6 +1122,10 @@ static int llog_run_tests(const struct lu_env *env, struct obd_device *obd)
 	if (rc)
 		GOTO(cleanup, rc);
 
+	rc = llog_test_8(env, obd);
+	if (rc)
+		GOTO(cleanup, rc);
+
 cleanup:
 	err = llog_destroy(env, llh);
 	if (err)
@@ -89,6 +89,21 @@ void lustre_som_swab(struct som_attrs *attrs)
 };
 EXPORT_SYMBOL(lustre_som_swab);
 
+/*
+ * Swab, if needed, lazy SOM structure which is stored on-disk in little-endian
+ * order.
+ */
+void lustre_lsom_swab(struct lsom_attrs *attrs)
+{
+	/* Use LUSTRE_MSG_MAGIC to detect local endianess. */
+	if (LUSTRE_MSG_MAGIC != cpu_to_le32(LUSTRE_MSG_MAGIC)) {
+		__swab32s(&attrs->lsa_flags);
+		__swab64s(&attrs->lsa_size);
+		__swab64s(&attrs->lsa_blocks);
+	}
+}
+EXPORT_SYMBOL(lustre_lsom_swab);
+
 /*
  * Swab and extract SOM attributes from on-disk xattr.
  *
@@ -461,6 +461,90 @@ int lprocfs_ofd_wr_grant_compat_disable(struct file *file, const char *buffer,
 	return count;
 }
 
+int lprocfs_ofd_rd_grant_adaptive(char *page, char **start, off_t off,
+				  int count, int *eof, void *data)
+{
+	struct obd_device	*obd = data;
+	struct ofd_device	*ofd = ofd_dev(obd->obd_lu_dev);
+
+	*eof = 1;
+	return snprintf(page, count, "%u\n", ofd->ofd_grant_adaptive);
+}
+
+int lprocfs_ofd_wr_grant_adaptive(struct file *file, const char *buffer,
+				  unsigned long count, void *data)
+{
+	struct obd_device	*obd = data;
+	struct ofd_device	*ofd = ofd_dev(obd->obd_lu_dev);
+	int			 val;
+	int			 rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0)
+		return -EINVAL;
+
+	spin_lock(&ofd->ofd_flags_lock);
+	ofd->ofd_grant_adaptive = !!val;
+	spin_unlock(&ofd->ofd_flags_lock);
+
+	return count;
+}
+
+struct ofd_exp_grant_cb_data {
+	char	*page;
+	int	 count;
+	int	 len;
+};
+
+static int lprocfs_ofd_exp_print_grant(cfs_hash_t *hs, cfs_hash_bd_t *bd,
+				       cfs_hlist_node_t *hnode, void *cb_data)
+{
+	struct obd_export		*exp = cfs_hash_object(hs, hnode);
+	struct ofd_exp_grant_cb_data	*data = cb_data;
+	struct filter_export_data	*fed = &exp->exp_filter_data;
+	struct ofd_device		*ofd = ofd_exp(exp);
+
+	if (exp->exp_nid_stats == NULL || data->len >= data->count)
+		return 0;
+
+	spin_lock(&ofd->ofd_grant_lock);
+	data->len += snprintf(data->page + data->len, data->count - data->len,
+			      "%s:\n"
+			      "    grant: %ld\n"
+			      "    dirty: %ld\n"
+			      "    pending: %ld\n"
+			      "    write_rate: "LPU64"\n"
+			      "    grant_shrunk: "LPU64"\n",
+			      obd_uuid2str(&exp->exp_client_uuid),
+			      fed->fed_grant, fed->fed_dirty, fed->fed_pending,
+			      fed->fed_write_rate, fed->fed_grant_shrunk);
+	spin_unlock(&ofd->ofd_grant_lock);
+	if (data->len > data->count)
+		data->len = data->count;
+	return 0;
+}
+
+/* per-export grant state, in the exports/<nid>/ directory */
+int lprocfs_ofd_rd_exp_grant(char *page, char **start, off_t off, int count,
+			     int *eof, void *data)
+{
+	struct nid_stat			*stats = data;
+	struct ofd_exp_grant_cb_data	 cb_data = {
+		.page	= page,
+		.count	= count,
+		.len	= 0,
+	};
+
+	*eof = 1;
+	page[0] = '\0';
+	cfs_hash_for_each_key(stats->nid_obd->obd_nid_hash, &stats->nid,
+			      lprocfs_ofd_exp_print_grant, &cb_data);
+	return cb_data.len;
+}
+
 static struct lprocfs_vars lprocfs_ofd_obd_vars[] = {
 	{ "uuid",		 lprocfs_rd_uuid, 0, 0 },
 	{ "blocksize",		 lprocfs_rd_blksize, 0, 0 },
@@ -499,6 +583,8 @@ static struct lprocfs_vars lprocfs_ofd_obd_vars[] = {
 				 lprocfs_obd_wr_ir_factor, 0},
 	{ "grant_compat_disable", lprocfs_ofd_rd_grant_compat_disable,
 				  lprocfs_ofd_wr_grant_compat_disable, 0 },
+	{ "grant_adaptive",	 lprocfs_ofd_rd_grant_adaptive,
+				 lprocfs_ofd_wr_grant_adaptive, 0 },
 	{ "client_cache_count",	 lprocfs_ofd_rd_fmd_max_num,
 				 lprocfs_ofd_wr_fmd_max_num, 0 },
 	{ "client_cache_seconds", lprocfs_ofd_rd_fmd_max_age,
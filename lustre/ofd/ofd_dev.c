@@ -600,6 +600,7 @@ static int ofd_init0(const struct lu_env *env, struct ofd_device *m,
 	m->ofd_syncjournal = 0;
 	ofd_slc_set(m);
 	m->ofd_grant_compat_disable = 0;
+	m->ofd_grant_adaptive = 1;
 
 	/* statfs data */
 	spin_lock_init(&m->ofd_osfs_lock);
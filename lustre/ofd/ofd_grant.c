@@ -48,6 +48,61 @@
 /* Clients typically hold 2x their max_rpcs_in_flight of grant space */
 #define OFD_GRANT_SHRINK_LIMIT(exp)	(2ULL * 8 * exp_max_brw_size(exp))
 
+/* Write rate of an export is sampled over windows of this many seconds */
+#define OFD_GRANT_RATE_WINDOW		5
+
+/* Busy writers get grant chunks up to this many times the default one */
+#define OFD_GRANT_CHUNK_MAX_MULT	4
+
+/**
+ * Account \a bytes written by an export and refresh its write rate.
+ * The rate is averaged with the previous one at the end of each window and
+ * halved for every window without any write, so it quickly drops to zero
+ * once the client goes idle.
+ * Caller must hold ofd_grant_lock spinlock.
+ *
+ * \param fed - is the filter export data of the client
+ * \param bytes - is the amount of data just written, 0 to only refresh
+ */
+static void ofd_grant_rate_update(struct filter_export_data *fed, long bytes)
+{
+	cfs_time_t	now = cfs_time_current();
+	long		age;
+	__u64		rate;
+
+	if (fed->fed_rate_stamp == 0)
+		fed->fed_rate_stamp = now;
+
+	age = cfs_duration_sec(cfs_time_sub(now, fed->fed_rate_stamp));
+	if (age >= OFD_GRANT_RATE_WINDOW) {
+		long windows = age / OFD_GRANT_RATE_WINDOW;
+
+		rate = fed->fed_write_bytes;
+		do_div(rate, age);
+		fed->fed_write_rate = windows < 64 ?
+				      fed->fed_write_rate >> (windows - 1) : 0;
+		fed->fed_write_rate = (fed->fed_write_rate + rate) >> 1;
+		fed->fed_write_bytes = 0;
+		fed->fed_rate_stamp = now;
+	}
+	fed->fed_write_bytes += bytes;
+}
+
+/* An export is idle if it has written nothing for the last couple of
+ * windows */
+static inline int ofd_grant_idle(struct filter_export_data *fed)
+{
+	return fed->fed_write_rate == 0 && fed->fed_write_bytes == 0;
+}
+
+/* Not enough ungranted space left for every client to hold its usual
+ * amount of grant */
+static inline int ofd_grant_tight(struct obd_export *exp, obd_size left)
+{
+	return left < ofd_exp(exp)->ofd_tot_granted_clients *
+		      OFD_GRANT_SHRINK_LIMIT(exp);
+}
+
 static inline obd_size ofd_grant_from_cli(struct obd_export *exp,
 					  struct ofd_device *ofd, obd_size val)
 {
@@ -70,17 +125,26 @@ static inline obd_size ofd_grant_to_cli(struct obd_export *exp,
 static inline obd_size ofd_grant_chunk(struct obd_export *exp,
 				       struct ofd_device *ofd)
 {
+	obd_size chunk;
+
 	if (ofd_obd(ofd)->obd_self_export == exp)
 		/* Grant enough space to handle a big precreate request */
 		return OST_MAX_PRECREATE * ofd->ofd_dt_conf.ddp_inodespace;
 
 	if (ofd_grant_compat(exp, ofd))
 		/* Try to grant enough space to send a full-size RPC */
-		return exp_max_brw_size(exp) <<
-		       (ofd->ofd_blockbits - COMPAT_BSIZE_SHIFT);
-
-	/* Try to return enough to send two full RPCs, if needed */
-	return exp_max_brw_size(exp) * 2;
+		chunk = (obd_size)exp_max_brw_size(exp) <<
+			(ofd->ofd_blockbits - COMPAT_BSIZE_SHIFT);
+	else
+		/* Try to return enough to send two full RPCs, if needed */
+		chunk = (obd_size)exp_max_brw_size(exp) * 2;
+
+	/* Busy writers get up to one second worth of their write rate, so
+	 * that they don't run out of grant between two RPCs */
+	if (ofd->ofd_grant_adaptive)
+		chunk = clamp_t(obd_size, exp->exp_filter_data.fed_write_rate,
+				chunk, chunk * OFD_GRANT_CHUNK_MAX_MULT);
+	return chunk;
 }
 
 /**
@@ -377,14 +441,19 @@ static void ofd_grant_shrink(struct obd_export *exp,
 
 	LASSERT_SPIN_LOCKED(&ofd->ofd_grant_lock);
 	LASSERT(exp);
-	if (left_space >= ofd->ofd_tot_granted_clients *
-			  OFD_GRANT_SHRINK_LIMIT(exp))
+
+	fed = &exp->exp_filter_data;
+	/* Grant held by idle clients is always worth taking back, it can be
+	 * handed out to active writers instead */
+	ofd_grant_rate_update(fed, 0);
+	if (!ofd_grant_tight(exp, left_space) &&
+	    !(ofd->ofd_grant_adaptive && ofd_grant_idle(fed)))
 		return;
 
 	grant_shrink = ofd_grant_from_cli(exp, ofd, oa->o_grant);
 
-	fed = &exp->exp_filter_data;
 	fed->fed_grant       -= grant_shrink;
+	fed->fed_grant_shrunk += grant_shrink;
 	ofd->ofd_tot_granted -= grant_shrink;
 
 	CDEBUG(D_CACHE, "%s: cli %s/%p shrink %ld fed_grant %ld total "
@@ -557,6 +626,9 @@ static void ofd_grant_check(const struct lu_env *env, struct obd_export *exp,
 		/* don't update dirty accounting during recovery */
 		RETURN_EXIT;
 
+	if (!resend)
+		ofd_grant_rate_update(fed, info->fti_used);
+
 	if (fed->fed_dirty < granted) {
 		CWARN("%s: cli %s/%p claims granted %lu > fed_dirty %lu\n",
 		       obd->obd_name, exp->exp_client_uuid.uuid, exp,
@@ -624,6 +696,14 @@ static long ofd_grant(struct obd_export *exp, obd_size curgrant,
 	if (curgrant >= want || curgrant >= fed->fed_grant + grant_chunk)
 		   RETURN(0);
 
+	/* When space is short, keep it for the clients actually writing.
+	 * Idle clients already hold some grant and get more once they
+	 * resume writing */
+	if (ofd->ofd_grant_adaptive && exp != obd->obd_self_export &&
+	    !obd->obd_recovering && fed->fed_grant > 0 &&
+	    ofd_grant_idle(fed) && ofd_grant_tight(exp, left))
+		RETURN(0);
+
 	if (!obd->obd_recovering)
 		/* don't grant more than 1/8th of the remaining free space in
 		 * one chunk */
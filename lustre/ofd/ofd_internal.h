@@ -183,7 +183,9 @@ struct ofd_device {
 				 ofd_sync_lock_cancel:2,
 				 /* shall we grant space to clients not
 				  * supporting OBD_CONNECT_GRANT_PARAM? */
-				 ofd_grant_compat_disable:1;
+				 ofd_grant_compat_disable:1,
+				 /* size grant by the client write rate */
+				 ofd_grant_adaptive:1;
 	struct seq_server_site	 ofd_seq_site;
 };
 
@@ -382,12 +384,19 @@ int ofd_txn_stop_cb(const struct lu_env *env, struct thandle *txn,
 #ifdef LPROCFS
 void lprocfs_ofd_init_vars(struct lprocfs_static_vars *lvars);
 void ofd_stats_counter_init(struct lprocfs_stats *stats);
+int lprocfs_ofd_rd_exp_grant(char *page, char **start, off_t off, int count,
+			     int *eof, void *data);
 #else
 static void lprocfs_ofd_init_vars(struct lprocfs_static_vars *lvars)
 {
 	memset(lvars, 0, sizeof(*lvars));
 }
 static inline void ofd_stats_counter_init(struct lprocfs_stats *stats) {}
+static inline int lprocfs_ofd_rd_exp_grant(char *page, char **start, off_t off,
+					   int count, int *eof, void *data)
+{
+	return 0;
+}
 #endif
 
 /* ofd_objects.c */
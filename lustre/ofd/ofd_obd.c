@@ -52,6 +52,7 @@ static int ofd_export_stats_init(struct ofd_device *ofd,
 {
 	struct obd_device	*obd = ofd_obd(ofd);
 	struct nid_stat		*stats;
+	cfs_proc_dir_entry_t	*entry;
 	int			 num_stats;
 	int			 rc, newnid = 0;
 
@@ -101,6 +102,12 @@ static int ofd_export_stats_init(struct ofd_device *ofd,
 		GOTO(clean, rc);
 	}
 
+	entry = lprocfs_add_simple(stats->nid_proc, "grant",
+				   lprocfs_ofd_rd_exp_grant, NULL, stats, NULL);
+	if (IS_ERR(entry))
+		CWARN("%s: cannot add the export grant file: rc = %ld\n",
+		      obd->obd_name, PTR_ERR(entry));
+
 	RETURN(0);
 clean:
 	return rc;
@@ -135,6 +142,9 @@ static int ofd_parse_connect_data(const struct lu_env *env,
 	fed->fed_group = data->ocd_group;
 
 	data->ocd_connect_flags &= OST_CONNECT_SUPPORTED;
+	/* a multi-object write carries the capability of one object only */
+	if (exp->exp_obd->u.filter.fo_fl_oss_capa)
+		data->ocd_connect_flags &= ~OBD_CONNECT_MULTIBRW;
 	exp->exp_connect_data = *data;
 	data->ocd_version = LUSTRE_VERSION_CODE;
 
@@ -1112,6 +1122,96 @@ out:
 	RETURN(rc);
 }
 
+/* chown one object for ofd_sync_batch() */
+static int ofd_sync_setattr(const struct lu_env *env, struct ofd_device *ofd,
+			    struct ost_sync_rec *rec)
+{
+	struct ofd_thread_info	*info = ofd_info(env);
+	struct ofd_object	*fo;
+	int			 rc;
+
+	fo = ofd_object_find(env, ofd, &info->fti_fid);
+	if (IS_ERR(fo))
+		return PTR_ERR(fo);
+
+	info->fti_attr.la_valid = LA_UID | LA_GID;
+	info->fti_attr.la_uid = rec->osr_uid;
+	info->fti_attr.la_gid = rec->osr_gid;
+	rc = ofd_attr_set(env, fo, &info->fti_attr, NULL);
+	info->fti_attr.la_valid = 0;
+
+	ofd_object_put(env, fo);
+	return rc;
+}
+
+/**
+ * Destroy or chown the objects of a batch sent by the MDS, see OST_SYNC_BATCH.
+ * Every object has its own transaction and, as in ofd_destroy(), the highest
+ * transno is reported back. -ENOENT is returned only if nothing was done.
+ */
+static int ofd_sync_batch(const struct lu_env *env, struct obd_export *exp,
+			  struct ost_sync_rec *recs, int count,
+			  struct obd_trans_info *oti)
+{
+	struct ofd_device	*ofd = ofd_exp(exp);
+	struct ofd_thread_info	*info;
+	int			 rc = 0;
+	int			 i;
+
+	ENTRY;
+
+	info = ofd_info_init(env, exp);
+	ofd_oti2info(info, oti);
+
+	if (info->fti_transno == 0) /* not replay */
+		info->fti_mult_trans = 1;
+
+	CDEBUG(D_HA, "%s: sync batch of %d objects\n", ofd_name(ofd), count);
+	for (i = 0; i < count; i++) {
+		struct ost_sync_rec	*rec = &recs[i];
+		struct ost_id		 oi = rec->osr_oi;
+		obd_count		 nr = 1;
+		int			 lrc;
+
+		if (rec->osr_op == OST_DESTROY && rec->osr_count > 0)
+			nr = rec->osr_count;
+
+		for (; nr > 0; nr--, ostid_inc_id(&oi)) {
+			lrc = ostid_to_fid(&info->fti_fid, &oi, 0);
+			if (lrc == 0 && rec->osr_op == OST_DESTROY)
+				lrc = ofd_destroy_by_fid(env, ofd,
+							 &info->fti_fid, 0);
+			else if (lrc == 0)
+				lrc = ofd_sync_setattr(env, ofd, rec);
+
+			if (lrc == -ENOENT) {
+				CDEBUG(D_INODE, "%s: %s non-existent object "
+				       DFID"\n", ofd_name(ofd),
+				       rec->osr_op == OST_DESTROY ?
+				       "destroying" : "changing",
+				       PFID(&info->fti_fid));
+				if (rc == 0)
+					rc = lrc;
+			} else if (lrc != 0) {
+				CERROR("%s: error syncing object "DOSTID": "
+				       "rc = %d\n", ofd_name(ofd), POSTID(&oi),
+				       lrc);
+				rc = lrc;
+			}
+		}
+	}
+
+	if (rc == -ENOENT) {
+		if (info->fti_transno != 0)
+			rc = 0;
+	} else if (rc != 0) {
+		/* the whole batch will be sent again */
+		info->fti_transno = 0;
+	}
+	ofd_info2oti(info, oti);
+	RETURN(rc);
+}
+
 static int ofd_orphans_destroy(const struct lu_env *env,
 			       struct obd_export *exp, struct ofd_device *ofd,
 			       struct obdo *oa)
@@ -1669,6 +1769,7 @@ struct obd_ops ofd_obd_ops = {
 	.o_preprw		= ofd_preprw,
 	.o_commitrw		= ofd_commitrw,
 	.o_destroy		= ofd_destroy,
+	.o_sync_batch		= ofd_sync_batch,
 	.o_init_export		= ofd_init_export,
 	.o_destroy_export	= ofd_destroy_export,
 	.o_postrecov		= ofd_obd_postrecov,
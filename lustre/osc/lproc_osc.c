@@ -117,6 +117,36 @@ static int osc_wr_max_rpcs_in_flight(struct file *file, const char *buffer,
         return count;
 }
 
+static int osc_rd_max_brw_objs(char *page, char **start, off_t off,
+			       int count, int *eof, void *data)
+{
+	struct obd_device *dev = data;
+	struct client_obd *cli = &dev->u.cli;
+
+	return snprintf(page, count, "%d\n", cli->cl_max_brw_objs);
+}
+
+static int osc_wr_max_brw_objs(struct file *file, const char *buffer,
+			       unsigned long count, void *data)
+{
+	struct obd_device *dev = data;
+	struct client_obd *cli = &dev->u.cli;
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 1 || val > PTLRPC_MAX_BRW_OBJS)
+		return -ERANGE;
+
+	client_obd_list_lock(&cli->cl_loi_list_lock);
+	cli->cl_max_brw_objs = val;
+	client_obd_list_unlock(&cli->cl_loi_list_lock);
+
+	return count;
+}
+
 static int osc_rd_max_dirty_mb(char *page, char **start, off_t off, int count,
                                int *eof, void *data)
 {
@@ -200,6 +230,57 @@ static int osc_wr_cached_mb(struct file *file, const char *buffer,
 	return count;
 }
 
+static int osc_rd_lru_lock_stats(char *page, char **start, off_t off,
+				 int count, int *eof, void *data)
+{
+	struct obd_device   *dev = data;
+	struct client_obd   *cli = &dev->u.cli;
+	struct cl_lru_batch *batch;
+	__u64		     locks;
+	__u64		     usec;
+	__u64		     flushes;
+	long		     max_usec;
+	int		     staged = 0;
+	int		     i;
+
+	if (cli->cl_lru_batches != NULL) {
+		cfs_percpt_for_each(batch, i, cli->cl_lru_batches)
+			staged += batch->clb_nr;
+	}
+
+	client_obd_list_lock(&cli->cl_lru_list_lock);
+	locks = cli->cl_lru_lock_count;
+	usec = cli->cl_lru_lock_usec;
+	max_usec = cli->cl_lru_lock_max_usec;
+	flushes = cli->cl_lru_batch_flushes;
+	client_obd_list_unlock(&cli->cl_lru_list_lock);
+
+	return snprintf(page, count,
+			"lock_count: "LPU64"\n"
+			"lock_hold_usec: "LPU64"\n"
+			"lock_hold_max_usec: %ld\n"
+			"batch_flushes: "LPU64"\n"
+			"staged_pages: %d\n",
+			locks, usec, max_usec, flushes, staged);
+}
+
+/* any write resets the counters */
+static int osc_wr_lru_lock_stats(struct file *file, const char *buffer,
+				 unsigned long count, void *data)
+{
+	struct obd_device *dev = data;
+	struct client_obd *cli = &dev->u.cli;
+
+	client_obd_list_lock(&cli->cl_lru_list_lock);
+	cli->cl_lru_lock_count = 0;
+	cli->cl_lru_lock_usec = 0;
+	cli->cl_lru_lock_max_usec = 0;
+	cli->cl_lru_batch_flushes = 0;
+	client_obd_list_unlock(&cli->cl_lru_list_lock);
+
+	return count;
+}
+
 static int osc_rd_cur_dirty_bytes(char *page, char **start, off_t off,
                                   int count, int *eof, void *data)
 {
@@ -515,9 +596,11 @@ static struct lprocfs_vars lprocfs_osc_obd_vars[] = {
 			       lprocfs_osc_wr_max_pages_per_rpc, 0 },
         { "max_rpcs_in_flight", osc_rd_max_rpcs_in_flight,
                                 osc_wr_max_rpcs_in_flight, 0 },
+	{ "max_brw_objs",    osc_rd_max_brw_objs, osc_wr_max_brw_objs, 0 },
         { "destroys_in_flight", osc_rd_destroys_in_flight, 0, 0 },
         { "max_dirty_mb",    osc_rd_max_dirty_mb, osc_wr_max_dirty_mb, 0 },
 	{ "osc_cached_mb",   osc_rd_cached_mb,     osc_wr_cached_mb, 0 },
+	{ "lru_lock_stats",  osc_rd_lru_lock_stats, osc_wr_lru_lock_stats, 0 },
         { "cur_dirty_bytes", osc_rd_cur_dirty_bytes, 0, 0 },
         { "cur_grant_bytes", osc_rd_cur_grant_bytes,
                              osc_wr_cur_grant_bytes, 0 },
@@ -1900,6 +1900,87 @@ static int get_write_extents(struct osc_object *obj, cfs_list_t *rpclist)
 	return page_count;
 }
 
+/**
+ * Pack the dirty extents of other small objects into the write RPC being
+ * built for \a osc, so that a bunch of small files goes out in one
+ * multi-object BRW RPC instead of one RPC per file. Only objects of the same
+ * owner whose dirty pages fit in the room left in the RPC are taken, so
+ * streaming writers of big files are not split up.
+ *
+ * Called without object lock held, returns the new page count of the RPC.
+ */
+static obd_count osc_add_small_writes(const struct lu_env *env,
+				      struct client_obd *cli,
+				      struct osc_object *osc,
+				      cfs_list_t *rpclist, obd_count page_count)
+{
+	struct osc_object *objs[PTLRPC_MAX_BRW_OBJS - 1];
+	struct osc_object *tmp;
+	struct osc_extent *ext;
+	unsigned int max_pages = cli->cl_max_pages_per_rpc;
+	unsigned int room;
+	int max_objs = cli->cl_max_brw_objs;
+	int pages = page_count;
+	int nr = 0;
+	int i;
+	ENTRY;
+
+	/* HP extents go out on their own to release the lock quickly */
+	ext = cfs_list_entry(rpclist->next, struct osc_extent, oe_link);
+	if (max_objs <= 1 || ext->oe_srvlock || ext->oe_hp ||
+	    !osc->oo_owner_valid || page_count >= max_pages ||
+	    !exp_connect_multibrw(osc_export(osc)))
+		RETURN(page_count);
+
+	room = max_pages - page_count;
+	client_obd_list_lock(&cli->cl_loi_list_lock);
+	cfs_list_for_each_entry(tmp, &cli->cl_loi_write_list, oo_write_item) {
+		int nr_writes = cfs_atomic_read(&tmp->oo_nr_writes);
+
+		if (nr + 1 >= max_objs || room == 0)
+			break;
+		if (tmp == osc || !tmp->oo_owner_valid ||
+		    tmp->oo_owner[USRQUOTA] != osc->oo_owner[USRQUOTA] ||
+		    tmp->oo_owner[GRPQUOTA] != osc->oo_owner[GRPQUOTA] ||
+		    nr_writes == 0 || nr_writes > room)
+			continue;
+
+		cl_object_get(osc2cl(tmp));
+		objs[nr++] = tmp;
+		room -= nr_writes;
+	}
+	client_obd_list_unlock(&cli->cl_loi_list_lock);
+
+	for (i = 0; i < nr; i++) {
+		int count = pages;
+
+		tmp = objs[i];
+		osc_object_lock(tmp);
+		if (!cfs_list_empty(&tmp->oo_hp_exts))
+			ext = NULL;
+		else
+			ext = first_extent(tmp);
+		for (; ext != NULL; ext = next_extent(ext)) {
+			if (ext->oe_state != OES_CACHE ||
+			    (!cfs_list_empty(&ext->oe_link) &&
+			     ext->oe_owner != NULL))
+				continue;
+
+			if (!try_to_add_extent_for_io(cli, ext, rpclist,
+						      &pages, &max_pages))
+				break;
+			osc_extent_state_set(ext, OES_LOCKING);
+		}
+		if (pages > count)
+			osc_update_pending(tmp, OBD_BRW_WRITE, count - pages);
+		osc_object_unlock(tmp);
+
+		osc_list_maint(cli, tmp);
+		cl_object_put(env, osc2cl(tmp));
+	}
+	RETURN(pages);
+}
+
 static int
 osc_send_write_rpc(const struct lu_env *env, struct client_obd *cli,
 		   struct osc_object *osc, pdl_policy_t pol)
@@ -1936,6 +2017,8 @@ osc_send_write_rpc(const struct lu_env *env, struct client_obd *cli,
 	 * lock order is page lock -> object lock. */
 	osc_object_unlock(osc);
 
+	page_count = osc_add_small_writes(env, cli, osc, &rpclist, page_count);
+
 	cfs_list_for_each_entry_safe(ext, tmp, &rpclist, oe_link) {
 		if (ext->oe_state == OES_LOCKING) {
 			rc = osc_extent_make_ready(env, ext);
@@ -2225,8 +2308,10 @@ int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 		cmd |= OBD_BRW_NOQUOTA;
 	}
 
-	/* check if the file's owner/group is over quota */
-	if (!(cmd & OBD_BRW_NOQUOTA)) {
+	/* check if the file's owner/group is over quota, and remember the
+	 * owner for multi-object write RPCs */
+	if (!(cmd & OBD_BRW_NOQUOTA) ||
+	    (cli->cl_max_brw_objs > 1 && !osc->oo_owner_valid)) {
 		struct cl_object *obj;
 		struct cl_attr   *attr;
 		unsigned int qid[MAXQUOTAS];
@@ -2240,10 +2325,18 @@ int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 
 		qid[USRQUOTA] = attr->cat_uid;
 		qid[GRPQUOTA] = attr->cat_gid;
-		if (rc == 0 && osc_quota_chkdq(cli, qid) == NO_QUOTA)
-			rc = -EDQUOT;
-		if (rc)
-			RETURN(rc);
+		if (rc == 0) {
+			osc->oo_owner[USRQUOTA] = qid[USRQUOTA];
+			osc->oo_owner[GRPQUOTA] = qid[GRPQUOTA];
+			osc->oo_owner_valid = 1;
+		}
+		if (!(cmd & OBD_BRW_NOQUOTA)) {
+			if (rc == 0 && osc_quota_chkdq(cli, qid) == NO_QUOTA)
+				rc = -EDQUOT;
+			if (rc)
+				RETURN(rc);
+		}
+		rc = 0;
 	}
 
 	oap->oap_cmd = cmd;
@@ -166,6 +166,11 @@ struct osc_object {
 	cfs_atomic_t	 oo_nr_reads;
 	cfs_atomic_t	 oo_nr_writes;
 
+	/** Owner of the file as seen at page queue time. Only objects of the
+	 * same owner are packed into one multi-object write RPC. */
+	unsigned int	   oo_owner[MAXQUOTAS];
+	int		   oo_owner_valid;
+
 	/** Protect extent tree. Will be used to protect
 	 * oo_{read|write}_pages soon. */
 	spinlock_t	    oo_lock;
@@ -383,6 +388,11 @@ struct osc_page {
 		 */
 		cfs_list_t            ops_inflight;
 	};
+	/**
+	 * CPT of the cl_lru_batch the page is staged on, -1 if it is on
+	 * client_obd::cl_lru_list or not in LRU at all.
+	 */
+	int			 ops_lru_cpt;
         /**
          * Thread that submitted this page for transfer. For debugging.
          */
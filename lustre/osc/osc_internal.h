@@ -130,6 +130,8 @@ int osc_process_config_base(struct obd_device *obd, struct lustre_cfg *cfg);
 int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 		  cfs_list_t *ext_list, int cmd, pdl_policy_t p);
 int osc_lru_shrink(struct client_obd *cli, int target);
+int osc_lru_batches_init(struct client_obd *cli);
+void osc_lru_batches_fini(struct client_obd *cli);
 
 extern spinlock_t osc_ast_guard;
 
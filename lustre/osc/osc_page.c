@@ -536,6 +536,7 @@ int osc_page_init(const struct lu_env *env, struct cl_object *obj,
 	 * hurt to initialize it twice :-) */
 	CFS_INIT_LIST_HEAD(&opg->ops_inflight);
 	CFS_INIT_LIST_HEAD(&opg->ops_lru);
+	opg->ops_lru_cpt = -1;
 
 	/* reserve an LRU space for this page */
 	if (page->cp_type == CPT_CACHEABLE && result == 0)
@@ -596,6 +597,98 @@ static cfs_atomic_t osc_lru_waiters = CFS_ATOMIC_INIT(0);
 static const int lru_shrink_min = 2 << (20 - CFS_PAGE_SHIFT);  /* 2M */
 /* free this number at most otherwise it will take too long time to finsih. */
 static const int lru_shrink_max = 32 << (20 - CFS_PAGE_SHIFT); /* 32M */
+/* pages staged on a cl_lru_batch before they are moved to cl_lru_list */
+#define OSC_LRU_BATCH	16
+
+static inline void osc_lru_lock(struct client_obd *cli, struct timeval *tv)
+{
+	client_obd_list_lock(&cli->cl_lru_list_lock);
+	cfs_gettimeofday(tv);
+}
+
+static inline void osc_lru_unlock(struct client_obd *cli, struct timeval *tv)
+{
+	struct timeval now;
+	long usec;
+
+	cfs_gettimeofday(&now);
+	usec = cfs_timeval_sub(&now, tv, NULL);
+	cli->cl_lru_lock_count++;
+	cli->cl_lru_lock_usec += usec;
+	if (usec > cli->cl_lru_lock_max_usec)
+		cli->cl_lru_lock_max_usec = usec;
+	client_obd_list_unlock(&cli->cl_lru_list_lock);
+}
+
+int osc_lru_batches_init(struct client_obd *cli)
+{
+	struct cl_lru_batch *batch;
+	int i;
+
+	cli->cl_lru_batches = cfs_percpt_alloc(cfs_cpt_table,
+					       sizeof(*batch));
+	if (cli->cl_lru_batches == NULL)
+		return -ENOMEM;
+
+	cfs_percpt_for_each(batch, i, cli->cl_lru_batches) {
+		spin_lock_init(&batch->clb_lock);
+		CFS_INIT_LIST_HEAD(&batch->clb_list);
+		batch->clb_nr = 0;
+	}
+	return 0;
+}
+
+void osc_lru_batches_fini(struct client_obd *cli)
+{
+	struct cl_lru_batch *batch;
+	int i;
+
+	if (cli->cl_lru_batches == NULL)
+		return;
+
+	cfs_percpt_for_each(batch, i, cli->cl_lru_batches)
+		LASSERT(cfs_list_empty(&batch->clb_list));
+	cfs_percpt_free(cli->cl_lru_batches);
+	cli->cl_lru_batches = NULL;
+}
+
+/* Move the pages staged on @batch to the tail of cl_lru_list, called with
+ * clb_lock held. */
+static void osc_lru_batch_flush(struct client_obd *cli,
+				struct cl_lru_batch *batch)
+{
+	struct osc_page *opg;
+	struct timeval tv;
+
+	if (batch->clb_nr == 0)
+		return;
+
+	/* ops_lru_cpt is changed with both locks held, see osc_lru_del() */
+	osc_lru_lock(cli, &tv);
+	cfs_list_for_each_entry(opg, &batch->clb_list, ops_lru)
+		opg->ops_lru_cpt = -1;
+	/* splice after the last page, i.e. to the tail */
+	cfs_list_splice_init(&batch->clb_list, cli->cl_lru_list.prev);
+	cli->cl_lru_batch_flushes++;
+	osc_lru_unlock(cli, &tv);
+	batch->clb_nr = 0;
+}
+
+/* Flush the batches of all CPTs, one partition at a time, so that the
+ * staged pages can be found by the shrinker. */
+static void osc_lru_batches_flush(struct client_obd *cli)
+{
+	struct cl_lru_batch *batch;
+	int i;
+
+	cfs_percpt_for_each(batch, i, cli->cl_lru_batches) {
+		if (batch->clb_nr == 0)
+			continue;
+		spin_lock(&batch->clb_lock);
+		osc_lru_batch_flush(cli, batch);
+		spin_unlock(&batch->clb_lock);
+	}
+}
 
 /* Check if we can free LRU slots from this OSC. If there exists LRU waiters,
  * we should free slots aggressively. In this way, slots are freed in a steady
@@ -665,6 +758,7 @@ int osc_lru_shrink(struct client_obd *cli, int target)
 	struct cl_object *clobj = NULL;
 	struct cl_page **pvec;
 	struct osc_page *opg;
+	struct timeval tv;
 	int maxscan = 0;
 	int count = 0;
 	int index = 0;
@@ -682,7 +776,9 @@ int osc_lru_shrink(struct client_obd *cli, int target)
 	pvec = osc_env_info(env)->oti_pvec;
 	io = &osc_env_info(env)->oti_io;
 
-	client_obd_list_lock(&cli->cl_lru_list_lock);
+	osc_lru_batches_flush(cli);
+
+	osc_lru_lock(cli, &tv);
 	cfs_atomic_inc(&cli->cl_lru_shrinkers);
 	maxscan = min(target << 1, cfs_atomic_read(&cli->cl_lru_in_list));
 	while (!cfs_list_empty(&cli->cl_lru_list)) {
@@ -704,7 +800,7 @@ int osc_lru_shrink(struct client_obd *cli, int target)
 			struct cl_object *tmp = page->cp_obj;
 
 			cl_object_get(tmp);
-			client_obd_list_unlock(&cli->cl_lru_list_lock);
+			osc_lru_unlock(cli, &tv);
 
 			if (clobj != NULL) {
 				count -= discard_pagevec(env, io, pvec, index);
@@ -720,7 +816,7 @@ int osc_lru_shrink(struct client_obd *cli, int target)
 			io->ci_ignore_layout = 1;
 			rc = cl_io_init(env, io, CIT_MISC, clobj);
 
-			client_obd_list_lock(&cli->cl_lru_list_lock);
+			osc_lru_lock(cli, &tv);
 
 			if (rc != 0)
 				break;
@@ -742,14 +838,14 @@ int osc_lru_shrink(struct client_obd *cli, int target)
 			break;
 
 		if (unlikely(index == OTI_PVEC_SIZE)) {
-			client_obd_list_unlock(&cli->cl_lru_list_lock);
+			osc_lru_unlock(cli, &tv);
 			count -= discard_pagevec(env, io, pvec, index);
 			index = 0;
 
-			client_obd_list_lock(&cli->cl_lru_list_lock);
+			osc_lru_lock(cli, &tv);
 		}
 	}
-	client_obd_list_unlock(&cli->cl_lru_list_lock);
+	osc_lru_unlock(cli, &tv);
 
 	if (clobj != NULL) {
 		count -= discard_pagevec(env, io, pvec, index);
@@ -765,19 +861,27 @@ int osc_lru_shrink(struct client_obd *cli, int target)
 
 static void osc_lru_add(struct client_obd *cli, struct osc_page *opg)
 {
+	struct cl_lru_batch *batch;
 	bool wakeup = false;
+	int cpt;
 
 	if (!opg->ops_in_lru)
 		return;
 
 	cfs_atomic_dec(&cli->cl_lru_busy);
-	client_obd_list_lock(&cli->cl_lru_list_lock);
+
+	cpt = cfs_cpt_current(cfs_cpt_table, 0);
+	batch = cli->cl_lru_batches[cpt];
+	spin_lock(&batch->clb_lock);
 	if (cfs_list_empty(&opg->ops_lru)) {
-		cfs_list_move_tail(&opg->ops_lru, &cli->cl_lru_list);
-		cfs_atomic_inc_return(&cli->cl_lru_in_list);
+		cfs_list_add_tail(&opg->ops_lru, &batch->clb_list);
+		opg->ops_lru_cpt = cpt;
+		cfs_atomic_inc(&cli->cl_lru_in_list);
 		wakeup = cfs_atomic_read(&osc_lru_waiters) > 0;
+		if (++batch->clb_nr >= OSC_LRU_BATCH || wakeup)
+			osc_lru_batch_flush(cli, batch);
 	}
-	client_obd_list_unlock(&cli->cl_lru_list_lock);
+	spin_unlock(&batch->clb_lock);
 
 	if (wakeup) {
 		osc_lru_shrink(cli, osc_cache_too_much(cli));
@@ -790,18 +894,47 @@ static void osc_lru_add(struct client_obd *cli, struct osc_page *opg)
 static void osc_lru_del(struct client_obd *cli, struct osc_page *opg, bool del)
 {
 	if (opg->ops_in_lru) {
-		client_obd_list_lock(&cli->cl_lru_list_lock);
+		struct cl_lru_batch *batch = NULL;
+		struct timeval tv;
+		int cpt;
+
+		/* the page can be moved from a batch to cl_lru_list by a
+		 * flush, retry until the lock of its current list is held */
+		while (1) {
+			cpt = opg->ops_lru_cpt;
+			if (cpt < 0) {
+				osc_lru_lock(cli, &tv);
+				if (opg->ops_lru_cpt < 0)
+					break;
+				osc_lru_unlock(cli, &tv);
+			} else {
+				batch = cli->cl_lru_batches[cpt];
+				spin_lock(&batch->clb_lock);
+				if (opg->ops_lru_cpt == cpt)
+					break;
+				spin_unlock(&batch->clb_lock);
+			}
+		}
+
 		if (!cfs_list_empty(&opg->ops_lru)) {
 			LASSERT(cfs_atomic_read(&cli->cl_lru_in_list) > 0);
 			cfs_list_del_init(&opg->ops_lru);
 			cfs_atomic_dec(&cli->cl_lru_in_list);
+			if (cpt >= 0) {
+				batch->clb_nr--;
+				opg->ops_lru_cpt = -1;
+			}
 			if (!del)
 				cfs_atomic_inc(&cli->cl_lru_busy);
 		} else if (del) {
 			LASSERT(cfs_atomic_read(&cli->cl_lru_busy) > 0);
 			cfs_atomic_dec(&cli->cl_lru_busy);
 		}
-		client_obd_list_unlock(&cli->cl_lru_list_lock);
+
+		if (cpt < 0)
+			osc_lru_unlock(cli, &tv);
+		else
+			spin_unlock(&batch->clb_lock);
 		if (del) {
 			cfs_atomic_inc(cli->cl_lru_left);
 			/* this is a great place to release more LRU pages if
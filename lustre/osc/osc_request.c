@@ -1176,6 +1176,20 @@ static inline int can_merge_pages(struct brw_page *p1, struct brw_page *p2)
         return (p1->off + p1->count == p2->off);
 }
 
+/* Multi-object RPCs are only built from cached pages, see osc_build_rpc() */
+static inline struct osc_object *osc_brw_page_obj(struct brw_page *pg)
+{
+	return container_of(pg, struct osc_async_page, oap_brw_page)->oap_obj;
+}
+
+/* Check whether @pga[i] starts the pages of a new object */
+static inline int osc_brw_new_obj(struct brw_page **pga, int i,
+				  obd_count obj_count)
+{
+	return obj_count > 1 &&
+	       osc_brw_page_obj(pga[i - 1]) != osc_brw_page_obj(pga[i]);
+}
+
 static obd_count osc_checksum_bulk(int nob, obd_count pg_count,
 				   struct brw_page **pga, int opc,
 				   cksum_type_t cksum_type)
@@ -1235,7 +1249,7 @@ static obd_count osc_checksum_bulk(int nob, obd_count pg_count,
 
 static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
                                 struct lov_stripe_md *lsm, obd_count page_count,
-                                struct brw_page **pga,
+                                struct brw_page **pga, obd_count obj_count,
                                 struct ptlrpc_request **reqp,
                                 struct obd_capa *ocapa, int reserve,
                                 int resend)
@@ -1249,6 +1263,7 @@ static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
         struct osc_brw_async_args *aa;
         struct req_capsule      *pill;
         struct brw_page *pg_prev;
+        int first; /* index of the first page of the current object */
 
         ENTRY;
         if (OBD_FAIL_CHECK(OBD_FAIL_OSC_BRW_PREP_REQ))
@@ -1269,13 +1284,14 @@ static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
                 RETURN(-ENOMEM);
 
         for (niocount = i = 1; i < page_count; i++) {
-                if (!can_merge_pages(pga[i - 1], pga[i]))
+                if (osc_brw_new_obj(pga, i, obj_count) ||
+                    !can_merge_pages(pga[i - 1], pga[i]))
                         niocount++;
         }
 
         pill = &req->rq_pill;
         req_capsule_set_size(pill, &RMF_OBD_IOOBJ, RCL_CLIENT,
-                             sizeof(*ioobj));
+                             obj_count * sizeof(*ioobj));
         req_capsule_set_size(pill, &RMF_NIOBUF_REMOTE, RCL_CLIENT,
                              niocount * sizeof(*niobuf));
         osc_set_capa_size(req, &RMF_CAPA1, ocapa);
@@ -1308,7 +1324,7 @@ static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
         lustre_set_wire_obdo(&body->oa, oa);
 
 	obdo_to_ioobj(oa, ioobj);
-	ioobj->ioo_bufcnt = niocount;
+	ioobj->ioo_bufcnt = 0;
 	/* The high bits of ioo_max_brw tells server _maximum_ number of bulks
 	 * that might be send for this request.  The actual number is decided
 	 * when the RPC is finally sent in ptlrpc_register_bulk(). It sends
@@ -1318,21 +1334,34 @@ static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
 	osc_pack_capa(req, body, ocapa);
 	LASSERT(page_count > 0);
 	pg_prev = pga[0];
+	first = 0;
         for (requested_nob = i = 0; i < page_count; i++, niobuf++) {
                 struct brw_page *pg = pga[i];
                 int poff = pg->off & ~CFS_PAGE_MASK;
+                int last;
+
+		/* pages are grouped by object, one ioobj for each of them */
+		if (i > 0 && osc_brw_new_obj(pga, i, obj_count)) {
+			ioobj++;
+			ioobj->ioo_oid = osc_brw_page_obj(pg)->oo_oinfo->loi_oi;
+			ioobj->ioo_bufcnt = 0;
+			ioobj_max_brw_set(ioobj, desc->bd_md_max_brw);
+			first = i;
+		}
+		last = i == page_count - 1 || osc_brw_new_obj(pga, i + 1,
+							     obj_count);
 
                 LASSERT(pg->count > 0);
                 /* make sure there is no gap in the middle of page array */
-                LASSERTF(page_count == 1 ||
-                         (ergo(i == 0, poff + pg->count == CFS_PAGE_SIZE) &&
-                          ergo(i > 0 && i < page_count - 1,
+                LASSERTF((i == first && last) ||
+                         (ergo(i == first, poff + pg->count == CFS_PAGE_SIZE) &&
+                          ergo(i > first && !last,
                                poff == 0 && pg->count == CFS_PAGE_SIZE)   &&
-                          ergo(i == page_count - 1, poff == 0)),
+                          ergo(last, poff == 0)),
                          "i: %d/%d pg: %p off: "LPU64", count: %u\n",
                          i, page_count, pg, pg->off, pg->count);
 #ifdef __linux__
-                LASSERTF(i == 0 || pg->off > pg_prev->off,
+                LASSERTF(i == first || pg->off > pg_prev->off,
                          "i %d p_c %u pg %p [pri %lu ind %lu] off "LPU64
                          " prev_pg %p [pri %lu ind %lu] off "LPU64"\n",
                          i, page_count,
@@ -1340,7 +1369,7 @@ static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
                          pg_prev->pg, page_private(pg_prev->pg),
                          pg_prev->pg->index, pg_prev->off);
 #else
-                LASSERTF(i == 0 || pg->off > pg_prev->off,
+                LASSERTF(i == first || pg->off > pg_prev->off,
                          "i %d p_c %u\n", i, page_count);
 #endif
                 LASSERT((pga[0]->flag & OBD_BRW_SRVLOCK) ==
@@ -1349,22 +1378,32 @@ static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
 		ptlrpc_prep_bulk_page_pin(desc, pg->pg, poff, pg->count);
                 requested_nob += pg->count;
 
-                if (i > 0 && can_merge_pages(pg_prev, pg)) {
+                if (i > first && can_merge_pages(pg_prev, pg)) {
                         niobuf--;
                         niobuf->len += pg->count;
                 } else {
                         niobuf->offset = pg->off;
                         niobuf->len    = pg->count;
                         niobuf->flags  = pg->flag;
+                        ioobj->ioo_bufcnt++;
                 }
                 pg_prev = pg;
         }
 
+        LASSERTF(ioobj + 1 - obj_count ==
+                 req_capsule_client_get(&req->rq_pill, &RMF_OBD_IOOBJ),
+                 "pages of %u objects are not grouped\n", obj_count);
+
         LASSERTF((void *)(niobuf - niocount) ==
                 req_capsule_client_get(&req->rq_pill, &RMF_NIOBUF_REMOTE),
                 "want %p - real %p\n", req_capsule_client_get(&req->rq_pill,
                 &RMF_NIOBUF_REMOTE), (void *)(niobuf - niocount));
 
+	/* make a multi-object write look larger than the OST can take */
+	if (opc == OST_WRITE && obj_count > 1 &&
+	    OBD_FAIL_CHECK(OBD_FAIL_OSC_BRW_OVERSIZE))
+		niobuf[-1].len += PTLRPC_MAX_BRW_SIZE;
+
         osc_announce_cached(cli, &body->oa, opc == OST_WRITE ? requested_nob:0);
         if (resend) {
                 if ((body->oa.o_valid & OBD_MD_FLFLAGS) == 0) {
@@ -1660,7 +1699,7 @@ static int osc_brw_internal(int cmd, struct obd_export *exp, struct obdo *oa,
 
 restart_bulk:
         rc = osc_brw_prep_request(cmd, &exp->exp_obd->u.cli, oa, lsm,
-                                  page_count, pga, &req, ocapa, 0, resends);
+                                  page_count, pga, 1, &req, ocapa, 0, resends);
         if (rc != 0)
                 return (rc);
 
@@ -1728,6 +1767,7 @@ static int osc_brw_redo_request(struct ptlrpc_request *request,
                                   aa->aa_cli, aa->aa_oa,
                                   NULL /* lsm unused by osc currently */,
                                   aa->aa_page_count, aa->aa_ppga,
+                                  aa->aa_clerq->crq_nrobjs,
                                   &new_req, aa->aa_ocapa, 0, 1);
         if (rc)
                 RETURN(rc);
@@ -2060,23 +2100,33 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
         struct cl_req *clerq = NULL;
         enum cl_req_type crt = (cmd & OBD_BRW_WRITE) ? CRT_WRITE : CRT_READ;
         struct ldlm_lock *lock = NULL;
-        struct cl_req_attr crattr;
+        struct cl_req_attr *crattr = NULL;
+	struct osc_object *obj = NULL;
 	obd_off starting_offset = OBD_OBJECT_EOF;
+	obd_off obj_start = OBD_OBJECT_EOF;
 	obd_off ending_offset = 0;
-	int i, rc, mpflag = 0, mem_tight = 0, page_count = 0;
+	int i, j, rc, mpflag = 0, mem_tight = 0, page_count = 0;
+	int obj_count = 0;
 
 	ENTRY;
 	LASSERT(!cfs_list_empty(ext_list));
 
-	/* add pages into rpc_list to build BRW rpc */
+	/* add pages into rpc_list to build BRW rpc, extents of different
+	 * objects are grouped by osc_send_write_rpc() */
 	cfs_list_for_each_entry(ext, ext_list, oe_link) {
 		LASSERT(ext->oe_state == OES_RPC);
 		mem_tight |= ext->oe_memalloc;
+		if (ext->oe_obj != obj) {
+			obj = ext->oe_obj;
+			obj_count++;
+			obj_start = OBD_OBJECT_EOF;
+			ending_offset = 0;
+		}
 		cfs_list_for_each_entry(oap, &ext->oe_pages, oap_pending_item) {
 			++page_count;
 			cfs_list_add_tail(&oap->oap_rpc_item, &rpc_list);
-			if (starting_offset > oap->oap_obj_off)
-				starting_offset = oap->oap_obj_off;
+			if (obj_start > oap->oap_obj_off)
+				obj_start = oap->oap_obj_off;
 			else
 				LASSERT(oap->oap_page_off == 0);
 			if (ending_offset < oap->oap_obj_off + oap->oap_count)
@@ -2086,12 +2136,18 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 				LASSERT(oap->oap_page_off + oap->oap_count ==
 					CFS_PAGE_SIZE);
 		}
+		if (starting_offset > obj_start)
+			starting_offset = obj_start;
 	}
+	LASSERT(obj_count <= PTLRPC_MAX_BRW_OBJS);
 
 	if (mem_tight)
 		mpflag = cfs_memory_pressure_get_and_set();
 
-	memset(&crattr, 0, sizeof crattr);
+	OBD_ALLOC(crattr, sizeof(*crattr) * obj_count);
+	if (crattr == NULL)
+		GOTO(out, rc = -ENOMEM);
+
 	OBD_ALLOC(pga, sizeof(*pga) * page_count);
 	if (pga == NULL)
 		GOTO(out, rc = -ENOMEM);
@@ -2099,14 +2155,20 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 	OBDO_ALLOC(oa);
 	if (oa == NULL)
 		GOTO(out, rc = -ENOMEM);
+	crattr[0].cra_oa = oa;
+
+	/* the other objects only need their own attributes to be checked */
+	for (i = 1; i < obj_count; i++) {
+		OBDO_ALLOC(crattr[i].cra_oa);
+		if (crattr[i].cra_oa == NULL)
+			GOTO(out, rc = -ENOMEM);
+	}
 
 	i = 0;
 	cfs_list_for_each_entry(oap, &rpc_list, oap_rpc_item) {
 		struct cl_page *page = oap2cl_page(oap);
 		if (clerq == NULL) {
-			clerq = cl_req_alloc(env, page, crt,
-					     1 /* only 1-object rpcs for
-						* now */);
+			clerq = cl_req_alloc(env, page, crt, obj_count);
 			if (IS_ERR(clerq))
 				GOTO(out, rc = PTR_ERR(clerq));
 			lock = oap->oap_ldlm_lock;
@@ -2123,10 +2185,16 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 
         /* always get the data for the obdo for the rpc */
 	LASSERT(clerq != NULL);
-	crattr.cra_oa = oa;
-	crattr.cra_capa = NULL;
-	memset(crattr.cra_jobid, 0, JOBSTATS_JOBID_SIZE);
-        cl_req_attr_set(env, clerq, &crattr, ~0ULL);
+        cl_req_attr_set(env, clerq, crattr, ~0ULL);
+	for (i = 1; i < obj_count; i++) {
+		struct obdo *o = crattr[i].cra_oa;
+
+		/* the RPC carries the owner of the first object only */
+		if (o->o_uid != oa->o_uid || o->o_gid != oa->o_gid)
+			CDEBUG(D_CACHE, "object "DOSTID" owner %u:%u differs "
+			       "from RPC owner %u:%u\n", POSTID(&o->o_oi),
+			       o->o_uid, o->o_gid, oa->o_uid, oa->o_gid);
+	}
         if (lock) {
                 oa->o_handle = lock->l_remote_handle;
                 oa->o_valid |= OBD_MD_FLHANDLE;
@@ -2138,9 +2206,16 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 		GOTO(out, rc);
 	}
 
-	sort_brw_pages(pga, page_count);
+	/* pages are grouped by object, sort each group separately */
+	for (i = 0, j = 1; j <= page_count; j++) {
+		if (j < page_count && (obj_count == 1 ||
+		    osc_brw_page_obj(pga[j]) == osc_brw_page_obj(pga[i])))
+			continue;
+		sort_brw_pages(pga + i, j - i);
+		i = j;
+	}
 	rc = osc_brw_prep_request(cmd, cli, oa, NULL, page_count,
-			pga, &req, crattr.cra_capa, 1, 0);
+			pga, obj_count, &req, crattr[0].cra_capa, 1, 0);
 	if (rc != 0) {
 		CERROR("prep_req failed: %d\n", rc);
 		GOTO(out, rc);
@@ -2155,10 +2230,10 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
          * later setattr before earlier BRW (as determined by the request xid),
          * the OST will not use BRW timestamps.  Sadly, there is no obvious
          * way to do this in a single call.  bug 10150 */
-        cl_req_attr_set(env, clerq, &crattr,
+        cl_req_attr_set(env, clerq, crattr,
                         OBD_MD_FLMTIME|OBD_MD_FLCTIME|OBD_MD_FLATIME);
 
-	lustre_msg_set_jobid(req->rq_reqmsg, crattr.cra_jobid);
+	lustre_msg_set_jobid(req->rq_reqmsg, crattr[0].cra_jobid);
 
 	CLASSERT(sizeof(*aa) <= sizeof(req->rq_async_args));
 	aa = ptlrpc_req_async_args(req);
@@ -2201,8 +2276,8 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 	}
 	client_obd_list_unlock(&cli->cl_loi_list_lock);
 
-	DEBUG_REQ(D_INODE, req, "%d pages, aa %p. now %dr/%dw in flight",
-		  page_count, aa, cli->cl_r_in_flight,
+	DEBUG_REQ(D_INODE, req, "%d pages, %d objects, aa %p. now %dr/%dw in "
+		  "flight", page_count, obj_count, aa, cli->cl_r_in_flight,
 		  cli->cl_w_in_flight);
 
 	/* XXX: Maybe the caller can check the RPC bulk descriptor to
@@ -2225,7 +2300,14 @@ out:
 	if (mem_tight != 0)
 		cfs_memory_pressure_restore(mpflag);
 
-	capa_put(crattr.cra_capa);
+	if (crattr != NULL) {
+		for (i = 0; i < obj_count; i++) {
+			capa_put(crattr[i].cra_capa);
+			if (i > 0 && crattr[i].cra_oa != NULL)
+				OBDO_FREE(crattr[i].cra_oa);
+		}
+		OBD_FREE(crattr, sizeof(*crattr) * obj_count);
+	}
 	if (rc != 0) {
 		LASSERT(req == NULL);
 
@@ -3130,6 +3212,9 @@ static int osc_set_info_async(const struct lu_env *env, struct obd_export *exp,
 		struct client_obd *cli = &obd->u.cli;
 
 		LASSERT(cli->cl_cache == NULL); /* only once */
+		rc = osc_lru_batches_init(cli);
+		if (rc != 0)
+			RETURN(rc);
 		cli->cl_cache = (struct cl_client_cache *)val;
 		cfs_atomic_inc(&cli->cl_cache->ccc_users);
 		cli->cl_lru_left = &cli->cl_cache->ccc_lru_left;
@@ -3537,6 +3622,7 @@ int osc_cleanup(struct obd_device *obd)
 		cli->cl_lru_left = NULL;
 		cfs_atomic_dec(&cli->cl_cache->ccc_users);
 		cli->cl_cache = NULL;
+		osc_lru_batches_fini(cli);
 	}
 
         /* free memory of osc quota cache */
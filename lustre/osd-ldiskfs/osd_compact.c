@@ -0,0 +1,925 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License version 2 for more details.  A copy is
+ * included in the COPYING file that accompanied this code.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2013, Intel Corporation.
+ */
+/*
+ * lustre/osd-ldiskfs/osd_compact.c
+ *
+ * Online compaction of htree directories.
+ *
+ * ldiskfs never frees the blocks of a directory when its entries are
+ * removed, so a directory which once held millions of names keeps all of
+ * its leaf blocks, and readdir and lookup keep walking them. A directory
+ * is queued here after many names have been removed from it. A
+ * background thread then merges adjacent sparse leaves (and index nodes)
+ * of the htree, moves the last block of the directory into the freed one
+ * and truncates the directory by one block. Every such step is one
+ * transaction under the exclusive htree lock, which is dropped between
+ * the steps, so the directory stays accessible during the pass.
+ */
+
+#ifndef EXPORT_SYMTAB
+# define EXPORT_SYMTAB
+#endif
+#define DEBUG_SUBSYSTEM S_MDS
+
+#include <lustre/lustre_idl.h>
+#include <dt_object.h>
+
+#include "osd_internal.h"
+
+/* leaves examined under one lock hold */
+#define OSD_COMPACT_SCAN_BATCH	64
+
+/* htree index entry, the first one of a block holds dx_countlimit in
+ * place of the hash */
+struct osd_dx_entry {
+	__le32	ode_hash;
+	__le32	ode_block;
+};
+
+struct osd_dx_frame {
+	struct buffer_head	*odf_bh;
+	struct osd_dx_entry	*odf_entries;
+	int			 odf_at;
+};
+
+struct osd_compact_pass {
+	struct inode			*ocp_dir;
+	/* block sized scratch buffer for leaf merges */
+	char				*ocp_buf;
+	struct ldiskfs_dx_hash_info	 ocp_hinfo;
+	/* hash the scan resumes from */
+	__u32				 ocp_hash;
+	unsigned int			 ocp_levels;
+	/* root, and the index node of the leaves being scanned */
+	struct osd_dx_frame		 ocp_frames[2];
+	unsigned int			 ocp_freed;
+};
+
+enum osd_dx_merge {
+	OSD_DX_MERGE_NONE	= 0,
+	OSD_DX_MERGE_LEAF	= 1,
+	OSD_DX_MERGE_NODE	= 2,
+	/* the only index node is pulled into the root */
+	OSD_DX_MERGE_COLLAPSE	= 3,
+};
+
+static inline unsigned osd_dx_count(struct osd_dx_entry *entries)
+{
+	return le16_to_cpu(((struct dx_countlimit *)entries)->count);
+}
+
+static inline unsigned osd_dx_limit(struct osd_dx_entry *entries)
+{
+	return le16_to_cpu(((struct dx_countlimit *)entries)->limit);
+}
+
+static inline void osd_dx_set_count(struct osd_dx_entry *entries,
+				    unsigned count)
+{
+	((struct dx_countlimit *)entries)->count = cpu_to_le16(count);
+}
+
+static inline __u32 osd_dx_block(struct osd_dx_entry *entry)
+{
+	return le32_to_cpu(entry->ode_block) & 0x00ffffff;
+}
+
+static inline __u32 osd_dx_hash(struct osd_dx_entry *entry)
+{
+	return le32_to_cpu(entry->ode_hash);
+}
+
+/* last entry whose hash is not above @hash, entry 0 covers the lowest
+ * hashes of the block */
+static int osd_dx_search(struct osd_dx_entry *entries, __u32 hash)
+{
+	int count = osd_dx_count(entries);
+	int i;
+
+	for (i = 1; i < count; i++)
+		if (osd_dx_hash(&entries[i]) > hash)
+			break;
+
+	return i - 1;
+}
+
+static void osd_dx_remove(struct osd_dx_entry *entries, int at)
+{
+	unsigned count = osd_dx_count(entries);
+
+	LASSERT(at > 0 && at < count);
+	memmove(entries + at, entries + at + 1,
+		(count - at - 1) * sizeof(*entries));
+	osd_dx_set_count(entries, count - 1);
+}
+
+static void osd_dx_frame_release(struct osd_dx_frame *frame)
+{
+	if (frame->odf_bh != NULL) {
+		brelse(frame->odf_bh);
+		frame->odf_bh = NULL;
+	}
+}
+
+static int osd_dx_read_root(struct osd_compact_pass *ocp)
+{
+	struct inode		   *dir   = ocp->ocp_dir;
+	struct osd_dx_frame	   *frame = &ocp->ocp_frames[0];
+	struct ldiskfs_dir_entry_2 *de;
+	struct dx_root_info	   *info;
+	int			    rc    = 0;
+
+	frame->odf_bh = ldiskfs_bread(NULL, dir, 0, 0, &rc);
+	if (frame->odf_bh == NULL)
+		return rc != 0 ? rc : -EIO;
+
+	/* "." and ".." may carry dirdata, dx_root_info follows the records
+	 * of both */
+	de = (struct ldiskfs_dir_entry_2 *)frame->odf_bh->b_data;
+	de = (struct ldiskfs_dir_entry_2 *)((char *)de + LDISKFS_DIR_REC_LEN(de));
+	info = (struct dx_root_info *)((char *)de + LDISKFS_DIR_REC_LEN(de));
+
+	/* ldiskfs does not support more than one level of index nodes */
+	if (info->reserved_zero != 0 || info->info_length != 8 ||
+	    info->indirect_levels > 1 || info->unused_flags & 1)
+		return -EOPNOTSUPP;
+
+	ocp->ocp_levels = info->indirect_levels;
+	ocp->ocp_hinfo.hash_version = info->hash_version;
+	if (ocp->ocp_hinfo.hash_version <= LDISKFS_DX_HASH_TEA)
+		ocp->ocp_hinfo.hash_version +=
+			LDISKFS_SB(dir->i_sb)->s_hash_unsigned;
+	ocp->ocp_hinfo.seed = LDISKFS_SB(dir->i_sb)->s_hash_seed;
+	frame->odf_entries = (struct osd_dx_entry *)((char *)info +
+						     info->info_length);
+	if (osd_dx_count(frame->odf_entries) == 0 ||
+	    osd_dx_count(frame->odf_entries) >
+	    osd_dx_limit(frame->odf_entries))
+		return -EIO;
+
+	return 0;
+}
+
+static int osd_dx_read_node(struct inode *dir, __u32 block,
+			    struct osd_dx_frame *frame)
+{
+	unsigned limit = (dir->i_sb->s_blocksize -
+			  sizeof(struct fake_dirent)) / sizeof(struct osd_dx_entry);
+	int	 rc    = 0;
+
+	frame->odf_bh = ldiskfs_bread(NULL, dir, block, 0, &rc);
+	if (frame->odf_bh == NULL)
+		return rc != 0 ? rc : -EIO;
+
+	frame->odf_entries = (struct osd_dx_entry *)(frame->odf_bh->b_data +
+						     sizeof(struct fake_dirent));
+	if (osd_dx_limit(frame->odf_entries) != limit ||
+	    osd_dx_count(frame->odf_entries) == 0 ||
+	    osd_dx_count(frame->odf_entries) > limit) {
+		osd_dx_frame_release(frame);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/* bytes taken by the live entries of leaf @block */
+static int osd_dx_leaf_used(struct inode *dir, __u32 block, int *used)
+{
+	unsigned		    blocksize = dir->i_sb->s_blocksize;
+	struct buffer_head	   *bh;
+	struct ldiskfs_dir_entry_2 *de;
+	char			   *top;
+	int			    rc = 0;
+
+	bh = ldiskfs_bread(NULL, dir, block, 0, &rc);
+	if (bh == NULL)
+		return rc != 0 ? rc : -EIO;
+
+	*used = 0;
+	de = (struct ldiskfs_dir_entry_2 *)bh->b_data;
+	top = bh->b_data + blocksize;
+	while ((char *)de < top) {
+		int rlen = ldiskfs_rec_len_from_disk(de->rec_len, blocksize);
+
+		if (rlen < __LDISKFS_DIR_REC_LEN(1) || (rlen & 3) != 0 ||
+		    (char *)de + rlen > top ||
+		    (de->inode != 0 && rlen < LDISKFS_DIR_REC_LEN(de))) {
+			rc = -EIO;
+			break;
+		}
+
+		if (de->inode != 0)
+			*used += LDISKFS_DIR_REC_LEN(de);
+		de = (struct ldiskfs_dir_entry_2 *)((char *)de + rlen);
+	}
+	brelse(bh);
+
+	return rc;
+}
+
+/* hash of the first name of leaf @block, a removed first entry keeps its
+ * name so this works for an emptied leaf too */
+static int osd_dx_leaf_hash(struct osd_compact_pass *ocp, __u32 block,
+			    __u32 *hash)
+{
+	struct ldiskfs_dx_hash_info hinfo = ocp->ocp_hinfo;
+	struct ldiskfs_dir_entry_2 *de;
+	struct buffer_head	   *bh;
+	int			    rc = 0;
+
+	bh = ldiskfs_bread(NULL, ocp->ocp_dir, block, 0, &rc);
+	if (bh == NULL)
+		return rc != 0 ? rc : -EIO;
+
+	de = (struct ldiskfs_dir_entry_2 *)bh->b_data;
+	if (de->name_len == 0) {
+		rc = -ENODATA;
+	} else {
+		ldiskfsfs_dirhash(de->name, de->name_len, &hinfo);
+		*hash = hinfo.hash;
+	}
+	brelse(bh);
+
+	return rc;
+}
+
+/* find the index entry pointing at @block, the buffer returned in @bhp
+ * holds a reference */
+static int osd_dx_find_parent(struct osd_compact_pass *ocp, __u32 block,
+			      struct buffer_head **bhp,
+			      struct osd_dx_entry **entryp)
+{
+	struct osd_dx_frame *root = &ocp->ocp_frames[0];
+	struct osd_dx_frame  node = { 0 };
+	int		     count = osd_dx_count(root->odf_entries);
+	int		     hint = -1;
+	__u32		     hash;
+	int		     i;
+	int		     j;
+
+	for (i = 0; i < count; i++) {
+		if (osd_dx_block(&root->odf_entries[i]) == block) {
+			get_bh(root->odf_bh);
+			*bhp = root->odf_bh;
+			*entryp = &root->odf_entries[i];
+			return 0;
+		}
+	}
+
+	if (ocp->ocp_levels == 0)
+		return -ENOENT;
+
+	/* a leaf under an index node, try the node its first name hashes to
+	 * before scanning all of them */
+	if (osd_dx_leaf_hash(ocp, block, &hash) == 0)
+		hint = osd_dx_search(root->odf_entries, hash);
+
+	for (i = -1; i < count; i++) {
+		int n = i < 0 ? hint : i;
+
+		if (n < 0 || (i >= 0 && i == hint))
+			continue;
+
+		if (osd_dx_read_node(ocp->ocp_dir,
+				     osd_dx_block(&root->odf_entries[n]),
+				     &node) != 0)
+			continue;
+
+		for (j = 0; j < osd_dx_count(node.odf_entries); j++) {
+			if (osd_dx_block(&node.odf_entries[j]) == block) {
+				*bhp = node.odf_bh;
+				*entryp = &node.odf_entries[j];
+				return 0;
+			}
+		}
+		osd_dx_frame_release(&node);
+	}
+
+	return -ENOENT;
+}
+
+/* copy the live entries of @bh to @buf at @pos */
+static int osd_dx_pack(struct buffer_head *bh, unsigned blocksize, char *buf,
+		       int pos, struct ldiskfs_dir_entry_2 **last)
+{
+	struct ldiskfs_dir_entry_2 *de  = (struct ldiskfs_dir_entry_2 *)bh->b_data;
+	char			   *top = bh->b_data + blocksize;
+
+	while ((char *)de < top) {
+		int rlen = ldiskfs_rec_len_from_disk(de->rec_len, blocksize);
+
+		if (de->inode != 0) {
+			int len = LDISKFS_DIR_REC_LEN(de);
+
+			memcpy(buf + pos, de, len);
+			*last = (struct ldiskfs_dir_entry_2 *)(buf + pos);
+			(*last)->rec_len = ldiskfs_rec_len_to_disk(len,
+								   blocksize);
+			pos += len;
+		}
+		de = (struct ldiskfs_dir_entry_2 *)((char *)de + rlen);
+	}
+
+	return pos;
+}
+
+/* move the live entries of leaf @src into leaf @dst */
+static int osd_dx_merge_leaf(handle_t *jh, struct osd_compact_pass *ocp,
+			     __u32 dst, __u32 src)
+{
+	struct inode		   *dir = ocp->ocp_dir;
+	unsigned		    blocksize = dir->i_sb->s_blocksize;
+	struct ldiskfs_dir_entry_2 *last = NULL;
+	struct buffer_head	   *dbh;
+	struct buffer_head	   *sbh;
+	int			    pos;
+	int			    rc = 0;
+
+	dbh = ldiskfs_bread(NULL, dir, dst, 0, &rc);
+	if (dbh == NULL)
+		return rc != 0 ? rc : -EIO;
+
+	sbh = ldiskfs_bread(NULL, dir, src, 0, &rc);
+	if (sbh == NULL) {
+		brelse(dbh);
+		return rc != 0 ? rc : -EIO;
+	}
+
+	memset(ocp->ocp_buf, 0, blocksize);
+	pos = osd_dx_pack(dbh, blocksize, ocp->ocp_buf, 0, &last);
+	pos = osd_dx_pack(sbh, blocksize, ocp->ocp_buf, pos, &last);
+	LASSERT(pos <= blocksize);
+	if (last == NULL) {
+		last = (struct ldiskfs_dir_entry_2 *)ocp->ocp_buf;
+		last->rec_len = ldiskfs_rec_len_to_disk(blocksize, blocksize);
+	} else {
+		last->rec_len = ldiskfs_rec_len_to_disk(blocksize -
+					((char *)last - ocp->ocp_buf),
+					blocksize);
+	}
+
+	rc = ldiskfs_journal_get_write_access(jh, dbh);
+	if (rc == 0) {
+		memcpy(dbh->b_data, ocp->ocp_buf, blocksize);
+		rc = ldiskfs_journal_dirty_metadata(jh, dbh);
+	}
+	brelse(sbh);
+	brelse(dbh);
+
+	return rc;
+}
+
+/* append the entries of the index node at @at + 1 of the root to the
+ * node at @at, and drop it from the root */
+static int osd_dx_merge_node(handle_t *jh, struct osd_compact_pass *ocp,
+			     struct osd_dx_frame *dst, struct osd_dx_frame *src)
+{
+	struct osd_dx_frame *root = &ocp->ocp_frames[0];
+	struct osd_dx_entry *entries = dst->odf_entries;
+	unsigned	     count = osd_dx_count(entries);
+	unsigned	     scount = osd_dx_count(src->odf_entries);
+	int		     rc;
+
+	rc = ldiskfs_journal_get_write_access(jh, dst->odf_bh);
+	if (rc != 0)
+		return rc;
+
+	/* the hash of the first entry of a node is kept by its parent */
+	entries[count].ode_hash = root->odf_entries[root->odf_at + 1].ode_hash;
+	entries[count].ode_block = src->odf_entries[0].ode_block;
+	memcpy(entries + count + 1, src->odf_entries + 1,
+	       (scount - 1) * sizeof(*entries));
+	osd_dx_set_count(entries, count + scount);
+	rc = ldiskfs_journal_dirty_metadata(jh, dst->odf_bh);
+	if (rc != 0)
+		return rc;
+
+	rc = ldiskfs_journal_get_write_access(jh, root->odf_bh);
+	if (rc != 0)
+		return rc;
+
+	osd_dx_remove(root->odf_entries, root->odf_at + 1);
+	return ldiskfs_journal_dirty_metadata(jh, root->odf_bh);
+}
+
+/* pull the entries of the only index node into the root */
+static int osd_dx_collapse(handle_t *jh, struct osd_compact_pass *ocp,
+			   struct osd_dx_frame *node)
+{
+	struct osd_dx_frame *root = &ocp->ocp_frames[0];
+	struct ldiskfs_dir_entry_2 *de;
+	struct dx_root_info *info;
+	unsigned	     count = osd_dx_count(node->odf_entries);
+	int		     rc;
+
+	rc = ldiskfs_journal_get_write_access(jh, root->odf_bh);
+	if (rc != 0)
+		return rc;
+
+	root->odf_entries[0].ode_block = node->odf_entries[0].ode_block;
+	memcpy(root->odf_entries + 1, node->odf_entries + 1,
+	       (count - 1) * sizeof(struct osd_dx_entry));
+	osd_dx_set_count(root->odf_entries, count);
+
+	de = (struct ldiskfs_dir_entry_2 *)root->odf_bh->b_data;
+	de = (struct ldiskfs_dir_entry_2 *)((char *)de + LDISKFS_DIR_REC_LEN(de));
+	info = (struct dx_root_info *)((char *)de + LDISKFS_DIR_REC_LEN(de));
+	info->indirect_levels = 0;
+	ocp->ocp_levels = 0;
+
+	return ldiskfs_journal_dirty_metadata(jh, root->odf_bh);
+}
+
+/* copy block @from into the freed block @to and repoint its parent */
+static int osd_dx_move_block(handle_t *jh, struct osd_compact_pass *ocp,
+			     __u32 from, __u32 to)
+{
+	struct inode	    *dir = ocp->ocp_dir;
+	struct buffer_head  *pbh;
+	struct buffer_head  *sbh;
+	struct buffer_head  *dbh;
+	struct osd_dx_entry *entry;
+	int		     rc;
+
+	rc = osd_dx_find_parent(ocp, from, &pbh, &entry);
+	if (rc != 0)
+		return rc;
+
+	sbh = ldiskfs_bread(NULL, dir, from, 0, &rc);
+	if (sbh == NULL)
+		GOTO(out_parent, rc = (rc != 0 ? rc : -EIO));
+
+	dbh = ldiskfs_bread(NULL, dir, to, 0, &rc);
+	if (dbh == NULL)
+		GOTO(out_src, rc = (rc != 0 ? rc : -EIO));
+
+	rc = ldiskfs_journal_get_write_access(jh, dbh);
+	if (rc != 0)
+		GOTO(out_dst, rc);
+
+	memcpy(dbh->b_data, sbh->b_data, dir->i_sb->s_blocksize);
+	rc = ldiskfs_journal_dirty_metadata(jh, dbh);
+	if (rc != 0)
+		GOTO(out_dst, rc);
+
+	rc = ldiskfs_journal_get_write_access(jh, pbh);
+	if (rc != 0)
+		GOTO(out_dst, rc);
+
+	entry->ode_block = cpu_to_le32((le32_to_cpu(entry->ode_block) &
+					~0x00ffffff) | to);
+	rc = ldiskfs_journal_dirty_metadata(jh, pbh);
+
+out_dst:
+	brelse(dbh);
+out_src:
+	brelse(sbh);
+out_parent:
+	brelse(pbh);
+	return rc;
+}
+
+/* drop the last block of the directory */
+static int osd_dx_truncate(handle_t *jh, struct inode *dir, __u32 blocks)
+{
+	struct timespec mtime = dir->i_mtime;
+	struct timespec ctime = dir->i_ctime;
+
+	i_size_write(dir, (loff_t)blocks << dir->i_blkbits);
+	LDISKFS_I(dir)->i_disksize = i_size_read(dir);
+	ldiskfs_truncate(dir);
+
+	/* compaction is not a change of the directory */
+	dir->i_mtime = mtime;
+	dir->i_ctime = ctime;
+	return ldiskfs_mark_inode_dirty(jh, dir);
+}
+
+/*
+ * Free at most one block of the directory.
+ *
+ * \retval 1	the step is done, call again
+ * \retval 0	the pass is over
+ * \retval -ve	failure
+ */
+static int osd_compact_step(handle_t *jh, struct osd_compact *oc,
+			    struct osd_compact_pass *ocp)
+{
+	struct inode		*dir   = ocp->ocp_dir;
+	unsigned		 blocksize = dir->i_sb->s_blocksize;
+	struct osd_dx_frame	*root  = &ocp->ocp_frames[0];
+	struct osd_dx_frame	*frame = root;
+	struct osd_dx_frame	 next  = { 0 };
+	struct buffer_head	*pbh;
+	struct osd_dx_entry	*entry;
+	enum osd_dx_merge	 merge = OSD_DX_MERGE_NONE;
+	__u32			 last;
+	__u32			 freed = 0;
+	int			 used  = -1;
+	int			 used2;
+	int			 scanned;
+	int			 rc;
+
+	if (!(LDISKFS_I(dir)->i_flags & LDISKFS_INDEX_FL) || dir->i_nlink == 0)
+		return 0;
+
+	last = (i_size_read(dir) >> dir->i_blkbits) - 1;
+	if (last < 2)
+		return 0;
+
+	rc = osd_dx_read_root(ocp);
+	if (rc != 0)
+		GOTO(out, rc = (rc == -EOPNOTSUPP ? 0 : rc));
+
+	root->odf_at = osd_dx_search(root->odf_entries, ocp->ocp_hash);
+	if (ocp->ocp_levels > 0) {
+		frame = &ocp->ocp_frames[1];
+		rc = osd_dx_read_node(dir,
+				osd_dx_block(&root->odf_entries[root->odf_at]),
+				frame);
+		if (rc != 0)
+			GOTO(out, rc);
+		frame->odf_at = osd_dx_search(frame->odf_entries,
+					      ocp->ocp_hash);
+	}
+
+	/* merge adjacent leaves of the index block */
+	for (scanned = 0; frame->odf_at + 1 < osd_dx_count(frame->odf_entries);
+	     scanned++) {
+		entry = &frame->odf_entries[frame->odf_at];
+		if (scanned >= OSD_COMPACT_SCAN_BATCH)
+			GOTO(out, rc = 1);
+
+		if (used < 0) {
+			rc = osd_dx_leaf_used(dir, osd_dx_block(entry), &used);
+			if (rc != 0)
+				GOTO(out, rc);
+		}
+		rc = osd_dx_leaf_used(dir, osd_dx_block(entry + 1), &used2);
+		if (rc != 0)
+			GOTO(out, rc);
+
+		if (used + used2 <= blocksize * oc->oc_fill / 100) {
+			merge = OSD_DX_MERGE_LEAF;
+			freed = osd_dx_block(entry + 1);
+			break;
+		}
+
+		frame->odf_at++;
+		ocp->ocp_hash = osd_dx_hash(entry + 1);
+		used = used2;
+	}
+
+	if (merge == OSD_DX_MERGE_NONE && ocp->ocp_levels > 0) {
+		int count = osd_dx_count(frame->odf_entries);
+
+		entry = &root->odf_entries[root->odf_at];
+		if (root->odf_at + 1 < osd_dx_count(root->odf_entries)) {
+			rc = osd_dx_read_node(dir, osd_dx_block(entry + 1),
+					      &next);
+			if (rc != 0)
+				GOTO(out, rc);
+
+			if (count + osd_dx_count(next.odf_entries) <=
+			    osd_dx_limit(frame->odf_entries) * oc->oc_fill /
+			    100) {
+				merge = OSD_DX_MERGE_NODE;
+				freed = osd_dx_block(entry + 1);
+			} else {
+				ocp->ocp_hash = osd_dx_hash(entry + 1);
+				GOTO(out, rc = 1);
+			}
+		} else if (osd_dx_count(root->odf_entries) == 1 &&
+			   count <= osd_dx_limit(root->odf_entries)) {
+			merge = OSD_DX_MERGE_COLLAPSE;
+			freed = osd_dx_block(entry);
+		}
+	}
+
+	if (merge == OSD_DX_MERGE_NONE)
+		GOTO(out, rc = 0);
+
+	/* the last block is moved into the freed one, check that its
+	 * parent can be found before anything is changed */
+	if (freed != last) {
+		rc = osd_dx_find_parent(ocp, last, &pbh, &entry);
+		if (rc != 0)
+			GOTO(out, rc);
+		brelse(pbh);
+	}
+
+	switch (merge) {
+	case OSD_DX_MERGE_LEAF:
+		entry = &frame->odf_entries[frame->odf_at];
+		rc = osd_dx_merge_leaf(jh, ocp, osd_dx_block(entry), freed);
+		if (rc != 0)
+			break;
+
+		rc = ldiskfs_journal_get_write_access(jh, frame->odf_bh);
+		if (rc != 0)
+			break;
+
+		osd_dx_remove(frame->odf_entries, frame->odf_at + 1);
+		rc = ldiskfs_journal_dirty_metadata(jh, frame->odf_bh);
+		if (rc == 0)
+			oc->oc_leaves_merged++;
+		break;
+	case OSD_DX_MERGE_NODE:
+		rc = osd_dx_merge_node(jh, ocp, frame, &next);
+		if (rc == 0)
+			oc->oc_nodes_merged++;
+		break;
+	case OSD_DX_MERGE_COLLAPSE:
+		rc = osd_dx_collapse(jh, ocp, frame);
+		if (rc == 0)
+			oc->oc_nodes_merged++;
+		break;
+	default:
+		LBUG();
+	}
+
+	if (rc == 0 && freed != last)
+		rc = osd_dx_move_block(jh, ocp, last, freed);
+
+out:
+	osd_dx_frame_release(&next);
+	osd_dx_frame_release(&ocp->ocp_frames[1]);
+	osd_dx_frame_release(root);
+	if (merge != OSD_DX_MERGE_NONE && rc == 0) {
+		rc = osd_dx_truncate(jh, dir, last);
+		if (rc == 0) {
+			ocp->ocp_freed++;
+			oc->oc_blocks_freed++;
+			rc = 1;
+		}
+	}
+
+	return rc;
+}
+
+static void osd_compact_dir(const struct lu_env *env, struct osd_device *dev,
+			    struct osd_object *obj, char *buf)
+{
+	struct osd_compact	*oc    = &dev->od_compact;
+	struct inode		*dir   = obj->oo_inode;
+	struct htree_lock	*hlock = NULL;
+	struct osd_compact_pass	 ocp   = { 0 };
+	handle_t		*jh;
+	int			 credits;
+	int			 rc    = 1;
+	ENTRY;
+
+	if (!dt_object_exists(&obj->oo_dt) || dir == NULL)
+		RETURN_EXIT;
+
+	ocp.ocp_dir = dir;
+	ocp.ocp_buf = buf;
+
+	/* index and leaf blocks like a delete, freeing the last block like
+	 * a destroy, one credit each for user and group quota */
+	credits = osd_dto_credits_noquota[DTO_INDEX_DELETE] +
+		  osd_dto_credits_noquota[DTO_OBJECT_DELETE] + 2;
+
+	ll_vfs_dq_init(dir);
+	while (rc > 0 && thread_is_running(&oc->oc_thread)) {
+		jh = ldiskfs_journal_start_sb(osd_sb(dev), credits);
+		if (IS_ERR(jh)) {
+			rc = PTR_ERR(jh);
+			break;
+		}
+
+		/* start journal before the PDO lock, like the other index
+		 * operations. "0" means exclusive lock for the whole
+		 * directory, the index blocks are changed */
+		if (obj->oo_hl_head != NULL) {
+			hlock = osd_oti_get(env)->oti_hlock;
+			ldiskfs_htree_lock(hlock, obj->oo_hl_head, dir, 0);
+		} else {
+			down_write(&obj->oo_ext_idx_sem);
+		}
+
+		rc = osd_compact_step(jh, oc, &ocp);
+
+		if (hlock != NULL)
+			ldiskfs_htree_unlock(hlock);
+		else
+			up_write(&obj->oo_ext_idx_sem);
+		ldiskfs_journal_stop(jh);
+
+		cfs_cond_resched();
+	}
+
+	oc->oc_dirs++;
+	if (rc < 0) {
+		oc->oc_failed++;
+		CDEBUG(D_INODE, "%s: compaction of dir %lu failed: rc = %d\n",
+		       osd_name(dev), dir->i_ino, rc);
+	}
+
+	CDEBUG(D_INODE, "%s: dir %lu compacted, %u blocks freed\n",
+	       osd_name(dev), dir->i_ino, ocp.ocp_freed);
+	EXIT;
+}
+
+static int osd_compact_main(void *args)
+{
+	struct lu_env		 env;
+	struct osd_device	*dev    = args;
+	struct osd_compact	*oc     = &dev->od_compact;
+	struct ptlrpc_thread	*thread = &oc->oc_thread;
+	struct l_wait_info	 lwi    = { 0 };
+	struct osd_object	*obj;
+	CFS_LIST_HEAD		(list);
+	char			*buf;
+	int			 rc;
+	ENTRY;
+
+	cfs_daemonize("osd_compact");
+	rc = lu_env_init(&env, LCT_DT_THREAD);
+	if (rc != 0) {
+		CERROR("%s: dir compaction, fail to init env, rc = %d\n",
+		       osd_name(dev), rc);
+		GOTO(noenv, rc);
+	}
+
+	OBD_ALLOC_LARGE(buf, osd_sb(dev)->s_blocksize);
+	if (buf == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	spin_lock(&oc->oc_lock);
+	thread_set_flags(thread, SVC_RUNNING);
+	spin_unlock(&oc->oc_lock);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+
+	while (1) {
+		l_wait_event(thread->t_ctl_waitq,
+			     !cfs_list_empty(&oc->oc_list) ||
+			     !thread_is_running(thread),
+			     &lwi);
+		if (!thread_is_running(thread))
+			break;
+
+		spin_lock(&oc->oc_lock);
+		obj = cfs_list_entry(oc->oc_list.next, struct osd_object,
+				     oo_compact_list);
+		cfs_list_del_init(&obj->oo_compact_list);
+		oc->oc_queued--;
+		spin_unlock(&oc->oc_lock);
+
+		osd_compact_dir(&env, dev, obj, buf);
+		lu_object_put(&env, &obj->oo_dt.do_lu);
+	}
+
+	OBD_FREE_LARGE(buf, osd_sb(dev)->s_blocksize);
+
+out:
+	/* nothing is queued once the thread is not running */
+	spin_lock(&oc->oc_lock);
+	cfs_list_splice_init(&oc->oc_list, &list);
+	oc->oc_queued = 0;
+	spin_unlock(&oc->oc_lock);
+
+	while (!cfs_list_empty(&list)) {
+		obj = cfs_list_entry(list.next, struct osd_object,
+				     oo_compact_list);
+		cfs_list_del_init(&obj->oo_compact_list);
+		lu_object_put(&env, &obj->oo_dt.do_lu);
+	}
+	lu_env_fini(&env);
+
+noenv:
+	spin_lock(&oc->oc_lock);
+	thread_set_flags(thread, SVC_STOPPED);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+	spin_unlock(&oc->oc_lock);
+	return rc;
+}
+
+/* called after a name is removed from @obj */
+void osd_compact_check(struct osd_object *obj)
+{
+	struct osd_device  *dev  = osd_obj2dev(obj);
+	struct osd_compact *oc   = &dev->od_compact;
+	struct inode	   *dir  = obj->oo_inode;
+	__u64		    blocks;
+	int		    wake = 0;
+
+	if (oc->oc_min_blocks == 0 ||
+	    !(LDISKFS_I(dir)->i_flags & LDISKFS_INDEX_FL))
+		return;
+
+	blocks = i_size_read(dir) >> dir->i_blkbits;
+	if (blocks < oc->oc_min_blocks)
+		return;
+
+	/* racy, it is only a hint of how sparse the directory is */
+	if (++obj->oo_compact_dels < blocks * OSD_COMPACT_DELS_PER_BLOCK)
+		return;
+
+	spin_lock(&oc->oc_lock);
+	if (thread_is_running(&oc->oc_thread) &&
+	    cfs_list_empty(&obj->oo_compact_list) &&
+	    oc->oc_queued < OSD_COMPACT_MAX_QUEUED) {
+		obj->oo_compact_dels = 0;
+		lu_object_get(&obj->oo_dt.do_lu);
+		cfs_list_add_tail(&obj->oo_compact_list, &oc->oc_list);
+		oc->oc_queued++;
+		wake = 1;
+	}
+	spin_unlock(&oc->oc_lock);
+
+	if (wake)
+		cfs_waitq_signal(&oc->oc_thread.t_ctl_waitq);
+}
+
+int osd_compact_setup(struct osd_device *dev)
+{
+	struct osd_compact	*oc     = &dev->od_compact;
+	struct ptlrpc_thread	*thread = &oc->oc_thread;
+	struct l_wait_info	 lwi    = { 0 };
+	int			 rc;
+	ENTRY;
+
+	spin_lock_init(&oc->oc_lock);
+	CFS_INIT_LIST_HEAD(&oc->oc_list);
+	cfs_waitq_init(&thread->t_ctl_waitq);
+	oc->oc_min_blocks = OSD_COMPACT_MIN_BLOCKS;
+	oc->oc_fill = OSD_COMPACT_FILL;
+
+	rc = cfs_create_thread(osd_compact_main, dev, 0);
+	if (rc < 0) {
+		CERROR("%s: cannot start dir compaction thread, rc = %d\n",
+		       osd_name(dev), rc);
+		RETURN(rc);
+	}
+
+	l_wait_event(thread->t_ctl_waitq,
+		     thread_is_running(thread) || thread_is_stopped(thread),
+		     &lwi);
+
+	RETURN(0);
+}
+
+void osd_compact_cleanup(struct osd_device *dev)
+{
+	struct osd_compact	*oc     = &dev->od_compact;
+	struct ptlrpc_thread	*thread = &oc->oc_thread;
+	struct l_wait_info	 lwi    = { 0 };
+
+	/* never started */
+	if (thread_is_init(thread))
+		return;
+
+	spin_lock(&oc->oc_lock);
+	if (!thread_is_stopped(thread)) {
+		thread_set_flags(thread, SVC_STOPPING);
+		spin_unlock(&oc->oc_lock);
+		cfs_waitq_broadcast(&thread->t_ctl_waitq);
+		l_wait_event(thread->t_ctl_waitq,
+			     thread_is_stopped(thread),
+			     &lwi);
+		spin_lock(&oc->oc_lock);
+	}
+	spin_unlock(&oc->oc_lock);
+}
+
+int osd_compact_dump(struct osd_device *dev, char *buf, int len)
+{
+	struct osd_compact *oc = &dev->od_compact;
+
+	return snprintf(buf, len,
+			"min_blocks: %u\n"
+			"fill: %u%%\n"
+			"queued: %u\n"
+			"directories: "LPU64"\n"
+			"leaves_merged: "LPU64"\n"
+			"index_merged: "LPU64"\n"
+			"blocks_freed: "LPU64"\n"
+			"failed: "LPU64"\n",
+			oc->oc_min_blocks, oc->oc_fill, oc->oc_queued,
+			oc->oc_dirs, oc->oc_leaves_merged, oc->oc_nodes_merged,
+			oc->oc_blocks_freed, oc->oc_failed);
+}
@@ -162,6 +162,7 @@ static struct lu_object *osd_object_alloc(const struct lu_env *env,
 		init_rwsem(&mo->oo_sem);
 		init_rwsem(&mo->oo_ext_idx_sem);
 		spin_lock_init(&mo->oo_guard);
+		CFS_INIT_LIST_HEAD(&mo->oo_compact_list);
                 return l;
         } else {
                 return NULL;
@@ -1670,6 +1671,7 @@ static int osd_attr_set(const struct lu_env *env,
 		rc = iam_update(oh->ot_handle, bag, (const struct iam_key *)fid1,
 				(const struct iam_rec *)id, ipd);
 		osd_ipd_put(env, bag, ipd);
+		osd_oi_cache_drop(osd_dev(dt->do_lu.lo_dev), fid0);
 		return(rc > 0 ? 0 : rc);
 	}
 
@@ -3293,6 +3295,8 @@ static int osd_index_ea_delete(const struct lu_env *env, struct dt_object *dt,
 	if (rc != 0)
 		GOTO(out, rc);
 
+	osd_compact_check(obj);
+
 	/* For inode on the remote MDT, .. will point to
 	 * /Agent directory, Check whether it needs to delete
 	 * from agent directory */
@@ -5135,6 +5139,7 @@ static int osd_shutdown(const struct lu_env *env, struct osd_device *o)
 {
 	ENTRY;
 
+	osd_compact_cleanup(o);
 	osd_scrub_cleanup(env, o);
 
 	if (o->od_fsops) {
@@ -5337,6 +5342,10 @@ static int osd_device_init0(const struct lu_env *env,
 	if (rc)
 		GOTO(out_site, rc);
 
+	rc = osd_compact_setup(o);
+	if (rc != 0)
+		GOTO(out_site, rc);
+
 	rc = osd_procfs_init(o, o->od_svname);
 	if (rc != 0) {
 		CERROR("%s: can't initialize procfs: rc = %d\n",
@@ -5585,15 +5594,25 @@ static int __init osd_mod_init(void)
 {
         struct lprocfs_static_vars lvars;
 
+	int rc;
+
         osd_oi_mod_init();
+	rc = osd_bio_sched_init();
+	if (rc != 0)
+		return rc;
+
         lprocfs_osd_init_vars(&lvars);
-        return class_register_type(&osd_obd_device_ops, NULL, lvars.module_vars,
-				   LUSTRE_OSD_LDISKFS_NAME, &osd_device_type);
+	rc = class_register_type(&osd_obd_device_ops, NULL, lvars.module_vars,
+				 LUSTRE_OSD_LDISKFS_NAME, &osd_device_type);
+	if (rc != 0)
+		osd_bio_sched_fini();
+	return rc;
 }
 
 static void __exit osd_mod_exit(void)
 {
 	class_unregister_type(LUSTRE_OSD_LDISKFS_NAME);
+	osd_bio_sched_fini();
 }
 
 MODULE_AUTHOR("Sun Microsystems, Inc. <http://www.lustre.org/>");
@@ -140,6 +140,11 @@ struct osd_object {
         int                     oo_compat_dotdot_created;
 
         const struct lu_env    *oo_owner;
+
+	/* names removed since the directory was last queued for compaction,
+	 * and link to osd_compact::oc_list */
+	__u32			oo_compact_dels;
+	cfs_list_t		oo_compact_list;
 #ifdef CONFIG_LOCKDEP
         struct lockdep_map      oo_dep_map;
 #endif
@@ -228,6 +233,31 @@ struct osd_otable_it {
 
 extern const int osd_dto_credits_noquota[];
 
+/* directories of at least this many blocks are compacted */
+#define OSD_COMPACT_MIN_BLOCKS		128
+/* merge two blocks whose entries fill at most this percentage of one */
+#define OSD_COMPACT_FILL		50
+/* queue a directory after this many removals per block */
+#define OSD_COMPACT_DELS_PER_BLOCK	16
+#define OSD_COMPACT_MAX_QUEUED		1024
+
+/* online compaction of htree directories, see osd_compact.c */
+struct osd_compact {
+	spinlock_t		oc_lock;
+	/* directories waiting for a pass, each holds an object reference */
+	cfs_list_t		oc_list;
+	unsigned int		oc_queued;
+	struct ptlrpc_thread	oc_thread;
+	/* 0 disables compaction */
+	unsigned int		oc_min_blocks;
+	unsigned int		oc_fill;
+	__u64			oc_dirs;
+	__u64			oc_leaves_merged;
+	__u64			oc_nodes_merged;
+	__u64			oc_blocks_freed;
+	__u64			oc_failed;
+};
+
 /*
  * osd device.
  */
@@ -240,6 +270,10 @@ struct osd_device {
         struct osd_oi           **od_oi_table;
         /* total number of OI containers */
         int                       od_oi_count;
+	/* FID to inode cache in front of the OI, partitioned per CPT */
+	struct osd_oi_cache_part **od_oi_cache;
+	/* max cached entries, 0 disables the cache */
+	unsigned int		  od_oi_cache_size;
         /*
          * Fid Capability
          */
@@ -273,6 +307,8 @@ struct osd_device {
         unsigned long long        od_readcache_max_filesize;
         int                       od_read_cache;
         int                       od_writethrough_cache;
+	/* pages per bio segment submitted in parallel, 0: serial */
+	unsigned int		  od_bio_seg_pages;
 
         struct brw_stats          od_brw_stats;
         cfs_atomic_t              od_r_in_flight;
@@ -282,6 +318,7 @@ struct osd_device {
 	struct osd_otable_it	 *od_otable_it;
 	struct osd_scrub	  od_scrub;
 	cfs_list_t		  od_ios_list;
+	struct osd_compact	  od_compact;
 
 	/* service name associated with the osd device */
 	char                      od_svname[MAX_OBD_NAME];
@@ -465,13 +502,31 @@ struct osd_it_quota {
 
 #define MAX_BLOCKS_PER_PAGE (CFS_PAGE_SIZE / 512)
 
+/* max # of bio segments of one iobuf submitted in parallel */
+#define OSD_BIO_MAX_SEGS	16
+
+/* a range of iobuf pages whose bios are built and submitted by a thread
+ * of the per-CPT submission pool */
+struct osd_bio_seg {
+	cfs_workitem_t		 obs_wi;
+	struct osd_iobuf	*obs_iobuf;
+	struct inode		*obs_inode;
+	int			 obs_start;	/* first page */
+	int			 obs_npages;
+	int			 obs_cpt;
+};
+
 struct osd_iobuf {
 	cfs_waitq_t        dr_wait;
 	cfs_atomic_t       dr_numreqs;  /* number of reqs being processed */
 	int                dr_max_pages;
 	int                dr_npages;
 	int                dr_error;
-	int                dr_frags;
+	cfs_atomic_t       dr_frags;
+	cfs_atomic_t       dr_nsubmit;  /* segments still being submitted */
+	int                dr_nsegs;
+	unsigned long      dr_submit_usec; /* time to submit all bios */
+	struct timeval     dr_start_tv;
 	unsigned int       dr_ignore_quota:1;
 	unsigned int       dr_elapsed_valid:1; /* we really did count time */
 	unsigned int       dr_rw:1;
@@ -483,6 +538,7 @@ struct osd_iobuf {
 	unsigned long      dr_elapsed;  /* how long io took */
 	struct osd_device *dr_dev;
 	unsigned int	   dr_init_at;	/* the line iobuf was initialized */
+	struct osd_bio_seg dr_segs[OSD_BIO_MAX_SEGS];
 };
 
 struct osd_thread_info {
@@ -663,6 +719,14 @@ int osd_oii_insert(struct osd_device *dev, struct osd_idmap_cache *oic,
 int osd_oii_lookup(struct osd_device *dev, const struct lu_fid *fid,
 		   struct osd_inode_id *id);
 int osd_scrub_dump(struct osd_device *dev, char *buf, int len);
+int osd_scrub_set_threads(struct osd_device *dev, __u32 threads);
+int osd_scrub_dump_threads(struct osd_device *dev, char *buf, int len);
+
+/* osd_compact.c */
+void osd_compact_check(struct osd_object *obj);
+int osd_compact_setup(struct osd_device *dev);
+void osd_compact_cleanup(struct osd_device *dev);
+int osd_compact_dump(struct osd_device *dev, char *buf, int len);
 
 int osd_fld_lookup(const struct lu_env *env, struct osd_device *osd,
 		   const struct lu_fid *fid, struct lu_seq_range *range);
@@ -858,6 +922,8 @@ static inline void osd_ipd_put(const struct lu_env *env,
         bag->ic_descr->id_ops->id_ipd_free(ipd);
 }
 
+int osd_bio_sched_init(void);
+void osd_bio_sched_fini(void);
 int osd_ldiskfs_read(struct inode *inode, void *buf, int size, loff_t *offs);
 int osd_ldiskfs_write_record(struct inode *inode, void *buf, int bufsize,
 			     int write_NUL, loff_t *offs, handle_t *handle);
@@ -107,7 +107,10 @@ static int __osd_init_iobuf(struct osd_device *d, struct osd_iobuf *iobuf,
         iobuf->dr_npages = 0;
         iobuf->dr_error = 0;
         iobuf->dr_dev = d;
-        iobuf->dr_frags = 0;
+	cfs_atomic_set(&iobuf->dr_frags, 0);
+	cfs_atomic_set(&iobuf->dr_nsubmit, 0);
+	iobuf->dr_nsegs = 0;
+	iobuf->dr_submit_usec = 0;
         iobuf->dr_elapsed = 0;
         /* must be counted before, so assert */
         iobuf->dr_rw = rw;
@@ -163,15 +166,47 @@ void osd_fini_iobuf(struct osd_device *d, struct osd_iobuf *iobuf)
         if (iobuf->dr_elapsed_valid) {
                 iobuf->dr_elapsed_valid = 0;
                 LASSERT(iobuf->dr_dev == d);
-                LASSERT(iobuf->dr_frags > 0);
+		LASSERT(cfs_atomic_read(&iobuf->dr_frags) > 0);
                 lprocfs_oh_tally(&d->od_brw_stats.
                                  hist[BRW_R_DIO_FRAGS+rw],
-                                 iobuf->dr_frags);
+				 cfs_atomic_read(&iobuf->dr_frags));
                 lprocfs_oh_tally_log2(&d->od_brw_stats.hist[BRW_R_IO_TIME+rw],
                                       iobuf->dr_elapsed);
+		lprocfs_oh_tally(&d->od_brw_stats.hist[BRW_R_BIO_SEGS+rw],
+				 max(iobuf->dr_nsegs, 1));
+		lprocfs_oh_tally_log2(&d->od_brw_stats.
+				      hist[BRW_R_SUBMIT_TIME+rw],
+				      iobuf->dr_submit_usec);
         }
 }
 
+/* the first error of iobuf wins, it can be set concurrently by the bio
+ * completions and the submission threads */
+static inline void osd_iobuf_set_error(struct osd_iobuf *iobuf, int error)
+{
+	cmpxchg(&iobuf->dr_error, 0, error);
+}
+
+/* drop one of dr_numreqs, which are held by bios in flight and by bio
+ * segments not submitted yet */
+static void osd_iobuf_put_req(struct osd_iobuf *iobuf)
+{
+	/*
+	 * set dr_elapsed before dr_numreqs turns to 0, otherwise
+	 * it's possible that service thread will see dr_numreqs
+	 * is zero, but dr_elapsed is not set yet, leading to lost
+	 * data in this processing and an assertion in a subsequent
+	 * call to OSD. A segment of holes only submits no bio at all.
+	 */
+	if (cfs_atomic_read(&iobuf->dr_numreqs) == 1 &&
+	    cfs_atomic_read(&iobuf->dr_frags) > 0) {
+		iobuf->dr_elapsed = jiffies - iobuf->dr_start_time;
+		iobuf->dr_elapsed_valid = 1;
+	}
+	if (cfs_atomic_dec_and_test(&iobuf->dr_numreqs))
+		cfs_waitq_signal(&iobuf->dr_wait);
+}
+
 #ifndef REQ_WRITE /* pre-2.6.35 */
 #define __REQ_WRITE BIO_RW
 #endif
@@ -231,22 +266,10 @@ static int dio_complete_routine(struct bio *bio, unsigned int done, int error)
         }
 
         /* any real error is good enough -bzzz */
-        if (error != 0 && iobuf->dr_error == 0)
-                iobuf->dr_error = error;
+	if (error != 0)
+		osd_iobuf_set_error(iobuf, error);
 
-	/*
-	 * set dr_elapsed before dr_numreqs turns to 0, otherwise
-	 * it's possible that service thread will see dr_numreqs
-	 * is zero, but dr_elapsed is not set yet, leading to lost
-	 * data in this processing and an assertion in a subsequent
-	 * call to OSD.
-	 */
-	if (cfs_atomic_read(&iobuf->dr_numreqs) == 1) {
-		iobuf->dr_elapsed = jiffies - iobuf->dr_start_time;
-		iobuf->dr_elapsed_valid = 1;
-	}
-	if (cfs_atomic_dec_and_test(&iobuf->dr_numreqs))
-		cfs_waitq_signal(&iobuf->dr_wait);
+	osd_iobuf_put_req(iobuf);
 
         /* Completed bios used to be chained off iobuf->dr_bios and freed in
          * filter_clear_dreq().  It was then possible to exhaust the biovec-256
@@ -262,7 +285,7 @@ static void record_start_io(struct osd_iobuf *iobuf, int size)
         struct osd_device    *osd = iobuf->dr_dev;
         struct obd_histogram *h = osd->od_brw_stats.hist;
 
-        iobuf->dr_frags++;
+	cfs_atomic_inc(&iobuf->dr_frags);
         cfs_atomic_inc(&iobuf->dr_numreqs);
 
         if (iobuf->dr_rw == 0) {
@@ -300,14 +323,15 @@ static int can_be_merged(struct bio *bio, sector_t sector)
         return bio->bi_sector + size == sector ? 1 : 0;
 }
 
-static int osd_do_bio(struct osd_device *osd, struct inode *inode,
-                      struct osd_iobuf *iobuf)
+/* build and submit bios for pages [start, start + count) of iobuf */
+static int osd_bio_build(struct inode *inode, struct osd_iobuf *iobuf,
+			 int start, int count)
 {
         int            blocks_per_page = CFS_PAGE_SIZE >> inode->i_blkbits;
         struct page  **pages = iobuf->dr_pages;
-        int            npages = iobuf->dr_npages;
         unsigned long *blocks = iobuf->dr_blocks;
-        int            total_blocks = npages * blocks_per_page;
+	int	       end = start + count;
+        int            total_blocks = end * blocks_per_page;
         int            sector_bits = inode->i_sb->s_blocksize_bits - 9;
         unsigned int   blocksize = inode->i_sb->s_blocksize;
         struct bio    *bio = NULL;
@@ -319,15 +343,17 @@ static int osd_do_bio(struct osd_device *osd, struct inode *inode,
         int            page_idx;
         int            i;
         int            rc = 0;
-        ENTRY;
+#ifdef HAVE_BLK_PLUG
+	struct blk_plug plug;
 
-        LASSERT(iobuf->dr_npages == npages);
+	/* let the elevator merge the bios of this segment */
+	blk_start_plug(&plug);
+#endif
 
-        osd_brw_stats_update(osd, iobuf);
-        iobuf->dr_start_time = cfs_time_current();
+	LASSERT(end <= iobuf->dr_npages);
 
-        for (page_idx = 0, block_idx = 0;
-             page_idx < npages;
+        for (page_idx = start, block_idx = start * blocks_per_page;
+             page_idx < end;
              page_idx++, block_idx += blocks_per_page) {
 
                 page = pages[page_idx];
@@ -393,12 +419,12 @@ static int osd_do_bio(struct osd_device *osd, struct inode *inode,
 
 			/* allocate new bio */
 			bio = bio_alloc(GFP_NOIO, min(BIO_MAX_PAGES,
-						      (npages - page_idx) *
+						      (end - page_idx) *
 						      blocks_per_page));
                         if (bio == NULL) {
                                 CERROR("Can't allocate bio %u*%u = %u pages\n",
-                                       (npages - page_idx), blocks_per_page,
-                                       (npages - page_idx) * blocks_per_page);
+                                       (end - page_idx), blocks_per_page,
+                                       (end - page_idx) * blocks_per_page);
                                 rc = -ENOMEM;
                                 goto out;
                         }
@@ -422,6 +448,175 @@ static int osd_do_bio(struct osd_device *osd, struct inode *inode,
         }
 
  out:
+#ifdef HAVE_BLK_PLUG
+	blk_finish_plug(&plug);
+#endif
+	return rc;
+}
+
+/* per-CPT threads building and submitting bio segments */
+static int bio_submit_threads = 2;
+CFS_MODULE_PARM(bio_submit_threads, "i", int, 0444,
+		"# of bio submission threads per CPT, 0 to disable");
+
+static struct cfs_wi_sched **osd_bio_scheds;
+
+int osd_bio_sched_init(void)
+{
+	int ncpts = cfs_cpt_number(cfs_cpt_table);
+	int rc;
+	int i;
+
+	if (bio_submit_threads <= 0)
+		return 0;
+
+	OBD_ALLOC(osd_bio_scheds, ncpts * sizeof(osd_bio_scheds[0]));
+	if (osd_bio_scheds == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < ncpts; i++) {
+		rc = cfs_wi_sched_create("osd_bio", cfs_cpt_table, i,
+					 bio_submit_threads,
+					 &osd_bio_scheds[i]);
+		if (rc != 0) {
+			CERROR("Can't create bio submission threads for "
+			       "CPT %d: %d\n", i, rc);
+			osd_bio_sched_fini();
+			return rc;
+		}
+	}
+	return 0;
+}
+
+void osd_bio_sched_fini(void)
+{
+	int ncpts = cfs_cpt_number(cfs_cpt_table);
+	int i;
+
+	if (osd_bio_scheds == NULL)
+		return;
+
+	for (i = 0; i < ncpts; i++) {
+		if (osd_bio_scheds[i] != NULL)
+			cfs_wi_sched_destroy(osd_bio_scheds[i]);
+	}
+	OBD_FREE(osd_bio_scheds, ncpts * sizeof(osd_bio_scheds[0]));
+	osd_bio_scheds = NULL;
+}
+
+/* the last segment of iobuf has been submitted */
+static void osd_iobuf_submitted(struct osd_iobuf *iobuf)
+{
+	struct timeval now;
+
+	cfs_gettimeofday(&now);
+	iobuf->dr_submit_usec = cfs_timeval_sub(&now, &iobuf->dr_start_tv,
+						NULL);
+	/* osd_bio_finish() may wait for the submission threads */
+	cfs_waitq_signal(&iobuf->dr_wait);
+}
+
+static int osd_bio_seg_run(cfs_workitem_t *wi)
+{
+	struct osd_bio_seg *seg = wi->wi_data;
+	struct osd_iobuf   *iobuf = seg->obs_iobuf;
+	int		    rc;
+
+	rc = osd_bio_build(seg->obs_inode, iobuf, seg->obs_start,
+			   seg->obs_npages);
+	if (rc != 0)
+		osd_iobuf_set_error(iobuf, rc);
+
+	cfs_wi_exit(osd_bio_scheds[seg->obs_cpt], wi);
+
+	if (cfs_atomic_dec_and_test(&iobuf->dr_nsubmit))
+		osd_iobuf_submitted(iobuf);
+	/* iobuf can be reused once this is dropped */
+	osd_iobuf_put_req(iobuf);
+	return 1;
+}
+
+/* hand pages [start, start + count) to a submission thread, the segment
+ * holds a dr_numreqs reference until all its bios are submitted */
+static void osd_bio_queue_seg(struct inode *inode, struct osd_iobuf *iobuf,
+			      int start, int count)
+{
+	struct osd_bio_seg *seg = &iobuf->dr_segs[iobuf->dr_nsegs];
+	int		    ncpts = cfs_cpt_number(cfs_cpt_table);
+
+	LASSERT(iobuf->dr_nsegs < OSD_BIO_MAX_SEGS);
+
+	seg->obs_iobuf  = iobuf;
+	seg->obs_inode  = inode;
+	seg->obs_start  = start;
+	seg->obs_npages = count;
+	seg->obs_cpt    = (cfs_cpt_current(cfs_cpt_table, 1) +
+			   iobuf->dr_nsegs) % ncpts;
+	iobuf->dr_nsegs++;
+
+	cfs_atomic_inc(&iobuf->dr_numreqs);
+	cfs_atomic_inc(&iobuf->dr_nsubmit);
+	cfs_wi_init(&seg->obs_wi, seg, osd_bio_seg_run);
+	cfs_wi_schedule(osd_bio_scheds[seg->obs_cpt], &seg->obs_wi);
+}
+
+/* end of the segment starting at page @start: about @seg_pages pages,
+ * extended to the end of a contiguous extent so it is not split into
+ * two bios */
+static int osd_bio_seg_end(struct inode *inode, struct osd_iobuf *iobuf,
+			   int start, int end, int seg_pages)
+{
+	int		blocks_per_page = CFS_PAGE_SIZE >> inode->i_blkbits;
+	unsigned long  *blocks = iobuf->dr_blocks;
+	int		limit = min(end, start + 2 * seg_pages);
+	int		i;
+
+	for (i = start + seg_pages; i < limit; i++) {
+		unsigned long prev = blocks[i * blocks_per_page - 1];
+
+		if (prev == 0 || blocks[i * blocks_per_page] != prev + 1)
+			return i;
+	}
+	return i < end ? start + seg_pages : end;
+}
+
+/* submit pages [start, end) of iobuf, in parallel if it is large enough,
+ * the caller always builds the last segment itself */
+static int osd_bio_submit(struct osd_device *osd, struct inode *inode,
+			  struct osd_iobuf *iobuf, int start, int end)
+{
+	int seg_pages = osd->od_bio_seg_pages;
+	int next;
+
+	if (osd_bio_scheds != NULL && seg_pages > 0) {
+		while (end - start > seg_pages &&
+		       iobuf->dr_nsegs < OSD_BIO_MAX_SEGS - 1) {
+			next = osd_bio_seg_end(inode, iobuf, start, end,
+					       seg_pages);
+			if (next == end)
+				break;
+			osd_bio_queue_seg(inode, iobuf, start, next - start);
+			start = next;
+		}
+	}
+
+	return osd_bio_build(inode, iobuf, start, end - start);
+}
+
+/* wait for reads and return the status of iobuf, the caller holds one
+ * dr_nsubmit reference for the whole submission */
+static int osd_bio_finish(struct osd_iobuf *iobuf, int rc)
+{
+	if (cfs_atomic_dec_and_test(&iobuf->dr_nsubmit))
+		osd_iobuf_submitted(iobuf);
+
+	/* the submission threads may still be building bios of the queued
+	 * segments, wait for them for writes too so that the errors of them
+	 * are returned and the caller does not touch pages being submitted */
+	if (iobuf->dr_nsegs > 0)
+		cfs_wait_event(iobuf->dr_wait,
+			       cfs_atomic_read(&iobuf->dr_nsubmit) == 0);
+
         /* in order to achieve better IO throughput, we don't wait for writes
          * completion here. instead we proceed with transaction commit in
          * parallel and wait for IO completion once transaction is stopped
@@ -433,7 +628,90 @@ static int osd_do_bio(struct osd_device *osd, struct inode *inode,
 
         if (rc == 0)
                 rc = iobuf->dr_error;
-        RETURN(rc);
+	return rc;
+}
+
+static void osd_bio_start(struct osd_iobuf *iobuf)
+{
+        iobuf->dr_start_time = cfs_time_current();
+	cfs_gettimeofday(&iobuf->dr_start_tv);
+	cfs_atomic_set(&iobuf->dr_nsubmit, 1);
+}
+
+static int osd_do_bio(struct osd_device *osd, struct inode *inode,
+                      struct osd_iobuf *iobuf)
+{
+        int rc;
+        ENTRY;
+
+        osd_brw_stats_update(osd, iobuf);
+	osd_bio_start(iobuf);
+
+	rc = osd_bio_submit(osd, inode, iobuf, 0, iobuf->dr_npages);
+	RETURN(osd_bio_finish(iobuf, rc));
+}
+
+/*
+ * Map and read the pages of iobuf. In parallel mode, pages are mapped
+ * od_bio_seg_pages at a time and each chunk is submitted as soon as it is
+ * mapped, so that block mapping of the rest overlaps with the I/O.
+ */
+static int osd_map_do_bio(struct osd_device *osd, struct inode *inode,
+			  struct osd_iobuf *iobuf)
+{
+	int blocks_per_page = CFS_PAGE_SIZE >> inode->i_blkbits;
+	int npages = iobuf->dr_npages;
+	int seg_pages = osd->od_bio_seg_pages;
+	int start = 0;
+	int count;
+	int rc = 0;
+	ENTRY;
+
+	LASSERT(iobuf->dr_rw == 0);
+
+	if (osd_bio_scheds == NULL || seg_pages == 0 || npages <= seg_pages) {
+		rc = osd->od_fsops->fs_map_inode_pages(inode, iobuf->dr_pages,
+						       npages,
+						       iobuf->dr_blocks,
+						       0, NULL);
+		if (rc == 0)
+			rc = osd_do_bio(osd, inode, iobuf);
+		RETURN(rc);
+	}
+
+	osd_bio_start(iobuf);
+	while (start < npages) {
+		count = min(seg_pages, npages - start);
+		rc = osd->od_fsops->fs_map_inode_pages(inode,
+					iobuf->dr_pages + start, count,
+					iobuf->dr_blocks +
+					start * blocks_per_page, 0, NULL);
+		if (rc != 0)
+			break;
+
+		if (start + count == npages ||
+		    iobuf->dr_nsegs == OSD_BIO_MAX_SEGS - 1) {
+			/* the rest is mapped and built by myself */
+			count = npages - start;
+			if (count > seg_pages)
+				rc = osd->od_fsops->fs_map_inode_pages(inode,
+					iobuf->dr_pages + start + seg_pages,
+					count - seg_pages,
+					iobuf->dr_blocks +
+					(start + seg_pages) * blocks_per_page,
+					0, NULL);
+			if (rc == 0) {
+				osd_brw_stats_update(osd, iobuf);
+				rc = osd_bio_build(inode, iobuf, start, count);
+			}
+			break;
+		}
+
+		osd_bio_queue_seg(inode, iobuf, start, count);
+		start += count;
+	}
+
+	RETURN(osd_bio_finish(iobuf, rc));
 }
 
 static int osd_map_remote_to_local(loff_t offset, ssize_t len, int *nrpages,
@@ -635,15 +913,9 @@ static int osd_write_prep(const struct lu_env *env, struct dt_object *dt,
         lprocfs_counter_add(osd->od_stats, LPROC_OSD_GET_PAGE, timediff);
 
         if (iobuf->dr_npages) {
-		rc = osd->od_fsops->fs_map_inode_pages(inode, iobuf->dr_pages,
-						       iobuf->dr_npages,
-						       iobuf->dr_blocks,
-						       0, NULL);
-                if (likely(rc == 0)) {
-                        rc = osd_do_bio(osd, inode, iobuf);
-                        /* do IO stats for preparation reads */
-                        osd_fini_iobuf(osd, iobuf);
-                }
+		rc = osd_map_do_bio(osd, inode, iobuf);
+		/* do IO stats for preparation reads */
+		osd_fini_iobuf(osd, iobuf);
         }
         RETURN(rc);
 }
@@ -861,6 +1133,11 @@ static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
         }
 
         if (unlikely(rc != 0)) {
+		/* the bios submitted before the failure still reference the
+		 * pages, wait for them before dropping the pages */
+		cfs_wait_event(iobuf->dr_wait,
+			       cfs_atomic_read(&iobuf->dr_numreqs) == 0);
+
                 /* if write fails, we should drop pages from the cache */
                 for (i = 0; i < npages; i++) {
                         if (lnb[i].page == NULL)
@@ -927,11 +1204,7 @@ static int osd_read_prep(const struct lu_env *env, struct dt_object *dt,
         lprocfs_counter_add(osd->od_stats, LPROC_OSD_GET_PAGE, timediff);
 
         if (iobuf->dr_npages) {
-		rc = osd->od_fsops->fs_map_inode_pages(inode, iobuf->dr_pages,
-						       iobuf->dr_npages,
-						       iobuf->dr_blocks,
-						       0, NULL);
-                rc = osd_do_bio(osd, inode, iobuf);
+		rc = osd_map_do_bio(osd, inode, iobuf);
 
                 /* IO stats will be done in osd_bufs_put() */
         }
@@ -159,6 +159,14 @@ static void brw_stats_show(struct seq_file *seq, struct brw_stats *brw_stats)
         display_brw_stats(seq, "disk I/O size", "ios",
                           &brw_stats->hist[BRW_R_DISK_IOSIZE],
                           &brw_stats->hist[BRW_W_DISK_IOSIZE], 1);
+
+	display_brw_stats(seq, "bio submit segments", "rpcs",
+			  &brw_stats->hist[BRW_R_BIO_SEGS],
+			  &brw_stats->hist[BRW_W_BIO_SEGS], 0);
+
+	display_brw_stats(seq, "bio submit time (usec)", "rpcs",
+			  &brw_stats->hist[BRW_R_SUBMIT_TIME],
+			  &brw_stats->hist[BRW_W_SUBMIT_TIME], 1);
 }
 
 #undef pct
@@ -455,6 +463,40 @@ static int lprocfs_osd_rd_oi_scrub(char *page, char **start, off_t off,
 	return osd_scrub_dump(dev, page, count);
 }
 
+static int lprocfs_osd_rd_oi_scrub_threads(char *page, char **start,
+					   off_t off, int count, int *eof,
+					   void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	*eof = 1;
+	return osd_scrub_dump_threads(dev, page, count);
+}
+
+/* threads for the next OI scrub, 1 for the single-threaded scrub */
+static int lprocfs_osd_wr_oi_scrub_threads(struct file *file,
+					   const char *buffer,
+					   unsigned long count, void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+	int		   val, rc;
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	rc = osd_scrub_set_threads(dev, val);
+	return rc != 0 ? rc : count;
+}
+
 int lprocfs_osd_rd_readcache(char *page, char **start, off_t off, int count,
 			     int *eof, void *data)
 {
@@ -489,6 +531,171 @@ int lprocfs_osd_wr_readcache(struct file *file, const char *buffer,
 	return count;
 }
 
+static int lprocfs_osd_rd_bio_seg_pages(char *page, char **start, off_t off,
+					int count, int *eof, void *data)
+{
+	struct osd_device *osd = osd_dt_dev(data);
+
+	LASSERT(osd != NULL);
+	return snprintf(page, count, "%u\n", osd->od_bio_seg_pages);
+}
+
+/* pages per bio segment submitted in parallel, 0 disables parallel
+ * submission */
+static int lprocfs_osd_wr_bio_seg_pages(struct file *file, const char *buffer,
+					unsigned long count, void *data)
+{
+	struct osd_device	*osd = osd_dt_dev(data);
+	int			 val, rc;
+
+	LASSERT(osd != NULL);
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0 || val > PTLRPC_MAX_BRW_PAGES)
+		return -EINVAL;
+
+	osd->od_bio_seg_pages = val;
+	return count;
+}
+
+static int lprocfs_osd_rd_dir_compact(char *page, char **start, off_t off,
+				      int count, int *eof, void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	*eof = 1;
+	return osd_compact_dump(dev, page, count);
+}
+
+static int lprocfs_osd_rd_compact_min_blocks(char *page, char **start,
+					     off_t off, int count, int *eof,
+					     void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+
+	LASSERT(dev != NULL);
+	*eof = 1;
+	return snprintf(page, count, "%u\n", dev->od_compact.oc_min_blocks);
+}
+
+/* directories smaller than this are not compacted, 0 disables compaction */
+static int lprocfs_osd_wr_compact_min_blocks(struct file *file,
+					     const char *buffer,
+					     unsigned long count, void *data)
+{
+	struct osd_device	*dev = osd_dt_dev(data);
+	int			 val, rc;
+
+	LASSERT(dev != NULL);
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0)
+		return -EINVAL;
+
+	dev->od_compact.oc_min_blocks = val;
+	return count;
+}
+
+static int lprocfs_osd_rd_compact_fill(char *page, char **start, off_t off,
+				       int count, int *eof, void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+
+	LASSERT(dev != NULL);
+	*eof = 1;
+	return snprintf(page, count, "%u\n", dev->od_compact.oc_fill);
+}
+
+static int lprocfs_osd_wr_compact_fill(struct file *file, const char *buffer,
+				       unsigned long count, void *data)
+{
+	struct osd_device	*dev = osd_dt_dev(data);
+	int			 val, rc;
+
+	LASSERT(dev != NULL);
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 1 || val > 100)
+		return -EINVAL;
+
+	dev->od_compact.oc_fill = val;
+	return count;
+}
+
+static int lprocfs_osd_rd_oi_cache_size(char *page, char **start, off_t off,
+					int count, int *eof, void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+
+	LASSERT(dev != NULL);
+	*eof = 1;
+	return snprintf(page, count, "%u\n", dev->od_oi_cache_size);
+}
+
+/* max entries of the OI cache, 0 disables the cache */
+static int lprocfs_osd_wr_oi_cache_size(struct file *file, const char *buffer,
+					unsigned long count, void *data)
+{
+	struct osd_device	*dev = osd_dt_dev(data);
+	int			 val, rc;
+
+	LASSERT(dev != NULL);
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0)
+		return -EINVAL;
+
+	osd_oi_cache_resize(dev, val);
+	return count;
+}
+
+static int lprocfs_osd_rd_oi_cache_stats(char *page, char **start, off_t off,
+					 int count, int *eof, void *data)
+{
+	struct osd_device	 *dev = osd_dt_dev(data);
+	struct osd_oi_cache_part *ocp;
+	__u64			  hits = 0;
+	__u64			  neg_hits = 0;
+	__u64			  misses = 0;
+	__u64			  prefetched = 0;
+	unsigned int		  cached = 0;
+	int			  i;
+
+	LASSERT(dev != NULL);
+	if (dev->od_oi_cache != NULL) {
+		cfs_percpt_for_each(ocp, i, dev->od_oi_cache) {
+			spin_lock(&ocp->ocp_lock);
+			cached += ocp->ocp_count;
+			hits += ocp->ocp_hits;
+			neg_hits += ocp->ocp_neg_hits;
+			misses += ocp->ocp_misses;
+			prefetched += ocp->ocp_prefetched;
+			spin_unlock(&ocp->ocp_lock);
+		}
+	}
+
+	*eof = 1;
+	return snprintf(page, count,
+			"cached: %u\n"
+			"hits: "LPU64"\n"
+			"negative_hits: "LPU64"\n"
+			"misses: "LPU64"\n"
+			"prefetched: "LPU64"\n",
+			cached, hits, neg_hits, misses, prefetched);
+}
+
 struct lprocfs_vars lprocfs_osd_obd_vars[] = {
         { "blocksize",       lprocfs_osd_rd_blksize,     0, 0 },
         { "kbytestotal",     lprocfs_osd_rd_kbytestotal, 0, 0 },
@@ -503,12 +710,24 @@ struct lprocfs_vars lprocfs_osd_obd_vars[] = {
 	{ "auto_scrub",      lprocfs_osd_rd_auto_scrub,
 			     lprocfs_osd_wr_auto_scrub,  0 },
 	{ "oi_scrub",	     lprocfs_osd_rd_oi_scrub,    0, 0 },
+	{ "oi_scrub_threads",	lprocfs_osd_rd_oi_scrub_threads,
+				lprocfs_osd_wr_oi_scrub_threads, 0 },
 	{ "force_sync",		0, lprocfs_osd_wr_force_sync },
 	{ "read_cache_enable",	lprocfs_osd_rd_cache, lprocfs_osd_wr_cache, 0 },
 	{ "writethrough_cache_enable",	lprocfs_osd_rd_wcache,
 					lprocfs_osd_wr_wcache, 0 },
 	{ "readcache_max_filesize",	lprocfs_osd_rd_readcache,
 					lprocfs_osd_wr_readcache, 0 },
+	{ "bio_submit_pages",	lprocfs_osd_rd_bio_seg_pages,
+				lprocfs_osd_wr_bio_seg_pages, 0 },
+	{ "dir_compact",	lprocfs_osd_rd_dir_compact, 0, 0 },
+	{ "dir_compact_min_blocks",	lprocfs_osd_rd_compact_min_blocks,
+					lprocfs_osd_wr_compact_min_blocks, 0 },
+	{ "dir_compact_fill",	lprocfs_osd_rd_compact_fill,
+				lprocfs_osd_wr_compact_fill, 0 },
+	{ "oi_cache_size",	lprocfs_osd_rd_oi_cache_size,
+				lprocfs_osd_wr_oi_cache_size, 0 },
+	{ "oi_cache_stats",	lprocfs_osd_rd_oi_cache_stats, 0, 0 },
 	{ 0 }
 };
 
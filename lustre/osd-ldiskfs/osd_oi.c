@@ -329,6 +329,269 @@ osd_oi_table_open(struct osd_thread_info *info, struct osd_device *osd,
 	RETURN(count);
 }
 
+static inline struct osd_oi_cache_part *
+osd_oi_cache_part(struct osd_device *osd, const struct lu_fid *fid)
+{
+	return osd->od_oi_cache[fid_flatten32(fid) %
+				cfs_percpt_number(osd->od_oi_cache)];
+}
+
+static struct osd_oi_cache_entry *
+osd_oi_cache_find(struct osd_oi_cache_part *ocp, const struct lu_fid *fid)
+{
+	struct osd_oi_cache_entry *oce;
+	cfs_hlist_node_t	  *pos;
+	cfs_hlist_head_t	  *head;
+
+	head = &ocp->ocp_hash[fid_hash(fid, OSD_OI_CACHE_HASH_BITS)];
+	cfs_hlist_for_each_entry(oce, pos, head, oce_hash) {
+		if (lu_fid_eq(&oce->oce_fid, fid))
+			return oce;
+	}
+	return NULL;
+}
+
+static void osd_oi_cache_free(struct osd_oi_cache_part *ocp,
+			      struct osd_oi_cache_entry *oce)
+{
+	cfs_hlist_del(&oce->oce_hash);
+	cfs_list_del(&oce->oce_lru);
+	ocp->ocp_count--;
+	OBD_FREE_PTR(oce);
+}
+
+/* Sample the generation of the partition \a fid belongs to, it must be done
+ * before reading the OI for the result to be passed to osd_oi_cache_add(). */
+static inline int osd_oi_cache_gen(struct osd_device *osd,
+				   const struct lu_fid *fid)
+{
+	int gen;
+
+	gen = cfs_atomic_read(&osd_oi_cache_part(osd, fid)->ocp_gen);
+	smp_rmb();
+	return gen;
+}
+
+static void osd_oi_cache_flush(struct osd_device *osd)
+{
+	struct osd_oi_cache_part  *ocp;
+	struct osd_oi_cache_entry *oce;
+	int			   i;
+
+	if (osd->od_oi_cache == NULL)
+		return;
+
+	cfs_percpt_for_each(ocp, i, osd->od_oi_cache) {
+		spin_lock(&ocp->ocp_lock);
+		cfs_atomic_inc(&ocp->ocp_gen);
+		while (!cfs_list_empty(&ocp->ocp_lru)) {
+			oce = cfs_list_entry(ocp->ocp_lru.next,
+					     struct osd_oi_cache_entry,
+					     oce_lru);
+			osd_oi_cache_free(ocp, oce);
+		}
+		spin_unlock(&ocp->ocp_lock);
+	}
+}
+
+/**
+ * Lookup \a fid in the OI cache.
+ *
+ * \retval 0		positive entry found, \a id is filled
+ * \retval -ENOENT	negative entry found
+ * \retval 1		not cached, \a gen is to be passed to
+ *			osd_oi_cache_add() with the OI lookup result
+ */
+static int osd_oi_cache_lookup(struct osd_device *osd,
+			       const struct lu_fid *fid,
+			       struct osd_inode_id *id, int *gen)
+{
+	struct osd_oi_cache_part  *ocp;
+	struct osd_oi_cache_entry *oce;
+	int			   rc = 1;
+
+	if (osd->od_oi_cache == NULL) {
+		*gen = 0;
+		return 1;
+	}
+
+	*gen = osd_oi_cache_gen(osd, fid);
+	if (osd->od_oi_cache_size == 0)
+		return 1;
+
+	ocp = osd_oi_cache_part(osd, fid);
+	spin_lock(&ocp->ocp_lock);
+	oce = osd_oi_cache_find(ocp, fid);
+	if (oce == NULL) {
+		ocp->ocp_misses++;
+	} else {
+		cfs_list_move_tail(&oce->oce_lru, &ocp->ocp_lru);
+		if (oce->oce_id.oii_ino == 0) {
+			ocp->ocp_neg_hits++;
+			rc = -ENOENT;
+		} else {
+			ocp->ocp_hits++;
+			*id = oce->oce_id;
+			rc = 0;
+		}
+	}
+	spin_unlock(&ocp->ocp_lock);
+	return rc;
+}
+
+/**
+ * Add the mapping \a fid => \a id into the OI cache, NULL \a id for negative
+ * entry.
+ *
+ * If \a update is set, the OI has just been modified for \a fid, the entry is
+ * replaced and all the racing lookups are prevented from caching what they
+ * read before the modification. It is done even if the cache is disabled, so
+ * that a lookup racing with re-enabling the cache cannot cache stale result.
+ * Otherwise the mapping is the result of an OI lookup started at \a gen of
+ * the partition of \a fid, it is only cached if there is no entry for \a fid
+ * and no OI modification in the partition since then.
+ *
+ * \retval 1 if a new entry is added
+ */
+static int osd_oi_cache_add(struct osd_device *osd, const struct lu_fid *fid,
+			    const struct osd_inode_id *id, bool update,
+			    int gen)
+{
+	struct osd_oi_cache_part  *ocp;
+	struct osd_oi_cache_entry *oce;
+	struct osd_oi_cache_entry *new = NULL;
+	unsigned int		   max;
+	int			   rc = 0;
+
+	if (osd->od_oi_cache == NULL)
+		return 0;
+
+	max = osd->od_oi_cache_size / cfs_percpt_number(osd->od_oi_cache);
+	if (max == 0 && !update)
+		return 0;
+
+	ocp = osd_oi_cache_part(osd, fid);
+	spin_lock(&ocp->ocp_lock);
+	if (update)
+		cfs_atomic_inc(&ocp->ocp_gen);
+
+again:
+	if (!update && gen != cfs_atomic_read(&ocp->ocp_gen))
+		goto unlock;
+
+	oce = osd_oi_cache_find(ocp, fid);
+	if (oce != NULL) {
+		if (max == 0) {
+			osd_oi_cache_free(ocp, oce);
+		} else if (update) {
+			if (id != NULL)
+				oce->oce_id = *id;
+			else
+				memset(&oce->oce_id, 0, sizeof(oce->oce_id));
+			cfs_list_move_tail(&oce->oce_lru, &ocp->ocp_lru);
+		}
+		goto unlock;
+	}
+
+	if (max == 0)
+		goto unlock;
+
+	if (new == NULL) {
+		spin_unlock(&ocp->ocp_lock);
+		OBD_ALLOC_PTR(new);
+		if (new == NULL)
+			return 0;
+
+		spin_lock(&ocp->ocp_lock);
+		goto again;
+	}
+
+	new->oce_fid = *fid;
+	if (id != NULL)
+		new->oce_id = *id;
+	cfs_hlist_add_head(&new->oce_hash,
+		&ocp->ocp_hash[fid_hash(fid, OSD_OI_CACHE_HASH_BITS)]);
+	cfs_list_add_tail(&new->oce_lru, &ocp->ocp_lru);
+	ocp->ocp_count++;
+	new = NULL;
+	rc = 1;
+
+	while (ocp->ocp_count > max) {
+		oce = cfs_list_entry(ocp->ocp_lru.next,
+				     struct osd_oi_cache_entry, oce_lru);
+		osd_oi_cache_free(ocp, oce);
+	}
+
+unlock:
+	spin_unlock(&ocp->ocp_lock);
+	if (new != NULL)
+		OBD_FREE_PTR(new);
+	return rc;
+}
+
+void osd_oi_cache_update(struct osd_device *osd, const struct lu_fid *fid,
+			 const struct osd_inode_id *id)
+{
+	osd_oi_cache_add(osd, fid, id, true, 0);
+}
+
+void osd_oi_cache_drop(struct osd_device *osd, const struct lu_fid *fid)
+{
+	struct osd_oi_cache_part  *ocp;
+	struct osd_oi_cache_entry *oce;
+
+	if (osd->od_oi_cache == NULL)
+		return;
+
+	ocp = osd_oi_cache_part(osd, fid);
+	spin_lock(&ocp->ocp_lock);
+	cfs_atomic_inc(&ocp->ocp_gen);
+	oce = osd_oi_cache_find(ocp, fid);
+	if (oce != NULL)
+		osd_oi_cache_free(ocp, oce);
+	spin_unlock(&ocp->ocp_lock);
+}
+
+void osd_oi_cache_resize(struct osd_device *osd, unsigned int size)
+{
+	/* The OI modifications drop the cached entries and bump the partition
+	 * generation even if the cache is disabled, flushing after the size
+	 * change is enough to drop what was cached under the old size. */
+	osd->od_oi_cache_size = size;
+	osd_oi_cache_flush(osd);
+}
+
+static int osd_oi_cache_init(struct osd_device *osd)
+{
+	struct osd_oi_cache_part *ocp;
+	int			  i;
+	int			  j;
+
+	osd->od_oi_cache = cfs_percpt_alloc(cfs_cpt_table, sizeof(*ocp));
+	if (osd->od_oi_cache == NULL)
+		return -ENOMEM;
+
+	cfs_percpt_for_each(ocp, i, osd->od_oi_cache) {
+		spin_lock_init(&ocp->ocp_lock);
+		cfs_atomic_set(&ocp->ocp_gen, 0);
+		CFS_INIT_LIST_HEAD(&ocp->ocp_lru);
+		for (j = 0; j < OSD_OI_CACHE_HASH_SIZE; j++)
+			CFS_INIT_HLIST_HEAD(&ocp->ocp_hash[j]);
+	}
+	osd->od_oi_cache_size = OSD_OI_CACHE_SIZE;
+	return 0;
+}
+
+static void osd_oi_cache_fini(struct osd_device *osd)
+{
+	if (osd->od_oi_cache == NULL)
+		return;
+
+	osd_oi_cache_flush(osd);
+	cfs_percpt_free(osd->od_oi_cache);
+	osd->od_oi_cache = NULL;
+}
+
 int osd_oi_init(struct osd_thread_info *info, struct osd_device *osd)
 {
 	struct osd_scrub  *scrub = &osd->od_scrub;
@@ -402,6 +665,9 @@ out:
 		osd->od_oi_table = oi;
 		osd->od_oi_count = rc;
 		rc = 0;
+		if (osd_oi_cache_init(osd) != 0)
+			CWARN("%.16s: fail to init OI cache, run without it\n",
+			      LDISKFS_SB(osd_sb(osd))->s_es->s_volume_name);
 	}
 
 	mutex_unlock(&oi_init_lock);
@@ -413,6 +679,7 @@ void osd_oi_fini(struct osd_thread_info *info, struct osd_device *osd)
 	if (unlikely(osd->od_oi_table == NULL))
 		return;
 
+	osd_oi_cache_fini(osd);
         osd_oi_table_put(info, osd->od_oi_table, osd->od_oi_count);
 
         OBD_FREE(osd->od_oi_table,
@@ -427,9 +694,51 @@ static inline int fid_is_fs_root(const struct lu_fid *fid)
                          fid_oid(fid) == OSD_FS_ROOT_OID));
 }
 
+/* Cache the records following \a fid in the same IAM leaf, the objects of
+ * the same sequence are usually accessed together. It does not cross leaf
+ * boundary to avoid extra leaf locking and I/O.
+ *
+ * The leaf is locked by the iterator, so the generation of the partition of
+ * each record sampled before reading the record covers the OI modifications
+ * of that record. */
+static void osd_oi_iam_prefetch(struct osd_device *osd,
+				struct iam_iterator *it,
+				const struct lu_fid *fid)
+{
+	struct iam_leaf		 *leaf = &it->ii_path.ip_leaf;
+	struct osd_oi_cache_part *ocp;
+	struct lu_fid		  tfid;
+	struct osd_inode_id	  id;
+	int			  count = 0;
+	int			  gen;
+	int			  i;
+
+	for (i = 0; i < OSD_OI_PREFETCH; i++) {
+		iam_leaf_next(leaf);
+		if (iam_leaf_at_end(leaf))
+			break;
+
+		fid_be_to_cpu(&tfid, (struct lu_fid *)iam_it_key_get(it));
+		if (fid_seq(&tfid) != fid_seq(fid))
+			break;
+
+		gen = osd_oi_cache_gen(osd, &tfid);
+		osd_id_unpack(&id, (struct osd_inode_id *)iam_it_rec_get(it));
+		count += osd_oi_cache_add(osd, &tfid, &id, false, gen);
+	}
+
+	if (count > 0) {
+		ocp = osd_oi_cache_part(osd, fid);
+		spin_lock(&ocp->ocp_lock);
+		ocp->ocp_prefetched += count;
+		spin_unlock(&ocp->ocp_lock);
+	}
+}
+
 static int osd_oi_iam_lookup(struct osd_thread_info *oti,
-                             struct osd_oi *oi, struct dt_rec *rec,
-                             const struct dt_key *key)
+			     struct osd_device *osd, struct osd_oi *oi,
+			     struct dt_rec *rec, const struct dt_key *key,
+			     const struct lu_fid *fid)
 {
         struct iam_container  *bag;
         struct iam_iterator   *it = &oti->oti_idx_it;
@@ -449,8 +758,11 @@ static int osd_oi_iam_lookup(struct osd_thread_info *oti,
         iam_it_init(it, bag, 0, ipd);
 
         rc = iam_it_get(it, (struct iam_key *)key);
-	if (rc > 0)
+	if (rc > 0) {
 		iam_reccpy(&it->ii_path.ip_leaf, (struct iam_rec *)rec);
+		if (osd->od_oi_cache_size > 0 && fid_is_norm(fid))
+			osd_oi_iam_prefetch(osd, it, fid);
+	}
         iam_it_put(it);
         iam_it_fini(it);
         osd_ipd_put(oti->oti_env, bag, ipd);
@@ -494,15 +806,23 @@ int __osd_oi_lookup(struct osd_thread_info *info, struct osd_device *osd,
 		    const struct lu_fid *fid, struct osd_inode_id *id)
 {
 	struct lu_fid *oi_fid = &info->oti_fid2;
+	int	       gen;
 	int	       rc;
 
+	rc = osd_oi_cache_lookup(osd, fid, id, &gen);
+	if (rc <= 0)
+		return rc;
+
 	fid_cpu_to_be(oi_fid, fid);
-	rc = osd_oi_iam_lookup(info, osd_fid2oi(osd, fid), (struct dt_rec *)id,
-			       (const struct dt_key *)oi_fid);
+	rc = osd_oi_iam_lookup(info, osd, osd_fid2oi(osd, fid),
+			       (struct dt_rec *)id,
+			       (const struct dt_key *)oi_fid, fid);
 	if (rc > 0) {
 		osd_id_unpack(id, id);
+		osd_oi_cache_add(osd, fid, id, false, gen);
 		rc = 0;
 	} else if (rc == 0) {
+		osd_oi_cache_add(osd, fid, NULL, false, gen);
 		rc = -ENOENT;
 	}
 	return rc;
@@ -635,6 +955,7 @@ update:
 			return rc;
 	}
 
+	osd_oi_cache_update(osd, fid, id);
 	if (unlikely(fid_seq(fid) == FID_SEQ_LOCAL_FILE))
 		rc = osd_obj_spec_insert(info, osd, fid, id, th);
 	return rc;
@@ -673,6 +994,7 @@ int osd_oi_delete(struct osd_thread_info *info,
 		  struct thandle *th)
 {
 	struct lu_fid *oi_fid = &info->oti_fid2;
+	int	       rc;
 
 	if (fid_is_last_id(fid))
 		return 0;
@@ -681,8 +1003,11 @@ int osd_oi_delete(struct osd_thread_info *info,
 		return osd_obj_map_delete(info, osd, fid, th);
 
 	fid_cpu_to_be(oi_fid, fid);
-	return osd_oi_iam_delete(info, osd_fid2oi(osd, fid),
-				 (const struct dt_key *)oi_fid, th);
+	rc = osd_oi_iam_delete(info, osd_fid2oi(osd, fid),
+			       (const struct dt_key *)oi_fid, th);
+	if (rc == 0)
+		osd_oi_cache_update(osd, fid, NULL);
+	return rc;
 }
 
 int osd_oi_mod_init(void)
@@ -89,6 +89,37 @@ struct osd_idmap_cache {
 	struct osd_inode_id	oic_lid;
 };
 
+/* FID to inode mapping cached in front of the OI files */
+struct osd_oi_cache_entry {
+	cfs_hlist_node_t	oce_hash;
+	cfs_list_t		oce_lru;
+	struct lu_fid		oce_fid;
+	/* oii_ino == 0 for negative entry */
+	struct osd_inode_id	oce_id;
+};
+
+#define OSD_OI_CACHE_HASH_BITS	10
+#define OSD_OI_CACHE_HASH_SIZE	(1 << OSD_OI_CACHE_HASH_BITS)
+/* default max entries of the OI cache for each device */
+#define OSD_OI_CACHE_SIZE	(64 * 1024)
+/* max records cached from the same IAM leaf after an OI lookup */
+#define OSD_OI_PREFETCH		16
+
+/* one partition of the OI cache per CPT, selected by FID hash */
+struct osd_oi_cache_part {
+	spinlock_t		ocp_lock;
+	/* bumped on every OI modification of the FIDs in this partition,
+	 * even if the cache is disabled */
+	cfs_atomic_t		ocp_gen;
+	cfs_list_t		ocp_lru;
+	unsigned int		ocp_count;
+	__u64			ocp_hits;
+	__u64			ocp_neg_hits;
+	__u64			ocp_misses;
+	__u64			ocp_prefetched;
+	cfs_hlist_head_t	ocp_hash[OSD_OI_CACHE_HASH_SIZE];
+};
+
 static inline void osd_id_pack(struct osd_inode_id *tgt,
 			       const struct osd_inode_id *src)
 {
@@ -146,6 +177,11 @@ int  osd_oi_delete(struct osd_thread_info *info,
 		   struct osd_device *osd, const struct lu_fid *fid,
 		   struct thandle *th);
 
+void osd_oi_cache_update(struct osd_device *osd, const struct lu_fid *fid,
+			 const struct osd_inode_id *id);
+void osd_oi_cache_drop(struct osd_device *osd, const struct lu_fid *fid);
+void osd_oi_cache_resize(struct osd_device *osd, unsigned int size);
+
 int fid_is_on_ost(struct osd_thread_info *info, struct osd_device *osd,
 		  const struct lu_fid *fid);
 #endif /* __KERNEL__ */
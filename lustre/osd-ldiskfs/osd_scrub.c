@@ -153,6 +153,8 @@ static int osd_scrub_refresh_mapping(struct osd_thread_info *info,
 			 *	Anyway, it is rare, only exists in theory. */
 		}
 	}
+	if (rc == 0)
+		osd_oi_cache_update(dev, fid, id);
 	osd_ipd_put(info->oti_env, bag, ipd);
 	ldiskfs_journal_stop(jh);
 	RETURN(rc);
@@ -386,9 +388,24 @@ static int osd_scrub_prep(struct osd_device *dev)
 	RETURN(rc);
 }
 
+/* Several OI scrub threads may find the inconsistency at the same time. */
+static void osd_scrub_set_flags(struct osd_scrub *scrub, __u64 flags, int idx)
+{
+	struct scrub_file *sf = &scrub->os_file;
+
+	spin_lock(&scrub->os_lock);
+	sf->sf_flags |= flags;
+	if (idx >= 0 && unlikely(!ldiskfs_test_bit(idx, sf->sf_oi_bitmap)))
+		ldiskfs_set_bit(idx, sf->sf_oi_bitmap);
+	scrub->os_full_speed = 1;
+	spin_unlock(&scrub->os_lock);
+}
+
+/* Hold os_rwsem as shared, the checkpoint will not store the scrub file
+ * in the middle of the update. The statistics are under os_lock. */
 static int
 osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
-		       struct osd_idmap_cache *oic, int val)
+		       struct osd_idmap_cache *oic, int val, bool prior)
 {
 	struct osd_scrub	     *scrub  = &dev->od_scrub;
 	struct scrub_file	     *sf     = &scrub->os_file;
@@ -402,20 +419,22 @@ osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
 	int			      rc;
 	ENTRY;
 
-	down_write(&scrub->os_rwsem);
-	scrub->os_new_checked++;
+	down_read(&scrub->os_rwsem);
 	if (val < 0)
 		GOTO(out, rc = val);
 
-	if (scrub->os_in_prior)
+	if (prior)
 		oii = cfs_list_entry(oic, struct osd_inconsistent_item,
 				     oii_cache);
 
 	if (lid->oii_ino < sf->sf_pos_latest_start && oii == NULL)
 		GOTO(out, rc = 0);
 
-	if (fid_is_igif(fid))
+	if (fid_is_igif(fid)) {
+		spin_lock(&scrub->os_lock);
 		sf->sf_items_igif++;
+		spin_unlock(&scrub->os_lock);
+	}
 
 	if ((val == SCRUB_NEXT_NOLMA) &&
 	    (!dev->od_handle_nolma || OBD_FAIL_CHECK(OBD_FAIL_FID_NOLMA)))
@@ -455,35 +474,35 @@ iget:
 		ops = DTO_INDEX_INSERT;
 		idx = osd_oi_fid2idx(dev, fid);
 		if (val == SCRUB_NEXT_NOLMA) {
-			sf->sf_flags |= SF_UPGRADE;
-			scrub->os_full_speed = 1;
+			osd_scrub_set_flags(scrub, SF_UPGRADE, -1);
 			rc = osd_ea_fid_set(info, inode, fid, 0);
 			if (rc != 0)
 				GOTO(out, rc);
 		} else {
-			sf->sf_flags |= SF_RECREATED | SF_INCONSISTENT;
-			scrub->os_full_speed = 1;
-			if (unlikely(!ldiskfs_test_bit(idx, sf->sf_oi_bitmap)))
-				ldiskfs_set_bit(idx, sf->sf_oi_bitmap);
+			osd_scrub_set_flags(scrub, SF_RECREATED | SF_INCONSISTENT,
+					    idx);
 		}
 	} else if (osd_id_eq(lid, lid2)) {
 		GOTO(out, rc = 0);
 	} else {
-		sf->sf_flags |= SF_INCONSISTENT;
-		scrub->os_full_speed = 1;
+		osd_scrub_set_flags(scrub, SF_INCONSISTENT, -1);
 	}
 
 	rc = osd_scrub_refresh_mapping(info, dev, fid, lid, ops);
 	if (rc == 0) {
-		if (scrub->os_in_prior)
+		spin_lock(&scrub->os_lock);
+		if (prior)
 			sf->sf_items_updated_prior++;
 		else
 			sf->sf_items_updated++;
+		spin_unlock(&scrub->os_lock);
 	}
 
 	GOTO(out, rc);
 
 out:
+	spin_lock(&scrub->os_lock);
+	scrub->os_new_checked++;
 	if (rc < 0) {
 		sf->sf_items_failed++;
 		if (sf->sf_pos_first_inconsistent == 0 ||
@@ -492,12 +511,13 @@ out:
 	} else {
 		rc = 0;
 	}
+	spin_unlock(&scrub->os_lock);
 
 	if (ops == DTO_INDEX_INSERT) {
 		mutex_unlock(&inode->i_mutex);
 		iput(inode);
 	}
-	up_write(&scrub->os_rwsem);
+	up_read(&scrub->os_rwsem);
 
 	if (oii != NULL) {
 		LASSERT(!cfs_list_empty(&oii->oii_list));
@@ -791,7 +811,7 @@ static int osd_scrub_exec(struct osd_thread_info *info, struct osd_device *dev,
 		goto next;
 	}
 
-	rc = osd_scrub_check_update(info, dev, oic, rc);
+	rc = osd_scrub_check_update(info, dev, oic, rc, scrub->os_in_prior);
 	if (rc != 0)
 		return rc;
 
@@ -969,6 +989,518 @@ static int osd_otable_it_preload(const struct lu_env *env,
 	RETURN(rc < 0 ? rc : ooc->ooc_cached_items);
 }
 
+/* multi-threaded OI scrub
+ *
+ * The OI scrub thread dispatches the inode table in chunks, one chunk is
+ * a run of the inodes in the same block group. When a chunk is dispatched,
+ * its inode table blocks are read ahead asynchronously, then one of the
+ * os_threads helper threads verifies/repairs the OI mappings for it. The
+ * inconsistent items found by RPC are still handled by the OI scrub thread.
+ * The checkpoint only goes forward when all the chunks before it are done. */
+
+static inline bool osd_scrub_mt_abort(struct osd_scrub *scrub)
+{
+	return !thread_is_running(&scrub->os_thread) || scrub->os_mt_rc != 0;
+}
+
+static void osd_scrub_mt_failout(struct osd_scrub *scrub, int rc)
+{
+	spin_lock(&scrub->os_lock);
+	if (scrub->os_mt_rc == 0)
+		scrub->os_mt_rc = rc;
+	spin_unlock(&scrub->os_lock);
+	cfs_waitq_broadcast(&scrub->os_thread.t_ctl_waitq);
+}
+
+static void osd_scrub_readahead(struct osd_iit_param *param,
+				__u32 start, __u32 end)
+{
+	struct super_block	  *sb  = param->sb;
+	struct ldiskfs_group_desc *gdp;
+	ldiskfs_fsblk_t		   blk;
+	__u32			   ipb = LDISKFS_INODES_PER_BLOCK(sb);
+	__u32			   i;
+
+	gdp = ldiskfs_get_group_desc(sb, param->bg, NULL);
+	if (gdp == NULL)
+		return;
+
+	blk = le32_to_cpu(gdp->bg_inode_table_lo);
+	if (LDISKFS_DESC_SIZE(sb) >= LDISKFS_MIN_DESC_SIZE_64BIT)
+		blk |= (ldiskfs_fsblk_t)le32_to_cpu(gdp->bg_inode_table_hi)
+		       << 32;
+
+	for (i = (start - param->gbase) / ipb;
+	     i <= (end - 1 - param->gbase) / ipb; i++)
+		sb_breadahead(sb, blk + i);
+}
+
+/* Cut the next chunk with some inode in use from os_pos_dispatch, and start
+ * to read its inode table blocks. Return 1 if all have been dispatched. */
+static int osd_scrub_mt_fill(struct osd_iit_param *param,
+			     struct osd_scrub *scrub,
+			     struct osd_scrub_chunk *chunk, __u32 limit)
+{
+	struct super_block *sb	 = param->sb;
+	__u32		    ipg	 = LDISKFS_INODES_PER_GROUP(sb);
+	__u32		    size = min_t(__u32, SCRUB_CHUNK_SIZE, ipg);
+
+	while (scrub->os_pos_dispatch <= limit) {
+		ldiskfs_group_t bg     = (scrub->os_pos_dispatch - 1) / ipg;
+		__u32		offset = (scrub->os_pos_dispatch - 1) % ipg;
+		__u32		end    = min(offset + size, ipg);
+
+		if (param->bitmap == NULL || param->bg != bg) {
+			if (param->bitmap != NULL)
+				brelse(param->bitmap);
+			param->bg = bg;
+			param->gbase = 1 + bg * ipg;
+			param->bitmap = ldiskfs_read_inode_bitmap(sb, bg);
+			if (param->bitmap == NULL) {
+				CERROR("%.16s: fail to read bitmap for %u, "
+				       "scrub will stop, urgent mode\n",
+				       LDISKFS_SB(sb)->s_es->s_volume_name,
+				       (__u32)bg);
+				return -EIO;
+			}
+		}
+
+		scrub->os_pos_dispatch = param->gbase + end;
+		offset = ldiskfs_find_next_bit(param->bitmap->b_data, end,
+					       offset);
+		if (offset >= end)
+			continue;
+
+		chunk->osc_start = param->gbase + offset;
+		chunk->osc_end = param->gbase + end;
+		chunk->osc_done = 0;
+		osd_scrub_readahead(param, chunk->osc_start, chunk->osc_end);
+		return 0;
+	}
+
+	return 1;
+}
+
+static int osd_scrub_mt_exec(struct osd_thread_info *info,
+			     struct osd_scrub_thread *ost,
+			     struct osd_scrub_chunk *chunk)
+{
+	struct osd_device      *dev	= ost->ost_dev;
+	struct osd_scrub       *scrub	= &dev->od_scrub;
+	struct ptlrpc_thread   *thread	= &scrub->os_thread;
+	struct osd_idmap_cache *oic	= &info->oti_cache;
+	struct super_block     *sb	= osd_sb(dev);
+	struct buffer_head     *bitmap;
+	__u32			ipg	= LDISKFS_INODES_PER_GROUP(sb);
+	ldiskfs_group_t		bg	= (chunk->osc_start - 1) / ipg;
+	__u32			gbase	= 1 + bg * ipg;
+	__u32			offset	= chunk->osc_start - gbase;
+	__u32			end	= chunk->osc_end - gbase;
+	int			rc	= 0;
+
+	bitmap = ldiskfs_read_inode_bitmap(sb, bg);
+	if (bitmap == NULL) {
+		CERROR("%.16s: fail to read bitmap for %u, "
+		       "scrub will stop, urgent mode\n",
+		       LDISKFS_SB(sb)->s_es->s_volume_name, (__u32)bg);
+		return -EIO;
+	}
+
+	while (1) {
+		offset = ldiskfs_find_next_bit(bitmap->b_data, end, offset);
+		if (offset >= end)
+			break;
+
+		if (OBD_FAIL_CHECK(OBD_FAIL_OSD_SCRUB_DELAY) &&
+		    cfs_fail_val > 0) {
+			struct l_wait_info lwi;
+
+			lwi = LWI_TIMEOUT(cfs_time_seconds(cfs_fail_val),
+					  NULL, NULL);
+			l_wait_event(thread->t_ctl_waitq,
+				     osd_scrub_mt_abort(scrub), &lwi);
+		}
+
+		if (osd_scrub_mt_abort(scrub)) {
+			rc = 1;
+			break;
+		}
+
+		ost->ost_pos = gbase + offset++;
+		rc = osd_iit_iget(info, dev, &oic->oic_fid, &oic->oic_lid,
+				  ost->ost_pos, sb, true);
+		if (rc == SCRUB_NEXT_CONTINUE) {
+			rc = 0;
+			continue;
+		}
+
+		ost->ost_checked++;
+		if (rc == SCRUB_NEXT_NOSCRUB) {
+			down_read(&scrub->os_rwsem);
+			spin_lock(&scrub->os_lock);
+			scrub->os_new_checked++;
+			scrub->os_file.sf_items_noscrub++;
+			spin_unlock(&scrub->os_lock);
+			up_read(&scrub->os_rwsem);
+			rc = 0;
+			continue;
+		}
+
+		rc = osd_scrub_check_update(info, dev, oic, rc, false);
+		if (rc != 0)
+			break;
+	}
+
+	brelse(bitmap);
+	return rc;
+}
+
+static bool osd_scrub_mt_wakeup(struct osd_scrub *scrub)
+{
+	return !cfs_list_empty(&scrub->os_mt_queue) || scrub->os_mt_over ||
+	       osd_scrub_mt_abort(scrub);
+}
+
+static int osd_scrub_mt_main(void *args)
+{
+	struct osd_scrub_thread *ost	= (struct osd_scrub_thread *)args;
+	struct osd_scrub	*scrub	= &ost->ost_dev->od_scrub;
+	struct ptlrpc_thread	*thread = &scrub->os_thread;
+	struct osd_scrub_chunk	*chunk;
+	struct lu_env		 env;
+	char			 name[16];
+	int			 rc;
+	ENTRY;
+
+	snprintf(name, sizeof(name), "OI_scrub_%02d", ost->ost_index);
+	cfs_daemonize(name);
+	rc = lu_env_init(&env, LCT_DT_THREAD);
+	if (rc != 0) {
+		CERROR("%.16s: OI scrub, fail to init env for thread %d, "
+		       "rc = %d\n",
+		       LDISKFS_SB(osd_scrub2sb(scrub))->s_es->s_volume_name,
+		       ost->ost_index, rc);
+		GOTO(out, rc);
+	}
+
+	spin_lock(&scrub->os_lock);
+	thread_set_flags(&ost->ost_thread, SVC_RUNNING);
+	spin_unlock(&scrub->os_lock);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+
+	while (1) {
+		struct l_wait_info lwi = { 0 };
+
+		l_wait_event(thread->t_ctl_waitq,
+			     osd_scrub_mt_wakeup(scrub),
+			     &lwi);
+
+		if (osd_scrub_mt_abort(scrub))
+			break;
+
+		spin_lock(&scrub->os_lock);
+		if (cfs_list_empty(&scrub->os_mt_queue)) {
+			spin_unlock(&scrub->os_lock);
+			if (scrub->os_mt_over)
+				break;
+			continue;
+		}
+
+		chunk = cfs_list_entry(scrub->os_mt_queue.next,
+				       struct osd_scrub_chunk, osc_link);
+		cfs_list_del_init(&chunk->osc_link);
+		spin_unlock(&scrub->os_lock);
+
+		rc = osd_scrub_mt_exec(osd_oti_get(&env), ost, chunk);
+		if (rc < 0) {
+			osd_scrub_mt_failout(scrub, rc);
+			break;
+		}
+
+		/* Left the interrupted chunk undone, then the checkpoint will
+		 * not go beyond it. */
+		if (rc == 0) {
+			ost->ost_chunks++;
+			spin_lock(&scrub->os_lock);
+			chunk->osc_done = 1;
+			spin_unlock(&scrub->os_lock);
+			cfs_waitq_broadcast(&thread->t_ctl_waitq);
+		}
+	}
+
+	lu_env_fini(&env);
+	rc = 0;
+
+out:
+	spin_lock(&scrub->os_lock);
+	thread_set_flags(&ost->ost_thread, SVC_STOPPED);
+	spin_unlock(&scrub->os_lock);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+	RETURN(rc);
+}
+
+/* Release the finished chunks by dispatch order, and move os_pos_current to
+ * the last inode of them. Return true if there is free chunk. */
+static bool osd_scrub_mt_reap(struct osd_scrub *scrub)
+{
+	struct osd_scrub_chunk *chunk;
+	__u32			pos  = scrub->os_pos_current;
+	bool			free;
+
+	spin_lock(&scrub->os_lock);
+	while (!cfs_list_empty(&scrub->os_mt_order)) {
+		chunk = cfs_list_entry(scrub->os_mt_order.next,
+				       struct osd_scrub_chunk, osc_order);
+		if (!chunk->osc_done)
+			break;
+
+		scrub->os_pos_current = chunk->osc_end - 1;
+		cfs_list_move_tail(&chunk->osc_order, &scrub->os_mt_free);
+	}
+	/* The inodes between the dispatched chunks are not in use. */
+	if (cfs_list_empty(&scrub->os_mt_order))
+		scrub->os_pos_current = scrub->os_pos_dispatch - 1;
+	free = !cfs_list_empty(&scrub->os_mt_free);
+	spin_unlock(&scrub->os_lock);
+
+	/* Wake up the up layer LFSCK which is waiting for the OI scrub. */
+	if (scrub->os_pos_current != pos)
+		cfs_waitq_broadcast(&scrub->os_thread.t_ctl_waitq);
+
+	return free;
+}
+
+static bool osd_scrub_mt_ready(struct osd_scrub *scrub, __u32 limit)
+{
+	bool free = osd_scrub_mt_reap(scrub);
+
+	if (!cfs_list_empty(&scrub->os_inconsistent_items) ||
+	    osd_scrub_mt_abort(scrub))
+		return true;
+
+	/* All have been dispatched, wait for the threads to finish. */
+	if (scrub->os_pos_dispatch > limit)
+		return cfs_list_empty(&scrub->os_mt_order);
+
+	return free;
+}
+
+static bool osd_scrub_mt_stopped(struct osd_scrub *scrub)
+{
+	int i;
+
+	for (i = 0; i < scrub->os_mt_count; i++) {
+		if (!thread_is_init(&scrub->os_mt_threads[i].ost_thread) &&
+		    !thread_is_stopped(&scrub->os_mt_threads[i].ost_thread))
+			return false;
+	}
+	return true;
+}
+
+static void osd_scrub_mt_fini(struct osd_scrub *scrub)
+{
+	struct ptlrpc_thread   *thread = &scrub->os_thread;
+	struct osd_scrub_chunk *chunk;
+	struct l_wait_info	lwi    = { 0 };
+
+	spin_lock(&scrub->os_lock);
+	scrub->os_mt_over = 1;
+	spin_unlock(&scrub->os_lock);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+	l_wait_event(thread->t_ctl_waitq,
+		     osd_scrub_mt_stopped(scrub),
+		     &lwi);
+
+	osd_scrub_mt_reap(scrub);
+
+	spin_lock(&scrub->os_lock);
+	cfs_list_splice_init(&scrub->os_mt_order, &scrub->os_mt_free);
+	CFS_INIT_LIST_HEAD(&scrub->os_mt_queue);
+	scrub->os_mt_running = 0;
+	spin_unlock(&scrub->os_lock);
+
+	while (!cfs_list_empty(&scrub->os_mt_free)) {
+		chunk = cfs_list_entry(scrub->os_mt_free.next,
+				       struct osd_scrub_chunk, osc_order);
+		cfs_list_del(&chunk->osc_order);
+		OBD_FREE_PTR(chunk);
+	}
+}
+
+static int osd_scrub_mt_init(struct osd_device *dev)
+{
+	struct osd_scrub	*scrub	= &dev->od_scrub;
+	struct ptlrpc_thread	*thread = &scrub->os_thread;
+	struct osd_scrub_thread *threads;
+	struct osd_scrub_chunk	*chunk;
+	struct l_wait_info	 lwi	= { 0 };
+	__u32			 count	= scrub->os_threads;
+	int			 rc	= 0;
+	int			 i;
+
+	LASSERT(cfs_list_empty(&scrub->os_mt_free));
+
+	/* os_pos_current has not been processed yet. */
+	scrub->os_pos_dispatch = scrub->os_pos_current;
+	scrub->os_mt_rc = 0;
+	spin_lock(&scrub->os_lock);
+	scrub->os_pos_current--;
+	scrub->os_mt_over = 0;
+	scrub->os_mt_running = 1;
+	spin_unlock(&scrub->os_lock);
+
+	/* The former threads are kept for dump until the next run. */
+	if (scrub->os_mt_count != count) {
+		OBD_ALLOC(threads, sizeof(*threads) * count);
+		if (threads == NULL)
+			return -ENOMEM;
+
+		down_write(&scrub->os_rwsem);
+		if (scrub->os_mt_threads != NULL)
+			OBD_FREE(scrub->os_mt_threads,
+				 sizeof(*threads) * scrub->os_mt_count);
+		scrub->os_mt_threads = threads;
+		scrub->os_mt_count = count;
+		up_write(&scrub->os_rwsem);
+	}
+
+	for (i = 0; i < count * SCRUB_CHUNKS_PER_THREAD; i++) {
+		OBD_ALLOC_PTR(chunk);
+		if (chunk == NULL)
+			return -ENOMEM;
+
+		CFS_INIT_LIST_HEAD(&chunk->osc_link);
+		cfs_list_add_tail(&chunk->osc_order, &scrub->os_mt_free);
+	}
+
+	for (i = 0; i < count; i++) {
+		struct osd_scrub_thread *ost = &scrub->os_mt_threads[i];
+
+		memset(ost, 0, sizeof(*ost));
+		ost->ost_dev = dev;
+		ost->ost_index = i;
+		cfs_waitq_init(&ost->ost_thread.t_ctl_waitq);
+		rc = cfs_create_thread(osd_scrub_mt_main, ost, 0);
+		if (rc < 0) {
+			CERROR("%.16s: cannot start OI scrub thread %d, "
+			       "rc = %d\n",
+			       LDISKFS_SB(osd_sb(dev))->s_es->s_volume_name,
+			       i, rc);
+			break;
+		}
+
+		l_wait_event(thread->t_ctl_waitq,
+			     thread_is_running(&ost->ost_thread) ||
+			     thread_is_stopped(&ost->ost_thread),
+			     &lwi);
+		rc = 0;
+	}
+
+	return rc;
+}
+
+static int osd_scrub_mt_iteration(struct osd_thread_info *info,
+				  struct osd_device *dev)
+{
+	struct osd_scrub	*scrub	= &dev->od_scrub;
+	struct ptlrpc_thread	*thread = &scrub->os_thread;
+	struct osd_iit_param	 param	= { 0 };
+	__u32			 limit;
+	int			 rc;
+	ENTRY;
+
+	param.sb = osd_sb(dev);
+	limit = le32_to_cpu(LDISKFS_SB(param.sb)->s_es->s_inodes_count);
+	rc = osd_scrub_mt_init(dev);
+	if (rc != 0)
+		GOTO(out, rc);
+
+	while (1) {
+		struct l_wait_info	lwi = { 0 };
+		struct osd_scrub_chunk *chunk;
+
+		l_wait_event(thread->t_ctl_waitq,
+			     osd_scrub_mt_ready(scrub, limit),
+			     &lwi);
+
+		if (osd_scrub_mt_abort(scrub))
+			GOTO(out, rc = scrub->os_mt_rc);
+
+		if (OBD_FAIL_CHECK(OBD_FAIL_OSD_SCRUB_CRASH)) {
+			spin_lock(&scrub->os_lock);
+			thread_set_flags(thread, SVC_STOPPING);
+			spin_unlock(&scrub->os_lock);
+			GOTO(out, rc = SCRUB_IT_CRASH);
+		}
+
+		if (OBD_FAIL_CHECK(OBD_FAIL_OSD_SCRUB_FATAL))
+			GOTO(out, rc = -EINVAL);
+
+		while (!cfs_list_empty(&scrub->os_inconsistent_items)) {
+			struct osd_inconsistent_item *oii;
+
+			oii = cfs_list_entry(scrub->os_inconsistent_items.next,
+					     struct osd_inconsistent_item,
+					     oii_list);
+			rc = osd_scrub_check_update(info, dev, &oii->oii_cache,
+						    0, true);
+			if (rc != 0)
+				GOTO(out, rc);
+		}
+
+		rc = osd_scrub_checkpoint(scrub);
+		if (rc != 0) {
+			CERROR("%.16s: fail to checkpoint, pos = %u, rc = %d\n",
+			       LDISKFS_SB(param.sb)->s_es->s_volume_name,
+			       scrub->os_pos_current, rc);
+			/* Continue, as long as the scrub itself can go ahead. */
+		}
+
+		if (scrub->os_pos_dispatch > limit) {
+			if (cfs_list_empty(&scrub->os_mt_order))
+				GOTO(out, rc = SCRUB_IT_ALL);
+			continue;
+		}
+
+		if (cfs_list_empty(&scrub->os_mt_free))
+			continue;
+
+		spin_lock(&scrub->os_lock);
+		chunk = cfs_list_entry(scrub->os_mt_free.next,
+				       struct osd_scrub_chunk, osc_order);
+		cfs_list_del_init(&chunk->osc_order);
+		spin_unlock(&scrub->os_lock);
+
+		rc = osd_scrub_mt_fill(&param, scrub, chunk, limit);
+		spin_lock(&scrub->os_lock);
+		if (rc == 0) {
+			cfs_list_add_tail(&chunk->osc_order,
+					  &scrub->os_mt_order);
+			cfs_list_add_tail(&chunk->osc_link,
+					  &scrub->os_mt_queue);
+		} else {
+			cfs_list_add_tail(&chunk->osc_order,
+					  &scrub->os_mt_free);
+		}
+		spin_unlock(&scrub->os_lock);
+		if (rc < 0)
+			GOTO(out, rc);
+
+		cfs_waitq_broadcast(&thread->t_ctl_waitq);
+	}
+
+out:
+	if (param.bitmap != NULL)
+		brelse(param.bitmap);
+	/* Stop the threads ASAP, do not let them drain the queue. */
+	if (rc < 0)
+		osd_scrub_mt_failout(scrub, rc);
+	osd_scrub_mt_fini(scrub);
+	if (rc >= 0 && scrub->os_mt_rc != 0)
+		rc = scrub->os_mt_rc;
+	RETURN(rc);
+}
+
 static int osd_scrub_main(void *args)
 {
 	struct lu_env	      env;
@@ -1012,7 +1544,12 @@ static int osd_scrub_main(void *args)
 	CDEBUG(D_LFSCK, "OI scrub: flags = 0x%x, pos = %u\n",
 	       scrub->os_start_flags, scrub->os_pos_current);
 
-	rc = osd_inode_iteration(osd_oti_get(&env), dev, ~0U, false);
+	/* The LFSCK may have to wait for the OI scrub in non-full speed mode,
+	 * then follow its order, use the single thread. */
+	if (scrub->os_threads > 1 && scrub->os_full_speed)
+		rc = osd_scrub_mt_iteration(osd_oti_get(&env), dev);
+	else
+		rc = osd_inode_iteration(osd_oti_get(&env), dev, ~0U, false);
 	if (unlikely(rc == SCRUB_IT_CRASH))
 		GOTO(out, rc = -EINVAL);
 	GOTO(post, rc);
@@ -1606,7 +2143,10 @@ static void osd_scrub_stop(struct osd_device *dev)
 {
 	/* od_otable_mutex: prevent curcurrent start/stop */
 	mutex_lock(&dev->od_otable_mutex);
+	/* os_lock: the OI scrub threads may update the other bits. */
+	spin_lock(&dev->od_scrub.os_lock);
 	dev->od_scrub.os_paused = 1;
+	spin_unlock(&dev->od_scrub.os_lock);
 	do_osd_scrub_stop(&dev->od_scrub);
 	mutex_unlock(&dev->od_otable_mutex);
 }
@@ -1639,6 +2179,10 @@ int osd_scrub_setup(const struct lu_env *env, struct osd_device *dev)
 	init_rwsem(&scrub->os_rwsem);
 	spin_lock_init(&scrub->os_lock);
 	CFS_INIT_LIST_HEAD(&scrub->os_inconsistent_items);
+	CFS_INIT_LIST_HEAD(&scrub->os_mt_queue);
+	CFS_INIT_LIST_HEAD(&scrub->os_mt_order);
+	CFS_INIT_LIST_HEAD(&scrub->os_mt_free);
+	scrub->os_threads = 1;
 
 	push_ctxt(&saved, ctxt, NULL);
 	filp = filp_open(osd_scrub_name, O_RDWR | O_CREAT, 0644);
@@ -1707,6 +2251,12 @@ void osd_scrub_cleanup(const struct lu_env *env, struct osd_device *dev)
 		iput(scrub->os_inode);
 		scrub->os_inode = NULL;
 	}
+	if (scrub->os_mt_threads != NULL) {
+		OBD_FREE(scrub->os_mt_threads,
+			 sizeof(*scrub->os_mt_threads) * scrub->os_mt_count);
+		scrub->os_mt_threads = NULL;
+		scrub->os_mt_count = 0;
+	}
 	if (dev->od_oi_table != NULL)
 		osd_oi_fini(osd_oti_get(env), dev);
 }
@@ -1804,7 +2354,10 @@ static void osd_otable_it_put(const struct lu_env *env, struct dt_it *di)
 	/* od_otable_mutex: prevent curcurrent init/fini */
 	mutex_lock(&dev->od_otable_mutex);
 	if (it->ooi_pid == cfs_curproc_pid()) {
+		/* os_lock: the OI scrub threads may update the other bits. */
+		spin_lock(&dev->od_scrub.os_lock);
 		dev->od_scrub.os_paused = 1;
+		spin_unlock(&dev->od_scrub.os_lock);
 	} else {
 		struct ptlrpc_thread *thread = &dev->od_scrub.os_thread;
 
@@ -1922,12 +2475,12 @@ static __u64 osd_otable_it_store(const struct lu_env *env,
 	struct osd_otable_cache *ooc = &it->ooi_cache;
 	__u64			 hash;
 
-	if (it->ooi_user_ready)
-		hash = ooc->ooc_pos_preload;
-	else if (likely(ooc->ooc_consumer_idx != -1))
+	/* The up layer checkpoints by this hash, so return the position of
+	 * the item being consumed rather than the pre-loading position. */
+	if (it->ooi_user_ready && ooc->ooc_consumer_idx != -1)
 		hash = ooc->ooc_cache[ooc->ooc_consumer_idx].oic_lid.oii_ino;
 	else
-		hash = 0;
+		hash = ooc->ooc_pos_preload;
 	return hash;
 }
 
@@ -2254,3 +2807,57 @@ out:
 	up_read(&scrub->os_rwsem);
 	return ret;
 }
+
+int osd_scrub_set_threads(struct osd_device *dev, __u32 threads)
+{
+	if (threads < 1 || threads > SCRUB_THREADS_MAX)
+		return -EINVAL;
+
+	/* Take effect when the OI scrub is started next time. */
+	mutex_lock(&dev->od_otable_mutex);
+	dev->od_scrub.os_threads = threads;
+	mutex_unlock(&dev->od_otable_mutex);
+	return 0;
+}
+
+int osd_scrub_dump_threads(struct osd_device *dev, char *buf, int len)
+{
+	struct osd_scrub *scrub = &dev->od_scrub;
+	int		  save  = len;
+	int		  rc;
+	int		  i;
+
+	down_read(&scrub->os_rwsem);
+	rc = snprintf(buf, len,
+		      "threads: %u\n"
+		      "completed_position: %u\n",
+		      scrub->os_threads,
+		      scrub->os_mt_running ? scrub->os_pos_current : 0);
+	if (rc <= 0)
+		GOTO(out, rc = -ENOSPC);
+
+	buf += rc;
+	len -= rc;
+	for (i = 0; i < scrub->os_mt_count; i++) {
+		struct osd_scrub_thread *ost = &scrub->os_mt_threads[i];
+
+		rc = snprintf(buf, len,
+			      "thread_%02d: %s position: %u chunks: "LPU64
+			      " checked: "LPU64"\n", i,
+			      thread_is_running(&ost->ost_thread) ?
+			      "running" : "stopped",
+			      ost->ost_pos, ost->ost_chunks, ost->ost_checked);
+		if (rc <= 0)
+			GOTO(out, rc = -ENOSPC);
+
+		buf += rc;
+		len -= rc;
+	}
+	rc = save - len;
+
+	GOTO(out, rc);
+
+out:
+	up_read(&scrub->os_rwsem);
+	return rc;
+}
@@ -39,6 +39,14 @@
 #define SCRUB_CHECKPOINT_INTERVAL	60
 #define SCRUB_OI_BITMAP_SIZE		(OSD_OI_FID_NR_MAX >> 3)
 #define SCRUB_WINDOW_SIZE		1024
+#define SCRUB_THREADS_MAX		32
+
+/* How many inodes are dispatched together, never cross block group. */
+#define SCRUB_CHUNK_SIZE		1024
+
+/* How many chunks are dispatched ahead for each thread, their inode table
+ * blocks are read ahead when dispatched. */
+#define SCRUB_CHUNKS_PER_THREAD		4
 
 enum scrub_status {
 	/* The scrub file is new created, for new MDT, upgrading from old disk,
@@ -167,14 +175,41 @@ struct scrub_file {
 	__u8    sf_oi_bitmap[SCRUB_OI_BITMAP_SIZE];
 };
 
+/* A run of the inodes in one block group handled by one OI scrub thread. */
+struct osd_scrub_chunk {
+	/* into osd_scrub::os_mt_queue, when waiting for a thread. */
+	cfs_list_t		osc_link;
+
+	/* into osd_scrub::os_mt_order by dispatch order, or os_mt_free. */
+	cfs_list_t		osc_order;
+
+	/* [osc_start, osc_end) */
+	__u32			osc_start;
+	__u32			osc_end;
+	unsigned int		osc_done:1;
+};
+
+struct osd_scrub_thread {
+	struct ptlrpc_thread	ost_thread;
+	struct osd_device      *ost_dev;
+	int			ost_index;
+
+	/* The inode in processing. */
+	__u32			ost_pos;
+
+	/* Progress of this thread since the OI scrub started. */
+	__u64			ost_chunks;
+	__u64			ost_checked;
+};
+
 struct osd_scrub {
 	struct lvfs_run_ctxt    os_ctxt;
 	struct ptlrpc_thread    os_thread;
 	struct osd_idmap_cache  os_oic;
 	cfs_list_t		os_inconsistent_items;
 
-	/* write lock for scrub prep/update/post/checkpoint,
-	 * read lock for scrub dump. */
+	/* write lock for scrub prep/post/checkpoint,
+	 * read lock for scrub update/dump. */
 	struct rw_semaphore	os_rwsem;
 	spinlock_t		os_lock;
 
@@ -195,13 +230,40 @@ struct osd_scrub {
 
 	/* How many objects have been checked since last checkpoint. */
 	__u32			os_new_checked;
+
+	/* For the multi-threaded scrub, the last inode before which all have
+	 * been processed. */
 	__u32			os_pos_current;
 	__u32			os_start_flags;
+
+	/* How many threads scan the inode table, 1 for single thread. */
+	__u32			os_threads;
+
+	/* The threads for multi-threaded scrub, os_mt_count in total. */
+	struct osd_scrub_thread *os_mt_threads;
+	__u32			os_mt_count;
+
+	/* The next inode to be dispatched to the threads. */
+	__u32			os_pos_dispatch;
+	int			os_mt_rc;
+
+	/* The chunks to be processed, the ones in processing (by dispatch
+	 * order) and the free ones, protected by os_lock. */
+	cfs_list_t		os_mt_queue;
+	cfs_list_t		os_mt_order;
+	cfs_list_t		os_mt_free;
+
+	/* Run w/o speed limit. Set by the OI scrub threads under os_lock,
+	 * out of the bit fields below that the main thread updates without
+	 * the lock. */
+	unsigned int		os_full_speed;
+
 	unsigned int		os_in_prior:1, /* process inconsistent item
 						* found by RPC prior */
 				os_waiting:1, /* Waiting for scan window. */
-				os_full_speed:1, /* run w/o speed limit */
-				os_paused:1; /* The scrub is paused. */
+				os_paused:1, /* The scrub is paused. */
+				os_mt_running:1, /* multi-threaded scrub */
+				os_mt_over:1; /* no more chunk to dispatch */
 };
 
 #endif /* _OSD_SCRUB_H */
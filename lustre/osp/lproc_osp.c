@@ -195,6 +195,69 @@ static int osp_wr_max_rpcs_in_prog(struct file *file, const char *buffer,
 	return count;
 }
 
+static int osp_rd_max_sync_batch(char *page, char **start, off_t off,
+				 int count, int *eof, void *data)
+{
+	struct obd_device	*dev = data;
+	struct osp_device	*osp = lu2osp_dev(dev->obd_lu_dev);
+
+	if (osp == NULL)
+		return -EINVAL;
+
+	return snprintf(page, count, "%d\n", osp->opd_syn_max_batch);
+}
+
+static int osp_wr_max_sync_batch(struct file *file, const char *buffer,
+				 unsigned long count, void *data)
+{
+	struct obd_device	*dev = data;
+	struct osp_device	*osp = lu2osp_dev(dev->obd_lu_dev);
+	int			 val, rc;
+
+	if (osp == NULL)
+		return -EINVAL;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	/* 1 sends every llog record in its own RPC, as old OSTs need */
+	if (val < 1 || val > OST_SYNC_BATCH_MAX)
+		return -ERANGE;
+
+	osp->opd_syn_max_batch = val;
+
+	return count;
+}
+
+static int osp_rd_sync_batch_stats(char *page, char **start, off_t off,
+				   int count, int *eof, void *data)
+{
+	struct obd_device	*dev = data;
+	struct osp_device	*osp = lu2osp_dev(dev->obd_lu_dev);
+	__u64			 rpcs, recs, avg = 0;
+
+	if (osp == NULL)
+		return -EINVAL;
+
+	spin_lock(&osp->opd_syn_lock);
+	rpcs = osp->opd_syn_batch_rpcs;
+	recs = osp->opd_syn_batch_recs;
+	spin_unlock(&osp->opd_syn_lock);
+
+	if (rpcs > 0) {
+		avg = recs;
+		do_div(avg, rpcs);
+	}
+
+	return snprintf(page, count,
+			"batch_rpcs: "LPU64"\n"
+			"batch_records: "LPU64"\n"
+			"avg_batch_size: "LPU64"\n"
+			"drain_rate: %lu recs/s\n",
+			rpcs, recs, avg, osp->opd_syn_drain_rate);
+}
+
 static int osp_rd_create_count(char *page, char **start, off_t off, int count,
 			       int *eof, void *data)
 {
@@ -455,6 +518,9 @@ static struct lprocfs_vars lprocfs_osp_obd_vars[] = {
 	{ "sync_in_flight",	osp_rd_syn_in_flight, 0, 0 },
 	{ "sync_in_progress",	osp_rd_syn_in_prog, 0, 0 },
 	{ "old_sync_processed",	osp_rd_old_sync_processed, 0, 0 },
+	{ "max_sync_batch",	osp_rd_max_sync_batch,
+				osp_wr_max_sync_batch, 0 },
+	{ "sync_batch_stats",	osp_rd_sync_batch_stats, 0, 0 },
 
 	/* for compatibility reasons */
 	{ "destroys_in_flight",	osp_rd_destroys_in_flight, 0, 0 },
@@ -155,6 +155,16 @@ struct osp_device {
 	/* number of RPC in processing (including non-committed by OST) */
 	int				 opd_syn_rpc_in_progress;
 	int				 opd_syn_max_rpc_in_progress;
+	/* OST_SYNC_BATCH being filled, sent once full or when idle */
+	struct ptlrpc_request		*opd_syn_batch;
+	/* max records per OST_SYNC_BATCH, 1 disables batching */
+	int				 opd_syn_max_batch;
+	__u64				 opd_syn_batch_rpcs;
+	__u64				 opd_syn_batch_recs;
+	/* records cancelled per second, sampled over few seconds */
+	unsigned long			 opd_syn_drain_rate;
+	unsigned long			 opd_syn_drain_done;
+	cfs_time_t			 opd_syn_drain_stamp;
 	/* osd api's commit cb control structure */
 	struct dt_txn_callback		 opd_syn_txn_cb;
 	/* last used change number -- semantically similar to transno */
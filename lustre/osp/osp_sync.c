@@ -96,6 +96,17 @@ static void osp_sync_remove_from_tracker(struct osp_device *d);
 
 #define OSP_JOB_MAGIC		0x26112005
 
+/* drain rate of the llog is sampled over windows of this many seconds */
+#define OSP_SYNC_RATE_WINDOW	5
+
+/* llog records carried by one OST_SYNC_BATCH, to cancel them once the
+ * batch is committed on OST */
+struct osp_sync_batch {
+	int			osb_count;
+	int			osb_max;
+	struct llog_cookie	osb_cookies[OST_SYNC_BATCH_MAX];
+};
+
 static inline int osp_sync_running(struct osp_device *d)
 {
 	return !!(d->opd_syn_thread.t_flags & SVC_RUNNING);
@@ -307,6 +318,26 @@ int osp_sync_gap(const struct lu_env *env, struct osp_device *d,
  * XXX: should be optimized?
  */
 
+static inline struct osp_sync_batch *
+osp_sync_req2batch(struct ptlrpc_request *req)
+{
+	union ptlrpc_async_args *aa;
+
+	if (lustre_msg_get_opc(req->rq_reqmsg) != OST_SYNC_BATCH)
+		return NULL;
+
+	aa = ptlrpc_req_async_args(req);
+	return aa->pointer_arg[0];
+}
+
+static void osp_sync_batch_free(struct ptlrpc_request *req)
+{
+	union ptlrpc_async_args *aa = ptlrpc_req_async_args(req);
+
+	OBD_FREE_PTR(aa->pointer_arg[0]);
+	aa->pointer_arg[0] = NULL;
+}
+
 /**
  * called for each RPC reported committed
  */
@@ -377,12 +408,19 @@ static int osp_sync_interpret(const struct lu_env *env,
 			 req->rq_transno, rc, req->rq_import_generation,
 			 imp->imp_generation);
 		if (req->rq_transno == 0) {
+			struct osp_sync_batch *batch = osp_sync_req2batch(req);
+			int		       done = 1;
+
 			/* this is the last time we see the request
 			 * if transno is not zero, then commit cb
 			 * will be called at some point */
-			LASSERT(d->opd_syn_rpc_in_progress > 0);
+			if (batch != NULL) {
+				done = batch->osb_count;
+				osp_sync_batch_free(req);
+			}
+			LASSERT(d->opd_syn_rpc_in_progress >= done);
 			spin_lock(&d->opd_syn_lock);
-			d->opd_syn_rpc_in_progress--;
+			d->opd_syn_rpc_in_progress -= done;
 			spin_unlock(&d->opd_syn_lock);
 		}
 
@@ -554,12 +592,196 @@ static int osp_sync_new_unlink64_job(struct osp_device *d,
 	RETURN(0);
 }
 
+static inline int osp_sync_batch_supported(struct osp_device *d)
+{
+	struct obd_import *imp = d->opd_obd->u.cli.cl_import;
+
+	return d->opd_syn_max_batch > 1 &&
+	       (imp->imp_connect_data.ocd_connect_flags &
+		OBD_CONNECT_SYNC_BATCH);
+}
+
+/*
+ * allocate a new OST_SYNC_BATCH, records are added to it by
+ * osp_sync_batch_add() and it's sent by osp_sync_batch_flush()
+ */
+static struct ptlrpc_request *osp_sync_batch_new(struct osp_device *d)
+{
+	struct ptlrpc_request	*req;
+	struct osp_sync_batch	*batch;
+	union ptlrpc_async_args	*aa;
+	struct obd_import	*imp;
+	int			 max = d->opd_syn_max_batch;
+	int			 rc;
+
+	imp = d->opd_obd->u.cli.cl_import;
+	LASSERT(imp);
+	LASSERT(max > 1 && max <= OST_SYNC_BATCH_MAX);
+
+	OBD_ALLOC_PTR(batch);
+	if (batch == NULL)
+		return ERR_PTR(-ENOMEM);
+	batch->osb_max = max;
+
+	req = ptlrpc_request_alloc(imp, &RQF_OST_SYNC_BATCH);
+	if (req == NULL) {
+		OBD_FREE_PTR(batch);
+		return ERR_PTR(-ENOMEM);
+	}
+
+	req_capsule_set_size(&req->rq_pill, &RMF_OST_SYNC_REC, RCL_CLIENT,
+			     max * sizeof(struct ost_sync_rec));
+	rc = ptlrpc_request_pack(req, LUSTRE_OST_VERSION, OST_SYNC_BATCH);
+	if (rc) {
+		ptlrpc_request_free(req);
+		OBD_FREE_PTR(batch);
+		return ERR_PTR(rc);
+	}
+
+	aa = ptlrpc_req_async_args(req);
+	aa->pointer_arg[0] = batch;
+
+	CFS_INIT_LIST_HEAD(&req->rq_exp_list);
+	req->rq_svc_thread = (void *) OSP_JOB_MAGIC;
+
+	req->rq_interpret_reply = osp_sync_interpret;
+	req->rq_commit_cb = osp_sync_request_commit_cb;
+	req->rq_cb_data = d;
+
+	ptlrpc_request_set_replen(req);
+
+	return req;
+}
+
+/* send the batch being filled, if any */
+static void osp_sync_batch_flush(struct osp_device *d)
+{
+	struct ptlrpc_request	*req = d->opd_syn_batch;
+	struct osp_sync_batch	*batch;
+
+	if (req == NULL)
+		return;
+
+	d->opd_syn_batch = NULL;
+	batch = osp_sync_req2batch(req);
+	LASSERT(batch != NULL);
+
+	if (batch->osb_count == 0) {
+		spin_lock(&d->opd_syn_lock);
+		d->opd_syn_rpc_in_flight--;
+		spin_unlock(&d->opd_syn_lock);
+		osp_sync_batch_free(req);
+		ptlrpc_req_finished(req);
+		return;
+	}
+
+	req_capsule_shrink(&req->rq_pill, &RMF_OST_SYNC_REC,
+			   batch->osb_count * sizeof(struct ost_sync_rec),
+			   RCL_CLIENT);
+
+	spin_lock(&d->opd_syn_lock);
+	d->opd_syn_batch_rpcs++;
+	d->opd_syn_batch_recs += batch->osb_count;
+	spin_unlock(&d->opd_syn_lock);
+
+	CDEBUG(D_HA, "%s: send batch of %d records\n",
+	       d->opd_obd->obd_name, batch->osb_count);
+	osp_sync_send_new_rpc(d, req);
+}
+
+/*
+ * drop the batch being filled on shutdown, its records stay in the llog
+ * and will be processed on the next start
+ */
+static void osp_sync_batch_abort(struct osp_device *d)
+{
+	struct ptlrpc_request	*req = d->opd_syn_batch;
+	struct osp_sync_batch	*batch;
+
+	if (req == NULL)
+		return;
+
+	d->opd_syn_batch = NULL;
+	batch = osp_sync_req2batch(req);
+	LASSERT(batch != NULL);
+
+	spin_lock(&d->opd_syn_lock);
+	d->opd_syn_rpc_in_flight--;
+	d->opd_syn_rpc_in_progress -= batch->osb_count;
+	spin_unlock(&d->opd_syn_lock);
+
+	osp_sync_batch_free(req);
+	ptlrpc_req_finished(req);
+}
+
+static int osp_sync_batch_add(struct osp_device *d, struct llog_handle *llh,
+			      struct llog_rec_hdr *h)
+{
+	struct ptlrpc_request	*req = d->opd_syn_batch;
+	struct osp_sync_batch	*batch;
+	struct ost_sync_rec	*osr;
+	struct llog_cookie	*cookie;
+	int			 rc;
+
+	ENTRY;
+
+	if (req == NULL) {
+		req = osp_sync_batch_new(d);
+		if (IS_ERR(req))
+			RETURN(PTR_ERR(req));
+
+		/* the whole batch is a single RPC in flight */
+		spin_lock(&d->opd_syn_lock);
+		d->opd_syn_rpc_in_flight++;
+		spin_unlock(&d->opd_syn_lock);
+		d->opd_syn_batch = req;
+	}
+
+	batch = osp_sync_req2batch(req);
+	LASSERT(batch->osb_count < batch->osb_max);
+
+	osr = req_capsule_client_get(&req->rq_pill, &RMF_OST_SYNC_REC);
+	LASSERT(osr);
+	osr += batch->osb_count;
+	memset(osr, 0, sizeof(*osr));
+
+	if (h->lrh_type == MDS_UNLINK64_REC) {
+		struct llog_unlink64_rec *rec = (struct llog_unlink64_rec *)h;
+
+		rc = fid_to_ostid(&rec->lur_fid, &osr->osr_oi);
+		if (rc < 0)
+			RETURN(rc);
+		osr->osr_op = OST_DESTROY;
+		osr->osr_count = rec->lur_count;
+	} else {
+		struct llog_setattr64_rec *rec = (struct llog_setattr64_rec *)h;
+
+		LASSERT(h->lrh_type == MDS_SETATTR64_REC);
+		osr->osr_oi = rec->lsr_oi;
+		osr->osr_op = OST_SETATTR;
+		osr->osr_uid = rec->lsr_uid;
+		osr->osr_gid = rec->lsr_gid;
+	}
+
+	cookie = &batch->osb_cookies[batch->osb_count];
+	cookie->lgc_lgl = llh->lgh_id;
+	cookie->lgc_subsys = LLOG_MDS_OST_ORIG_CTXT;
+	cookie->lgc_index = h->lrh_index;
+	batch->osb_count++;
+
+	if (batch->osb_count == batch->osb_max)
+		osp_sync_batch_flush(d);
+
+	RETURN(0);
+}
+
 static int osp_sync_process_record(const struct lu_env *env,
 				   struct osp_device *d,
 				   struct llog_handle *llh,
 				   struct llog_rec_hdr *rec)
 {
 	struct llog_cookie	 cookie;
+	int			 batch = 0;
 	int			 rc = 0;
 
 	cookie.lgc_lgl = llh->lgh_id;
@@ -589,13 +811,26 @@ static int osp_sync_process_record(const struct lu_env *env,
 	 * and fire after next commit callback
 	 */
 
+	/* new records are packed into OST_SYNC_BATCH if OST supports it,
+	 * then in-flight is accounted per batch, not per record */
+	if ((rec->lrh_type == MDS_UNLINK64_REC ||
+	     rec->lrh_type == MDS_SETATTR64_REC) &&
+	    osp_sync_batch_supported(d))
+		batch = 1;
+
 	/* notice we increment counters before sending RPC, to be consistent
 	 * in RPC interpret callback which may happen very quickly */
 	spin_lock(&d->opd_syn_lock);
-	d->opd_syn_rpc_in_flight++;
+	if (!batch)
+		d->opd_syn_rpc_in_flight++;
 	d->opd_syn_rpc_in_progress++;
 	spin_unlock(&d->opd_syn_lock);
 
+	if (batch) {
+		rc = osp_sync_batch_add(d, llh, rec);
+		goto out;
+	}
+
 	switch (rec->lrh_type) {
 	/* case MDS_UNLINK_REC is kept for compatibility */
 	case MDS_UNLINK_REC:
@@ -613,6 +848,7 @@ static int osp_sync_process_record(const struct lu_env *env,
 		       break;
 	}
 
+out:
 	if (likely(rc == 0)) {
 		spin_lock(&d->opd_syn_lock);
 		if (d->opd_syn_prev_done) {
@@ -633,7 +869,8 @@ static int osp_sync_process_record(const struct lu_env *env,
 		spin_unlock(&d->opd_syn_lock);
 	} else {
 		spin_lock(&d->opd_syn_lock);
-		d->opd_syn_rpc_in_flight--;
+		if (!batch)
+			d->opd_syn_rpc_in_flight--;
 		d->opd_syn_rpc_in_progress--;
 		spin_unlock(&d->opd_syn_lock);
 	}
@@ -643,6 +880,27 @@ static int osp_sync_process_record(const struct lu_env *env,
 	return rc;
 }
 
+/*
+ * account records cancelled from the llog and refresh the drain rate,
+ * caller must hold opd_syn_lock
+ */
+static void osp_sync_drain_update(struct osp_device *d, int done)
+{
+	cfs_time_t	now = cfs_time_current();
+	long		age;
+
+	if (d->opd_syn_drain_stamp == 0)
+		d->opd_syn_drain_stamp = now;
+
+	d->opd_syn_drain_done += done;
+	age = cfs_duration_sec(cfs_time_sub(now, d->opd_syn_drain_stamp));
+	if (age >= OSP_SYNC_RATE_WINDOW) {
+		d->opd_syn_drain_rate = d->opd_syn_drain_done / age;
+		d->opd_syn_drain_done = 0;
+		d->opd_syn_drain_stamp = now;
+	}
+}
+
 static void osp_sync_process_committed(const struct lu_env *env,
 				       struct osp_device *d)
 {
@@ -689,17 +947,28 @@ static void osp_sync_process_committed(const struct lu_env *env,
 	spin_unlock(&d->opd_syn_lock);
 
 	cfs_list_for_each_entry_safe(req, tmp, &list, rq_exp_list) {
+		struct osp_sync_batch	*batch;
+		struct llog_cookie	*cookies;
+		int			 count = 1;
+
 		LASSERT(req->rq_svc_thread == (void *) OSP_JOB_MAGIC);
 		cfs_list_del_init(&req->rq_exp_list);
 
-		body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
-		LASSERT(body);
+		batch = osp_sync_req2batch(req);
+		if (batch != NULL) {
+			cookies = batch->osb_cookies;
+			count = batch->osb_count;
+		} else {
+			body = req_capsule_client_get(&req->rq_pill,
+						      &RMF_OST_BODY);
+			LASSERT(body);
+			cookies = &body->oa.o_lcookie;
+		}
 
 		/* import can be closing, thus all commit cb's are
 		 * called we can check committness directly */
 		if (req->rq_transno <= imp->imp_peer_committed_transno) {
-			rc = llog_cat_cancel_records(env, llh, 1,
-						     &body->oa.o_lcookie);
+			rc = llog_cat_cancel_records(env, llh, count, cookies);
 			if (rc)
 				CERROR("%s: can't cancel record: %d\n",
 				       obd->obd_name, rc);
@@ -707,8 +976,10 @@ static void osp_sync_process_committed(const struct lu_env *env,
 			DEBUG_REQ(D_HA, req, "not committed");
 		}
 
+		if (batch != NULL)
+			osp_sync_batch_free(req);
 		ptlrpc_req_finished(req);
-		done++;
+		done += count;
 	}
 
 	llog_ctxt_put(ctxt);
@@ -716,6 +987,7 @@ static void osp_sync_process_committed(const struct lu_env *env,
 	LASSERT(d->opd_syn_rpc_in_progress >= done);
 	spin_lock(&d->opd_syn_lock);
 	d->opd_syn_rpc_in_progress -= done;
+	osp_sync_drain_update(d, done);
 	spin_unlock(&d->opd_syn_lock);
 	CDEBUG(D_OTHER, "%s: %d in flight, %d in progress\n",
 	       d->opd_obd->obd_name, d->opd_syn_rpc_in_flight,
@@ -778,6 +1050,7 @@ static int osp_sync_process_queues(const struct lu_env *env,
 				 */
 				if (rc) {
 					CERROR("can't send: %d\n", rc);
+					osp_sync_batch_flush(d);
 					l_wait_event(d->opd_syn_waitq,
 						     !osp_sync_running(d) ||
 						     osp_sync_has_work(d),
@@ -792,6 +1065,9 @@ static int osp_sync_process_queues(const struct lu_env *env,
 		if (d->opd_syn_last_processed_id == d->opd_syn_last_used_id)
 			osp_sync_remove_from_tracker(d);
 
+		/* nothing to add to the batch right now, don't hold it */
+		osp_sync_batch_flush(d);
+
 		l_wait_event(d->opd_syn_waitq,
 			     !osp_sync_running(d) ||
 			     osp_sync_can_process_new(d, rec) ||
@@ -867,6 +1143,8 @@ static int osp_sync_thread(void *_arg)
 		 d->opd_syn_changes, d->opd_syn_rpc_in_progress,
 		 d->opd_syn_rpc_in_flight);
 
+	osp_sync_batch_abort(d);
+
 	/* wait till all the requests are completed */
 	count = 0;
 	while (d->opd_syn_rpc_in_progress > 0) {
@@ -1036,6 +1314,7 @@ int osp_sync_init(const struct lu_env *env, struct osp_device *d)
 	 */
 	d->opd_syn_max_rpc_in_flight = OSP_MAX_IN_FLIGHT;
 	d->opd_syn_max_rpc_in_progress = OSP_MAX_IN_PROGRESS;
+	d->opd_syn_max_batch = OST_SYNC_BATCH_MAX;
 	spin_lock_init(&d->opd_syn_lock);
 	cfs_waitq_init(&d->opd_syn_waitq);
 	cfs_waitq_init(&d->opd_syn_thread.t_ctl_waitq);
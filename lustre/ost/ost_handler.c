@@ -222,6 +222,54 @@ static int ost_destroy(struct obd_export *exp, struct ptlrpc_request *req,
         RETURN(0);
 }
 
+/**
+ * Destroy or chown a batch of objects for the MDS, see OST_SYNC_BATCH.
+ */
+static int ost_sync_batch(struct obd_export *exp, struct ptlrpc_request *req,
+			  struct obd_trans_info *oti)
+{
+	struct ost_sync_rec	*recs;
+	int			 count;
+	int			 rc;
+	int			 i;
+	ENTRY;
+
+	if (!(exp_connect_flags(exp) & OBD_CONNECT_SYNC_BATCH))
+		RETURN(-EPROTO);
+
+	recs = req_capsule_client_get(&req->rq_pill, &RMF_OST_SYNC_REC);
+	if (recs == NULL)
+		RETURN(-EFAULT);
+
+	count = req_capsule_get_size(&req->rq_pill, &RMF_OST_SYNC_REC,
+				     RCL_CLIENT) / sizeof(*recs);
+	if (count == 0 || count > OST_SYNC_BATCH_MAX)
+		RETURN(-EPROTO);
+
+	for (i = 0; i < count; i++) {
+		obd_seq seq = ostid_seq(&recs[i].osr_oi);
+
+		if ((recs[i].osr_op != OST_DESTROY &&
+		     recs[i].osr_op != OST_SETATTR) ||
+		    ostid_id(&recs[i].osr_oi) == 0 ||
+		    !(fid_seq_is_idif(seq) || fid_seq_is_mdt(seq))) {
+			CERROR("%s: %s sent bad sync op %u for "DOSTID
+			       ": rc = -EPROTO\n", exp->exp_obd->obd_name,
+			       obd_export_nid2str(exp), recs[i].osr_op,
+			       POSTID(&recs[i].osr_oi));
+			RETURN(-EPROTO);
+		}
+	}
+
+	rc = req_capsule_server_pack(&req->rq_pill);
+	if (rc)
+		RETURN(rc);
+
+	req->rq_status = obd_sync_batch(req->rq_svc_thread->t_env, exp, recs,
+					count, oti);
+	RETURN(0);
+}
+
 /**
  * Helper function for getting server side [start, start+count] DLM lock
  * if asked by client.
@@ -970,6 +1018,105 @@ static void ost_warn_on_cksum(struct ptlrpc_request *req,
 			   client_cksum, server_cksum);
 }
 
+/*
+ * Commit the first \a nr objects of a write prepared by ost_brw_prep_write(),
+ * returns the first error.
+ */
+static int ost_brw_commit_write(struct ptlrpc_request *req,
+				struct obdo *oa, struct obdo *oas,
+				struct obd_ioobj *ioo, int nr,
+				struct niobuf_remote *remote_nb,
+				struct niobuf_local *local_nb, int *nr_local,
+				struct obd_trans_info *oti, int rc)
+{
+	int i;
+	int rc2;
+	int result = rc;
+
+	for (i = 0; i < nr; i++) {
+		rc2 = obd_commitrw(req->rq_svc_thread->t_env, OBD_BRW_WRITE,
+				   req->rq_export, i == 0 ? oa : &oas[i], 1,
+				   &ioo[i], remote_nb, nr_local[i], local_nb,
+				   oti, rc);
+		if (result == 0)
+			result = rc2;
+		remote_nb += ioo[i].ioo_bufcnt;
+		local_nb += nr_local[i];
+	}
+	return result;
+}
+
+/*
+ * Prepare the pages of all objects of a write. The first object uses \a oa
+ * which carries grant and quota information back to the client. The others
+ * of a multi-object write get a copy of it without grant, so that is only
+ * accounted once, and without the parent FID, times, size and blocks which
+ * are those of the first object. Returns the number of prepared pages, or a negative error after
+ * releasing what was already prepared.
+ */
+static int ost_brw_prep_write(struct ptlrpc_request *req, struct obdo *oa,
+			      struct obdo *oas, struct obd_ioobj *ioo,
+			      int objcount, struct niobuf_remote *remote_nb,
+			      struct niobuf_local *local_nb, int *nr_local,
+			      struct obd_trans_info *oti,
+			      struct lustre_capa *capa)
+{
+	struct niobuf_remote *rnb = remote_nb;
+	int npages = 0;
+	int rc = 0;
+	int i;
+
+	/* copy before obd_preprw() clobbers @oa */
+	for (i = 1; i < objcount; i++) {
+		oas[i] = *oa;
+		oas[i].o_oi = ioo[i].ioo_oid;
+		oas[i].o_valid &= ~(OBD_MD_FLGRANT | OBD_MD_FLFID |
+				    OBD_MD_FLHANDLE | OBD_MD_FLATIME |
+				    OBD_MD_FLMTIME | OBD_MD_FLCTIME |
+				    OBD_MD_FLSIZE | OBD_MD_FLBLOCKS);
+		rc = ost_validate_obdo(req->rq_export, &oas[i], &ioo[i]);
+		if (rc != 0)
+			return rc;
+	}
+
+	for (i = 0; i < objcount; i++) {
+		nr_local[i] = OST_THREAD_POOL_SIZE - npages;
+		rc = obd_preprw(req->rq_svc_thread->t_env, OBD_BRW_WRITE,
+				req->rq_export, i == 0 ? oa : &oas[i], 1,
+				&ioo[i], rnb, &nr_local[i], local_nb + npages,
+				oti, capa);
+		if (rc != 0)
+			break;
+		npages += nr_local[i];
+		rnb += ioo[i].ioo_bufcnt;
+	}
+
+	if (rc != 0) {
+		ost_brw_commit_write(req, oa, oas, ioo, i, remote_nb, local_nb,
+				     nr_local, oti, rc);
+		return rc;
+	}
+	return npages;
+}
+
+/*
+ * Number of local pages the \a niocount remote niobufs of a write map to,
+ * counting stops once it is over OST_THREAD_POOL_SIZE.
+ */
+static int ost_brw_npages(struct niobuf_remote *nb, int niocount)
+{
+	int npages = 0;
+	int i;
+
+	for (i = 0; i < niocount && npages <= OST_THREAD_POOL_SIZE; i++) {
+		if (nb[i].len == 0)
+			return OST_THREAD_POOL_SIZE + 1;
+		npages += ((nb[i].offset + nb[i].len - 1) >> CFS_PAGE_SHIFT) -
+			  (nb[i].offset >> CFS_PAGE_SHIFT) + 1;
+	}
+	return npages;
+}
+
 static int ost_brw_write(struct ptlrpc_request *req, struct obd_trans_info *oti)
 {
         struct ptlrpc_bulk_desc *desc = NULL;
@@ -982,13 +1129,15 @@ static int ost_brw_write(struct ptlrpc_request *req, struct obd_trans_info *oti)
         struct lustre_handle     lockh = {0};
         struct lustre_capa      *capa = NULL;
         __u32                   *rcs;
-        int objcount, niocount, npages;
+        int objcount = 0, niocount, npages;
         int rc, i, j;
         obd_count                client_cksum = 0, server_cksum = 0;
         cksum_type_t             cksum_type = OBD_CKSUM_CRC32;
         int                      no_reply = 0, mmap = 0;
         __u32                    o_uid = 0, o_gid = 0;
         struct ost_thread_local_cache *tls;
+	struct obdo		*oas = NULL; /* multi-object write */
+	int			 nr_local[PTLRPC_MAX_BRW_OBJS];
         ENTRY;
 
         req->rq_bulk_write = 1;
@@ -1017,6 +1166,14 @@ static int ost_brw_write(struct ptlrpc_request *req, struct obd_trans_info *oti)
         if (rc)
                 RETURN(rc);
 
+	if (objcount > PTLRPC_MAX_BRW_OBJS)
+		GOTO(out, rc = -EPROTO);
+	if (objcount > 1) {
+		OBD_ALLOC(oas, sizeof(*oas) * objcount);
+		if (oas == NULL)
+			GOTO(out, rc = -ENOMEM);
+	}
+
         for (niocount = i = 0; i < objcount; i++)
                 niocount += ioo[i].ioo_bufcnt;
 
@@ -1030,6 +1187,14 @@ static int ost_brw_write(struct ptlrpc_request *req, struct obd_trans_info *oti)
             &RMF_NIOBUF_REMOTE, RCL_CLIENT) / sizeof(*remote_nb)))
                 GOTO(out, rc = -EFAULT);
 
+	/* the pages of all objects must fit in the thread's local niobufs */
+	if (ost_brw_npages(remote_nb, niocount) > OST_THREAD_POOL_SIZE) {
+		CERROR("%s: write of %d objects from %s is too large\n",
+		       exp->exp_obd->obd_name, objcount,
+		       libcfs_id2str(req->rq_peer));
+		GOTO(out, rc = -EPROTO);
+	}
+
         if ((remote_nb[0].flags & OBD_BRW_MEMALLOC) &&
             (exp->exp_connection->c_peer.nid == exp->exp_connection->c_self))
                 cfs_memory_pressure_set();
@@ -1099,12 +1264,11 @@ static int ost_brw_write(struct ptlrpc_request *req, struct obd_trans_info *oti)
         repbody = req_capsule_server_get(&req->rq_pill, &RMF_OST_BODY);
         memcpy(&repbody->oa, &body->oa, sizeof(repbody->oa));
 
-        npages = OST_THREAD_POOL_SIZE;
-        rc = obd_preprw(req->rq_svc_thread->t_env, OBD_BRW_WRITE, exp,
-                        &repbody->oa, objcount, ioo, remote_nb, &npages,
-                        local_nb, oti, capa);
-        if (rc != 0)
-                GOTO(out_lock, rc);
+	npages = ost_brw_prep_write(req, &repbody->oa, oas, ioo, objcount,
+				    remote_nb, local_nb, nr_local, oti, capa);
+	if (npages < 0)
+		GOTO(out_lock, rc = npages);
+	rc = 0;
 
 	desc = ptlrpc_prep_bulk_exp(req, npages, ioobj_max_brw_get(ioo),
 				    BULK_GET_SINK, OST_BULK_PORTAL);
@@ -1146,9 +1310,8 @@ skip_transfer:
         }
 
         /* Must commit after prep above in all cases */
-        rc = obd_commitrw(req->rq_svc_thread->t_env, OBD_BRW_WRITE, exp,
-                          &repbody->oa, objcount, ioo, remote_nb, npages,
-                          local_nb, oti, rc);
+	rc = ost_brw_commit_write(req, &repbody->oa, oas, ioo, objcount,
+				  remote_nb, local_nb, nr_local, oti, rc);
         if (rc == -ENOTCONN)
                 /* quota acquire process has been given up because
                  * either the client has been evicted or the client
@@ -1197,6 +1360,8 @@ out_bulk:
         if (desc)
 		ptlrpc_free_bulk_nopin(desc);
 out:
+	if (oas != NULL)
+		OBD_FREE(oas, sizeof(*oas) * objcount);
         if (rc == 0) {
                 oti_to_request(oti, req);
                 target_committed_to_req(req);
@@ -1660,6 +1825,7 @@ static int ost_filter_recovery_request(struct ptlrpc_request *req,
         case OBD_PING:
         case OST_CREATE:
         case OST_DESTROY:
+	case OST_SYNC_BATCH:
         case OST_PUNCH:
         case OST_SETATTR:
         case OST_SYNC:
@@ -1705,6 +1871,7 @@ int ost_msg_check_version(struct lustre_msg *msg)
 		break;
         case OST_CREATE:
         case OST_DESTROY:
+	case OST_SYNC_BATCH:
         case OST_GETATTR:
         case OST_SETATTR:
         case OST_WRITE:
@@ -1814,7 +1981,7 @@ static void ost_prolong_locks(struct ost_prolong_data *data)
         struct ldlm_lock  *lock;
         ENTRY;
 
-        if (oa->o_valid & OBD_MD_FLHANDLE) {
+        if (oa != NULL && oa->o_valid & OBD_MD_FLHANDLE) {
                 /* mostly a request should be covered by only one lock, try
                  * fast path. */
                 lock = ldlm_handle2lock(&oa->o_handle);
@@ -1863,6 +2030,7 @@ static int ost_rw_hpreq_lock_match(struct ptlrpc_request *req,
         struct niobuf_remote *nb;
         struct obd_ioobj *ioo;
         int mode, opc;
+        int objcount;
         struct ldlm_extent ext;
         ENTRY;
 
@@ -1871,25 +2039,31 @@ static int ost_rw_hpreq_lock_match(struct ptlrpc_request *req,
 
         ioo = req_capsule_client_get(&req->rq_pill, &RMF_OBD_IOOBJ);
         LASSERT(ioo != NULL);
+	objcount = req_capsule_get_size(&req->rq_pill, &RMF_OBD_IOOBJ,
+					RCL_CLIENT) / sizeof(*ioo);
 
         nb = req_capsule_client_get(&req->rq_pill, &RMF_NIOBUF_REMOTE);
         LASSERT(nb != NULL);
 
-        ext.start = nb->offset;
-        nb += ioo->ioo_bufcnt - 1;
-        ext.end = nb->offset + nb->len - 1;
-
-	LASSERT(lock->l_resource != NULL);
-	if (!ostid_res_name_eq(&ioo->ioo_oid, &lock->l_resource->lr_name))
-		RETURN(0);
-
         mode = LCK_PW;
         if (opc == OST_READ)
                 mode |= LCK_PR;
         if (!(lock->l_granted_mode & mode))
                 RETURN(0);
 
-        RETURN(ldlm_extent_overlap(&lock->l_policy_data.l_extent, &ext));
+	LASSERT(lock->l_resource != NULL);
+	for (; objcount > 0; objcount--, nb += ioo->ioo_bufcnt, ioo++) {
+		if (!ostid_res_name_eq(&ioo->ioo_oid,
+				       &lock->l_resource->lr_name))
+			continue;
+
+		ext.start = nb->offset;
+		ext.end = nb[ioo->ioo_bufcnt - 1].offset +
+			  nb[ioo->ioo_bufcnt - 1].len - 1;
+		RETURN(ldlm_extent_overlap(&lock->l_policy_data.l_extent,
+					   &ext));
+	}
+	RETURN(0);
 }
 
 /**
@@ -1910,6 +2084,7 @@ static int ost_rw_hpreq_check(struct ptlrpc_request *req)
         struct niobuf_remote *nb;
         struct ost_prolong_data opd = { 0 };
         int mode, opc;
+        int objcount;
         ENTRY;
 
         /*
@@ -1924,32 +2099,38 @@ static int ost_rw_hpreq_check(struct ptlrpc_request *req)
 
         ioo = req_capsule_client_get(&req->rq_pill, &RMF_OBD_IOOBJ);
         LASSERT(ioo != NULL);
+	objcount = req_capsule_get_size(&req->rq_pill, &RMF_OBD_IOOBJ,
+					RCL_CLIENT) / sizeof(*ioo);
 
         nb = req_capsule_client_get(&req->rq_pill, &RMF_NIOBUF_REMOTE);
         LASSERT(nb != NULL);
         LASSERT(!(nb->flags & OBD_BRW_SRVLOCK));
 
-	ostid_build_res_name(&ioo->ioo_oid, &opd.opd_resid);
-
         opd.opd_req = req;
         mode = LCK_PW;
         if (opc == OST_READ)
                 mode |= LCK_PR;
         opd.opd_mode = mode;
         opd.opd_exp = req->rq_export;
-        opd.opd_oa  = &body->oa;
-        opd.opd_extent.start = nb->offset;
-        nb += ioo->ioo_bufcnt - 1;
-        opd.opd_extent.end = nb->offset + nb->len - 1;
         opd.opd_timeout = prolong_timeout(req);
 
-        DEBUG_REQ(D_RPCTRACE, req,
-               "%s %s: refresh rw locks: " LPU64"/"LPU64" ("LPU64"->"LPU64")\n",
-               obd->obd_name, cfs_current()->comm,
-               opd.opd_resid.name[0], opd.opd_resid.name[1],
-               opd.opd_extent.start, opd.opd_extent.end);
-
-        ost_prolong_locks(&opd);
+	/* the lock handle in the body is that of the first object */
+	opd.opd_oa = &body->oa;
+	for (; objcount > 0; objcount--, nb += ioo->ioo_bufcnt, ioo++) {
+		ostid_build_res_name(&ioo->ioo_oid, &opd.opd_resid);
+		opd.opd_extent.start = nb->offset;
+		opd.opd_extent.end = nb[ioo->ioo_bufcnt - 1].offset +
+				     nb[ioo->ioo_bufcnt - 1].len - 1;
+
+		DEBUG_REQ(D_RPCTRACE, req,
+			  "%s %s: refresh rw locks: "LPU64"/"LPU64" ("LPU64"->"
+			  LPU64")\n", obd->obd_name, cfs_current()->comm,
+			  opd.opd_resid.name[0], opd.opd_resid.name[1],
+			  opd.opd_extent.start, opd.opd_extent.end);
+
+		ost_prolong_locks(&opd);
+		opd.opd_oa = NULL;
+	}
 
         CDEBUG(D_DLMTRACE, "%s: refreshed %u locks timeout for req %p.\n",
                obd->obd_name, opd.opd_locks, req);
@@ -2090,7 +2271,12 @@ static int ost_io_hpreq_handler(struct ptlrpc_request *req)
                                 CERROR("Missing/short ioobj\n");
                                 RETURN(-EFAULT);
                         }
-                        if (objcount > 1) {
+			/* only writes of OBD_CONNECT_MULTIBRW clients may
+			 * carry several objects, see ost_brw_prep_write() */
+			if (objcount > 1 &&
+			    (opc != OST_WRITE || objcount > PTLRPC_MAX_BRW_OBJS ||
+			     !exp_connect_multibrw(req->rq_export) ||
+			     body->oa.o_valid & OBD_MD_FLOSSCAPA)) {
                                 CERROR("too many ioobjs (%d)\n", objcount);
                                 RETURN(-EFAULT);
                         }
@@ -2124,11 +2310,21 @@ static int ost_io_hpreq_handler(struct ptlrpc_request *req)
 
                         nb = req_capsule_client_get(&req->rq_pill,
                                                     &RMF_NIOBUF_REMOTE);
-                        if (nb == NULL) {
+                        if (nb == NULL ||
+			    req_capsule_get_size(&req->rq_pill,
+						 &RMF_NIOBUF_REMOTE,
+						 RCL_CLIENT) <
+			    niocount * sizeof(*nb)) {
                                 CERROR("Missing/short niobuf\n");
                                 RETURN(-EFAULT);
                         }
 
+			if (objcount > 1 && nb[0].flags & OBD_BRW_SRVLOCK) {
+				CERROR("srvlock write of %d ioobjs\n",
+				       objcount);
+				RETURN(-EFAULT);
+			}
+
                         if (niocount == 0 || !(nb[0].flags & OBD_BRW_SRVLOCK))
                                 req->rq_ops = &ost_hpreq_rw;
                 } else if (opc == OST_PUNCH) {
@@ -2253,6 +2449,13 @@ int ost_handle(struct ptlrpc_request *req)
                         GOTO(out, rc = -EROFS);
                 rc = ost_destroy(req->rq_export, req, oti);
                 break;
+	case OST_SYNC_BATCH:
+		CDEBUG(D_INODE, "sync batch\n");
+		req_capsule_set(&req->rq_pill, &RQF_OST_SYNC_BATCH);
+		if (OBD_FAIL_CHECK(OBD_FAIL_OST_EROFS))
+			GOTO(out, rc = -EROFS);
+		rc = ost_sync_batch(req->rq_export, req, oti);
+		break;
         case OST_GETATTR:
                 CDEBUG(D_INODE, "getattr\n");
                 req_capsule_set(&req->rq_pill, &RQF_OST_GETATTR);
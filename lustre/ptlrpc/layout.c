@@ -128,6 +128,11 @@ static const struct req_msg_field *quota_body_only[] = {
 	&RMF_QUOTA_BODY
 };
 
+static const struct req_msg_field *quota_batch_only[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_QUOTA_BATCH
+};
+
 static const struct req_msg_field *ldlm_intent_quota_client[] = {
 	&RMF_PTLRPC_BODY,
 	&RMF_DLM_REQ,
@@ -294,6 +299,20 @@ static const struct req_msg_field *mds_reint_setxattr_client[] = {
         &RMF_EADATA
 };
 
+static const struct req_msg_field *mdt_batch_getattr_client[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_MDT_BODY,
+	&RMF_CAPA1,
+	&RMF_MDT_BATCH_ENT,
+	&RMF_MDT_BATCH_NAMES
+};
+
+static const struct req_msg_field *mdt_batch_getattr_server[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_MDT_BATCH_REP,
+	&RMF_MDT_MD
+};
+
 static const struct req_msg_field *mdt_swap_layouts[] = {
 	&RMF_PTLRPC_BODY,
 	&RMF_MDT_BODY,
@@ -555,6 +574,11 @@ static const struct req_msg_field *ost_destroy_client[] = {
         &RMF_CAPA1
 };
 
+static const struct req_msg_field *ost_sync_batch_client[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_OST_SYNC_REC
+};
+
 
 static const struct req_msg_field *ost_brw_client[] = {
         &RMF_PTLRPC_BODY,
@@ -697,6 +721,9 @@ static struct req_format *req_formats[] = {
 	&RQF_MDS_HSM_ACTION,
 	&RQF_MDS_HSM_REQUEST,
 	&RQF_MDS_SWAP_LAYOUTS,
+	&RQF_MDS_DOM_READ,
+	&RQF_MDS_DOM_WRITE,
+	&RQF_MDS_BATCH_GETATTR,
 	&RQF_UPDATE_OBJ,
 	&RQF_QC_CALLBACK,
         &RQF_OST_CONNECT,
@@ -709,6 +736,7 @@ static struct req_format *req_formats[] = {
         &RQF_OST_PUNCH,
         &RQF_OST_SYNC,
         &RQF_OST_DESTROY,
+	&RQF_OST_SYNC_BATCH,
         &RQF_OST_BRW_READ,
         &RQF_OST_BRW_WRITE,
         &RQF_OST_STATFS,
@@ -736,6 +764,7 @@ static struct req_format *req_formats[] = {
         &RQF_LDLM_INTENT_UNLINK,
 	&RQF_LDLM_INTENT_QUOTA,
 	&RQF_QUOTA_DQACQ,
+	&RQF_QUOTA_DQACQ_BATCH,
         &RQF_LOG_CANCEL,
         &RQF_LLOG_ORIGIN_HANDLE_CREATE,
         &RQF_LLOG_ORIGIN_HANDLE_DESTROY,
@@ -878,6 +907,11 @@ struct req_msg_field RMF_QUOTA_BODY =
 		    sizeof(struct quota_body), lustre_swab_quota_body, NULL);
 EXPORT_SYMBOL(RMF_QUOTA_BODY);
 
+struct req_msg_field RMF_QUOTA_BATCH =
+	DEFINE_MSGF("quota_batch", RMF_F_STRUCT_ARRAY,
+		    sizeof(struct quota_body), lustre_swab_quota_body, NULL);
+EXPORT_SYMBOL(RMF_QUOTA_BATCH);
+
 struct req_msg_field RMF_MDT_EPOCH =
         DEFINE_MSGF("mdt_ioepoch", 0,
                     sizeof(struct mdt_ioepoch), lustre_swab_mdt_ioepoch, NULL);
@@ -1037,6 +1071,12 @@ struct req_msg_field RMF_OST_BODY =
                     sizeof(struct ost_body), lustre_swab_ost_body, dump_ost_body);
 EXPORT_SYMBOL(RMF_OST_BODY);
 
+struct req_msg_field RMF_OST_SYNC_REC =
+	DEFINE_MSGF("ost_sync_rec", RMF_F_STRUCT_ARRAY,
+		    sizeof(struct ost_sync_rec), lustre_swab_ost_sync_rec,
+		    NULL);
+EXPORT_SYMBOL(RMF_OST_SYNC_REC);
+
 struct req_msg_field RMF_OBD_IOOBJ =
         DEFINE_MSGF("obd_ioobj", RMF_F_STRUCT_ARRAY,
                     sizeof(struct obd_ioobj), lustre_swab_obd_ioobj, dump_ioo);
@@ -1107,6 +1147,22 @@ struct req_msg_field RMF_MDS_HSM_USER_ITEM =
 		    NULL);
 EXPORT_SYMBOL(RMF_MDS_HSM_USER_ITEM);
 
+struct req_msg_field RMF_MDT_BATCH_ENT =
+	DEFINE_MSGF("mdt_batch_ent", RMF_F_STRUCT_ARRAY,
+		    sizeof(struct mdt_batch_ent), lustre_swab_mdt_batch_ent,
+		    NULL);
+EXPORT_SYMBOL(RMF_MDT_BATCH_ENT);
+
+struct req_msg_field RMF_MDT_BATCH_NAMES =
+	DEFINE_MSGF("mdt_batch_names", 0, -1, NULL, NULL);
+EXPORT_SYMBOL(RMF_MDT_BATCH_NAMES);
+
+struct req_msg_field RMF_MDT_BATCH_REP =
+	DEFINE_MSGF("mdt_batch_rep", RMF_F_STRUCT_ARRAY,
+		    sizeof(struct mdt_batch_rep), lustre_swab_mdt_batch_rep,
+		    NULL);
+EXPORT_SYMBOL(RMF_MDT_BATCH_REP);
+
 struct req_msg_field RMF_MDS_HSM_ARCHIVE =
 	DEFINE_MSGF("hsm_archive", 0,
 		    sizeof(__u32), lustre_swab_generic_32s, NULL);
@@ -1229,6 +1285,11 @@ struct req_format RQF_QUOTA_DQACQ =
 	DEFINE_REQ_FMT0("QUOTA_DQACQ", quota_body_only, quota_body_only);
 EXPORT_SYMBOL(RQF_QUOTA_DQACQ);
 
+struct req_format RQF_QUOTA_DQACQ_BATCH =
+	DEFINE_REQ_FMT0("QUOTA_DQACQ_BATCH", quota_batch_only,
+			quota_batch_only);
+EXPORT_SYMBOL(RQF_QUOTA_DQACQ_BATCH);
+
 struct req_format RQF_LDLM_INTENT_QUOTA =
 	DEFINE_REQ_FMT0("LDLM_INTENT_QUOTA",
 			ldlm_intent_quota_client,
@@ -1468,6 +1529,19 @@ struct req_format RQF_MDS_SWAP_LAYOUTS =
 			mdt_swap_layouts, empty);
 EXPORT_SYMBOL(RQF_MDS_SWAP_LAYOUTS);
 
+struct req_format RQF_MDS_DOM_READ =
+	DEFINE_REQ_FMT0("MDS_DOM_READ", mdt_body_capa, mdt_body_only);
+EXPORT_SYMBOL(RQF_MDS_DOM_READ);
+
+struct req_format RQF_MDS_DOM_WRITE =
+	DEFINE_REQ_FMT0("MDS_DOM_WRITE", mdt_body_capa, mdt_body_only);
+EXPORT_SYMBOL(RQF_MDS_DOM_WRITE);
+
+struct req_format RQF_MDS_BATCH_GETATTR =
+	DEFINE_REQ_FMT0("MDS_BATCH_GETATTR", mdt_batch_getattr_client,
+			mdt_batch_getattr_server);
+EXPORT_SYMBOL(RQF_MDS_BATCH_GETATTR);
+
 /* This is for split */
 struct req_format RQF_MDS_WRITEPAGE =
         DEFINE_REQ_FMT0("MDS_WRITEPAGE",
@@ -1541,6 +1615,10 @@ struct req_format RQF_OST_DESTROY =
         DEFINE_REQ_FMT0("OST_DESTROY", ost_destroy_client, ost_body_only);
 EXPORT_SYMBOL(RQF_OST_DESTROY);
 
+struct req_format RQF_OST_SYNC_BATCH =
+	DEFINE_REQ_FMT0("OST_SYNC_BATCH", ost_sync_batch_client, empty);
+EXPORT_SYMBOL(RQF_OST_SYNC_BATCH);
+
 struct req_format RQF_OST_BRW_READ =
         DEFINE_REQ_FMT0("OST_BRW_READ", ost_brw_client, ost_brw_read_server);
 EXPORT_SYMBOL(RQF_OST_BRW_READ);
@@ -73,6 +73,7 @@ struct ll_rpc_opcode {
         { OST_QUOTACHECK,   "ost_quotacheck" },
         { OST_QUOTACTL,     "ost_quotactl" },
         { OST_QUOTA_ADJUST_QUNIT, "ost_quota_adjust_qunit" },
+	{ OST_SYNC_BATCH,	"ost_sync_batch" },
         { MDS_GETATTR,      "mds_getattr" },
         { MDS_GETATTR_NAME, "mds_getattr_lock" },
         { MDS_CLOSE,        "mds_close" },
@@ -102,6 +103,9 @@ struct ll_rpc_opcode {
 	{ MDS_HSM_CT_REGISTER, "mds_hsm_ct_register" },
 	{ MDS_HSM_CT_UNREGISTER, "mds_hsm_ct_unregister" },
 	{ MDS_SWAP_LAYOUTS,	"mds_swap_layouts" },
+	{ MDS_DOM_READ,		"mds_dom_read" },
+	{ MDS_DOM_WRITE,	"mds_dom_write" },
+	{ MDS_BATCH_GETATTR,	"mds_batch_getattr" },
         { LDLM_ENQUEUE,     "ldlm_enqueue" },
         { LDLM_CONVERT,     "ldlm_convert" },
         { LDLM_CANCEL,      "ldlm_cancel" },
@@ -131,6 +135,7 @@ struct ll_rpc_opcode {
         { LLOG_ORIGIN_HANDLE_DESTROY,    "llog_origin_handle_destroy" },
         { QUOTA_DQACQ,      "quota_acquire" },
         { QUOTA_DQREL,      "quota_release" },
+	{ QUOTA_DQACQ_BATCH,	"quota_acquire_batch" },
         { SEQ_QUERY,        "seq_query" },
         { SEC_CTX_INIT,     "sec_ctx_init" },
         { SEC_CTX_INIT_CONT,"sec_ctx_init_cont" },
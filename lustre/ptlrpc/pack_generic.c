@@ -1807,6 +1807,16 @@ void lustre_swab_ost_body (struct ost_body *b)
 }
 EXPORT_SYMBOL(lustre_swab_ost_body);
 
+void lustre_swab_ost_sync_rec(struct ost_sync_rec *r)
+{
+	lustre_swab_ost_id(&r->osr_oi);
+	__swab32s(&r->osr_op);
+	__swab32s(&r->osr_count);
+	__swab32s(&r->osr_uid);
+	__swab32s(&r->osr_gid);
+}
+EXPORT_SYMBOL(lustre_swab_ost_sync_rec);
+
 void lustre_swab_ost_last_id(obd_id *id)
 {
         __swab64s(id);
@@ -1907,6 +1917,25 @@ void lustre_swab_mdt_ioepoch (struct mdt_ioepoch *b)
 }
 EXPORT_SYMBOL(lustre_swab_mdt_ioepoch);
 
+void lustre_swab_mdt_batch_ent(struct mdt_batch_ent *e)
+{
+	/* handle is opaque */
+	__swab64s(&e->mbe_bits);
+	__swab32s(&e->mbe_nameoff);
+	__swab32s(&e->mbe_namelen);
+}
+EXPORT_SYMBOL(lustre_swab_mdt_batch_ent);
+
+void lustre_swab_mdt_batch_rep(struct mdt_batch_rep *r)
+{
+	lustre_swab_mdt_body(&r->mbr_body);
+	/* handle is opaque */
+	__swab64s(&r->mbr_bits);
+	__swab32s(&r->mbr_status);
+	CLASSERT(offsetof(typeof(*r), mbr_padding) != 0);
+}
+EXPORT_SYMBOL(lustre_swab_mdt_batch_rep);
+
 void lustre_swab_mgs_target_info(struct mgs_target_info *mti)
 {
         int i;
@@ -2294,6 +2323,7 @@ void lustre_swab_quota_body(struct quota_body *b)
 	lustre_swab_lu_fid(&b->qb_fid);
 	lustre_swab_lu_fid((struct lu_fid *)&b->qb_id);
 	__swab32s(&b->qb_flags);
+	__swab32s(&b->qb_rc);
 	__swab64s(&b->qb_count);
 	__swab64s(&b->qb_usage);
 	__swab64s(&b->qb_slv_ver);
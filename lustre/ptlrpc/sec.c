@@ -822,10 +822,12 @@ void sptlrpc_req_set_flavor(struct ptlrpc_request *req, int opcode)
         case MDS_READPAGE:
         case MGS_CONFIG_READ:
 	case OBD_IDX_READ:
+	case MDS_DOM_READ:
                 req->rq_bulk_read = 1;
                 break;
         case OST_WRITE:
         case MDS_WRITEPAGE:
+	case MDS_DOM_WRITE:
                 req->rq_bulk_write = 1;
                 break;
         case SEC_CTX_INIT:
@@ -1788,11 +1788,13 @@ ptlrpc_server_handle_req_in(struct ptlrpc_service_part *svcpt)
         switch(lustre_msg_get_opc(req->rq_reqmsg)) {
         case MDS_WRITEPAGE:
         case OST_WRITE:
+	case MDS_DOM_WRITE:
                 req->rq_bulk_write = 1;
                 break;
         case MDS_READPAGE:
         case OST_READ:
         case MGS_CONFIG_READ:
+	case MDS_DOM_READ:
                 req->rq_bulk_read = 1;
                 break;
         }
@@ -108,7 +108,9 @@ void lustre_assert_wire_constants(void)
 		 (long long)OST_QUOTACTL);
 	LASSERTF(OST_QUOTA_ADJUST_QUNIT == 20, "found %lld\n",
 		 (long long)OST_QUOTA_ADJUST_QUNIT);
-	LASSERTF(OST_LAST_OPC == 21, "found %lld\n",
+	LASSERTF(OST_SYNC_BATCH == 21, "found %lld\n",
+		 (long long)OST_SYNC_BATCH);
+	LASSERTF(OST_LAST_OPC == 22, "found %lld\n",
 		 (long long)OST_LAST_OPC);
 	LASSERTF(OBD_OBJECT_EOF == 0xffffffffffffffffULL, "found 0x%.16llxULL\n",
 		 OBD_OBJECT_EOF);
@@ -180,7 +182,13 @@ void lustre_assert_wire_constants(void)
 		 (long long)MDS_HSM_CT_UNREGISTER);
 	LASSERTF(MDS_SWAP_LAYOUTS == 61, "found %lld\n",
 		 (long long)MDS_SWAP_LAYOUTS);
-	LASSERTF(MDS_LAST_OPC == 62, "found %lld\n",
+	LASSERTF(MDS_DOM_READ == 62, "found %lld\n",
+		 (long long)MDS_DOM_READ);
+	LASSERTF(MDS_DOM_WRITE == 63, "found %lld\n",
+		 (long long)MDS_DOM_WRITE);
+	LASSERTF(MDS_BATCH_GETATTR == 64, "found %lld\n",
+		 (long long)MDS_BATCH_GETATTR);
+	LASSERTF(MDS_LAST_OPC == 65, "found %lld\n",
 		 (long long)MDS_LAST_OPC);
 	LASSERTF(REINT_SETATTR == 1, "found %lld\n",
 		 (long long)REINT_SETATTR);
@@ -362,7 +370,9 @@ void lustre_assert_wire_constants(void)
 		 (long long)QUOTA_DQACQ);
 	LASSERTF(QUOTA_DQREL == 602, "found %lld\n",
 		 (long long)QUOTA_DQREL);
-	LASSERTF(QUOTA_LAST_OPC == 603, "found %lld\n",
+	LASSERTF(QUOTA_DQACQ_BATCH == 603, "found %lld\n",
+		 (long long)QUOTA_DQACQ_BATCH);
+	LASSERTF(QUOTA_LAST_OPC == 604, "found %lld\n",
 		 (long long)QUOTA_LAST_OPC);
 	LASSERTF(MGS_CONNECT == 250, "found %lld\n",
 		 (long long)MGS_CONNECT);
@@ -490,6 +500,28 @@ void lustre_assert_wire_constants(void)
 	LASSERTF((int)sizeof(((struct som_attrs *)0)->som_mountid) == 8, "found %lld\n",
 		 (long long)(int)sizeof(((struct som_attrs *)0)->som_mountid));
 
+	/* Checks for struct lsom_attrs */
+	LASSERTF((int)sizeof(struct lsom_attrs) == 24, "found %lld\n",
+		 (long long)(int)sizeof(struct lsom_attrs));
+	LASSERTF((int)offsetof(struct lsom_attrs, lsa_flags) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct lsom_attrs, lsa_flags));
+	LASSERTF((int)sizeof(((struct lsom_attrs *)0)->lsa_flags) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lsom_attrs *)0)->lsa_flags));
+	LASSERTF((int)offsetof(struct lsom_attrs, lsa_padding) == 4, "found %lld\n",
+		 (long long)(int)offsetof(struct lsom_attrs, lsa_padding));
+	LASSERTF((int)sizeof(((struct lsom_attrs *)0)->lsa_padding) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lsom_attrs *)0)->lsa_padding));
+	LASSERTF((int)offsetof(struct lsom_attrs, lsa_size) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct lsom_attrs, lsa_size));
+	LASSERTF((int)sizeof(((struct lsom_attrs *)0)->lsa_size) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct lsom_attrs *)0)->lsa_size));
+	LASSERTF((int)offsetof(struct lsom_attrs, lsa_blocks) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct lsom_attrs, lsa_blocks));
+	LASSERTF((int)sizeof(((struct lsom_attrs *)0)->lsa_blocks) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct lsom_attrs *)0)->lsa_blocks));
+	LASSERTF(LSOM_FL_VALID == 0x00000001UL, "found 0x%.8xUL\n",
+		(unsigned)LSOM_FL_VALID);
+
 	/* Checks for struct hsm_attrs */
 	LASSERTF((int)sizeof(struct hsm_attrs) == 24, "found %lld\n",
 		 (long long)(int)sizeof(struct hsm_attrs));
@@ -1154,6 +1186,20 @@ void lustre_assert_wire_constants(void)
 		 OBD_CONNECT_SHORTIO);
 	LASSERTF(OBD_CONNECT_PINGLESS == 0x4000000000000ULL, "found 0x%.16llxULL\n",
 		 OBD_CONNECT_PINGLESS);
+	LASSERTF(OBD_CONNECT_MULTIBRW == 0x8000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT_MULTIBRW);
+	LASSERTF(OBD_CONNECT_DOM == 0x10000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT_DOM);
+	LASSERTF(OBD_CONNECT_BATCH_GETATTR == 0x20000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT_BATCH_GETATTR);
+	LASSERTF(OBD_CONNECT_LAZY_SIZE == 0x40000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT_LAZY_SIZE);
+	LASSERTF(OBD_CONNECT_SYNC_BATCH == 0x80000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT_SYNC_BATCH);
+	LASSERTF(OBD_CONNECT_STRIPED_DIR == 0x100000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT_STRIPED_DIR);
+	LASSERTF(OBD_CONNECT_QUOTA_BATCH == 0x200000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT_QUOTA_BATCH);
 	LASSERTF(OBD_CKSUM_CRC32 == 0x00000001UL, "found 0x%.8xUL\n",
 		(unsigned)OBD_CKSUM_CRC32);
 	LASSERTF(OBD_CKSUM_ADLER == 0x00000002UL, "found 0x%.8xUL\n",
@@ -1370,6 +1416,10 @@ void lustre_assert_wire_constants(void)
 		 OBD_MD_FLRMTRGETFACL);
 	LASSERTF(OBD_MD_FLDATAVERSION == (0x0010000000000000ULL), "found 0x%.16llxULL\n",
 		 OBD_MD_FLDATAVERSION);
+	LASSERTF(OBD_MD_FLLAZYSIZE == (0x0020000000000000ULL), "found 0x%.16llxULL\n",
+		 OBD_MD_FLLAZYSIZE);
+	LASSERTF(OBD_MD_FLLAZYBLOCKS == (0x0040000000000000ULL), "found 0x%.16llxULL\n",
+		 OBD_MD_FLLAZYBLOCKS);
 	CLASSERT(OBD_FL_INLINEDATA == 0x00000001);
 	CLASSERT(OBD_FL_OBDMDEXISTS == 0x00000002);
 	CLASSERT(OBD_FL_DELORPHAN == 0x00000004);
@@ -1482,6 +1532,8 @@ void lustre_assert_wire_constants(void)
 		(unsigned)LOV_PATTERN_RAID0);
 	LASSERTF(LOV_PATTERN_RAID1 == 0x00000002UL, "found 0x%.8xUL\n",
 		(unsigned)LOV_PATTERN_RAID1);
+	LASSERTF(LOV_PATTERN_MDT == 0x00000004UL, "found 0x%.8xUL\n",
+		(unsigned)LOV_PATTERN_MDT);
 	LASSERTF(LOV_PATTERN_FIRST == 0x00000100UL, "found 0x%.8xUL\n",
 		(unsigned)LOV_PATTERN_FIRST);
 	LASSERTF(LOV_PATTERN_CMOBD == 0x00000200UL, "found 0x%.8xUL\n",
@@ -1868,6 +1920,30 @@ void lustre_assert_wire_constants(void)
 	LASSERTF((int)sizeof(((struct ost_body *)0)->oa) == 208, "found %lld\n",
 		 (long long)(int)sizeof(((struct ost_body *)0)->oa));
 
+	/* Checks for struct ost_sync_rec */
+	LASSERTF((int)sizeof(struct ost_sync_rec) == 32, "found %lld\n",
+		 (long long)(int)sizeof(struct ost_sync_rec));
+	LASSERTF((int)offsetof(struct ost_sync_rec, osr_oi) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_sync_rec, osr_oi));
+	LASSERTF((int)sizeof(((struct ost_sync_rec *)0)->osr_oi) == 16, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_sync_rec *)0)->osr_oi));
+	LASSERTF((int)offsetof(struct ost_sync_rec, osr_op) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_sync_rec, osr_op));
+	LASSERTF((int)sizeof(((struct ost_sync_rec *)0)->osr_op) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_sync_rec *)0)->osr_op));
+	LASSERTF((int)offsetof(struct ost_sync_rec, osr_count) == 20, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_sync_rec, osr_count));
+	LASSERTF((int)sizeof(((struct ost_sync_rec *)0)->osr_count) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_sync_rec *)0)->osr_count));
+	LASSERTF((int)offsetof(struct ost_sync_rec, osr_uid) == 24, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_sync_rec, osr_uid));
+	LASSERTF((int)sizeof(((struct ost_sync_rec *)0)->osr_uid) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_sync_rec *)0)->osr_uid));
+	LASSERTF((int)offsetof(struct ost_sync_rec, osr_gid) == 28, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_sync_rec, osr_gid));
+	LASSERTF((int)sizeof(((struct ost_sync_rec *)0)->osr_gid) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_sync_rec *)0)->osr_gid));
+
 	/* Checks for struct ll_fid */
 	LASSERTF((int)sizeof(struct ll_fid) == 16, "found %lld\n",
 		 (long long)(int)sizeof(struct ll_fid));
@@ -2083,6 +2159,8 @@ void lustre_assert_wire_constants(void)
 		MDS_INODELOCK_OPEN);
 	LASSERTF(MDS_INODELOCK_LAYOUT == 0x000008, "found 0x%.8x\n",
 		MDS_INODELOCK_LAYOUT);
+	LASSERTF(MDS_INODELOCK_DOM == 0x000020, "found 0x%.8x\n",
+		MDS_INODELOCK_DOM);
 
 	/* Checks for struct mdt_ioepoch */
 	LASSERTF((int)sizeof(struct mdt_ioepoch) == 24, "found %lld\n",
@@ -2104,6 +2182,50 @@ void lustre_assert_wire_constants(void)
 	LASSERTF((int)sizeof(((struct mdt_ioepoch *)0)->padding) == 4, "found %lld\n",
 		 (long long)(int)sizeof(((struct mdt_ioepoch *)0)->padding));
 
+	/* Checks for struct mdt_batch_ent */
+	LASSERTF((int)sizeof(struct mdt_batch_ent) == 24, "found %lld\n",
+		 (long long)(int)sizeof(struct mdt_batch_ent));
+	LASSERTF((int)offsetof(struct mdt_batch_ent, mbe_handle) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_ent, mbe_handle));
+	LASSERTF((int)sizeof(((struct mdt_batch_ent *)0)->mbe_handle) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_ent *)0)->mbe_handle));
+	LASSERTF((int)offsetof(struct mdt_batch_ent, mbe_bits) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_ent, mbe_bits));
+	LASSERTF((int)sizeof(((struct mdt_batch_ent *)0)->mbe_bits) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_ent *)0)->mbe_bits));
+	LASSERTF((int)offsetof(struct mdt_batch_ent, mbe_nameoff) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_ent, mbe_nameoff));
+	LASSERTF((int)sizeof(((struct mdt_batch_ent *)0)->mbe_nameoff) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_ent *)0)->mbe_nameoff));
+	LASSERTF((int)offsetof(struct mdt_batch_ent, mbe_namelen) == 20, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_ent, mbe_namelen));
+	LASSERTF((int)sizeof(((struct mdt_batch_ent *)0)->mbe_namelen) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_ent *)0)->mbe_namelen));
+
+	/* Checks for struct mdt_batch_rep */
+	LASSERTF((int)sizeof(struct mdt_batch_rep) == 240, "found %lld\n",
+		 (long long)(int)sizeof(struct mdt_batch_rep));
+	LASSERTF((int)offsetof(struct mdt_batch_rep, mbr_body) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_rep, mbr_body));
+	LASSERTF((int)sizeof(((struct mdt_batch_rep *)0)->mbr_body) == 216, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_rep *)0)->mbr_body));
+	LASSERTF((int)offsetof(struct mdt_batch_rep, mbr_handle) == 216, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_rep, mbr_handle));
+	LASSERTF((int)sizeof(((struct mdt_batch_rep *)0)->mbr_handle) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_rep *)0)->mbr_handle));
+	LASSERTF((int)offsetof(struct mdt_batch_rep, mbr_bits) == 224, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_rep, mbr_bits));
+	LASSERTF((int)sizeof(((struct mdt_batch_rep *)0)->mbr_bits) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_rep *)0)->mbr_bits));
+	LASSERTF((int)offsetof(struct mdt_batch_rep, mbr_status) == 232, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_rep, mbr_status));
+	LASSERTF((int)sizeof(((struct mdt_batch_rep *)0)->mbr_status) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_rep *)0)->mbr_status));
+	LASSERTF((int)offsetof(struct mdt_batch_rep, mbr_padding) == 236, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_rep, mbr_padding));
+	LASSERTF((int)sizeof(((struct mdt_batch_rep *)0)->mbr_padding) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_rep *)0)->mbr_padding));
+
 	/* Checks for struct mdt_remote_perm */
 	LASSERTF((int)sizeof(struct mdt_remote_perm) == 32, "found %lld\n",
 		 (long long)(int)sizeof(struct mdt_remote_perm));
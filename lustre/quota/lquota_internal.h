@@ -91,6 +91,19 @@ struct lquota_mst_entry {
 	__u64			lme_may_rel;
 };
 
+/* Per-CPU partition reservation of quota space carved out of the space
+ * granted to a quota slave, see qsd_bucket_consume() */
+struct lquota_slv_bucket {
+	spinlock_t		lsb_lock;
+
+	/* reserved space not handed out yet, in inodes or kbytes */
+	__u64			lsb_avail;
+
+	/* reserved space used by completed operations and still accounted
+	 * in lse_pending_write, in inodes or kbytes */
+	__u64			lsb_done;
+};
+
 /* Per-ID information specific to the quota slave */
 struct lquota_slv_entry {
 	/* [ib]tune size, inodes or kbytes */
@@ -129,6 +142,15 @@ struct lquota_slv_entry {
 
 	/* when latest acquire RPC completed */
 	__u64			lse_acq_time;
+
+	/* start of the current consumption rate window */
+	__u64			lse_rate_start;
+
+	/* quota space handed out in the current rate window */
+	__u64			lse_rate_space;
+
+	/* operations served through lse_lock in the current rate window */
+	unsigned int		lse_rate_ops;
 };
 
 /* In-memory entry for each enforced quota id
@@ -159,6 +181,9 @@ struct lquota_entry {
 		struct	lquota_slv_entry se; /* params specific to QSD */
 	} u;
 
+	/* per-CPU partition reservations of a busy ID, only used on slave */
+	struct lquota_slv_bucket **lqe_buckets;
+
 	/* flags describing the state of the lquota_entry */
 	unsigned long	lqe_enforced:1,/* quota enforced or not */
 			lqe_uptodate:1,/* successfully read from disk */
@@ -208,6 +233,9 @@ struct lquota_site {
 #define lqe_lockh		u.se.lse_lockh
 #define lqe_acq_rc		u.se.lse_acq_rc
 #define lqe_acq_time		u.se.lse_acq_time
+#define lqe_rate_start		u.se.lse_rate_start
+#define lqe_rate_space		u.se.lse_rate_space
+#define lqe_rate_ops		u.se.lse_rate_ops
 
 #define LQUOTA_BUMP_VER 0x1
 #define LQUOTA_SET_VER  0x2
@@ -223,8 +251,11 @@ static inline void lqe_putref(struct lquota_entry *lqe)
 {
 	LASSERT(lqe != NULL);
 	LASSERT(atomic_read(&lqe->lqe_ref) > 0);
-	if (atomic_dec_and_test(&lqe->lqe_ref))
+	if (atomic_dec_and_test(&lqe->lqe_ref)) {
+		if (lqe->lqe_buckets != NULL)
+			cfs_percpt_free(lqe->lqe_buckets);
 		OBD_FREE_PTR(lqe);
+	}
 }
 
 static inline int lqe_is_master(struct lquota_entry *lqe)
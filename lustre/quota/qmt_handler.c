@@ -582,17 +582,18 @@ out:
 }
 
 /*
- * Handle quota request from slave.
+ * Check and process one quota request from slave.
  *
- * \param env  - is the environment passed by the caller
- * \param ld   - is the lu device associated with the qmt
- * \param req  - is the quota acquire request
+ * \param env     - is the environment passed by the caller
+ * \param qmt     - is the quota master device
+ * \param req     - is the request carrying \a qbody
+ * \param qbody   - is the quota body to process
+ * \param repbody - is the quota body to fill in the reply
  */
-static int qmt_dqacq(const struct lu_env *env, struct lu_device *ld,
-		     struct ptlrpc_request *req)
+static int qmt_dqacq_one(const struct lu_env *env, struct qmt_device *qmt,
+			 struct ptlrpc_request *req, struct quota_body *qbody,
+			 struct quota_body *repbody)
 {
-	struct qmt_device	*qmt = lu2qmt_dev(ld);
-	struct quota_body	*qbody, *repbody;
 	struct obd_uuid		*uuid;
 	struct ldlm_lock	*lock;
 	struct lquota_entry	*lqe;
@@ -600,14 +601,6 @@ static int qmt_dqacq(const struct lu_env *env, struct lu_device *ld,
 	int			 rc;
 	ENTRY;
 
-	qbody = req_capsule_client_get(&req->rq_pill, &RMF_QUOTA_BODY);
-	if (qbody == NULL)
-		RETURN(err_serious(-EPROTO));
-
-	repbody = req_capsule_server_get(&req->rq_pill, &RMF_QUOTA_BODY);
-	if (repbody == NULL)
-		RETURN(err_serious(-EFAULT));
-
 	/* verify if global lock is stale */
 	if (!lustre_handle_is_used(&qbody->qb_glb_lockh))
 		RETURN(-ENOLCK);
@@ -686,12 +679,80 @@ static int qmt_dqacq(const struct lu_env *env, struct lu_device *ld,
 	RETURN(rc);
 }
 
+/*
+ * Handle quota request from slave.
+ *
+ * \param env  - is the environment passed by the caller
+ * \param ld   - is the lu device associated with the qmt
+ * \param req  - is the quota acquire request
+ */
+static int qmt_dqacq(const struct lu_env *env, struct lu_device *ld,
+		     struct ptlrpc_request *req)
+{
+	struct quota_body	*qbody, *repbody;
+	ENTRY;
+
+	qbody = req_capsule_client_get(&req->rq_pill, &RMF_QUOTA_BODY);
+	if (qbody == NULL)
+		RETURN(err_serious(-EPROTO));
+
+	repbody = req_capsule_server_get(&req->rq_pill, &RMF_QUOTA_BODY);
+	if (repbody == NULL)
+		RETURN(err_serious(-EFAULT));
+
+	RETURN(qmt_dqacq_one(env, lu2qmt_dev(ld), req, qbody, repbody));
+}
+
+/*
+ * Handle a batch of quota requests from slave. Each quota body is processed
+ * as a QUOTA_DQACQ would be, its status is returned in repbody::qb_rc.
+ *
+ * \param env  - is the environment passed by the caller
+ * \param ld   - is the lu device associated with the qmt
+ * \param req  - is the QUOTA_DQACQ_BATCH request
+ */
+static int qmt_dqacq_batch(const struct lu_env *env, struct lu_device *ld,
+			   struct ptlrpc_request *req)
+{
+	struct qmt_device	*qmt = lu2qmt_dev(ld);
+	struct req_capsule	*pill = &req->rq_pill;
+	struct quota_body	*qbody, *repbody;
+	int			 count, i, rc;
+	ENTRY;
+
+	count = req_capsule_get_size(pill, &RMF_QUOTA_BATCH, RCL_CLIENT) /
+		sizeof(*qbody);
+	qbody = req_capsule_client_get(pill, &RMF_QUOTA_BATCH);
+	if (qbody == NULL || count == 0 || count > QUOTA_DQACQ_BATCH_MAX)
+		RETURN(err_serious(-EPROTO));
+
+	req_capsule_set_size(pill, &RMF_QUOTA_BATCH, RCL_SERVER,
+			     count * sizeof(*repbody));
+	rc = req_capsule_server_pack(pill);
+	if (rc)
+		RETURN(err_serious(rc));
+
+	repbody = req_capsule_server_get(pill, &RMF_QUOTA_BATCH);
+	memset(repbody, 0, count * sizeof(*repbody));
+
+	for (i = 0; i < count; i++) {
+		rc = qmt_dqacq_one(env, qmt, req, &qbody[i], &repbody[i]);
+		if (rc)
+			CDEBUG(D_QUOTA, "%s: dqacq of id "LPU64" in batch "
+			       "failed: rc = %d\n", qmt->qmt_svname,
+			       qbody[i].qb_id.qid_uid, rc);
+		repbody[i].qb_rc = rc;
+	}
+	RETURN(0);
+}
+
 /* Vector of quota request handlers. This vector is used by the MDT to forward
  * requests to the quota master. */
 struct qmt_handlers qmt_hdls = {
 	/* quota request handlers */
 	.qmth_quotactl		= qmt_quotactl,
 	.qmth_dqacq		= qmt_dqacq,
+	.qmth_dqacq_batch	= qmt_dqacq_batch,
 
 	/* ldlm handlers */
 	.qmth_intent_policy	= qmt_intent_policy,
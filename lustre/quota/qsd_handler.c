@@ -434,6 +434,199 @@ out_noadjust:
 	EXIT;
 }
 
+/*
+ * Per-CPU partition reservations
+ *
+ * Once an ID is busy enough (qsd_bucket_ops operations per second), each CPU
+ * partition keeps a bucket of quota space carved out of the space granted to
+ * this slave. Operations are then charged to the local bucket without taking
+ * lqe_lock nor refreshing disk usage. Reserved space is accounted in
+ * lqe_pending_write so that it is neither released to the master nor handed
+ * out twice. Space used by completed operations stays in lqe_pending_write
+ * until the next qsd_bucket_reconcile(), which only overestimates usage in
+ * the meantime.
+ */
+
+/**
+ * Give back to the lquota entry the bucket space used by completed
+ * operations and, if \a drain is set, the space still available in buckets.
+ * The caller must hold the lqe write lock.
+ */
+void qsd_bucket_reconcile(struct lquota_entry *lqe, bool drain)
+{
+	struct lquota_slv_bucket	*bkt;
+	__u64				 rel = 0;
+	int				 i;
+
+	if (lqe->lqe_buckets == NULL)
+		return;
+
+	cfs_percpt_for_each(bkt, i, lqe->lqe_buckets) {
+		spin_lock(&bkt->lsb_lock);
+		rel += bkt->lsb_done;
+		bkt->lsb_done = 0;
+		if (drain) {
+			rel += bkt->lsb_avail;
+			bkt->lsb_avail = 0;
+		}
+		spin_unlock(&bkt->lsb_lock);
+	}
+
+	if (unlikely(lqe->lqe_pending_write < rel)) {
+		LQUOTA_ERROR(lqe, "reconciling "LPU64" bucket space with "
+			     "pending_write "LPU64, rel, lqe->lqe_pending_write);
+		rel = lqe->lqe_pending_write;
+	}
+	lqe->lqe_pending_write -= rel;
+}
+
+/**
+ * Try to charge \a space to the bucket of the current CPU partition.
+ *
+ * \retval true  - \a space is now granted to the operation
+ * \retval false - no bucket or not enough space in it
+ */
+static bool qsd_bucket_consume(struct lquota_entry *lqe, __u64 space)
+{
+	struct lquota_slv_bucket	*bkt;
+	bool				 rc = false;
+
+	if (lqe->lqe_buckets == NULL)
+		return false;
+
+	bkt = cfs_percpt_current(lqe->lqe_buckets);
+	spin_lock(&bkt->lsb_lock);
+	if (bkt->lsb_avail >= space) {
+		bkt->lsb_avail -= space;
+		rc = true;
+	}
+	spin_unlock(&bkt->lsb_lock);
+	return rc;
+}
+
+/**
+ * Record completion of an operation which consumed \a space from a bucket.
+ */
+static void qsd_bucket_done(struct lquota_entry *lqe, __u64 space)
+{
+	struct lquota_slv_bucket *bkt = cfs_percpt_current(lqe->lqe_buckets);
+
+	spin_lock(&bkt->lsb_lock);
+	bkt->lsb_done += space;
+	spin_unlock(&bkt->lsb_lock);
+}
+
+/**
+ * Refill the bucket of the current CPU partition from the spare quota space
+ * owned by this slave. Each bucket holds up to qtune divided by the number of
+ * CPU partitions, so that pre-acquire keeps buckets and writers waiting for
+ * space fed. The caller must hold the lqe write lock.
+ */
+static void qsd_bucket_refill(struct lquota_entry *lqe)
+{
+	struct lquota_slv_bucket	*bkt;
+	__u64				 usage, target, fill = 0;
+
+	if (lqe->lqe_buckets == NULL || lqe->lqe_edquot)
+		return;
+
+	usage  = lqe->lqe_usage;
+	usage += lqe->lqe_pending_write + lqe->lqe_waiting_write;
+	if (usage + lqe->lqe_pending_rel >= lqe->lqe_granted)
+		return;
+
+	target = lqe->lqe_qtune / cfs_percpt_number(lqe->lqe_buckets);
+
+	bkt = cfs_percpt_current(lqe->lqe_buckets);
+	spin_lock(&bkt->lsb_lock);
+	if (bkt->lsb_avail < target) {
+		fill = min(target - bkt->lsb_avail,
+			   lqe->lqe_granted - lqe->lqe_pending_rel - usage);
+		bkt->lsb_avail += fill;
+	}
+	spin_unlock(&bkt->lsb_lock);
+
+	lqe->lqe_pending_write += fill;
+	lqe->lqe_rate_space += fill;
+}
+
+/**
+ * Set up per-CPU partition reservations for \a lqe once it is busy enough.
+ */
+static void qsd_bucket_setup(struct lquota_entry *lqe)
+{
+	struct qsd_instance		 *qsd = lqe2qqi(lqe)->qqi_qsd;
+	struct lquota_slv_bucket	**buckets;
+	struct lquota_slv_bucket	 *bkt;
+	int				  i;
+
+	if (lqe->lqe_buckets != NULL || qsd->qsd_bucket_ops == 0 ||
+	    lqe->lqe_rate_ops < qsd->qsd_bucket_ops)
+		return;
+
+	buckets = cfs_percpt_alloc(cfs_cpt_table, sizeof(*bkt));
+	if (buckets == NULL)
+		return;
+
+	cfs_percpt_for_each(bkt, i, buckets) {
+		spin_lock_init(&bkt->lsb_lock);
+		bkt->lsb_avail = 0;
+		bkt->lsb_done  = 0;
+	}
+	/* buckets are looked up without lqe_lock */
+	smp_wmb();
+
+	lqe_write_lock(lqe);
+	if (lqe->lqe_buckets == NULL) {
+		lqe->lqe_buckets = buckets;
+		buckets = NULL;
+		LQUOTA_DEBUG(lqe, "per-CPU reservations set up");
+	}
+	lqe_write_unlock(lqe);
+
+	if (buckets != NULL)
+		cfs_percpt_free(buckets);
+}
+
+/**
+ * Account \a space handed out through lqe_lock and adapt qtune to the rate
+ * at which the ID consumes quota space: pre-acquire should keep about one
+ * second worth of consumption ahead, up to half a qunit. The caller must hold
+ * the lqe write lock.
+ */
+static void qsd_rate_update(struct lquota_entry *lqe, __u64 space)
+{
+	__u64	now = cfs_time_current_64();
+	__u64	rate, qtune;
+	__u32	elapsed;
+
+	if (cfs_time_before_64(now, lqe->lqe_rate_start + CFS_HZ)) {
+		lqe->lqe_rate_ops++;
+		lqe->lqe_rate_space += space;
+		return;
+	}
+
+	/* close the current window */
+	if (lqe->lqe_rate_start != 0) {
+		elapsed = (now - lqe->lqe_rate_start) / CFS_HZ;
+		rate = lqe->lqe_rate_space;
+		do_div(rate, elapsed);
+
+		qtune = qsd_qtune(lqe->lqe_qunit);
+		if (rate > qtune)
+			qtune = max(qtune, min(rate, lqe->lqe_qunit >> 1));
+		if (qtune != lqe->lqe_qtune) {
+			LQUOTA_DEBUG(lqe, "rate "LPU64"/s, qtune "LPU64" -> "
+				     LPU64, rate, lqe->lqe_qtune, qtune);
+			lqe->lqe_qtune = qtune;
+		}
+	}
+
+	lqe->lqe_rate_start = now;
+	lqe->lqe_rate_ops   = 1;
+	lqe->lqe_rate_space = space;
+}
+
 /**
  * Try to consume local quota space.
  *
@@ -455,15 +648,27 @@ static int qsd_acquire_local(struct lquota_entry *lqe, __u64 space)
 		RETURN(-ESRCH);
 
 	lqe_write_lock(lqe);
+	/* fold operations completed against buckets, usage is up-to-date */
+	qsd_bucket_reconcile(lqe, false);
 	/* use latest usage */
 	usage = lqe->lqe_usage;
 	/* take pending write into account */
 	usage += lqe->lqe_pending_write;
 
+	if (space + usage > lqe->lqe_granted - lqe->lqe_pending_rel &&
+	    lqe->lqe_buckets != NULL) {
+		/* take back space sitting in other buckets before asking the
+		 * master for more */
+		qsd_bucket_reconcile(lqe, true);
+		usage = lqe->lqe_usage + lqe->lqe_pending_write;
+	}
+
 	if (space + usage <= lqe->lqe_granted - lqe->lqe_pending_rel) {
 		/* Yay! we got enough space */
 		lqe->lqe_pending_write += space;
 		lqe->lqe_waiting_write -= space;
+		qsd_rate_update(lqe, space);
+		qsd_bucket_refill(lqe);
 		rc = 0;
 	} else if (lqe->lqe_edquot) {
 		rc = -EDQUOT;
@@ -723,6 +928,15 @@ static int qsd_op_begin0(const struct lu_env *env, struct qsd_qtype_info *qqi,
 		RETURN(0);
 	}
 
+	/* fast path, charge the bucket of the local CPU partition */
+	if (qsd_bucket_consume(lqe, space)) {
+		qid->lqi_space     += space;
+		qid->lqi_rsv_space += space;
+		if (flags != NULL)
+			GOTO(out_flags, rc = 0);
+		RETURN(0);
+	}
+
 	LQUOTA_DEBUG(lqe, "op_begin space:"LPD64, space);
 
 	lqe_write_lock(lqe);
@@ -738,6 +952,7 @@ static int qsd_op_begin0(const struct lu_env *env, struct qsd_qtype_info *qqi,
 
 	if (rc == 0 && ret == 0) {
 		qid->lqi_space += space;
+		qsd_bucket_setup(lqe);
 	} else {
 		if (rc == 0)
 			rc = ret;
@@ -895,10 +1110,13 @@ EXPORT_SYMBOL(qsd_op_begin);
  *
  * \param env    - the environment passed by the caller
  * \param lqe    - is the qid entry to be processed
+ * \param batch  - if not NULL, a non-intent request is added to this batch
+ *                 instead of being sent, see qsd_batch_send()
  *
  * \retval 0 on success, appropriate errors on failure
  */
-int qsd_adjust(const struct lu_env *env, struct lquota_entry *lqe)
+int qsd_adjust(const struct lu_env *env, struct lquota_entry *lqe,
+	       struct qsd_dqacq_batch *batch)
 {
 	struct qsd_thread_info	*qti = qsd_info(env);
 	struct quota_body	*qbody = &qti->qti_body;
@@ -923,6 +1141,11 @@ int qsd_adjust(const struct lu_env *env, struct lquota_entry *lqe)
 
 	lqe_write_lock(lqe);
 
+	/* space reserved in buckets must be given back before releasing
+	 * quota space to the master */
+	qsd_bucket_reconcile(lqe, !lqe->lqe_enforced ||
+				  !lustre_handle_is_used(&lqe->lqe_lockh));
+
 	/* fill qb_count & qb_flags */
 	if (!qsd_calc_adjust(lqe, qbody)) {
 		lqe_write_unlock(lqe);
@@ -977,7 +1200,16 @@ int qsd_adjust(const struct lu_env *env, struct lquota_entry *lqe)
 		memset(&qti->qti_lockh, 0, sizeof(qti->qti_lockh));
 	}
 
-	if (!intent) {
+	if (!intent && batch != NULL) {
+		int	i = batch->qdb_count++;
+
+		LASSERT(i < QUOTA_DQACQ_BATCH_MAX);
+		batch->qdb_body[i] = *qbody;
+		lustre_handle_copy(&batch->qdb_lockh[i], &qti->qti_lockh);
+		/* the lqe reference is released on completion */
+		batch->qdb_lqe[i] = lqe;
+		RETURN(0);
+	} else if (!intent) {
 		rc = qsd_send_dqacq(env, qsd->qsd_exp, qbody, false,
 				    qsd_req_completion, qqi, &qti->qti_lockh,
 				    lqe);
@@ -1001,6 +1233,42 @@ out:
 	return rc;
 }
 
+/**
+ * Check whether quota requests of several IDs can be sent to the master in
+ * one QUOTA_DQACQ_BATCH.
+ */
+bool qsd_batch_enabled(struct qsd_instance *qsd)
+{
+	bool	enabled = false;
+
+	if (qsd->qsd_batch_max <= 1)
+		return false;
+
+	read_lock(&qsd->qsd_lock);
+	if (qsd->qsd_exp_valid)
+		enabled = !!(class_exp2cliimp(qsd->qsd_exp)->
+			     imp_connect_data.ocd_connect_flags &
+			     OBD_CONNECT_QUOTA_BATCH);
+	read_unlock(&qsd->qsd_lock);
+	return enabled;
+}
+
+/**
+ * Send the quota requests collected by qsd_adjust() in \a batch to the master.
+ * The batch is freed once all the requests are completed.
+ *
+ * \param env   - the environment passed by the caller
+ * \param qsd   - is the qsd instance the requests belong to
+ * \param batch - is the batch of requests to send
+ */
+int qsd_batch_send(const struct lu_env *env, struct qsd_instance *qsd,
+		   struct qsd_dqacq_batch *batch)
+{
+	LASSERT(batch->qdb_count > 0);
+	return qsd_send_dqacq_batch(env, qsd->qsd_exp, batch,
+				    qsd_req_completion);
+}
+
 /**
  * Post quota operation, pre-acquire/release quota from master.
  *
@@ -1027,6 +1295,18 @@ static void qsd_op_end0(const struct lu_env *env, struct qsd_qtype_info *qqi,
 		RETURN_EXIT;
 	qid->lqi_qentry = NULL;
 
+	if (qid->lqi_rsv_space > 0) {
+		/* space charged to a bucket is given back to the lqe on next
+		 * reconcile, no need to take lqe_lock here */
+		qsd_bucket_done(lqe, qid->lqi_rsv_space);
+		qid->lqi_space -= qid->lqi_rsv_space;
+		qid->lqi_rsv_space = 0;
+		if (qid->lqi_space == 0) {
+			lqe_putref(lqe);
+			RETURN_EXIT;
+		}
+	}
+
 	/* refresh cached usage if a suitable environment is passed */
 	if (env != NULL)
 		qsd_refresh_usage(env, lqe);
@@ -1042,10 +1322,11 @@ static void qsd_op_end0(const struct lu_env *env, struct qsd_qtype_info *qqi,
 
 	if (adjust) {
 		/* pre-acquire/release quota space is needed */
-		if (env != NULL)
-			qsd_adjust(env, lqe);
+		if (env != NULL && !qsd_batch_enabled(qqi->qqi_qsd))
+			qsd_adjust(env, lqe, NULL);
 		else
-			/* no suitable environment, handle adjustment in
+			/* no suitable environment, or the adjustment can be
+			 * batched with other IDs, handle adjustment in
 			 * separate thread context */
 			qsd_adjust_schedule(lqe, false, false);
 	}
@@ -1162,7 +1443,7 @@ void qsd_op_adjust(const struct lu_env *env, struct qsd_instance *qsd,
 	lqe_read_unlock(lqe);
 
 	if (adjust)
-		qsd_adjust(env, lqe);
+		qsd_adjust(env, lqe, NULL);
 
 	lqe_putref(lqe);
 	EXIT;
@@ -107,6 +107,14 @@ struct qsd_instance {
 	 * enforced here (via procfs) */
 	int			 qsd_timeout;
 
+	/* number of quota operations per second on an ID above which the ID
+	 * gets per-CPU partition reservations, 0 disables them */
+	unsigned int		 qsd_bucket_ops;
+
+	/* maximum number of IDs adjusted with one QUOTA_DQACQ_BATCH request,
+	 * 0 or 1 disables batching */
+	unsigned int		 qsd_batch_max;
+
 	unsigned long		 qsd_is_md:1,    /* managing quota for mdt */
 				 qsd_started:1,  /* instance is now started */
 				 qsd_prepared:1, /* qsd_prepare() successfully
@@ -201,6 +209,16 @@ struct qsd_fsinfo {
 	int			qfs_ref;
 };
 
+/* Non-intent quota requests of several IDs collected by the writeback thread
+ * and sent to the master in one QUOTA_DQACQ_BATCH. Each entry holds a
+ * reference on the lqe and has lqe_pending_req set until completion. */
+struct qsd_dqacq_batch {
+	int			 qdb_count;
+	struct quota_body	 qdb_body[QUOTA_DQACQ_BATCH_MAX];
+	struct lustre_handle	 qdb_lockh[QUOTA_DQACQ_BATCH_MAX];
+	struct lquota_entry	*qdb_lqe[QUOTA_DQACQ_BATCH_MAX];
+};
+
 /*
  * Helper functions & prototypes
  */
@@ -288,28 +306,33 @@ static inline int qsd_type_enabled(struct qsd_instance *qsd, int type)
 	return enabled & (1 << type);
 }
 
-/* helper function to set new qunit and compute associated qtune value */
-static inline void qsd_set_qunit(struct lquota_entry *lqe, __u64 qunit)
+/* helper function computing the default qtune value for a given qunit */
+static inline __u64 qsd_qtune(__u64 qunit)
 {
-	if (lqe->lqe_qunit == qunit)
-		return;
-
-	lqe->lqe_qunit = qunit;
-
 	/* With very large qunit support, we can't afford to have a static
 	 * qtune value, e.g. with a 1PB qunit and qtune set to 50%, we would
 	 * start pre-allocation when 512TB of free quota space remains.
 	 * Therefore, we adapt qtune depending on the actual qunit value */
 	if (qunit == 0)				/* if qunit is NULL           */
-		lqe->lqe_qtune = 0;		/*  qtune = 0                 */
+		return 0;			/*  qtune = 0                 */
 	else if (qunit == 1024)			/* if 1MB or 1K inodes        */
-		lqe->lqe_qtune = qunit >> 1;	/*  => 50%                    */
+		return qunit >> 1;		/*  => 50%                    */
 	else if (qunit <= 1024 * 1024)		/* up to 1GB or 1M inodes     */
-		lqe->lqe_qtune = qunit >> 2;	/*  => 25%                    */
+		return qunit >> 2;		/*  => 25%                    */
 	else if (qunit <= 4 * 1024 * 1024)	/* up to 16GB or 16M inodes   */
-		lqe->lqe_qtune = qunit >> 3;	/*  => 12.5%                  */
+		return qunit >> 3;		/*  => 12.5%                  */
 	else					/* above 4GB/4M               */
-		lqe->lqe_qtune = 1024 * 1024;	/*  value capped to 1GB/1M    */
+		return 1024 * 1024;		/*  value capped to 1GB/1M    */
+}
+
+/* helper function to set new qunit and compute associated qtune value */
+static inline void qsd_set_qunit(struct lquota_entry *lqe, __u64 qunit)
+{
+	if (lqe->lqe_qunit == qunit)
+		return;
+
+	lqe->lqe_qunit = qunit;
+	lqe->lqe_qtune = qsd_qtune(qunit);
 
 	LQUOTA_DEBUG(lqe, "changing qunit & qtune");
 
@@ -318,6 +341,8 @@ static inline void qsd_set_qunit(struct lquota_entry *lqe, __u64 qunit)
 }
 
 #define QSD_WB_INTERVAL	60 /* 60 seconds */
+#define QSD_BUCKET_OPS	256 /* default qsd_bucket_ops */
+#define QSD_BATCH_MAX	32  /* default qsd_batch_max */
 
 /* helper function calculating how long a service thread should be waiting for
  * quota space */
@@ -358,6 +383,8 @@ int qsd_send_dqacq(const struct lu_env *, struct obd_export *,
 		   struct quota_body *, bool, qsd_req_completion_t,
 		   struct qsd_qtype_info *, struct lustre_handle *,
 		   struct lquota_entry *);
+int qsd_send_dqacq_batch(const struct lu_env *, struct obd_export *,
+			 struct qsd_dqacq_batch *, qsd_req_completion_t);
 int qsd_intent_lock(const struct lu_env *, struct obd_export *,
 		    struct quota_body *, bool, int, qsd_req_completion_t,
 		    struct qsd_qtype_info *, struct lquota_lvb *, void *);
@@ -374,7 +401,12 @@ void qsd_put_fsinfo(struct qsd_fsinfo *);
 int qsd_process_config(struct lustre_cfg *);
 
 /* qsd_handler.c */
-int qsd_adjust(const struct lu_env *, struct lquota_entry *);
+int qsd_adjust(const struct lu_env *, struct lquota_entry *,
+	       struct qsd_dqacq_batch *);
+bool qsd_batch_enabled(struct qsd_instance *);
+int qsd_batch_send(const struct lu_env *, struct qsd_instance *,
+		   struct qsd_dqacq_batch *);
+void qsd_bucket_reconcile(struct lquota_entry *, bool);
 
 /* qsd_writeback.c */
 void qsd_upd_schedule(struct qsd_qtype_info *, struct lquota_entry *,
@@ -210,11 +210,72 @@ static int lprocfs_qsd_wr_timeout(struct file *file, const char *buffer,
 	return count;
 }
 
+static int lprocfs_qsd_rd_percpu_threshold(char *page, char **start,
+					   off_t off, int count, int *eof,
+					   void *data)
+{
+	struct qsd_instance	*qsd = (struct qsd_instance *)data;
+	LASSERT(qsd != NULL);
+
+	return snprintf(page, count, "%u\n", qsd->qsd_bucket_ops);
+}
+
+static int lprocfs_qsd_wr_percpu_threshold(struct file *file,
+					   const char *buffer,
+					   unsigned long count, void *data)
+{
+	struct qsd_instance	*qsd = (struct qsd_instance *)data;
+	int			 ops, rc;
+	LASSERT(qsd != NULL);
+
+	rc = lprocfs_write_helper(buffer, count, &ops);
+	if (rc)
+		return rc;
+	if (ops < 0)
+		return -EINVAL;
+
+	/* IDs which already have per-CPU reservations keep them */
+	qsd->qsd_bucket_ops = ops;
+	return count;
+}
+
+static int lprocfs_qsd_rd_batch_max(char *page, char **start, off_t off,
+				    int count, int *eof, void *data)
+{
+	struct qsd_instance	*qsd = (struct qsd_instance *)data;
+	LASSERT(qsd != NULL);
+
+	return snprintf(page, count, "%u\n", qsd->qsd_batch_max);
+}
+
+static int lprocfs_qsd_wr_batch_max(struct file *file, const char *buffer,
+				    unsigned long count, void *data)
+{
+	struct qsd_instance	*qsd = (struct qsd_instance *)data;
+	int			 max, rc;
+	LASSERT(qsd != NULL);
+
+	rc = lprocfs_write_helper(buffer, count, &max);
+	if (rc)
+		return rc;
+	if (max < 0 || max > QUOTA_DQACQ_BATCH_MAX) {
+		CERROR("%s: batch_max %d must be in the range [0, %d]\n",
+		       qsd->qsd_svname, max, QUOTA_DQACQ_BATCH_MAX);
+		return -EINVAL;
+	}
+
+	qsd->qsd_batch_max = max;
+	return count;
+}
+
 static struct lprocfs_vars lprocfs_quota_qsd_vars[] = {
 	{ "info", lprocfs_qsd_rd_state, 0, 0},
 	{ "enabled", lprocfs_qsd_rd_enabled, 0, 0},
 	{ "force_reint", 0, lprocfs_qsd_wr_force_reint, 0},
 	{ "timeout", lprocfs_qsd_rd_timeout, lprocfs_qsd_wr_timeout, 0},
+	{ "percpu_threshold", lprocfs_qsd_rd_percpu_threshold,
+			      lprocfs_qsd_wr_percpu_threshold, 0},
+	{ "batch_max", lprocfs_qsd_rd_batch_max, lprocfs_qsd_wr_batch_max, 0},
 	{ NULL }
 };
 
@@ -560,6 +621,8 @@ struct qsd_instance *qsd_init(const struct lu_env *env, char *svname,
 	CFS_INIT_LIST_HEAD(&qsd->qsd_adjust_list);
 	qsd->qsd_prepared = false;
 	qsd->qsd_started = false;
+	qsd->qsd_bucket_ops = QSD_BUCKET_OPS;
+	qsd->qsd_batch_max = QSD_BATCH_MAX;
 
 	/* copy service name */
 	if (strlcpy(qsd->qsd_svname, svname, sizeof(qsd->qsd_svname))
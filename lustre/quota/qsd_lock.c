@@ -344,7 +344,7 @@ static int qsd_id_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *de
 		 * which means there could be a short window that slave is
 		 * holding spare grant wihtout per-ID lock. */
 		if (rel)
-			rc = qsd_adjust(env, lqe);
+			rc = qsd_adjust(env, lqe, NULL);
 
 		/* release lqe reference grabbed by qsd_id_ast_data_get() */
 		lqe_putref(lqe);
@@ -398,6 +398,9 @@ static int qsd_id_glimpse_ast(struct ldlm_lock *lock, void *data)
 		/* extract new qunit from glimpse request */
 		qsd_set_qunit(lqe, desc->gl_qunit);
 
+		/* space reserved in per-CPU buckets can be released too */
+		qsd_bucket_reconcile(lqe, true);
+
 		space  = lqe->lqe_granted - lqe->lqe_pending_rel;
 		space -= lqe->lqe_usage;
 		space -= lqe->lqe_pending_write + lqe->lqe_waiting_write;
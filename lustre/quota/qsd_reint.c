@@ -358,7 +358,7 @@ static int qsd_reconciliation(const struct lu_env *env,
 			GOTO(out, rc);
 		}
 
-		rc = qsd_adjust(env, lqe);
+		rc = qsd_adjust(env, lqe, NULL);
 		lqe_putref(lqe);
 		if (rc) {
 			CWARN("%s: failed to report quota. "DFID", %d\n",
@@ -145,6 +145,119 @@ out:
 	return rc;
 }
 
+/*
+ * QUOTA_DQACQ_BATCH interpret callback, completes each request of the batch.
+ *
+ * \param env    - the environment passed by the caller
+ * \param req    - the QUOTA_DQACQ_BATCH request
+ * \param arg    - qsd_async_args
+ * \param rc     - request status
+ */
+static int qsd_dqacq_batch_interpret(const struct lu_env *env,
+				     struct ptlrpc_request *req, void *arg,
+				     int rc)
+{
+	struct qsd_async_args	*aa = (struct qsd_async_args *)arg;
+	struct qsd_dqacq_batch	*batch = aa->aa_arg;
+	struct quota_body	*rep_qbody = NULL, *repbody;
+	int			 i, ret;
+	ENTRY;
+
+	if (rc == 0) {
+		rep_qbody = req_capsule_server_get(&req->rq_pill,
+						   &RMF_QUOTA_BATCH);
+		if (rep_qbody == NULL ||
+		    req_capsule_get_size(&req->rq_pill, &RMF_QUOTA_BATCH,
+					 RCL_SERVER) <
+		    batch->qdb_count * sizeof(*rep_qbody))
+			rc = -EPROTO;
+	}
+
+	for (i = 0; i < batch->qdb_count; i++) {
+		ret = rc == 0 ? (int)rep_qbody[i].qb_rc : rc;
+		repbody = NULL;
+		if (rc == 0 &&
+		    (ret == 0 || ret == -EDQUOT || ret == -EINPROGRESS))
+			repbody = &rep_qbody[i];
+		aa->aa_completion(env, lqe2qqi(batch->qdb_lqe[i]),
+				  &batch->qdb_body[i], repbody,
+				  &batch->qdb_lockh[i], NULL,
+				  batch->qdb_lqe[i], ret);
+	}
+	OBD_FREE_LARGE(batch, sizeof(*batch));
+	RETURN(rc);
+}
+
+/*
+ * Send the non-intent quota requests of several IDs to master in one
+ * QUOTA_DQACQ_BATCH. \a completion is called for each request of the batch,
+ * which is freed afterwards.
+ *
+ * \param env    - the environment passed by the caller
+ * \param exp    - is the export to use to send the RPC
+ * \param batch  - is the batch of quota bodies to be packed in request
+ * \param completion - completion callback
+ *
+ * \retval 0     - success
+ * \retval -ve   - appropriate errors
+ */
+int qsd_send_dqacq_batch(const struct lu_env *env, struct obd_export *exp,
+			 struct qsd_dqacq_batch *batch,
+			 qsd_req_completion_t completion)
+{
+	struct ptlrpc_request	*req;
+	struct quota_body	*req_qbody;
+	struct qsd_async_args	*aa;
+	int			 size, i, rc;
+	ENTRY;
+
+	LASSERT(exp);
+	LASSERT(batch->qdb_count > 0 &&
+		batch->qdb_count <= QUOTA_DQACQ_BATCH_MAX);
+	size = batch->qdb_count * sizeof(*req_qbody);
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp),
+				   &RQF_QUOTA_DQACQ_BATCH);
+	if (req == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	req->rq_no_resend = req->rq_no_delay = 1;
+	req->rq_no_retry_einprogress = 1;
+	req_capsule_set_size(&req->rq_pill, &RMF_QUOTA_BATCH, RCL_CLIENT, size);
+	rc = ptlrpc_request_pack(req, LUSTRE_MDS_VERSION, QUOTA_DQACQ_BATCH);
+	if (rc) {
+		ptlrpc_request_free(req);
+		GOTO(out, rc);
+	}
+
+	req_qbody = req_capsule_client_get(&req->rq_pill, &RMF_QUOTA_BATCH);
+	memcpy(req_qbody, batch->qdb_body, size);
+
+	req_capsule_set_size(&req->rq_pill, &RMF_QUOTA_BATCH, RCL_SERVER, size);
+	ptlrpc_request_set_replen(req);
+
+	CLASSERT(sizeof(*aa) <= sizeof(req->rq_async_args));
+	aa = ptlrpc_req_async_args(req);
+	memset(aa, 0, sizeof(*aa));
+	aa->aa_exp = exp;
+	aa->aa_arg = (void *)batch;
+	aa->aa_completion = completion;
+
+	CDEBUG(D_QUOTA, "%s: sending %d quota requests in one batch\n",
+	       exp->exp_obd->obd_name, batch->qdb_count);
+
+	req->rq_interpret_reply = qsd_dqacq_batch_interpret;
+	ptlrpcd_add_req(req, PDL_POLICY_LOCAL, -1);
+	RETURN(0);
+out:
+	for (i = 0; i < batch->qdb_count; i++)
+		completion(env, lqe2qqi(batch->qdb_lqe[i]), &batch->qdb_body[i],
+			   NULL, &batch->qdb_lockh[i], NULL, batch->qdb_lqe[i],
+			   rc);
+	OBD_FREE_LARGE(batch, sizeof(*batch));
+	return rc;
+}
+
 /*
  * intent quota request interpret callback.
  *
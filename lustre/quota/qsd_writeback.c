@@ -269,7 +269,30 @@ void qsd_upd_schedule(struct qsd_qtype_info *qqi, struct lquota_entry *lqe,
 	EXIT;
 }
 
-static int qsd_process_upd(const struct lu_env *env, struct qsd_upd_rec *upd)
+/*
+ * Adjust quota space of \a lqe. If \a batch is set, a non-intent request is
+ * added to it and the batch is sent to the master once it is full.
+ */
+static int qsd_adjust_batched(const struct lu_env *env,
+			      struct qsd_instance *qsd,
+			      struct lquota_entry *lqe,
+			      struct qsd_dqacq_batch **batch)
+{
+	int	rc;
+
+	rc = qsd_adjust(env, lqe, *batch);
+	if (*batch != NULL && (*batch)->qdb_count >=
+	    min_t(unsigned int, qsd->qsd_batch_max, QUOTA_DQACQ_BATCH_MAX)) {
+		qsd_batch_send(env, qsd, *batch);
+		/* the next IDs go to a new batch, or are sent one by one if
+		 * it can't be allocated */
+		OBD_ALLOC_LARGE(*batch, sizeof(**batch));
+	}
+	return rc;
+}
+
+static int qsd_process_upd(const struct lu_env *env, struct qsd_upd_rec *upd,
+			   struct qsd_dqacq_batch **batch)
 {
 	struct lquota_entry	*lqe = upd->qur_lqe;
 	struct qsd_qtype_info	*qqi = upd->qur_qqi;
@@ -291,7 +314,7 @@ static int qsd_process_upd(const struct lu_env *env, struct qsd_upd_rec *upd)
 		/* refresh usage */
 		qsd_refresh_usage(env, lqe);
 		/* Report usage asynchronously */
-		rc = qsd_adjust(env, lqe);
+		rc = qsd_adjust_batched(env, qqi->qqi_qsd, lqe, batch);
 		if (rc)
 			LQUOTA_ERROR(lqe, "failed to report usage, rc:%d", rc);
 	}
@@ -409,6 +432,7 @@ static int qsd_upd_thread(void *arg)
 	int			 qtype, rc = 0;
 	bool			 uptodate;
 	struct lquota_entry	*lqe, *tmp;
+	struct qsd_dqacq_batch	*batch = NULL;
 	__u64			 cur_time;
 	ENTRY;
 
@@ -436,9 +460,19 @@ static int qsd_upd_thread(void *arg)
 			     qsd_job_pending(qsd, &queue, &uptodate) ||
 			     !thread_is_running(thread), &lwi);
 
+		/* quota requests of several IDs are sent to the master in one
+		 * QUOTA_DQACQ_BATCH if it supports it */
+		if (qsd_batch_enabled(qsd)) {
+			if (batch == NULL)
+				OBD_ALLOC_LARGE(batch, sizeof(*batch));
+		} else if (batch != NULL) {
+			OBD_FREE_LARGE(batch, sizeof(*batch));
+			batch = NULL;
+		}
+
 		cfs_list_for_each_entry_safe(upd, n, &queue, qur_link) {
 			cfs_list_del_init(&upd->qur_link);
-			qsd_process_upd(env, upd);
+			qsd_process_upd(env, upd, &batch);
 			qsd_upd_free(upd);
 		}
 
@@ -459,7 +493,8 @@ static int qsd_upd_thread(void *arg)
 				if (lqe->lqe_adjust_time == 0)
 					qsd_id_lock_cancel(env, lqe);
 				else
-					qsd_adjust(env, lqe);
+					qsd_adjust_batched(env, qsd, lqe,
+							   &batch);
 			}
 
 			lqe_putref(lqe);
@@ -467,6 +502,11 @@ static int qsd_upd_thread(void *arg)
 		}
 		spin_unlock(&qsd->qsd_adjust_lock);
 
+		if (batch != NULL && batch->qdb_count > 0) {
+			qsd_batch_send(env, qsd, batch);
+			batch = NULL;
+		}
+
 		if (!thread_is_running(thread))
 			break;
 
@@ -476,6 +516,8 @@ static int qsd_upd_thread(void *arg)
 		for (qtype = USRQUOTA; qtype < MAXQUOTAS; qtype++)
 			qsd_start_reint_thread(qsd->qsd_type_array[qtype]);
 	}
+	if (batch != NULL)
+		OBD_FREE_LARGE(batch, sizeof(*batch));
 	lu_env_fini(env);
 	OBD_FREE_PTR(env);
 	thread_set_flags(thread, SVC_STOPPED);
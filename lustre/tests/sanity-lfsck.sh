@@ -916,6 +916,61 @@ test_10()
 }
 run_test 10 "System is available during LFSCK scanning"
 
+test_11()
+{
+	lfsck_prep 1 1
+	echo "start $SINGLEMDS"
+	start $SINGLEMDS $MDT_DEVNAME $MOUNT_OPTS_SCRUB > /dev/null ||
+		error "(1) Fail to start MDS!"
+
+	mount_client $MOUNT || error "(2) Fail to start client!"
+
+	#define OBD_FAIL_LFSCK_LINKEA_CRASH	0x1603
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0x1603
+	for ((i=0; i<100; i++)); do
+		mkdir -p $DIR/$tdir/d${i}
+		for ((j=0; j<10; j++)); do
+			touch $DIR/$tdir/d${i}/f${j}
+		done
+	done
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0
+	umount_client $MOUNT
+
+	local saved=$(do_facet $SINGLEMDS \
+		$LCTL get_param -n mdd.${MDT_DEV}.lfsck_threads |
+		awk '/^threads/ { print $2 }')
+	do_facet $SINGLEMDS \
+		$LCTL set_param -n mdd.${MDT_DEV}.lfsck_threads 4 ||
+		error "(3) Fail to set lfsck_threads!"
+
+	$START_NAMESPACE || error "(4) Fail to start LFSCK for namespace!"
+
+	sleep 5
+	local STATUS=$($SHOW_NAMESPACE | awk '/^status/ { print $2 }')
+	[ "$STATUS" == "completed" ] ||
+		error "(5) Expect 'completed', but got '$STATUS'"
+
+	local repaired=$($SHOW_NAMESPACE |
+			 awk '/^updated_phase1/ { print $2 }')
+	[ $repaired -ge 1000 ] ||
+		error "(6) Fail to repair crashed linkEA: $repaired"
+
+	local workers=$(do_facet $SINGLEMDS \
+		$LCTL get_param -n mdd.${MDT_DEV}.lfsck_threads |
+		grep -c "^thread_")
+	do_facet $SINGLEMDS \
+		$LCTL set_param -n mdd.${MDT_DEV}.lfsck_threads $saved
+	[ $workers -eq 4 ] ||
+		error "(7) Expect 4 LFSCK threads, but got $workers"
+
+	mount_client $MOUNT || error "(8) Fail to start client!"
+	local fid=$($LFS path2fid $DIR/$tdir/d99/f9)
+	local name=$($LFS fid2path $DIR $fid)
+	[ "$name" == "$DIR/$tdir/d99/f9" ] ||
+		error "(9) Fail to repair linkEA: $fid $name"
+}
+run_test 11 "multi-threaded LFSCK repairs linkEA"
+
 $LCTL set_param debug=-lfsck > /dev/null || true
 
 # restore MDS/OST size
@@ -2302,6 +2302,99 @@ test_36() {
 }
 run_test 36 "Migrate old admin files into new global indexes"
 
+test_37() {
+	local LIMIT=2048
+	local TESTFILE="$DIR/$tdir/$tfile"
+	local procf="osd-*.$FSNAME-MDT*.quota_slave.percpu_threshold"
+	local old=$(do_facet $SINGLEMDS $LCTL get_param -n $procf | head -1)
+	local pids=""
+	local i
+
+	setup_quota_test
+	trap cleanup_quota_test EXIT
+
+	set_mdt_qtype "u" || error "enable mdt quota failed"
+
+	# reserve quota space per CPU from the first operation on
+	do_facet $SINGLEMDS $LCTL set_param $procf=1
+
+	$LFS setquota -u $TSTUSR -b 0 -B 0 -i 0 -I $LIMIT $DIR ||
+		error "set user quota failed"
+
+	log "Create $LIMIT files from 4 processes ..."
+	for i in 0 1 2 3; do
+		$RUNAS createmany -m ${TESTFILE}-$i- $((LIMIT / 4)) &
+		pids="$pids $!"
+	done
+	for i in $pids; do
+		wait $i || quota_error u $TSTUSR \
+			"user create failure, but expect success"
+	done
+
+	log "Create out of file quota ..."
+	$RUNAS touch ${TESTFILE}_xxx &&
+		quota_error u $TSTUSR "user create success, but expect EDQUOT"
+
+	do_facet $SINGLEMDS $LCTL set_param $procf=$old
+	for i in 0 1 2 3; do
+		unlinkmany ${TESTFILE}-$i- $((LIMIT / 4))
+	done
+	wait_delete_completed
+
+	local USED=$(getquota -u $TSTUSR global curinodes)
+	[ $USED -ne 0 ] && quota_error u $TSTUSR \
+		"user quota isn't released after deletion"
+
+	cleanup_quota_test
+	resetquota -u $TSTUSR
+}
+run_test 37 "Per-CPU quota reservations don't break inode hardlimit"
+
+test_38() {
+	local LIMIT=10240
+	local TESTFILE="$DIR/$tdir/$tfile"
+	local procf="osd-*.$FSNAME-MDT*.quota_slave.batch_max"
+	local stats="mds.MDS.mdt.stats"
+	local old=$(do_facet $SINGLEMDS $LCTL get_param -n $procf | head -1)
+	local batches
+
+	setup_quota_test
+	trap cleanup_quota_test EXIT
+
+	set_mdt_qtype "ug" || error "enable mdt quota failed"
+	do_facet $SINGLEMDS $LCTL set_param $procf=32
+
+	$LFS setquota -u $TSTUSR -b 0 -B 0 -i 0 -I $LIMIT $DIR ||
+		error "set user quota failed"
+	$LFS setquota -g $TSTUSR -b 0 -B 0 -i 0 -I $LIMIT $DIR ||
+		error "set group quota failed"
+
+	do_facet $SINGLEMDS $LCTL set_param $stats=clear
+	log "Create and remove 1000 files ..."
+	$RUNAS createmany -m ${TESTFILE}- 1000 ||
+		quota_error u $TSTUSR "user create failure, but expect success"
+	unlinkmany ${TESTFILE}- 1000
+	wait_delete_completed
+
+	# user and group adjustments of each operation go in one batch
+	batches=$(do_facet $SINGLEMDS $LCTL get_param -n $stats |
+		  awk '/quota_acquire_batch/ { print $2 }')
+	do_facet $SINGLEMDS $LCTL set_param $procf=$old
+	[ ${batches:-0} -gt 0 ] || error "no quota request was batched"
+
+	local USED=$(getquota -u $TSTUSR global curinodes)
+	[ $USED -ne 0 ] && quota_error u $TSTUSR \
+		"user quota isn't released after deletion"
+	USED=$(getquota -g $TSTUSR global curinodes)
+	[ $USED -ne 0 ] && quota_error g $TSTUSR \
+		"group quota isn't released after deletion"
+
+	cleanup_quota_test
+	resetquota -u $TSTUSR
+	resetquota -g $TSTUSR
+}
+run_test 38 "Quota requests of several IDs are batched"
+
 quota_fini()
 {
         do_nodes $(comma_list $(nodes_list)) "lctl set_param debug=-quota"
@@ -780,6 +780,130 @@ test_11() {
 }
 run_test 11 "OI scrub skips the new created objects only once"
 
+test_12() {
+	scrub_prep 1000
+	mds_backup_restore || error "(1) Fail to backup/restore!"
+
+	echo "start $SINGLEMDS with disabling OI scrub"
+	start $SINGLEMDS $MDT_DEVNAME $MOUNT_OPTS_NOSCRUB > /dev/null ||
+		error "(2) Fail to start MDS!"
+
+	local FLAGS=$($SHOW_SCRUB | awk '/^flags/ { print $2 }')
+	[ "$FLAGS" == "inconsistent" ] ||
+		error "(3) Expect 'inconsistent', but got '$FLAGS'"
+
+	do_facet $SINGLEMDS $LCTL set_param -n \
+		osd-ldiskfs.${MDT_DEV}.oi_scrub_threads 4 ||
+		error "(4) Fail to set OI scrub threads!"
+
+	$START_SCRUB || error "(5) Fail to start OI scrub!"
+	sleep 3
+	local STATUS=$($SHOW_SCRUB | awk '/^status/ { print $2 }')
+	[ "$STATUS" == "completed" ] ||
+		error "(6) Expect 'completed', but got '$STATUS'"
+
+	FLAGS=$($SHOW_SCRUB | awk '/^flags/ { print $2 }')
+	[ -z "$FLAGS" ] || error "(7) Expect empty flags, but got '$FLAGS'"
+
+	local THREADS=$(do_facet $SINGLEMDS $LCTL get_param -n \
+		osd-ldiskfs.${MDT_DEV}.oi_scrub_threads |
+		awk '/^thread_/ { print $1 }' | wc -l)
+	[ $THREADS -eq 4 ] ||
+		error "(8) Expect 4 OI scrub threads, but got $THREADS"
+
+	mount_client $MOUNT || error "(9) Fail to start client!"
+
+	diff -q $LUSTRE/tests/test-framework.sh $DIR/$tdir/test-framework.sh ||
+		error "(10) File diff failed unexpected!"
+}
+run_test 12 "Multi-threaded OI scrub for backup/restore case"
+
+oi_cache_stat() {
+	do_facet $SINGLEMDS $LCTL get_param -n \
+		osd-ldiskfs.${MDT_DEV}.oi_cache_stats |
+		awk '/^'$1':/ { print $2 }'
+}
+
+oi_cache_check_fids() {
+	local dir=$1
+	local fid
+
+	cancel_lru_locks mdc
+	for f in $(ls $dir); do
+		fid=$($LFS path2fid $dir/$f)
+		stat $MOUNT/.lustre/fid/$fid > /dev/null ||
+			error "$2: Fail to stat $dir/$f by FID $fid"
+	done
+}
+
+test_13() {
+	echo "stopall"
+	stopall > /dev/null
+	echo "formatall"
+	formatall > /dev/null
+	echo "setupall"
+	setupall > /dev/null
+
+	local tname=`date +%s`
+	mkdir $MOUNT/$tname || error "(1) Fail to mkdir $MOUNT/$tname"
+	createmany -o $MOUNT/$tname/f 100 || error "(2) Fail to create!"
+
+	# restart MDS to drop the cached objects
+	echo "stop $SINGLEMDS"
+	stop $SINGLEMDS > /dev/null || error "(3) Fail to stop MDS!"
+	echo "start $SINGLEMDS"
+	start $SINGLEMDS $MDT_DEVNAME $MOUNT_OPTS_SCRUB > /dev/null ||
+		error "(4) Fail to start MDS!"
+	cancel_lru_locks mdc
+
+	local SAVED=$(do_facet $SINGLEMDS $LCTL get_param -n \
+		osd-ldiskfs.${MDT_DEV}.oi_cache_size)
+
+	ls -l $MOUNT/$tname > /dev/null || error "(5) Fail to ls!"
+	local PREFETCHED=$(oi_cache_stat prefetched)
+	[ $PREFETCHED -gt 0 ] ||
+		error "(6) Expect OI records prefetched, but got $PREFETCHED"
+
+	# the cached mappings of the unlinked objects must be dropped
+	local fids=$(for f in $(ls $MOUNT/$tname); do
+			$LFS path2fid $MOUNT/$tname/$f; done)
+	unlinkmany $MOUNT/$tname/f 100 || error "(7) Fail to unlink!"
+	cancel_lru_locks mdc
+	for fid in $fids; do
+		stat $MOUNT/.lustre/fid/$fid > /dev/null 2>&1 &&
+			error "(8) Unlinked object $fid is still found"
+	done
+
+	createmany -o $MOUNT/$tname/f 100 || error "(9) Fail to re-create!"
+	oi_cache_check_fids $MOUNT/$tname "(10)"
+
+	# toggle the OI cache while creating, nothing stale may be cached
+	createmany -o $MOUNT/$tname/g 1000 &
+	local PID=$!
+	for i in $(seq 20); do
+		do_facet $SINGLEMDS $LCTL set_param -n \
+			osd-ldiskfs.${MDT_DEV}.oi_cache_size 0 ||
+			error "(11) Fail to disable OI cache!"
+		do_facet $SINGLEMDS $LCTL set_param -n \
+			osd-ldiskfs.${MDT_DEV}.oi_cache_size $SAVED ||
+			error "(12) Fail to enable OI cache!"
+	done
+	wait $PID || error "(13) Fail to create!"
+	oi_cache_check_fids $MOUNT/$tname "(14)"
+
+	do_facet $SINGLEMDS $LCTL set_param -n \
+		osd-ldiskfs.${MDT_DEV}.oi_cache_size 0 ||
+		error "(15) Fail to disable OI cache!"
+	local CACHED=$(oi_cache_stat cached)
+	do_facet $SINGLEMDS $LCTL set_param -n \
+		osd-ldiskfs.${MDT_DEV}.oi_cache_size $SAVED ||
+		error "(16) Fail to restore OI cache size!"
+	[ $CACHED -eq 0 ] || error "(17) Expect empty OI cache, got $CACHED"
+
+	rm -rf $MOUNT/$tname > /dev/null
+}
+run_test 13 "OI cache prefetch and coherency with unlink and resize"
+
 # restore MDS/OST size
 MDSSIZE=${SAVED_MDSSIZE}
 OSTSIZE=${SAVED_OSTSIZE}
@@ -7074,6 +7074,31 @@ test_119d() # bug 15950
 }
 run_test 119d "The DIO path should try to send a new rpc once one is completed"
 
+test_119e() {
+	local param="llite.*.max_dio_inflight_mb"
+	local old=$($LCTL get_param -n $param | head -1)
+
+	$SETSTRIPE -c -1 $DIR/$tfile || error "setstripe failed"
+	dd if=/dev/urandom of=$TMP/$tfile bs=1M count=16 ||
+		error "dd to $TMP failed"
+	# a 1MB window with 256kB chunks drains several times per request
+	for mb in 0 1 $old; do
+		$LCTL set_param -n $param $mb
+		dd if=$TMP/$tfile of=$DIR/$tfile bs=4M oflag=direct \
+			conv=notrunc || error "direct write failed, window $mb"
+		cancel_lru_locks osc
+		cmp $TMP/$tfile $DIR/$tfile ||
+			error "data mismatch after write, window $mb"
+		dd if=$DIR/$tfile of=$TMP/$tfile.2 bs=8M iflag=direct ||
+			error "direct read failed, window $mb"
+		cmp $TMP/$tfile $TMP/$tfile.2 ||
+			error "data mismatch after read, window $mb"
+	done
+	$LCTL set_param -n $param $old
+	rm -f $DIR/$tfile $TMP/$tfile $TMP/$tfile.2
+}
+run_test 119e "pipelined direct IO keeps data intact"
+
 test_120a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
         test_mkdir -p $DIR/$tdir
@@ -9142,6 +9167,11 @@ test_160() {
     [ $USER_REC2 == $(($USER_REC1 + 5)) ] || \
 	err17935 "user index should be $(($USER_REC1 + 5)); is $USER_REC2"
 
+    # records are cancelled by the changelog GC thread
+    wait_update_facet $SINGLEMDS "$LCTL get_param -n \
+	mdd.$MDT0.changelog_gc | awk '/^lag:/ { print \$2 }'" 0 30 ||
+	error "changelog GC did not catch up"
+
     MIN_REC=$(do_facet $SINGLEMDS $LCTL get_param mdd.$MDT0.changelog_users | \
 	awk 'min == "" || $2 < min {min = $2}; END {print min}')
     FIRST_REC=$($LFS changelog $MDT0 | head -1 | awk '{print $1}')
@@ -9170,6 +9200,56 @@ test_160() {
 }
 run_test 160 "changelog sanity"
 
+test_160b() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+	local gc="mdd.$MDT0.changelog_gc"
+	local USER
+	local CANCELLED1
+	local CANCELLED2
+	local FIRST_REC
+	local LAST_REC
+
+	do_facet $SINGLEMDS $LCTL get_param $gc 2>/dev/null |
+		grep -q "status: running" ||
+		{ skip "no changelog GC thread"; return; }
+
+	USER=$(do_facet $SINGLEMDS $LCTL --device $MDT0 changelog_register -n)
+	echo "Registered as changelog user $USER"
+	if [ $(do_facet $SINGLEMDS $LCTL get_param -n \
+	       mdd.$MDT0.changelog_users | wc -l) -ne 3 ]; then
+		do_facet $SINGLEMDS $LCTL --device $MDT0 \
+			changelog_deregister $USER
+		skip "other changelog users registered"
+		return
+	fi
+	CANCELLED1=$(do_facet $SINGLEMDS $LCTL get_param -n $gc |
+		awk '/^records_cancelled:/ { print $2 }')
+
+	test_mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/f 1000 || error "createmany failed"
+	LAST_REC=$($LFS changelog $MDT0 | tail -1 | awk '{ print $1 }')
+	$LFS changelog_clear $MDT0 $USER $LAST_REC ||
+		error "changelog_clear failed"
+
+	wait_update_facet $SINGLEMDS "$LCTL get_param -n $gc |
+		awk '/^lag:/ { print \$2 }'" 0 60 ||
+		error "changelog GC did not catch up"
+	do_facet $SINGLEMDS $LCTL get_param $gc
+
+	CANCELLED2=$(do_facet $SINGLEMDS $LCTL get_param -n $gc |
+		awk '/^records_cancelled:/ { print $2 }')
+	[ $CANCELLED2 -ge $((CANCELLED1 + 1000)) ] ||
+		error "only $((CANCELLED2 - CANCELLED1)) records cancelled"
+	FIRST_REC=$($LFS changelog $MDT0 | head -1 | awk '{ print $1 }')
+	[ -z "$FIRST_REC" -o "$FIRST_REC" -gt $LAST_REC ] ||
+		error "record $FIRST_REC not purged, cleared up to $LAST_REC"
+
+	do_facet $SINGLEMDS $LCTL --device $MDT0 changelog_deregister $USER
+	unlinkmany $DIR/$tdir/f 1000
+}
+run_test 160b "changelog records are purged by GC thread"
+
 test_161a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
     test_mkdir -p $DIR/$tdir
@@ -10440,9 +10520,34 @@ test_215() { # for bugs 18102, 21079, 21517
 	check_lnet_proc_entry "nis.sys" "lnet.nis" "$BR" "$L1"
 	remove_lnet_proc_files "nis"
 
+	# /proc/sys/lnet/nis_latency should look like this:
+	# nid type count total_us 0 2 4 ... 524288
+	# where type is queue/credit/wire, followed by the message count,
+	# the total latency in usec and the counts of the log2 usec buckets.
+	L1="^nid +type +count +total_us( +$N)+$"
+	BR="^$NID +(queue|credit|wire) +$N +$N( +$N)+$"
+	create_lnet_proc_files "nis_latency"
+	check_lnet_proc_entry "nis_latency.out" "/proc/sys/lnet/nis_latency" \
+		"$BR" "$L1"
+	check_lnet_proc_entry "nis_latency.sys" "lnet.nis_latency" "$BR" "$L1"
+	remove_lnet_proc_files "nis_latency"
+
+	# /proc/sys/lnet/peers_latency is the same per peer, with the current
+	# and the maximum # of messages in flight to the peer after the nid.
+	L1="^nid +inflight +max +type +count +total_us( +$N)+$"
+	BR="^$NID +$N +$N +(queue|credit|wire) +$N +$N( +$N)+$"
+	create_lnet_proc_files "peers_latency"
+	check_lnet_proc_entry "peers_latency.out" \
+		"/proc/sys/lnet/peers_latency" "$BR" "$L1"
+	check_lnet_proc_entry "peers_latency.sys" "lnet.peers_latency" \
+		"$BR" "$L1"
+	remove_lnet_proc_files "peers_latency"
+
 	# can we successfully write to /proc/sys/lnet/stats?
 	echo "0" >/proc/sys/lnet/stats || error "cannot write to /proc/sys/lnet/stats"
 	sysctl -w lnet.stats=0 || error "cannot write to lnet.stats"
+	echo "0" >/proc/sys/lnet/nis_latency ||
+		error "cannot write to /proc/sys/lnet/nis_latency"
 }
 run_test 215 "/proc/sys/lnet exists and has proper content - bugs 18102, 21079, 21517"
 
@@ -11073,6 +11178,512 @@ test_232() {
 }
 run_test 232 "failed lock should not block umount"
 
+test_233() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+	[ "$(facet_fstype ost1)" != "ldiskfs" ] &&
+		skip "ldiskfs only test" && return
+
+	local list=$(comma_list $(osts_nodes))
+	local old=$(get_osd_param $(facet_active_host ost1) '' \
+		    bio_submit_pages | head -1)
+	local old_cache=$(get_osd_param $(facet_active_host ost1) '' \
+			  read_cache_enable | head -1)
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	dd if=/dev/urandom of=$TMP/$tfile bs=1M count=4 ||
+		error "dd to $TMP/$tfile failed"
+
+	set_osd_param $list '' bio_submit_pages 16
+	set_cache read off
+	dd if=$TMP/$tfile of=$DIR/$tfile bs=4M count=1 oflag=direct ||
+		error "dd to $DIR/$tfile failed"
+	cancel_lru_locks osc
+	cmp $TMP/$tfile $DIR/$tfile || error "data differ after parallel I/O"
+	get_osd_param $list '' brw_stats | grep -q "bio submit segments" ||
+		error "no bio submit segments in brw_stats"
+
+	set_osd_param $list '' bio_submit_pages $old
+	set_osd_param $list '' read_cache_enable $old_cache
+	rm -f $TMP/$tfile $DIR/$tfile
+}
+run_test 233 "parallel bio submission keeps data intact"
+
+LOV_IO_THREADS=/sys/module/lov/parameters/lov_io_threads
+
+cleanup_234() {
+	trap 0
+	echo $1 > $LOV_IO_THREADS
+	rm -f $TMP/$tfile $DIR/$tfile
+}
+
+test_234() {
+	local old
+
+	[ "$OSTCOUNT" -lt "2" ] && skip_env "needs >= 2 OSTs" && return
+	[ -f $LOV_IO_THREADS ] ||
+		{ skip "no lov_io_threads parameter" && return; }
+
+	old=$(cat $LOV_IO_THREADS)
+	trap "cleanup_234 $old" EXIT
+	echo 2 > $LOV_IO_THREADS || error "can't set lov_io_threads"
+
+	$SETSTRIPE -c -1 -S 1M $DIR/$tfile || error "setstripe failed"
+	dd if=/dev/urandom of=$TMP/$tfile bs=1M count=$((OSTCOUNT * 4)) ||
+		error "dd to $TMP failed"
+	# each iteration of these covers a whole stripe width
+	dd if=$TMP/$tfile of=$DIR/$tfile bs=$((OSTCOUNT * 2))M ||
+		error "write failed"
+	cancel_lru_locks osc
+	cmp $TMP/$tfile $DIR/$tfile || error "data differ after write"
+	dd if=$DIR/$tfile of=/dev/null bs=$((OSTCOUNT * 2))M ||
+		error "read failed"
+	$MULTIOP $DIR/$tfile oO_WRONLY:y || error "fsync failed"
+	# truncate and fsync start their sub-io's on the workers
+	$TRUNCATE $DIR/$tfile $((OSTCOUNT * 512 * 1024 + 1000)) ||
+		error "truncate failed"
+	$TRUNCATE $TMP/$tfile $((OSTCOUNT * 512 * 1024 + 1000))
+	cancel_lru_locks osc
+	cmp $TMP/$tfile $DIR/$tfile || error "data differ after truncate"
+	cleanup_234 $old
+}
+run_test 234 "parallel sub-io execution of a striped file"
+
+test_235() {
+	local param="osc.*-osc-[^mM]*.lru_lock_stats"
+
+	$LCTL get_param -n $param > /dev/null || error "no lru_lock_stats"
+	$LCTL set_param -n $param=0
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=16 || error "dd failed"
+	sync
+	cat $DIR/$tfile > /dev/null || error "read failed"
+	# shrink the LRU, this flushes the per-CPT batches
+	$LCTL set_param -n osc.*-osc-[^mM]*.osc_cached_mb=0
+
+	local flushes=$($LCTL get_param -n $param |
+			awk '/batch_flushes/ { sum += $2 } END { print sum }')
+	local staged=$($LCTL get_param -n $param |
+			awk '/staged_pages/ { sum += $2 } END { print sum }')
+	$LCTL get_param $param
+	[ $flushes -gt 0 ] || error "LRU batches were never flushed"
+	[ $staged -eq 0 ] || error "$staged pages left staged after shrink"
+	rm -f $DIR/$tfile
+}
+run_test 235 "osc LRU batches are flushed to the shared LRU"
+
+test_236a() {
+	local param="osc.*-osc-[^mM]*.max_brw_objs"
+	local nfiles=64
+	local old
+	local before
+	local after
+
+	[ -z "$($LCTL get_param -n osc.*-osc-*.import |
+		grep multi_brw)" ] &&
+		skip "server does not support multi-object writes" && return
+
+	old=$($LCTL get_param -n $param | head -1)
+	$LCTL set_param -n $param=16
+	mkdir -p $DIR/$tdir
+	$SETSTRIPE -c 1 -i 0 $DIR/$tdir || error "setstripe failed"
+	dd if=/dev/urandom of=$TMP/$tfile bs=4k count=1 ||
+		error "dd to $TMP failed"
+	sync
+	before=$(count_ost_writes)
+	for i in $(seq $nfiles); do
+		cp $TMP/$tfile $DIR/$tdir/f$i || error "cp f$i failed"
+	done
+	sync
+	after=$(count_ost_writes)
+	$LCTL set_param -n $param=$old
+
+	echo "$nfiles files written with $((after - before)) write RPCs"
+	[ $((after - before)) -lt $nfiles ] ||
+		error "small writes were not packed into shared RPCs"
+	cancel_lru_locks osc
+	for i in $(seq $nfiles); do
+		cmp $TMP/$tfile $DIR/$tdir/f$i || error "f$i differs"
+	done
+	rm -rf $DIR/$tdir $TMP/$tfile
+}
+run_test 236a "small writes of many objects share write RPCs"
+
+test_236b() {
+	local param="osc.*-osc-[^mM]*.max_brw_objs"
+	local nfiles=16
+	local old
+
+	[ -z "$($LCTL get_param -n osc.*-osc-*.import |
+		grep multi_brw)" ] &&
+		skip "server does not support multi-object writes" && return
+
+	old=$($LCTL get_param -n $param | head -1)
+	$LCTL set_param -n $param=16
+	mkdir -p $DIR/$tdir
+	$SETSTRIPE -c 1 -i 0 $DIR/$tdir || error "setstripe failed"
+	dd if=/dev/urandom of=$TMP/$tfile bs=4k count=1 ||
+		error "dd to $TMP failed"
+	sync
+
+	# the first multi-object write claims more pages than the OST takes
+	#define OBD_FAIL_OSC_BRW_OVERSIZE	 0x413
+	$LCTL set_param fail_loc=0x80000413
+	for i in $(seq $nfiles); do
+		cp $TMP/$tfile $DIR/$tdir/f$i || error "cp f$i failed"
+	done
+	sync
+	$LCTL set_param fail_loc=0
+
+	# the OST refused it and still serves writes
+	for i in $(seq $nfiles); do
+		cp $TMP/$tfile $DIR/$tdir/f$i || error "rewrite f$i failed"
+	done
+	sync || error "sync failed"
+	$LCTL set_param -n $param=$old
+	cancel_lru_locks osc
+	for i in $(seq $nfiles); do
+		cmp $TMP/$tfile $DIR/$tdir/f$i || error "f$i differs"
+	done
+	rm -rf $DIR/$tdir $TMP/$tfile
+}
+run_test 236b "oversized multi-object write is refused by the OST"
+
+test_237() {
+	local ost=$(ostname_from_index 0)
+	local param="obdfilter.$ost.exports.*.grant"
+
+	do_facet ost1 $LCTL get_param -n obdfilter.$ost.grant_adaptive ||
+		{ skip "no adaptive grant support" && return; }
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=32 conv=fsync ||
+		error "dd failed"
+	# the write rate is refreshed at the end of a 5s window
+	sleep 6
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=1 seek=32 conv=fsync ||
+		error "dd failed"
+
+	do_facet ost1 $LCTL get_param $param
+	local rate=$(do_facet ost1 $LCTL get_param -n $param |
+		     awk '/write_rate/ { if ($2 > max) max = $2 }
+			  END { print max + 0 }')
+	[ $rate -gt 0 ] || error "write rate of the client is not tracked"
+	rm -f $DIR/$tfile
+}
+run_test 237 "per-export write rate is tracked for adaptive grant"
+
+test_238a() {
+	[ -z "$($LCTL get_param -n mdc.*.import | grep -w dom)" ] &&
+		skip "MDS does not support data on MDT" && return
+
+	$SETSTRIPE -L mdt -S 64k $DIR/$tfile || error "setstripe -L mdt failed"
+	$GETSTRIPE -v $DIR/$tfile
+	[ $($GETSTRIPE -v $DIR/$tfile | awk '/lmm_stripe_pattern/ { print $2 }'
+	  ) == 4 ] || error "file does not have the DoM layout"
+	[ $($GETSTRIPE -c $DIR/$tfile) -eq 0 ] ||
+		error "DoM file has OST objects"
+
+	dd if=/dev/urandom of=$TMP/$tfile bs=4k count=12 ||
+		error "dd to $TMP failed"
+	cp $TMP/$tfile $DIR/$tfile || error "write of DoM file failed"
+	cancel_lru_locks mdc
+	cmp $TMP/$tfile $DIR/$tfile || error "DoM data differs"
+
+	# truncate stays on the MDT
+	$TRUNCATE $DIR/$tfile 1000 || error "truncate failed"
+	truncate -s 1000 $TMP/$tfile
+	[ $(stat -c %s $DIR/$tfile) -eq 1000 ] || error "wrong size after truncate"
+	cmp $TMP/$tfile $DIR/$tfile || error "DoM data differs after truncate"
+
+	# append past the limit moves the file to OSTs
+	dd if=/dev/urandom bs=4k count=32 2>/dev/null |
+		tee -a $TMP/$tfile >> $DIR/$tfile || error "append failed"
+	cancel_lru_locks mdc
+	cancel_lru_locks osc
+	[ $($GETSTRIPE -v $DIR/$tfile | awk '/lmm_stripe_pattern/ { print $2 }'
+	  ) == 1 ] || error "file was not moved to OSTs"
+	[ "$(md5sum < $DIR/$tfile)" == "$(md5sum < $TMP/$tfile)" ] ||
+		error "data differs after migration"
+
+	# mmap moves the file to OSTs as well
+	$SETSTRIPE -L mdt -S 64k $DIR/$tfile-2 ||
+		error "setstripe -L mdt failed"
+	head -c 12345 $TMP/$tfile > $TMP/$tfile-2
+	cp $TMP/$tfile-2 $DIR/$tfile-2 || error "write of DoM file failed"
+	$MULTIOP $DIR/$tfile-2 OSMRUc || error "mmap of DoM file failed"
+	[ $($GETSTRIPE -v $DIR/$tfile-2 |
+	    awk '/lmm_stripe_pattern/ { print $2 }') == 1 ] ||
+		error "mapped file was not moved to OSTs"
+	cancel_lru_locks osc
+	cmp $TMP/$tfile-2 $DIR/$tfile-2 || error "data differs after mmap"
+	rm -f $DIR/$tfile $DIR/$tfile-2 $TMP/$tfile $TMP/$tfile-2
+}
+run_test 238a "small file data is kept on the MDT until it grows"
+
+test_238b() {
+	[ -z "$($LCTL get_param -n mdc.*.import | grep -w dom)" ] &&
+		skip "MDS does not support data on MDT" && return
+
+	$SETSTRIPE -L mdt -S 64k $DIR/$tfile || error "setstripe -L mdt failed"
+	dd if=/dev/urandom of=$TMP/$tfile bs=4k count=2 ||
+		error "dd to $TMP failed"
+	dd if=$TMP/$tfile of=$DIR/$tfile bs=4k count=1 ||
+		error "write of DoM file failed"
+
+	# the reply to the append is lost, the resent append is not redone
+	#define OBD_FAIL_MDS_DOM_WRITE_NET_REP 0x154
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0x80000154
+	dd if=$TMP/$tfile of=$DIR/$tfile bs=4k skip=1 count=1 \
+		oflag=append conv=notrunc || error "append failed"
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0
+
+	cancel_lru_locks mdc
+	[ $(stat -c %s $DIR/$tfile) -eq 8192 ] ||
+		error "wrong size $(stat -c %s $DIR/$tfile) after resent append"
+	cmp $TMP/$tfile $DIR/$tfile || error "DoM data differs"
+	rm -f $DIR/$tfile $TMP/$tfile
+}
+run_test 238b "resent DoM append is not written twice"
+
+test_239() {
+	[ -z "$($LCTL get_param -n mdc.*.import | grep -w dom)" ] &&
+		skip "MDS does not support data on MDT" && return
+
+	local old=$($LCTL get_param -n llite.*.create_batch_kb | head -1)
+	local nr=10
+	local i
+
+	$LCTL set_param llite.*.create_batch_kb=64 ||
+		error "cannot enable batched create"
+	$LCTL set_param llite.*.stats=clear
+	test_mkdir -p $DIR/$tdir
+	test_mkdir -p $DIR/$tdir/plain
+	# only files which get a DoM layout from their directory are batched
+	$SETSTRIPE -L mdt -S 64k $DIR/$tdir ||
+		error "setstripe -L mdt on $tdir failed"
+	dd if=/dev/urandom of=$TMP/$tfile bs=1k count=20 ||
+		error "dd to $TMP failed"
+	for i in $(seq $nr); do
+		dd if=$TMP/$tfile of=$DIR/$tdir/f$i bs=4k 2>/dev/null ||
+			error "write of f$i failed"
+	done
+	dd if=$TMP/$tfile of=$DIR/$tdir/plain/f bs=4k 2>/dev/null ||
+		error "write of plain/f failed"
+	# the first 64k are still batched, the rest moves the file to OSTs
+	dd if=/dev/urandom of=$DIR/$tdir/big bs=4k count=32 ||
+		error "dd to big failed"
+	$LCTL set_param llite.*.create_batch_kb=$old
+
+	local batched=$($LCTL get_param -n llite.*.stats |
+			awk '/^create_batched/ { print $2 }')
+	local unbatched=$($LCTL get_param -n llite.*.stats |
+			  awk '/^create_unbatched/ { print $2 }')
+	echo "batched: $batched unbatched: $unbatched"
+	[ "$batched" == "$((nr + 1))" ] ||
+		error "$batched creates batched, not $((nr + 1))"
+	[ -z "$unbatched" ] || error "$unbatched creates unbatched, not 0"
+
+	cancel_lru_locks mdc
+	cancel_lru_locks osc
+	for i in $(seq $nr); do
+		[ $($GETSTRIPE -v $DIR/$tdir/f$i |
+		    awk '/lmm_stripe_pattern/ { print $2 }') == 4 ] ||
+			error "f$i is not on the MDT"
+		cmp $TMP/$tfile $DIR/$tdir/f$i || error "f$i data differs"
+	done
+	[ $($GETSTRIPE -c $DIR/$tdir/plain/f) -gt 0 ] ||
+		error "plain/f has no OST objects"
+	cmp $TMP/$tfile $DIR/$tdir/plain/f || error "plain/f data differs"
+	[ $($GETSTRIPE -v $DIR/$tdir/big |
+	    awk '/lmm_stripe_pattern/ { print $2 }') == 1 ] ||
+		error "big file is not on OSTs"
+	[ $(stat -c %s $DIR/$tdir/big) -eq 131072 ] || error "wrong size of big"
+	rm -rf $DIR/$tdir $TMP/$tfile
+}
+run_test 239 "small file create, layout and data are sent at close"
+
+test_240() {
+	[ -z "$($LCTL get_param -n mdc.*.import | grep -w batch_getattr)" ] &&
+		skip "MDS does not support batched getattr" && return
+	[ -z "$($LCTL get_param -n mdc.*.import | grep -w dom)" ] &&
+		skip "MDS does not support data on MDT" && return
+
+	local old=$($LCTL get_param -n llite.*.statahead_batch_max | head -1)
+	local nr=1000
+	local rpcs
+	local gl1
+	local gl2
+
+	# only DoM files (and files with a lazy size) are stat'ed without
+	# any OST RPC, files striped over OSTs still get one glimpse each
+	test_mkdir -p $DIR/$tdir
+	$SETSTRIPE -L mdt -S 64k $DIR/$tdir ||
+		error "setstripe -L mdt on $tdir failed"
+	createmany -o $DIR/$tdir/f $nr || error "createmany failed"
+	ls -l $DIR/$tdir > $TMP/$tfile.ref || error "ls -l failed"
+
+	$LCTL set_param llite.*.statahead_batch_max=64 ||
+		error "cannot set statahead_batch_max"
+	cancel_lru_locks mdc
+	cancel_lru_locks osc
+	$LCTL set_param mdc.*.stats=clear
+	gl1=$(get_ost_param "ldlm_glimpse_enqueue")
+	ls -l $DIR/$tdir > $TMP/$tfile.sa || error "ls -l with statahead failed"
+	gl2=$(get_ost_param "ldlm_glimpse_enqueue")
+	rpcs=$($LCTL get_param -n mdc.*.stats |
+	       awk '/^mds_batch_getattr/ { sum += $2 } END { print sum+0 }')
+	$LCTL set_param llite.*.statahead_batch_max=$old
+	$LCTL get_param -n llite.*.statahead_stats
+
+	echo "$rpcs batched getattr, $((gl2 - gl1)) glimpse RPCs for $nr files"
+	[ $rpcs -gt 0 ] || error "no batched getattr RPC was sent"
+	[ $rpcs -le $((nr / 16)) ] || error "too many batched getattr RPCs"
+	[ $((gl2 - gl1)) -eq 0 ] || error "no glimpse RPC is expected"
+	diff $TMP/$tfile.ref $TMP/$tfile.sa || error "ls -l output differs"
+	rm -rf $DIR/$tdir $TMP/$tfile.ref $TMP/$tfile.sa
+}
+run_test 240 "statahead stats a batch of DoM files per RPC"
+
+test_241() {
+	[ -z "$($LCTL get_param -n mdc.*.import | grep -w lazy_size)" ] &&
+		skip "MDS does not support lazy size" && return
+
+	local size
+	local gl1
+	local gl2
+
+	$SETSTRIPE -c -1 $DIR/$tfile || error "setstripe failed"
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=2 || error "dd failed"
+	cancel_lru_locks osc
+	cancel_lru_locks mdc
+
+	gl1=$(get_ost_param "ldlm_glimpse_enqueue")
+	size=$(stat -c %s $DIR/$tfile)
+	gl2=$(get_ost_param "ldlm_glimpse_enqueue")
+	echo "size $size, $((gl2 - gl1)) glimpse RPCs"
+	[ $size -eq 2097152 ] || error "wrong size $size"
+	[ $((gl2 - gl1)) -eq 0 ] || error "no glimpse RPC is expected"
+
+	# the lazy size follows the data after the next close
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=1 seek=2 conv=notrunc ||
+		error "append failed"
+	cancel_lru_locks osc
+	cancel_lru_locks mdc
+	size=$(stat -c %s $DIR/$tfile)
+	[ $size -eq 3145728 ] || error "wrong size $size after append"
+
+	# a writer keeps the lazy size invalid
+	multiop_bg_pause $DIR/$tfile oO_WRONLY:_c || error "multiop failed"
+	local pid=$!
+	$TRUNCATE $DIR/$tfile 1024 || error "truncate failed"
+	cancel_lru_locks osc
+	cancel_lru_locks mdc
+	gl1=$(get_ost_param "ldlm_glimpse_enqueue")
+	size=$(stat -c %s $DIR/$tfile)
+	gl2=$(get_ost_param "ldlm_glimpse_enqueue")
+	kill -USR1 $pid
+	wait $pid || error "multiop failed"
+	[ $size -eq 1024 ] || error "wrong size $size while open"
+	[ $((gl2 - gl1)) -gt 0 ] || error "some glimpse RPC is expected"
+	rm -f $DIR/$tfile
+}
+run_test 241 "lazy size on the MDT avoids glimpse RPCs"
+
+test_242() {
+	[ -z "$(do_facet $SINGLEMDS $LCTL get_param -n osp.*.import |
+		grep -w sync_batch)" ] &&
+		skip "OST does not support sync batch" && return
+
+	local nr=500
+	local rpcs1
+	local rpcs2
+	local recs
+
+	rpcs1=$(do_facet $SINGLEMDS $LCTL get_param -n osp.*.sync_batch_stats |
+		awk '/batch_rpcs/ { sum += $2 } END { print sum + 0 }')
+
+	test_mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/$tfile $nr || error "createmany failed"
+	unlinkmany $DIR/$tdir/$tfile $nr || error "unlinkmany failed"
+	wait_delete_completed
+
+	rpcs2=$(do_facet $SINGLEMDS $LCTL get_param -n osp.*.sync_batch_stats |
+		awk '/batch_rpcs/ { sum += $2 } END { print sum + 0 }')
+	recs=$(do_facet $SINGLEMDS $LCTL get_param -n osp.*.sync_batch_stats |
+	       awk '/batch_records/ { sum += $2 } END { print sum + 0 }')
+	echo "$((rpcs2 - rpcs1)) batch RPCs, $recs records in total"
+	[ $rpcs2 -gt $rpcs1 ] || error "no OST_SYNC_BATCH sent"
+	[ $((rpcs2 - rpcs1)) -lt $nr ] || error "records were not batched"
+}
+run_test 242 "destroys are sent to the OST in batches"
+
+test_243() {
+	[ $MDSCOUNT -lt 2 ] && skip "needs >= 2 MDTs" && return
+	local nr=100
+	local count
+
+	mkdir -p $DIR/$tdir
+	$LFS setdirstripe -i 0 -c $MDSCOUNT $DIR/$tdir/striped ||
+		error "setdirstripe failed"
+	createmany -o $DIR/$tdir/striped/$tfile $nr || error "createmany failed"
+	cancel_lru_locks mdc
+	count=$(ls $DIR/$tdir/striped | wc -l)
+	[ $count -eq $nr ] || error "ls found $count entries, expected $nr"
+	for i in $(seq 0 $((nr - 1))); do
+		stat $DIR/$tdir/striped/$tfile$i > /dev/null ||
+			error "stat $tfile$i failed"
+	done
+	# every shard has the name of the directory in its link EA
+	for i in $(seq 0 $((nr - 1))); do
+		local fid=$($LFS path2fid $DIR/$tdir/striped/$tfile$i)
+		[ "$($LFS fid2path $DIR $fid)" == "$tdir/striped/$tfile$i" ] ||
+			error "fid2path of $tfile$i failed"
+	done
+	rmdir $DIR/$tdir/striped 2>/dev/null &&
+		error "rmdir of non-empty striped dir succeeded"
+	unlinkmany $DIR/$tdir/striped/$tfile $nr || error "unlinkmany failed"
+	rmdir $DIR/$tdir/striped || error "rmdir of striped dir failed"
+}
+run_test 243 "directory striped over several MDTs"
+
+test_244() {
+	[ "$(facet_fstype $SINGLEMDS)" != "ldiskfs" ] &&
+		skip "only for ldiskfs MDT" && return
+	local param="osd-ldiskfs.$FSNAME-MDT0000"
+	local old=$(do_facet $SINGLEMDS $LCTL get_param -n \
+		    $param.dir_compact_min_blocks)
+	local nr=20000
+	local size1
+	local size2
+	local freed
+
+	do_facet $SINGLEMDS $LCTL set_param $param.dir_compact_min_blocks=16
+	test_mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/$tfile- $nr || error "createmany failed"
+	size1=$(stat -c %s $DIR/$tdir)
+	unlinkmany $DIR/$tdir/$tfile- $((nr - 10)) || error "unlinkmany failed"
+
+	for i in $(seq 30); do
+		cancel_lru_locks mdc
+		size2=$(stat -c %s $DIR/$tdir)
+		[ $size2 -lt $size1 ] && break
+		sleep 1
+	done
+	do_facet $SINGLEMDS $LCTL get_param $param.dir_compact
+	do_facet $SINGLEMDS $LCTL set_param $param.dir_compact_min_blocks=$old
+
+	echo "directory size $size1 -> $size2"
+	[ $size2 -lt $size1 ] || error "directory was not compacted"
+	[ $(ls $DIR/$tdir | wc -l) -eq 10 ] || error "entries lost"
+	for i in $(seq $((nr - 10)) $((nr - 1))); do
+		stat $DIR/$tdir/$tfile-$i > /dev/null ||
+			error "stat $tfile-$i failed"
+	done
+	rm -rf $DIR/$tdir
+}
+run_test 244 "emptied directories are compacted online"
+
 #
 # tests that do cleanup/setup should be run at the end
 #
@@ -948,6 +948,55 @@ test_33b() {
 }
 run_test 33b "COS: cross create/delete, 2 clients, benchmark under remote dir"
 
+cos_forced_commits() {
+	do_facet $SINGLEMDS "lctl get_param -n mdt.*.commit_on_sharing_stats" |
+		awk '/forced_commits/ { sum += $2 } END { print sum + 0 }'
+}
+
+test_33c() {
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+
+	[ -n "$CLIENTS" ] || { skip "Need two or more clients" && return 0; }
+	[ $CLIENTCOUNT -ge 2 ] ||
+		{ skip "Need two or more clients, have $CLIENTCOUNT" &&
+								return 0; }
+
+	local nfiles=${TEST33_NFILES:-10000}
+	local param_file=$TMP/$tfile-params
+	local COS
+	local forced
+
+	save_lustre_params $(comma_list $(mdts_nodes)) \
+				"mdt.*.commit_on_sharing" > $param_file
+
+	do_facet $SINGLEMDS lctl set_param mdt.*.commit_on_sharing=3 &&
+		error "commit_on_sharing=3 should be rejected"
+
+	for COS in 1 2; do
+		do_facet $SINGLEMDS lctl set_param mdt.*.commit_on_sharing=$COS
+		do_nodes $CLIENT1,$CLIENT2 "mkdir -p $DIR1/$tdir-\\\$(hostname)-$COS"
+
+		forced=$(cos_forced_commits)
+		local elapsed=$(do_and_time "do_nodes $CLIENT1,$CLIENT2 \
+			createmany -o $DIR1/$tdir-\\\$(hostname)-$COS/f- \
+			-r $DIR2/$tdir-\\\$(hostname)-$COS/f- $nfiles > \
+							/dev/null 2>&1")
+		forced=$(($(cos_forced_commits) - forced))
+		echo "COS=$COS forced commits: $forced time: $elapsed"
+		eval cos${COS}_forced=$forced
+	done
+	do_facet $SINGLEMDS lctl get_param mdt.*.commit_on_sharing_stats
+
+	[ $cos2_forced -le $cos1_forced ] ||
+		echo "COS=2 forced more commits than COS=1:" \
+		     "$cos2_forced > $cos1_forced"
+
+	restore_lustre_params < $param_file
+	rm -f $param_file
+	return 0
+}
+run_test 33c "COS: fine-grained mode avoids covered commits, 2 clients"
+
 # End commit on sharing tests
 
 get_ost_lock_timeouts() {
@@ -125,13 +125,17 @@ static int lfs_swap_layouts(int argc, char **argv);
 	"                 [--stripe-index|-i <start_ost_idx>]\n"\
 	"                 [--stripe-size|-S <stripe_size>]\n"\
 	"                 [--pool|-p <pool_name>]\n"\
+	"                 [--layout|-L <raid0|mdt>]\n"\
 	"                 [--block|-b] "_tgt"\n"\
 	"\tstripe_size:  Number of bytes on each OST (0 filesystem default)\n"\
+	"\t              or data kept on the MDT for the mdt layout\n"\
 	"\t              Can be specified with k, m or g (in KB, MB and GB\n"\
 	"\t              respectively)\n"\
 	"\tstart_ost_idx: OST index of first stripe (-1 default)\n"\
 	"\tstripe_count: Number of OSTs to stripe over (0 default, -1 all)\n"\
 	"\tpool_name:    Name of OST pool to use (default none)\n"\
+	"\tlayout:       mdt keeps a small file in the MDT inode until it\n"\
+	"\t              grows past stripe_size (64k default, 1m max)\n"\
 	"\tblock:	 Block file access during data migration"
 
 /* all avaialable commands */
@@ -152,9 +156,12 @@ command_t cmdlist[] = {
 	 "                 [--mdt-index|-M] [--recursive|-r] [--raw|-R]\n"
 	 "                 <directory|filename> ..."},
 	{"setdirstripe", lfs_setdirstripe, 0,
-	 "To create a remote directory on a specified MDT.\n"
-	 "usage: setdirstripe <--index|-i mdt_index> <dir>\n"
-	 "\tmdt_index:    MDT index of first stripe\n"},
+	 "To create a remote directory on a specified MDT, or a directory\n"
+	 "striped over several MDTs.\n"
+	 "usage: setdirstripe <--index|-i mdt_index>\n"
+	 "                    [--count|-c stripe_count] <dir>\n"
+	 "\tmdt_index:    MDT index of first stripe\n"
+	 "\tstripe_count: Number of MDTs to stripe over (1 default)\n"},
 	{"getdirstripe", lfs_getdirstripe, 0,
 	 "To list the striping info for a given directory\n"
 	 "or recursively for all directories in a directory tree.\n"
@@ -562,6 +569,7 @@ static int lfs_setstripe(int argc, char **argv)
 	char			*stripe_count_arg = NULL;
 	char			*pool_name_arg = NULL;
 	unsigned long long	 size_units = 1;
+	int			 st_pattern = 0;
 	int			 migrate_mode = 0;
 	__u64			 migration_flags = 0;
 
@@ -589,6 +597,7 @@ static int lfs_setstripe(int argc, char **argv)
 #endif
 		{"stripe-index", required_argument, 0, 'i'},
 		{"stripe_index", required_argument, 0, 'i'},
+		{"layout",	 required_argument, 0, 'L'},
 #if LUSTRE_VERSION >= OBD_OCD_VERSION(2,9,50,0)
 #warning "remove deprecated --offset option"
 #else
@@ -630,7 +639,7 @@ static int lfs_setstripe(int argc, char **argv)
 #endif
         {
                 optind = 0;
-                while ((c = getopt_long(argc, argv, "c:di:o:p:s:S:",
+                while ((c = getopt_long(argc, argv, "c:di:L:o:p:s:S:",
                                         long_opts, NULL)) >= 0) {
                 switch (c) {
                 case 0:
@@ -678,6 +687,17 @@ static int lfs_setstripe(int argc, char **argv)
 #endif
                         stripe_off_arg = optarg;
                         break;
+		case 'L':
+			if (strcmp(optarg, "mdt") == 0) {
+				st_pattern = LOV_PATTERN_MDT;
+			} else if (strcmp(optarg, "raid0") == 0) {
+				st_pattern = LOV_PATTERN_RAID0;
+			} else {
+				fprintf(stderr, "error: %s: bad layout '%s'\n",
+					argv[0], optarg);
+				return CMD_HELP;
+			}
+			break;
                 case 's':
 #if LUSTRE_VERSION >= OBD_OCD_VERSION(2,9,50,0)
 #warning "remove deprecated --size option"
@@ -706,6 +726,15 @@ static int lfs_setstripe(int argc, char **argv)
                                         argv[0]);
                         return CMD_HELP;
                 }
+
+		if (st_pattern == LOV_PATTERN_MDT &&
+		    (migrate_mode || delete || stripe_off_arg != NULL ||
+		     stripe_count_arg != NULL || pool_name_arg != NULL)) {
+			fprintf(stderr, "error: %s: cannot specify -L mdt with "
+				"-d, -i, -c, -p or in migrate mode\n",
+				argv[0]);
+			return CMD_HELP;
+		}
         }
 
         if (optind == argc) {
@@ -741,6 +770,9 @@ static int lfs_setstripe(int argc, char **argv)
                         return CMD_HELP;
                 }
         }
+	/* DoM size limit */
+	if (st_pattern == LOV_PATTERN_MDT && st_size == 0)
+		st_size = LOV_MIN_STRIPE_SIZE;
 
 	do {
 		if (migrate_mode)
@@ -750,7 +782,8 @@ static int lfs_setstripe(int argc, char **argv)
 		else
 			result = llapi_file_create_pool(fname, st_size,
 							st_offset, st_count,
-							0, pool_name_arg);
+							st_pattern,
+							pool_name_arg);
 		if (result) {
 			fprintf(stderr,
 				"error: %s: %s stripe file '%s' failed\n",
@@ -1433,9 +1466,11 @@ static int lfs_setdirstripe(int argc, char **argv)
 	char *end;
 	int c;
 	char *stripe_off_arg = NULL;
+	char *stripe_count_arg = NULL;
 	int  flags = 0;
 
 	struct option long_opts[] = {
+		{"count",    required_argument, 0, 'c'},
 		{"index",    required_argument, 0, 'i'},
 		{0, 0, 0, 0}
 	};
@@ -1443,12 +1478,15 @@ static int lfs_setdirstripe(int argc, char **argv)
 	st_offset = -1;
 	st_count = 1;
 	optind = 0;
-	while ((c = getopt_long(argc, argv, "i:o",
+	while ((c = getopt_long(argc, argv, "c:i:o",
 				long_opts, NULL)) >= 0) {
 		switch (c) {
 		case 0:
 			/* Long options. */
 			break;
+		case 'c':
+			stripe_count_arg = optarg;
+			break;
 		case 'i':
 			stripe_off_arg = optarg;
 			break;
@@ -1479,6 +1517,15 @@ static int lfs_setdirstripe(int argc, char **argv)
 			argv[0], stripe_off_arg);
 		return CMD_HELP;
 	}
+	/* get the stripe count */
+	if (stripe_count_arg != NULL) {
+		st_count = strtoul(stripe_count_arg, &end, 0);
+		if (*end != '\0' || st_count < 1) {
+			fprintf(stderr, "error: %s: bad stripe count '%s'\n",
+				argv[0], stripe_count_arg);
+			return CMD_HELP;
+		}
+	}
 	do {
 		result = llapi_dir_create_pool(dname, flags, st_offset,
 					       st_count, 0, NULL);
@@ -267,6 +267,23 @@ int llapi_stripe_limit_check(unsigned long long stripe_size, int stripe_offset,
 				"is not currently supported and would wrap");
 		return rc;
 	}
+	if (stripe_pattern != 0 && stripe_pattern != LOV_PATTERN_RAID0 &&
+	    stripe_pattern != LOV_PATTERN_MDT) {
+		rc = -EINVAL;
+		llapi_error(LLAPI_MSG_ERROR, rc, "error: bad stripe pattern %#x",
+				stripe_pattern);
+		return rc;
+	}
+	/* the stripe size of a DoM file is the size of its MDT body */
+	if (stripe_pattern == LOV_PATTERN_MDT &&
+	    (stripe_size == 0 || stripe_size > LOV_MAX_DOM_SIZE ||
+	     stripe_count != 0 || stripe_offset != -1)) {
+		rc = -EINVAL;
+		llapi_error(LLAPI_MSG_ERROR, rc, "error: bad DoM size %llu, "
+				"must be at most %u bytes without stripes",
+				stripe_size, LOV_MAX_DOM_SIZE);
+		return rc;
+	}
 	return 0;
 }
 
@@ -2111,6 +2128,9 @@ static void lov_dump_user_lmm_header(struct lov_user_md *lum, char *path,
                                      lum->lmm_stripe_offset ==
                                      (typeof(lum->lmm_stripe_offset))(-1) ? -1 :
                                      lum->lmm_stripe_offset, nl);
+		else if (lum->lmm_stripe_count == 0)
+			/* DoM file has no OST objects */
+			llapi_printf(LLAPI_MSG_NORMAL, "%d%c", -1, nl);
                 else
                         llapi_printf(LLAPI_MSG_NORMAL, "%u%c",
                                      objects[0].l_ost_idx, nl);
@@ -225,6 +225,18 @@ check_som_attrs(void)
 	CHECK_MEMBER(som_attrs, som_mountid);
 }
 
+static void
+check_lsom_attrs(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(lsom_attrs);
+	CHECK_MEMBER(lsom_attrs, lsa_flags);
+	CHECK_MEMBER(lsom_attrs, lsa_padding);
+	CHECK_MEMBER(lsom_attrs, lsa_size);
+	CHECK_MEMBER(lsom_attrs, lsa_blocks);
+	CHECK_VALUE_X(LSOM_FL_VALID);
+}
+
 static void
 check_hsm_attrs(void)
 {
@@ -520,6 +532,13 @@ check_obd_connect_data(void)
 	CHECK_DEFINE_64X(OBD_CONNECT_LIGHTWEIGHT);
 	CHECK_DEFINE_64X(OBD_CONNECT_SHORTIO);
 	CHECK_DEFINE_64X(OBD_CONNECT_PINGLESS);
+	CHECK_DEFINE_64X(OBD_CONNECT_MULTIBRW);
+	CHECK_DEFINE_64X(OBD_CONNECT_DOM);
+	CHECK_DEFINE_64X(OBD_CONNECT_BATCH_GETATTR);
+	CHECK_DEFINE_64X(OBD_CONNECT_LAZY_SIZE);
+	CHECK_DEFINE_64X(OBD_CONNECT_SYNC_BATCH);
+	CHECK_DEFINE_64X(OBD_CONNECT_STRIPED_DIR);
+	CHECK_DEFINE_64X(OBD_CONNECT_QUOTA_BATCH);
 
 	CHECK_VALUE_X(OBD_CKSUM_CRC32);
 	CHECK_VALUE_X(OBD_CKSUM_ADLER);
@@ -607,6 +626,8 @@ check_obdo(void)
 	CHECK_DEFINE_64X(OBD_MD_FLRMTRSETFACL);
 	CHECK_DEFINE_64X(OBD_MD_FLRMTRGETFACL);
 	CHECK_DEFINE_64X(OBD_MD_FLDATAVERSION);
+	CHECK_DEFINE_64X(OBD_MD_FLLAZYSIZE);
+	CHECK_DEFINE_64X(OBD_MD_FLLAZYBLOCKS);
 
 	CHECK_CVALUE_X(OBD_FL_INLINEDATA);
 	CHECK_CVALUE_X(OBD_FL_OBDMDEXISTS);
@@ -676,6 +697,7 @@ check_lov_mds_md_v3(void)
 
 	CHECK_VALUE_X(LOV_PATTERN_RAID0);
 	CHECK_VALUE_X(LOV_PATTERN_RAID1);
+	CHECK_VALUE_X(LOV_PATTERN_MDT);
 	CHECK_VALUE_X(LOV_PATTERN_FIRST);
 	CHECK_VALUE_X(LOV_PATTERN_CMOBD);
 }
@@ -846,6 +868,18 @@ check_ost_body(void)
 	CHECK_MEMBER(ost_body, oa);
 }
 
+static void
+check_ost_sync_rec(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(ost_sync_rec);
+	CHECK_MEMBER(ost_sync_rec, osr_oi);
+	CHECK_MEMBER(ost_sync_rec, osr_op);
+	CHECK_MEMBER(ost_sync_rec, osr_count);
+	CHECK_MEMBER(ost_sync_rec, osr_uid);
+	CHECK_MEMBER(ost_sync_rec, osr_gid);
+}
+
 static void
 check_ll_fid(void)
 {
@@ -932,6 +966,7 @@ check_mdt_body(void)
 	CHECK_DEFINE_X(MDS_INODELOCK_UPDATE);
 	CHECK_DEFINE_X(MDS_INODELOCK_OPEN);
 	CHECK_DEFINE_X(MDS_INODELOCK_LAYOUT);
+	CHECK_DEFINE_X(MDS_INODELOCK_DOM);
 }
 
 static void
@@ -945,6 +980,29 @@ check_mdt_ioepoch(void)
 	CHECK_MEMBER(mdt_ioepoch, padding);
 }
 
+static void
+check_mdt_batch_ent(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(mdt_batch_ent);
+	CHECK_MEMBER(mdt_batch_ent, mbe_handle);
+	CHECK_MEMBER(mdt_batch_ent, mbe_bits);
+	CHECK_MEMBER(mdt_batch_ent, mbe_nameoff);
+	CHECK_MEMBER(mdt_batch_ent, mbe_namelen);
+}
+
+static void
+check_mdt_batch_rep(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(mdt_batch_rep);
+	CHECK_MEMBER(mdt_batch_rep, mbr_body);
+	CHECK_MEMBER(mdt_batch_rep, mbr_handle);
+	CHECK_MEMBER(mdt_batch_rep, mbr_bits);
+	CHECK_MEMBER(mdt_batch_rep, mbr_status);
+	CHECK_MEMBER(mdt_batch_rep, mbr_padding);
+}
+
 static void
 check_mdt_remote_perm(void)
 {
@@ -2120,6 +2178,7 @@ main(int argc, char **argv)
 	CHECK_VALUE(OST_QUOTACHECK);
 	CHECK_VALUE(OST_QUOTACTL);
 	CHECK_VALUE(OST_QUOTA_ADJUST_QUNIT);
+	CHECK_VALUE(OST_SYNC_BATCH);
 	CHECK_VALUE(OST_LAST_OPC);
 
 	CHECK_DEFINE_64X(OBD_OBJECT_EOF);
@@ -2160,6 +2219,9 @@ main(int argc, char **argv)
 	CHECK_VALUE(MDS_HSM_CT_REGISTER);
 	CHECK_VALUE(MDS_HSM_CT_UNREGISTER);
 	CHECK_VALUE(MDS_SWAP_LAYOUTS);
+	CHECK_VALUE(MDS_DOM_READ);
+	CHECK_VALUE(MDS_DOM_WRITE);
+	CHECK_VALUE(MDS_BATCH_GETATTR);
 	CHECK_VALUE(MDS_LAST_OPC);
 
 	CHECK_VALUE(REINT_SETATTR);
@@ -2277,6 +2339,7 @@ main(int argc, char **argv)
 
 	CHECK_VALUE(QUOTA_DQACQ);
 	CHECK_VALUE(QUOTA_DQREL);
+	CHECK_VALUE(QUOTA_DQACQ_BATCH);
 	CHECK_VALUE(QUOTA_LAST_OPC);
 
 	CHECK_VALUE(MGS_CONNECT);
@@ -2312,6 +2375,7 @@ main(int argc, char **argv)
 	CHECK_VALUE(OBJ_INDEX_DELETE);
 
 	check_som_attrs();
+	check_lsom_attrs();
 	check_hsm_attrs();
 	check_ost_id();
 	check_lu_dirent();
@@ -2331,9 +2395,12 @@ main(int argc, char **argv)
 	check_obd_idx_read();
 	check_niobuf_remote();
 	check_ost_body();
+	check_ost_sync_rec();
 	check_ll_fid();
 	check_mdt_body();
 	check_mdt_ioepoch();
+	check_mdt_batch_ent();
+	check_mdt_batch_rep();
 	check_mdt_remote_perm();
 	check_mdt_rec_setattr();
 	check_mdt_rec_create();